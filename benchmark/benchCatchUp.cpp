@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchCatchUp.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 5, 2021, 4:30 PM
+ */
+
+// Measures what a late joiner costs the receivers that are already there. A real sender, a
+// steady receiver and a joiner run in simulated time, in steps of 1ms. The multicast datagrams
+// travel over a loopback socket (the shared link) that carries linkCapacity datagrams per step
+// with a delay of 1ms; what doesn't fit waits. The sender sends liveRate datagrams per step. The
+// joiner arrives halfway and wants the history of the last `history` datagrams:
+//  - catch-up: it sends a join, the sender replays the history over unicast at catchUpRate,
+//    outside the shared link
+//  - NAK: it asks for the history with a NAK, the sender resends over multicast what it still
+//    keeps: only the datagrams that the steady receiver didn't acknowledge yet
+// The latency of the steady receiver is from send to delivery.
+
+#include "benchmarkHelper.h"
+#include "../rmdgpLib/CNakPacket.h"
+#include "../rmdgpLib/CRmdgpReceiver.h"
+#include "../rmdgpLib/CRmdgpSender.h"
+#include "../socketLib/CSocketAddress.h"
+#include "../socketLib/CUdpMulticastReceiver.h"
+#include "../socketLib/CUdpMulticastSender.h"
+#include "../socketLib/CUdpSocket.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace {
+   const char *localAddress = "127.0.0.1";
+   const int dataPort = 7893;
+   const int feedbackPort = 7894;
+   const size_t payloadSize = 1000;
+   const uint64_t liveRate = 20;
+   const size_t linkCapacity = 40;
+   const size_t history = 2000;
+   const double catchUpRate = 40e6;
+   const CNanoTime step = CNanoTime::fromMsec(1);
+   const CNanoTime oneWayDelay = CNanoTime::fromMsec(1);
+   const CNanoTime duration = CNanoTime::fromMsec(1000);
+   const CNanoTime joinTime = CNanoTime::fromMsec(500);
+
+   enum class EMode { alone, catchUp, nak };
+
+   /// \brief a datagram on its way, with its source
+   struct SInFlight {
+      CNanoTime due;
+      sockaddr_in source;
+      std::vector<uint8_t> bytes;
+   };
+
+   /// \brief a loopback socket where the datagrams of one direction arrive. It hands over at
+   ///        most capacity datagrams per step, in order.
+   class CWire {
+   public:
+      CWire(int port, size_t capacity) : capacity(capacity), buffer(2048)
+      {
+         const in_addr address = { inet_addr(localAddress) };
+         socket.openUdpSocket();
+         socket.bind(address, port);
+         socket.setNonBlocking();
+      }
+
+      /// \brief takes the datagrams from the socket
+      void collect(const CNanoTime &now)
+      {
+         sockaddr_in source;
+         size_t length;
+         while((length = socket.receiveFrom(buffer.data(), buffer.size(), &source)) > 0)
+            inFlight.push_back({ now + oneWayDelay, source,
+                                 std::vector<uint8_t>(buffer.begin(), buffer.begin() + length) });
+      }
+
+      /// \brief hands over the datagrams that arrived
+      template<class TDeliver>
+      void deliver(const CNanoTime &now, TDeliver deliver)
+      {
+         for(size_t i = 0; i < capacity && !inFlight.empty() && inFlight.front().due <= now; i++)
+         {
+            deliver(inFlight.front().bytes.data(), inFlight.front().bytes.size(),
+                    inFlight.front().source);
+            inFlight.pop_front();
+         }
+      }
+
+   private:
+      const size_t capacity;
+      CUdpSocket socket;
+      std::vector<uint8_t> buffer;
+      std::deque<SInFlight> inFlight;
+   };
+
+   /// \brief copies datagram in a buffer of receiver and processes it
+   template<class TDelivered>
+   void process(CRmdgpReceiver &receiver, const uint8_t *datagram, size_t length,
+                const CNanoTime &now, TDelivered delivered)
+   {
+      SReceivedDatagram ready[64];
+      const uint32_t handle = receiver.getDatagramPool().acquire();
+
+      if(handle == CDatagramPool::invalidHandle)
+         return;
+      std::copy(datagram, datagram + length, receiver.getDatagramPool().getBuffer(handle));
+      size_t count = receiver.processDatagram(handle, length, ready, 64, now);
+      do
+      {
+         for(size_t i = 0; i < count; i++)
+         {
+            delivered(ready[i].sequence);
+            receiver.release(ready[i]);
+         }
+      } while((count = receiver.getReady(ready, 64)) > 0);
+   }
+
+   void run(EMode mode)
+   {
+      std::shared_ptr<CUdpMulticastSender> udpSender(new CUdpMulticastSender);
+      udpSender->open(localAddress, dataPort, localAddress);
+      std::shared_ptr<CUdpMulticastReceiver> steadySocket(new CUdpMulticastReceiver);
+      steadySocket->openUdpSocket();
+      std::shared_ptr<CUdpMulticastReceiver> joinerSocket(new CUdpMulticastReceiver);
+      joinerSocket->openUdpSocket();
+      joinerSocket->setNonBlocking();
+      CWire link(dataPort, linkCapacity), feedbackWire(feedbackPort, SIZE_MAX);
+      CRmdgpSender sender(udpSender, 1, 1, 4096, 4096 * (CRmdgpHeader::size + payloadSize),
+                          payloadSize);
+      CRmdgpReceiver steady(steadySocket, CSocketAddress(localAddress, feedbackPort), 1);
+      CRmdgpReceiver joiner(joinerSocket, CSocketAddress(localAddress, feedbackPort), 1);
+      std::vector<CNanoTime> sendTimes;
+      std::vector<CNanoTime> latencies;
+      uint8_t payload[payloadSize] = { 0 };
+      std::vector<uint8_t> buffer(2048);
+      uint64_t steadyDelivered = 0;
+      uint64_t historyDelivered = 0;
+      uint64_t joinerLive = 0;
+      uint64_t firstLive = 0;
+      uint64_t resent = 0;
+      CNanoTime joinerFirst, caughtUp;
+      bool joined = false;
+
+      sender.setCatchUp(catchUpRate, 16 * 1024);
+      steady.setReceiverId(1);
+      joiner.setReceiverId(2);
+      if(mode == EMode::catchUp)
+         joiner.setCatchUp(history);
+
+      // simulated CLOCK_MONOTONIC, far from zero like the real one
+      const CNanoTime base = CNanoTime::fromSec(1000);
+      for(CNanoTime time; time < duration; time += step)
+      {
+         const CNanoTime now = base + time;
+
+         for(uint64_t i = 0; i < liveRate; i++)
+         {
+            sendTimes.push_back(now);
+            sender.send(payload, payloadSize);
+         }
+         sender.handleTimer(now);
+
+         link.collect(now);
+         link.deliver(now, [&](const uint8_t *datagram, size_t length, const sockaddr_in &source)
+         {
+            if(CRmdgpHeaderView(datagram).hasFlag(rmdgpFlagRetransmission))
+               resent++;
+            process(steady, datagram, length, now, [&](uint64_t sequence)
+            {
+               latencies.push_back(now - sendTimes[sequence]);
+               steadyDelivered++;
+            });
+            if(mode == EMode::alone || time < joinTime)
+               return;
+            if(!joined && mode == EMode::nak)
+            {
+               // the history before the first datagram, like the join asks for
+               const uint64_t first = CRmdgpHeaderView(datagram).getSequence();
+               CNakBuilder nak(buffer.data(), buffer.size(), 1, 1, 1);
+               nak.add({ first - history, first });
+               CSocketAddress feedbackAddress(localAddress, feedbackPort);
+               joinerSocket->sendTo(buffer.data(), nak.getLength(), &feedbackAddress);
+            }
+            if(!joined)
+            {
+               joined = true;
+               joinerFirst = now;
+               firstLive = CRmdgpHeaderView(datagram).getSequence();
+            }
+            process(joiner, datagram, length, now, [&](uint64_t sequence)
+            {
+               if(CSequenceNumber::isBefore(sequence, firstLive))
+                  historyDelivered++;
+               else
+                  joinerLive++;
+            });
+         });
+
+         // the replay and the join accept come straight from the sender
+         size_t length;
+         sockaddr_in source;
+         while((length = joinerSocket->receiveFrom(buffer.data(), buffer.size(), &source)) > 0)
+            process(joiner, buffer.data(), length, now, [&](uint64_t sequence)
+            {
+               if(CSequenceNumber::isBefore(sequence, firstLive))
+                  historyDelivered++;
+               else
+                  joinerLive++;
+            });
+         if(joined && caughtUp == CNanoTime() && !joiner.isCatchingUp())
+            caughtUp = now;
+
+         steady.handleTimer(now);
+         if(joined)
+            joiner.handleTimer(now);
+         feedbackWire.collect(now);
+         bool acknowledged = false;
+         feedbackWire.deliver(now, [&](const uint8_t *datagram, size_t length,
+                                       const sockaddr_in &source)
+         {
+            const ERmdgpPacketType type = ERmdgpPacketType(datagram[CRmdgpHeader::typeOffset]);
+            if(type == ERmdgpPacketType::ack)
+               acknowledged |= sender.processAck(datagram, length, now);
+            else if(type == ERmdgpPacketType::join)
+               sender.processJoin(datagram, length, source, now);
+            else
+               sender.processNak(datagram, length);
+         });
+         if(acknowledged)
+            sender.updateWindow();
+      }
+
+      std::sort(latencies.begin(), latencies.end());
+      std::cout << (mode == EMode::alone ? "no joiner: " :
+                    (mode == EMode::catchUp ? "catch-up:  " : "NAK:       "))
+                << "steady receiver " << steadyDelivered << " delivered, latency p50 "
+                << latencies[latencies.size() / 2].getMsec() << "ms p99 "
+                << latencies[latencies.size() * 99 / 100].getMsec() << "ms max "
+                << latencies.back().getMsec() << "ms, "
+                << steady.getDuplicateFilter().getDuplicateCount() << " duplicates";
+      if(mode != EMode::alone)
+      {
+         std::cout << "; joiner " << historyDelivered << " of " << history
+                   << " history datagrams";
+         if(mode == EMode::catchUp)
+            std::cout << " in " << (caughtUp - joinerFirst).getMsec() << "ms";
+         else
+            std::cout << ", " << resent << " multicast resends";
+         std::cout << ", " << joinerLive << " live";
+      }
+      std::cout << std::endl;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   std::cout << liveRate << " datagrams of " << payloadSize << " bytes per ms over a link of "
+             << linkCapacity << " per ms, the joiner arrives at " << joinTime.getMsec()
+             << "ms and wants " << history << " datagrams of history, replayed at "
+             << catchUpRate / 1e6 << "MB/s" << std::endl;
+   run(EMode::alone);
+   run(EMode::catchUp);
+   run(EMode::nak);
+   return 0;
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchClock.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 6, 2021, 5:30 PM
+ */
+
+// Compares the cost of reading the clock via clock_gettime and via the TSC, and reports how far
+// the TSC clock drifts from CLOCK_MONOTONIC.
+
+#include "benchmarkHelper.h"
+#include "../socketLib/CClock.h"
+#include "../socketLib/CTscClock.h"
+#include "../socketLib/CNanoTime.h"
+#include <sstream>
+
+int main(int argc, char** argv)
+{
+   const size_t iterations = 10000000;
+   int driftSeconds = 5;
+
+   if(argc > 1)
+   {
+      std::istringstream driftSecondsSS(argv[1]);
+      driftSecondsSS >> driftSeconds;
+   }
+
+   std::cout << "invariant TSC: " << (CTscClock::hasInvariantTsc() ? "yes" : "no")
+             << ", fast clock TSC based: "
+             << (CClock::isFastMonotonicTimeTscBased() ? "yes" : "no") << std::endl;
+
+   CNanoTime time;
+   measure("CClock::getMonotonicTime", iterations, [&](size_t i)
+         { CClock::getMonotonicTime(time); doNotOptimize(time); });
+   measure("CClock::getFastMonotonicTime", iterations, [&](size_t i)
+         { CClock::getFastMonotonicTime(time); doNotOptimize(time); });
+   uint64_t tsc;
+   measure("CTscClock::readTsc (raw, no conversion)", iterations, [&](size_t i)
+         { tsc = CTscClock::readTsc(); doNotOptimize(tsc); });
+
+   // drift: sample both clocks every 100ms, the fast clock recalibrates every second
+   std::cout << "drift of the fast clock against CLOCK_MONOTONIC for " << driftSeconds
+             << "s:" << std::endl;
+   CNanoTime start, before, after, fast;
+   CNanoTime maxDrift;
+   CClock::getMonotonicTime(start);
+   for(int sample = 1; sample <= driftSeconds * 10; sample++)
+   {
+      do
+      {
+         CClock::getMonotonicTime(before);
+      } while(before - start < CNanoTime::fromMsec(100) * sample);
+
+      CClock::getFastMonotonicTime(fast);
+      CClock::getMonotonicTime(after);
+      // the real time is between before and after
+      const CNanoTime drift = fast - (before + (after - before) / 2);
+      const CNanoTime absDrift = (drift < CNanoTime()) ? -drift : drift;
+      if(absDrift > maxDrift)
+         maxDrift = absDrift;
+      if(sample % 10 == 0)
+         std::cout << "  " << sample / 10 << "s drift " << drift.getNsec() << "ns" << std::endl;
+   }
+   std::cout << "max drift " << maxDrift.getNsec() << "ns" << std::endl;
+
+   return 0;
+}
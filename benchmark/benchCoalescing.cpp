@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchCoalescing.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 4, 2021, 11:10 AM
+ */
+
+// Measures what coalescing small messages into batches does for the number of datagrams, the
+// messages per second that a real CRmdgpSender sends over loopback, and the latency that the
+// flush deadline adds.
+// The application publishes messages of 20 to 100 bytes with random (exponential) gaps, on
+// average 100000 per second, on a simulated clock. The event loop wakes up at the flush time
+// of the sender to call handleTimer, so a batch waits at most the deadline. The latency is the
+// time from sendMessage until the batch of the message is sent. The messages per second are
+// measured on the real clock, for the whole run including the system calls. wire/data is the
+// number of bytes on the wire, with the RMDGP, UDP and IPv4 headers, per byte of message.
+
+#include "benchmarkHelper.h"
+#include "../rmdgpLib/CRmdgpSender.h"
+#include "../socketLib/CLatencyHistogram.h"
+#include "../socketLib/CUdpMulticastSender.h"
+#include <math.h>
+#include <memory>
+#include <vector>
+
+namespace {
+   /// \brief xorshift64, fast and good enough for message sizes and gaps
+   class CRandom {
+   public:
+      CRandom(uint64_t seed) : state(seed) {}
+      uint64_t next() { state ^= state << 13; state ^= state >> 7; state ^= state << 17; return state; }
+      double uniform() { return double((next() >> 11) + 1) * 0x1.0p-53; }
+   private:
+      uint64_t state;
+   };
+
+   const size_t nbrMessages = 1000000;
+   const size_t minMessageSize = 20;
+   const size_t maxMessageSize = 100;
+   const double messagesPerSecond = 100000;
+   const size_t ringSize = 4096;
+
+   /// \param deadline the flush deadline, negative to send every message in its own datagram
+   void run(const std::shared_ptr<CUdpMulticastSender> &udpSender, const CNanoTime &deadline)
+   {
+      CRmdgpSender sender(udpSender, 1, 1, ringSize,
+                          ringSize * (CRmdgpSender::defaultMaxPayloadSize + CRmdgpHeader::size));
+      CRandom random(0x9e3779b97f4a7c15);
+      CLatencyHistogram histogram;
+      std::vector<CNanoTime> pending;
+      uint8_t message[maxMessageSize] = { 0 };
+      uint64_t bytes = 0, dropped = 0;
+      CNanoTime now = CNanoTime::fromSec(1000);
+      CNanoTime start, stop;
+      const bool coalescing = deadline >= CNanoTime();
+
+      if(coalescing)
+         sender.setCoalescing(deadline);
+
+      // the sent messages leave the batch in order, the latency is taken when they do
+      auto sent = [&](size_t count, const CNanoTime &time)
+      {
+         for(size_t i = 0; i < count; i++)
+            histogram.record(time - pending[i]);
+         pending.erase(pending.begin(), pending.begin() + count);
+      };
+
+      CClock::getMonotonicTime(start);
+      for(size_t i = 0; i < nbrMessages; i++)
+      {
+         now += CNanoTime::fromNsec(int64_t(-log(random.uniform()) * 1e9 / messagesPerSecond));
+         const size_t length = minMessageSize + random.next() % (maxMessageSize -
+                                                                 minMessageSize + 1);
+         bytes += length;
+         if(!coalescing)
+         {
+            dropped += !sender.send(message, length);
+            histogram.record(CNanoTime());
+         }
+         else
+         {
+            // the event loop wakes up for the flush time when it comes before the message
+            if(sender.hasPendingMessages() && sender.getFlushTime() <= now)
+            {
+               sender.handleTimer(sender.getFlushTime());
+               sent(pending.size(), sender.getFlushTime());
+            }
+            const uint64_t batches = sender.getBatchCount();
+            pending.push_back(now);
+            if(!sender.sendMessage(message, length, now))
+            {
+               pending.pop_back();
+               dropped++;
+            }
+            else if(sender.getBatchCount() != batches)
+               sent(pending.size() - (sender.hasPendingMessages() ? 1 : 0), now);
+         }
+         // every receiver has everything, the window stays open
+         if((i & 255) == 0)
+            sender.acknowledge(sender.getNextSequence());
+      }
+      sender.flush();
+      sent(pending.size(), now);
+      CClock::getMonotonicTime(stop);
+
+      const uint64_t datagrams = sender.getNextSequence();
+      const double seconds = double((stop - start).getNsec()) / 1e9;
+      std::cout << std::left << std::setw(12)
+                << (coalescing ? std::to_string(deadline.getUsec()) + "us" : std::string("off"))
+                << std::right << std::setw(9) << datagrams << std::fixed << std::setprecision(1)
+                << std::setw(10) << double(nbrMessages - dropped) / double(datagrams)
+                << std::setw(10) << double(bytes + datagrams * (CRmdgpHeader::size + 28)) /
+                                    double(bytes) << std::setprecision(0)
+                << std::setw(12) << double(nbrMessages - dropped) / seconds
+                << std::setw(9) << histogram.getValueAtPercentile(50.0).getUsec()
+                << std::setw(9) << histogram.getValueAtPercentile(99.0).getUsec()
+                << std::setw(9) << histogram.getMax().getUsec() << std::endl;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   // nobody listens, the datagrams only have to leave the sender
+   std::shared_ptr<CUdpMulticastSender> udpSender(new CUdpMulticastSender);
+   udpSender->open("127.0.0.1", 7890, "127.0.0.1");
+
+   std::cout << nbrMessages << " messages of " << minMessageSize << " to " << maxMessageSize
+             << " bytes, " << messagesPerSecond << " per second" << std::endl;
+   std::cout << std::left << std::setw(12) << "deadline" << std::right << std::setw(9)
+             << "packets" << std::setw(10) << "msg/pkt" << std::setw(10) << "wire/data"
+             << std::setw(12) << "msg/s" << std::setw(9) << "p50 us" << std::setw(9) << "p99 us"
+             << std::setw(9) << "max us" << std::endl;
+   run(udpSender, -CNanoTime::fromNsec(1));
+   for(int64_t usec : { 0, 10, 50, 100, 500, 1000, 5000 })
+      run(udpSender, CNanoTime::fromUsec(usec));
+   return 0;
+}
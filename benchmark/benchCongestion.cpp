@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchCongestion.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 5, 2021, 11:15 AM
+ */
+
+// Simulates CTfmccController behind a bottleneck, alone and together with TCP like flows.
+// The network is a fluid model in steps of 1ms: a link of 10Mbit/s with a drop tail queue of
+// one bandwidth delay product. When the arrivals overflow the queue, every flow loses the same
+// fraction of that step. The round trip time is the base time of a path plus the queueing delay.
+// The TFMCC stream goes to 4 receivers with base round trip times of 20 to 80ms. Each measures
+// its loss event rate like TFRC does (the average of the last 8 loss intervals, at most one
+// loss event per round trip time) and reports it every 50ms with its round trip time to a real
+// CTfmccController. The TCP like flows do AIMD on a window: one segment more per round trip
+// time, halve on a loss event. They have the 80ms base round trip time of the slowest receiver.
+// Reported are the convergence time, the link utilisation, the shares of the flows in the last
+// half and Jain's fairness index.
+
+#include "benchmarkHelper.h"
+#include "../rmdgpLib/CTfmccController.h"
+#include <iomanip>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace {
+   const double linkRate = 10e6 / 8;                         // bytes per second
+   const CNanoTime step = CNanoTime::fromMsec(1);
+   const double stepSec = 0.001;
+   const size_t segmentSize = 1400;
+   const CNanoTime reportInterval = CNanoTime::fromMsec(50);
+   const CNanoTime tcpRtt = CNanoTime::fromMsec(80);
+   const double queueSize = linkRate * 0.08;
+   const int64_t duration = 120000;                          // steps
+   const size_t lossIntervals = 8;
+
+   /// \brief the loss event rate at one receiver, see RFC 5348 section 5
+   class CLossEvents {
+   public:
+      CLossEvents() : intervals(), current(0), lastEvent() {}
+      void receive(double segments, double lostSegments, const CNanoTime &now,
+                   const CNanoTime &rtt)
+      {
+         current += segments;
+         if(lostSegments <= 0 || (!intervals.empty() && now - lastEvent < rtt))
+            return;
+         intervals.insert(intervals.begin(), current);
+         if(intervals.size() > lossIntervals)
+            intervals.pop_back();
+         current = 0;
+         lastEvent = now;
+      }
+      double getLossRate() const
+      {
+         if(intervals.empty())
+            return 0;
+         // the open interval counts when it makes the average larger
+         const double closed = std::accumulate(intervals.begin(), intervals.end(), 0.0) /
+                               double(intervals.size());
+         const double open = (current + std::accumulate(intervals.begin(), intervals.end() - 1,
+                               0.0)) / double(intervals.size());
+         return 1.0 / std::max(std::max(closed, open), 1.0);
+      }
+   private:
+      std::vector<double> intervals;
+      double current;
+      CNanoTime lastEvent;
+   };
+
+   /// \brief a TFMCC stream with its receivers
+   struct STfmccFlow {
+      STfmccFlow(int64_t start) : controller(segmentSize, 2 * segmentSize, 100 * linkRate),
+                                  start(start), receivers(4), sent(0) {}
+      CTfmccController controller;
+      int64_t start;                                      // step of the first datagram
+      std::vector<CLossEvents> receivers;
+      double sent;                                        // in the measured half
+   };
+
+   /// \brief an AIMD flow, TCP Reno without its details
+   struct STcpFlow {
+      STcpFlow() : window(2 * segmentSize), lastDecrease(), sent(0) {}
+      double window;
+      CNanoTime lastDecrease;
+      double sent;
+   };
+
+   CNanoTime getReceiverRtt(size_t receiver, const CNanoTime &queueDelay)
+   {
+      return CNanoTime::fromMsec(20 * int64_t(receiver + 1)) + queueDelay;
+   }
+
+   /// \brief runs one scenario and prints its line
+   /// \param starts the start of each TFMCC flow in steps
+   void simulate(const std::string &name, const std::vector<int64_t> &starts, size_t nbrTcp)
+   {
+      std::vector<std::unique_ptr<STfmccFlow>> tfmcc;
+      std::vector<STcpFlow> tcp(nbrTcp);
+      std::vector<double> rates(starts.size() + nbrTcp);
+      const CNanoTime begin = CNanoTime::fromSec(1000);
+      double queue = 0, delivered = 0;
+      int64_t converged = -1;
+
+      for(int64_t start : starts)
+         tfmcc.emplace_back(new STfmccFlow(start));
+
+      for(int64_t i = 0; i < duration; i++)
+      {
+         const CNanoTime now = begin + step * i;
+         const CNanoTime queueDelay = CNanoTime::fromNsec(int64_t(queue / linkRate * 1e9));
+         double arrivals = 0;
+
+         for(size_t f = 0; f < tfmcc.size(); f++)
+            arrivals += rates[f] = (i >= tfmcc[f]->start) ? tfmcc[f]->controller.getRate(now) : 0;
+         for(size_t f = 0; f < nbrTcp; f++)
+            arrivals += rates[tfmcc.size() + f] = tcp[f].window /
+                                                  double((tcpRtt + queueDelay).getNsec()) * 1e9;
+         arrivals *= stepSec;
+
+         // the drop tail queue
+         const double overflow = std::max(queue + arrivals - linkRate * stepSec - queueSize, 0.0);
+         const double dropped = (arrivals > 0) ? overflow / arrivals : 0;
+         queue = std::max(queue + arrivals - overflow - linkRate * stepSec, 0.0);
+         if(i >= duration / 2)
+            delivered += arrivals - overflow;
+
+         for(size_t f = 0; f < tfmcc.size(); f++)
+         {
+            STfmccFlow &flow = *tfmcc[f];
+            if(i < flow.start)
+               continue;
+            const double segments = rates[f] * stepSec / segmentSize;
+            for(size_t r = 0; r < flow.receivers.size(); r++)
+               flow.receivers[r].receive(segments * (1 - dropped), segments * dropped, now,
+                                         getReceiverRtt(r, queueDelay));
+            if((i - flow.start) % reportInterval.getMsec() == 0)
+               for(size_t r = 0; r < flow.receivers.size(); r++)
+                  flow.controller.onFeedback(uint32_t(r + 1), flow.receivers[r].getLossRate(),
+                                             getReceiverRtt(r, queueDelay), now);
+            if(i >= duration / 2)
+               flow.sent += rates[f] * stepSec * (1 - dropped);
+         }
+         for(size_t f = 0; f < nbrTcp; f++)
+         {
+            STcpFlow &flow = tcp[f];
+            const double bytes = rates[tfmcc.size() + f] * stepSec;
+            if(dropped > 0 && now - flow.lastDecrease > tcpRtt + queueDelay)
+            {
+               flow.window = std::max(flow.window / 2, double(segmentSize));
+               flow.lastDecrease = now;
+            }
+            else
+               flow.window += segmentSize * bytes * (1 - dropped) / flow.window;
+            if(i >= duration / 2)
+               flow.sent += bytes * (1 - dropped);
+         }
+         if(converged < 0 && rates[0] >= 0.9 * linkRate / double(rates.size()))
+            converged = i;
+      }
+
+      std::vector<double> shares;
+      for(auto &flow : tfmcc)
+         shares.push_back(flow->sent);
+      for(auto &flow : tcp)
+         shares.push_back(flow.sent);
+      double sum = 0, squares = 0;
+      for(double share : shares)
+      {
+         sum += share;
+         squares += share * share;
+      }
+
+      std::cout << std::left << std::setw(20) << name << std::right << std::fixed
+                << std::setprecision(0) << std::setw(8) << double(converged) << "ms"
+                << std::setprecision(1) << std::setw(8)
+                << 100.0 * delivered / (linkRate * stepSec * double(duration / 2)) << "%  ";
+      for(double share : shares)
+         std::cout << std::setw(6) << 100.0 * share / sum << "%";
+      std::cout << std::setprecision(3) << "   Jain " << sum * sum / (double(shares.size()) * squares)
+                << "   CLR";
+      for(auto &flow : tfmcc)
+         std::cout << " " << flow->controller.getLimitingReceiver() << " ("
+                   << flow->controller.getLimitingChangeCount() << " changes)";
+      std::cout << std::endl;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   std::cout << "10Mbit/s bottleneck, " << duration / 1000 << "s, shares of the second half"
+             << std::endl;
+   std::cout << std::setw(20) << "" << "  converged  utilisation  shares (TFMCC first)" << std::endl;
+   simulate("TFMCC alone", { 0 }, 0);
+   simulate("TFMCC + 1 TCP", { 0 }, 1);
+   simulate("TFMCC + 2 TCP", { 0 }, 2);
+   simulate("TFMCC + 4 TCP", { 0 }, 4);
+   simulate("2 TFMCC, 2nd at 20s", { 0, 20000 }, 0);
+   return 0;
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchDeliveryLog.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 7, 2021, 1:50 PM
+ */
+
+// Measures the receiver delivery log: the append throughput with a flush every flushInterval
+// messages and a flush(true) (msync) every syncInterval, like the timer of a receiver does, and
+// the time a restarted receiver needs to open the full log, find its watermark and replay the
+// last replayCount messages. The resume is measured twice: with the log in the page cache and
+// after the pages are dropped from it, like after a reboot.
+// Usage: benchDeliveryLog [directory [megabytes]], by default a new directory in /tmp and
+// 10240 MB. The log is removed afterwards.
+
+#include "benchmarkHelper.h"
+#include "../rmdgpLib/CDeliveryLog.h"
+#include "../socketLib/CMappedFile.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <memory>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+   const size_t messageLength = 1400;
+   const size_t segmentSize = CDeliveryLog::defaultSegmentSize;
+   const size_t flushInterval = 1000;
+   const CNanoTime syncInterval = CNanoTime::fromMsec(100);
+   const uint64_t replayCount = 100000;
+
+   CNanoTime now()
+   {
+      CNanoTime time;
+      return CClock::getMonotonicTime(time);
+   }
+
+   /// \brief removes the pages of the log from the page cache, they are all written back
+   void dropPageCache(const std::string &directory)
+   {
+      for(const std::string &file : CMappedFile::list(directory, CDeliveryLog::filePrefix))
+      {
+         const int fd = open((directory + "/" + file).c_str(), O_RDONLY);
+         if(fd < 0)
+            continue;
+         posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+         close(fd);
+      }
+   }
+
+   /// \brief opens the log like a restarted receiver and replays the end of it
+   void resume(const std::string &directory, const char *description, uint64_t expectedNext)
+   {
+      const CNanoTime openStart = now();
+      CDeliveryLog log(directory, segmentSize);
+      const uint64_t next = log.getDurableSequence();
+      const CNanoTime openTime = now() - openStart;
+
+      const CNanoTime replayStart = now();
+      CDeliveryLog::SPosition position = log.seek(next - replayCount);
+      CDeliveryLog::SRecord record;
+      uint64_t replayed = 0, checksum = 0;
+      while(log.next(position, record))
+      {
+         checksum += record.data[record.length - 1];
+         replayed++;
+      }
+      doNotOptimize(checksum);
+      const CNanoTime replayTime = now() - replayStart;
+
+      std::cout << description << ": open " << log.getRecoveredCount() << " messages in "
+                << log.getSegmentCount() << " segments " << openTime.getUsec() << " us, "
+                << ((next == expectedNext) ? "resume at " : "WRONG, resume at ") << next
+                << ", replay " << replayed << " messages " << replayTime.getUsec() << " us"
+                << std::endl;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   char name[] = "/tmp/benchDeliveryLog-XXXXXX";
+   const std::string directory = (argc > 1) ? argv[1] : mkdtemp(name);
+   const size_t megabytes = (argc > 2) ? size_t(atol(argv[2])) : 10240;
+   const size_t segments = std::max<size_t>(1, (megabytes << 20) / segmentSize);
+   std::vector<uint8_t> message(messageLength, 0x55);
+   std::vector<int64_t> appendTimes;
+   std::vector<int64_t> syncTimes;
+   uint64_t sequence = 0;
+
+   std::cout << "log of " << segments << " segments of " << (segmentSize >> 20) << " MB in "
+             << directory << ", messages of " << messageLength << " bytes, flush(true) every "
+             << syncInterval.getMsec() << " ms" << std::endl;
+   {
+      std::unique_ptr<CDeliveryLog> log(new CDeliveryLog(directory, segmentSize));
+      // the first segment is made in advance
+      log->flush();
+      const CNanoTime fillStart = now();
+      CNanoTime flushTime;
+      CNanoTime lastSync = fillStart;
+      uint64_t perSegment = 0;
+      // fill all segments
+      while(perSegment == 0 || log->getCount() < perSegment * segments)
+      {
+         memcpy(message.data(), &sequence, sizeof(sequence));
+         const CNanoTime start = now();
+         log->append(sequence++, message.data(), message.size());
+         const CNanoTime end = now();
+         appendTimes.push_back((end - start).getNsec());
+         if(sequence % flushInterval == 0)
+         {
+            if(end - lastSync >= syncInterval)
+            {
+               log->flush(true);
+               lastSync = now();
+               syncTimes.push_back((lastSync - end).getNsec());
+            }
+            else
+            {
+               log->flush();
+               flushTime += now() - end;
+            }
+         }
+         if(perSegment == 0 && log->getSegmentCount() == 2)
+            perSegment = log->getCount() - 1;
+      }
+      log->flush(true);
+      const CNanoTime fillTime = now() - fillStart;
+      const double bytes = double(log->getCount()) * messageLength;
+
+      std::sort(appendTimes.begin(), appendTimes.end());
+      std::sort(syncTimes.begin(), syncTimes.end());
+      std::cout << "append " << appendTimes.size() << " messages, " << int64_t(bytes) / 1000000
+                << " MB in " << fillTime.getMsec() << " ms: "
+                << int64_t(bytes * 1000 / double(fillTime.getNsec())) << " MB/s, "
+                << fillTime.getNsec() / int64_t(appendTimes.size())
+                << " ns per message including flush" << std::endl;
+      std::cout << "append median " << appendTimes[appendTimes.size() / 2] << " ns, 99.99% "
+                << appendTimes[appendTimes.size() * 9999 / 10000] << " ns, max "
+                << appendTimes.back() << " ns (clock reading included)" << std::endl;
+      std::cout << "flush every " << flushInterval << " messages: "
+                << flushTime.getNsec() / int64_t(appendTimes.size() / flushInterval)
+                << " ns per flush" << std::endl;
+      if(!syncTimes.empty())
+         std::cout << syncTimes.size() << " x flush(true): median "
+                   << syncTimes[syncTimes.size() / 2] / 1000 << " us, max "
+                   << syncTimes.back() / 1000 << " us" << std::endl;
+   }
+
+   resume(directory, "resume from the page cache", sequence);
+   dropPageCache(directory);
+   resume(directory, "resume from the disk", sequence);
+
+   for(const std::string &file : CMappedFile::list(directory, CDeliveryLog::filePrefix))
+      unlink((directory + "/" + file).c_str());
+   if(argc < 2)
+      rmdir(directory.c_str());
+   return 0;
+}
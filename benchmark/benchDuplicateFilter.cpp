@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchDuplicateFilter.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 24, 2021, 9:15 PM
+ */
+
+// Measures the duplicate filter on a stream where a part of the datagrams arrives a second time
+// (a retransmission that crossed the original) somewhere within the window behind the newest.
+// The base follows the stream like the delivered watermark of the receiver.
+
+#include "benchmarkHelper.h"
+#include "../rmdgpLib/CDuplicateFilter.h"
+#include <sstream>
+#include <vector>
+
+namespace {
+   /// \brief a small and fast pseudo random generator (xorshift64)
+   class CRandom {
+   public:
+      CRandom(uint64_t seed) : state(seed) {}
+      uint64_t next() { state ^= state << 13; state ^= state >> 7; state ^= state << 17; return state; }
+   private:
+      uint64_t state;
+   };
+
+   void run(size_t window, unsigned duplicatePercent)
+   {
+      const size_t nbrSequences = 1 << 20;
+      CRandom random(0x7654321);
+      std::vector<uint64_t> sequences(nbrSequences);
+      uint64_t newest = 0;
+
+      // prepare the stream up front, so only the filter is measured
+      for(size_t i = 0; i < nbrSequences; i++)
+      {
+         if(newest > window && random.next() % 100 < duplicatePercent)
+            sequences[i] = newest - 1 - random.next() % (window / 2);
+         else
+            sequences[i] = ++newest;
+      }
+
+      CDuplicateFilter filter(window, 1);
+      std::ostringstream name;
+      name << "window " << window << ", " << duplicatePercent << "% duplicates";
+      const double nsecPerCheck = measure(name.str(), nbrSequences, [&](size_t i)
+            {
+               // start over after the warm up
+               if(i == 0)
+               {
+                  filter.reset(1);
+                  filter.resetCounters();
+               }
+               const uint64_t sequence = sequences[i];
+               CDuplicateFilter::EResult result = filter.checkAndSet(sequence);
+               doNotOptimize(result);
+               // advance in steps, like the receiver does once per delivered batch
+               if((i & 31) == 0 && sequence > window / 2)
+                  filter.advance(sequence - window / 2);
+            });
+      std::cout << "  duplicates " << filter.getDuplicateCount() << ", beyond window "
+                << filter.getBeyondWindowCount() << ", " << std::setprecision(1)
+                << 1e3 / nsecPerCheck << " M checks/s" << std::endl;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   run(1024, 0);
+   run(4096, 20);
+   run(65536, 20);
+   run(4096, 50);
+   return 0;
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchEventLoop.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 9, 2021, 8:05 PM
+ */
+
+// Runs an event loop over a loopback UDP socket and counts the clock reads per processed packet,
+// for handlers that read the clock themselves and for handlers that use the cached
+// CFdWaiter::now(), with the precise and the coarse clock.
+
+#include "benchmarkHelper.h"
+#include "../socketLib/CFdWaiter.h"
+#include "../socketLib/CUdpSocket.h"
+#include "../socketLib/CSocketAddress.h"
+#include "../socketLib/CClock.h"
+#include "../socketLib/CNanoTime.h"
+#include <arpa/inet.h>
+
+namespace {
+   const int port = 7400;
+   const size_t burstSize = 32;
+   const size_t nbrBursts = 20000;
+
+   void runLoop(const std::string &name, CFdWaiter::EClockMode mode, bool handlerReadsClock)
+   {
+      const struct in_addr localAddress = { inet_addr("127.0.0.1") };
+      CSocketAddress destination("127.0.0.1", port);
+      CUdpSocket receiver, sender;
+      CFdWaiter waiter;
+      char buffer[64] = "timestamp me";
+      sockaddr_in source;
+      size_t packets = 0;
+      uint64_t handlerClockReads = 0;
+      CNanoTime lastTimestamp, start, stop;
+
+      receiver.openUdpSocket();
+      receiver.bind(localAddress, port);
+      receiver.setNonBlocking();
+      sender.openUdpSocket();
+      waiter.addReadFileDescriptor(&receiver);
+      waiter.setClockMode(mode);
+
+      CClock::getMonotonicTime(start);
+      for(size_t burst = 0; burst < nbrBursts; burst++)
+      {
+         for(size_t i = 0; i < burstSize; i++)
+            sender.sendTo(buffer, sizeof(buffer), &destination);
+
+         size_t received = 0;
+         while(received < burstSize)
+         {
+            waiter.waitUntil(waiter.now() + CNanoTime::fromMsec(100));
+            while(receiver.receiveFrom(buffer, sizeof(buffer), &source) > 0)
+            {
+               // the handler time stamps every packet
+               if(handlerReadsClock)
+               {
+                  CClock::getMonotonicTime(lastTimestamp);
+                  handlerClockReads++;
+               }
+               else
+                  lastTimestamp = waiter.now();
+               doNotOptimize(lastTimestamp);
+               received++;
+            }
+         }
+         packets += received;
+      }
+      CClock::getMonotonicTime(stop);
+
+      const uint64_t clockReads = waiter.getClockReadCount() + handlerClockReads;
+      std::cout << std::left << std::setw(40) << name << std::right
+                << " packets " << packets
+                << " wake ups " << waiter.getWakeUpCount()
+                << " clock reads/packet " << std::fixed << std::setprecision(3)
+                << double(clockReads) / double(packets)
+                << " ns/packet " << std::setprecision(1)
+                << double((stop - start).getNsec()) / double(packets) << std::endl;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   try
+   {
+      runLoop("handler reads clock, precise", CFdWaiter::EClockMode::precise, true);
+      runLoop("handler uses now(), precise", CFdWaiter::EClockMode::precise, false);
+      runLoop("handler uses now(), coarse", CFdWaiter::EClockMode::coarse, false);
+   }
+   catch(std::runtime_error &re)
+   {
+      std::cout << re.what() << std::endl;
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchFec.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 1, 2021, 8:45 AM
+ */
+
+// Measures the cost of the XOR parity FEC and what it does for the delivery latency.
+// The encoding cost is measured per XOR kernel and for the whole CFecEncoder, and expressed as
+// CPU time per gigabit of payload.
+// The latency is simulated with a real CRmdgpReceiver. The sender sends 100000 datagrams per
+// second over a link with a one way delay of 100us and 1% random loss, in both directions.
+// A loss is found when the next datagram arrives, the receiver NAKs at once and the repair
+// arrives a round trip later; a lost repair is asked for again a round trip after that.
+// With FEC the sender follows every block with a parity datagram, which can be lost too.
+// Reported are the percentiles of the time from sending to in order delivery.
+
+#include "benchmarkHelper.h"
+#include "../rmdgpLib/CFecEncoder.h"
+#include "../rmdgpLib/CRmdgpReceiver.h"
+#include "../rmdgpLib/CXorKernel.h"
+#include "../socketLib/CLatencyHistogram.h"
+#include "../socketLib/CSocketAddress.h"
+#include "../socketLib/CUdpMulticastReceiver.h"
+#include <memory>
+#include <queue>
+#include <string.h>
+#include <vector>
+
+namespace {
+   /// \brief a small and fast pseudo random generator (xorshift64)
+   class CRandom {
+   public:
+      CRandom(uint64_t seed) : state(seed) {}
+      uint64_t next() { state ^= state << 13; state ^= state >> 7; state ^= state << 17; return state; }
+      bool chance(double probability) { return double(next() >> 11) * 0x1.0p-53 < probability; }
+   private:
+      uint64_t state;
+   };
+
+   const size_t payloadSize = 1200;
+   const double bitsPerGigabit = 1e9;
+   const uint32_t sessionId = 1;
+   const uint32_t streamId = 1;
+   const size_t nbrDatagrams = 500000;
+   const CNanoTime interval = CNanoTime::fromUsec(10);
+   const CNanoTime oneWay = CNanoTime::fromUsec(100);
+   const double lossRate = 0.01;
+
+   /// \brief prints the CPU time per gigabit of payload for a cost per datagram
+   void printPerGigabit(double nsecPerDatagram)
+   {
+      const double datagramsPerGigabit = bitsPerGigabit / 8 / payloadSize;
+      std::cout << "   = " << nsecPerDatagram * datagramsPerGigabit / 1e6
+                << " ms CPU per Gbit" << std::endl;
+   }
+
+   void measureEncoding()
+   {
+      const size_t iterations = 2000000;
+      std::vector<uint8_t> payload(payloadSize, 0x5a), target(payloadSize);
+      const CXorKernel::EKernel kernels[] = { CXorKernel::EKernel::scalar,
+                                              CXorKernel::EKernel::sse2,
+                                              CXorKernel::EKernel::avx2 };
+
+      for(CXorKernel::EKernel kernel : kernels)
+      {
+         if(!CXorKernel::isSupported(kernel))
+            continue;
+         const double nsec = measure(std::string("xorInto ") + CXorKernel::getName(kernel) +
+                                     " 1200 bytes", iterations, [&](size_t i)
+               { CXorKernel::xorInto(kernel, target.data(), payload.data(), payloadSize);
+                 doNotOptimize(target[0]); });
+         printPerGigabit(nsec);
+      }
+      std::cout << "CFecEncoder uses " << CXorKernel::getName(CXorKernel::getSelected())
+                << std::endl;
+      for(size_t blockSize : { 4, 8, 16 })
+      {
+         CFecEncoder encoder(blockSize, payloadSize);
+         size_t length;
+         const double nsec = measure("CFecEncoder k=" + std::to_string(blockSize) +
+                                     " per data datagram", iterations, [&](size_t i)
+               {
+                  encoder.add(i, payload.data(), payloadSize);
+                  if(encoder.isComplete())
+                  {
+                     encoder.finish(sessionId, streamId);
+                     const uint8_t *parity = encoder.getParity(0, length);
+                     doNotOptimize(parity);
+                  }
+               });
+         printPerGigabit(nsec);
+      }
+   }
+
+   /// \brief a datagram on its way to the receiver
+   struct SArrival {
+      CNanoTime time;
+      uint64_t sequence;
+      CNanoTime sent;                          ///< of the original, for the latency
+      std::shared_ptr<std::vector<uint8_t>> parity;   ///< set for a parity datagram
+
+      bool operator>(const SArrival &other) const { return time > other.time; }
+   };
+
+   /// \param blockSize the FEC block size, 0 for no FEC
+   void simulateLatency(size_t blockSize)
+   {
+      CRandom random(0x9e3779b97f4a7c15);
+      std::unique_ptr<CFecEncoder> encoder;
+      CRmdgpReceiver receiver(std::make_shared<CUdpMulticastReceiver>(),
+                              CSocketAddress("127.0.0.1", 7890), streamId);
+      std::priority_queue<SArrival, std::vector<SArrival>, std::greater<SArrival>> arrivals;
+      std::vector<CNanoTime> sentTimes(nbrDatagrams);
+      std::vector<bool> nakked(nbrDatagrams);
+      SReceivedDatagram ready[64];
+      CLatencyHistogram histogram;
+      uint8_t payload[payloadSize] = { 0 };
+      uint64_t sentDatagrams = 0;
+
+      // the simulation sends nothing back, the ACKs are not needed
+      receiver.setAckPolicy(UINT32_MAX, CNanoTime::fromSec(1000));
+      if(blockSize > 0)
+      {
+         encoder.reset(new CFecEncoder(blockSize, payloadSize));
+         receiver.enableFec();
+      }
+
+      const CNanoTime start = CNanoTime::fromSec(1000);
+      for(uint64_t sequence = 0; sequence < nbrDatagrams; sequence++)
+      {
+         const CNanoTime sent = start + interval * int64_t(sequence);
+         sentTimes[sequence] = sent;
+         sentDatagrams++;
+         if(!random.chance(lossRate))
+            arrivals.push({ sent + oneWay, sequence, sent, nullptr });
+         if(!encoder)
+            continue;
+         encoder->add(sequence, payload, payloadSize);
+         if(encoder->isComplete())
+         {
+            size_t length;
+            encoder->finish(sessionId, streamId);
+            const uint8_t *parity = encoder->getParity(0, length);
+            sentDatagrams++;
+            // it leaves right after the last datagram of the block
+            if(!random.chance(lossRate))
+               arrivals.push({ sent + oneWay + interval / 10, sequence, sent,
+                               std::make_shared<std::vector<uint8_t>>(parity, parity + length) });
+         }
+      }
+
+      while(!arrivals.empty())
+      {
+         const SArrival arrival = arrivals.top();
+         arrivals.pop();
+         const uint32_t handle = receiver.getDatagramPool().acquire();
+         uint8_t *datagram = receiver.getDatagramPool().getBuffer(handle);
+         size_t length;
+         if(arrival.parity)
+         {
+            length = arrival.parity->size();
+            memcpy(datagram, arrival.parity->data(), length);
+         }
+         else
+         {
+            CRmdgpHeaderBuilder builder(datagram);
+            builder.setType(ERmdgpPacketType::data).setPayloadLength(uint16_t(payloadSize))
+                   .setSessionId(sessionId).setStreamId(streamId).setSequence(arrival.sequence);
+            if(encoder)
+               builder.setFlags(rmdgpFlagFec).setFecPosition(uint8_t(blockSize),
+                                                   uint8_t(arrival.sequence % blockSize));
+            memset(datagram + CRmdgpHeader::size, 0, payloadSize);
+            length = CRmdgpHeader::size + payloadSize;
+         }
+
+         const uint64_t expected = receiver.getLossTracker().getNextExpected();
+         size_t count = receiver.processDatagram(handle, length, ready, 64, arrival.time);
+         do
+         {
+            for(size_t i = 0; i < count; i++)
+            {
+               histogram.record(arrival.time - sentTimes[ready[i].sequence]);
+               receiver.release(ready[i]);
+            }
+         } while((count = receiver.getReady(ready, 64)) > 0);
+
+         // the NAK of a new gap goes out now, of a lost repair a round trip later. The NAK
+         // can be lost as well as the repair.
+         const uint64_t nextExpected = receiver.getLossTracker().getNextExpected();
+         for(uint64_t sequence = expected; sequence < nextExpected && sequence < nbrDatagrams;
+             sequence++)
+         {
+            if(!receiver.getLossTracker().isMissing(sequence))
+               continue;
+            CNanoTime repair = arrival.time + oneWay * 2;
+            while(random.chance(lossRate) || random.chance(lossRate))
+               repair += oneWay * 2;
+            arrivals.push({ repair, sequence, sentTimes[sequence], nullptr });
+            sentDatagrams++;
+         }
+      }
+
+      std::cout << (blockSize ? "FEC k=" + std::to_string(blockSize) : std::string("no FEC"))
+                << ": " << sentDatagrams - nbrDatagrams << " extra datagrams, "
+                << (receiver.getFecDecoder() ? receiver.getFecDecoder()->getRecoveredCount() : 0)
+                << " recovered, latency p50 " << histogram.getValueAtPercentile(50.0).getUsec()
+                << "us p99 " << histogram.getValueAtPercentile(99.0).getUsec()
+                << "us p99.9 " << histogram.getValueAtPercentile(99.9).getUsec()
+                << "us max " << histogram.getMax().getUsec() << "us" << std::endl;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   measureEncoding();
+
+   std::cout << nbrDatagrams << " datagrams every " << interval.getUsec() << "us, one way "
+             << oneWay.getUsec() << "us, " << lossRate * 100 << "% loss" << std::endl;
+   simulateLatency(0);
+   for(size_t blockSize : { 4, 8, 16, 32 })
+      simulateLatency(blockSize);
+   return 0;
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchFecAdaptive.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 3, 2021, 2:40 PM
+ */
+
+// Simulates what the loss adaptive FEC of CFecController does for the bandwidth overhead and
+// the number of NAKs while the loss rate of the network changes.
+// The sender sends 100000 datagrams per second to 20 receivers. The loss is random and goes
+// through phases; the worst receiver sees the loss of the phase, the others half of it.
+// Every 50ms each receiver reports the loss it saw in a real CReceiverTable, and the worst rate
+// goes into CFecController, like CRmdgpSender::handleTimer does. A new choice is applied at the
+// next block boundary. The Reed-Solomon parity rebuilds a block when at least k of its k + m
+// datagrams arrive; otherwise every lost data datagram has to be NAKed.
+// Compared are no FEC, two fixed configurations and the adaptive one. Reported per phase are
+// the parity overhead, the NAKs of all receivers and the distinct repairs, per 1000 datagrams.
+
+#include "benchmarkHelper.h"
+#include "../rmdgpLib/CFecController.h"
+#include "../rmdgpLib/CReceiverTable.h"
+#include <iomanip>
+#include <string>
+#include <vector>
+
+namespace {
+   /// \brief xorshift64, fast and good enough to draw losses
+   class CRandom {
+   public:
+      CRandom(uint64_t seed) : state(seed) {}
+      uint64_t next() { state ^= state << 13; state ^= state >> 7; state ^= state << 17; return state; }
+      bool chance(double probability) { return double(next() >> 11) * 0x1.0p-53 < probability; }
+   private:
+      uint64_t state;
+   };
+
+   struct SPhase {
+      const char *name;
+      double lossRate;
+   };
+
+   const SPhase phases[] = { { "0%", 0.0 }, { "0.5%", 0.005 }, { "2%", 0.02 }, { "5%", 0.05 },
+                             { "1%", 0.01 }, { "0%", 0.0 } };
+   const size_t nbrPhases = sizeof(phases) / sizeof(phases[0]);
+   const size_t nbrReceivers = 20;
+   const uint64_t datagramsPerPhase = 200000;
+   const CNanoTime interval = CNanoTime::fromUsec(10);
+   const uint64_t reportInterval = 5000;                   // 50ms of datagrams
+   const double targetResidualLoss = 1e-4;
+
+   /// \brief the counts of one phase
+   struct SCounts {
+      uint64_t data;
+      uint64_t parity;
+      uint64_t naks;
+      uint64_t repairs;
+   };
+
+   /// \param blockSize the fixed block size, 0 for no FEC
+   /// \param parityRows the fixed number of parity rows
+   /// \param adaptive true to let CFecController choose, blockSize and parityRows are ignored
+   void simulate(const std::string &name, size_t blockSize, size_t parityRows, bool adaptive)
+   {
+      CRandom random(0x9e3779b97f4a7c15);
+      CReceiverTable receivers(nbrReceivers);
+      CFecController controller(targetResidualLoss);
+      std::vector<uint64_t> lost(nbrReceivers, 0);
+      std::vector<uint8_t> lostInBlock(nbrReceivers * 32);
+      SCounts counts[nbrPhases] = {};
+      CNanoTime now = CNanoTime::fromSec(1000);
+      uint64_t sequence = 0;
+      uint64_t reported = 0;
+
+      for(uint32_t r = 0; r < nbrReceivers; r++)
+         receivers.add(r + 1, 0, now);
+      if(adaptive)
+         blockSize = parityRows = 0;
+
+      for(size_t phase = 0; phase < nbrPhases; phase++)
+      {
+         const uint64_t end = sequence + datagramsPerPhase;
+         while(sequence < end)
+         {
+            // a block, or a single datagram without FEC. The configuration is fixed per block.
+            const size_t k = blockSize ? blockSize : 1;
+            size_t blockRepairs = 0;
+            std::vector<bool> needed(k, false);
+            for(uint32_t r = 0; r < nbrReceivers; r++)
+            {
+               const double lossRate = phases[phase].lossRate * ((r == 0) ? 1.0 : 0.5);
+               size_t lostData = 0, lostTotal = 0;
+               for(size_t i = 0; i < k + (blockSize ? parityRows : 0); i++)
+               {
+                  if(!random.chance(lossRate))
+                     continue;
+                  lostTotal++;
+                  if(i < k)
+                     lostInBlock[r * 32 + lostData++] = uint8_t(i);
+               }
+               lost[r] += lostData;
+               if(blockSize && lostTotal <= parityRows)
+                  continue;
+               counts[phase].naks += lostData;
+               for(size_t i = 0; i < lostData; i++)
+                  needed[lostInBlock[r * 32 + i]] = true;
+            }
+            for(size_t i = 0; i < k; i++)
+               blockRepairs += needed[i] ? 1 : 0;
+            counts[phase].repairs += blockRepairs;
+            counts[phase].data += k;
+            counts[phase].parity += blockSize ? parityRows : 0;
+
+            const uint64_t previous = sequence;
+            sequence += k;
+            now += interval * int64_t(k);
+            if(previous / reportInterval == sequence / reportInterval)
+               continue;
+
+            // the ACKs with the loss of the last interval
+            for(uint32_t r = 0; r < nbrReceivers; r++)
+            {
+               receivers.reportLoss(r, double(lost[r]) / double(sequence - reported));
+               lost[r] = 0;
+            }
+            reported = sequence;
+            if(adaptive && controller.update(receivers.getWorstLossRate(), now))
+            {
+               // applied at the next block boundary, which is here
+               blockSize = controller.getBlockSize();
+               parityRows = controller.getParityRows();
+            }
+         }
+      }
+
+      std::cout << std::left << std::setw(14) << name << std::right;
+      for(size_t phase = 0; phase < nbrPhases; phase++)
+      {
+         const double perThousand = 1000.0 / double(counts[phase].data);
+         std::cout << std::fixed << std::setprecision(1) << std::setw(6)
+                   << 100.0 * double(counts[phase].parity) / double(counts[phase].data) << "%"
+                   << std::setw(7) << double(counts[phase].naks) * perThousand
+                   << std::setw(7) << double(counts[phase].repairs) * perThousand;
+      }
+      std::cout << std::endl;
+      if(adaptive)
+         std::cout << "adaptive: " << controller.getChangeCount() << " changes" << std::endl;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   std::cout << nbrReceivers << " receivers, " << datagramsPerPhase << " datagrams per phase, "
+             << "target residual loss " << targetResidualLoss << std::endl;
+   std::cout << "per phase: parity overhead, NAKs and repairs per 1000 datagrams" << std::endl;
+   std::cout << std::setw(14) << "";
+   for(size_t phase = 0; phase < nbrPhases; phase++)
+      std::cout << std::setw(20) << std::string("loss ") + phases[phase].name;
+   std::cout << std::endl;
+
+   simulate("no FEC", 0, 0, false);
+   simulate("fixed (8,1)", 8, 1, false);
+   simulate("fixed (16,4)", 16, 4, false);
+   simulate("adaptive", 0, 0, true);
+   return 0;
+}
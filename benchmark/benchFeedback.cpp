@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchFeedback.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 25, 2021, 9:40 PM
+ */
+
+// Simulates the ACK feedback of 10, 100 and 1000 receivers of one stream and reports the
+// feedback bytes per delivered megabyte. Every receiver loses 1% of the datagrams independently
+// and gets the repair a fixed number of datagrams later. A receiver sends an ACK after every
+// ackPacketThreshold received datagrams, or when ackInterval passed (the stream runs at a
+// simulated 50000 datagrams/s). The ACKs are fed to a real sender in batches of
+// CRmdgpSender::feedbackBatchSize, the time it takes to process them is measured as well.
+
+#include "benchmarkHelper.h"
+#include "../rmdgpLib/CAckPacket.h"
+#include "../rmdgpLib/CLossTracker.h"
+#include "../rmdgpLib/CRmdgpSender.h"
+#include "../socketLib/CUdpMulticastSender.h"
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace {
+   /// \brief a small and fast pseudo random generator (xorshift64)
+   class CRandom {
+   public:
+      CRandom(uint64_t seed) : state(seed) {}
+      uint64_t next() { state ^= state << 13; state ^= state >> 7; state ^= state << 17; return state; }
+      bool lose(unsigned perMille) { return next() % 1000 < perMille; }
+   private:
+      uint64_t state;
+   };
+
+   struct SRepair {
+      uint64_t sequence;
+      uint64_t due;
+   };
+
+   /// \brief a simulated receiver, it only tracks losses and builds ACKs
+   struct SReceiver {
+      SReceiver() : tracker(0), packetsSinceAck(0), lastTimedAck(0) {}
+      CLossTracker tracker;
+      std::deque<SRepair> repairs;
+      uint32_t packetsSinceAck;
+      uint64_t lastTimedAck;
+   };
+
+   const size_t payloadSize = 1400;
+   // IPv4 and UDP header of every feedback datagram
+   const size_t ipUdpOverhead = 28;
+   const uint64_t datagramsPerSecond = 50000;
+
+   void run(std::shared_ptr<CUdpMulticastSender> udpSender, size_t nbrReceivers,
+            uint64_t datagrams, uint32_t ackPacketThreshold, const CNanoTime &ackInterval)
+   {
+      const unsigned lossPerMille = 10;
+      const uint64_t repairDelay = 200;
+      const uint64_t timerTicks = ackInterval.getNsec() * datagramsPerSecond / CNanoTime::nsecInSec;
+      const unsigned int batchSize = CRmdgpSender::feedbackBatchSize;
+      CRandom random(0x1234567);
+      CRmdgpSender sender(udpSender, 1, 1, 65536, 65536 * (payloadSize + CRmdgpHeader::size),
+                          payloadSize);
+      std::vector<SReceiver> receivers(nbrReceivers);
+      std::vector<uint8_t> batch(batchSize * CRmdgpSender::maxFeedbackLength);
+      size_t batchLengths[batchSize];
+      unsigned int batchCount = 0;
+      uint64_t ackCount = 0, ackBytes = 0, sendFailed = 0;
+      uint8_t payload[payloadSize] = { 0 };
+      CNanoTime senderTime, start, stop;
+
+      // the sender handles the ACKs of one receive batch, then recomputes its window once
+      auto processBatch = [&]()
+      {
+         CClock::getMonotonicTime(start);
+         for(unsigned int i = 0; i < batchCount; i++)
+            sender.processAck(&batch[i * CRmdgpSender::maxFeedbackLength], batchLengths[i], start);
+         sender.updateWindow();
+         CClock::getMonotonicTime(stop);
+         senderTime += stop - start;
+         batchCount = 0;
+      };
+      auto sendAck = [&](size_t id, SReceiver &receiver)
+      {
+         uint8_t *datagram = &batch[batchCount * CRmdgpSender::maxFeedbackLength];
+         const CLossTracker::THoles &holes = receiver.tracker.getHoles();
+         CAckBuilder ack(datagram, CRmdgpSender::maxFeedbackLength, 1, 1, uint32_t(id),
+                         receiver.tracker.getFirstMissing());
+         for(CLossTracker::THoles::const_iterator hole = holes.begin(); hole != holes.end();
+             ++hole)
+         {
+            const CLossTracker::THoles::const_iterator nextHole = std::next(hole);
+            if(!ack.add({ hole->second, (nextHole != holes.end()) ? nextHole->first :
+                                        receiver.tracker.getNextExpected() }))
+               break;
+         }
+         batchLengths[batchCount] = ack.getLength();
+         ackBytes += ack.getLength() + ipUdpOverhead;
+         ackCount++;
+         receiver.packetsSinceAck = 0;
+         if(++batchCount == batchSize)
+            processBatch();
+      };
+      auto receive = [&](size_t id, SReceiver &receiver, uint64_t sequence)
+      {
+         receiver.tracker.receive(sequence);
+         if(++receiver.packetsSinceAck >= ackPacketThreshold)
+            sendAck(id, receiver);
+      };
+
+      for(uint64_t sequence = 0; sequence < datagrams; sequence++)
+      {
+         sendFailed += !sender.send(payload, payloadSize);
+         for(size_t id = 0; id < nbrReceivers; id++)
+         {
+            SReceiver &receiver = receivers[id];
+
+            if(random.lose(lossPerMille))
+               receiver.repairs.push_back({ sequence, sequence + repairDelay });
+            else
+               receive(id, receiver, sequence);
+
+            while(!receiver.repairs.empty() && receiver.repairs.front().due <= sequence)
+            {
+               const uint64_t repaired = receiver.repairs.front().sequence;
+               receiver.repairs.pop_front();
+               if(random.lose(lossPerMille))
+                  receiver.repairs.push_back({ repaired, sequence + repairDelay });
+               else
+                  receive(id, receiver, repaired);
+            }
+
+            // the timer, for receivers that didn't reach the packet threshold in time
+            if(sequence - receiver.lastTimedAck >= timerTicks)
+            {
+               receiver.lastTimedAck = sequence;
+               if(receiver.packetsSinceAck > 0)
+                  sendAck(id, receiver);
+            }
+         }
+      }
+      processBatch();
+
+      const double megabytes = double(datagrams * payloadSize) / 1e6;
+      std::cout << std::setw(5) << nbrReceivers << " receivers, ACK after " << std::setw(3)
+                << ackPacketThreshold << " datagrams or " << ackInterval.getMsec() << "ms: "
+                << std::fixed << std::setprecision(1)
+                << double(ackCount) / double(nbrReceivers) << " ACKs/receiver of "
+                << double(ackBytes) / double(ackCount) << " bytes, "
+                << double(ackBytes) / megabytes << " bytes/MB ("
+                << double(ackBytes) / megabytes / double(nbrReceivers) << " per receiver), sender "
+                << double(senderTime.getNsec()) / double(ackCount) << " ns/ACK, "
+                << double(senderTime.getNsec()) / megabytes / 1e3 << " us/MB";
+      if(sendFailed)
+         std::cout << ", window full " << sendFailed << " times";
+      std::cout << std::endl;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   const uint64_t datagrams = 100000;
+   // nobody listens, the datagrams only have to leave the sender
+   std::shared_ptr<CUdpMulticastSender> udpSender(new CUdpMulticastSender);
+   udpSender->open("127.0.0.1", 7890, "127.0.0.1");
+
+   std::cout << "one ACK per datagram would be "
+             << double(CRmdgpHeader::size + 1 + ipUdpOverhead) * 1e6 / double(payloadSize)
+             << " bytes/MB per receiver" << std::endl;
+   for(size_t nbrReceivers : { 10, 100, 1000 })
+   {
+      run(udpSender, nbrReceivers, datagrams, 64, CNanoTime::fromMsec(10));
+      run(udpSender, nbrReceivers, datagrams, 256, CNanoTime::fromMsec(10));
+   }
+   return 0;
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchFlowControl.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 27, 2021, 4:40 PM
+ */
+
+// Simulates 100 receivers of one stream, with simulated time in steps of 1ms. The sender wants
+// to send 50000 datagrams/s, the receivers acknowledge everything every step. At 200ms one
+// receiver becomes a straggler that only handles 2000 datagrams/s: the retransmission ring
+// fills up and the slowest receiver sets the pace. The minimum rate policy ejects it after the
+// grace period and the window recovers. The throughput and the window in use are printed
+// every 100ms.
+
+#include "benchmarkHelper.h"
+#include "../rmdgpLib/CAckPacket.h"
+#include "../rmdgpLib/CReceiverListener.h"
+#include "../rmdgpLib/CRmdgpSender.h"
+#include "../socketLib/CUdpMulticastSender.h"
+#include <memory>
+#include <vector>
+
+namespace {
+   const size_t payloadSize = 1000;
+   const size_t ringSize = 4096;
+   const size_t nbrReceivers = 100;
+   const uint32_t stragglerId = 42;
+   const uint64_t datagramsPerStep = 50;
+   const uint64_t stragglerPerStep = 2;
+   const CNanoTime step = CNanoTime::fromMsec(1);
+   const CNanoTime straggleFrom = CNanoTime::fromMsec(200);
+   const CNanoTime duration = CNanoTime::fromMsec(1500);
+   const CNanoTime reportInterval = CNanoTime::fromMsec(100);
+
+   /// \brief prints the ejections
+   class CEjectionPrinter : public CReceiverListener {
+   public:
+      CEjectionPrinter() : time() {}
+      void onReceiverEjected(uint32_t receiverId, double rate) override
+      {
+         std::cout << "  at " << time.getMsec() << "ms receiver " << receiverId
+                   << " ejected, goodput " << rate << " datagrams/s" << std::endl;
+      }
+      CNanoTime time;
+   };
+}
+
+int main(int argc, char** argv)
+{
+   // nobody listens, the datagrams only have to leave the sender
+   std::shared_ptr<CUdpMulticastSender> udpSender(new CUdpMulticastSender);
+   udpSender->open("127.0.0.1", 7890, "127.0.0.1");
+   std::shared_ptr<CEjectionPrinter> printer(new CEjectionPrinter);
+   CRmdgpSender sender(udpSender, 1, 1, ringSize, ringSize * (payloadSize + CRmdgpHeader::size),
+                       payloadSize);
+   uint8_t payload[payloadSize] = { 0 };
+   uint8_t datagram[CRmdgpSender::maxFeedbackLength];
+   uint64_t stragglerAcked = 0, sentInReport = 0;
+   CNanoTime checkTime, start, stop;
+   uint64_t checks = 0;
+
+   sender.setMinimumRate(5000.0, CNanoTime::fromMsec(100), CNanoTime::fromMsec(500));
+   sender.setReceiverListener(printer);
+   std::cout << "sender wants " << datagramsPerStep * 1000 << " datagrams/s, the straggler does "
+             << stragglerPerStep * 1000 << " from " << straggleFrom.getMsec()
+             << "ms, minimum rate 5000/s, interval 100ms, grace period 500ms" << std::endl;
+
+   // simulated CLOCK_MONOTONIC, far from zero like the real one
+   const CNanoTime base = CNanoTime::fromSec(1000);
+   for(CNanoTime time; time < duration; time += step)
+   {
+      const CNanoTime now = base + time;
+      printer->time = time;
+
+      for(uint64_t i = 0; i < datagramsPerStep; i++)
+         sentInReport += sender.send(payload, payloadSize);
+
+      const uint64_t next = sender.getNextSequence();
+      stragglerAcked = (time < straggleFrom) ? next :
+                       std::min(next, stragglerAcked + stragglerPerStep);
+      for(uint32_t id = 0; id < nbrReceivers; id++)
+      {
+         CAckBuilder ack(datagram, sizeof(datagram), 1, 1, id,
+                         (id == stragglerId) ? stragglerAcked : next);
+         sender.processAck(datagram, ack.getLength(), now);
+      }
+      sender.updateWindow();
+
+      CClock::getMonotonicTime(start);
+      sender.checkReceivers(now);
+      CClock::getMonotonicTime(stop);
+      checkTime += stop - start;
+      checks++;
+
+      if((time + step).getNsec() % reportInterval.getNsec() == 0)
+      {
+         const CRetransmissionRing &ring = sender.getRetransmissionRing();
+         std::cout << std::setw(6) << (time + step).getMsec() << "ms: " << std::setw(6)
+                   << sentInReport * CNanoTime::nsecInSec / reportInterval.getNsec()
+                   << " datagrams/s, window in use " << std::setw(4)
+                   << ring.getNextSequence() - ring.getOldestSequence() << "/" << ringSize
+                   << ", " << sender.getReceiverTable().getCount() << " receivers" << std::endl;
+         sentInReport = 0;
+      }
+   }
+   std::cout << "checkReceivers " << double(checkTime.getNsec()) / double(checks)
+             << " ns/call for " << nbrReceivers << " receivers" << std::endl;
+   return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchFragmentation.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 4, 2021, 4:50 PM
+ */
+
+// Measures the throughput of fragmentation and reassembly for messages of 64KB and 16MB.
+// The sender side is a real CRmdgpSender that sends over loopback, every message is
+// acknowledged right after it is sent, so the window stays open. The receiver side feeds the
+// fragment payloads to a CFragmentAssembler, once in order and once with the fragments
+// shuffled within windows of 64, like reordering on the network, and takes the messages.
+// Throughput is in message bytes per second.
+
+#include "benchmarkHelper.h"
+#include "../rmdgpLib/CFragmentAssembler.h"
+#include "../rmdgpLib/CFragmentHeader.h"
+#include "../rmdgpLib/CRmdgpSender.h"
+#include "../socketLib/CUdpMulticastSender.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace {
+   /// \brief xorshift64, fast and good enough to shuffle
+   class CRandom {
+   public:
+      CRandom(uint64_t seed) : state(seed) {}
+      uint64_t next() { state ^= state << 13; state ^= state >> 7; state ^= state << 17; return state; }
+   private:
+      uint64_t state;
+   };
+
+   const size_t payloadSize = CRmdgpSender::defaultMaxPayloadSize;
+   const size_t fragmentSize = payloadSize - CFragmentHeader::size;
+   const size_t shuffleWindow = 64;
+
+   double toGigabytes(size_t bytes, const CNanoTime &time)
+   {
+      return double(bytes) / double(time.getNsec());
+   }
+
+   void measureSend(const std::shared_ptr<CUdpMulticastSender> &udpSender, size_t messageSize,
+                    size_t nbrMessages)
+   {
+      const size_t fragments = (messageSize + fragmentSize - 1) / fragmentSize;
+      CRmdgpSender sender(udpSender, 1, 1, fragments, fragments * (CRmdgpHeader::size +
+                          payloadSize));
+      std::vector<uint8_t> message(messageSize, 0x5a);
+      CNanoTime start, stop;
+
+      CClock::getMonotonicTime(start);
+      for(size_t i = 0; i < nbrMessages; i++)
+      {
+         if(!sender.sendFragmented(message.data(), message.size()))
+            std::cout << "message " << i << " doesn't fit" << std::endl;
+         sender.acknowledge(sender.getNextSequence());
+      }
+      CClock::getMonotonicTime(stop);
+      std::cout << std::left << std::setw(50) << "sendFragmented " + std::to_string(messageSize >> 10)
+                   + "KB" << std::right << std::setw(10) << std::fixed << std::setprecision(2)
+                << toGigabytes(messageSize * nbrMessages, stop - start) << " GB/s, "
+                << fragments << " fragments" << std::endl;
+   }
+
+   void measureReassembly(size_t messageSize, size_t nbrMessages, bool shuffle)
+   {
+      const size_t count = (messageSize + fragmentSize - 1) / fragmentSize;
+      std::vector<std::vector<uint8_t>> fragments(count);
+      std::vector<size_t> order(count);
+      CFragmentAssembler assembler(messageSize, 4 * messageSize);
+      CFragmentAssembler::SMessage result;
+      CRandom random(0x9e3779b97f4a7c15);
+      CNanoTime start, stop;
+      size_t checksum = 0;
+
+      for(size_t index = 0; index < count; index++)
+      {
+         const size_t offset = index * fragmentSize;
+         const size_t length = std::min(fragmentSize, messageSize - offset);
+         fragments[index].assign(CFragmentHeader::size + length, uint8_t(index));
+         CFragmentHeader::store(fragments[index].data(), uint32_t(messageSize), uint32_t(offset),
+                                uint32_t(index), uint32_t(count));
+         order[index] = index;
+      }
+      if(shuffle)
+      {
+         for(size_t begin = 0; begin < count; begin += shuffleWindow)
+         {
+            const size_t end = std::min(count, begin + shuffleWindow);
+            for(size_t i = end - 1; i > begin; i--)
+               std::swap(order[i], order[begin + random.next() % (i - begin + 1)]);
+         }
+      }
+
+      CClock::getMonotonicTime(start);
+      for(size_t i = 0; i < nbrMessages; i++)
+      {
+         const uint64_t firstSequence = uint64_t(i) * count;
+         for(size_t index : order)
+            assembler.add(firstSequence + index, fragments[index].data(),
+                          fragments[index].size());
+         while(assembler.next(result))
+            checksum += result.data[result.length - 1];
+      }
+      CClock::getMonotonicTime(stop);
+      doNotOptimize(checksum);
+      std::cout << std::left << std::setw(50) << "CFragmentAssembler " +
+                   std::to_string(messageSize >> 10) + "KB " + (shuffle ? "shuffled" : "in order")
+                << std::right << std::setw(10) << std::fixed << std::setprecision(2)
+                << toGigabytes(messageSize * nbrMessages, stop - start) << " GB/s" << std::endl;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   // nobody listens, the datagrams only have to leave the sender
+   std::shared_ptr<CUdpMulticastSender> udpSender(new CUdpMulticastSender);
+   udpSender->open("127.0.0.1", 7890, "127.0.0.1");
+
+   measureSend(udpSender, 64 << 10, 2000);
+   measureSend(udpSender, 16 << 20, 8);
+   for(bool shuffle : { false, true })
+   {
+      measureReassembly(64 << 10, 20000, shuffle);
+      measureReassembly(16 << 20, 40, shuffle);
+   }
+   return 0;
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchHeader.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 14, 2021, 9:05 PM
+ */
+
+// Measures building, validating and parsing the RMDGP header in place.
+
+#include "benchmarkHelper.h"
+#include "../rmdgpLib/CRmdgpHeader.h"
+#include <vector>
+
+int main(int argc, char** argv)
+{
+   const size_t iterations = 50000000;
+   const size_t nbrDatagrams = 1024;
+   const size_t payloadLength = 1000;
+   const size_t datagramLength = CRmdgpHeader::size + payloadLength;
+   std::vector<uint8_t> datagrams(nbrDatagrams * datagramLength);
+
+   measure("CRmdgpHeaderBuilder (all fields)", iterations, [&](size_t i)
+         {
+            uint8_t *datagram = &datagrams[(i % nbrDatagrams) * datagramLength];
+            CRmdgpHeaderBuilder(datagram).setType(ERmdgpPacketType::data)
+                     .setPayloadLength(payloadLength).setSessionId(0x12345678)
+                     .setStreamId(uint32_t(i & 3)).setSequence(i);
+            doNotOptimize(*datagram);
+         });
+
+   ERmdgpValidation validation = ERmdgpValidation::valid;
+   measure("CRmdgpHeaderView::validate", iterations, [&](size_t i)
+         {
+            validation = CRmdgpHeaderView::validate(&datagrams[(i % nbrDatagrams) * datagramLength],
+                                                    datagramLength);
+            doNotOptimize(validation);
+         });
+
+   uint64_t sum = 0;
+   measure("CRmdgpHeaderView (validate and read all fields)", iterations, [&](size_t i)
+         {
+            const uint8_t *datagram = &datagrams[(i % nbrDatagrams) * datagramLength];
+            if(CRmdgpHeaderView::validate(datagram, datagramLength) == ERmdgpValidation::valid)
+            {
+               const CRmdgpHeaderView header(datagram);
+               sum += header.getSequence() + header.getSessionId() + header.getStreamId() +
+                      header.getFlags() + uint8_t(header.getType()) + header.getPayloadLength();
+            }
+            doNotOptimize(sum);
+         });
+
+   // a random byte stream is rejected by the first compares
+   std::vector<uint8_t> garbage(nbrDatagrams * datagramLength);
+   for(size_t i = 0; i < garbage.size(); i++)
+      garbage[i] = uint8_t((i * 7919) >> 3);
+   size_t rejected = 0;
+   measure("CRmdgpHeaderView::validate (malformed)", iterations, [&](size_t i)
+         {
+            rejected += CRmdgpHeaderView::validate(&garbage[(i % nbrDatagrams) * datagramLength],
+                                                   datagramLength - (i & 1)) != ERmdgpValidation::valid;
+            doNotOptimize(rejected);
+         });
+
+   return 0;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchHistogram.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 13, 2021, 11:30 AM
+ */
+
+// Measures the cost of recording in CLatencyHistogram and CLatencyRecorder, and of the queries
+// and snapshots that are done off the hot path.
+
+#include "benchmarkHelper.h"
+#include "../socketLib/CLatencyHistogram.h"
+#include "../socketLib/CLatencyRecorder.h"
+#include "../socketLib/CNanoTime.h"
+#include <vector>
+#include <random>
+
+int main(int argc, char** argv)
+{
+   const size_t iterations = 20000000;
+   const size_t nbrDurations = 4096;
+   std::vector<CNanoTime> durations(nbrDurations);
+   std::mt19937_64 generator(42);
+   // latencies spread over 5 decades: 1us .. 100ms
+   std::lognormal_distribution<double> distribution(10.0, 2.0);
+
+   for(CNanoTime &duration : durations)
+      duration = CNanoTime::fromNsec(int64_t(distribution(generator)));
+
+   CLatencyHistogram histogram;
+   measure("CLatencyHistogram::record", iterations, [&](size_t i)
+         { histogram.record(durations[i % nbrDurations]); });
+
+   CLatencyRecorder recorder;
+   measure("CLatencyRecorder::record", iterations, [&](size_t i)
+         { recorder.record(durations[i % nbrDurations]); });
+
+   CNanoTime percentile;
+   measure("CLatencyHistogram::getValueAtPercentile(99.99)", 10000, [&](size_t i)
+         { percentile = histogram.getValueAtPercentile(99.99); doNotOptimize(percentile); });
+
+   measure("CLatencyRecorder::snapshot", 10000, [&](size_t i)
+         { CLatencyHistogram snapshot = recorder.snapshot(); doNotOptimize(snapshot); });
+
+   CLatencyHistogram merged;
+   measure("CLatencyHistogram::merge", 10000, [&](size_t i)
+         { merged.merge(histogram); });
+
+   std::cout << "memory per histogram " << CLatencyHistogram::countsLength * sizeof(uint64_t)
+             << " bytes" << std::endl << "recorded: ";
+   histogram.printPercentiles(std::cout);
+   std::cout << std::endl;
+
+   return 0;
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchJournal.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 6, 2021, 2:15 PM
+ */
+
+// Measures the sender journal: the cost of an append on the send path, with a flush every
+// flushInterval datagrams like the timer of a sender does, the cost of a lookup for a repair
+// far behind the retransmission ring, and the time a restarted sender needs to recover a full
+// journal. Usage: benchJournal [directory [megabytes]], by default a new directory in /tmp and
+// 1024 MB. The journal is removed afterwards.
+
+#include "benchmarkHelper.h"
+#include "../rmdgpLib/CSenderJournal.h"
+#include "../socketLib/CMappedFile.h"
+#include <algorithm>
+#include <memory>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+   const size_t datagramLength = 1400;
+   const size_t segmentSize = CSenderJournal::defaultSegmentSize;
+   // a sender at 1M datagrams per second with a 1ms timer
+   const size_t flushInterval = 1000;
+
+   CNanoTime now()
+   {
+      CNanoTime time;
+      return CClock::getMonotonicTime(time);
+   }
+}
+
+int main(int argc, char** argv)
+{
+   char name[] = "/tmp/benchJournal-XXXXXX";
+   const std::string directory = (argc > 1) ? argv[1] : mkdtemp(name);
+   const size_t megabytes = (argc > 2) ? size_t(atol(argv[2])) : 1024;
+   const size_t maxSegments = std::max<size_t>(1, (megabytes << 20) / segmentSize);
+   std::vector<uint8_t> datagram(datagramLength, 0x55);
+   std::vector<int64_t> appendTimes;
+   uint64_t sequence = 0;
+
+   std::cout << "journal of " << maxSegments << " segments of " << (segmentSize >> 20)
+             << " MB in " << directory << ", datagrams of " << datagramLength << " bytes"
+             << std::endl;
+   {
+      std::unique_ptr<CSenderJournal> journal(new CSenderJournal(directory, segmentSize,
+                                                                 maxSegments));
+      // like setJournal does, so the first segment is made in advance
+      journal->flush();
+      const CNanoTime fillStart = now();
+      CNanoTime flushTime;
+      uint64_t perSegment = 0;
+      // fill all segments
+      while(perSegment == 0 || journal->getCount() < perSegment * maxSegments)
+      {
+         memcpy(datagram.data(), &sequence, sizeof(sequence));
+         const CNanoTime start = now();
+         journal->append(sequence++, datagram.data(), datagram.size());
+         appendTimes.push_back((now() - start).getNsec());
+         if(sequence % flushInterval == 0)
+         {
+            const CNanoTime flushStart = now();
+            journal->flush();
+            flushTime += now() - flushStart;
+         }
+         if(perSegment == 0 && journal->getSegmentCount() == 2)
+            perSegment = journal->getCount() - 1;
+      }
+      const CNanoTime fillTime = now() - fillStart;
+
+      std::sort(appendTimes.begin(), appendTimes.end());
+      std::cout << "append " << appendTimes.size() << " datagrams: average "
+                << fillTime.getNsec() / int64_t(appendTimes.size()) << " ns including flush,"
+                << " median " << appendTimes[appendTimes.size() / 2] << " ns, 99.99% "
+                << appendTimes[appendTimes.size() * 9999 / 10000] << " ns, max "
+                << appendTimes.back() << " ns (clock reading included)" << std::endl;
+      std::cout << "flush every " << flushInterval << " datagrams: "
+                << flushTime.getNsec() / int64_t(appendTimes.size() / flushInterval)
+                << " ns per flush" << std::endl;
+      const CNanoTime syncStart = now();
+      journal->flush(true);
+      std::cout << "flush(true) at the end: " << (now() - syncStart).getMsec() << " ms"
+                << std::endl;
+
+      const uint64_t oldest = journal->getOldestSequence();
+      const uint64_t count = journal->getCount();
+      size_t length = 0;
+      measure("CSenderJournal::lookup random", 10000000, [&](size_t i)
+            { const uint8_t *found = journal->lookup(oldest + (i * 7919) % count, length);
+              doNotOptimize(found); });
+   }
+
+   // a restart: map the segments and find their ends
+   const CNanoTime recoverStart = now();
+   CSenderJournal journal(directory, segmentSize, maxSegments);
+   size_t length = 0;
+   const uint8_t *last = journal.lookup(journal.getNextSequence() - 1, length);
+   const CNanoTime recoverTime = now() - recoverStart;
+   uint64_t lastSequence;
+   memcpy(&lastSequence, last, sizeof(lastSequence));
+   std::cout << "recover " << journal.getRecoveredCount() << " datagrams in "
+             << journal.getSegmentCount() << " segments: " << recoverTime.getUsec() << " us, "
+             << ((lastSequence == sequence - 1) ? "continues at " : "WRONG, continues at ")
+             << journal.getNextSequence() << std::endl;
+   const CNanoTime prepareStart = now();
+   journal.flush();
+   std::cout << "first flush after the restart, makes the next segment when needed: "
+             << (now() - prepareStart).getUsec() << " us" << std::endl;
+
+   for(const std::string &file : CMappedFile::list(directory, CSenderJournal::filePrefix))
+      unlink((directory + "/" + file).c_str());
+   if(argc < 2)
+      rmdir(directory.c_str());
+   return 0;
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchLossTracker.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 20, 2021, 9:30 PM
+ */
+
+// Measures the loss tracker and NAK generation at 10% random loss. Lost datagrams are repaired
+// (and can be lost again) after a fixed number of datagrams, the repair delay. A longer delay
+// gives more outstanding holes. Every nakInterval datagrams all holes are packed in NAKs.
+
+#include "benchmarkHelper.h"
+#include "../rmdgpLib/CLossTracker.h"
+#include "../rmdgpLib/CNakPacket.h"
+#include <deque>
+#include <vector>
+
+namespace {
+   /// \brief a small and fast pseudo random generator (xorshift64)
+   class CRandom {
+   public:
+      CRandom(uint64_t seed) : state(seed) {}
+      uint64_t next() { state ^= state << 13; state ^= state >> 7; state ^= state << 17; return state; }
+      bool lose(unsigned percent) { return next() % 100 < percent; }
+   private:
+      uint64_t state;
+   };
+
+   struct SRepair {
+      uint64_t sequence;
+      uint64_t due;
+   };
+
+   void run(uint64_t datagrams, uint64_t repairDelay, uint64_t nakInterval)
+   {
+      const unsigned lossPercent = 10;
+      CRandom random(0x1234567);
+      CLossTracker tracker(0);
+      std::deque<SRepair> repairs;
+      std::vector<uint8_t> nak(1472);
+      uint64_t received = 0, nakDatagrams = 0, nakRanges = 0, nakBytes = 0;
+      size_t maxHoles = 0;
+      CNanoTime start, stop;
+
+      CClock::getMonotonicTime(start);
+      for(uint64_t sequence = 0; sequence < datagrams; sequence++)
+      {
+         if(random.lose(lossPercent))
+            repairs.push_back({ sequence, sequence + repairDelay });
+         else
+         {
+            tracker.receive(sequence);
+            received++;
+         }
+
+         while(!repairs.empty() && repairs.front().due <= sequence)
+         {
+            const uint64_t repaired = repairs.front().sequence;
+            repairs.pop_front();
+            if(random.lose(lossPercent))
+               repairs.push_back({ repaired, sequence + repairDelay });
+            else
+            {
+               tracker.receive(repaired);
+               received++;
+            }
+         }
+
+         if(sequence % nakInterval == 0)
+         {
+            CLossTracker::THoles::const_iterator hole = tracker.getHoles().begin();
+            while(hole != tracker.getHoles().end())
+            {
+               CNakBuilder builder(nak.data(), nak.size(), 1, 1, 1);
+               while(hole != tracker.getHoles().end() && builder.add({ hole->first, hole->second }))
+                  ++hole;
+               nakDatagrams++;
+               nakRanges += builder.getRangeCount();
+               nakBytes += builder.getLength();
+            }
+            if(tracker.getHoleCount() > maxHoles)
+               maxHoles = tracker.getHoleCount();
+         }
+      }
+      CClock::getMonotonicTime(stop);
+
+      const double seconds = double((stop - start).getNsec()) / double(CNanoTime::nsecInSec);
+      std::cout << "repair delay " << std::setw(7) << repairDelay << ": "
+                << std::setprecision(1) << std::fixed << double(received) / seconds / 1e6
+                << " M datagrams/s, max holes " << maxHoles << ", "
+                << nakDatagrams << " NAKs with " << std::setprecision(1)
+                << double(nakRanges) / double(nakDatagrams ? nakDatagrams : 1) << " ranges, "
+                << double(nakBytes - nakDatagrams * CRmdgpHeader::size) /
+                   double(nakRanges ? nakRanges : 1) << " bytes/range" << std::endl;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   const uint64_t datagrams = 10000000;
+
+   // a repair after a LAN round trip, and one far behind with ~300000 holes open
+   run(datagrams, 1000, 10000);
+   run(datagrams, 100000, 100000);
+   run(datagrams, 3000000, 1000000);
+   return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchNakSuppression.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 28, 2021, 5:20 PM
+ */
+
+// Simulates the NAKs of 10 to 1000 receivers that all lose the same datagram on a shared link,
+// with one CNakScheduler per receiver. Time advances in steps of 1/100 round trip time. Every
+// host is half a round trip time from every other host. A receiver detects the loss within 0.1
+// round trip time. Its NAK reaches the sender and the other receivers half a round trip time
+// later. The sender multicasts the repair when the first NAK arrives, and the repair takes
+// another half round trip time. Compared are no suppression (every receiver NAKs at once), the
+// uniform delay of the original SRM (lambda 0) and the default exponential delay. Reported
+// are the NAKs per lost datagram and the repair latency in round trip times.
+
+#include "benchmarkHelper.h"
+#include "../rmdgpLib/CNakScheduler.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace {
+   /// \brief a small and fast pseudo random generator (xorshift64)
+   class CRandom {
+   public:
+      CRandom(uint64_t seed) : state(seed) {}
+      uint64_t next() { state ^= state << 13; state ^= state >> 7; state ^= state << 17; return state; }
+   private:
+      uint64_t state;
+   };
+
+   const CNanoTime rtt = CNanoTime::fromMsec(1);
+   const CNanoTime step = rtt / 100;
+   const CNanoTime oneWay = rtt / 2;
+   const int lossEvents = 100;
+
+   struct SResult {
+      double naksPerLoss;
+      double latency;               ///< in round trip times
+   };
+
+   /// \param suppression false: every receiver NAKs when it detects the loss
+   SResult simulate(size_t nbrReceivers, bool suppression, double lambda, CRandom &random)
+   {
+      const uint64_t lost = 1000;
+      uint64_t naks = 0;
+      CNanoTime latencySum;
+      std::vector<SSequenceRange> due;
+
+      for(int event = 0; event < lossEvents; event++)
+      {
+         std::vector<std::unique_ptr<CNakScheduler>> schedulers(nbrReceivers);
+         std::vector<CNanoTime> detect(nbrReceivers);
+         std::vector<CNanoTime> nakArrivals;
+         CNanoTime repairArrival = CNanoTime::fromNsec(INT64_MAX);
+
+         for(size_t i = 0; i < nbrReceivers; i++)
+         {
+            schedulers[i].reset(new CNakScheduler(uint32_t(random.next())));
+            schedulers[i]->setRtt(rtt);
+            schedulers[i]->setBackoff(CNakScheduler::defaultC1, CNakScheduler::defaultC2, lambda);
+            detect[i] = CNanoTime::fromNsec(int64_t(random.next() % uint64_t(rtt.getNsec() / 10)));
+         }
+
+         CNanoTime now;
+         for(; now < repairArrival; now += step)
+         {
+            // the NAKs of the previous steps that arrive now
+            size_t arrived = 0;
+            while(arrived < nakArrivals.size() && nakArrivals[arrived] <= now)
+               arrived++;
+            if(arrived > 0)
+            {
+               // the first one that reaches the sender triggers the repair
+               repairArrival = std::min(repairArrival, nakArrivals[0] + oneWay);
+               for(size_t i = 0; i < nbrReceivers && suppression; i++)
+                  for(size_t n = 0; n < arrived; n++)
+                     schedulers[i]->suppress({ lost, lost + 1 });
+               nakArrivals.erase(nakArrivals.begin(), nakArrivals.begin() + arrived);
+            }
+
+            for(size_t i = 0; i < nbrReceivers; i++)
+            {
+               if(detect[i] <= now && detect[i] > now - step)
+               {
+                  if(!suppression)
+                  {
+                     naks++;
+                     nakArrivals.push_back(now + oneWay);
+                     continue;
+                  }
+                  schedulers[i]->add({ lost, lost + 1 });
+               }
+               if(suppression && schedulers[i]->takeDue(now, due) > 0)
+               {
+                  naks++;
+                  nakArrivals.push_back(now + oneWay);
+               }
+            }
+         }
+         latencySum += now;
+      }
+      return { double(naks) / lossEvents,
+               double(latencySum.getNsec()) / lossEvents / double(rtt.getNsec()) };
+   }
+}
+
+int main(int argc, char** argv)
+{
+   CRandom random(0x1234567);
+
+   std::cout << "receivers | no suppression    | uniform (SRM)     | exponential (lambda "
+             << CNakScheduler::defaultLambda << ")" << std::endl
+             << "          | NAKs/loss latency | NAKs/loss latency | NAKs/loss latency" << std::endl;
+   for(size_t nbrReceivers : { 10, 30, 100, 300, 1000 })
+   {
+      const SResult none = simulate(nbrReceivers, false, 0.0, random);
+      const SResult uniform = simulate(nbrReceivers, true, 0.0, random);
+      const SResult exponential = simulate(nbrReceivers, true, CNakScheduler::defaultLambda,
+                                           random);
+      std::cout << std::setw(9) << nbrReceivers << std::fixed << std::setprecision(1);
+      for(const SResult &result : { none, uniform, exponential })
+         std::cout << " | " << std::setw(9) << result.naksPerLoss << " " << std::setw(5)
+                   << result.latency << "rtt";
+      std::cout << std::endl;
+   }
+   return 0;
+}
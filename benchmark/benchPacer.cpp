@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchPacer.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 5, 2021, 3:40 PM
+ */
+
+// Measures how well CPacer holds its rate from 10Mbit/s to 10Gbit/s, and how evenly it spaces
+// the datagrams. The event loop busy waits on CTscClock until getNextSendTime and keeps the
+// queue full with 1472 byte datagrams, for one second per rate. The micro burst is 20us of data
+// but at least one datagram.
+// "dry" replaces sendmmsg by a proxy that only counts, so it shows the pacer itself; "socket"
+// really sends to the loopback interface, where the system calls limit the top rates.
+// Reported are the achieved rate and its error, the datagrams per sendmmsg call, and the jitter:
+// how much the gap between two micro bursts differs from the time that the bytes of the first
+// take at the rate.
+
+#include "benchmarkHelper.h"
+#include "../socketLib/CLatencyHistogram.h"
+#include "../socketLib/CPacer.h"
+#include "../socketLib/CSocketProxy.h"
+#include "../socketLib/CTscClock.h"
+#include "../socketLib/CUdpMulticastSender.h"
+#include <iomanip>
+#include <memory>
+#include <string>
+
+namespace {
+   /// \brief acts like every datagram is sent
+   class CDrySendProxy : public CSocketProxy {
+   public:
+      virtual int sendmmsg(int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags) override
+      {
+         return int(vlen);
+      }
+   };
+
+   const size_t datagramSize = CPacer::defaultMaxDatagramSize;
+   const CNanoTime duration = CNanoTime::fromSec(1);
+   const CNanoTime burstTime = CNanoTime::fromUsec(20);
+
+   void measureRate(const std::string &mode, double bitsPerSecond, bool dry, CTscClock &clock)
+   {
+      std::shared_ptr<CUdpMulticastSender> sender(new CUdpMulticastSender);
+      if(dry)
+         sender->setSocketProxy(std::make_shared<CDrySendProxy>());
+      sender->open("127.0.0.1", 7890, "127.0.0.1");
+
+      const double rate = bitsPerSecond / 8;
+      const size_t burst = std::max(datagramSize, size_t(rate * double(burstTime.getNsec()) * 1e-9));
+      CPacer pacer(sender, rate, burst, 1024);
+      CLatencyHistogram jitter;
+      uint8_t datagram[datagramSize] = { 0 };
+      const CNanoTime start = clock.now();
+      CNanoTime now = start, lastRelease = start;
+      uint64_t lastBytes = 0;
+
+      while(now - start < duration)
+      {
+         while(pacer.enqueue(datagram, sizeof(datagram)))
+            ;
+         const CNanoTime next = pacer.getNextSendTime();
+         while(now < next)
+            now = clock.now();
+         const uint64_t before = pacer.getSentBytes();
+         if(pacer.release(now) == 0)
+            continue;
+         // the gap since the previous micro burst against the time its bytes take at the rate
+         if(lastBytes > 0)
+         {
+            const CNanoTime ideal = CNanoTime::fromNsec(int64_t(double(lastBytes) / rate * 1e9));
+            const CNanoTime gap = now - lastRelease;
+            jitter.record((gap > ideal) ? gap - ideal : ideal - gap);
+         }
+         lastBytes = pacer.getSentBytes() - before;
+         lastRelease = now;
+      }
+
+      const double achieved = double(pacer.getSentBytes() - burst) * 8 /
+                              (double((lastRelease - start).getNsec()) * 1e-9);
+      std::cout << std::left << std::setw(7) << mode << std::right << std::fixed
+                << std::setprecision(0) << std::setw(8) << bitsPerSecond / 1e6 << std::setw(10)
+                << achieved / 1e6 << std::setprecision(2) << std::setw(8)
+                << 100.0 * (achieved - bitsPerSecond) / bitsPerSecond << "%"
+                << std::setprecision(1) << std::setw(8)
+                << double(pacer.getSentCount()) / double(pacer.getBatchCount())
+                << std::setw(10) << jitter.getValueAtPercentile(50).getNsec() / 1000.0
+                << std::setw(10) << jitter.getValueAtPercentile(99).getNsec() / 1000.0
+                << std::setw(10) << jitter.getMax().getNsec() / 1000.0 << std::endl;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   const double rates[] = { 10e6, 100e6, 1e9, 10e9 };
+   CTscClock clock;
+
+   std::cout << datagramSize << " byte datagrams, micro burst " << burstTime.getUsec()
+             << "us, " << duration.getSec() << "s per rate" << std::endl;
+   std::cout << "mode     Mbit/s  achieved   error   per call  jitter us: p50       p99       max"
+             << std::endl;
+   for(double rate : rates)
+      measureRate("dry", rate, true, clock);
+   for(double rate : rates)
+      measureRate("socket", rate, false, clock);
+   return 0;
+}
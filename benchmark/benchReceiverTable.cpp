@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchReceiverTable.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 26, 2021, 4:45 PM
+ */
+
+// Measures the feedback processing of the sender per receiver with 1000 receivers: the update of
+// the receiver table with an ACK plus the watermark after it. The receivers acknowledge round
+// robin while the stream moves on, each with its own random lag. Compared with a full scan of
+// the table per ACK, scalar and AVX2, and with the std::unordered_map the sender used before.
+
+#include "benchmarkHelper.h"
+#include "../rmdgpLib/CReceiverTable.h"
+#include "../rmdgpLib/CSequenceNumber.h"
+#include <unordered_map>
+#include <vector>
+
+namespace {
+   /// \brief a small and fast pseudo random generator (xorshift64)
+   class CRandom {
+   public:
+      CRandom(uint64_t seed) : state(seed) {}
+      uint64_t next() { state ^= state << 13; state ^= state >> 7; state ^= state << 17; return state; }
+   private:
+      uint64_t state;
+   };
+
+   struct SAck {
+      uint32_t receiverId;
+      uint64_t cumulativeAck;
+      uint64_t reference;       ///< the next sequence number of the sender at that moment
+   };
+
+   struct SReceiverFeedback {
+      uint64_t cumulativeAck;
+      uint64_t highestReceived;
+   };
+}
+
+int main(int argc, char** argv)
+{
+   const size_t nbrReceivers = 1000;
+   const size_t nbrAcks = 1 << 20;
+   const CNanoTime now = CNanoTime::fromSec(1);
+   CRandom random(0x2468ace);
+   std::vector<SAck> acks(nbrAcks);
+
+   // every round all receivers acknowledge once, the stream moved 64 datagrams meanwhile
+   for(size_t i = 0; i < nbrAcks; i++)
+   {
+      const uint64_t reference = 100000 + (i / nbrReceivers) * 64;
+      acks[i] = { uint32_t(0x10000 + (i % nbrReceivers) * 7919), reference - random.next() % 256,
+                  reference };
+   }
+
+   CReceiverTable table(nbrReceivers);
+   for(size_t i = 0; i < nbrReceivers; i++)
+      table.add(acks[i].receiverId, 0, now);
+   uint64_t watermark = 0;
+   measure("table: ACK + incremental watermark", nbrAcks, [&](size_t i)
+         {
+            const SAck &ack = acks[i];
+            table.acknowledge(table.find(ack.receiverId), ack.cumulativeAck, ack.cumulativeAck,
+                              now);
+            watermark = table.getWatermark(ack.reference);
+            doNotOptimize(watermark);
+         });
+   // measure runs a tenth of the iterations extra as warm up
+   std::cout << "  full scans: " << std::fixed << std::setprecision(2)
+             << double(table.getScanCount()) / double(nbrAcks * 11 / 10) * 100.0
+             << "% of the ACKs" << std::endl;
+
+   std::vector<uint64_t> acked(nbrReceivers);
+   for(size_t i = 0; i < nbrReceivers; i++)
+      acked[i] = acks[i].cumulativeAck;
+   int64_t minimum = 0;
+   const double scalar = measure("scan of 1000 receivers, scalar", nbrAcks / 16, [&](size_t i)
+         {
+            acked[i % nbrReceivers] += 1;
+            minimum = CReceiverTable::scanMinScalar(acked.data(), nbrReceivers, 200000);
+            doNotOptimize(minimum);
+         });
+   const double vectorized = measure("scan of 1000 receivers, scanMin (AVX2)", nbrAcks / 16,
+         [&](size_t i)
+         {
+            acked[i % nbrReceivers] += 1;
+            minimum = CReceiverTable::scanMin(acked.data(), nbrReceivers, 200000);
+            doNotOptimize(minimum);
+         });
+   std::cout << "  per receiver: scalar " << scalar / double(nbrReceivers) << " ns, AVX2 "
+             << vectorized / double(nbrReceivers) << " ns" << std::endl;
+
+   // the map the sender had before, with a full walk per ACK
+   std::unordered_map<uint32_t, SReceiverFeedback> receivers;
+   for(size_t i = 0; i < nbrReceivers; i++)
+      receivers[acks[i].receiverId] = { 0, 0 };
+   measure("unordered_map: ACK + full walk", nbrAcks / 16, [&](size_t i)
+         {
+            const SAck &ack = acks[i];
+            SReceiverFeedback &receiver = receivers[ack.receiverId];
+            if(CSequenceNumber::isAfter(ack.cumulativeAck, receiver.cumulativeAck))
+               receiver.cumulativeAck = ack.cumulativeAck;
+            watermark = ack.reference;
+            for(const std::pair<const uint32_t, SReceiverFeedback> &r : receivers)
+            {
+               if(CSequenceNumber::isBefore(r.second.cumulativeAck, watermark))
+                  watermark = r.second.cumulativeAck;
+            }
+            doNotOptimize(watermark);
+         });
+   return 0;
+}
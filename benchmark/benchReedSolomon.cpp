@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchReedSolomon.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 2, 2021, 11:20 PM
+ */
+
+// Measures the throughput of the Reed-Solomon erasure code. First the GF(2^8) multiply
+// accumulate of one 1200 byte shard per kernel, then encoding and decoding of k data shards
+// with m parity shards for common (k, m) pairs, with the kernel that CGaloisField selected.
+// Decoding rebuilds m data shards, the worst case. The rate is data bytes per second.
+
+#include "benchmarkHelper.h"
+#include "../rmdgpLib/CGaloisField.h"
+#include "../rmdgpLib/CReedSolomon.h"
+#include <string>
+#include <vector>
+
+namespace {
+   const size_t shardSize = 1200;
+
+   /// \brief prints the rate for nsec per bytes
+   void printRate(double nsec, size_t bytes)
+   {
+      std::cout << "   = " << double(bytes) / nsec << " GB/s" << std::endl;
+   }
+
+   void measureKernels()
+   {
+      const size_t iterations = 2000000;
+      std::vector<uint8_t> source(shardSize, 0x5a), target(shardSize);
+      const CGaloisField::EKernel kernels[] = { CGaloisField::EKernel::scalar,
+                                                CGaloisField::EKernel::ssse3,
+                                                CGaloisField::EKernel::avx2 };
+
+      for(CGaloisField::EKernel kernel : kernels)
+      {
+         if(!CGaloisField::isSupported(kernel))
+            continue;
+         const double nsec = measure(std::string("mulAddInto ") + CGaloisField::getName(kernel) +
+                                     " 1200 bytes", iterations, [&](size_t i)
+               { CGaloisField::mulAddInto(kernel, uint8_t(i | 2), target.data(), source.data(),
+                                          shardSize);
+                 doNotOptimize(target[0]); });
+         printRate(nsec, shardSize);
+      }
+      std::cout << "CReedSolomon uses " << CGaloisField::getName(CGaloisField::getSelected())
+                << std::endl;
+   }
+
+   void measureCode(size_t k, size_t m)
+   {
+      const size_t iterations = 200000 / k;
+      CReedSolomon code(k, m);
+      std::vector<std::vector<uint8_t>> shards(k + m, std::vector<uint8_t>(shardSize));
+      std::vector<uint8_t*> pointers(k + m);
+      bool present[CReedSolomon::maxDataShards + CReedSolomon::maxParityShards];
+      const std::string name = "(" + std::to_string(k) + "," + std::to_string(m) + ") ";
+
+      for(size_t i = 0; i < k + m; i++)
+      {
+         pointers[i] = shards[i].data();
+         for(size_t j = 0; j < shardSize; j++)
+            shards[i][j] = uint8_t(i * 131 + j);
+         // the first m data shards are lost
+         present[i] = (i >= m);
+      }
+
+      const double encodeNsec = measure(name + "encode", iterations, [&](size_t i)
+            { code.encode(pointers.data(), pointers.data() + k, shardSize);
+              doNotOptimize(shards[k][0]); });
+      printRate(encodeNsec, k * shardSize);
+      const double decodeNsec = measure(name + "decode " + std::to_string(m) + " lost",
+                                        iterations, [&](size_t i)
+            { code.decode(pointers.data(), present, shardSize); doNotOptimize(shards[0][0]); });
+      printRate(decodeNsec, k * shardSize);
+   }
+}
+
+int main(int argc, char** argv)
+{
+   measureKernels();
+   const size_t pairs[][2] = { { 4, 2 }, { 8, 2 }, { 8, 4 }, { 10, 4 }, { 16, 4 }, { 32, 8 } };
+   for(const auto &pair : pairs)
+      measureCode(pair[0], pair[1]);
+   return 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchReorderBuffer.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 23, 2021, 8:15 PM
+ */
+
+// Measures the reorder buffer: the in order fast path, and a stream where pairs of datagrams are
+// swapped or 10% of the datagrams arrive 1000 datagrams late.
+
+#include "benchmarkHelper.h"
+#include "../rmdgpLib/CReorderBuffer.h"
+#include "../rmdgpLib/CDatagramPool.h"
+#include <deque>
+#include <vector>
+
+namespace {
+   /// \brief builds the arrival order: every datagram with late == true arrives delay later
+   std::vector<uint64_t> arrivalOrder(size_t count, unsigned latePercent, size_t delay)
+   {
+      std::vector<uint64_t> order;
+      std::deque<std::pair<uint64_t, uint64_t> > late;
+      uint64_t random = 0x9e3779b97f4a7c15;
+
+      order.reserve(count);
+      for(uint64_t sequence = 0; sequence < count; sequence++)
+      {
+         random ^= random << 13; random ^= random >> 7; random ^= random << 17;
+         if(random % 100 < latePercent)
+            late.push_back({ sequence + delay, sequence });
+         else
+            order.push_back(sequence);
+         while(!late.empty() && late.front().first <= sequence)
+         {
+            order.push_back(late.front().second);
+            late.pop_front();
+         }
+      }
+      for(const std::pair<uint64_t, uint64_t> &entry : late)
+         order.push_back(entry.second);
+      return order;
+   }
+
+   void run(const std::string &name, const std::vector<uint64_t> &order)
+   {
+      CDatagramPool pool(8192, 64);
+      CReorderBuffer buffer(8192, 8192 * 64);
+      SReceivedDatagram batch[64];
+      std::vector<SReceivedDatagram> held(8192);
+      uint64_t delivered = 0;
+
+      measure(name, order.size(), [&](size_t i)
+            {
+               // the warm up of measure runs the first 10% once more, start again then
+               if(i == 0)
+               {
+                  const size_t count = buffer.reset(0, held.data());
+                  for(size_t j = 0; j < count; j++)
+                     pool.release(held[j].handle);
+               }
+               const SReceivedDatagram datagram = { order[i], pool.acquire(), 64 };
+               if(buffer.insert(datagram) == CReorderBuffer::EResult::deliverNow)
+               {
+                  pool.release(datagram.handle);
+                  delivered++;
+                  size_t count;
+                  while((count = buffer.popReady(batch, 64)) > 0)
+                  {
+                     for(size_t j = 0; j < count; j++)
+                        pool.release(batch[j].handle);
+                     delivered += count;
+                  }
+               }
+            });
+      doNotOptimize(delivered);
+   }
+}
+
+int main(int argc, char** argv)
+{
+   const size_t count = 20000000;
+
+   run("in order (fast path)", arrivalOrder(count, 0, 0));
+   run("1% late by 1000", arrivalOrder(count, 1, 1000));
+   run("10% late by 1000", arrivalOrder(count, 10, 1000));
+   return 0;
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchRepair.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 29, 2021, 2:40 PM
+ */
+
+// Sends the repairs for 100 lost datagrams with a real sender, for a group of 100 receivers.
+// Every receiver that lost a datagram NAKs it once; the NAKs of one loss arrive within the
+// repair window. Single loss: each datagram is lost by one receiver. Correlated loss: each
+// datagram is lost by half or all of the receivers. Compared are the policies always multicast
+// (threshold 0), always unicast and the default threshold of 2. Reported are the repair bytes
+// the sender sends and the repair bytes all receivers together have to handle, per lost
+// datagram. Nobody listens, the repairs only have to leave the sender.
+
+#include "benchmarkHelper.h"
+#include "../rmdgpLib/CNakPacket.h"
+#include "../rmdgpLib/CRmdgpSender.h"
+#include "../socketLib/CSocketAddress.h"
+#include "../socketLib/CUdpMulticastSender.h"
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+namespace {
+   /// \brief a small and fast pseudo random generator (xorshift64)
+   class CRandom {
+   public:
+      CRandom(uint64_t seed) : state(seed) {}
+      uint64_t next() { state ^= state << 13; state ^= state >> 7; state ^= state << 17; return state; }
+   private:
+      uint64_t state;
+   };
+
+   const size_t nbrReceivers = 100;
+   const size_t payloadSize = 1200;
+   const size_t datagramSize = CRmdgpHeader::size + payloadSize;
+   const uint64_t nbrLost = 100;
+   const CNanoTime window = CNanoTime::fromMsec(2);
+
+   void run(const char *scenario, const char *policy, size_t threshold, size_t lostBy,
+            CRandom &random)
+   {
+      std::shared_ptr<CUdpMulticastSender> udpSender(new CUdpMulticastSender);
+      udpSender->open("127.0.0.1", 7890, "127.0.0.1");
+      CRmdgpSender sender(udpSender, 1, 1, 1024, 1024 * datagramSize, payloadSize);
+      uint8_t payload[payloadSize] = { 0 };
+      uint8_t nak[CRmdgpSender::maxFeedbackLength];
+      std::vector<CSocketAddress> receivers;
+
+      for(size_t i = 0; i < nbrReceivers; i++)
+         receivers.emplace_back("127.0.0.1", int(20000 + i));
+      for(uint64_t sequence = 0; sequence < nbrLost; sequence++)
+         sender.send(payload, sizeof(payload));
+      sender.setRepairPolicy(threshold, window);
+
+      const CNanoTime start = CNanoTime::fromSec(1000);
+      CNanoTime now = start;
+      for(uint64_t sequence = 0; sequence < nbrLost; sequence++)
+      {
+         CNakBuilder builder(nak, sizeof(nak), 1, 1, 1);
+         builder.add({ sequence, sequence + 1 });
+         const size_t first = size_t(random.next() % nbrReceivers);
+         for(size_t n = 0; n < lostBy; n++)
+         {
+            const CNanoTime arrival = now + CNanoTime::fromNsec(
+                                       int64_t(random.next() % uint64_t(window.getNsec())));
+            sender.processNak(nak, builder.getLength(), receivers[(first + n) % nbrReceivers],
+                              arrival);
+         }
+         now += window;
+         sender.sendRepairs(now);
+      }
+      // the requests that arrived late in the last window
+      sender.sendRepairs(now + window);
+
+      const CRepairScheduler *scheduler = sender.getRepairScheduler();
+      const uint64_t multicasts = scheduler->getMulticastCount();
+      const uint64_t unicasts = scheduler->getUnicastCount();
+      const double sent = double((multicasts + unicasts) * datagramSize) / nbrLost;
+      const double handled = double((multicasts * nbrReceivers + unicasts) * datagramSize) /
+                             nbrLost;
+      std::cout << scenario << " " << policy << ": " << multicasts << " multicast, " << unicasts
+                << " unicast, sent " << sent << " bytes/loss, received " << handled
+                << " bytes/loss" << std::endl;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   CRandom random(0x1234567);
+   const size_t unicastOnly = SIZE_MAX;
+   const size_t adaptive = 2;
+
+   std::cout << nbrReceivers << " receivers, " << datagramSize << " byte datagrams, window "
+             << window.getMsec() << "ms" << std::endl;
+   run("single loss    ", "multicast", 0, 1, random);
+   run("single loss    ", "unicast  ", unicastOnly, 1, random);
+   run("single loss    ", "adaptive ", adaptive, 1, random);
+   run("half lose      ", "multicast", 0, nbrReceivers / 2, random);
+   run("half lose      ", "unicast  ", unicastOnly, nbrReceivers / 2, random);
+   run("half lose      ", "adaptive ", adaptive, nbrReceivers / 2, random);
+   run("all lose       ", "multicast", 0, nbrReceivers, random);
+   run("all lose       ", "unicast  ", unicastOnly, nbrReceivers, random);
+   run("all lose       ", "adaptive ", adaptive, nbrReceivers, random);
+   return 0;
+}
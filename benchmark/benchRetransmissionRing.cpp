@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchRetransmissionRing.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 17, 2021, 9:00 PM
+ */
+
+// Measures store, lookup and release of the retransmission ring, and checks how much of a second
+// the ring needs to handle 1M messages per second.
+
+#include "benchmarkHelper.h"
+#include "../rmdgpLib/CRetransmissionRing.h"
+#include "../rmdgpLib/CRmdgpHeader.h"
+#include <string.h>
+
+int main(int argc, char** argv)
+{
+   const size_t iterations = 20000000;
+   const size_t window = 16384;
+   const size_t datagramLength = 1200;
+   const size_t ackInterval = 64;
+   CRetransmissionRing ring(window, window * datagramLength, 1472);
+   uint8_t payload[datagramLength] = { 0 };
+
+   std::cout << "ring of " << ring.getCapacity() << " slots of " << ring.getMaxDatagramSize()
+             << " bytes, datagrams of " << datagramLength << " bytes" << std::endl;
+
+   measure("store header in place + release", iterations, [&](size_t i)
+         {
+            if(!ring.canStore(datagramLength))
+               ring.release(ring.getOldestSequence() + ackInterval);
+            const uint64_t sequence = ring.getNextSequence();
+            CRmdgpHeaderBuilder(ring.store(datagramLength)).setSequence(sequence);
+         });
+
+   measure("store with payload copy + release", iterations / 10, [&](size_t i)
+         {
+            if(!ring.canStore(datagramLength))
+               ring.release(ring.getOldestSequence() + ackInterval);
+            ring.store(payload, datagramLength);
+         });
+
+   size_t length = 0;
+   const uint8_t *found = nullptr;
+   measure("lookup (random in window)", iterations, [&](size_t i)
+         {
+            found = ring.lookup(ring.getOldestSequence() + (i * 7919) % ring.getCount(), length);
+            doNotOptimize(found);
+         });
+
+   size_t released = 0;
+   measure("release " + std::to_string(ackInterval) + " + store " +
+           std::to_string(ackInterval) + " headers", iterations / ackInterval, [&](size_t i)
+         {
+            released += ring.release(ring.getOldestSequence() + ackInterval);
+            for(size_t j = 0; j < ackInterval; j++)
+               ring.store(datagramLength);
+            doNotOptimize(released);
+         });
+
+   // one second of traffic at 1M messages/s: every message is stored with its payload, one in
+   // 100 is looked up for a repair and the acknowledged watermark advances every 64 messages
+   const size_t messagesPerSecond = 1000000;
+   CNanoTime start, stop;
+   CClock::getMonotonicTime(start);
+   for(size_t i = 0; i < messagesPerSecond; i++)
+   {
+      if(i % ackInterval == 0 && ring.getCount() > window / 2)
+         ring.release(ring.getOldestSequence() + ackInterval * 2);
+      ring.store(payload, datagramLength);
+      if(i % 100 == 0)
+      {
+         found = ring.lookup(ring.getOldestSequence() + i % ring.getCount(), length);
+         doNotOptimize(found);
+      }
+   }
+   CClock::getMonotonicTime(stop);
+   std::cout << "1M messages of " << datagramLength << " bytes took " << (stop - start).getUsec()
+             << " us, " << std::fixed << std::setprecision(1)
+             << 100.0 * double((stop - start).getNsec()) / double(CNanoTime::nsecInSec)
+             << "% of the 1 second budget" << std::endl;
+
+   return 0;
+}
@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchTailLoss.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 28, 2021, 10:15 AM
+ */
+
+// Measures how long it takes to repair a loss at the end of a burst, with and without
+// heartbeats. A real sender and receiver run in simulated time, in steps of 1ms. The datagrams
+// travel over loopback sockets (the wire), where the benchmark delays them by 1ms and drops the
+// first transmission of the last datagrams of every burst. The sender sends a burst of 50
+// datagrams every second and is idle in between. Without heartbeats a tail loss is only found
+// when the next burst arrives. The receiver sends NAKs every 20ms while something is missing.
+
+#include "benchmarkHelper.h"
+#include "../rmdgpLib/CRmdgpReceiver.h"
+#include "../rmdgpLib/CRmdgpSender.h"
+#include "../socketLib/CSocketAddress.h"
+#include "../socketLib/CUdpMulticastReceiver.h"
+#include "../socketLib/CUdpMulticastSender.h"
+#include "../socketLib/CUdpSocket.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace {
+   const char *localAddress = "127.0.0.1";
+   const int dataPort = 7891;
+   const int feedbackPort = 7892;
+   const uint64_t burstSize = 50;
+   const uint64_t tailLost = 3;
+   const int bursts = 20;
+   const CNanoTime burstInterval = CNanoTime::fromSec(1);
+   const CNanoTime step = CNanoTime::fromMsec(1);
+   const CNanoTime oneWayDelay = CNanoTime::fromMsec(1);
+   const CNanoTime nakInterval = CNanoTime::fromMsec(20);
+   const size_t payloadSize = 100;
+
+   /// \brief a datagram on its way
+   struct SInFlight {
+      CNanoTime due;
+      std::vector<uint8_t> bytes;
+   };
+
+   /// \brief a loopback socket where the datagrams of one direction arrive
+   class CWire {
+   public:
+      CWire(int port) : buffer(2048)
+      {
+         const in_addr address = { inet_addr(localAddress) };
+         socket.openUdpSocket();
+         socket.bind(address, port);
+         socket.setNonBlocking();
+      }
+
+      /// \brief takes the datagrams from the socket, the ones that pass keep go on the way
+      template<class TKeep>
+      void collect(const CNanoTime &now, TKeep keep)
+      {
+         sockaddr_in source;
+         size_t length;
+         while((length = socket.receiveFrom(buffer.data(), buffer.size(), &source)) > 0)
+            if(keep(buffer.data(), length))
+               inFlight.push_back({ now + oneWayDelay, std::vector<uint8_t>(buffer.begin(),
+                                    buffer.begin() + length) });
+      }
+
+      /// \brief hands over the datagrams that arrived
+      template<class TDeliver>
+      void deliver(const CNanoTime &now, TDeliver deliver)
+      {
+         while(!inFlight.empty() && inFlight.front().due <= now)
+         {
+            deliver(inFlight.front().bytes.data(), inFlight.front().bytes.size());
+            inFlight.pop_front();
+         }
+      }
+
+   private:
+      CUdpSocket socket;
+      std::vector<uint8_t> buffer;
+      std::deque<SInFlight> inFlight;
+   };
+
+   void run(bool heartbeats)
+   {
+      std::shared_ptr<CUdpMulticastSender> udpSender(new CUdpMulticastSender);
+      udpSender->open(localAddress, dataPort, localAddress);
+      std::shared_ptr<CUdpMulticastReceiver> udpReceiver(new CUdpMulticastReceiver);
+      udpReceiver->openUdpSocket();
+      CWire dataWire(dataPort), feedbackWire(feedbackPort);
+      CRmdgpSender sender(udpSender, 1, 1, 4096, 4096 * (CRmdgpHeader::size + payloadSize),
+                          payloadSize);
+      CRmdgpReceiver receiver(udpReceiver, CSocketAddress(localAddress, feedbackPort), 1);
+      std::vector<CNanoTime> sendTimes;
+      std::vector<CNanoTime> latencies;
+      SReceivedDatagram ready[64];
+      uint8_t payload[payloadSize] = { 0 };
+      uint64_t heartbeatsSent = 0;
+      CNanoTime lastNak;
+
+      // simulated CLOCK_MONOTONIC, far from zero like the real one
+      const CNanoTime base = CNanoTime::fromSec(1000);
+      const CNanoTime duration = burstInterval * bursts;
+      for(CNanoTime time; time < duration; time += step)
+      {
+         const CNanoTime now = base + time;
+
+         if(time.getNsec() % burstInterval.getNsec() == 0)
+         {
+            for(uint64_t i = 0; i < burstSize; i++)
+            {
+               sendTimes.push_back(now);
+               sender.send(payload, payloadSize);
+            }
+         }
+         if(heartbeats)
+            heartbeatsSent += sender.handleTimer(now);
+
+         // the first transmission of the tail of every burst is lost
+         dataWire.collect(now, [](const uint8_t *datagram, size_t length)
+         {
+            const CRmdgpHeaderView header(datagram);
+            return header.getType() != ERmdgpPacketType::data ||
+                   header.hasFlag(rmdgpFlagRetransmission) ||
+                   header.getSequence() % burstSize < burstSize - tailLost;
+         });
+         dataWire.deliver(now, [&](const uint8_t *datagram, size_t length)
+         {
+            const uint32_t handle = receiver.getDatagramPool().acquire();
+            std::copy(datagram, datagram + length, receiver.getDatagramPool().getBuffer(handle));
+            const size_t count = receiver.processDatagram(handle, length, ready, 64, now);
+            for(size_t i = 0; i < count; i++)
+            {
+               if(ready[i].sequence % burstSize >= burstSize - tailLost)
+                  latencies.push_back(now - sendTimes[ready[i].sequence]);
+               receiver.release(ready[i]);
+            }
+         });
+
+         if(receiver.getLossTracker().getHoleCount() > 0 && now - lastNak >= nakInterval)
+         {
+            receiver.sendNaks();
+            lastNak = now;
+         }
+         receiver.handleTimer(now);
+
+         feedbackWire.collect(now, [](const uint8_t *datagram, size_t length) { return true; });
+         feedbackWire.deliver(now, [&](const uint8_t *datagram, size_t length)
+         {
+            if(datagram[CRmdgpHeader::typeOffset] == uint8_t(ERmdgpPacketType::ack))
+            {
+               sender.processAck(datagram, length, now);
+               sender.updateWindow();
+            }
+            else
+               sender.processNak(datagram, length);
+         });
+      }
+
+      const uint64_t lost = bursts * tailLost;
+      std::sort(latencies.begin(), latencies.end());
+      std::cout << (heartbeats ? "with heartbeats:    " : "without heartbeats: ")
+                << latencies.size() << " of " << lost << " tail losses repaired";
+      if(!latencies.empty())
+         std::cout << ", latency median " << latencies[latencies.size() / 2].getMsec()
+                   << "ms max " << latencies.back().getMsec() << "ms";
+      std::cout << ", " << double(heartbeatsSent) / duration.getSec()
+                << " heartbeats/s" << std::endl;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   std::cout << bursts << " bursts of " << burstSize << " datagrams, one every "
+             << burstInterval.getMsec() << "ms, the last " << tailLost
+             << " of every burst are lost" << std::endl;
+   run(false);
+   run(true);
+   return 0;
+}
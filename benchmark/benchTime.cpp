@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchTime.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 3, 2021, 9:12 PM
+ */
+
+// Compares the cost of CTime with the compact CNanoTime.
+
+#include "benchmarkHelper.h"
+#include "../socketLib/CTime.h"
+#include "../socketLib/CNanoTime.h"
+#include "../socketLib/CClock.h"
+#include <vector>
+
+int main(int argc, char** argv)
+{
+   const size_t iterations = 20000000;
+   const size_t nbrTimes = 1024;
+   std::vector<CTime> times(nbrTimes);
+   std::vector<CNanoTime> nanoTimes(nbrTimes);
+
+   for(size_t i = 0; i < nbrTimes; i++)
+   {
+      times[i] = CTime(i, (i * 7919 * 104729) % CTime::nsecInSec);
+      nanoTimes[i] = CNanoTime(times[i]);
+   }
+
+   std::cout << "sizeof(CTime)=" << sizeof(CTime) << " sizeof(CNanoTime)=" << sizeof(CNanoTime)
+             << std::endl;
+
+   CTime timeSum;
+   measure("CTime operator+", iterations, [&](size_t i)
+         { timeSum = timeSum + times[i % nbrTimes]; doNotOptimize(timeSum); });
+   CNanoTime nanoTimeSum;
+   measure("CNanoTime operator+", iterations, [&](size_t i)
+         { nanoTimeSum = nanoTimeSum + nanoTimes[i % nbrTimes]; doNotOptimize(nanoTimeSum); });
+
+   CTime timeDiff;
+   measure("CTime operator-", iterations, [&](size_t i)
+         { timeDiff = times[i % nbrTimes] - times[(i + 1) % nbrTimes]; doNotOptimize(timeDiff); });
+   CNanoTime nanoTimeDiff;
+   measure("CNanoTime operator-", iterations, [&](size_t i)
+         { nanoTimeDiff = nanoTimes[i % nbrTimes] - nanoTimes[(i + 1) % nbrTimes];
+           doNotOptimize(nanoTimeDiff); });
+
+   CTime timeProduct;
+   measure("CTime operator*", iterations, [&](size_t i)
+         { timeProduct = times[i % nbrTimes] * int(i & 0xff); doNotOptimize(timeProduct); });
+   CNanoTime nanoTimeProduct;
+   measure("CNanoTime operator*", iterations, [&](size_t i)
+         { nanoTimeProduct = nanoTimes[i % nbrTimes] * int(i & 0xff);
+           doNotOptimize(nanoTimeProduct); });
+
+   bool less = false;
+   measure("CTime operator<", iterations, [&](size_t i)
+         { less = times[i % nbrTimes] < times[(i * 31) % nbrTimes]; doNotOptimize(less); });
+   measure("CNanoTime operator<", iterations, [&](size_t i)
+         { less = nanoTimes[i % nbrTimes] < nanoTimes[(i * 31) % nbrTimes]; doNotOptimize(less); });
+
+   CTime currentTime;
+   measure("CClock::getMonotonicTime(CTime)", iterations / 10, [&](size_t i)
+         { CClock::getMonotonicTime(currentTime); doNotOptimize(currentTime); });
+   CNanoTime currentNanoTime;
+   measure("CClock::getMonotonicTime(CNanoTime)", iterations / 10, [&](size_t i)
+         { CClock::getMonotonicTime(currentNanoTime); doNotOptimize(currentNanoTime); });
+
+   return 0;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   benchmarkHelper.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 3, 2021, 9:12 PM
+ */
+
+#ifndef BENCHMARKHELPER_H
+#define BENCHMARKHELPER_H
+
+#include "../socketLib/CClock.h"
+#include "../socketLib/CNanoTime.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <stddef.h>
+
+/// \brief prevents the compiler from optimizing away the calculation of value
+template<class T>
+inline void doNotOptimize(T &value)
+{
+   asm volatile("" : "+m"(value) : : "memory");
+}
+
+/// \brief calls function iterations times and prints the average time per call
+/// \return the average time per call in nano seconds
+template<class Function>
+double measure(const std::string &name, size_t iterations, Function function)
+{
+   CNanoTime start, stop;
+
+   // warm up caches and branch predictors
+   for(size_t i = 0; i < iterations/10; i++)
+      function(i);
+
+   CClock::getMonotonicTime(start);
+   for(size_t i = 0; i < iterations; i++)
+      function(i);
+   CClock::getMonotonicTime(stop);
+
+   const double nsecPerCall = double((stop - start).getNsec()) / double(iterations);
+   std::cout << std::left << std::setw(50) << name << std::right << std::setw(10)
+             << std::fixed << std::setprecision(2) << nsecPerCall << " ns/call" << std::endl;
+   return nsecPerCall;
+}
+
+#endif /* BENCHMARKHELPER_H */
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CAckPacket.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 25, 2021, 7:20 PM
+ */
+
+#include "CAckPacket.h"
+#include "CVarInt.h"
+
+CAckBuilder::CAckBuilder(uint8_t *datagram, size_t maxLength, uint32_t sessionId,
+               uint32_t streamId, uint32_t receiverId, uint64_t cumulativeAck,
+               const CNanoTime &holdTime) : datagram(datagram),
+               maxLength(maxLength < CRmdgpHeader::size + CRmdgpHeader::maxPayloadLength ?
+                         maxLength : CRmdgpHeader::size + CRmdgpHeader::maxPayloadLength),
+               length(CRmdgpHeader::size), rangeCount(0), previousEnd(cumulativeAck)
+{
+   CRmdgpHeaderBuilder(datagram).setType(ERmdgpPacketType::ack).setSessionId(sessionId)
+                   .setStreamId(streamId).setSequence(cumulativeAck);
+   const CNanoTime held = holdTime < CNanoTime() ? CNanoTime() :
+                          (holdTime > maxHoldTime ? maxHoldTime : holdTime);
+
+   length += CVarInt::encode(datagram + length, this->maxLength - length, receiverId);
+   length += CVarInt::encode(datagram + length, this->maxLength - length,
+                             uint64_t(held.getUsec()));
+   CRmdgpHeader::store16(datagram + CRmdgpHeader::payloadLengthOffset,
+                         uint16_t(length - CRmdgpHeader::size));
+}
+
+CAckBuilder::~CAckBuilder()
+{
+}
+
+void CAckBuilder::setLossRate(double lossRate)
+{
+   const double clamped = (lossRate < 0) ? 0 : ((lossRate > 1) ? 1 : lossRate);
+
+   CRmdgpHeader::store16(datagram + CRmdgpHeader::flagsOffset,
+                   CRmdgpHeaderView(datagram).getFlags() | rmdgpFlagLossReport);
+   CRmdgpHeader::store16(datagram + CRmdgpHeader::lossReportOffset,
+                   uint16_t(clamped * lossRateScale + 0.5));
+}
+
+bool CAckBuilder::add(const SSequenceRange &range)
+{
+   if(range.size() == 0 || CSequenceNumber::isAfter(range.begin, range.end) ||
+      !CSequenceNumber::isAfter(range.begin, previousEnd))
+      return false;
+
+   const uint64_t missingMinusOne = range.begin - previousEnd - 1;
+   const uint64_t sizeMinusOne = range.size() - 1;
+   if(length + CVarInt::size(missingMinusOne) + CVarInt::size(sizeMinusOne) > maxLength)
+      return false;
+
+   length += CVarInt::encode(datagram + length, maxLength - length, missingMinusOne);
+   length += CVarInt::encode(datagram + length, maxLength - length, sizeMinusOne);
+   CRmdgpHeader::store16(datagram + CRmdgpHeader::payloadLengthOffset,
+                         uint16_t(length - CRmdgpHeader::size));
+   previousEnd = range.end;
+   rangeCount++;
+   return true;
+}
+
+CAckReader::CAckReader(const uint8_t *datagram, size_t length) :
+               position(datagram + CRmdgpHeader::size), end(datagram + length),
+               cumulativeAck(CRmdgpHeaderView(datagram).getSequence()),
+               previousEnd(cumulativeAck), receiverId(0), lossRate(-1), holdTime(),
+               malformed(false)
+{
+   const CRmdgpHeaderView header(datagram);
+   uint64_t id, held = 0;
+
+   if(header.hasFlag(rmdgpFlagLossReport))
+      lossRate = double(header.getLossReport()) / CAckBuilder::lossRateScale;
+   size_t bytes = CVarInt::decode(position, end - position, id);
+   if(bytes != 0)
+   {
+      position += bytes;
+      bytes = CVarInt::decode(position, end - position, held);
+   }
+
+   if(bytes == 0 || id > UINT32_MAX || held > uint64_t(CAckBuilder::maxHoldTime.getUsec()))
+      malformed = true;
+   else
+   {
+      receiverId = uint32_t(id);
+      holdTime = CNanoTime::fromUsec(int64_t(held));
+      position += bytes;
+   }
+}
+
+CAckReader::~CAckReader()
+{
+}
+
+bool CAckReader::next(SSequenceRange &range)
+{
+   uint64_t missingMinusOne, sizeMinusOne;
+
+   if(position >= end || malformed)
+      return false;
+
+   size_t bytes = CVarInt::decode(position, end - position, missingMinusOne);
+   if(bytes != 0)
+   {
+      position += bytes;
+      bytes = CVarInt::decode(position, end - position, sizeMinusOne);
+   }
+   if(bytes == 0 || missingMinusOne >= uint64_t(INT64_MAX) || sizeMinusOne >= uint64_t(INT64_MAX))
+   {
+      malformed = true;
+      return false;
+   }
+   position += bytes;
+
+   range.begin = previousEnd + missingMinusOne + 1;
+   range.end = range.begin + sizeMinusOne + 1;
+   previousEnd = range.end;
+   return true;
+}
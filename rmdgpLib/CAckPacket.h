@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CAckPacket.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 25, 2021, 7:20 PM
+ */
+
+#ifndef CACKPACKET_H
+#define CACKPACKET_H
+
+#include "CRmdgpHeader.h"
+#include "CSequenceNumber.h"
+#include "../socketLib/CNanoTime.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief Builds an ACK datagram, the periodic feedback of a receiver. It holds a cumulative
+///        acknowledgement: every sequence number before it is received, and it is missing itself
+///        (or not sent yet). Above it a selective acknowledgement tells which sequence numbers
+///        are received as well. That is a bitmap, compressed to its runs:
+///        the header sequence number is the cumulative acknowledgement and the payload holds a
+///        CVarInt with the receiver id, a CVarInt with the hold time in microseconds, then per
+///        received range two CVarInts: the number of missing sequence numbers since the end of
+///        the previous range (the cumulative acknowledgement for the first range) - 1, and the
+///        size - 1.
+///        The end of the last range echoes the newest received datagram, the sender knows when
+///        it sent it. The hold time is how long the receiver had that datagram before it sent
+///        the ACK, so the sender takes the ACK batching out of its round trip time sample.
+///        A receiver without losses sends no ranges, its ACK is about 27 bytes.
+///        With setLossRate the ACK also reports the fraction of the datagrams that the receiver
+///        missed at first, before repairs and FEC, in the reserved header field as a fraction of
+///        lossRateScale with rmdgpFlagLossReport.
+///        Ranges must be added in sequence order, with at least one missing sequence number in
+///        between. When not all ranges fit, the ACK just tells less.
+class CAckBuilder {
+public:
+    /// \param datagram the send buffer
+    /// \param maxLength the maximum datagram length, including the header
+    /// \param receiverId identifies the receiver at the sender
+    /// \param cumulativeAck everything before this sequence number is received
+    /// \param holdTime the time since the newest datagram was received, it is capped at
+    ///        maxHoldTime
+    CAckBuilder(uint8_t *datagram, size_t maxLength, uint32_t sessionId, uint32_t streamId,
+                uint32_t receiverId, uint64_t cumulativeAck,
+                const CNanoTime &holdTime = CNanoTime());
+    CAckBuilder(const CAckBuilder& orig) = delete;
+    virtual ~CAckBuilder();
+
+    /// \brief adds a received range
+    /// \return false when the range doesn't fit anymore, or doesn't start after a missing
+    ///         sequence number after the previous range
+    bool add(const SSequenceRange &range);
+
+    /// \brief reports the loss rate, 0 to 1
+    void setLossRate(double lossRate);
+
+    /// \brief returns the number of ranges added
+    size_t getRangeCount() const { return rangeCount; }
+    /// \brief returns the datagram length so far
+    size_t getLength() const { return length; }
+
+    /// \brief a loss rate of 1 in the header
+    static constexpr uint16_t lossRateScale = UINT16_MAX;
+    /// \brief the longest hold time that an ACK reports
+    static constexpr CNanoTime maxHoldTime = CNanoTime::fromSec(60);
+
+private:
+    uint8_t *datagram;
+    const size_t maxLength;
+    size_t length;
+    size_t rangeCount;
+    uint64_t previousEnd;
+};
+
+/// \brief Reads an ACK datagram, in place
+class CAckReader {
+public:
+    /// \param datagram a datagram that passed CRmdgpHeaderView::validate and has type ack
+    /// \param length the datagram length
+    CAckReader(const uint8_t *datagram, size_t length);
+    CAckReader(const CAckReader& orig) = delete;
+    virtual ~CAckReader();
+
+    /// \brief returns the id of the receiver that sent the ACK
+    uint32_t getReceiverId() const { return receiverId; }
+    /// \brief returns the cumulative acknowledgement
+    uint64_t getCumulativeAck() const { return cumulativeAck; }
+    /// \brief returns true when the ACK reports the loss rate
+    bool hasLossRate() const { return lossRate >= 0; }
+    /// \brief returns the reported loss rate, 0 to 1, or -1 when there is none
+    double getLossRate() const { return lossRate; }
+    /// \brief returns the time the receiver held the newest datagram before it sent the ACK
+    const CNanoTime& getHoldTime() const { return holdTime; }
+
+    /// \brief reads the next received range
+    /// \return false at the end of the datagram, or when the rest of the datagram is malformed
+    bool next(SSequenceRange &range);
+
+    /// \brief returns true when the receiver id, the hold time or a range is malformed
+    bool isMalformed() const { return malformed; }
+
+private:
+    const uint8_t *position;
+    const uint8_t *end;
+    uint64_t cumulativeAck;
+    uint64_t previousEnd;
+    uint32_t receiverId;
+    double lossRate;
+    CNanoTime holdTime;
+    bool malformed;
+};
+
+#endif /* CACKPACKET_H */
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CCongestionController.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 5, 2021, 9:10 AM
+ */
+
+#ifndef CCONGESTIONCONTROLLER_H
+#define CCONGESTIONCONTROLLER_H
+
+#include "../socketLib/CNanoTime.h"
+#include <stdint.h>
+
+/// \brief Interface for the congestion control of a CRmdgpSender: it gets the feedback of the
+///        receivers and tells how fast the sender may send. Derive from it and pass it to
+///        CRmdgpSender::setCongestionController, see CTfmccController. The functions are called
+///        from the thread that calls the sender.
+class CCongestionController {
+public:
+    CCongestionController() {}
+    CCongestionController(const CCongestionController& orig) = delete;
+    CCongestionController& operator=(const CCongestionController& other) = delete;
+    virtual ~CCongestionController() {}
+
+    /// \brief the feedback of a receiver, from an ACK with a loss report
+    /// \param receiverId the id of the receiver
+    /// \param lossRate the smoothed loss rate of the receiver, 0 to 1
+    /// \param rtt a round trip time sample, 0 when the ACK gave none
+    /// \param now the time the ACK was received
+    virtual void onFeedback(uint32_t receiverId, double lossRate, const CNanoTime &rtt,
+                            const CNanoTime &now) = 0;
+
+    /// \brief the receiver was ejected, its feedback doesn't count anymore
+    virtual void onReceiverRemoved(uint32_t receiverId) = 0;
+
+    /// \brief returns the rate that the sender may send at now, in bytes per second
+    virtual double getRate(const CNanoTime &now) = 0;
+};
+
+#endif /* CCONGESTIONCONTROLLER_H */
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CDatagramPool.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 22, 2021, 7:10 PM
+ */
+
+#include "CDatagramPool.h"
+#include <sstream>
+#include <stdexcept>
+
+CDatagramPool::CDatagramPool(size_t count, size_t bufferSize) : count(count),
+               bufferSize(bufferSize), cacheLinesPerBuffer(0), freeCount(0)
+{
+   if(count == 0 || count >= invalidHandle || bufferSize == 0 || bufferSize > UINT32_MAX)
+   {
+      std::ostringstream message;
+      message << "Error invalid datagram pool size, count:" << count << " buffer size:"
+              << bufferSize;
+      throw std::runtime_error(message.str());
+   }
+
+   cacheLinesPerBuffer = (bufferSize + cacheLineSize - 1) / cacheLineSize;
+   // value initialized, so all pages are mapped now and not on the first receive
+   data.reset(new SCacheLine[count * cacheLinesPerBuffer]());
+   freeHandles.reset(new uint32_t[count]);
+
+   // hand out the low handles first
+   for(size_t i = 0; i < count; i++)
+      freeHandles[i] = uint32_t(count - 1 - i);
+   freeCount = count;
+}
+
+CDatagramPool::~CDatagramPool()
+{
+}
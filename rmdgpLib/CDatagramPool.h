@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CDatagramPool.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 22, 2021, 7:10 PM
+ */
+
+#ifndef CDATAGRAMPOOL_H
+#define CDATAGRAMPOOL_H
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief A fixed number of preallocated, cache line aligned receive buffers. A buffer is
+///        referred to by a small handle, so it can be passed around (reordered, delivered)
+///        without copying the datagram. Acquire and release are O(1) and allocate nothing.
+class CDatagramPool {
+public:
+    /// \param count the number of buffers, this caps the memory of the receiver
+    /// \param bufferSize the size of every buffer
+    /// \throws std::runtime_error when count or bufferSize is 0 or too large
+    CDatagramPool(size_t count, size_t bufferSize);
+    CDatagramPool(const CDatagramPool& orig) = delete;
+    CDatagramPool& operator=(const CDatagramPool& other) = delete;
+    virtual ~CDatagramPool();
+
+    /// \brief takes a free buffer
+    /// \return the handle of the buffer or invalidHandle when all buffers are in use
+    uint32_t acquire()
+    {
+        return (freeCount == 0) ? invalidHandle : freeHandles[--freeCount];
+    }
+    /// \brief gives a buffer back
+    void release(uint32_t handle) { freeHandles[freeCount++] = handle; }
+
+    /// \brief returns the buffer of handle
+    uint8_t* getBuffer(uint32_t handle) const { return data[size_t(handle) * cacheLinesPerBuffer].bytes; }
+
+    size_t getBufferSize() const { return bufferSize; }
+    size_t getCount() const { return count; }
+    size_t getFreeCount() const { return freeCount; }
+
+    static constexpr uint32_t invalidHandle = UINT32_MAX;
+    static constexpr size_t cacheLineSize = 64;
+
+private:
+    struct alignas(cacheLineSize) SCacheLine {
+        uint8_t bytes[cacheLineSize];
+    };
+
+    const size_t count;
+    const size_t bufferSize;
+    size_t cacheLinesPerBuffer;
+    std::unique_ptr<SCacheLine[]> data;
+    std::unique_ptr<uint32_t[]> freeHandles;
+    size_t freeCount;
+};
+
+#endif /* CDATAGRAMPOOL_H */
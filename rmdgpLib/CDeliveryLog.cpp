@@ -0,0 +1,325 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CDeliveryLog.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 7, 2021, 9:40 AM
+ */
+
+#include "CDeliveryLog.h"
+#include "CSequenceNumber.h"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+#include <unistd.h>
+
+namespace {
+   const char logMagic[8] = { 'R', 'M', 'D', 'G', 'P', 'L', 'O', 'G' };
+   const uint32_t logVersion = 2;
+   /// \brief the segment has the session and stream of its messages
+   const uint32_t logFlagSession = 0x1;
+
+   /// \brief the first page of a segment file, the records follow at headerSize. The kernel
+   ///        may write the page back at any moment, so recordsEnd, nextSequence and count are
+   ///        only set by flush(true), after the records they cover are on the disk.
+   struct SLogHeader {
+      char magic[8];
+      uint32_t version;
+      uint32_t flags;
+      uint32_t sessionId;
+      uint32_t streamId;
+      uint64_t firstSequence;
+      uint64_t recordsEnd;
+      uint64_t nextSequence;
+      uint64_t count;
+   };
+   // a page of its own, so the write back of the records never waits for the header
+   const size_t headerSize = 4096;
+   static_assert(sizeof(SLogHeader) <= headerSize, "the log header doesn't fit");
+
+   /// \brief the start of a record, the message follows
+   typedef SSegmentRecordHeader SRecordHeader;
+   const size_t recordAlignment = SRecordHeader::alignment;
+   const size_t minSegmentSize = 64 * 1024;
+   const size_t maxSegmentSize = size_t(1) << 40;
+}
+
+const std::string CDeliveryLog::filePrefix = "delivery-";
+
+struct CDeliveryLog::SSegment {
+   SSegment(const std::string &path, size_t size, bool populate)
+         : file(path, size, populate), firstSequence(0), nextSequence(0),
+           count(0), writeOffset(headerSize), flushedEnd(headerSize), syncedEnd(headerSize),
+           sessionKnown(false), sessionId(0), streamId(0) {}
+
+   SLogHeader& header() { return *reinterpret_cast<SLogHeader*>(file.getData()); }
+   const SRecordHeader& record(size_t offset) const
+      { return *reinterpret_cast<const SRecordHeader*>(file.getData() + offset); }
+   bool fits(size_t recordSize) const { return writeOffset + recordSize <= file.getSize(); }
+   /// \brief reads the header of an existing segment
+   /// \return false when the segment was never used
+   bool recover();
+   /// \brief returns false when the segment goes back in the stream or is of an other
+   ///        session, then it was written after a restart without the log
+   bool follows(const SSegment &previous) const
+   {
+      return !CSequenceNumber::isBefore(firstSequence, previous.nextSequence) &&
+             sessionKnown == previous.sessionKnown && sessionId == previous.sessionId &&
+             streamId == previous.streamId;
+   }
+
+   CMappedFile file;
+   uint64_t firstSequence;
+   /// \brief after the last record, or the watermark of the log in the last segment
+   uint64_t nextSequence;
+   uint64_t count;
+   size_t writeOffset;
+   /// \brief where the write back is started by flush(false)
+   size_t flushedEnd;
+   /// \brief what is on the disk after flush(true)
+   size_t syncedEnd;
+   bool sessionKnown;
+   uint32_t sessionId;
+   uint32_t streamId;
+};
+
+bool CDeliveryLog::SSegment::recover()
+{
+   const SLogHeader &logHeader = header();
+
+   if(file.getSize() < minSegmentSize)
+      throw std::runtime_error("Error log segment " + file.getPath() + " is too small");
+   // without it the header page would bring a read ahead window of records along
+   file.adviseRandom(0, headerSize);
+   if(memcmp(logHeader.magic, logMagic, sizeof(logMagic)) != 0)
+   {
+      if(std::any_of(logHeader.magic, logHeader.magic + sizeof(logMagic),
+                     [](char c) { return c != 0; }))
+         throw std::runtime_error("Error " + file.getPath() + " is no log segment");
+      // made in advance and never used
+      return false;
+   }
+   if(logHeader.version != logVersion || logHeader.recordsEnd < headerSize ||
+      logHeader.recordsEnd > file.getSize() || logHeader.recordsEnd % recordAlignment != 0)
+   {
+      std::ostringstream message;
+      message << "Error log segment " << file.getPath() << " has version " << logHeader.version
+              << " and ends at " << logHeader.recordsEnd;
+      throw std::runtime_error(message.str());
+   }
+   firstSequence = logHeader.firstSequence;
+   nextSequence = logHeader.nextSequence;
+   count = logHeader.count;
+   sessionKnown = (logHeader.flags & logFlagSession) != 0;
+   sessionId = logHeader.sessionId;
+   streamId = logHeader.streamId;
+   writeOffset = flushedEnd = syncedEnd = size_t(logHeader.recordsEnd);
+   return count > 0;
+}
+
+CDeliveryLog::CDeliveryLog(const std::string &directory, size_t segmentSize,
+               size_t maxSegments) : segments(directory, filePrefix, segmentSize, maxSegments),
+               nextSequence(0), durableSequence(0), count(0), recoveredCount(0),
+               sessionKnown(false), sessionId(0), streamId(0)
+{
+   if(segmentSize < minSegmentSize || segmentSize > maxSegmentSize)
+   {
+      std::ostringstream message;
+      message << "Error log segment size " << segmentSize << " is not between "
+              << minSegmentSize << " and " << maxSegmentSize;
+      throw std::runtime_error(message.str());
+   }
+   if(maxSegments == 0)
+      throw std::runtime_error("Error a log needs at least 1 segment");
+
+   segments.recover();
+   for(const std::unique_ptr<SSegment> &segment : segments)
+      count += segment->count;
+   if(!segments.empty())
+   {
+      nextSequence = durableSequence = segments.back()->nextSequence;
+      sessionKnown = segments.back()->sessionKnown;
+      sessionId = segments.back()->sessionId;
+      streamId = segments.back()->streamId;
+   }
+   recoveredCount = count;
+   count -= segments.removeOldSegments();
+}
+
+CDeliveryLog::~CDeliveryLog()
+{
+}
+
+bool CDeliveryLog::append(uint64_t sequence, const uint8_t *message, size_t length)
+{
+   const size_t recordSize = SRecordHeader::getRecordSize(length);
+
+   if((!segments.empty() && CSequenceNumber::isBefore(sequence, nextSequence)) ||
+      length > getMaxLength())
+      return false;
+   if(segments.empty() || !segments.back()->fits(recordSize))
+      addSegment(sequence);
+
+   SSegment &segment = *segments.back();
+   uint8_t *record = segment.file.getData() + segment.writeOffset;
+   const SRecordHeader recordHeader = { sequence, uint32_t(length), 0 };
+   memcpy(record, &recordHeader, sizeof(recordHeader));
+   memcpy(record + sizeof(recordHeader), message, length);
+   segment.writeOffset += recordSize;
+   segment.count++;
+   segment.nextSequence = sequence + 1;
+   nextSequence = sequence + 1;
+   count++;
+   return true;
+}
+
+void CDeliveryLog::setSession(uint32_t sessionId, uint32_t streamId)
+{
+   if(sessionKnown && sessionId == this->sessionId && streamId == this->streamId)
+      return;
+
+   // the sequence numbers of the old session don't continue in this one
+   segments.removeSegments();
+   count = 0;
+   nextSequence = durableSequence = 0;
+   sessionKnown = true;
+   this->sessionId = sessionId;
+   this->streamId = streamId;
+}
+
+void CDeliveryLog::advance(uint64_t next)
+{
+   if(!segments.empty() && !CSequenceNumber::isAfter(next, nextSequence))
+      return;
+   nextSequence = next;
+   if(!segments.empty())
+      segments.back()->nextSequence = next;
+}
+
+size_t CDeliveryLog::getMaxLength() const
+{
+   return (segments.getSegmentSize() - headerSize) / recordAlignment * recordAlignment -
+          sizeof(SRecordHeader);
+}
+
+uint64_t CDeliveryLog::getOldestSequence() const
+{
+   return segments.empty() ? nextSequence : segments.front()->firstSequence;
+}
+
+void CDeliveryLog::flush(bool synchronous)
+{
+   const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+
+   // only the last segments have something new, a full segment is written back whole
+   for(auto it = segments.rbegin(); it != segments.rend(); ++it)
+   {
+      SSegment &segment = **it;
+      const bool current = it == segments.rbegin();
+      size_t &done = synchronous ? segment.syncedEnd : segment.flushedEnd;
+      SLogHeader &logHeader = segment.header();
+
+      if(!current && done == segment.writeOffset)
+         break;
+      // the page that is being filled is left alone, the next append would wait for it
+      const size_t end = (synchronous || !current) ? segment.writeOffset :
+                         segment.writeOffset - segment.writeOffset % pageSize;
+      if(end > done)
+      {
+         segment.file.flush(done, end - done, synchronous);
+         done = end;
+      }
+      if(synchronous && (logHeader.recordsEnd != segment.writeOffset ||
+                         logHeader.nextSequence != segment.nextSequence))
+      {
+         // the records are on the disk, now the header may point to them
+         logHeader.recordsEnd = segment.writeOffset;
+         logHeader.nextSequence = segment.nextSequence;
+         logHeader.count = segment.count;
+         segment.file.flush(0, headerSize, true);
+         segment.flushedEnd = segment.syncedEnd;
+      }
+   }
+   if(synchronous)
+      durableSequence = nextSequence;
+
+   if(segments.empty() || segments.back()->writeOffset > segments.back()->file.getSize() / 2)
+      segments.makeSpare();
+   count -= segments.removeOldSegments();
+}
+
+CDeliveryLog::SPosition CDeliveryLog::seek(uint64_t sequence) const
+{
+   // the segments are in order, compare the distances from the oldest to survive a wrap around
+   const uint64_t oldest = getOldestSequence();
+   if(segments.empty() || CSequenceNumber::isBefore(sequence, oldest))
+      return { 0, headerSize };
+   auto it = std::upper_bound(segments.begin(), segments.end(), sequence - oldest,
+                              [oldest](uint64_t value, const std::unique_ptr<SSegment> &segment)
+                              { return value < segment->firstSequence - oldest; });
+   SPosition position = { size_t(it - segments.begin()) - 1, headerSize };
+   const SSegment &segment = *segments[position.segment];
+
+   while(position.offset < segment.writeOffset &&
+         CSequenceNumber::isBefore(segment.record(position.offset).sequence, sequence))
+      position.offset += SRecordHeader::getRecordSize(segment.record(position.offset).length);
+   return position;
+}
+
+bool CDeliveryLog::next(SPosition &position, SRecord &record) const
+{
+   while(position.segment < segments.size())
+   {
+      const SSegment &segment = *segments[position.segment];
+      if(position.offset < segment.writeOffset)
+      {
+         const SRecordHeader &recordHeader = segment.record(position.offset);
+         record = { recordHeader.sequence, segment.file.getData() + position.offset +
+                    sizeof(SRecordHeader), recordHeader.length };
+         position.offset += SRecordHeader::getRecordSize(recordHeader.length);
+         return true;
+      }
+      position = { position.segment + 1, headerSize };
+   }
+   return false;
+}
+
+void CDeliveryLog::addSegment(uint64_t sequence)
+{
+   SSegment &segment = segments.addSegment();
+
+   segment.firstSequence = sequence;
+   segment.nextSequence = sequence;
+   segment.sessionKnown = sessionKnown;
+   segment.sessionId = sessionId;
+   segment.streamId = streamId;
+   SLogHeader &logHeader = segment.header();
+   logHeader.version = logVersion;
+   logHeader.flags = sessionKnown ? logFlagSession : 0;
+   logHeader.sessionId = sessionId;
+   logHeader.streamId = streamId;
+   logHeader.firstSequence = sequence;
+   logHeader.recordsEnd = headerSize;
+   logHeader.nextSequence = sequence;
+   logHeader.count = 0;
+   memcpy(logHeader.magic, logMagic, sizeof(logMagic));
+}
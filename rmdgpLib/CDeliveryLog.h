@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CDeliveryLog.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 7, 2021, 9:40 AM
+ */
+
+#ifndef CDELIVERYLOG_H
+#define CDELIVERYLOG_H
+
+#include "../socketLib/CSegmentDirectory.h"
+#include <memory>
+#include <string>
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief A durable log of the messages that a receiver delivered, in memory mapped segment
+///        files, with the delivered watermark: the sequence number after the last delivered
+///        message. A restarted receiver replays the log locally and asks the sender only for
+///        what comes after the watermark, see CRmdgpReceiver::setResume.
+///        The sequence numbers in the log go up but may have gaps, a datagram that was lost for
+///        good is not in it. A segment is a preallocated file of segmentSize bytes: a header
+///        page with the session, the end of the records and the watermark, then the records.
+///        So opening the log reads one page per segment, whatever the size of the log.
+///        append only copies in the mapping. flush starts the write back of the full pages,
+///        makes the next segment in advance and removes the segments beyond maxSegments; call
+///        it regularly, for instance from the timer of the receiver. flush(true) waits until
+///        the records are on the disk and only then updates the header, so a reopened log,
+///        after a crash of the process or of the machine, holds what was there at the last
+///        flush(true) and continues at getDurableSequence().
+///        The segments also hold the session and stream of the messages, see setSession. The
+///        sequence numbers of one session mean nothing in an other one, so a receiver resumes
+///        only in the session of the log.
+///        The files are read and written in the byte order of the machine.
+class CDeliveryLog {
+public:
+    /// \brief a delivered message in the log
+    struct SRecord {
+        uint64_t sequence;
+        const uint8_t *data;
+        size_t length;
+    };
+    /// \brief a place in the log to read from, see seek. It is valid until the next flush.
+    struct SPosition {
+        size_t segment;
+        size_t offset;
+    };
+
+    /// \brief opens the log in directory and maps the segments that are there, the log
+    ///        continues after them
+    /// \param directory where the segment files are, it is created when it doesn't exist
+    /// \param segmentSize the size of a segment file
+    /// \param maxSegments the number of segments that are kept, the oldest are removed
+    /// \throws std::runtime_error when segmentSize is too small or too large, maxSegments is 0,
+    ///         a segment is damaged or a file can't be made or mapped
+    CDeliveryLog(const std::string &directory, size_t segmentSize = defaultSegmentSize,
+                 size_t maxSegments = defaultMaxSegments);
+    CDeliveryLog(const CDeliveryLog& orig) = delete;
+    CDeliveryLog& operator=(const CDeliveryLog& other) = delete;
+    virtual ~CDeliveryLog();
+
+    /// \brief adds a delivered message, the watermark moves to the next sequence number
+    /// \return false when sequence is before getNextSequence() or the message doesn't fit in
+    ///         an empty segment
+    /// \throws std::runtime_error when a new segment is needed, the one made in advance is not
+    ///         there and it can't be made
+    bool append(uint64_t sequence, const uint8_t *message, size_t length);
+    /// \brief sets the session and stream of the messages that are appended from now on, call
+    ///        it before the first append of a session. When the log holds an other session or
+    ///        stream, that history doesn't belong to it: its segments are removed and the log
+    ///        starts empty.
+    void setSession(uint32_t sessionId, uint32_t streamId);
+    /// \brief moves the watermark to next without a message, for datagrams that are given up
+    ///        or that the application doesn't log. flush(true) keeps it in the last segment, so
+    ///        it is lost when there is none yet.
+    void advance(uint64_t next);
+
+    /// \brief starts the write back of the full pages that were appended since the previous
+    ///        flush, makes the next segment when there is none or the current one is half full,
+    ///        and removes the oldest segments beyond maxSegments
+    /// \param synchronous true to wait until the appended messages and the watermark are on
+    ///        the disk
+    /// \throws std::runtime_error when OS reports an error.
+    void flush(bool synchronous = false);
+
+    /// \brief returns the position of the first message at or after sequence
+    SPosition seek(uint64_t sequence) const;
+    /// \brief reads the message at position and moves position to the next one
+    /// \return false when there are no more messages
+    bool next(SPosition &position, SRecord &record) const;
+
+    bool isEmpty() const { return count == 0; }
+    /// \brief returns true when the log has a session, from setSession or the opened log
+    bool hasSession() const { return sessionKnown; }
+    /// \brief returns the session of the log, see hasSession
+    uint32_t getSessionId() const { return sessionId; }
+    /// \brief returns the stream of the log, see hasSession
+    uint32_t getStreamId() const { return streamId; }
+    /// \brief returns the sequence number of the oldest message in the log
+    uint64_t getOldestSequence() const;
+    /// \brief returns the delivered watermark, everything before it is delivered
+    uint64_t getNextSequence() const { return nextSequence; }
+    /// \brief returns the watermark of the last flush(true), or of the opened log
+    uint64_t getDurableSequence() const { return durableSequence; }
+    /// \brief returns the number of messages in the log
+    uint64_t getCount() const { return count; }
+    /// \brief returns the number of messages that were found when the log was opened
+    uint64_t getRecoveredCount() const { return recoveredCount; }
+    size_t getSegmentCount() const { return segments.size(); }
+    /// \brief returns the length of the largest message that fits in a segment
+    size_t getMaxLength() const;
+    const std::string& getDirectory() const { return segments.getDirectory(); }
+
+    /// \brief 64 MB
+    static constexpr size_t defaultSegmentSize = size_t(64) << 20;
+    /// \brief without a limit
+    static constexpr size_t defaultMaxSegments = SIZE_MAX;
+    /// \brief the segment files are named prefix followed by their number
+    static const std::string filePrefix;
+
+private:
+    /// \brief a mapped segment file, see CDeliveryLog.cpp
+    struct SSegment;
+
+    /// \brief starts a new segment with sequence as first message
+    void addSegment(uint64_t sequence);
+
+    CSegmentDirectory<SSegment> segments;
+    uint64_t nextSequence;
+    uint64_t durableSequence;
+    uint64_t count;
+    uint64_t recoveredCount;
+    bool sessionKnown;
+    uint32_t sessionId;
+    uint32_t streamId;
+};
+
+#endif /* CDELIVERYLOG_H */
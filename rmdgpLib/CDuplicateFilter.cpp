@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CDuplicateFilter.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 24, 2021, 7:30 PM
+ */
+
+#include "CDuplicateFilter.h"
+#include "CSequenceNumber.h"
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+
+namespace {
+   // prevents an overflow when the window is rounded up
+   const size_t maxWindow = size_t(1) << 40;
+}
+
+CDuplicateFilter::CDuplicateFilter(size_t window, uint64_t base) : windowBits(64), wordMask(0),
+               base(base), checkCount(0), duplicateCount(0), beyondWindowCount(0)
+{
+   if(window == 0 || window > maxWindow)
+   {
+      std::ostringstream message;
+      message << "Error invalid duplicate filter window " << window;
+      throw std::runtime_error(message.str());
+   }
+
+   while(windowBits < window)
+      windowBits <<= 1;
+   wordMask = windowBits / 64 - 1;
+   bits.reset(new uint64_t[windowBits / 64]());
+}
+
+CDuplicateFilter::~CDuplicateFilter()
+{
+}
+
+void CDuplicateFilter::advance(uint64_t newBase)
+{
+   if(!CSequenceNumber::isAfter(newBase, base))
+      return;
+
+   // the bits of the passed sequence numbers are reused by the ones at the end of the window
+   if(newBase - base >= windowBits)
+      memset(bits.get(), 0, windowBits / 8);
+   else
+      clearRange(base, newBase);
+   base = newBase;
+}
+
+void CDuplicateFilter::reset(uint64_t newBase)
+{
+   memset(bits.get(), 0, windowBits / 8);
+   base = newBase;
+}
+
+void CDuplicateFilter::clearRange(uint64_t begin, uint64_t end)
+{
+   while(begin != end)
+   {
+      const unsigned firstBit = unsigned(begin & 63);
+      const uint64_t bitsInWord = 64 - firstBit;
+      const uint64_t count = (end - begin < bitsInWord) ? end - begin : bitsInWord;
+      const uint64_t mask = (count == 64) ? ~uint64_t(0) : ((uint64_t(1) << count) - 1) << firstBit;
+
+      bits[(begin >> 6) & wordMask] &= ~mask;
+      begin += count;
+   }
+}
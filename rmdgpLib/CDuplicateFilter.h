@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CDuplicateFilter.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 24, 2021, 7:30 PM
+ */
+
+#ifndef CDUPLICATEFILTER_H
+#define CDUPLICATEFILTER_H
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief Filters datagrams that were received before, for instance multicast repairs that
+///        were asked for by an other receiver. A sliding bitmap window is anchored at the
+///        delivered watermark (getBase()): everything before it was received, every bit in the
+///        window tells whether that sequence number was received. A check is a subtraction, a
+///        compare and a bit test and set; there is no hashing and nothing is allocated after
+///        construction.
+class CDuplicateFilter {
+public:
+    /// \brief the result of checkAndSet
+    enum class EResult {
+        fresh,          ///< not received before, now marked as received
+        duplicate,      ///< received before, or before the base
+        beyondWindow    ///< too far ahead to track, not marked
+    };
+
+    /// \param window the number of sequence numbers after the base that are tracked, rounded up
+    ///        to a power of two of at least 64
+    /// \param base the first sequence number that can be received
+    /// \throws std::runtime_error when window is 0 or too large
+    CDuplicateFilter(size_t window, uint64_t base = 0);
+    CDuplicateFilter(const CDuplicateFilter& orig) = delete;
+    CDuplicateFilter& operator=(const CDuplicateFilter& other) = delete;
+    virtual ~CDuplicateFilter();
+
+    /// \brief checks whether sequence was received before and marks it as received
+    EResult checkAndSet(uint64_t sequence)
+    {
+        const uint64_t offset = sequence - base;
+
+        checkCount++;
+        if(offset >= windowBits)
+        {
+            // before the base is a huge offset too
+            if(int64_t(offset) < 0)
+            {
+                duplicateCount++;
+                return EResult::duplicate;
+            }
+            beyondWindowCount++;
+            return EResult::beyondWindow;
+        }
+
+        uint64_t &word = bits[(sequence >> 6) & wordMask];
+        const uint64_t bit = uint64_t(1) << (sequence & 63);
+        const uint64_t seen = (word & bit) >> (sequence & 63);
+        word |= bit;
+        duplicateCount += seen;
+        return seen ? EResult::duplicate : EResult::fresh;
+    }
+
+    /// \brief unmarks sequence, for a datagram that was accepted by checkAndSet but couldn't be
+    ///        kept after all, so a retransmission of it is fresh again
+    void clear(uint64_t sequence)
+    {
+        if(sequence - base < windowBits)
+            bits[(sequence >> 6) & wordMask] &= ~(uint64_t(1) << (sequence & 63));
+    }
+
+    /// \brief moves the base forward to the new delivered watermark. A base before the current
+    ///        one is ignored.
+    void advance(uint64_t newBase);
+
+    /// \brief forgets everything and starts at base
+    void reset(uint64_t base);
+
+    uint64_t getBase() const { return base; }
+    /// \brief returns the number of tracked sequence numbers after the base
+    size_t getWindow() const { return windowBits; }
+
+    uint64_t getCheckCount() const { return checkCount; }
+    uint64_t getDuplicateCount() const { return duplicateCount; }
+    uint64_t getBeyondWindowCount() const { return beyondWindowCount; }
+    /// \brief returns the fraction of the checked datagrams that were duplicates
+    double getDuplicateRate() const
+        { return checkCount ? double(duplicateCount) / double(checkCount) : 0.0; }
+    /// \brief sets the counters to 0
+    void resetCounters() { checkCount = duplicateCount = beyondWindowCount = 0; }
+
+private:
+    /// \brief clears the bits of the sequence numbers from begin up to (excluding) end, that are
+    ///        less than a window apart
+    void clearRange(uint64_t begin, uint64_t end);
+
+    uint64_t windowBits;
+    size_t wordMask;
+    std::unique_ptr<uint64_t[]> bits;
+    uint64_t base;
+    uint64_t checkCount;
+    uint64_t duplicateCount;
+    uint64_t beyondWindowCount;
+};
+
+#endif /* CDUPLICATEFILTER_H */
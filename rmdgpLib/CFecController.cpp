@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CFecController.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 3, 2021, 10:15 AM
+ */
+
+#include "CFecController.h"
+#include "CFecEncoder.h"
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+   // the block sizes to choose from, a larger block delays its parity
+   const size_t blockSizes[] = { 4, 8, 16, 32 };
+}
+
+CFecController::CFecController(double targetResidualLoss, size_t maxParityRows,
+               double maxOverhead, const CNanoTime &holdTime) : target(targetResidualLoss),
+               maxParityRows(maxParityRows), maxOverhead(maxOverhead), holdTime(holdTime),
+               lossEstimate(0), lastUpdate(), updated(false), blockSize(0), parityRows(0),
+               residualLoss(0), changeCount(0)
+{
+   if(!(targetResidualLoss > 0 && targetResidualLoss < 1) || maxParityRows == 0 ||
+      maxParityRows > CFecEncoder::maxParityRows || !(maxOverhead > 0) ||
+      holdTime <= CNanoTime())
+   {
+      std::ostringstream message;
+      message << "Error FEC controller with target " << targetResidualLoss << ", "
+              << maxParityRows << " parity rows, overhead " << maxOverhead << " and hold time "
+              << holdTime;
+      throw std::runtime_error(message.str());
+   }
+}
+
+CFecController::~CFecController()
+{
+}
+
+bool CFecController::update(double lossRate, const CNanoTime &now)
+{
+   const size_t oldBlockSize = blockSize;
+   const size_t oldParityRows = parityRows;
+
+   if(lossRate >= lossEstimate || !updated)
+      lossEstimate = lossRate;
+   else
+   {
+      const double elapsed = double((now - lastUpdate).getNsec());
+      lossEstimate = lossRate + (lossEstimate - lossRate) *
+                                std::exp(-elapsed / double(holdTime.getNsec()));
+   }
+   lastUpdate = now;
+   updated = true;
+
+   choose();
+   if(blockSize == oldBlockSize && parityRows == oldParityRows)
+      return false;
+   changeCount++;
+   return true;
+}
+
+void CFecController::choose()
+{
+   blockSize = 0;
+   parityRows = 0;
+   residualLoss = lossEstimate;
+   if(lossEstimate <= target)
+      return;
+
+   double bestOverhead = 0;
+   bool reached = false;
+   for(size_t k : blockSizes)
+   {
+      for(size_t m = 1; m <= maxParityRows && double(m) <= maxOverhead * double(k); m++)
+      {
+         const double overhead = double(m) / double(k);
+         const double residual = getResidualLoss(k, m, lossEstimate);
+         const bool better = (residual <= target) ?
+                  (!reached || overhead < bestOverhead) : (!reached && residual < residualLoss);
+         if(better)
+         {
+            blockSize = k;
+            parityRows = m;
+            residualLoss = residual;
+            bestOverhead = overhead;
+            reached = (residual <= target);
+         }
+         // more rows for this block size only cost more
+         if(residual <= target)
+            break;
+      }
+   }
+}
+
+double CFecController::getResidualLoss(size_t blockSize, size_t parityRows, double lossRate)
+{
+   if(blockSize == 0)
+      return lossRate;
+   if(lossRate <= 0)
+      return 0;
+   if(lossRate >= 1)
+      return 1;
+
+   // the binomial probabilities of x losses in n datagrams, from x = 0 up
+   const size_t n = blockSize + parityRows;
+   const double ratio = lossRate / (1 - lossRate);
+   double probability = std::pow(1 - lossRate, double(n));
+   double residual = 0;
+   for(size_t x = 1; x <= n; x++)
+   {
+      probability *= ratio * double(n - x + 1) / double(x);
+      if(x > parityRows)
+         residual += probability * double(x) / double(n);
+   }
+   return residual;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CFecController.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 3, 2021, 10:15 AM
+ */
+
+#ifndef CFECCONTROLLER_H
+#define CFECCONTROLLER_H
+
+#include "../socketLib/CNanoTime.h"
+#include <stddef.h>
+
+/// \brief Chooses the FEC block size k and the number of parity rows m from the loss rate of
+///        the receivers, so the part of the datagrams that FEC can't rebuild stays below a
+///        target and no more parity is sent than needed. On a clean network FEC is off.
+///        A block of k data and m parity datagrams loses x of them with a binomial
+///        probability; when x > m nothing of the block is rebuilt, so the residual loss is
+///        the sum over x > m of P(x) * x / (k + m). Of all (k, m) that reach the target, the
+///        one with the least overhead m / k is taken, the smaller block on a tie because its
+///        parity comes sooner. When none reaches it, the one with the least residual loss.
+///        A rise of the loss rate is followed at once, a fall slowly, with holdTime as time
+///        constant, so a loss spike doesn't make the choice flap.
+///        Changes take effect at a block boundary, see CRmdgpSender::setFecBlockSize.
+class CFecController {
+public:
+    /// \param targetResidualLoss the part of the datagrams that may be left to the NAKs
+    /// \param maxParityRows the most parity rows per block, 1 to CFecEncoder::maxParityRows
+    /// \param maxOverhead the most parity datagrams per data datagram
+    /// \param holdTime the time constant of a falling loss rate
+    /// \throws std::runtime_error when a parameter is out of range
+    CFecController(double targetResidualLoss, size_t maxParityRows = defaultMaxParityRows,
+                   double maxOverhead = defaultMaxOverhead,
+                   const CNanoTime &holdTime = defaultHoldTime);
+    CFecController(const CFecController& orig) = delete;
+    CFecController& operator=(const CFecController& other) = delete;
+    virtual ~CFecController();
+
+    /// \brief registers the loss rate, for instance the worst one of the receivers, and
+    ///        chooses again
+    /// \param now the current CLOCK_MONOTONIC time
+    /// \return true when the choice changed
+    bool update(double lossRate, const CNanoTime &now);
+
+    /// \brief returns the chosen block size, 0 for no FEC
+    size_t getBlockSize() const { return blockSize; }
+    /// \brief returns the chosen number of parity rows, 0 for no FEC
+    size_t getParityRows() const { return parityRows; }
+    /// \brief returns the loss rate that the choice is based on
+    double getLossEstimate() const { return lossEstimate; }
+    /// \brief returns the expected residual loss of the choice
+    double getResidualLoss() const { return residualLoss; }
+    /// \brief returns the number of times the choice changed
+    uint64_t getChangeCount() const { return changeCount; }
+    /// \brief returns the most parity rows that are chosen
+    size_t getMaxParityRows() const { return maxParityRows; }
+
+    /// \brief returns the expected part of the data datagrams that FEC can't rebuild
+    /// \param blockSize k, 0 for no FEC
+    /// \param parityRows m
+    /// \param lossRate the independent loss probability of every datagram
+    static double getResidualLoss(size_t blockSize, size_t parityRows, double lossRate);
+
+    static constexpr size_t defaultMaxParityRows = 8;
+    static constexpr double defaultMaxOverhead = 0.5;
+    static constexpr CNanoTime defaultHoldTime = CNanoTime::fromSec(2);
+
+private:
+    /// \brief chooses blockSize and parityRows for lossEstimate
+    void choose();
+
+    const double target;
+    const size_t maxParityRows;
+    const double maxOverhead;
+    const CNanoTime holdTime;
+    double lossEstimate;
+    CNanoTime lastUpdate;
+    bool updated;
+    size_t blockSize;
+    size_t parityRows;
+    double residualLoss;
+    uint64_t changeCount;
+};
+
+#endif /* CFECCONTROLLER_H */
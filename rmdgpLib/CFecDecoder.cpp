@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CFecDecoder.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 30, 2021, 10:20 PM
+ */
+
+#include "CFecDecoder.h"
+#include "CFecEncoder.h"
+#include "CGaloisField.h"
+#include "CReedSolomon.h"
+#include "CRmdgpHeader.h"
+#include "CSequenceNumber.h"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+
+CFecDecoder::CFecDecoder(size_t maxPayloadSize, size_t maxBlocks, size_t parityRows) :
+               maxPayloadSize(maxPayloadSize), parityRows(parityRows),
+               shardSize(CFecEncoder::parityHeaderSize + maxPayloadSize),
+               blocks(maxBlocks, SBlock()), accumulators(maxBlocks * parityRows * shardSize),
+               recoverable(), shard(shardSize), matrix(), lastSlot(0), recoveredCount(0),
+               parityCount(0), droppedCount(0)
+{
+   if(maxBlocks == 0)
+   {
+      std::ostringstream message;
+      message << "Error FEC decoder needs at least 1 block";
+      throw std::runtime_error(message.str());
+   }
+   if(parityRows == 0 || parityRows > CFecEncoder::maxParityRows)
+   {
+      std::ostringstream message;
+      message << "Error FEC decoder with " << parityRows << " parity rows, the maximum is "
+              << CFecEncoder::maxParityRows;
+      throw std::runtime_error(message.str());
+   }
+   recoverable.reserve(maxBlocks);
+}
+
+CFecDecoder::~CFecDecoder()
+{
+}
+
+bool CFecDecoder::addData(uint64_t sequence, uint8_t blockSize, uint8_t index,
+                    const uint8_t *payload, size_t length)
+{
+   if(index >= blockSize || blockSize > CFecEncoder::maxBlockSize || length > maxPayloadSize)
+      return false;
+
+   const size_t slot = findBlock(sequence - index, blockSize);
+   const SBlock &block = blocks[slot];
+   if((block.receivedMask & (uint64_t(1) << index)) || index >= block.blockSize)
+      return false;
+
+   return addShard(slot, index, payload, length);
+}
+
+bool CFecDecoder::addParity(uint64_t firstSequence, uint8_t blockSize, uint8_t row,
+                    const uint8_t *payload, size_t length)
+{
+   if(blockSize == 0 || blockSize > CFecEncoder::maxBlockSize || row >= parityRows ||
+      length < CFecEncoder::parityHeaderSize || length > shardSize)
+      return false;
+
+   const size_t slot = findBlock(firstSequence, blockSize);
+   SBlock &block = blocks[slot];
+   const uint64_t bit = uint64_t(1) << row;
+   if(block.parityMask & bit)
+      return false;
+
+   // a block that was cut short has fewer datagrams than the data datagrams announced
+   parityCount++;
+   block.parityMask |= bit;
+   block.blockSize = blockSize;
+   if(block.receivedCount >= blockSize)
+   {
+      free(slot);
+      return false;
+   }
+   CGaloisField::mulAddInto(1, getAccumulator(slot, row), payload, length);
+   block.accumulatedLength = uint16_t(std::max(size_t(block.accumulatedLength), length));
+   return checkRecoverable(slot);
+}
+
+size_t CFecDecoder::recover(uint8_t *datagram, size_t maxLength, uint32_t sessionId,
+                    uint32_t streamId)
+{
+   if(recoverable.empty())
+      return 0;
+
+   const size_t slot = recoverable.back();
+   recoverable.pop_back();
+   const SBlock &block = blocks[slot];
+   const uint64_t all = (block.blockSize == 64) ? UINT64_MAX :
+                                                  (uint64_t(1) << block.blockSize) - 1;
+   uint64_t missingMask = all & ~block.receivedMask;
+   const size_t count = size_t(__builtin_popcountll(missingMask));
+   size_t missing[CFecEncoder::maxBlockSize];
+   size_t rows[CFecEncoder::maxBlockSize];
+
+   for(size_t i = 0; i < count; i++, missingMask &= missingMask - 1)
+      missing[i] = size_t(__builtin_ctzll(missingMask));
+   uint64_t parityMask = block.parityMask;
+   for(size_t i = 0; i < count; i++, parityMask &= parityMask - 1)
+      rows[i] = size_t(__builtin_ctzll(parityMask));
+
+   // the accumulator of row r holds the sum over the missing j of coefficient(r, j) * shard j,
+   // rebuild the first missing shard with the first row of the inverse
+   matrix.resize(count * count);
+   for(size_t i = 0; i < count; i++)
+      for(size_t j = 0; j < count; j++)
+         matrix[i * count + j] = CReedSolomon::getCoefficient(rows[i], missing[j]);
+   const size_t accumulatedLength = block.accumulatedLength;
+   if(!CReedSolomon::invert(matrix.data(), count))
+   {
+      free(slot);
+      return 0;
+   }
+   memset(shard.data(), 0, accumulatedLength);
+   for(size_t i = 0; i < count; i++)
+      CGaloisField::mulAddInto(matrix[i], shard.data(), getAccumulator(slot, rows[i]),
+                               accumulatedLength);
+
+   // a parity that doesn't match the data can't be trusted
+   const size_t length = CRmdgpHeader::load16(shard.data());
+   if(CFecEncoder::parityHeaderSize + length > accumulatedLength ||
+      CRmdgpHeader::size + length > maxLength)
+   {
+      free(slot);
+      return 0;
+   }
+
+   CRmdgpHeaderBuilder(datagram).setType(ERmdgpPacketType::data).setFlags(rmdgpFlagRetransmission)
+                   .setPayloadLength(uint16_t(length)).setSessionId(sessionId)
+                   .setStreamId(streamId).setSequence(block.firstSequence + missing[0]);
+   memcpy(datagram + CRmdgpHeader::size, &shard[CFecEncoder::parityHeaderSize], length);
+   recoveredCount++;
+
+   // the rebuilt shard takes part in the rest of the block like a received one
+   addShard(slot, missing[0], &shard[CFecEncoder::parityHeaderSize], length);
+   return CRmdgpHeader::size + length;
+}
+
+size_t CFecDecoder::findBlock(uint64_t firstSequence, uint8_t blockSize)
+{
+   // the datagrams of a block arrive together, so the last block is the common case
+   if(blocks[lastSlot].used && blocks[lastSlot].firstSequence == firstSequence)
+      return lastSlot;
+
+   size_t freeSlot = blocks.size();
+   size_t oldest = 0;
+   for(size_t slot = 0; slot < blocks.size(); slot++)
+   {
+      const SBlock &block = blocks[slot];
+      if(!block.used)
+      {
+         freeSlot = std::min(freeSlot, slot);
+         continue;
+      }
+      if(block.firstSequence == firstSequence)
+      {
+         lastSlot = slot;
+         return slot;
+      }
+      if(CSequenceNumber::isBefore(block.firstSequence, blocks[oldest].firstSequence) ||
+         !blocks[oldest].used)
+         oldest = slot;
+   }
+
+   if(freeSlot == blocks.size())
+   {
+      freeSlot = oldest;
+      free(oldest);
+      droppedCount++;
+   }
+   blocks[freeSlot] = { firstSequence, 0, 0, 0, blockSize, 0, true };
+   lastSlot = freeSlot;
+   return freeSlot;
+}
+
+void CFecDecoder::accumulate(size_t slot, size_t index, const uint8_t *payload, size_t length)
+{
+   SBlock &block = blocks[slot];
+   uint8_t shardLength[CFecEncoder::parityHeaderSize];
+
+   CRmdgpHeader::store16(shardLength, uint16_t(length));
+   for(size_t row = 0; row < parityRows; row++)
+   {
+      const uint8_t coefficient = CReedSolomon::getCoefficient(row, index);
+      uint8_t *accumulator = getAccumulator(slot, row);
+
+      CGaloisField::mulAddInto(coefficient, accumulator, shardLength, sizeof(shardLength));
+      CGaloisField::mulAddInto(coefficient, accumulator + sizeof(shardLength), payload, length);
+   }
+   block.accumulatedLength = uint16_t(std::max(size_t(block.accumulatedLength),
+                                               sizeof(shardLength) + length));
+}
+
+bool CFecDecoder::addShard(size_t slot, size_t index, const uint8_t *payload, size_t length)
+{
+   SBlock &block = blocks[slot];
+
+   block.receivedMask |= uint64_t(1) << index;
+   block.receivedCount++;
+   if(block.receivedCount == block.blockSize)
+   {
+      // nothing to recover, whatever the parities bring
+      free(slot);
+      return false;
+   }
+   accumulate(slot, index, payload, length);
+   return checkRecoverable(slot);
+}
+
+bool CFecDecoder::checkRecoverable(size_t slot)
+{
+   const SBlock &block = blocks[slot];
+
+   if(block.receivedCount >= block.blockSize ||
+      size_t(__builtin_popcountll(block.parityMask)) < size_t(block.blockSize - block.receivedCount) ||
+      std::find(recoverable.begin(), recoverable.end(), slot) != recoverable.end())
+      return false;
+   recoverable.push_back(slot);
+   return true;
+}
+
+void CFecDecoder::free(size_t slot)
+{
+   SBlock &block = blocks[slot];
+
+   // only the accumulated part needs clearing
+   for(size_t row = 0; row < parityRows; row++)
+      memset(getAccumulator(slot, row), 0, block.accumulatedLength);
+   block.used = false;
+   recoverable.erase(std::remove(recoverable.begin(), recoverable.end(), slot),
+                     recoverable.end());
+}
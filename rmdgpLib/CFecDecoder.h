@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CFecDecoder.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 30, 2021, 10:20 PM
+ */
+
+#ifndef CFECDECODER_H
+#define CFECDECODER_H
+
+#include <memory>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief Rebuilds lost data datagrams from the other datagrams of their FEC block and the
+///        parity datagrams, see CFecEncoder for the format.
+///        Every received datagram of a block is multiplied into an accumulator per parity row
+///        of the block as it arrives, so the receiver doesn't have to keep the datagrams: the
+///        application may have released them long before the parities arrive. A parity is
+///        added to the accumulator of its row too, which leaves the sum of the missing shards
+///        only. When a block misses e datagrams and has e parities, that is a system of e
+///        equations that CReedSolomon::invert solves. With one missing datagram and parity
+///        row 0 the accumulator is the datagram.
+///        The decoder tracks maxBlocks blocks at the same time. A block that is complete or
+///        recovered is forgotten at once; when all slots are in use the oldest block is
+///        dropped, its loss is left to the NAKs.
+class CFecDecoder {
+public:
+    /// \param maxPayloadSize the largest payload of a data datagram
+    /// \param maxBlocks the number of blocks that are tracked at the same time
+    /// \param parityRows the number of parity rows that are used, the rows the sender sends
+    ///        with every block plus the ones it sends to answer NAKs. Parities of later rows
+    ///        are ignored.
+    /// \throws std::runtime_error when maxBlocks is 0 or parityRows is out of range
+    CFecDecoder(size_t maxPayloadSize, size_t maxBlocks = defaultMaxBlocks,
+                size_t parityRows = 1);
+    CFecDecoder(const CFecDecoder& orig) = delete;
+    CFecDecoder& operator=(const CFecDecoder& other) = delete;
+    virtual ~CFecDecoder();
+
+    /// \brief registers a received data datagram with rmdgpFlagFec. Only pass each sequence
+    ///        number once.
+    /// \param blockSize the FEC block size from the header
+    /// \param index the index in the block from the header
+    /// \return true when a datagram can be recovered now
+    bool addData(uint64_t sequence, uint8_t blockSize, uint8_t index, const uint8_t *payload,
+                 size_t length);
+
+    /// \brief registers a received parity datagram
+    /// \param firstSequence the sequence number from the header
+    /// \param blockSize the FEC block size from the header
+    /// \param row the FEC index from the header
+    /// \param payload the payload of the parity datagram
+    /// \return true when a datagram can be recovered now
+    bool addParity(uint64_t firstSequence, uint8_t blockSize, uint8_t row, const uint8_t *payload,
+                   size_t length);
+
+    /// \brief returns true when recover has a datagram to rebuild
+    bool hasRecoverable() const { return !recoverable.empty(); }
+
+    /// \brief rebuilds a lost datagram: a data datagram with rmdgpFlagRetransmission, like a
+    ///        repair from the sender
+    /// \param datagram receives the datagram
+    /// \param maxLength the size of datagram
+    /// \return the datagram length, 0 when the block turned out to be inconsistent or nothing
+    ///         was recoverable
+    size_t recover(uint8_t *datagram, size_t maxLength, uint32_t sessionId, uint32_t streamId);
+
+    /// \brief returns the number of rebuilt datagrams
+    uint64_t getRecoveredCount() const { return recoveredCount; }
+    /// \brief returns the number of received parity datagrams
+    uint64_t getParityCount() const { return parityCount; }
+    /// \brief returns the number of blocks that were dropped while incomplete
+    uint64_t getDroppedCount() const { return droppedCount; }
+    size_t getMaxBlocks() const { return blocks.size(); }
+    size_t getParityRows() const { return parityRows; }
+
+    static constexpr size_t defaultMaxBlocks = 16;
+
+private:
+    struct SBlock {
+        uint64_t firstSequence;
+        uint64_t receivedMask;
+        uint64_t parityMask;        ///< the rows that have their parity
+        uint16_t accumulatedLength; ///< the part of the accumulators that is not zero
+        uint8_t blockSize;
+        uint8_t receivedCount;
+        bool used;
+    };
+
+    /// \brief returns the slot of the block that starts at firstSequence, a new one when it is
+    ///        not tracked yet
+    size_t findBlock(uint64_t firstSequence, uint8_t blockSize);
+    uint8_t* getAccumulator(size_t slot, size_t row)
+        { return &accumulators[(slot * parityRows + row) * shardSize]; }
+    /// \brief adds the shard of data datagram index to the accumulators of all rows
+    void accumulate(size_t slot, size_t index, const uint8_t *payload, size_t length);
+    /// \brief adds a received or rebuilt data datagram to the block
+    /// \return true when a datagram can be recovered now
+    bool addShard(size_t slot, size_t index, const uint8_t *payload, size_t length);
+    /// \brief queues the block for recover when it has as many parities as missing datagrams
+    bool checkRecoverable(size_t slot);
+    void free(size_t slot);
+
+    const size_t maxPayloadSize;
+    const size_t parityRows;
+    const size_t shardSize;         ///< the uint16 length and the payload
+    std::vector<SBlock> blocks;
+    std::vector<uint8_t> accumulators;
+    std::vector<size_t> recoverable;
+    std::vector<uint8_t> shard;     ///< scratch of recover
+    std::vector<uint8_t> matrix;    ///< scratch of recover
+    size_t lastSlot;
+    uint64_t recoveredCount;
+    uint64_t parityCount;
+    uint64_t droppedCount;
+};
+
+#endif /* CFECDECODER_H */
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CFecEncoder.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 30, 2021, 9:05 PM
+ */
+
+#include "CFecEncoder.h"
+#include "CGaloisField.h"
+#include "CReedSolomon.h"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+
+CFecEncoder::CFecEncoder(size_t blockSize, size_t maxPayloadSize, size_t parityRows) :
+               maxPayloadSize(maxPayloadSize), blockSize(blockSize), nextBlockSize(blockSize),
+               firstRow(0), nextFirstRow(0), nextRows(parityRows), count(0), firstSequence(0),
+               parityLength(0), sentLength(0), parityCount(0), datagrams()
+{
+   checkBlockSize(blockSize);
+   checkParityRows(parityRows, 0);
+   if(parityHeaderSize + maxPayloadSize > CRmdgpHeader::maxPayloadLength)
+   {
+      std::ostringstream message;
+      message << "Error max payload size " << maxPayloadSize << " leaves no room for the parity";
+      throw std::runtime_error(message.str());
+   }
+   datagrams.resize(parityRows,
+                    std::vector<uint8_t>(CRmdgpHeader::size + parityHeaderSize + maxPayloadSize));
+}
+
+CFecEncoder::~CFecEncoder()
+{
+}
+
+void CFecEncoder::add(uint64_t sequence, const uint8_t *payload, size_t length)
+{
+   if(count == 0)
+   {
+      // the parities of the previous block are sent, clear them now and take the new rows
+      for(std::vector<uint8_t> &datagram : datagrams)
+         memset(&datagram[CRmdgpHeader::size], 0, parityHeaderSize + sentLength);
+      sentLength = 0;
+      firstRow = nextFirstRow;
+      datagrams.resize(nextRows,
+                       std::vector<uint8_t>(CRmdgpHeader::size + parityHeaderSize + maxPayloadSize));
+      firstSequence = sequence;
+   }
+
+   length = std::min(length, maxPayloadSize);
+   uint8_t shardLength[parityHeaderSize];
+   CRmdgpHeader::store16(shardLength, uint16_t(length));
+   for(size_t row = 0; row < datagrams.size(); row++)
+   {
+      const uint8_t coefficient = CReedSolomon::getCoefficient(firstRow + row, count);
+      uint8_t *parity = &datagrams[row][CRmdgpHeader::size];
+
+      CGaloisField::mulAddInto(coefficient, parity, shardLength, parityHeaderSize);
+      CGaloisField::mulAddInto(coefficient, parity + parityHeaderSize, payload, length);
+   }
+   parityLength = std::max(parityLength, length);
+   count++;
+}
+
+size_t CFecEncoder::finish(uint32_t sessionId, uint32_t streamId, uint16_t flags)
+{
+   for(size_t row = 0; row < datagrams.size(); row++)
+      CRmdgpHeaderBuilder(datagrams[row].data()).setType(ERmdgpPacketType::parity)
+                      .setFlags(flags).setPayloadLength(uint16_t(parityHeaderSize + parityLength))
+                      .setSessionId(sessionId).setStreamId(streamId).setSequence(firstSequence)
+                      .setFecPosition(uint8_t(count), uint8_t(firstRow + row));
+   parityCount += datagrams.size();
+
+   // the caller still sends the datagrams, the next add clears them
+   sentLength = parityLength;
+   count = 0;
+   parityLength = 0;
+   blockSize = nextBlockSize;
+   return datagrams.size();
+}
+
+const uint8_t* CFecEncoder::getParity(size_t i, size_t &length) const
+{
+   length = CRmdgpHeader::size + parityHeaderSize + sentLength;
+   return datagrams[i].data();
+}
+
+void CFecEncoder::setBlockSize(size_t newBlockSize)
+{
+   checkBlockSize(newBlockSize);
+   nextBlockSize = newBlockSize;
+   if(count == 0)
+      blockSize = newBlockSize;
+}
+
+void CFecEncoder::setParityRows(size_t newCount, size_t newFirstRow)
+{
+   checkParityRows(newCount, newFirstRow);
+   nextRows = newCount;
+   nextFirstRow = newFirstRow;
+}
+
+void CFecEncoder::checkBlockSize(size_t blockSize)
+{
+   if(blockSize == 0 || blockSize > maxBlockSize)
+   {
+      std::ostringstream message;
+      message << "Error FEC block size " << blockSize << " is not within 1 and " << maxBlockSize;
+      throw std::runtime_error(message.str());
+   }
+}
+
+void CFecEncoder::checkParityRows(size_t count, size_t firstRow)
+{
+   if(count == 0 || firstRow + count > maxParityRows)
+   {
+      std::ostringstream message;
+      message << "Error " << count << " FEC parity rows from row " << firstRow
+              << " don't fit in " << maxParityRows << " rows";
+      throw std::runtime_error(message.str());
+   }
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CFecEncoder.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 30, 2021, 9:05 PM
+ */
+
+#ifndef CFECENCODER_H
+#define CFECENCODER_H
+
+#include "CRmdgpHeader.h"
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief Makes the parity datagrams of a block of data datagrams, for forward error correction.
+///        The data datagrams of a block have consecutive sequence numbers and carry
+///        rmdgpFlagFec with the block size and their index in the header. After the last one
+///        the sender sends m parity datagrams, the parity rows of a CReedSolomon code over the
+///        block. A receiver that misses up to m datagrams of the block rebuilds them from the
+///        others and the parities, without asking the sender, see CFecDecoder.
+///        Every data datagram is a shard of the code: its payload length as uint16, then the
+///        payload, zero padded to the longest of the block. Row 0 has all coefficients 1, so
+///        with m = 1 the parity is the plain XOR of the shards.
+///        The parities are built in place in datagram buffers of the encoder, every payload is
+///        multiplied into each of them once with CGaloisField::mulAddInto.
+///        Parity payload: the sum of the shards, the length part first.
+///        The header has the sequence number of the first datagram of the block, the number of
+///        data datagrams in the block as FEC block size and the parity row as FEC index.
+///        Rows after the ones that are sent with the block are new parities for the same block,
+///        the sender makes those to answer NAKs.
+class CFecEncoder {
+public:
+    /// \param blockSize the number of data datagrams per block, 1 to maxBlockSize
+    /// \param maxPayloadSize the largest payload of a data datagram
+    /// \param parityRows the number of parity datagrams per block, see setParityRows
+    /// \throws std::runtime_error when blockSize or parityRows is out of range, or
+    ///         maxPayloadSize doesn't fit in a parity datagram
+    CFecEncoder(size_t blockSize, size_t maxPayloadSize, size_t parityRows = 1);
+    CFecEncoder(const CFecEncoder& orig) = delete;
+    CFecEncoder& operator=(const CFecEncoder& other) = delete;
+    virtual ~CFecEncoder();
+
+    /// \brief adds the payload of the next data datagram of the block to the parities. Write
+    ///        the FEC position of getBlockSize() and getIndex() in its header before.
+    /// \param sequence the sequence number of the datagram, the first one starts the block
+    void add(uint64_t sequence, const uint8_t *payload, size_t length);
+
+    /// \brief returns true when the block has all its data datagrams, send the parities
+    bool isComplete() const { return count == blockSize; }
+    /// \brief returns true when data datagrams were added since the last parity
+    bool isStarted() const { return count > 0; }
+    /// \brief returns the sequence number of the first datagram of the started block
+    uint64_t getFirstSequence() const { return firstSequence; }
+
+    /// \brief finishes the parity datagrams of the current block, also when it is not
+    ///        complete, and starts a new block
+    /// \param flags the header flags of the parity datagrams
+    /// \return the number of parity datagrams, see getParity
+    size_t finish(uint32_t sessionId, uint32_t streamId, uint16_t flags = 0);
+    /// \brief returns parity datagram i of the finished block, valid until the next add
+    /// \param length receives the length of the datagram
+    const uint8_t* getParity(size_t i, size_t &length) const;
+
+    /// \brief the block size of the block that is being built
+    uint8_t getBlockSize() const { return uint8_t(blockSize); }
+    /// \brief the index that the next data datagram gets in the block
+    uint8_t getIndex() const { return uint8_t(count); }
+    /// \brief sets the block size of the next block, the current one keeps its size
+    /// \throws std::runtime_error when blockSize is out of range
+    void setBlockSize(size_t newBlockSize);
+    size_t getNextBlockSize() const { return nextBlockSize; }
+    /// \brief sets the parity rows of the next block: count rows from firstRow. Like the
+    ///        block size it applies at once when no block is started.
+    /// \throws std::runtime_error when count is 0 or the rows pass maxParityRows
+    void setParityRows(size_t count, size_t firstRow = 0);
+    size_t getParityRows() const { return nextRows; }
+    size_t getFirstParityRow() const { return nextFirstRow; }
+
+    /// \brief returns the number of finished parity datagrams
+    uint64_t getParityCount() const { return parityCount; }
+
+    /// \brief the largest block, the receiver tracks the datagrams of a block in 64 bits
+    static constexpr size_t maxBlockSize = 64;
+    /// \brief the number of parity rows, the receiver tracks the parities of a block in 64
+    ///        bits
+    static constexpr size_t maxParityRows = 64;
+    /// \brief the uint16 payload length in front of every shard
+    static constexpr size_t parityHeaderSize = 2;
+
+private:
+    static void checkBlockSize(size_t blockSize);
+    static void checkParityRows(size_t count, size_t firstRow);
+
+    const size_t maxPayloadSize;
+    size_t blockSize;
+    size_t nextBlockSize;
+    size_t firstRow;
+    size_t nextFirstRow;
+    size_t nextRows;
+    size_t count;
+    uint64_t firstSequence;
+    size_t parityLength;           ///< the longest payload of the block
+    size_t sentLength;             ///< the parity length of the finished block, to clear
+    uint64_t parityCount;
+    std::vector<std::vector<uint8_t>> datagrams;   ///< one per row of the block
+};
+
+#endif /* CFECENCODER_H */
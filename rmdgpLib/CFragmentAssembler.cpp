@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CFragmentAssembler.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 4, 2021, 2:30 PM
+ */
+
+#include "CFragmentAssembler.h"
+#include "CFragmentHeader.h"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+
+CFragmentAssembler::CFragmentAssembler(size_t maxMessageSize, size_t maxPartialBytes) :
+               maxMessageSize(maxMessageSize), maxPartialBytes(maxPartialBytes), partials(),
+               last(partials.end()), partialBytes(0), complete(), droppedCount(0)
+{
+   if(maxPartialBytes < maxMessageSize || maxMessageSize > CFragmentHeader::maxMessageLength)
+   {
+      std::ostringstream message;
+      message << "Error max partial bytes " << maxPartialBytes << " is smaller than max message "
+              << "size " << maxMessageSize << " or that is too large";
+      throw std::runtime_error(message.str());
+   }
+}
+
+CFragmentAssembler::~CFragmentAssembler()
+{
+}
+
+EFragmentResult CFragmentAssembler::add(uint64_t sequence, const uint8_t *payload, size_t length)
+{
+   if(length < CFragmentHeader::size)
+      return EFragmentResult::malformed;
+
+   const uint32_t messageLength = CFragmentHeader::getMessageLength(payload);
+   const uint32_t offset = CFragmentHeader::getOffset(payload);
+   const uint32_t index = CFragmentHeader::getIndex(payload);
+   const uint32_t count = CFragmentHeader::getCount(payload);
+   const size_t fragmentLength = length - CFragmentHeader::size;
+
+   // the last fragment ends the message, the others may not be empty
+   if(index >= count || uint64_t(offset) + fragmentLength > messageLength ||
+      ((index == count - 1) != (offset + fragmentLength == messageLength)) ||
+      (fragmentLength == 0 && messageLength > 0) ||
+      count > std::max<uint32_t>(messageLength, 1))
+      return EFragmentResult::malformed;
+   // the fragments have one size and start at their index times it, the last one tells the
+   // size by its offset. Then they don't overlap and leave no byte of the message unwritten.
+   uint32_t fragmentSize = uint32_t(fragmentLength);
+   if(index == count - 1 && index > 0)
+   {
+      fragmentSize = offset / index;
+      if(offset % index != 0 || fragmentLength > fragmentSize)
+         return EFragmentResult::malformed;
+   }
+   else if(uint64_t(index) * fragmentSize != offset)
+      return EFragmentResult::malformed;
+
+   const TPartials::iterator it = findPartial(sequence - index, messageLength, count,
+                                              fragmentSize);
+   if(it == partials.end())
+      return EFragmentResult::tooLarge;
+   SPartial &partial = it->second;
+   if(partial.length != messageLength || partial.count != count ||
+      partial.fragmentSize != fragmentSize)
+      return EFragmentResult::malformed;
+
+   uint64_t &word = partial.received[index / 64];
+   const uint64_t bit = uint64_t(1) << (index % 64);
+   if(word & bit)
+      return EFragmentResult::duplicate;
+   word |= bit;
+   memcpy(partial.data.get() + offset, payload + CFragmentHeader::size, fragmentLength);
+   if(++partial.receivedCount < count)
+      return EFragmentResult::incomplete;
+
+   // the buffer goes to the application as it is
+   complete.push_back({ it->first, messageLength, std::move(partial.data) });
+   partialBytes -= messageLength;
+   partials.erase(it);
+   last = partials.end();
+   return EFragmentResult::complete;
+}
+
+CFragmentAssembler::TPartials::iterator CFragmentAssembler::findPartial(uint64_t firstSequence,
+                                                   uint32_t length, uint32_t count,
+                                                   uint32_t fragmentSize)
+{
+   if(last != partials.end() && last->first == firstSequence)
+      return last;
+   TPartials::iterator it = partials.find(firstSequence);
+   if(it != partials.end())
+      return last = it;
+
+   if(length > maxMessageSize)
+      return partials.end();
+   // make room, the oldest message is the least likely to complete
+   while(partialBytes + length > maxPartialBytes)
+   {
+      partialBytes -= partials.begin()->second.length;
+      partials.erase(partials.begin());
+      droppedCount++;
+   }
+
+   last = partials.emplace(firstSequence, SPartial()).first;
+   SPartial &partial = last->second;
+   // no value initialization, add only accepts fragments that together write every byte
+   partial.data.reset(new uint8_t[length ? length : 1]);
+   partial.received.assign((count + 63) / 64, 0);
+   partial.length = length;
+   partial.count = count;
+   partial.fragmentSize = fragmentSize;
+   partial.receivedCount = 0;
+   partialBytes += length;
+   return last;
+}
+
+bool CFragmentAssembler::next(SMessage &message)
+{
+   if(complete.empty())
+      return false;
+   message = std::move(complete.front());
+   complete.pop_front();
+   return true;
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CFragmentAssembler.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 4, 2021, 2:30 PM
+ */
+
+#ifndef CFRAGMENTASSEMBLER_H
+#define CFRAGMENTASSEMBLER_H
+
+#include "CSequenceNumber.h"
+#include <deque>
+#include <map>
+#include <memory>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief the result of CFragmentAssembler::add
+enum class EFragmentResult {
+    incomplete,     ///< the fragment is stored, the message isn't complete yet
+    complete,       ///< the fragment completed the message, see CFragmentAssembler::next
+    duplicate,      ///< the fragment was already stored
+    malformed,      ///< the fragment header is malformed or doesn't match the other fragments
+    tooLarge        ///< the message is larger than the memory limits allow, it is ignored
+};
+
+/// \brief Reassembles the messages that CRmdgpSender::sendFragmented split in fragments.
+///        At the first fragment of a message a buffer of the whole message is allocated, every
+///        fragment is copied from the datagram straight to its offset in that buffer, the only
+///        copy on the way to the application. A bitmap per message tells which fragments are
+///        there, so the fragments may come in any order. Like sendFragmented makes them, the
+///        fragments of a message must have one size, only the last may be shorter, and the
+///        offset of a fragment must be its index times that size. So together they cover the
+///        message exactly and the buffer needs no initialization.
+///        The partial messages together hold at most maxPartialBytes. A new message that
+///        doesn't fit drops the oldest partial messages; a message that can never fit, or is
+///        larger than maxMessageSize, is ignored, so a bad header can't exhaust the memory.
+///        Only pass every sequence number once, for instance the datagrams that
+///        CRmdgpReceiver delivers.
+class CFragmentAssembler {
+public:
+    /// \brief a reassembled message
+    struct SMessage {
+        uint64_t firstSequence;
+        size_t length;
+        std::unique_ptr<uint8_t[]> data;
+    };
+
+    /// \param maxMessageSize the largest message that is accepted
+    /// \param maxPartialBytes the most bytes of all incomplete messages together
+    /// \throws std::runtime_error when maxPartialBytes is smaller than maxMessageSize
+    CFragmentAssembler(size_t maxMessageSize, size_t maxPartialBytes);
+    CFragmentAssembler(const CFragmentAssembler& orig) = delete;
+    CFragmentAssembler& operator=(const CFragmentAssembler& other) = delete;
+    virtual ~CFragmentAssembler();
+
+    /// \brief adds the fragment in a datagram
+    /// \param sequence the sequence number of the datagram
+    /// \param payload the payload of the datagram, a CFragmentHeader and the fragment
+    EFragmentResult add(uint64_t sequence, const uint8_t *payload, size_t length);
+
+    /// \brief takes the oldest complete message
+    /// \return false when there is none
+    bool next(SMessage &message);
+
+    /// \brief returns the number of incomplete messages
+    size_t getPartialCount() const { return partials.size(); }
+    /// \brief returns the bytes allocated for incomplete messages
+    size_t getPartialBytes() const { return partialBytes; }
+    /// \brief returns the number of complete messages that next didn't return yet
+    size_t getCompleteCount() const { return complete.size(); }
+    /// \brief returns the number of incomplete messages dropped for the memory limit
+    uint64_t getDroppedCount() const { return droppedCount; }
+    size_t getMaxMessageSize() const { return maxMessageSize; }
+    size_t getMaxPartialBytes() const { return maxPartialBytes; }
+
+private:
+    struct SPartial {
+        std::unique_ptr<uint8_t[]> data;
+        std::vector<uint64_t> received;     ///< bitmap of the fragment indexes
+        uint32_t length;
+        uint32_t count;
+        uint32_t fragmentSize;              ///< of all fragments but the last
+        uint32_t receivedCount;
+    };
+    typedef std::map<uint64_t, SPartial, CSequenceNumber::SLess> TPartials;
+
+    /// \brief finds or makes the partial message that starts at firstSequence
+    /// \return partials.end() when the message is too large
+    TPartials::iterator findPartial(uint64_t firstSequence, uint32_t length, uint32_t count,
+                                    uint32_t fragmentSize);
+
+    const size_t maxMessageSize;
+    const size_t maxPartialBytes;
+    TPartials partials;
+    /// \brief the partial message of the previous fragment, the next fragment is likely of it
+    TPartials::iterator last;
+    size_t partialBytes;
+    std::deque<SMessage> complete;
+    uint64_t droppedCount;
+};
+
+#endif /* CFRAGMENTASSEMBLER_H */
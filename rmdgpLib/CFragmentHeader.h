@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CFragmentHeader.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 4, 2021, 2:30 PM
+ */
+
+#ifndef CFRAGMENTHEADER_H
+#define CFRAGMENTHEADER_H
+
+#include "CRmdgpHeader.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief The header in front of the payload of every fragment of a message that is larger
+///        than a datagram, see CRmdgpSender::sendFragmented and CFragmentAssembler.
+///        The fragments of a message have consecutive sequence numbers, so the first sequence
+///        number of the message is the sequence number of a fragment minus its index.
+///        All fields are uint32 in network byte order:
+///        message length, offset of the fragment in the message, fragment index, fragment count.
+class CFragmentHeader {
+public:
+    static constexpr size_t messageLengthOffset = 0;
+    static constexpr size_t offsetOffset = 4;
+    static constexpr size_t indexOffset = 8;
+    static constexpr size_t countOffset = 12;
+    static constexpr size_t size = 16;
+    static constexpr size_t maxMessageLength = UINT32_MAX;
+
+    static void store(uint8_t *header, uint32_t messageLength, uint32_t offset, uint32_t index,
+                      uint32_t count)
+    {
+        CRmdgpHeader::store32(header + messageLengthOffset, messageLength);
+        CRmdgpHeader::store32(header + offsetOffset, offset);
+        CRmdgpHeader::store32(header + indexOffset, index);
+        CRmdgpHeader::store32(header + countOffset, count);
+    }
+
+    static constexpr uint32_t getMessageLength(const uint8_t *header)
+        { return CRmdgpHeader::load32(header + messageLengthOffset); }
+    static constexpr uint32_t getOffset(const uint8_t *header)
+        { return CRmdgpHeader::load32(header + offsetOffset); }
+    static constexpr uint32_t getIndex(const uint8_t *header)
+        { return CRmdgpHeader::load32(header + indexOffset); }
+    static constexpr uint32_t getCount(const uint8_t *header)
+        { return CRmdgpHeader::load32(header + countOffset); }
+};
+
+#endif /* CFRAGMENTHEADER_H */
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CGaloisField.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 2, 2021, 7:50 PM
+ */
+
+#include "CGaloisField.h"
+#include "CXorKernel.h"
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace {
+   const unsigned int polynomial = 0x11d;
+
+   /// \brief all tables are made once, before main
+   struct STables {
+      STables()
+      {
+         unsigned int value = 1;
+         for(unsigned int i = 0; i < 255; i++)
+         {
+            exp[i] = exp[i + 255] = uint8_t(value);
+            log[value] = uint8_t(i);
+            value <<= 1;
+            if(value & 0x100)
+               value ^= polynomial;
+         }
+         log[0] = 0;
+         for(unsigned int a = 0; a < 256; a++)
+         {
+            for(unsigned int b = 0; b < 256; b++)
+               product[a][b] = (a == 0 || b == 0) ? 0 : exp[log[a] + log[b]];
+            for(unsigned int nibble = 0; nibble < 16; nibble++)
+            {
+               low[a][nibble] = product[a][nibble];
+               high[a][nibble] = product[a][nibble << 4];
+            }
+         }
+      }
+
+      uint8_t exp[510];
+      uint8_t log[256];
+      uint8_t product[256][256];
+      /// \brief c * x == low[c][x & 0xf] ^ high[c][x >> 4], because multiplying is linear
+      alignas(16) uint8_t low[256][16];
+      alignas(16) uint8_t high[256][16];
+   };
+
+   const STables tables;
+
+   void mulAddScalar(uint8_t coefficient, uint8_t *target, const uint8_t *source, size_t length)
+   {
+      const uint8_t *row = tables.product[coefficient];
+
+      for(size_t i = 0; i < length; i++)
+         target[i] ^= row[source[i]];
+   }
+
+#if defined(__x86_64__)
+   __attribute__((target("ssse3")))
+   void mulAddSsse3(uint8_t coefficient, uint8_t *target, const uint8_t *source, size_t length)
+   {
+      const __m128i low = _mm_load_si128(reinterpret_cast<const __m128i*>(tables.low[coefficient]));
+      const __m128i high = _mm_load_si128(reinterpret_cast<const __m128i*>(tables.high[coefficient]));
+      const __m128i mask = _mm_set1_epi8(0x0f);
+      size_t i = 0;
+
+      for(; i + 16 <= length; i += 16)
+      {
+         const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+         const __m128i product = _mm_xor_si128(_mm_shuffle_epi8(low, _mm_and_si128(s, mask)),
+                           _mm_shuffle_epi8(high, _mm_and_si128(_mm_srli_epi64(s, 4), mask)));
+         const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(target + i));
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i), _mm_xor_si128(t, product));
+      }
+      mulAddScalar(coefficient, target + i, source + i, length - i);
+   }
+
+   __attribute__((target("avx2")))
+   void mulAddAvx2(uint8_t coefficient, uint8_t *target, const uint8_t *source, size_t length)
+   {
+      // the shuffle works per 128 bit lane, so both lanes get the same table
+      const __m256i low = _mm256_broadcastsi128_si256(
+                  _mm_load_si128(reinterpret_cast<const __m128i*>(tables.low[coefficient])));
+      const __m256i high = _mm256_broadcastsi128_si256(
+                  _mm_load_si128(reinterpret_cast<const __m128i*>(tables.high[coefficient])));
+      const __m256i mask = _mm256_set1_epi8(0x0f);
+      size_t i = 0;
+
+      for(; i + 32 <= length; i += 32)
+      {
+         const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+         const __m256i product = _mm256_xor_si256(
+                           _mm256_shuffle_epi8(low, _mm256_and_si256(s, mask)),
+                           _mm256_shuffle_epi8(high, _mm256_and_si256(_mm256_srli_epi64(s, 4),
+                                                                      mask)));
+         const __m256i t = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(target + i));
+         _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + i), _mm256_xor_si256(t, product));
+      }
+      mulAddScalar(coefficient, target + i, source + i, length - i);
+   }
+#endif
+
+   CGaloisField::EKernel selectKernel()
+   {
+      if(CGaloisField::isSupported(CGaloisField::EKernel::avx2))
+         return CGaloisField::EKernel::avx2;
+      if(CGaloisField::isSupported(CGaloisField::EKernel::ssse3))
+         return CGaloisField::EKernel::ssse3;
+      return CGaloisField::EKernel::scalar;
+   }
+}
+
+uint8_t CGaloisField::multiply(uint8_t a, uint8_t b)
+{
+   return tables.product[a][b];
+}
+
+uint8_t CGaloisField::divide(uint8_t a, uint8_t b)
+{
+   if(a == 0)
+      return 0;
+   return tables.exp[tables.log[a] + 255 - tables.log[b]];
+}
+
+void CGaloisField::mulAddInto(uint8_t coefficient, uint8_t *target, const uint8_t *source,
+                    size_t length)
+{
+   static const TMulAddFunction selected = getFunction(selectKernel());
+
+   if(coefficient == 1)
+      CXorKernel::xorInto(target, source, length);
+   else if(coefficient != 0)
+      selected(coefficient, target, source, length);
+}
+
+void CGaloisField::mulAddInto(EKernel kernel, uint8_t coefficient, uint8_t *target,
+                    const uint8_t *source, size_t length)
+{
+   if(!isSupported(kernel))
+   {
+      std::ostringstream message;
+      message << "Error GF(2^8) kernel " << getName(kernel) << " is not supported by this CPU";
+      throw std::runtime_error(message.str());
+   }
+   getFunction(kernel)(coefficient, target, source, length);
+}
+
+bool CGaloisField::isSupported(EKernel kernel)
+{
+   switch(kernel)
+   {
+      case EKernel::scalar:
+         return true;
+#if defined(__x86_64__)
+      case EKernel::ssse3:
+         // also called by a static initializer, maybe before the one of libgcc
+         __builtin_cpu_init();
+         return __builtin_cpu_supports("ssse3");
+      case EKernel::avx2:
+         __builtin_cpu_init();
+         return __builtin_cpu_supports("avx2");
+#endif
+      default:
+         return false;
+   }
+}
+
+CGaloisField::EKernel CGaloisField::getSelected()
+{
+   return selectKernel();
+}
+
+const char* CGaloisField::getName(EKernel kernel)
+{
+   switch(kernel)
+   {
+      case EKernel::scalar:
+         return "scalar";
+      case EKernel::ssse3:
+         return "ssse3";
+      case EKernel::avx2:
+         return "avx2";
+   }
+   return "unknown";
+}
+
+CGaloisField::TMulAddFunction CGaloisField::getFunction(EKernel kernel)
+{
+   switch(kernel)
+   {
+#if defined(__x86_64__)
+      case EKernel::ssse3:
+         return mulAddSsse3;
+      case EKernel::avx2:
+         return mulAddAvx2;
+#endif
+      default:
+         return mulAddScalar;
+   }
+}
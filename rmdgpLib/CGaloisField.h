@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CGaloisField.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 2, 2021, 7:50 PM
+ */
+
+#ifndef CGALOISFIELD_H
+#define CGALOISFIELD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief Arithmetic in GF(2^8) with the polynomial x^8 + x^4 + x^3 + x^2 + 1 (0x11d), the
+///        field of the Reed-Solomon code. Adding is XOR, multiplying goes through log and exp
+///        tables.
+///        mulAddInto is the inner loop of encoding and decoding: target += c * source for a
+///        whole buffer. The scalar version looks up every byte in the product table of c. The
+///        SSSE3 and AVX2 versions split every byte in two nibbles and look both up with a
+///        shuffle in a 16 entry table of c, 16 or 32 bytes at a time. The fastest one the CPU
+///        supports is chosen at the first call, like CXorKernel does.
+class CGaloisField {
+public:
+    /// \brief the implementations of mulAddInto
+    enum class EKernel {
+        scalar,
+        ssse3,
+        avx2
+    };
+
+    static uint8_t multiply(uint8_t a, uint8_t b);
+    /// \brief returns a / b, b must not be 0
+    static uint8_t divide(uint8_t a, uint8_t b);
+    /// \brief returns 1 / a, a must not be 0
+    static uint8_t inverse(uint8_t a) { return divide(1, a); }
+
+    /// \brief target[i] ^= coefficient * source[i] for i in [0, length), with the fastest
+    ///        kernel. Coefficient 1 is a plain XOR and goes to CXorKernel. The buffers need no
+    ///        alignment, but must not overlap.
+    static void mulAddInto(uint8_t coefficient, uint8_t *target, const uint8_t *source,
+                           size_t length);
+
+    /// \brief the same with a given kernel, for tests and benchmarks
+    /// \throws std::runtime_error when the CPU doesn't support kernel
+    static void mulAddInto(EKernel kernel, uint8_t coefficient, uint8_t *target,
+                           const uint8_t *source, size_t length);
+
+    /// \brief returns true when the CPU supports kernel
+    static bool isSupported(EKernel kernel);
+    /// \brief returns the kernel that mulAddInto uses
+    static EKernel getSelected();
+    static const char* getName(EKernel kernel);
+
+private:
+    typedef void (*TMulAddFunction)(uint8_t coefficient, uint8_t *target, const uint8_t *source,
+                                    size_t length);
+    static TMulAddFunction getFunction(EKernel kernel);
+};
+
+#endif /* CGALOISFIELD_H */
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CJoinPacket.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 5, 2021, 4:30 PM
+ */
+
+#include "CJoinPacket.h"
+#include "CVarInt.h"
+
+CJoinBuilder::CJoinBuilder(uint8_t *datagram, ERmdgpPacketType type, uint32_t sessionId,
+               uint32_t streamId, uint32_t receiverId, const SSequenceRange &range) :
+               length(CRmdgpHeader::size)
+{
+   CRmdgpHeaderBuilder(datagram).setType(type).setSessionId(sessionId).setStreamId(streamId)
+                   .setSequence(range.begin);
+   length += CVarInt::encode(datagram + length, maxLength - length, receiverId);
+   length += CVarInt::encode(datagram + length, maxLength - length, range.size());
+   CRmdgpHeader::store16(datagram + CRmdgpHeader::payloadLengthOffset,
+                         uint16_t(length - CRmdgpHeader::size));
+}
+
+CJoinBuilder::~CJoinBuilder()
+{
+}
+
+CJoinReader::CJoinReader(const uint8_t *datagram, size_t length) : receiverId(0),
+               range({ CRmdgpHeaderView(datagram).getSequence(),
+                       CRmdgpHeaderView(datagram).getSequence() }), malformed(true)
+{
+   const uint8_t *position = datagram + CRmdgpHeader::size;
+   const uint8_t *end = datagram + length;
+   uint64_t id, size;
+
+   size_t bytes = CVarInt::decode(position, end - position, id);
+   if(bytes == 0 || id > UINT32_MAX)
+      return;
+   position += bytes;
+   bytes = CVarInt::decode(position, end - position, size);
+   if(bytes == 0 || size >= uint64_t(INT64_MAX))
+      return;
+
+   receiverId = uint32_t(id);
+   range.end = range.begin + size;
+   malformed = false;
+}
+
+CJoinReader::~CJoinReader()
+{
+}
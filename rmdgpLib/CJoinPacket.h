@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CJoinPacket.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 5, 2021, 4:30 PM
+ */
+
+#ifndef CJOINPACKET_H
+#define CJOINPACKET_H
+
+#include "CRmdgpHeader.h"
+#include "CSequenceNumber.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief Builds the datagrams of the catch-up handshake of a late joiner. A join goes from the
+///        receiver to the sender and asks for the history range it missed: from the first
+///        sequence number it wants up to the first one it received live. The join accept is the
+///        answer, with the part of that range that the sender still has and will replay.
+///        Both have the same layout: the header sequence number is the begin of the range, the
+///        payload holds a CVarInt with the receiver id and a CVarInt with the size of the range.
+class CJoinBuilder {
+public:
+    /// \param datagram the send buffer, at least maxLength bytes
+    /// \param type ERmdgpPacketType::join or ERmdgpPacketType::joinAccept
+    /// \param receiverId identifies the late joiner
+    /// \param range the history range
+    CJoinBuilder(uint8_t *datagram, ERmdgpPacketType type, uint32_t sessionId, uint32_t streamId,
+                 uint32_t receiverId, const SSequenceRange &range);
+    CJoinBuilder(const CJoinBuilder& orig) = delete;
+    virtual ~CJoinBuilder();
+
+    /// \brief returns the datagram length
+    size_t getLength() const { return length; }
+
+    /// \brief the largest join datagram
+    static constexpr size_t maxLength = CRmdgpHeader::size + 5 + 10;
+
+private:
+    size_t length;
+};
+
+/// \brief Reads a join or join accept datagram, in place
+class CJoinReader {
+public:
+    /// \param datagram a datagram that passed CRmdgpHeaderView::validate and has type join or
+    ///        joinAccept
+    /// \param length the datagram length
+    CJoinReader(const uint8_t *datagram, size_t length);
+    CJoinReader(const CJoinReader& orig) = delete;
+    virtual ~CJoinReader();
+
+    /// \brief returns the id of the late joiner
+    uint32_t getReceiverId() const { return receiverId; }
+    /// \brief returns the history range
+    const SSequenceRange& getRange() const { return range; }
+    /// \brief returns true when the receiver id or the range size is malformed
+    bool isMalformed() const { return malformed; }
+
+private:
+    uint32_t receiverId;
+    SSequenceRange range;
+    bool malformed;
+};
+
+#endif /* CJOINPACKET_H */
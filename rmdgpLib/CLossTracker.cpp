@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CLossTracker.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 19, 2021, 4:05 PM
+ */
+
+#include "CLossTracker.h"
+#include <iterator>
+
+CLossTracker::CLossTracker(uint64_t firstSequence) : base(firstSequence),
+               nextExpected(firstSequence), missingCount(0)
+{
+}
+
+CLossTracker::~CLossTracker()
+{
+}
+
+CLossTracker::EResult CLossTracker::receive(uint64_t sequence)
+{
+   // the common case first
+   if(sequence == nextExpected)
+   {
+      nextExpected++;
+      return EResult::inOrder;
+   }
+
+   if(CSequenceNumber::isAfter(sequence, nextExpected))
+   {
+      // the sequence numbers in between are missing
+      addHole(sequence);
+      nextExpected = sequence + 1;
+      return EResult::gapDetected;
+   }
+
+   if(CSequenceNumber::isBefore(sequence, base))
+      return EResult::tooOld;
+
+   // find the hole with the largest begin at or before sequence
+   THoles::iterator hole = holes.upper_bound(sequence);
+   if(hole == holes.begin())
+      return EResult::duplicate;
+   --hole;
+   const uint64_t holeBegin = hole->first;
+   const uint64_t holeEnd = hole->second;
+   if(!CSequenceNumber::isBefore(sequence, holeEnd))
+      return EResult::duplicate;
+
+   if(sequence == holeBegin)
+   {
+      // the key changes, replace the entry
+      THoles::iterator next = holes.erase(hole);
+      if(sequence + 1 != holeEnd)
+         holes.emplace_hint(next, sequence + 1, holeEnd);
+   }
+   else
+   {
+      // keep the front part, add the part after sequence
+      hole->second = sequence;
+      if(sequence + 1 != holeEnd)
+         holes.emplace_hint(std::next(hole), sequence + 1, holeEnd);
+   }
+   missingCount--;
+   return EResult::repaired;
+}
+
+uint64_t CLossTracker::expect(uint64_t end)
+{
+   if(!CSequenceNumber::isAfter(end, nextExpected))
+      return 0;
+
+   const uint64_t missing = end - nextExpected;
+   addHole(end);
+   nextExpected = end;
+   return missing;
+}
+
+void CLossTracker::addHole(uint64_t end)
+{
+   // after expect the last hole can end at nextExpected, then it grows. Otherwise
+   // nextExpected - 1 was received and the new hole stands alone.
+   if(!holes.empty() && holes.rbegin()->second == nextExpected)
+      holes.rbegin()->second = end;
+   else
+      holes.emplace_hint(holes.end(), nextExpected, end);
+   missingCount += end - nextExpected;
+}
+
+uint64_t CLossTracker::forget(uint64_t newBase)
+{
+   uint64_t given = 0;
+
+   if(!CSequenceNumber::isAfter(newBase, base))
+      return 0;
+   base = newBase;
+
+   while(!holes.empty() && CSequenceNumber::isBefore(holes.begin()->first, newBase))
+   {
+      THoles::iterator hole = holes.begin();
+      if(CSequenceNumber::isBeforeOrEqual(hole->second, newBase))
+      {
+         given += hole->second - hole->first;
+         holes.erase(hole);
+      }
+      else
+      {
+         // only the front of the hole is given up
+         const uint64_t holeEnd = hole->second;
+         given += newBase - hole->first;
+         holes.erase(hole);
+         holes.emplace(newBase, holeEnd);
+         break;
+      }
+   }
+
+   if(CSequenceNumber::isAfter(newBase, nextExpected))
+      nextExpected = newBase;
+   missingCount -= given;
+   return given;
+}
+
+void CLossTracker::reset(uint64_t firstSequence)
+{
+   holes.clear();
+   base = firstSequence;
+   nextExpected = firstSequence;
+   missingCount = 0;
+}
+
+bool CLossTracker::isMissing(uint64_t sequence) const
+{
+   THoles::const_iterator hole = holes.upper_bound(sequence);
+
+   if(hole == holes.begin())
+      return false;
+   --hole;
+   return CSequenceNumber::isBefore(sequence, hole->second);
+}
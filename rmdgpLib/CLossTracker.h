@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CLossTracker.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 19, 2021, 4:05 PM
+ */
+
+#ifndef CLOSSTRACKER_H
+#define CLOSSTRACKER_H
+
+#include "CSequenceNumber.h"
+#include <map>
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief Detects missing sequence numbers at the receiver. A gap is found the moment a datagram
+///        with a later sequence number arrives. The missing sequence numbers are kept as ranges
+///        (holes) in an ordered map, so a burst loss costs one entry and a lookup stays
+///        O(log holes), also with hundreds of thousands of holes.
+class CLossTracker {
+public:
+    /// \brief the result of receive()
+    enum class EResult {
+        inOrder,        ///< the next expected sequence number
+        gapDetected,    ///< after the next expected sequence number, the ones in between are missing
+        repaired,       ///< filled a hole
+        duplicate,      ///< received before
+        tooOld          ///< before getBase(), no longer tracked
+    };
+
+    /// \brief missing ranges, begin -> end, in sequence order
+    typedef std::map<uint64_t, uint64_t, CSequenceNumber::SLess> THoles;
+
+    /// \param firstSequence the first sequence number that is expected
+    CLossTracker(uint64_t firstSequence = 0);
+    CLossTracker(const CLossTracker& orig) = delete;
+    CLossTracker& operator=(const CLossTracker& other) = delete;
+    virtual ~CLossTracker();
+
+    /// \brief registers the arrival of a datagram
+    EResult receive(uint64_t sequence);
+
+    /// \brief registers that everything before end is sent, for instance from a heartbeat of
+    ///        the sender. What is not received of it is missing, so a loss at the end of a burst
+    ///        is found without waiting for the next datagram.
+    /// \return the number of sequence numbers that became missing
+    uint64_t expect(uint64_t end);
+
+    /// \brief stops tracking everything before newBase, because it will not come anymore (the
+    ///        sender released it) or isn't needed anymore. When newBase is beyond the received
+    ///        sequence numbers, the next expected sequence number moves along.
+    /// \return the number of missing sequence numbers that were given up
+    uint64_t forget(uint64_t newBase);
+
+    /// \brief starts again, expecting firstSequence
+    void reset(uint64_t firstSequence);
+
+    /// \brief returns the first sequence number that is still tracked
+    uint64_t getBase() const { return base; }
+    /// \brief returns the sequence number after the highest received one
+    uint64_t getNextExpected() const { return nextExpected; }
+    /// \brief returns the first missing sequence number. Everything before it is received
+    ///        (or forgotten); when nothing is missing this is getNextExpected().
+    uint64_t getFirstMissing() const { return holes.empty() ? nextExpected : holes.begin()->first; }
+    /// \brief returns true when sequence is missing
+    bool isMissing(uint64_t sequence) const;
+    /// \brief returns the number of missing sequence numbers
+    uint64_t getMissingCount() const { return missingCount; }
+    /// \brief returns the number of missing ranges
+    size_t getHoleCount() const { return holes.size(); }
+    /// \brief returns the missing ranges
+    const THoles& getHoles() const { return holes; }
+
+private:
+    /// \brief adds the hole from nextExpected up to end
+    void addHole(uint64_t end);
+
+    uint64_t base;
+    uint64_t nextExpected;
+    uint64_t missingCount;
+    THoles holes;
+};
+
+#endif /* CLOSSTRACKER_H */
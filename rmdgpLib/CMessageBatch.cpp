@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CMessageBatch.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 4, 2021, 9:20 AM
+ */
+
+#include "CMessageBatch.h"
+#include <string.h>
+
+CMessageBatchBuilder::CMessageBatchBuilder(size_t capacity) : buffer(capacity),
+               capacity(capacity), length(0), messageCount(0)
+{
+}
+
+CMessageBatchBuilder::~CMessageBatchBuilder()
+{
+}
+
+bool CMessageBatchBuilder::add(const void *message, size_t messageLength)
+{
+   if(!fits(messageLength))
+      return false;
+
+   length += CVarInt::encode(&buffer[length], capacity - length, messageLength);
+   if(messageLength > 0)
+      memcpy(&buffer[length], message, messageLength);
+   length += messageLength;
+   messageCount++;
+   return true;
+}
+
+bool CMessageBatchReader::next(const uint8_t *&message, size_t &length)
+{
+   if(malformed || position == end)
+      return false;
+
+   uint64_t messageLength;
+   const size_t bytes = CVarInt::decode(position, size_t(end - position), messageLength);
+   if(bytes == 0 || messageLength > uint64_t(end - position) - bytes)
+   {
+      malformed = true;
+      return false;
+   }
+   message = position + bytes;
+   length = size_t(messageLength);
+   position += bytes + length;
+   return true;
+}
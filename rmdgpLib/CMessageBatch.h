@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CMessageBatch.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 4, 2021, 9:20 AM
+ */
+
+#ifndef CMESSAGEBATCH_H
+#define CMESSAGEBATCH_H
+
+#include "CVarInt.h"
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief Packs small messages into one payload, so they share a datagram, its headers and its
+///        system call. Every message is a CVarInt with its length followed by its bytes; a
+///        message below 128 bytes costs one byte extra. The payload has no header of its own,
+///        the receivers of a stream that carries batches read every payload with
+///        CMessageBatchReader.
+class CMessageBatchBuilder {
+public:
+    /// \param capacity the largest payload, for instance the max payload size of the sender
+    CMessageBatchBuilder(size_t capacity);
+    CMessageBatchBuilder(const CMessageBatchBuilder& orig) = delete;
+    CMessageBatchBuilder& operator=(const CMessageBatchBuilder& other) = delete;
+    virtual ~CMessageBatchBuilder();
+
+    /// \brief appends a message
+    /// \return false when it doesn't fit anymore
+    bool add(const void *message, size_t length);
+    /// \brief returns true when a message of length fits after the ones added
+    bool fits(size_t length) const { return this->length + getEncodedSize(length) <= capacity; }
+    /// \brief removes all messages, for the next batch
+    void clear() { length = 0; messageCount = 0; }
+
+    /// \brief returns the payload so far
+    const uint8_t* getData() const { return buffer.data(); }
+    /// \brief returns the payload length so far
+    size_t getLength() const { return length; }
+    size_t getMessageCount() const { return messageCount; }
+    bool isEmpty() const { return messageCount == 0; }
+    size_t getCapacity() const { return capacity; }
+
+    /// \brief returns the bytes that a message of length takes in a batch
+    static constexpr size_t getEncodedSize(size_t length) { return CVarInt::size(length) + length; }
+
+private:
+    std::vector<uint8_t> buffer;
+    const size_t capacity;
+    size_t length;
+    size_t messageCount;
+};
+
+/// \brief Reads the messages of a batch in place. The messages point into the payload, so they
+///        are valid as long as the datagram isn't released.
+class CMessageBatchReader {
+public:
+    /// \param payload the payload of a received datagram
+    /// \param length the payload length
+    CMessageBatchReader(const uint8_t *payload, size_t length)
+        : position(payload), end(payload + length), malformed(false) {}
+    CMessageBatchReader(const CMessageBatchReader& orig) = delete;
+    virtual ~CMessageBatchReader() {}
+
+    /// \brief reads the next message
+    /// \param message set to the first byte of the message
+    /// \param length set to the message length
+    /// \return false at the end of the payload, or when the rest of it is malformed
+    bool next(const uint8_t *&message, size_t &length);
+
+    /// \brief returns true when a length prefix is malformed or runs past the payload
+    bool isMalformed() const { return malformed; }
+
+private:
+    const uint8_t *position;
+    const uint8_t *end;
+    bool malformed;
+};
+
+#endif /* CMESSAGEBATCH_H */
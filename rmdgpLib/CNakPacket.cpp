@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CNakPacket.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 20, 2021, 11:15 AM
+ */
+
+#include "CNakPacket.h"
+#include "CVarInt.h"
+
+CNakBuilder::CNakBuilder(uint8_t *datagram, size_t maxLength, uint32_t sessionId,
+               uint32_t streamId, uint32_t receiverId) : datagram(datagram),
+               maxLength(maxLength < CRmdgpHeader::size + CRmdgpHeader::maxPayloadLength ?
+                         maxLength : CRmdgpHeader::size + CRmdgpHeader::maxPayloadLength),
+               length(CRmdgpHeader::size), rangeCount(0), previousEnd(0)
+{
+   CRmdgpHeaderBuilder(datagram).setType(ERmdgpPacketType::nak).setSessionId(sessionId)
+                   .setStreamId(streamId);
+   length += CVarInt::encode(datagram + length, this->maxLength - length, receiverId);
+   CRmdgpHeader::store16(datagram + CRmdgpHeader::payloadLengthOffset,
+                         uint16_t(length - CRmdgpHeader::size));
+}
+
+CNakBuilder::~CNakBuilder()
+{
+}
+
+bool CNakBuilder::add(const SSequenceRange &range)
+{
+   if(range.size() == 0 || CSequenceNumber::isAfter(range.begin, range.end))
+      return false;
+
+   if(rangeCount == 0)
+      previousEnd = range.begin;
+   else if(CSequenceNumber::isBefore(range.begin, previousEnd))
+      return false;
+
+   const uint64_t distance = range.begin - previousEnd;
+   const uint64_t sizeMinusOne = range.size() - 1;
+   if(length + CVarInt::size(distance) + CVarInt::size(sizeMinusOne) > maxLength)
+      return false;
+
+   if(rangeCount == 0)
+      CRmdgpHeader::store64(datagram + CRmdgpHeader::sequenceOffset, range.begin);
+   length += CVarInt::encode(datagram + length, maxLength - length, distance);
+   length += CVarInt::encode(datagram + length, maxLength - length, sizeMinusOne);
+   CRmdgpHeader::store16(datagram + CRmdgpHeader::payloadLengthOffset,
+                         uint16_t(length - CRmdgpHeader::size));
+   previousEnd = range.end;
+   rangeCount++;
+   return true;
+}
+
+CNakReader::CNakReader(const uint8_t *datagram, size_t length) :
+               position(datagram + CRmdgpHeader::size), end(datagram + length),
+               previousEnd(CRmdgpHeaderView(datagram).getSequence()), receiverId(0),
+               malformed(false)
+{
+   uint64_t id;
+   const size_t bytes = CVarInt::decode(position, end - position, id);
+
+   if(bytes == 0 || id > UINT32_MAX)
+      malformed = true;
+   else
+   {
+      receiverId = uint32_t(id);
+      position += bytes;
+   }
+}
+
+CNakReader::~CNakReader()
+{
+}
+
+bool CNakReader::next(SSequenceRange &range)
+{
+   uint64_t distance, sizeMinusOne;
+
+   if(position >= end || malformed)
+      return false;
+
+   size_t bytes = CVarInt::decode(position, end - position, distance);
+   if(bytes != 0)
+   {
+      position += bytes;
+      bytes = CVarInt::decode(position, end - position, sizeMinusOne);
+   }
+   if(bytes == 0 || sizeMinusOne >= uint64_t(INT64_MAX))
+   {
+      malformed = true;
+      return false;
+   }
+   position += bytes;
+
+   range.begin = previousEnd + distance;
+   range.end = range.begin + sizeMinusOne + 1;
+   previousEnd = range.end;
+   return true;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CNakPacket.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 20, 2021, 11:15 AM
+ */
+
+#ifndef CNAKPACKET_H
+#define CNAKPACKET_H
+
+#include "CRmdgpHeader.h"
+#include "CSequenceNumber.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief Builds a NAK datagram, a negative acknowledgement with the ranges of sequence numbers
+///        that a receiver misses. The ranges are range encoded relative to each other, so a
+///        datagram holds hundreds of them:
+///        the header sequence number is the begin of the first range and the payload holds a
+///        CVarInt with the receiver id, then per range two CVarInts: the distance from the end of
+///        the previous range (the header sequence number for the first range) to the begin, and
+///        the size - 1. The receiver id lets a receiver that gets the NAKs of the group back
+///        tell its own ones from the NAKs of the others.
+///        Ranges must be added in sequence order and must not overlap.
+class CNakBuilder {
+public:
+    /// \param datagram the send buffer
+    /// \param maxLength the maximum datagram length, including the header
+    /// \param receiverId identifies the receiver that asks
+    CNakBuilder(uint8_t *datagram, size_t maxLength, uint32_t sessionId, uint32_t streamId,
+                uint32_t receiverId);
+    CNakBuilder(const CNakBuilder& orig) = delete;
+    virtual ~CNakBuilder();
+
+    /// \brief adds a range
+    /// \return false when the range doesn't fit anymore, or isn't after the previous range
+    bool add(const SSequenceRange &range);
+
+    /// \brief returns the number of ranges added
+    size_t getRangeCount() const { return rangeCount; }
+    /// \brief returns the datagram length so far
+    size_t getLength() const { return length; }
+
+private:
+    uint8_t *datagram;
+    const size_t maxLength;
+    size_t length;
+    size_t rangeCount;
+    uint64_t previousEnd;
+};
+
+/// \brief Reads the ranges of a NAK datagram, in place
+class CNakReader {
+public:
+    /// \param datagram a datagram that passed CRmdgpHeaderView::validate and has type nak
+    /// \param length the datagram length
+    CNakReader(const uint8_t *datagram, size_t length);
+    CNakReader(const CNakReader& orig) = delete;
+    virtual ~CNakReader();
+
+    /// \brief returns the id of the receiver that sent the NAK
+    uint32_t getReceiverId() const { return receiverId; }
+
+    /// \brief reads the next range
+    /// \return false at the end of the datagram, or when the rest of the datagram is malformed
+    bool next(SSequenceRange &range);
+
+    /// \brief returns true when the receiver id or a range is malformed
+    bool isMalformed() const { return malformed; }
+
+private:
+    const uint8_t *position;
+    const uint8_t *end;
+    uint64_t previousEnd;
+    uint32_t receiverId;
+    bool malformed;
+};
+
+#endif /* CNAKPACKET_H */
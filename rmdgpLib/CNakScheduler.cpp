@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CNakScheduler.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 28, 2021, 3:45 PM
+ */
+
+#include "CNakScheduler.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+CNakScheduler::CNakScheduler(uint32_t seed) : rtt(defaultRtt), c1(defaultC1), c2(defaultC2),
+               lambda(defaultLambda), random(seed), uniform(0.0, 1.0), unscheduled(false),
+               nextDue(), suppressedCount(0)
+{
+}
+
+CNakScheduler::~CNakScheduler()
+{
+}
+
+void CNakScheduler::add(const SSequenceRange &range)
+{
+   if(range.size() == 0)
+      return;
+   pending.emplace_hint(pending.end(), range.begin, SPending{ range.end, CNanoTime(), 0, false });
+   unscheduled = true;
+}
+
+bool CNakScheduler::received(uint64_t sequence)
+{
+   TPending::iterator entry = split(sequence);
+
+   if(entry == pending.end() || entry->first != sequence)
+      return false;
+   split(sequence + 1);
+   pending.erase(entry);
+   return true;
+}
+
+size_t CNakScheduler::suppress(const SSequenceRange &range)
+{
+   size_t postponed = 0;
+
+   if(range.size() == 0)
+      return 0;
+   // both ends first, the iterators stay valid
+   const TPending::iterator first = split(range.begin);
+   const TPending::iterator last = split(range.end);
+   for(TPending::iterator entry = first; entry != last; ++entry)
+   {
+      entry->second.round = std::min(entry->second.round + 1, maxRound);
+      entry->second.scheduled = false;
+      postponed++;
+   }
+   if(postponed > 0)
+      unscheduled = true;
+   suppressedCount += postponed;
+   return postponed;
+}
+
+size_t CNakScheduler::takeDue(const CNanoTime &now, std::vector<SSequenceRange> &due)
+{
+   due.clear();
+   if(!unscheduled && now < nextDue)
+      return 0;
+
+   nextDue = CNanoTime::fromNsec(INT64_MAX);
+   for(TPending::iterator entry = pending.begin(); entry != pending.end(); ++entry)
+   {
+      SPending &state = entry->second;
+
+      if(!state.scheduled)
+      {
+         state.scheduled = true;
+         state.due = now + getDelay(state.round);
+      }
+      else if(state.due <= now)
+      {
+         if(!due.empty() && due.back().end == entry->first)
+            due.back().end = state.end;
+         else
+            due.push_back({ entry->first, state.end });
+         // wait longer for the repair before asking again
+         state.round = std::min(state.round + 1, maxRound);
+         state.due = now + getDelay(state.round);
+      }
+      nextDue = std::min(nextDue, state.due);
+   }
+   unscheduled = false;
+   return due.size();
+}
+
+CNanoTime CNakScheduler::getDelay(unsigned int round)
+{
+   const double u = uniform(random);
+   // the inverse of the distribution function of the exponential density
+   const double z = (lambda > 0.0) ? std::log1p(std::expm1(lambda) * u) / lambda : u;
+
+   return CNanoTime::fromNsec(int64_t(double(rtt.getNsec()) * (c1 + c2 * z)) << round);
+}
+
+CNakScheduler::TPending::iterator CNakScheduler::split(uint64_t at)
+{
+   TPending::iterator next = pending.upper_bound(at);
+
+   if(next == pending.begin())
+      return next;
+   const TPending::iterator entry = std::prev(next);
+   if(entry->first == at)
+      return entry;
+   if(!CSequenceNumber::isBefore(at, entry->second.end))
+      return next;
+
+   // the back part gets its own entry with the same state
+   SPending back = entry->second;
+   entry->second.end = at;
+   return pending.emplace_hint(next, at, back);
+}
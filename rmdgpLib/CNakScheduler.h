@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CNakScheduler.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 28, 2021, 3:45 PM
+ */
+
+#ifndef CNAKSCHEDULER_H
+#define CNAKSCHEDULER_H
+
+#include "CSequenceNumber.h"
+#include "../socketLib/CNanoTime.h"
+#include <map>
+#include <random>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief Decides when a receiver asks for its missing ranges, so a thousand receivers behind
+///        the same lost link don't all send a NAK for the same datagram (SRM style suppression).
+///        A missing range waits a random delay, scaled by the round trip time to the sender,
+///        before it is due. The NAKs are multicast to the group, so a receiver that sees a
+///        matching NAK of another receiver postpones its own, and the repair cancels it.
+///        After a NAK is sent the range stays pending with a doubled delay, in case the repair
+///        is lost as well.
+///        The random part of the delay of round r is 2^r * rtt * (c1 + c2 * z), where z in
+///        [0, 1) has density lambda * e^(lambda * z) / (e^lambda - 1): most receivers choose a
+///        late moment, a few an early one. With lambda = ln(receivers) + 1 the number of NAKs
+///        per loss stays about constant up to that number of receivers; lambda 0 gives the
+///        uniform delay of the original SRM.
+///        The missing ranges are kept in a map like the holes of CLossTracker; a partly matching
+///        NAK or a single repair splits a range.
+class CNakScheduler {
+public:
+    /// \param seed the seed of the random delays. Receivers must not share it.
+    CNakScheduler(uint32_t seed = std::random_device()());
+    CNakScheduler(const CNakScheduler& orig) = delete;
+    CNakScheduler& operator=(const CNakScheduler& other) = delete;
+    virtual ~CNakScheduler();
+
+    /// \brief sets the round trip time to the sender
+    void setRtt(const CNanoTime &newRtt) { rtt = newRtt; }
+    /// \brief sets the shape of the delay, see the class description
+    void setBackoff(double newC1, double newC2, double newLambda)
+        { c1 = newC1; c2 = newC2; lambda = newLambda; }
+
+    /// \brief adds a newly missing range, it gets its delay at the next takeDue. The range must
+    ///        not overlap a pending range.
+    void add(const SSequenceRange &range);
+    /// \brief the datagram with sequence is received, it isn't asked for anymore
+    /// \return true when it was pending
+    bool received(uint64_t sequence);
+    /// \brief an other receiver asked for range, the pending ranges in it get a new, doubled
+    ///        delay at the next takeDue
+    /// \return the number of postponed ranges
+    size_t suppress(const SSequenceRange &range);
+
+    /// \brief gives the ranges that are due at now, in sequence order and merged where they
+    ///        touch. They stay pending for a retry.
+    /// \param now the current CLOCK_MONOTONIC time
+    /// \param due receives the ranges to ask for
+    /// \return the number of ranges in due
+    size_t takeDue(const CNanoTime &now, std::vector<SSequenceRange> &due);
+
+    /// \brief returns a random delay for round
+    CNanoTime getDelay(unsigned int round);
+
+    /// \brief returns the number of pending ranges
+    size_t getPendingCount() const { return pending.size(); }
+    /// \brief returns the number of ranges that were postponed by NAKs of other receivers
+    uint64_t getSuppressedCount() const { return suppressedCount; }
+
+    /// \brief the delay doubles up to this round
+    static constexpr unsigned int maxRound = 6;
+    static constexpr CNanoTime defaultRtt = CNanoTime::fromMsec(1);
+    static constexpr double defaultC1 = 1.0;
+    static constexpr double defaultC2 = 4.0;
+    static constexpr double defaultLambda = 8.0;
+
+private:
+    struct SPending {
+        uint64_t end;
+        CNanoTime due;
+        unsigned int round;
+        bool scheduled;             ///< false until takeDue gives it a due time
+    };
+    typedef std::map<uint64_t, SPending, CSequenceNumber::SLess> TPending;
+
+    /// \brief splits the range that contains at, so a range begins at at
+    /// \return the first range that begins at or after at
+    TPending::iterator split(uint64_t at);
+
+    TPending pending;
+    CNanoTime rtt;
+    double c1;
+    double c2;
+    double lambda;
+    std::minstd_rand random;
+    std::uniform_real_distribution<double> uniform;
+    bool unscheduled;               ///< a range waits for its due time
+    CNanoTime nextDue;
+    uint64_t suppressedCount;
+};
+
+#endif /* CNAKSCHEDULER_H */
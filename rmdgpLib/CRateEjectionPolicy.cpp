@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CRateEjectionPolicy.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 27, 2021, 11:20 AM
+ */
+
+#include "CRateEjectionPolicy.h"
+#include "CReceiverTable.h"
+#include "CSequenceNumber.h"
+#include <sstream>
+#include <stdexcept>
+
+CRateEjectionPolicy::CRateEjectionPolicy(double minRate, const CNanoTime &interval,
+               const CNanoTime &gracePeriod) : minRate(minRate), interval(interval),
+               gracePeriod(gracePeriod), started(false), intervalStart(), intervalNextSequence(0)
+{
+   if(interval <= CNanoTime() || gracePeriod < CNanoTime())
+   {
+      std::ostringstream message;
+      message << "Error rate ejection policy with interval " << interval << " and grace period "
+              << gracePeriod;
+      throw std::runtime_error(message.str());
+   }
+}
+
+CRateEjectionPolicy::~CRateEjectionPolicy()
+{
+}
+
+bool CRateEjectionPolicy::evaluate(CReceiverTable &table, uint64_t nextSequence,
+                    const CNanoTime &now, std::vector<uint32_t> &eject)
+{
+   eject.clear();
+   if(!started)
+   {
+      // the first call only starts the first interval
+      started = true;
+      intervalStart = now;
+      intervalNextSequence = nextSequence;
+      return false;
+   }
+
+   const CNanoTime elapsed = now - intervalStart;
+   if(elapsed < interval)
+      return false;
+
+   lastRates.resize(table.getCount());
+   for(uint32_t index = 0; index < table.getCount(); index++)
+   {
+      const uint64_t acked = table.getAcked(index);
+      const double rate = double(acked - table.getIntervalAcked(index)) *
+                          double(CNanoTime::nsecInSec) / double(elapsed.getNsec());
+      const uint8_t flags = table.getFlags(index);
+
+      lastRates[index] = rate;
+      table.setIntervalAcked(index, acked);
+      if(rate < minRate && CSequenceNumber::isBefore(acked, intervalNextSequence))
+      {
+         if(!(flags & receiverFlagSlow))
+         {
+            table.setFlags(index, flags | receiverFlagSlow);
+            table.setSlowSince(index, intervalStart);
+         }
+         if(now - table.getSlowSince(index) >= gracePeriod)
+            eject.push_back(index);
+      }
+      else
+         table.setFlags(index, flags & ~receiverFlagSlow);
+   }
+
+   intervalStart = now;
+   intervalNextSequence = nextSequence;
+   return true;
+}
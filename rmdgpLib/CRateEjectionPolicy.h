@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CRateEjectionPolicy.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 27, 2021, 11:20 AM
+ */
+
+#ifndef CRATEEJECTIONPOLICY_H
+#define CRATEEJECTIONPOLICY_H
+
+#include "../socketLib/CNanoTime.h"
+#include <vector>
+#include <stdint.h>
+
+class CReceiverTable;
+
+/// \brief Decides which receivers are too slow to stay. The slowest receiver sets the pace of
+///        the sender, so one receiver with problems would block everybody. Every interval the
+///        goodput of each receiver is measured: the progress of its cumulative acknowledgement
+///        in that interval. A receiver is slow when its goodput is below the minimum rate while
+///        it was behind, it had not acknowledged everything that was sent at the start of the
+///        interval. So an idle sender doesn't make its receivers slow. A receiver that stays
+///        slow for the grace period is to be ejected.
+class CRateEjectionPolicy {
+public:
+    /// \param minRate the minimum rate, in datagrams per second
+    /// \param interval the measurement interval
+    /// \param gracePeriod how long a receiver may be slow
+    /// \throws std::runtime_error when interval is not positive or gracePeriod is negative
+    CRateEjectionPolicy(double minRate, const CNanoTime &interval, const CNanoTime &gracePeriod);
+    CRateEjectionPolicy(const CRateEjectionPolicy& orig) = delete;
+    CRateEjectionPolicy& operator=(const CRateEjectionPolicy& other) = delete;
+    virtual ~CRateEjectionPolicy();
+
+    /// \brief measures the receivers when the interval passed, else does nothing
+    /// \param table the receivers, their slow flags and interval state are updated
+    /// \param nextSequence the next sequence number of the sender
+    /// \param now the current time
+    /// \param eject receives the indexes of the receivers to eject, in increasing order
+    /// \return true when the receivers were measured
+    bool evaluate(CReceiverTable &table, uint64_t nextSequence, const CNanoTime &now,
+                  std::vector<uint32_t> &eject);
+
+    /// \brief returns the goodput of the receiver at index in the last interval
+    double getLastRate(uint32_t index) const
+        { return index < lastRates.size() ? lastRates[index] : 0.0; }
+
+    double getMinRate() const { return minRate; }
+    const CNanoTime& getInterval() const { return interval; }
+    const CNanoTime& getGracePeriod() const { return gracePeriod; }
+
+private:
+    const double minRate;
+    const CNanoTime interval;
+    const CNanoTime gracePeriod;
+    bool started;
+    CNanoTime intervalStart;
+    uint64_t intervalNextSequence;     ///< the next sequence number of the sender at the start
+    std::vector<double> lastRates;
+};
+
+#endif /* CRATEEJECTIONPOLICY_H */
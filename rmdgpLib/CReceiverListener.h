@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CReceiverListener.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 27, 2021, 11:20 AM
+ */
+
+#ifndef CRECEIVERLISTENER_H
+#define CRECEIVERLISTENER_H
+
+#include <stdint.h>
+
+/// \brief Interface for the events about the receivers of a CRmdgpSender. Derive from it and
+///        pass it to CRmdgpSender::setReceiverListener. The events are called from the thread
+///        that calls the sender.
+class CReceiverListener {
+public:
+    CReceiverListener() {}
+    CReceiverListener(const CReceiverListener& orig) = delete;
+    CReceiverListener& operator=(const CReceiverListener& other) = delete;
+    virtual ~CReceiverListener() {}
+
+    /// \brief the receiver stayed below the minimum rate for the grace period and is declared
+    ///        disconnected. It has no influence on the window anymore and its ACKs are ignored.
+    /// \param receiverId the id of the receiver
+    /// \param rate its rate in the last measurement interval, in datagrams per second
+    virtual void onReceiverEjected(uint32_t receiverId, double rate) = 0;
+};
+
+#endif /* CRECEIVERLISTENER_H */
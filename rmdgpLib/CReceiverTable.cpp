@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CReceiverTable.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 26, 2021, 2:10 PM
+ */
+
+#include "CReceiverTable.h"
+#include "CSequenceNumber.h"
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace {
+   // the weight of a new rate sample in the smoothed rate
+   const double rateGain = 1.0 / 8.0;
+   // the weight of a new loss report in the smoothed loss rate
+   const float lossGain = 1.0f / 8.0f;
+
+#if defined(__x86_64__)
+   __attribute__((target("avx2")))
+   int64_t scanMinAvx2(const uint64_t *acked, size_t count, uint64_t reference)
+   {
+      const __m256i base = _mm256_set1_epi64x(int64_t(reference));
+      __m256i minimum = _mm256_set1_epi64x(INT64_MAX);
+      __m256i minimum2 = minimum;
+      size_t i = 0;
+
+      // eight distances at a time in two independent chains; AVX2 has no 64 bit min, so
+      // compare and blend
+      for(; i + 8 <= count; i += 8)
+      {
+         const __m256i distance = _mm256_sub_epi64(
+                     _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acked + i)), base);
+         const __m256i distance2 = _mm256_sub_epi64(
+                     _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acked + i + 4)), base);
+         minimum = _mm256_blendv_epi8(minimum, distance, _mm256_cmpgt_epi64(minimum, distance));
+         minimum2 = _mm256_blendv_epi8(minimum2, distance2,
+                                       _mm256_cmpgt_epi64(minimum2, distance2));
+      }
+      minimum = _mm256_blendv_epi8(minimum, minimum2, _mm256_cmpgt_epi64(minimum, minimum2));
+
+      int64_t lanes[4];
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), minimum);
+      int64_t result = lanes[0];
+      for(int lane = 1; lane < 4; lane++)
+         result = (lanes[lane] < result) ? lanes[lane] : result;
+      for(; i < count; i++)
+      {
+         const int64_t distance = int64_t(acked[i] - reference);
+         result = (distance < result) ? distance : result;
+      }
+      return result;
+   }
+#endif
+
+   typedef int64_t (*TScanMin)(const uint64_t *acked, size_t count, uint64_t reference);
+
+   TScanMin selectScanMin()
+   {
+#if defined(__x86_64__)
+      if(__builtin_cpu_supports("avx2"))
+         return scanMinAvx2;
+#endif
+      return CReceiverTable::scanMinScalar;
+   }
+}
+
+CReceiverTable::CReceiverTable(size_t maxReceivers) : capacity(maxReceivers), count(0),
+               watermark(0), watermarkValid(false), scanCount(0)
+{
+   if(maxReceivers == 0 || maxReceivers > maxCapacity)
+   {
+      std::ostringstream message;
+      message << "Error receiver table of " << maxReceivers << " receivers, the maximum is "
+              << maxCapacity;
+      throw std::runtime_error(message.str());
+   }
+
+   ids.reset(new uint32_t[capacity]);
+   acked.reset(new uint64_t[capacity]);
+   highestReceived.reset(new uint64_t[capacity]);
+   lastHeard.reset(new CNanoTime[capacity]);
+   rates.reset(new double[capacity]);
+   lossRates.reset(new float[capacity]);
+   flags.reset(new uint8_t[capacity]);
+   intervalAcked.reset(new uint64_t[capacity]);
+   slowSince.reset(new CNanoTime[capacity]);
+   indexes.reserve(capacity);
+}
+
+CReceiverTable::~CReceiverTable()
+{
+}
+
+uint32_t CReceiverTable::add(uint32_t receiverId, uint64_t ackedSequence, const CNanoTime &now)
+{
+   if(count == capacity || indexes.count(receiverId) != 0)
+      return invalidIndex;
+
+   const uint32_t index = uint32_t(count++);
+   ids[index] = receiverId;
+   acked[index] = ackedSequence;
+   highestReceived[index] = ackedSequence;
+   lastHeard[index] = now;
+   rates[index] = 0.0;
+   lossRates[index] = 0.0f;
+   flags[index] = 0;
+   intervalAcked[index] = ackedSequence;
+   slowSince[index] = CNanoTime();
+   indexes[receiverId] = index;
+
+   if(count == 1)
+   {
+      watermark = ackedSequence;
+      watermarkValid = true;
+   }
+   else if(watermarkValid && CSequenceNumber::isBefore(ackedSequence, watermark))
+      watermark = ackedSequence;
+   return index;
+}
+
+void CReceiverTable::remove(uint32_t index)
+{
+   if(index >= count)
+      return;
+
+   if(acked[index] == watermark)
+      watermarkValid = false;
+   indexes.erase(ids[index]);
+
+   const uint32_t last = uint32_t(--count);
+   if(index != last)
+   {
+      ids[index] = ids[last];
+      acked[index] = acked[last];
+      highestReceived[index] = highestReceived[last];
+      lastHeard[index] = lastHeard[last];
+      rates[index] = rates[last];
+      lossRates[index] = lossRates[last];
+      flags[index] = flags[last];
+      intervalAcked[index] = intervalAcked[last];
+      slowSince[index] = slowSince[last];
+      indexes[ids[index]] = index;
+   }
+}
+
+void CReceiverTable::reportLoss(uint32_t index, double lossRate)
+{
+   if(flags[index] & receiverFlagLossValid)
+      lossRates[index] += (float(lossRate) - lossRates[index]) * lossGain;
+   else
+   {
+      lossRates[index] = float(lossRate);
+      flags[index] |= receiverFlagLossValid;
+   }
+}
+
+double CReceiverTable::getWorstLossRate() const
+{
+   float worst = 0.0f;
+
+   for(size_t i = 0; i < count; i++)
+      worst = (lossRates[i] > worst) ? lossRates[i] : worst;
+   return worst;
+}
+
+void CReceiverTable::acknowledge(uint32_t index, uint64_t cumulativeAck, uint64_t highestReceived,
+                    const CNanoTime &now)
+{
+   uint64_t advance = 0;
+
+   if(CSequenceNumber::isAfter(cumulativeAck, acked[index]))
+   {
+      // the receiver that held the watermark moves on, someone else may hold it now
+      if(acked[index] == watermark)
+         watermarkValid = false;
+      advance = cumulativeAck - acked[index];
+      acked[index] = cumulativeAck;
+   }
+   if(CSequenceNumber::isAfter(highestReceived, this->highestReceived[index]))
+      this->highestReceived[index] = highestReceived;
+
+   // an ACK without progress is a sample too, a stalled receiver gets a low rate
+   const CNanoTime elapsed = now - lastHeard[index];
+   if(elapsed > CNanoTime())
+   {
+      const double sample = double(advance) * double(CNanoTime::nsecInSec) /
+                            double(elapsed.getNsec());
+      if(flags[index] & receiverFlagRateValid)
+         rates[index] += (sample - rates[index]) * rateGain;
+      else
+      {
+         rates[index] = sample;
+         flags[index] |= receiverFlagRateValid;
+      }
+      lastHeard[index] = now;
+   }
+}
+
+int64_t CReceiverTable::scanMin(const uint64_t *acked, size_t count, uint64_t reference)
+{
+   static const TScanMin selected = selectScanMin();
+
+   return selected(acked, count, reference);
+}
+
+int64_t CReceiverTable::scanMinScalar(const uint64_t *acked, size_t count, uint64_t reference)
+{
+   int64_t result = INT64_MAX;
+
+   for(size_t i = 0; i < count; i++)
+   {
+      const int64_t distance = int64_t(acked[i] - reference);
+      result = (distance < result) ? distance : result;
+   }
+   return result;
+}
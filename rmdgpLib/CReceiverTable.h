@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CReceiverTable.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 26, 2021, 2:10 PM
+ */
+
+#ifndef CRECEIVERTABLE_H
+#define CRECEIVERTABLE_H
+
+#include "../socketLib/CNanoTime.h"
+#include <memory>
+#include <unordered_map>
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief bits in the flags of a receiver
+enum EReceiverFlag : uint8_t {
+    receiverFlagRateValid = 1,     ///< the rate estimate has at least one sample
+    receiverFlagSlow = 2,          ///< below the minimum rate, see CRateEjectionPolicy
+    receiverFlagLossValid = 4      ///< the loss estimate has at least one report
+};
+
+/// \brief The state the sender keeps per receiver, as a structure of arrays: every field has
+///        its own array, indexed by a dense receiver index 0 .. getCount() - 1. A receiver takes
+///        57 bytes and a scan over one field touches only that field, so the acknowledged
+///        sequence numbers of 1000 receivers are 125 cache lines.
+///        The receivers are found by the id in their ACKs. Removing a receiver moves the last
+///        one into its index, so indexes are only valid until the next remove.
+///        The lowest acknowledged sequence number, the watermark, is maintained incrementally:
+///        only when the receiver that held it moves on, the arrays are scanned again, with AVX2
+///        when the CPU has it.
+class CReceiverTable {
+public:
+    /// \param maxReceivers the maximum number of receivers
+    /// \throws std::runtime_error when maxReceivers is 0 or larger than maxCapacity
+    CReceiverTable(size_t maxReceivers);
+    CReceiverTable(const CReceiverTable& orig) = delete;
+    CReceiverTable& operator=(const CReceiverTable& other) = delete;
+    virtual ~CReceiverTable();
+
+    /// \brief returns the index of a receiver, or invalidIndex when it is unknown
+    uint32_t find(uint32_t receiverId) const
+    {
+        const std::unordered_map<uint32_t, uint32_t>::const_iterator it = indexes.find(receiverId);
+        return (it == indexes.end()) ? invalidIndex : it->second;
+    }
+
+    /// \brief adds a receiver
+    /// \param ackedSequence everything before it is received
+    /// \param now the time the receiver was heard of
+    /// \return the index of the receiver, or invalidIndex when the table is full or the
+    ///         receiver is known already
+    uint32_t add(uint32_t receiverId, uint64_t ackedSequence, const CNanoTime &now);
+
+    /// \brief removes a receiver, the last receiver moves to its index
+    void remove(uint32_t index);
+
+    /// \brief registers an ACK of the receiver at index. A cumulative acknowledgement before the
+    ///        known one is ignored, it was overtaken.
+    /// \param highestReceived the sequence number after the highest received one
+    /// \param now the time the ACK was received
+    void acknowledge(uint32_t index, uint64_t cumulativeAck, uint64_t highestReceived,
+                     const CNanoTime &now);
+
+    /// \brief registers the loss rate that the receiver at index reported in an ACK, see
+    ///        CAckBuilder::setLossRate. The reports are smoothed like the rate.
+    void reportLoss(uint32_t index, double lossRate);
+
+    /// \brief returns the lowest acknowledged sequence number of all receivers
+    /// \param reference a sequence number that no receiver has acknowledged beyond, like the
+    ///        next sequence number of the sender. It is returned when there are no receivers.
+    uint64_t getWatermark(uint64_t reference)
+    {
+        if(count == 0)
+            return reference;
+        if(!watermarkValid)
+        {
+            watermark = reference + uint64_t(scanMin(acked.get(), count, reference));
+            watermarkValid = true;
+            scanCount++;
+        }
+        return watermark;
+    }
+
+    uint32_t getReceiverId(uint32_t index) const { return ids[index]; }
+    /// \brief returns the cumulative acknowledgement: everything before it is received
+    uint64_t getAcked(uint32_t index) const { return acked[index]; }
+    /// \brief returns the sequence number after the highest received one
+    uint64_t getHighestReceived(uint32_t index) const { return highestReceived[index]; }
+    /// \brief returns when the receiver was heard of last
+    CNanoTime getLastHeard(uint32_t index) const { return lastHeard[index]; }
+    /// \brief returns the smoothed rate, in acknowledged datagrams per second
+    double getRate(uint32_t index) const { return rates[index]; }
+    /// \brief returns the smoothed loss rate that the receiver reported, 0 to 1
+    double getLossRate(uint32_t index) const { return lossRates[index]; }
+    /// \brief returns the highest smoothed loss rate of all receivers, 0 without reports
+    double getWorstLossRate() const;
+    uint8_t getFlags(uint32_t index) const { return flags[index]; }
+    void setFlags(uint32_t index, uint8_t newFlags) { flags[index] = newFlags; }
+    /// \brief the acknowledged sequence number at the start of the current measurement
+    ///        interval. Set to the acknowledged sequence number by add.
+    uint64_t getIntervalAcked(uint32_t index) const { return intervalAcked[index]; }
+    void setIntervalAcked(uint32_t index, uint64_t sequence) { intervalAcked[index] = sequence; }
+    /// \brief since when the receiver is slow, only meaningful with receiverFlagSlow
+    CNanoTime getSlowSince(uint32_t index) const { return slowSince[index]; }
+    void setSlowSince(uint32_t index, const CNanoTime &since) { slowSince[index] = since; }
+
+    /// \brief returns the number of receivers
+    size_t getCount() const { return count; }
+    size_t getCapacity() const { return capacity; }
+    /// \brief returns the number of full scans for the watermark
+    uint64_t getScanCount() const { return scanCount; }
+
+    /// \brief returns the lowest acked[i] - reference as signed (serial arithmetic) distance.
+    ///        Uses AVX2 when the CPU has it, else scanMinScalar. count must be at least 1.
+    static int64_t scanMin(const uint64_t *acked, size_t count, uint64_t reference);
+    /// \brief the portable version of scanMin, public for tests and benchmarks
+    static int64_t scanMinScalar(const uint64_t *acked, size_t count, uint64_t reference);
+
+    static constexpr uint32_t invalidIndex = UINT32_MAX;
+    static constexpr size_t maxCapacity = 1 << 20;
+
+private:
+    const size_t capacity;
+    size_t count;
+    std::unique_ptr<uint32_t[]> ids;
+    std::unique_ptr<uint64_t[]> acked;
+    std::unique_ptr<uint64_t[]> highestReceived;
+    std::unique_ptr<CNanoTime[]> lastHeard;
+    std::unique_ptr<double[]> rates;
+    std::unique_ptr<float[]> lossRates;
+    std::unique_ptr<uint8_t[]> flags;
+    std::unique_ptr<uint64_t[]> intervalAcked;
+    std::unique_ptr<CNanoTime[]> slowSince;
+    std::unordered_map<uint32_t, uint32_t> indexes;     ///< receiver id -> index
+
+    uint64_t watermark;
+    bool watermarkValid;
+    uint64_t scanCount;
+};
+
+#endif /* CRECEIVERTABLE_H */
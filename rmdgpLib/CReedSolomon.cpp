@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CReedSolomon.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 2, 2021, 9:30 PM
+ */
+
+#include "CReedSolomon.h"
+#include "CGaloisField.h"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+
+CReedSolomon::CReedSolomon(size_t dataShards, size_t parityShards) : dataShards(dataShards),
+               parityShards(parityShards), coefficients(dataShards * parityShards), matrix(),
+               missing(), rows(), syndromes()
+{
+   if(dataShards == 0 || dataShards > maxDataShards || parityShards == 0 ||
+      parityShards > maxParityShards)
+   {
+      std::ostringstream message;
+      message << "Error Reed-Solomon code with " << dataShards << " data and " << parityShards
+              << " parity shards, the maximum is " << maxDataShards << " and " << maxParityShards;
+      throw std::runtime_error(message.str());
+   }
+   for(size_t row = 0; row < parityShards; row++)
+      for(size_t column = 0; column < dataShards; column++)
+         coefficients[row * dataShards + column] = getCoefficient(row, column);
+   missing.reserve(dataShards);
+   rows.reserve(parityShards);
+}
+
+CReedSolomon::~CReedSolomon()
+{
+}
+
+void CReedSolomon::encode(const uint8_t *const *data, uint8_t *const *parity, size_t length) const
+{
+   for(size_t row = 0; row < parityShards; row++)
+   {
+      memset(parity[row], 0, length);
+      for(size_t column = 0; column < dataShards; column++)
+         CGaloisField::mulAddInto(coefficients[row * dataShards + column], parity[row],
+                                  data[column], length);
+   }
+}
+
+bool CReedSolomon::decode(uint8_t *const *shards, const bool *present, size_t length)
+{
+   missing.clear();
+   rows.clear();
+   for(size_t column = 0; column < dataShards; column++)
+      if(!present[column])
+         missing.push_back(column);
+   for(size_t row = 0; row < parityShards && rows.size() < missing.size(); row++)
+      if(present[dataShards + row])
+         rows.push_back(row);
+   if(missing.empty())
+      return true;
+   if(rows.size() < missing.size())
+      return false;
+
+   // the parity minus the received data leaves the part of the missing data:
+   // syndrome r = sum over the missing j of coefficient(r, j) * data j
+   const size_t count = missing.size();
+   syndromes.resize(count * length);
+   for(size_t i = 0; i < count; i++)
+   {
+      uint8_t *syndrome = &syndromes[i * length];
+      memcpy(syndrome, shards[dataShards + rows[i]], length);
+      for(size_t column = 0; column < dataShards; column++)
+         if(present[column])
+            CGaloisField::mulAddInto(coefficients[rows[i] * dataShards + column], syndrome,
+                                     shards[column], length);
+   }
+
+   // solve that square system
+   matrix.resize(count * count);
+   for(size_t i = 0; i < count; i++)
+      for(size_t j = 0; j < count; j++)
+         matrix[i * count + j] = coefficients[rows[i] * dataShards + missing[j]];
+   if(!invert(matrix.data(), count))
+      return false;
+   for(size_t j = 0; j < count; j++)
+   {
+      uint8_t *shard = shards[missing[j]];
+      memset(shard, 0, length);
+      for(size_t i = 0; i < count; i++)
+         CGaloisField::mulAddInto(matrix[j * count + i], shard, &syndromes[i * length], length);
+   }
+   return true;
+}
+
+uint8_t CReedSolomon::getCoefficient(size_t row, size_t column)
+{
+   // (x_0 + y_j) / (x_r + y_j), the addition in GF(2^8) is XOR
+   return CGaloisField::divide(uint8_t(255 ^ column), uint8_t((255 - row) ^ column));
+}
+
+bool CReedSolomon::invert(uint8_t *matrix, size_t size)
+{
+   std::vector<uint8_t> inverse(size * size, 0);
+
+   for(size_t i = 0; i < size; i++)
+      inverse[i * size + i] = 1;
+
+   for(size_t column = 0; column < size; column++)
+   {
+      // a row with a non zero pivot
+      size_t pivot = column;
+      while(pivot < size && matrix[pivot * size + column] == 0)
+         pivot++;
+      if(pivot == size)
+         return false;
+      if(pivot != column)
+      {
+         std::swap_ranges(matrix + pivot * size, matrix + (pivot + 1) * size,
+                          matrix + column * size);
+         std::swap_ranges(&inverse[pivot * size], &inverse[pivot * size] + size,
+                          &inverse[column * size]);
+      }
+
+      // scale the pivot to 1, then clear the column in all other rows
+      const uint8_t scale = CGaloisField::inverse(matrix[column * size + column]);
+      for(size_t j = 0; j < size; j++)
+      {
+         matrix[column * size + j] = CGaloisField::multiply(matrix[column * size + j], scale);
+         inverse[column * size + j] = CGaloisField::multiply(inverse[column * size + j], scale);
+      }
+      for(size_t row = 0; row < size; row++)
+      {
+         const uint8_t factor = matrix[row * size + column];
+         if(row == column || factor == 0)
+            continue;
+         for(size_t j = 0; j < size; j++)
+         {
+            matrix[row * size + j] ^= CGaloisField::multiply(factor, matrix[column * size + j]);
+            inverse[row * size + j] ^= CGaloisField::multiply(factor, inverse[column * size + j]);
+         }
+      }
+   }
+   std::copy(inverse.begin(), inverse.end(), matrix);
+   return true;
+}
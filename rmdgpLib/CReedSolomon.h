@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CReedSolomon.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 2, 2021, 9:30 PM
+ */
+
+#ifndef CREEDSOLOMON_H
+#define CREEDSOLOMON_H
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief A systematic Reed-Solomon erasure code over GF(2^8): k data shards are sent as they
+///        are, followed by m parity shards. Any k of the k + m shards give back the data, so up
+///        to m lost shards are repaired, in bursts as well.
+///        Parity shard r is the sum over the data shards j of getCoefficient(r, j) * data j.
+///        The coefficients are a Cauchy matrix 1 / (x_r + y_j), with x_r = 255 - r and
+///        y_j = j, whose columns are scaled so row 0 is all ones. Every square part of a
+///        Cauchy matrix is invertible and scaling keeps it that way, so the code is MDS. A
+///        coefficient only depends on r and j, not on k or m: parity 0 is the plain XOR parity
+///        of CFecEncoder, a shorter block uses the first columns, and a parity row that was
+///        not sent before is new information for every receiver.
+class CReedSolomon {
+public:
+    /// \param dataShards k, 1 to maxDataShards
+    /// \param parityShards m, 1 to maxParityShards
+    /// \throws std::runtime_error when k or m is out of range
+    CReedSolomon(size_t dataShards, size_t parityShards);
+    CReedSolomon(const CReedSolomon& orig) = delete;
+    CReedSolomon& operator=(const CReedSolomon& other) = delete;
+    virtual ~CReedSolomon();
+
+    /// \brief computes the parity shards
+    /// \param data k shards of length bytes
+    /// \param parity m shards of length bytes, they are overwritten
+    void encode(const uint8_t *const *data, uint8_t *const *parity, size_t length) const;
+
+    /// \brief rebuilds the missing data shards in place. Missing parity shards are not
+    ///        rebuilt.
+    /// \param shards k data shards followed by m parity shards, of length bytes. The buffers
+    ///        of missing data shards receive the data.
+    /// \param present k + m flags, true for the shards that are received
+    /// \return false when fewer than k shards are present, nothing is changed then
+    bool decode(uint8_t *const *shards, const bool *present, size_t length);
+
+    size_t getDataShards() const { return dataShards; }
+    size_t getParityShards() const { return parityShards; }
+
+    /// \brief returns the coefficient of data shard column in parity shard row
+    static uint8_t getCoefficient(size_t row, size_t column);
+
+    /// \brief inverts a square matrix over GF(2^8) in place, with Gauss-Jordan elimination
+    /// \param matrix size * size elements, row by row
+    /// \return false when the matrix is singular, it is garbage then
+    static bool invert(uint8_t *matrix, size_t size);
+
+    static constexpr size_t maxDataShards = 128;
+    static constexpr size_t maxParityShards = 32;
+
+private:
+    const size_t dataShards;
+    const size_t parityShards;
+    std::vector<uint8_t> coefficients;      ///< m rows of k
+    std::vector<uint8_t> matrix;            ///< scratch of decode
+    std::vector<size_t> missing;
+    std::vector<size_t> rows;
+    std::vector<uint8_t> syndromes;         ///< scratch of decode, one shard per missing shard
+};
+
+#endif /* CREEDSOLOMON_H */
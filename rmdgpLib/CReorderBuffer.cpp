@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CReorderBuffer.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 22, 2021, 8:00 PM
+ */
+
+#include "CReorderBuffer.h"
+#include "CSequenceNumber.h"
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+   // prevents an overflow when the window is rounded up
+   const size_t maxWindow = size_t(1) << 40;
+}
+
+CReorderBuffer::CReorderBuffer(size_t maxDatagrams, size_t maxBytes, uint64_t firstSequence) :
+               maxDatagrams(maxDatagrams), maxBytes(maxBytes), mask(0),
+               nextSequence(firstSequence), skipUntil(firstSequence), heldCount(0), heldBytes(0),
+               skippedCount(0)
+{
+   if(maxDatagrams == 0 || maxDatagrams > maxWindow || maxBytes == 0)
+   {
+      std::ostringstream message;
+      message << "Error invalid reorder buffer size, datagrams:" << maxDatagrams
+              << " bytes:" << maxBytes;
+      throw std::runtime_error(message.str());
+   }
+
+   size_t window = 1;
+   while(window < maxDatagrams)
+      window <<= 1;
+   mask = window - 1;
+   slots.reset(new SSlot[window]);
+   for(size_t i = 0; i < window; i++)
+      slots[i] = { emptySlot, 0 };
+}
+
+CReorderBuffer::~CReorderBuffer()
+{
+}
+
+CReorderBuffer::EResult CReorderBuffer::check(uint64_t sequence, size_t length) const
+{
+   const uint64_t distance = sequence - nextSequence;
+
+   if(distance > mask)
+      return (int64_t(distance) < 0) ? EResult::tooOld : EResult::full;
+   if(slots[sequence & mask].handle != emptySlot)
+      return EResult::duplicate;
+   if(distance == 0)
+      return EResult::deliverNow;
+   if(heldCount >= maxDatagrams || heldBytes + length > maxBytes)
+      return EResult::full;
+   return EResult::buffered;
+}
+
+CReorderBuffer::EResult CReorderBuffer::insert(const SReceivedDatagram &datagram)
+{
+   // the fast path: in order, the ring is not touched
+   if(datagram.sequence == nextSequence && heldCount == 0)
+   {
+      nextSequence++;
+      return EResult::deliverNow;
+   }
+
+   const EResult result = check(datagram.sequence, datagram.length);
+   if(result == EResult::deliverNow)
+      nextSequence++;
+   else if(result == EResult::buffered)
+   {
+      slots[datagram.sequence & mask] = { datagram.handle, datagram.length };
+      heldCount++;
+      heldBytes += datagram.length;
+   }
+   return result;
+}
+
+size_t CReorderBuffer::popReady(SReceivedDatagram *batch, size_t maxBatch)
+{
+   size_t count = 0;
+
+   // the fast path: nothing held, nothing to skip
+   if(heldCount == 0 && !CSequenceNumber::isBefore(nextSequence, skipUntil))
+      return 0;
+
+   while(count < maxBatch)
+   {
+      SSlot &slot = slots[nextSequence & mask];
+
+      if(slot.handle != emptySlot)
+      {
+         batch[count++] = { nextSequence, slot.handle, slot.length };
+         heldCount--;
+         heldBytes -= slot.length;
+         slot = { emptySlot, 0 };
+         nextSequence++;
+      }
+      else if(CSequenceNumber::isBefore(nextSequence, skipUntil))
+      {
+         if(heldCount == 0)
+         {
+            // nothing held anymore, jump to the end of the skipped range
+            skippedCount += skipUntil - nextSequence;
+            nextSequence = skipUntil;
+         }
+         else
+         {
+            skippedCount++;
+            nextSequence++;
+         }
+      }
+      else
+         break;
+   }
+   return count;
+}
+
+void CReorderBuffer::skip(uint64_t newNext)
+{
+   if(CSequenceNumber::isAfter(newNext, skipUntil))
+      skipUntil = newNext;
+}
+
+size_t CReorderBuffer::reset(uint64_t firstSequence, SReceivedDatagram *batch)
+{
+   size_t count = 0;
+
+   for(size_t i = 0; i <= mask && heldCount > 0; i++)
+   {
+      if(slots[i].handle != emptySlot)
+      {
+         batch[count++] = { 0, slots[i].handle, slots[i].length };
+         slots[i] = { emptySlot, 0 };
+         heldCount--;
+      }
+   }
+   heldBytes = 0;
+   nextSequence = firstSequence;
+   skipUntil = firstSequence;
+   return count;
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CReorderBuffer.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 22, 2021, 8:00 PM
+ */
+
+#ifndef CREORDERBUFFER_H
+#define CREORDERBUFFER_H
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief a received datagram, referred to by the handle of its CDatagramPool buffer
+struct SReceivedDatagram {
+    uint64_t sequence;
+    uint32_t handle;
+    uint32_t length;
+};
+
+/// \brief Holds datagrams that arrived out of order until the gap before them is filled, so the
+///        application gets them in sequence order. Only handles are stored, the datagrams are
+///        not copied. The buffer is a ring indexed by sequence number that covers a window of
+///        sequence numbers from getNextSequence(); the number of held datagrams and their bytes
+///        are bounded.
+///        A datagram that arrives in order is not stored at all: insert returns deliverNow and the
+///        caller delivers it directly, followed by the batch that popReady returns.
+class CReorderBuffer {
+public:
+    /// \brief the result of insert and check
+    enum class EResult {
+        deliverNow,     ///< the next sequence number, not stored; deliver it, then call popReady
+        buffered,       ///< stored until the gap before it is filled
+        duplicate,      ///< already stored
+        tooOld,         ///< before getNextSequence(), already delivered or skipped
+        full            ///< beyond the window or over the datagram or byte bound, not stored
+    };
+
+    /// \param maxDatagrams the maximum number of held datagrams, the window is the next power of
+    ///        two sequence numbers
+    /// \param maxBytes the maximum number of bytes of all held datagrams
+    /// \param firstSequence the first sequence number to deliver
+    /// \throws std::runtime_error when maxDatagrams or maxBytes is 0 or too large
+    CReorderBuffer(size_t maxDatagrams, size_t maxBytes, uint64_t firstSequence = 0);
+    CReorderBuffer(const CReorderBuffer& orig) = delete;
+    CReorderBuffer& operator=(const CReorderBuffer& other) = delete;
+    virtual ~CReorderBuffer();
+
+    /// \brief returns what insert would do, without storing
+    EResult check(uint64_t sequence, size_t length) const;
+
+    /// \brief offers a received datagram. Only when buffered the buffer takes the handle, in all
+    ///        other cases the caller keeps it.
+    EResult insert(const SReceivedDatagram &datagram);
+
+    /// \brief takes the datagrams that are in order now
+    /// \param batch receives the datagrams, in sequence order
+    /// \param maxBatch the size of batch. When more datagrams are ready, the next call returns
+    ///        the rest.
+    /// \return the number of datagrams in batch
+    size_t popReady(SReceivedDatagram *batch, size_t maxBatch);
+
+    /// \brief gives up on the sequence numbers before newNext that were not received. The held
+    ///        datagrams before newNext are still delivered by popReady.
+    void skip(uint64_t newNext);
+
+    /// \brief removes all held datagrams and starts at firstSequence
+    /// \param batch receives the removed datagrams, so their handles can be released. Must have
+    ///        room for getHeldCount() datagrams.
+    /// \return the number of removed datagrams
+    size_t reset(uint64_t firstSequence, SReceivedDatagram *batch);
+
+    /// \brief returns the sequence number that will be delivered next
+    uint64_t getNextSequence() const { return nextSequence; }
+    size_t getHeldCount() const { return heldCount; }
+    size_t getHeldBytes() const { return heldBytes; }
+    /// \brief returns the number of sequence numbers that were skipped without being received
+    uint64_t getSkippedCount() const { return skippedCount; }
+    /// \brief returns the number of sequence numbers covered by the ring, a power of two
+    size_t getWindow() const { return mask + 1; }
+
+    static constexpr uint32_t emptySlot = UINT32_MAX;
+
+private:
+    struct SSlot {
+        uint32_t handle;
+        uint32_t length;
+    };
+
+    const size_t maxDatagrams;
+    const size_t maxBytes;
+    size_t mask;
+    std::unique_ptr<SSlot[]> slots;
+    uint64_t nextSequence;
+    uint64_t skipUntil;
+    size_t heldCount;
+    size_t heldBytes;
+    uint64_t skippedCount;
+};
+
+#endif /* CREORDERBUFFER_H */
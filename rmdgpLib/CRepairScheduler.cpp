@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CRepairScheduler.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 29, 2021, 10:30 AM
+ */
+
+#include "CRepairScheduler.h"
+#include <algorithm>
+
+CRepairScheduler::CRepairScheduler(size_t unicastThreshold, const CNanoTime &window) :
+               unicastThreshold(unicastThreshold), window(window), pending(),
+               nextDue(CNanoTime::fromNsec(INT64_MAX)), mergedCount(0), multicastCount(0),
+               unicastCount(0)
+{
+}
+
+CRepairScheduler::~CRepairScheduler()
+{
+}
+
+bool CRepairScheduler::request(uint64_t sequence, const sockaddr_in &requester,
+                    const CNanoTime &now)
+{
+   const std::pair<TPending::iterator, bool> entry = pending.emplace(sequence,
+                  SPending{ now + window, unicastThreshold == 0, std::vector<sockaddr_in>() });
+   SPending &state = entry.first->second;
+
+   if(entry.second)
+      nextDue = std::min(nextDue, state.due);
+   else if(state.multicast || isKnown(state.requesters, requester))
+   {
+      mergedCount++;
+      return false;
+   }
+
+   if(state.multicast)
+      return true;
+   if(state.requesters.size() == unicastThreshold)
+   {
+      // one more than the threshold, one multicast serves them all
+      state.multicast = true;
+      state.requesters.clear();
+   }
+   else
+      state.requesters.push_back(requester);
+   return true;
+}
+
+size_t CRepairScheduler::takeDue(const CNanoTime &now, std::vector<uint64_t> &multicast,
+                    std::vector<SUnicastRepair> &unicast)
+{
+   multicast.clear();
+   unicast.clear();
+   if(now < nextDue)
+      return 0;
+
+   nextDue = CNanoTime::fromNsec(INT64_MAX);
+   for(TPending::iterator entry = pending.begin(); entry != pending.end(); )
+   {
+      const SPending &state = entry->second;
+
+      if(state.due > now)
+      {
+         nextDue = std::min(nextDue, state.due);
+         ++entry;
+         continue;
+      }
+      if(state.multicast)
+         multicast.push_back(entry->first);
+      else
+         for(const sockaddr_in &requester : state.requesters)
+            unicast.push_back({ entry->first, requester });
+      entry = pending.erase(entry);
+   }
+   multicastCount += multicast.size();
+   unicastCount += unicast.size();
+   return multicast.size() + unicast.size();
+}
+
+bool CRepairScheduler::isKnown(const std::vector<sockaddr_in> &requesters,
+                    const sockaddr_in &requester)
+{
+   for(const sockaddr_in &known : requesters)
+      if(known.sin_addr.s_addr == requester.sin_addr.s_addr && known.sin_port == requester.sin_port)
+         return true;
+   return false;
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CRepairScheduler.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 29, 2021, 10:30 AM
+ */
+
+#ifndef CREPAIRSCHEDULER_H
+#define CREPAIRSCHEDULER_H
+
+#include "CSequenceNumber.h"
+#include "../socketLib/CNanoTime.h"
+#include <netinet/in.h>
+#include <map>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief a repair for one receiver
+struct SUnicastRepair {
+    uint64_t sequence;
+    sockaddr_in requester;
+};
+
+/// \brief Decides how the sender repairs a lost datagram. The requests for a sequence number
+///        are gathered for a short window after the first one. Then the repair is multicast when
+///        more than unicastThreshold receivers asked for it, else it is sent to each of them.
+///        One receiver that misses a datagram doesn't make a thousand others handle a
+///        duplicate, and a loss on a shared link doesn't cost a thousand unicast datagrams.
+///        Repeated requests of a receiver for the same sequence number in the window are merged.
+class CRepairScheduler {
+public:
+    /// \param unicastThreshold up to this number of requesters the repair is unicast, 0 is
+    ///        always multicast
+    /// \param window how long the requests for a sequence number are gathered
+    CRepairScheduler(size_t unicastThreshold = defaultUnicastThreshold,
+                     const CNanoTime &window = defaultWindow);
+    CRepairScheduler(const CRepairScheduler& orig) = delete;
+    CRepairScheduler& operator=(const CRepairScheduler& other) = delete;
+    virtual ~CRepairScheduler();
+
+    /// \brief registers that requester asks for sequence
+    /// \return false when the request was merged with an earlier one
+    bool request(uint64_t sequence, const sockaddr_in &requester, const CNanoTime &now);
+
+    /// \brief takes the repairs whose window passed
+    /// \param multicast receives the sequence numbers to multicast, in sequence order
+    /// \param unicast receives the repairs to send to one receiver each
+    /// \return the number of repairs in multicast and unicast together
+    size_t takeDue(const CNanoTime &now, std::vector<uint64_t> &multicast,
+                   std::vector<SUnicastRepair> &unicast);
+
+    /// \brief returns the number of sequence numbers that wait for their window to pass
+    size_t getPendingCount() const { return pending.size(); }
+    /// \brief returns the number of requests that were merged
+    uint64_t getMergedCount() const { return mergedCount; }
+    /// \brief returns the number of multicast repairs
+    uint64_t getMulticastCount() const { return multicastCount; }
+    /// \brief returns the number of unicast repairs
+    uint64_t getUnicastCount() const { return unicastCount; }
+
+    size_t getUnicastThreshold() const { return unicastThreshold; }
+    const CNanoTime& getWindow() const { return window; }
+
+    static constexpr size_t defaultUnicastThreshold = 2;
+    static constexpr CNanoTime defaultWindow = CNanoTime::fromMsec(2);
+
+private:
+    struct SPending {
+        CNanoTime due;
+        bool multicast;                     ///< too many requesters, they aren't kept anymore
+        std::vector<sockaddr_in> requesters;
+    };
+    typedef std::map<uint64_t, SPending, CSequenceNumber::SLess> TPending;
+
+    /// \brief returns true when requester is in requesters, the list is short
+    static bool isKnown(const std::vector<sockaddr_in> &requesters, const sockaddr_in &requester);
+
+    const size_t unicastThreshold;
+    const CNanoTime window;
+    TPending pending;
+    CNanoTime nextDue;
+    uint64_t mergedCount;
+    uint64_t multicastCount;
+    uint64_t unicastCount;
+};
+
+#endif /* CREPAIRSCHEDULER_H */
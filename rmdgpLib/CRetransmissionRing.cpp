@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CRetransmissionRing.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 16, 2021, 8:02 PM
+ */
+
+#include "CRetransmissionRing.h"
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+
+namespace {
+   // the slot administration stores the length in 32 bits
+   const size_t maxSlotSize = UINT32_MAX;
+   // prevents an overflow when the number of slots is rounded up
+   const size_t maxRingMessages = size_t(1) << 40;
+}
+
+CRetransmissionRing::CRetransmissionRing(size_t maxMessages, size_t maxBytes,
+               size_t maxDatagramSize, uint64_t firstSequence) : maxMessages(maxMessages),
+               maxBytes(maxBytes), slotSize(maxDatagramSize), mask(0), cacheLinesPerSlot(0),
+               firstSequence(firstSequence), oldestSequence(firstSequence), count(0), bytes(0), storedBytes(0)
+{
+   if(maxMessages == 0 || maxMessages > maxRingMessages || maxBytes == 0 ||
+      maxDatagramSize == 0 || maxDatagramSize > maxSlotSize)
+   {
+      std::ostringstream message;
+      message << "Error invalid retransmission ring size, messages:" << maxMessages
+              << " bytes:" << maxBytes << " datagram size:" << maxDatagramSize;
+      throw std::runtime_error(message.str());
+   }
+
+   size_t capacity = 1;
+   while(capacity < maxMessages)
+      capacity <<= 1;
+   mask = capacity - 1;
+   cacheLinesPerSlot = (slotSize + cacheLineSize - 1) / cacheLineSize;
+
+   // value initialized, so all pages are mapped now and not on the first send
+   data.reset(new SCacheLine[capacity * cacheLinesPerSlot]());
+   slots.reset(new SSlotInfo[capacity]());
+}
+
+CRetransmissionRing::~CRetransmissionRing()
+{
+}
+
+uint8_t* CRetransmissionRing::store(size_t length)
+{
+   if(!canStore(length))
+      return nullptr;
+
+   const uint64_t sequence = oldestSequence + count;
+   SSlotInfo &slot = slots[sequence & mask];
+
+   storedBytes += length;
+   slot.endOffset = storedBytes;
+   slot.length = uint32_t(length);
+   bytes += length;
+   count++;
+   return slotData(sequence);
+}
+
+bool CRetransmissionRing::store(const void *datagram, size_t length)
+{
+   uint8_t *slot = store(length);
+
+   if(slot == nullptr)
+      return false;
+   memcpy(slot, datagram, length);
+   return true;
+}
+
+const uint8_t* CRetransmissionRing::lookup(uint64_t sequence, size_t &length) const
+{
+   if(!contains(sequence))
+      return nullptr;
+
+   length = slots[sequence & mask].length;
+   return slotData(sequence);
+}
+
+uint8_t* CRetransmissionRing::lookup(uint64_t sequence, size_t &length)
+{
+   return const_cast<uint8_t*>(static_cast<const CRetransmissionRing*>(this)->lookup(sequence,
+                                                                                     length));
+}
+
+const uint8_t* CRetransmissionRing::lookupHistory(uint64_t sequence, size_t &length) const
+{
+   const uint64_t start = getHistoryStart();
+
+   if(sequence - start >= getNextSequence() - start)
+      return nullptr;
+
+   length = slots[sequence & mask].length;
+   return slotData(sequence);
+}
+
+size_t CRetransmissionRing::release(uint64_t watermark)
+{
+   // serial number arithmetic: a watermark "before" the oldest sequence is a large distance
+   uint64_t released = watermark - oldestSequence;
+
+   if(int64_t(released) <= 0)
+      return 0;
+   if(released > count)
+      released = count;
+
+   // the bytes of all released datagrams follow from the end offset of the last one
+   const uint64_t lastSequence = oldestSequence + released - 1;
+   bytes = size_t(storedBytes - slots[lastSequence & mask].endOffset);
+   oldestSequence += released;
+   count -= released;
+   return released;
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CRetransmissionRing.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 16, 2021, 8:02 PM
+ */
+
+#ifndef CRETRANSMISSIONRING_H
+#define CRETRANSMISSIONRING_H
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief Keeps the datagrams that were sent until every receiver has acknowledged them, so they
+///        can be retransmitted. The ring has a power of two number of preallocated, cache line
+///        aligned slots and the slot of a datagram is its sequence number modulo the number of
+///        slots. Storing, looking up and releasing (any number of) datagrams are O(1) and nothing
+///        is allocated after construction.
+///        Sequence numbers are 64 bit and wrap around, the ring holds a consecutive range of them:
+///        from getOldestSequence() up to (excluding) getNextSequence().
+class CRetransmissionRing {
+public:
+    /// \param maxMessages the maximum number of datagrams that are kept. The ring allocates the
+    ///        next power of two slots.
+    /// \param maxBytes the maximum number of bytes that all kept datagrams together may have
+    /// \param maxDatagramSize the size of the largest datagram, the size of a slot.
+    /// \param firstSequence the sequence number of the first datagram that will be stored
+    /// \throws std::runtime_error when one of the sizes is 0 or too large
+    CRetransmissionRing(size_t maxMessages, size_t maxBytes, size_t maxDatagramSize,
+                        uint64_t firstSequence = 0);
+    CRetransmissionRing(const CRetransmissionRing& orig) = delete;
+    CRetransmissionRing& operator=(const CRetransmissionRing& other) = delete;
+    virtual ~CRetransmissionRing();
+
+    /// \brief claims the slot for the datagram with sequence number getNextSequence(), so the
+    ///        datagram can be built in place. The sequence number advances.
+    /// \param length the length of the datagram that will be written in the slot
+    /// \return the slot buffer or nullptr when the datagram doesn't fit in the message or byte
+    ///         bound, or is larger than maxDatagramSize.
+    uint8_t* store(size_t length);
+    /// \brief copies datagram in the next slot
+    /// \return false when the datagram doesn't fit, see store(size_t)
+    bool store(const void *datagram, size_t length);
+
+    /// \brief returns true when a datagram of length bytes can be stored now
+    bool canStore(size_t length) const
+    {
+        return (count < maxMessages) && (length <= slotSize) && (bytes + length <= maxBytes);
+    }
+
+    /// \brief finds the datagram with the given sequence number
+    /// \param length receives the length of the datagram
+    /// \return the datagram or nullptr when it was released or never stored
+    const uint8_t* lookup(uint64_t sequence, size_t &length) const;
+    uint8_t* lookup(uint64_t sequence, size_t &length);
+
+    /// \brief finds the datagram with the given sequence number, also when it is released but its
+    ///        slot isn't reused yet. This is the history that a late joiner can catch up from.
+    /// \param length receives the length of the datagram
+    /// \return the datagram or nullptr when it is not in the history
+    const uint8_t* lookupHistory(uint64_t sequence, size_t &length) const;
+    /// \brief returns the oldest sequence number that lookupHistory can still find. The history
+    ///        runs up to (excluding) getNextSequence().
+    uint64_t getHistoryStart() const
+    {
+        const uint64_t next = getNextSequence();
+        return (next - firstSequence > mask + 1) ? next - (mask + 1) : firstSequence;
+    }
+
+    /// \brief releases all datagrams before watermark, because every receiver has them.
+    ///        A watermark before getOldestSequence() is ignored, one after getNextSequence() is
+    ///        limited to getNextSequence().
+    /// \return the number of released datagrams
+    size_t release(uint64_t watermark);
+
+    /// \brief returns true when sequence is stored and not released yet
+    bool contains(uint64_t sequence) const { return (sequence - oldestSequence) < count; }
+
+    uint64_t getOldestSequence() const { return oldestSequence; }
+    uint64_t getNextSequence() const { return oldestSequence + count; }
+    /// \brief returns the number of datagrams that are kept
+    size_t getCount() const { return count; }
+    /// \brief returns the number of bytes that are kept
+    size_t getBytes() const { return bytes; }
+    size_t getMaxMessages() const { return maxMessages; }
+    size_t getMaxBytes() const { return maxBytes; }
+    size_t getMaxDatagramSize() const { return slotSize; }
+    /// \brief returns the number of slots, a power of two
+    size_t getCapacity() const { return mask + 1; }
+
+    static constexpr size_t cacheLineSize = 64;
+
+private:
+    struct alignas(cacheLineSize) SCacheLine {
+        uint8_t bytes[cacheLineSize];
+    };
+    /// \brief the administration of a slot, kept apart from the data so the hot fields of many
+    ///        slots share a cache line
+    struct SSlotInfo {
+        uint64_t endOffset;     ///< storedBytes after this datagram was stored
+        uint32_t length;
+    };
+
+    uint8_t* slotData(uint64_t sequence) const
+    {
+        return data[(sequence & mask) * cacheLinesPerSlot].bytes;
+    }
+
+    const size_t maxMessages;
+    const size_t maxBytes;
+    const size_t slotSize;
+    size_t mask;
+    size_t cacheLinesPerSlot;
+    std::unique_ptr<SCacheLine[]> data;
+    std::unique_ptr<SSlotInfo[]> slots;
+
+    const uint64_t firstSequence;
+    uint64_t oldestSequence;
+    size_t count;
+    size_t bytes;
+    uint64_t storedBytes;       ///< all bytes ever stored, the byte offset of the next datagram
+};
+
+#endif /* CRETRANSMISSIONRING_H */
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CRmdgpHeader.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 14, 2021, 7:20 PM
+ */
+
+#include "CRmdgpHeader.h"
+
+std::ostream& operator<<(std::ostream& os, ERmdgpValidation validation)
+{
+   switch(validation)
+   {
+      case ERmdgpValidation::valid:
+         return os << "valid";
+      case ERmdgpValidation::tooShort:
+         return os << "too short";
+      case ERmdgpValidation::badVersion:
+         return os << "bad version";
+      case ERmdgpValidation::badType:
+         return os << "bad type";
+      case ERmdgpValidation::badFlags:
+         return os << "bad flags";
+      case ERmdgpValidation::badLength:
+         return os << "bad length";
+   }
+   return os << "unknown(" << int(validation) << ")";
+}
+
+std::ostream& operator<<(std::ostream& os, const CRmdgpHeaderView &header)
+{
+   os << "version:" << int(header.getVersion()) << " type:" << int(header.getType())
+      << " flags:0x" << std::hex << header.getFlags() << std::dec
+      << " payloadLength:" << header.getPayloadLength()
+      << " session:" << header.getSessionId() << " stream:" << header.getStreamId()
+      << " sequence:" << header.getSequence();
+   return os;
+}
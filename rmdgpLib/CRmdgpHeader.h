@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CRmdgpHeader.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 14, 2021, 7:20 PM
+ */
+
+#ifndef CRMDGPHEADER_H
+#define CRMDGPHEADER_H
+
+#include <ostream>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+/// \brief The layout of the fixed size header in front of every RMDGP datagram. All fields are
+///        naturally aligned and stored in network byte order (big endian). The struct only
+///        documents and verifies the layout, the packet is read and written through
+///        CRmdgpHeaderView and CRmdgpHeaderBuilder, directly in the receive or send buffer.
+struct SRmdgpHeader {
+    uint8_t version;        ///< protocol version, CRmdgpHeader::version
+    uint8_t type;           ///< ERmdgpPacketType
+    uint16_t flags;         ///< ERmdgpFlag bits
+    uint16_t payloadLength; ///< number of bytes after the header
+    uint16_t reserved;      ///< sent as 0, ignored by the receiver. With rmdgpFlagFec the
+                            ///< FEC block size and the index in the block, one byte each.
+                            ///< With rmdgpFlagLossReport the loss rate of the receiver.
+    uint32_t sessionId;     ///< identifies a sender run, changes when the sender restarts
+    uint32_t streamId;      ///< identifies a stream within the session
+    uint64_t sequence;      ///< sequence number of the datagram within the stream
+};
+
+static_assert(sizeof(SRmdgpHeader) == 24, "the RMDGP header must be 24 bytes");
+static_assert(alignof(SRmdgpHeader) == 8, "the RMDGP header must be 8 byte aligned");
+static_assert(std::is_standard_layout<SRmdgpHeader>::value, "the RMDGP header needs a fixed layout");
+static_assert(offsetof(SRmdgpHeader, version) == 0, "RMDGP header layout");
+static_assert(offsetof(SRmdgpHeader, type) == 1, "RMDGP header layout");
+static_assert(offsetof(SRmdgpHeader, flags) == 2, "RMDGP header layout");
+static_assert(offsetof(SRmdgpHeader, payloadLength) == 4, "RMDGP header layout");
+static_assert(offsetof(SRmdgpHeader, reserved) == 6, "RMDGP header layout");
+static_assert(offsetof(SRmdgpHeader, sessionId) == 8, "RMDGP header layout");
+static_assert(offsetof(SRmdgpHeader, streamId) == 12, "RMDGP header layout");
+static_assert(offsetof(SRmdgpHeader, sequence) == 16, "RMDGP header layout");
+
+/// \brief the kind of datagram
+enum class ERmdgpPacketType : uint8_t {
+    data = 0,           ///< application data
+    nak = 1,            ///< negative acknowledgement from a receiver, see CNakBuilder
+    ack = 2,            ///< cumulative and selective acknowledgement from a receiver, see CAckBuilder
+    heartbeat = 3,      ///< sent by an idle sender, the sequence is the one the next datagram gets
+    parity = 4,         ///< XOR of a block of data datagrams, the sequence is the first of the
+                        ///< block, see CFecEncoder
+    join = 5,           ///< a late joiner asks the sender for the history it missed, see
+                        ///< CJoinBuilder
+    joinAccept = 6,     ///< the answer of the sender to a join, with the part of the history
+                        ///< that it will replay
+    count               ///< number of types, not a type itself
+};
+
+/// \brief bits in the flags field
+enum ERmdgpFlag : uint16_t {
+    rmdgpFlagRetransmission = 0x0001,   ///< the datagram is a repair of an earlier one
+    rmdgpFlagFec = 0x0002,              ///< the datagram is part of a FEC block, see CFecEncoder
+    rmdgpFlagLossReport = 0x0004,       ///< the ACK reports the loss rate, see CAckBuilder
+    rmdgpFlagCatchUp = 0x0008,          ///< a data datagram replayed to a late joiner
+    rmdgpKnownFlags = rmdgpFlagRetransmission | rmdgpFlagFec | rmdgpFlagLossReport |
+                      rmdgpFlagCatchUp
+};
+
+/// \brief the result of CRmdgpHeaderView::validate
+enum class ERmdgpValidation {
+    valid,
+    tooShort,           ///< the datagram is smaller than the header
+    badVersion,         ///< unsupported protocol version
+    badType,            ///< unknown packet type
+    badFlags,           ///< flags that this version doesn't know
+    badLength           ///< the payload length doesn't match the datagram size
+};
+
+std::ostream& operator<<(std::ostream& os, ERmdgpValidation validation);
+
+/// \brief constants of the RMDGP header
+class CRmdgpHeader {
+public:
+    static constexpr uint8_t version = 1;
+    static constexpr size_t size = sizeof(SRmdgpHeader);
+    static constexpr size_t maxPayloadLength = UINT16_MAX;
+
+    static constexpr size_t versionOffset = offsetof(SRmdgpHeader, version);
+    static constexpr size_t typeOffset = offsetof(SRmdgpHeader, type);
+    static constexpr size_t flagsOffset = offsetof(SRmdgpHeader, flags);
+    static constexpr size_t payloadLengthOffset = offsetof(SRmdgpHeader, payloadLength);
+    static constexpr size_t reservedOffset = offsetof(SRmdgpHeader, reserved);
+    static constexpr size_t sessionIdOffset = offsetof(SRmdgpHeader, sessionId);
+    static constexpr size_t streamIdOffset = offsetof(SRmdgpHeader, streamId);
+    static constexpr size_t sequenceOffset = offsetof(SRmdgpHeader, sequence);
+    static constexpr size_t fecBlockSizeOffset = reservedOffset;
+    static constexpr size_t fecIndexOffset = reservedOffset + 1;
+    static constexpr size_t lossReportOffset = reservedOffset;
+
+    /// \brief big endian loads and stores. Written with shifts so they are constexpr and
+    ///        independent of the alignment of the buffer; the compiler turns them into a single
+    ///        load or store with a byte swap.
+    static constexpr uint16_t load16(const uint8_t *p)
+        { return uint16_t((uint16_t(p[0]) << 8) | p[1]); }
+    static constexpr uint32_t load32(const uint8_t *p)
+        { return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3]; }
+    static constexpr uint64_t load64(const uint8_t *p)
+        { return (uint64_t(load32(p)) << 32) | load32(p + 4); }
+    static constexpr void store16(uint8_t *p, uint16_t value)
+        { p[0] = uint8_t(value >> 8); p[1] = uint8_t(value); }
+    static constexpr void store32(uint8_t *p, uint32_t value)
+        { store16(p, uint16_t(value >> 16)); store16(p + 2, uint16_t(value)); }
+    static constexpr void store64(uint8_t *p, uint64_t value)
+        { store32(p, uint32_t(value >> 32)); store32(p + 4, uint32_t(value)); }
+};
+
+/// \brief Read only access to the header at the start of a received datagram, without copying.
+///        Call validate before using the other methods on data from the network.
+class CRmdgpHeaderView {
+public:
+    explicit constexpr CRmdgpHeaderView(const uint8_t *datagram) : buffer(datagram) {}
+
+    /// \brief checks a received datagram with a few compares, without reading the payload
+    /// \param datagram the received bytes
+    /// \param length the number of received bytes
+    static constexpr ERmdgpValidation validate(const uint8_t *datagram, size_t length)
+    {
+        if(length < CRmdgpHeader::size)
+            return ERmdgpValidation::tooShort;
+        if(datagram[CRmdgpHeader::versionOffset] != CRmdgpHeader::version)
+            return ERmdgpValidation::badVersion;
+        if(datagram[CRmdgpHeader::typeOffset] >= uint8_t(ERmdgpPacketType::count))
+            return ERmdgpValidation::badType;
+        if(CRmdgpHeader::load16(datagram + CRmdgpHeader::flagsOffset) & ~rmdgpKnownFlags)
+            return ERmdgpValidation::badFlags;
+        if(CRmdgpHeader::load16(datagram + CRmdgpHeader::payloadLengthOffset) !=
+           length - CRmdgpHeader::size)
+            return ERmdgpValidation::badLength;
+        return ERmdgpValidation::valid;
+    }
+
+    constexpr uint8_t getVersion() const { return buffer[CRmdgpHeader::versionOffset]; }
+    constexpr ERmdgpPacketType getType() const
+        { return ERmdgpPacketType(buffer[CRmdgpHeader::typeOffset]); }
+    constexpr uint16_t getFlags() const
+        { return CRmdgpHeader::load16(buffer + CRmdgpHeader::flagsOffset); }
+    constexpr bool hasFlag(ERmdgpFlag flag) const { return (getFlags() & flag) != 0; }
+    constexpr uint16_t getPayloadLength() const
+        { return CRmdgpHeader::load16(buffer + CRmdgpHeader::payloadLengthOffset); }
+    constexpr uint32_t getSessionId() const
+        { return CRmdgpHeader::load32(buffer + CRmdgpHeader::sessionIdOffset); }
+    constexpr uint32_t getStreamId() const
+        { return CRmdgpHeader::load32(buffer + CRmdgpHeader::streamIdOffset); }
+    constexpr uint64_t getSequence() const
+        { return CRmdgpHeader::load64(buffer + CRmdgpHeader::sequenceOffset); }
+    /// \brief the FEC block size and the index in the block, only valid with rmdgpFlagFec and
+    ///        in a parity datagram
+    constexpr uint8_t getFecBlockSize() const { return buffer[CRmdgpHeader::fecBlockSizeOffset]; }
+    constexpr uint8_t getFecIndex() const { return buffer[CRmdgpHeader::fecIndexOffset]; }
+    /// \brief the loss report of an ACK, only valid with rmdgpFlagLossReport
+    constexpr uint16_t getLossReport() const
+        { return CRmdgpHeader::load16(buffer + CRmdgpHeader::lossReportOffset); }
+    /// \brief returns the first byte after the header
+    constexpr const uint8_t* getPayload() const { return buffer + CRmdgpHeader::size; }
+
+    friend std::ostream& operator<<(std::ostream& os, const CRmdgpHeaderView &header);
+
+private:
+    const uint8_t *buffer;
+};
+
+/// \brief Writes the header at the start of a send buffer, in place. The setters return the
+///        builder, so a header can be written in one expression.
+class CRmdgpHeaderBuilder {
+public:
+    /// \brief sets the version and clears the rest of the header
+    explicit constexpr CRmdgpHeaderBuilder(uint8_t *datagram) : buffer(datagram)
+    {
+        for(size_t i = 0; i < CRmdgpHeader::size; i++)
+            buffer[i] = 0;
+        buffer[CRmdgpHeader::versionOffset] = CRmdgpHeader::version;
+    }
+
+    constexpr CRmdgpHeaderBuilder& setType(ERmdgpPacketType type)
+        { buffer[CRmdgpHeader::typeOffset] = uint8_t(type); return *this; }
+    constexpr CRmdgpHeaderBuilder& setFlags(uint16_t flags)
+        { CRmdgpHeader::store16(buffer + CRmdgpHeader::flagsOffset, flags); return *this; }
+    constexpr CRmdgpHeaderBuilder& setPayloadLength(uint16_t length)
+        { CRmdgpHeader::store16(buffer + CRmdgpHeader::payloadLengthOffset, length); return *this; }
+    constexpr CRmdgpHeaderBuilder& setSessionId(uint32_t sessionId)
+        { CRmdgpHeader::store32(buffer + CRmdgpHeader::sessionIdOffset, sessionId); return *this; }
+    constexpr CRmdgpHeaderBuilder& setStreamId(uint32_t streamId)
+        { CRmdgpHeader::store32(buffer + CRmdgpHeader::streamIdOffset, streamId); return *this; }
+    constexpr CRmdgpHeaderBuilder& setSequence(uint64_t sequence)
+        { CRmdgpHeader::store64(buffer + CRmdgpHeader::sequenceOffset, sequence); return *this; }
+    constexpr CRmdgpHeaderBuilder& setFecPosition(uint8_t blockSize, uint8_t index)
+    {
+        buffer[CRmdgpHeader::fecBlockSizeOffset] = blockSize;
+        buffer[CRmdgpHeader::fecIndexOffset] = index;
+        return *this;
+    }
+    constexpr CRmdgpHeaderBuilder& setLossReport(uint16_t report)
+        { CRmdgpHeader::store16(buffer + CRmdgpHeader::lossReportOffset, report); return *this; }
+
+    /// \brief returns the first byte after the header, where the payload goes
+    constexpr uint8_t* getPayload() const { return buffer + CRmdgpHeader::size; }
+
+private:
+    uint8_t *buffer;
+};
+
+#endif /* CRMDGPHEADER_H */
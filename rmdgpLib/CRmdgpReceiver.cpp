@@ -0,0 +1,540 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CRmdgpReceiver.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 20, 2021, 2:40 PM
+ */
+
+#include "CRmdgpReceiver.h"
+#include "CAckPacket.h"
+#include "CJoinPacket.h"
+#include "CNakPacket.h"
+#include "../socketLib/CLatencyRecorder.h"
+#include "../socketLib/CUdpMulticastReceiver.h"
+#include <netinet/in.h>
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+   /// \brief the number of datagrams the reorder buffer may hold. The rest of the buffers stays
+   ///        free to receive, so the repair that closes a gap can always be read: an eighth,
+   ///        and at least one.
+   size_t getHeldLimit(size_t maxDatagrams)
+   {
+      return maxDatagrams - std::max<size_t>(1, maxDatagrams / 8);
+   }
+}
+
+CRmdgpReceiver::CRmdgpReceiver(std::shared_ptr<CUdpMulticastReceiver> receiver,
+               const sockaddr_in &senderAddress, uint32_t streamId, size_t maxDatagrams,
+               size_t maxDatagramSize) : receiver(receiver),
+               senderAddress(new sockaddr_in(senderAddress)), streamId(streamId), sessionId(0),
+               sessionKnown(false), datagramPool(maxDatagrams, maxDatagramSize),
+               reorderBuffer(getHeldLimit(maxDatagrams), maxDatagrams * maxDatagramSize),
+               duplicateFilter(reorderBuffer.getWindow()), ignoredCount(0),
+               droppedCount(0), receiverId(std::random_device()()),
+               ackPacketThreshold(defaultAckPacketThreshold), ackInterval(defaultAckInterval),
+               packetsSinceAck(0), lastTimedAck(), ackCount(0), senderHeard(false), lastHeard(),
+               senderTimeout(defaultSenderTimeout), heartbeatCount(0), heartbeatSequence(0),
+               ackedSequence(0), highestTime(), latestNow(), tailLossCount(0), lostCount(0),
+               reportedExpected(0), reportedLost(0), feedbackBuffer(maxFeedbackLength), nakGroup(),
+               nakScheduler(), nakRanges(),
+               nakCount(0), fecDecoder(), catchUpHistory(0), joinRetryInterval(),
+               catchingUp(false), catchUpNext(0), catchUpEnd(0), catchUpProgressed(false),
+               lastCatchUpProgress(), joinAttempts(0), catchUpCount(0), joinCount(0),
+               resuming(false), resumeSequence(0), resumeSessionId(0),
+               holdLatencyRecorder(), arrivalTimes()
+{
+}
+
+CRmdgpReceiver::~CRmdgpReceiver()
+{
+}
+
+size_t CRmdgpReceiver::receive(SReceivedDatagram *ready, size_t maxReady, const CNanoTime &now)
+{
+   const uint32_t handle = datagramPool.acquire();
+
+   if(handle == CDatagramPool::invalidHandle)
+      return 0;
+
+   const size_t length = receiver->receive(datagramPool.getBuffer(handle),
+                                           datagramPool.getBufferSize());
+   if(length == 0)
+   {
+      datagramPool.release(handle);
+      return 0;
+   }
+   return processDatagram(handle, length, ready, maxReady, now);
+}
+
+size_t CRmdgpReceiver::processDatagram(uint32_t handle, size_t length, SReceivedDatagram *ready,
+                    size_t maxReady, const CNanoTime &now)
+{
+   const uint8_t *datagram = datagramPool.getBuffer(handle);
+
+   latestNow = now;
+   if(holdLatencyRecorder)
+      arrivalTimes[handle] = now;
+   if(CRmdgpHeaderView::validate(datagram, length) != ERmdgpValidation::valid)
+   {
+      ignoredCount++;
+      datagramPool.release(handle);
+      return 0;
+   }
+
+   const CRmdgpHeaderView header(datagram);
+   const ERmdgpPacketType type = header.getType();
+   // NAKs of other receivers, parity and join accepts only count within a known session
+   if((type != ERmdgpPacketType::data && type != ERmdgpPacketType::heartbeat &&
+       !(type == ERmdgpPacketType::nak && sessionKnown) &&
+       !(type == ERmdgpPacketType::joinAccept && sessionKnown) &&
+       !(type == ERmdgpPacketType::parity && sessionKnown && fecDecoder)) ||
+      header.getStreamId() != streamId || (sessionKnown && header.getSessionId() != sessionId))
+   {
+      ignoredCount++;
+      datagramPool.release(handle);
+      return 0;
+   }
+
+   if(type == ERmdgpPacketType::nak)
+   {
+      suppressNaks(datagram, length);
+      datagramPool.release(handle);
+      return 0;
+   }
+
+   if(type == ERmdgpPacketType::joinAccept)
+      return processJoinAccept(handle, length, ready, maxReady);
+   if(header.hasFlag(rmdgpFlagCatchUp))
+      return processCatchUp(handle, length, ready, maxReady);
+
+   const uint64_t sequence = header.getSequence();
+   if(!sessionKnown)
+   {
+      // start with the first datagram we see
+      sessionId = header.getSessionId();
+      sessionKnown = true;
+      lossTracker.reset(sequence);
+      reportedExpected = sequence;
+      // nothing is held before the first datagram, so there is nothing to remove
+      reorderBuffer.reset(sequence, nullptr);
+      duplicateFilter.reset(sequence);
+      // a resumed receiver needs only what it didn't deliver before in this session, as far as
+      // the history reaches
+      uint64_t begin = sequence - catchUpHistory;
+      if(isResumed() && CSequenceNumber::isAfter(resumeSequence, begin))
+         begin = resumeSequence;
+      if(CSequenceNumber::isBefore(begin, sequence))
+      {
+         // the history is delivered first, the live datagrams wait for it
+         catchingUp = true;
+         catchUpNext = begin;
+         catchUpEnd = sequence;
+         reorderBuffer.reset(catchUpNext, nullptr);
+         catchUpProgressed = true;
+         sendJoin();
+      }
+      else if(CSequenceNumber::isAfter(begin, sequence))
+      {
+         // delivered before the restart, the stream continues at begin
+         lossTracker.reset(begin);
+         reportedExpected = begin;
+         reorderBuffer.reset(begin, nullptr);
+         duplicateFilter.reset(begin);
+      }
+      ackedSequence = lossTracker.getFirstMissing();
+   }
+   senderHeard = true;
+
+   if(type == ERmdgpPacketType::heartbeat)
+   {
+      // everything before the sequence of a heartbeat is sent
+      const uint64_t expected = lossTracker.getNextExpected();
+      const uint64_t missing = lossTracker.expect(sequence);
+      const bool idleStart = heartbeatCount == 0 || sequence != heartbeatSequence;
+      heartbeatCount++;
+      heartbeatSequence = sequence;
+      tailLossCount += missing;
+      lostCount += missing;
+      if(missing > 0 && nakGroup)
+         nakScheduler.add({ expected, sequence });
+      datagramPool.release(handle);
+      // the idle sender gets no ACKs from the data, so a lost ACK would leave this receiver
+      // behind at rate 0 for it. Answer the first heartbeat of an idle period, and every one
+      // that is ahead of the last ACK.
+      if(idleStart || CSequenceNumber::isBefore(ackedSequence, sequence))
+         sendAck(now);
+      return 0;
+   }
+
+   if(type == ERmdgpPacketType::parity)
+   {
+      // a block that is received completely doesn't need it
+      if(CSequenceNumber::isAfter(sequence + header.getFecBlockSize(),
+                                  lossTracker.getFirstMissing()))
+         fecDecoder->addParity(sequence, header.getFecBlockSize(), header.getFecIndex(),
+                               header.getPayload(), header.getPayloadLength());
+      datagramPool.release(handle);
+      return recoverLost(ready, maxReady);
+   }
+
+   // duplicates are the common case with multicast repairs, drop them first
+   if(duplicateFilter.checkAndSet(sequence) != CDuplicateFilter::EResult::fresh)
+   {
+      droppedCount++;
+      datagramPool.release(handle);
+      return 0;
+   }
+
+   // a datagram that doesn't fit in the reorder buffer is not registered as received, so it
+   // will be asked for again
+   const SReceivedDatagram received = { sequence, handle, uint32_t(length) };
+   if(reorderBuffer.check(sequence, length) == CReorderBuffer::EResult::full ||
+      (catchingUp && datagramPool.getFreeCount() < datagramPool.getCount() / 4))
+   {
+      duplicateFilter.clear(sequence);
+      droppedCount++;
+      datagramPool.release(handle);
+      return 0;
+   }
+   if(fecDecoder && header.hasFlag(rmdgpFlagFec))
+      fecDecoder->addData(sequence, header.getFecBlockSize(), header.getFecIndex(),
+                          header.getPayload(), header.getPayloadLength());
+   const uint64_t expected = lossTracker.getNextExpected();
+   const CLossTracker::EResult result = lossTracker.receive(sequence);
+   if(result == CLossTracker::EResult::gapDetected)
+      lostCount += sequence - expected;
+   if(result == CLossTracker::EResult::inOrder || result == CLossTracker::EResult::gapDetected)
+      highestTime = now;
+   if(nakGroup)
+   {
+      if(result == CLossTracker::EResult::gapDetected)
+         nakScheduler.add({ expected, sequence });
+      else if(result == CLossTracker::EResult::repaired)
+         nakScheduler.received(sequence);
+   }
+   if(++packetsSinceAck >= ackPacketThreshold)
+      sendAck(now);
+
+   size_t count = 0;
+   if(reorderBuffer.insert(received) == CReorderBuffer::EResult::deliverNow)
+   {
+      ready[0] = received;
+      count = 1 + reorderBuffer.popReady(ready + 1, maxReady - 1);
+      duplicateFilter.advance(reorderBuffer.getNextSequence());
+      recordHoldTimes(ready, count);
+   }
+   return count + recoverLost(ready + count, maxReady - count);
+}
+
+size_t CRmdgpReceiver::processCatchUp(uint32_t handle, size_t length, SReceivedDatagram *ready,
+                    size_t maxReady)
+{
+   const uint64_t sequence = CRmdgpHeaderView(datagramPool.getBuffer(handle)).getSequence();
+   const SReceivedDatagram received = { sequence, handle, uint32_t(length) };
+
+   // in order only, after a loss the join is sent again from catchUpNext
+   if(!catchingUp || sequence != catchUpNext ||
+      reorderBuffer.insert(received) != CReorderBuffer::EResult::deliverNow)
+   {
+      droppedCount++;
+      datagramPool.release(handle);
+      return 0;
+   }
+   catchUpNext++;
+   catchUpCount++;
+   catchUpProgressed = true;
+   joinAttempts = 0;
+   if(catchUpNext == catchUpEnd)
+      catchingUp = false;
+
+   ready[0] = received;
+   const size_t count = 1 + reorderBuffer.popReady(ready + 1, maxReady - 1);
+   duplicateFilter.advance(reorderBuffer.getNextSequence());
+   recordHoldTimes(ready, count);
+   return count;
+}
+
+size_t CRmdgpReceiver::processJoinAccept(uint32_t handle, size_t length,
+                    SReceivedDatagram *ready, size_t maxReady)
+{
+   const CJoinReader accept(datagramPool.getBuffer(handle), length);
+   datagramPool.release(handle);
+
+   // an accept for an earlier join has an other end, or a begin we are already past
+   if(!catchingUp || accept.isMalformed() || accept.getReceiverId() != receiverId ||
+      accept.getRange().end != catchUpEnd)
+      return 0;
+   catchUpProgressed = true;
+   if(!CSequenceNumber::isAfter(accept.getRange().begin, catchUpNext))
+      return 0;
+   skipHistory(accept.getRange().begin);
+   return getReady(ready, maxReady);
+}
+
+void CRmdgpReceiver::skipHistory(uint64_t newNext)
+{
+   reorderBuffer.skip(newNext);
+   catchUpNext = newNext;
+   if(catchUpNext == catchUpEnd)
+      catchingUp = false;
+}
+
+void CRmdgpReceiver::setCatchUp(size_t history, const CNanoTime &retryInterval)
+{
+   if(history == 0 || history > reorderBuffer.getWindow() / 2 || sessionKnown)
+   {
+      std::ostringstream message;
+      message << "Error catch-up history " << history << " with a reorder window of "
+              << reorderBuffer.getWindow() << (sessionKnown ? " after the session started" : "");
+      throw std::runtime_error(message.str());
+   }
+   catchUpHistory = history;
+   joinRetryInterval = retryInterval;
+}
+
+void CRmdgpReceiver::setResume(uint64_t next, uint32_t sessionId, uint32_t streamId)
+{
+   if(catchUpHistory == 0 || sessionKnown || streamId != this->streamId)
+   {
+      std::ostringstream message;
+      message << "Error resume at " << next << " of stream " << streamId
+              << (sessionKnown ? " after the session started" :
+                  (catchUpHistory == 0 ? " without catch-up" : " in an other stream"));
+      throw std::runtime_error(message.str());
+   }
+   resuming = true;
+   resumeSequence = next;
+   resumeSessionId = sessionId;
+}
+
+bool CRmdgpReceiver::sendJoin()
+{
+   if(!catchingUp)
+      return false;
+
+   CJoinBuilder join(feedbackBuffer.data(), ERmdgpPacketType::join, sessionId, streamId,
+                     receiverId, { catchUpNext, catchUpEnd });
+   receiver->sendTo(feedbackBuffer.data(), join.getLength(), senderAddress.get());
+   joinCount++;
+   return true;
+}
+
+size_t CRmdgpReceiver::getReady(SReceivedDatagram *ready, size_t maxReady)
+{
+   const size_t count = reorderBuffer.popReady(ready, maxReady);
+   duplicateFilter.advance(reorderBuffer.getNextSequence());
+   // the rebuilt datagrams of recoverLost are recorded by processDatagram
+   recordHoldTimes(ready, count);
+   return count + recoverLost(ready + count, maxReady - count);
+}
+
+void CRmdgpReceiver::setHoldLatencyRecorder(std::shared_ptr<CLatencyRecorder> recorder)
+{
+   holdLatencyRecorder = recorder;
+   // the datagrams that are held already count from the last arrival
+   arrivalTimes.assign(recorder ? datagramPool.getCount() : 0, latestNow);
+}
+
+void CRmdgpReceiver::recordHoldTimes(const SReceivedDatagram *ready, size_t count)
+{
+   if(!holdLatencyRecorder)
+      return;
+   for(size_t i = 0; i < count; i++)
+   {
+      const CNanoTime &arrival = arrivalTimes[ready[i].handle];
+      holdLatencyRecorder->record(latestNow > arrival ? latestNow - arrival : CNanoTime());
+   }
+}
+
+size_t CRmdgpReceiver::recoverLost(SReceivedDatagram *ready, size_t maxReady)
+{
+   size_t count = 0;
+
+   // a rebuilt datagram may be delivered at once, so it needs room in ready. Otherwise it
+   // waits in the decoder for the next call.
+   while(fecDecoder && fecDecoder->hasRecoverable() && count < maxReady)
+   {
+      const uint32_t handle = datagramPool.acquire();
+      if(handle == CDatagramPool::invalidHandle)
+         break;
+      const size_t length = fecDecoder->recover(datagramPool.getBuffer(handle),
+                                                datagramPool.getBufferSize(), sessionId, streamId);
+      if(length == 0)
+      {
+         datagramPool.release(handle);
+         continue;
+      }
+      count += processDatagram(handle, length, ready + count, maxReady - count, latestNow);
+   }
+   return count;
+}
+
+bool CRmdgpReceiver::sendAck(const CNanoTime &now)
+{
+   if(!sessionKnown)
+      return false;
+
+   // the received ranges are the parts between the holes, the last one ends at the highest
+   // received datagram
+   const CLossTracker::THoles &holes = lossTracker.getHoles();
+   // how long the newest datagram waited for this ACK, the sender takes it out of the RTT
+   const CNanoTime holdTime = highestTime == CNanoTime() ? CNanoTime() : now - highestTime;
+   CAckBuilder ack(feedbackBuffer.data(), feedbackBuffer.size(), sessionId, streamId, receiverId,
+                   lossTracker.getFirstMissing(), holdTime);
+   for(CLossTracker::THoles::const_iterator hole = holes.begin(); hole != holes.end(); ++hole)
+   {
+      const CLossTracker::THoles::const_iterator nextHole = std::next(hole);
+      const uint64_t receivedEnd = (nextHole != holes.end()) ? nextHole->first :
+                                                               lossTracker.getNextExpected();
+      if(!ack.add({ hole->second, receivedEnd }))
+         break;
+   }
+   // the loss of the datagrams that are new since the previous ACK
+   const uint64_t expected = lossTracker.getNextExpected() - reportedExpected;
+   if(CSequenceNumber::isAfter(lossTracker.getNextExpected(), reportedExpected))
+   {
+      ack.setLossRate(double(lostCount - reportedLost) / double(expected));
+      reportedExpected = lossTracker.getNextExpected();
+      reportedLost = lostCount;
+   }
+
+   receiver->sendTo(feedbackBuffer.data(), ack.getLength(), senderAddress.get());
+   ackedSequence = lossTracker.getFirstMissing();
+   packetsSinceAck = 0;
+   ackCount++;
+   return true;
+}
+
+bool CRmdgpReceiver::handleTimer(const CNanoTime &now)
+{
+   if(senderHeard)
+   {
+      senderHeard = false;
+      lastHeard = now;
+   }
+   if(nakGroup && nakScheduler.takeDue(now, nakRanges) > 0)
+      sendNakRanges(nakRanges);
+   if(catchingUp)
+   {
+      if(catchUpProgressed)
+      {
+         catchUpProgressed = false;
+         lastCatchUpProgress = now;
+      }
+      else if(now - lastCatchUpProgress >= joinRetryInterval)
+      {
+         // the sender doesn't answer (anymore), deliver the live datagrams without the rest
+         if(++joinAttempts >= maxJoinAttempts)
+            skipHistory(catchUpEnd);
+         else
+            sendJoin();
+         lastCatchUpProgress = now;
+      }
+   }
+   if(packetsSinceAck == 0 || now - lastTimedAck < ackInterval)
+      return false;
+   lastTimedAck = now;
+   return sendAck(now);
+}
+
+size_t CRmdgpReceiver::sendNaks()
+{
+   const CLossTracker::THoles &holes = lossTracker.getHoles();
+
+   nakRanges.clear();
+   for(CLossTracker::THoles::const_iterator hole = holes.begin(); hole != holes.end(); ++hole)
+      nakRanges.push_back({ hole->first, hole->second });
+   return sendNakRanges(nakRanges);
+}
+
+void CRmdgpReceiver::setNakSuppression(std::shared_ptr<CUdpSocket> nakSocket,
+                    const sockaddr_in &group, const CNanoTime &rtt)
+{
+   this->nakSocket = nakSocket;
+   nakGroup.reset(new sockaddr_in(group));
+   nakScheduler.setRtt(rtt);
+}
+
+bool CRmdgpReceiver::receiveNak()
+{
+   sockaddr_in source;
+
+   if(!nakSocket)
+      return false;
+   // the feedback buffer is only used while sending
+   const size_t length = nakSocket->receiveFrom(feedbackBuffer.data(), feedbackBuffer.size(),
+                                                &source);
+   if(length == 0)
+      return false;
+
+   const uint8_t *datagram = feedbackBuffer.data();
+   if(!sessionKnown ||
+      CRmdgpHeaderView::validate(datagram, length) != ERmdgpValidation::valid ||
+      CRmdgpHeaderView(datagram).getType() != ERmdgpPacketType::nak ||
+      CRmdgpHeaderView(datagram).getStreamId() != streamId ||
+      CRmdgpHeaderView(datagram).getSessionId() != sessionId)
+   {
+      ignoredCount++;
+      return false;
+   }
+   return suppressNaks(datagram, length);
+}
+
+bool CRmdgpReceiver::suppressNaks(const uint8_t *datagram, size_t length)
+{
+   SSequenceRange range;
+   CNakReader nak(datagram, length);
+
+   if(nak.isMalformed() || nak.getReceiverId() == receiverId)
+      return false;
+   while(nak.next(range))
+      nakScheduler.suppress(range);
+   return true;
+}
+
+size_t CRmdgpReceiver::sendNakRanges(const std::vector<SSequenceRange> &ranges)
+{
+   std::vector<SSequenceRange>::const_iterator range = ranges.begin();
+   size_t sent = 0;
+
+   while(range != ranges.end())
+   {
+      CNakBuilder nak(feedbackBuffer.data(), feedbackBuffer.size(), sessionId, streamId,
+                      receiverId);
+
+      while(range != ranges.end() && nak.add(*range))
+         ++range;
+      if(nak.getRangeCount() == 0)
+         break;
+      receiver->sendTo(feedbackBuffer.data(), nak.getLength(), senderAddress.get());
+      if(nakGroup)
+         receiver->sendTo(feedbackBuffer.data(), nak.getLength(), nakGroup.get());
+      sent++;
+   }
+   nakCount += sent;
+   return sent;
+}
@@ -0,0 +1,366 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CRmdgpReceiver.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 20, 2021, 2:40 PM
+ */
+
+#ifndef CRMDGPRECEIVER_H
+#define CRMDGPRECEIVER_H
+
+#include "CDatagramPool.h"
+#include "CDuplicateFilter.h"
+#include "CFecDecoder.h"
+#include "CLossTracker.h"
+#include "CNakScheduler.h"
+#include "CReorderBuffer.h"
+#include "CRmdgpHeader.h"
+#include "../socketLib/CNanoTime.h"
+#include <memory>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+class CLatencyRecorder;
+class CUdpMulticastReceiver;
+class CUdpSocket;
+struct sockaddr_in;
+
+/// \brief The receiving side of an RMDGP stream. It checks the received datagrams, detects
+///        the missing ones and asks the sender for them with NAK datagrams.
+///        Datagrams are received in the buffers of a CDatagramPool and delivered in sequence
+///        order without copying: out of order datagrams wait in a CReorderBuffer, datagrams that
+///        arrive in order go straight to the application. The application gets handles and must
+///        release every delivered datagram when it is done with it.
+///        The session id is taken from the first valid datagram, datagrams of other sessions
+///        are ignored.
+///        The receiver acknowledges what it has with ACK datagrams (see CAckBuilder) after every
+///        ackPacketThreshold received datagrams, or from handleTimer when ackInterval passed,
+///        whichever comes first. So the feedback of a receiver is bounded, also with a thousand
+///        receivers behind one sender.
+///        An idle sender sends heartbeats with its next sequence number. What the receiver
+///        doesn't have before it is missing (a tail loss) and is asked for with the next NAKs.
+///        Every datagram of the sender, data or heartbeat, shows it is alive, see isSenderAlive.
+///        The first heartbeat of an idle period, and every one that is ahead of the last ACK, is
+///        answered with an ACK, so a lost ACK doesn't leave the receiver behind for the sender.
+///        With setNakSuppression the missing ranges are asked for from handleTimer after a
+///        random delay (see CNakScheduler) and the NAKs are multicast, so the NAKs of other
+///        receivers postpone the own ones and a thousand receivers don't all ask at once. The
+///        NAKs of the others come from other sources than the sender, so they are received on
+///        a socket of their own, see receiveNak.
+///        With enableFec the datagrams that are lost in a FEC block are rebuilt from the
+///        parity datagrams of the sender (see CFecDecoder) and delivered like repairs.
+///        With setCatchUp a receiver that joins a running stream also gets the history before
+///        the first datagram it sees: it sends a join to the sender (see CJoinBuilder), which
+///        replays that part over unicast. The live datagrams wait in the reorder buffer until the
+///        replay reaches them, so the application gets one stream in sequence order without a
+///        gap at the switch. ACKs and NAKs cover the live datagrams only, so the replay doesn't
+///        hold the window of the sender.
+///        With setResume a restarted receiver asks only for what it didn't deliver before the
+///        restart, for instance the next sequence of a CDeliveryLog; the application replays
+///        the rest from its own log. That only holds in the session of the log: when the sender
+///        restarted in a new session, the receiver catches up as if it had no log, and the
+///        application starts a new one (see getSessionId and CDeliveryLog::setSession).
+///        With setHoldLatencyRecorder the time that every delivered datagram was held, from its
+///        arrival until it was handed to the application, is recorded. The reorder buffer and
+///        the FEC decoder are what hold datagrams back.
+class CRmdgpReceiver {
+public:
+    /// \param receiver an opened multicast receiver
+    /// \param senderAddress the unicast address of the sender, where the NAKs go
+    /// \param streamId the stream to receive
+    /// \param maxDatagrams the number of receive buffers, at least 2. This caps the memory of
+    ///        the receiver: the datagrams that wait for a gap to close and the delivered
+    ///        datagrams that are not released yet all use a buffer. An eighth of them (at least
+    ///        one) is never held for a gap, so the repair that closes it can be received.
+    /// \param maxDatagramSize the size of a receive buffer
+    /// \throws std::runtime_error when the buffers can't be made or maxDatagrams is too small
+    CRmdgpReceiver(std::shared_ptr<CUdpMulticastReceiver> receiver, const sockaddr_in &senderAddress,
+                   uint32_t streamId, size_t maxDatagrams = defaultMaxDatagrams,
+                   size_t maxDatagramSize = defaultMaxDatagramSize);
+    CRmdgpReceiver(const CRmdgpReceiver& orig) = delete;
+    virtual ~CRmdgpReceiver();
+
+    /// \brief receives one datagram from the socket, in a free buffer
+    /// \param ready receives the datagrams that can be delivered now, in sequence order
+    /// \param maxReady the size of ready, at least 1. When more datagrams are ready, getReady
+    ///        returns the rest.
+    /// \return the number of datagrams in ready. 0 when there was nothing to receive (non
+    ///         blocking mode), no free buffer, or the datagram wasn't deliverable yet.
+    /// \param now the current CLOCK_MONOTONIC time, for instance CFdWaiter::now(). It tells
+    ///        the sender how long an ACK was held back.
+    /// \throws std::runtime_error when OS reports an error.
+    size_t receive(SReceivedDatagram *ready, size_t maxReady, const CNanoTime &now);
+
+    /// \brief handles a received datagram, see receive. The receiver takes over the buffer.
+    /// \param handle a buffer of getDatagramPool() that holds the datagram
+    /// \param length the datagram length
+    size_t processDatagram(uint32_t handle, size_t length, SReceivedDatagram *ready,
+                    size_t maxReady, const CNanoTime &now);
+
+    /// \brief returns datagrams that became deliverable but didn't fit in ready before
+    size_t getReady(SReceivedDatagram *ready, size_t maxReady);
+
+    /// \brief returns the payload of a delivered datagram
+    const uint8_t* getPayload(const SReceivedDatagram &datagram) const
+        { return datagramPool.getBuffer(datagram.handle) + CRmdgpHeader::size; }
+    /// \brief returns the payload length of a delivered datagram
+    static size_t getPayloadLength(const SReceivedDatagram &datagram)
+        { return datagram.length - CRmdgpHeader::size; }
+    /// \brief gives the buffer of a delivered datagram back
+    void release(const SReceivedDatagram &datagram) { datagramPool.release(datagram.handle); }
+
+    /// \brief sends an ACK datagram to the sender, with the cumulative acknowledgement and as
+    ///        many received ranges above it as fit
+    /// \param now the current CLOCK_MONOTONIC time, the same clock as of receive
+    /// \return false when no datagram is received yet, so there is nothing to acknowledge
+    /// \throws std::runtime_error when OS reports an error.
+    bool sendAck(const CNanoTime &now);
+
+    /// \brief call this regularly, at least every ackInterval. Sends an ACK when datagrams were
+    ///        received since the last one and ackInterval passed since the last timed ACK.
+    ///        When the sender was heard since the previous call, now is the last time it was
+    ///        heard.
+    /// \param now the current CLOCK_MONOTONIC time, see CFdWaiter::now()
+    /// \return true when an ACK was sent
+    /// \throws std::runtime_error when OS reports an error.
+    bool handleTimer(const CNanoTime &now);
+
+    /// \brief sets when ACKs are sent: after packetThreshold received datagrams, or interval
+    ///        after the last timed ACK, whichever comes first
+    void setAckPolicy(uint32_t packetThreshold, const CNanoTime &interval)
+        { ackPacketThreshold = packetThreshold; ackInterval = interval; }
+    /// \brief sets the id that identifies this receiver in its ACKs. By default it is random.
+    void setReceiverId(uint32_t id) { receiverId = id; }
+    uint32_t getReceiverId() const { return receiverId; }
+    /// \brief returns the number of ACK datagrams sent
+    uint64_t getAckCount() const { return ackCount; }
+
+    /// \brief returns true when the sender was heard within the sender timeout, see
+    ///        handleTimer for the time it was heard
+    /// \param now the current CLOCK_MONOTONIC time
+    bool isSenderAlive(const CNanoTime &now) const
+        { return sessionKnown && (senderHeard || now - lastHeard < senderTimeout); }
+    /// \brief sets how long the sender may be silent before it is considered gone. Take it
+    ///        larger than the longest heartbeat interval of the sender.
+    void setSenderTimeout(const CNanoTime &timeout) { senderTimeout = timeout; }
+    /// \brief returns the number of received heartbeats
+    uint64_t getHeartbeatCount() const { return heartbeatCount; }
+    /// \brief returns the number of missing datagrams that were found by heartbeats
+    uint64_t getTailLossCount() const { return tailLossCount; }
+    /// \brief returns the number of datagrams that were missing when their gap was found,
+    ///        before NAKs and FEC. Every ACK reports the part of the datagrams since the
+    ///        previous ACK, see CAckBuilder::setLossRate.
+    uint64_t getLostCount() const { return lostCount; }
+
+    /// \brief sends NAK datagrams to the sender with all missing ranges, as many ranges per
+    ///        datagram as fit
+    /// \return the number of NAK datagrams sent
+    /// \throws std::runtime_error when OS reports an error.
+    size_t sendNaks();
+
+    /// \brief from now on handleTimer asks for the missing ranges when their delay expired. The
+    ///        NAKs go to the sender and to group, where the other receivers listen.
+    ///        A NAK of an other receiver that is received with receiveNak postpones the own NAK
+    ///        for the same ranges, the repair cancels it.
+    /// \param nakSocket an opened socket that receives the NAKs sent to group from every
+    ///        source, for instance a CUdpMulticastReceiver opened with the any source address.
+    ///        The receiver of the stream can't be used, it only takes datagrams of the sender.
+    ///        Put it in non blocking mode when it is polled.
+    /// \param group where the other receivers listen, a multicast group of its own
+    /// \param rtt the round trip time to the sender, it scales the delays
+    void setNakSuppression(std::shared_ptr<CUdpSocket> nakSocket, const sockaddr_in &group,
+                    const CNanoTime &rtt);
+    /// \brief receives one datagram from the NAK socket of setNakSuppression. Call it when the
+    ///        socket is readable. The own NAKs come back from the group as well, they are
+    ///        ignored by their receiver id.
+    /// \return true when it was a NAK of an other receiver of the session
+    /// \throws std::runtime_error when OS reports an error.
+    bool receiveNak();
+    /// \brief returns the scheduler of the NAKs, with its settings and counters
+    CNakScheduler& getNakScheduler() { return nakScheduler; }
+    /// \brief returns the number of NAK datagrams sent
+    uint64_t getNakCount() const { return nakCount; }
+
+    /// \brief from now on parity datagrams are used to rebuild lost datagrams. Without it they
+    ///        are ignored.
+    /// \param maxBlocks the number of FEC blocks that are tracked at the same time, each takes
+    ///        a receive buffer of memory per parity row
+    /// \param parityRows the parity rows of the sender: the ones per block plus the ones it
+    ///        answers NAKs with, see CRmdgpSender::setFecRepair. Every row costs a multiply of
+    ///        every received datagram.
+    /// \throws std::runtime_error when maxBlocks is 0 or parityRows is out of range
+    void enableFec(size_t maxBlocks = CFecDecoder::defaultMaxBlocks, size_t parityRows = 1)
+        { fecDecoder.reset(new CFecDecoder(datagramPool.getBufferSize() - CRmdgpHeader::size,
+                                           maxBlocks, parityRows)); }
+    /// \brief returns the FEC decoder with its counters, nullptr without FEC
+    const CFecDecoder* getFecDecoder() const { return fecDecoder.get(); }
+
+    /// \brief from now on the first datagram of the session starts a catch-up of the history
+    ///        datagrams before it. The replay is taken in order only: a replayed datagram that
+    ///        is not the next one is dropped, and when the replay makes no progress for
+    ///        retryInterval the join is sent again from the next one. After maxJoinAttempts
+    ///        joins without progress the receiver gives up on the rest of the history.
+    ///        While catching up a quarter of the receive buffers is kept for the replay: a live
+    ///        datagram that would take one of them is dropped, and asked for again later.
+    ///        The sender needs CRmdgpSender::setCatchUp.
+    /// \param history the number of datagrams before the first one that are asked for, at
+    ///        most half the window of the reorder buffer
+    /// \param retryInterval the time without progress before the join is sent again
+    /// \throws std::runtime_error when history is 0 or too large, or the session is already
+    ///         known
+    void setCatchUp(size_t history, const CNanoTime &retryInterval = defaultJoinRetryInterval);
+    /// \brief lets a restarted receiver continue where it stopped. The history of setCatchUp
+    ///        is asked for from next only, and the datagrams before next are dropped as
+    ///        duplicates. When next is further back than the history, only the history is asked
+    ///        for and the delivered stream has a gap. In an other session than sessionId next
+    ///        means nothing, the receiver catches up as without setResume.
+    /// \param next the sequence number after the last datagram that was delivered before the
+    ///        restart
+    /// \param sessionId the session of the datagrams that were delivered before the restart
+    /// \param streamId their stream
+    /// \throws std::runtime_error without setCatchUp, when the session is already known or
+    ///         streamId is not the stream of the receiver
+    void setResume(uint64_t next, uint32_t sessionId, uint32_t streamId);
+    /// \brief sends a join to the sender for the rest of the history
+    /// \return false when the receiver is not catching up
+    /// \throws std::runtime_error when OS reports an error.
+    bool sendJoin();
+    /// \brief returns true while the history is replayed. When the catch-up ends in handleTimer
+    ///        the held live datagrams become deliverable, call getReady.
+    bool isCatchingUp() const { return catchingUp; }
+    /// \brief returns the part of the history that is not received yet, the end is the first
+    ///        live datagram
+    SSequenceRange getCatchUpRange() const { return { catchUpNext, catchUpEnd }; }
+    /// \brief returns the number of delivered replayed datagrams
+    uint64_t getCatchUpCount() const { return catchUpCount; }
+    /// \brief returns the number of joins sent
+    uint64_t getJoinCount() const { return joinCount; }
+
+    /// \brief returns true when the session is known, from the first datagram
+    bool isSessionKnown() const { return sessionKnown; }
+    /// \brief returns the session, see isSessionKnown
+    uint32_t getSessionId() const { return sessionId; }
+    /// \brief returns true when the receiver continues where it stopped, see setResume
+    bool isResumed() const { return resuming && sessionKnown && sessionId == resumeSessionId; }
+
+    const CLossTracker& getLossTracker() const { return lossTracker; }
+    const CReorderBuffer& getReorderBuffer() const { return reorderBuffer; }
+    /// \brief returns the duplicate filter, with the counters of duplicate datagrams
+    const CDuplicateFilter& getDuplicateFilter() const { return duplicateFilter; }
+    CDatagramPool& getDatagramPool() { return datagramPool; }
+    /// \brief records the hold time of every delivered datagram in recorder, nullptr stops it.
+    ///        Datagrams that getReady returns are held until the now of the last received
+    ///        datagram.
+    void setHoldLatencyRecorder(std::shared_ptr<CLatencyRecorder> recorder);
+    /// \brief returns the number of received datagrams that failed validation or belong to an
+    ///        other session or stream
+    uint64_t getIgnoredCount() const { return ignoredCount; }
+    /// \brief returns the number of received datagrams that were dropped because they were
+    ///        duplicates or didn't fit in the reorder buffer. See getDuplicateFilter() for the
+    ///        duplicates alone.
+    uint64_t getDroppedCount() const { return droppedCount; }
+
+    /// \brief the largest NAK or ACK datagram, an Ethernet MTU minus the IPv4 and UDP headers
+    static constexpr size_t maxFeedbackLength = 1500 - 20 - 8;
+    static constexpr size_t defaultMaxDatagrams = 4096;
+    static constexpr size_t defaultMaxDatagramSize = 1500 - 20 - 8;
+    static constexpr uint32_t defaultAckPacketThreshold = 64;
+    static constexpr CNanoTime defaultAckInterval = CNanoTime::fromMsec(10);
+    static constexpr CNanoTime defaultSenderTimeout = CNanoTime::fromSec(3);
+    static constexpr CNanoTime defaultJoinRetryInterval = CNanoTime::fromMsec(50);
+    static constexpr uint32_t maxJoinAttempts = 5;
+
+private:
+    std::shared_ptr<CUdpMulticastReceiver> receiver;
+    std::unique_ptr<sockaddr_in> senderAddress;
+    const uint32_t streamId;
+    uint32_t sessionId;
+    bool sessionKnown;
+    CLossTracker lossTracker;
+    CDatagramPool datagramPool;
+    CReorderBuffer reorderBuffer;
+    CDuplicateFilter duplicateFilter;
+    uint64_t ignoredCount;
+    uint64_t droppedCount;
+    uint32_t receiverId;
+    uint32_t ackPacketThreshold;
+    CNanoTime ackInterval;
+    uint32_t packetsSinceAck;
+    CNanoTime lastTimedAck;
+    uint64_t ackCount;
+    bool senderHeard;               ///< since the last handleTimer
+    CNanoTime lastHeard;
+    CNanoTime senderTimeout;
+    uint64_t heartbeatCount;
+    uint64_t heartbeatSequence;     ///< of the last heartbeat
+    uint64_t ackedSequence;         ///< the cumulative acknowledgement of the last ACK
+    CNanoTime highestTime;          ///< when the newest datagram arrived, for the ACK hold time
+    CNanoTime latestNow;            ///< of the last processDatagram, for the rebuilt datagrams
+    uint64_t tailLossCount;
+    uint64_t lostCount;
+    uint64_t reportedExpected;      ///< the next expected sequence number at the last report
+    uint64_t reportedLost;          ///< lostCount at the last report
+    std::vector<uint8_t> feedbackBuffer;
+    std::unique_ptr<sockaddr_in> nakGroup;
+    std::shared_ptr<CUdpSocket> nakSocket;
+    CNakScheduler nakScheduler;
+    std::vector<SSequenceRange> nakRanges;
+    uint64_t nakCount;
+    std::unique_ptr<CFecDecoder> fecDecoder;
+    size_t catchUpHistory;          ///< 0 without catch-up
+    CNanoTime joinRetryInterval;
+    bool catchingUp;
+    uint64_t catchUpNext;
+    uint64_t catchUpEnd;
+    bool catchUpProgressed;         ///< since the last handleTimer
+    CNanoTime lastCatchUpProgress;
+    uint32_t joinAttempts;          ///< without progress
+    uint64_t catchUpCount;
+    uint64_t joinCount;
+    bool resuming;
+    uint64_t resumeSequence;        ///< the first sequence that wasn't delivered before
+    uint32_t resumeSessionId;       ///< the session of resumeSequence
+    std::shared_ptr<CLatencyRecorder> holdLatencyRecorder;
+    std::vector<CNanoTime> arrivalTimes; ///< by handle, only with a hold latency recorder
+
+    /// \brief rebuilds the datagrams that the FEC decoder can recover and handles them like
+    ///        received ones, as far as they fit in ready
+    size_t recoverLost(SReceivedDatagram *ready, size_t maxReady);
+    /// \brief delivers a replayed datagram when it is the next one of the history
+    size_t processCatchUp(uint32_t handle, size_t length, SReceivedDatagram *ready,
+                    size_t maxReady);
+    /// \brief skips the part of the history that the sender doesn't have anymore
+    size_t processJoinAccept(uint32_t handle, size_t length, SReceivedDatagram *ready,
+                    size_t maxReady);
+    /// \brief records the hold time of count delivered datagrams
+    void recordHoldTimes(const SReceivedDatagram *ready, size_t count);
+    /// \brief gives up on the history before newNext, the catch-up is done at catchUpEnd
+    void skipHistory(uint64_t newNext);
+    /// \brief postpones the own NAKs for the ranges of the NAK of an other receiver
+    /// \return true when the NAK is not an own one
+    bool suppressNaks(const uint8_t *datagram, size_t length);
+    /// \brief sends NAK datagrams with ranges, to the sender and the NAK group
+    size_t sendNakRanges(const std::vector<SSequenceRange> &ranges);
+};
+
+#endif /* CRMDGPRECEIVER_H */
@@ -0,0 +1,1031 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CRmdgpSender.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 16, 2021, 9:15 PM
+ */
+
+#include "CRmdgpSender.h"
+#include "CAckPacket.h"
+#include "CFragmentHeader.h"
+#include "CJoinPacket.h"
+#include "CNakPacket.h"
+#include "../socketLib/CPacer.h"
+#include "../socketLib/CUdpMulticastSender.h"
+#include <algorithm>
+#include <math.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+
+struct CRmdgpSender::SFeedbackBatch {
+   SFeedbackBatch() : buffers(feedbackBatchSize * maxFeedbackLength)
+   {
+      for(unsigned int i = 0; i < feedbackBatchSize; i++)
+      {
+         vectors[i] = { &buffers[i * maxFeedbackLength], maxFeedbackLength };
+         messages[i] = mmsghdr();
+         messages[i].msg_hdr.msg_iov = &vectors[i];
+         messages[i].msg_hdr.msg_iovlen = 1;
+      }
+   }
+   const uint8_t* getBuffer(unsigned int i) const { return &buffers[i * maxFeedbackLength]; }
+
+   /// \brief the kernel overwrites the address lengths, set them before every receive
+   void prepare()
+   {
+      for(unsigned int i = 0; i < feedbackBatchSize; i++)
+      {
+         messages[i].msg_hdr.msg_name = &sources[i];
+         messages[i].msg_hdr.msg_namelen = sizeof(sources[i]);
+      }
+   }
+
+   std::vector<uint8_t> buffers;
+   iovec vectors[feedbackBatchSize];
+   sockaddr_in sources[feedbackBatchSize];
+   mmsghdr messages[feedbackBatchSize];
+};
+
+struct CRmdgpSender::SRepairBatch {
+   SRepairBatch() : count(0) {}
+
+   /// \brief adds datagram for destination, destination must stay valid until it is sent
+   void add(uint8_t *datagram, size_t length, const sockaddr_in &destination)
+   {
+      vectors[count] = { datagram, length };
+      messages[count] = mmsghdr();
+      messages[count].msg_hdr.msg_iov = &vectors[count];
+      messages[count].msg_hdr.msg_iovlen = 1;
+      messages[count].msg_hdr.msg_name = const_cast<sockaddr_in*>(&destination);
+      messages[count].msg_hdr.msg_namelen = sizeof(destination);
+      count++;
+   }
+
+   unsigned int count;
+   iovec vectors[repairBatchSize];
+   mmsghdr messages[repairBatchSize];
+};
+
+struct CRmdgpSender::SJoiner {
+   SJoiner(std::shared_ptr<CUdpMulticastSender> sender, uint32_t receiverId,
+           const sockaddr_in &address, double rate, size_t burst, size_t maxDatagramSize) :
+           receiverId(receiverId), address(address), next(0), end(0), flag(rmdgpFlagCatchUp),
+           pacer(sender, address, rate, burst, catchUpQueueSize, maxDatagramSize) {}
+
+   const uint32_t receiverId;
+   sockaddr_in address;
+   /// \brief the part of the history that is not queued yet
+   uint64_t next;
+   uint64_t end;
+   /// \brief set in the replayed datagrams: rmdgpFlagCatchUp, or rmdgpFlagRetransmission for
+   ///        the replay of a NAK
+   uint16_t flag;
+   CPacer pacer;
+};
+
+CRmdgpSender::CRmdgpSender(std::shared_ptr<CUdpMulticastSender> sender, uint32_t sessionId,
+               uint32_t streamId, size_t maxMessages, size_t maxBytes, size_t maxPayloadSize,
+               uint64_t firstSequence, size_t maxReceivers) : sender(sender),
+               ring(maxMessages, maxBytes, CRmdgpHeader::size + maxPayloadSize, firstSequence),
+               sessionId(sessionId), streamId(streamId), feedback(new SFeedbackBatch),
+               receivers(maxReceivers), ackCount(0), ejectionPolicy(), listener(),
+               congestionController(), rttProbes(rttProbeCount, { 0, CNanoTime() }),
+               rttProbeIndex(0), latestNow(), pacer(), pacerLatencyRecorder(),
+               ejectedIds(), ejectIndexes(), rejoinDelay(defaultRejoinDelay),
+               sentSinceTimer(true), minHeartbeatInterval(defaultMinHeartbeatInterval),
+               maxHeartbeatInterval(defaultMaxHeartbeatInterval),
+               heartbeatInterval(defaultMinHeartbeatInterval), nextHeartbeat(), heartbeatCount(0),
+               repairScheduler(), repairBatch(new SRepairBatch), multicastRepairs(),
+               unicastRepairs(), fecEncoder(), repairEncoder(), fecController(), fecRepairRows(0),
+               fecRepairNextRow(), maxPayloadSize(maxPayloadSize), batch(), coalescingDeadline(),
+               flushTime(), messageCount(0), batchCount(0), fragmentedCount(0), catchUpRate(0),
+               catchUpBurst(0), maxJoiners(0), joiners(), joinCount(0), replayedCount(0),
+               journal(), journalCopy(), journalRepairCount(0), journalReplayCount(0),
+               maxRepairsPerNak(defaultMaxRepairsPerNak),
+               maxRepairsPerTimer(defaultMaxRepairsPerTimer),
+               repairBudget(defaultMaxRepairsPerTimer)
+{
+   if(maxPayloadSize > CRmdgpHeader::maxPayloadLength)
+   {
+      std::ostringstream message;
+      message << "Error max payload size " << maxPayloadSize << " is larger than "
+              << CRmdgpHeader::maxPayloadLength;
+      throw std::runtime_error(message.str());
+   }
+}
+
+CRmdgpSender::~CRmdgpSender()
+{
+}
+
+bool CRmdgpSender::send(const void *payload, size_t length)
+{
+   return send(nullptr, 0, payload, length);
+}
+
+bool CRmdgpSender::send(const uint8_t *prefix, size_t prefixLength, const void *payload,
+                    size_t length)
+{
+   const uint64_t sequence = ring.getNextSequence();
+   const size_t payloadLength = prefixLength + length;
+   const size_t datagramLength = CRmdgpHeader::size + payloadLength;
+   if(!hasPacerRoom(1))
+      return false;
+   uint8_t *datagram = ring.store(datagramLength);
+
+   if(datagram == nullptr)
+      return false;
+
+   CRmdgpHeaderBuilder builder(datagram);
+   builder.setType(ERmdgpPacketType::data).setPayloadLength(uint16_t(payloadLength))
+          .setSessionId(sessionId).setStreamId(streamId).setSequence(sequence);
+   if(fecEncoder)
+      builder.setFlags(rmdgpFlagFec).setFecPosition(fecEncoder->getBlockSize(),
+                                                    fecEncoder->getIndex());
+   if(prefixLength > 0)
+      memcpy(datagram + CRmdgpHeader::size, prefix, prefixLength);
+   memcpy(datagram + CRmdgpHeader::size + prefixLength, payload, length);
+
+   transmit(datagram, datagramLength);
+   if(journal)
+      journal->append(sequence, datagram, datagramLength);
+   sentSinceTimer = true;
+   // one probe per send time is enough, the first datagram sent at it gives the best sample
+   if(congestionController && rttProbes[rttProbeIndex].time != latestNow)
+   {
+      rttProbeIndex = (rttProbeIndex + 1) % rttProbeCount;
+      rttProbes[rttProbeIndex] = { sequence, latestNow };
+   }
+
+   // the parity work comes after the datagram is on its way
+   if(fecEncoder)
+   {
+      fecEncoder->add(sequence, datagram + CRmdgpHeader::size, payloadLength);
+      if(fecEncoder->isComplete())
+         sendParity();
+   }
+   return true;
+}
+
+bool CRmdgpSender::sendFragmented(const void *message, size_t length)
+{
+   const size_t fragmentSize = maxPayloadSize - CFragmentHeader::size;
+   const size_t count = (length == 0) ? 1 : (length + fragmentSize - 1) / fragmentSize;
+
+   // all fragments or none, half a message is of no use to the receivers
+   if(length > CFragmentHeader::maxMessageLength ||
+      ring.getMaxMessages() - ring.getCount() < count ||
+      ring.getMaxBytes() - ring.getBytes() < length +
+                                       count * (CRmdgpHeader::size + CFragmentHeader::size) ||
+      !hasPacerRoom(count))
+      return false;
+
+   const uint8_t *fragment = static_cast<const uint8_t*>(message);
+   uint8_t header[CFragmentHeader::size];
+   for(size_t index = 0; index < count; index++)
+   {
+      const size_t offset = index * fragmentSize;
+      const size_t fragmentLength = std::min(fragmentSize, length - offset);
+      CFragmentHeader::store(header, uint32_t(length), uint32_t(offset), uint32_t(index),
+                             uint32_t(count));
+      send(header, sizeof(header), fragment + offset, fragmentLength);
+   }
+   fragmentedCount++;
+   return true;
+}
+
+void CRmdgpSender::setCoalescing(const CNanoTime &deadline, size_t maxBatchSize)
+{
+   if(deadline < CNanoTime() || maxBatchSize > maxPayloadSize)
+   {
+      std::ostringstream message;
+      message << "Error coalescing deadline " << deadline << " or max batch size " << maxBatchSize
+              << " larger than " << maxPayloadSize;
+      throw std::runtime_error(message.str());
+   }
+   if(!flush())
+      throw std::runtime_error("Error the pending messages can't be sent");
+   batch.reset(new CMessageBatchBuilder(maxBatchSize ? maxBatchSize : maxPayloadSize));
+   coalescingDeadline = deadline;
+}
+
+bool CRmdgpSender::sendMessage(const void *message, size_t length, const CNanoTime &now)
+{
+   if(!batch)
+      throw std::runtime_error("Error sendMessage without setCoalescing");
+   latestNow = std::max(latestNow, now);
+
+   if(!batch->fits(length))
+   {
+      if(batch->isEmpty() || !flush() || !batch->fits(length))
+         return false;
+   }
+   if(batch->isEmpty())
+      flushTime = now + coalescingDeadline;
+   batch->add(message, length);
+   messageCount++;
+
+   // when not even the smallest message fits anymore there is no reason to wait
+   if(!batch->fits(1) || now >= flushTime)
+      flush();
+   return true;
+}
+
+bool CRmdgpSender::flush()
+{
+   if(!batch || batch->isEmpty())
+      return true;
+   if(!send(batch->getData(), batch->getLength()))
+      return false;
+   batch->clear();
+   batchCount++;
+   return true;
+}
+
+void CRmdgpSender::setFecBlockSize(size_t blockSize, size_t parityRows)
+{
+   if(blockSize == 0)
+   {
+      if(fecEncoder && fecEncoder->isStarted())
+         sendParity();
+      fecEncoder.reset();
+   }
+   else if(parityRows + fecRepairRows > CFecEncoder::maxParityRows)
+   {
+      std::ostringstream message;
+      message << "Error " << parityRows << " FEC parity rows and " << fecRepairRows
+              << " repair rows pass " << CFecEncoder::maxParityRows << " rows";
+      throw std::runtime_error(message.str());
+   }
+   else if(fecEncoder)
+   {
+      fecEncoder->setBlockSize(blockSize);
+      fecEncoder->setParityRows(parityRows);
+   }
+   else
+      fecEncoder.reset(new CFecEncoder(blockSize, maxPayloadSize, parityRows));
+}
+
+void CRmdgpSender::setFecRepair(size_t repairRows)
+{
+   // the controller may raise the parity rows up to its maximum later
+   const size_t parityRows = std::max<size_t>(fecEncoder ? fecEncoder->getParityRows() : 1,
+                                     fecController ? fecController->getMaxParityRows() : 1);
+
+   if(parityRows + repairRows > CFecEncoder::maxParityRows)
+   {
+      std::ostringstream message;
+      message << "Error " << parityRows << " FEC parity rows and " << repairRows
+              << " repair rows pass " << CFecEncoder::maxParityRows << " rows";
+      throw std::runtime_error(message.str());
+   }
+   fecRepairRows = repairRows;
+   if(repairRows > 0 && !repairEncoder)
+      repairEncoder.reset(new CFecEncoder(1, maxPayloadSize));
+}
+
+void CRmdgpSender::setFecController(double targetResidualLoss, size_t maxParityRows,
+                    double maxOverhead)
+{
+   // handleTimer must never choose more rows than the encoder has room for
+   if(maxParityRows + fecRepairRows > CFecEncoder::maxParityRows)
+   {
+      std::ostringstream message;
+      message << "Error " << maxParityRows << " FEC controller parity rows and " << fecRepairRows
+              << " repair rows pass " << CFecEncoder::maxParityRows << " rows";
+      throw std::runtime_error(message.str());
+   }
+   fecController.reset(new CFecController(targetResidualLoss, maxParityRows, maxOverhead));
+}
+
+void CRmdgpSender::sendParity()
+{
+   const size_t count = fecEncoder->finish(sessionId, streamId);
+
+   for(size_t i = 0; i < count; i++)
+   {
+      size_t length;
+      const uint8_t *datagram = fecEncoder->getParity(i, length);
+      transmit(datagram, length);
+   }
+}
+
+bool CRmdgpSender::resend(uint64_t sequence)
+{
+   size_t length;
+   uint8_t *datagram = ring.lookup(sequence, length);
+
+   if(datagram != nullptr)
+      CRmdgpHeader::store16(datagram + CRmdgpHeader::flagsOffset,
+                      CRmdgpHeaderView(datagram).getFlags() | rmdgpFlagRetransmission);
+   else
+   {
+      datagram = copyFromJournal(sequence, length);
+      if(datagram == nullptr)
+         return false;
+   }
+   transmit(datagram, length);
+   return true;
+}
+
+bool CRmdgpSender::resendRepair(uint64_t sequence)
+{
+   // the repairs over the budget are dropped, the receivers ask again
+   if(repairBudget == 0)
+      return false;
+   repairBudget--;
+   return resend(sequence);
+}
+
+uint8_t* CRmdgpSender::copyFromJournal(uint64_t sequence, size_t &length)
+{
+   const uint8_t *datagram = journal ? journal->lookup(sequence, length) : nullptr;
+
+   // the datagrams of a previous run can be longer than what fits now
+   if(datagram == nullptr || length > journalCopy.size())
+      return nullptr;
+   memcpy(journalCopy.data(), datagram, length);
+   CRmdgpHeader::store16(journalCopy.data() + CRmdgpHeader::flagsOffset,
+                   CRmdgpHeaderView(journalCopy.data()).getFlags() | rmdgpFlagRetransmission);
+   journalRepairCount++;
+   return journalCopy.data();
+}
+
+size_t CRmdgpSender::processNak(const uint8_t *datagram, size_t length)
+{
+   SSequenceRange journalRange;
+   uint32_t receiverId;
+
+   return forEachRequested(datagram, length, [this](uint64_t sequence)
+                           { return size_t(resendRepair(sequence)); },
+                           journalRange, receiverId);
+}
+
+size_t CRmdgpSender::processNak(const uint8_t *datagram, size_t length,
+                    const sockaddr_in &requester, const CNanoTime &now)
+{
+   SSequenceRange journalRange;
+   uint32_t receiverId;
+   size_t result;
+
+   if(!repairScheduler)
+      result = forEachRequested(datagram, length, [this](uint64_t sequence)
+                           { return size_t(resendRepair(sequence)); },
+                           journalRange, receiverId);
+   else
+      result = forEachRequested(datagram, length, [&](uint64_t sequence)
+                           { return size_t(repairScheduler->request(sequence, requester, now)); },
+                           journalRange, receiverId);
+
+   // the deep history goes to the requester alone at the catch-up rate, a replay that it asks
+   // for again restarts
+   if(journalRange.size() > 0 && maxJoiners > 0)
+   {
+      std::vector<std::unique_ptr<SJoiner>>::iterator joiner = std::find_if(joiners.begin(),
+                      joiners.end(), [&](const std::unique_ptr<SJoiner> &j)
+                      { return j->receiverId == receiverId; });
+      if((joiner == joiners.end() || (*joiner)->flag == rmdgpFlagRetransmission) &&
+         startReplay(receiverId, requester, journalRange, rmdgpFlagRetransmission) !=
+         joiners.end())
+         journalReplayCount++;
+   }
+   return result;
+}
+
+void CRmdgpSender::setRepairLimits(size_t maxPerNak, size_t maxPerTimer)
+{
+   if(maxPerNak == 0 || maxPerTimer == 0)
+   {
+      std::ostringstream message;
+      message << "Error repair limits " << maxPerNak << " per NAK and " << maxPerTimer
+              << " per timer, they must be positive";
+      throw std::runtime_error(message.str());
+   }
+   maxRepairsPerNak = maxPerNak;
+   maxRepairsPerTimer = maxPerTimer;
+   repairBudget = std::min(repairBudget, maxPerTimer);
+}
+
+template<class TFunction>
+size_t CRmdgpSender::forEachRequested(const uint8_t *datagram, size_t length, TFunction function,
+                    SSequenceRange &journalRange, uint32_t &receiverId)
+{
+   size_t result = 0;
+   size_t requested = 0;
+   SSequenceRange range;
+
+   journalRange = { 0, 0 };
+   receiverId = 0;
+   if(CRmdgpHeaderView::validate(datagram, length) != ERmdgpValidation::valid)
+      return 0;
+   const CRmdgpHeaderView header(datagram);
+   if(header.getType() != ERmdgpPacketType::nak || header.getSessionId() != sessionId ||
+      header.getStreamId() != streamId)
+      return 0;
+
+   CNakReader nak(datagram, length);
+   receiverId = nak.getReceiverId();
+   // an ejected receiver gets no repairs, they would spend the budget of the others
+   if(isEjected(receiverId))
+      return 0;
+   while(requested < maxRepairsPerNak && nak.next(range))
+   {
+      // only the part that is still in the ring, so a bogus range can't make us loop long
+      const uint64_t oldest = ring.getOldestSequence();
+      if(CSequenceNumber::isBefore(range.begin, oldest))
+      {
+         if(journalRange.size() == 0 && journal && !journal->isEmpty())
+         {
+            const uint64_t journalOldest = journal->getOldestSequence();
+            journalRange.begin = CSequenceNumber::isBefore(range.begin, journalOldest) ?
+                                 journalOldest : range.begin;
+            journalRange.end = CSequenceNumber::isBefore(range.end, oldest) ? range.end : oldest;
+            if(!CSequenceNumber::isBefore(journalRange.begin, journalRange.end))
+               journalRange = { 0, 0 };
+         }
+         range.begin = oldest;
+      }
+      if(CSequenceNumber::isAfter(range.end, ring.getNextSequence()))
+         range.end = ring.getNextSequence();
+      for(uint64_t sequence = range.begin; CSequenceNumber::isBefore(sequence, range.end) &&
+          requested < maxRepairsPerNak; sequence++, requested++)
+         result += function(sequence);
+   }
+   return result;
+}
+
+size_t CRmdgpSender::sendRepairs(const CNanoTime &now)
+{
+   size_t sent = 0;
+
+   if(!repairScheduler || repairScheduler->takeDue(now, multicastRepairs, unicastRepairs) == 0)
+      return 0;
+
+   if(fecRepairRows > 0 && fecEncoder)
+      sent += sendParityRepairs();
+   for(uint64_t sequence : multicastRepairs)
+      sent += resendRepair(sequence);
+
+   // a repair that doesn't fit in the socket buffer is lost, the receiver asks again
+   repairBatch->count = 0;
+   for(const SUnicastRepair &repair : unicastRepairs)
+   {
+      size_t length;
+
+      // the repairs over the budget are dropped, the receivers ask again
+      if(repairBudget == 0)
+         break;
+      repairBudget--;
+      uint8_t *datagram = ring.lookup(repair.sequence, length);
+
+      if(datagram == nullptr)
+      {
+         // the copy is overwritten by the next one, so it goes on its own
+         datagram = copyFromJournal(repair.sequence, length);
+         if(datagram != nullptr)
+            sent += (sender->sendTo(datagram, length, const_cast<sockaddr_in*>(&repair.requester))
+                     > 0);
+         continue;
+      }
+      CRmdgpHeader::store16(datagram + CRmdgpHeader::flagsOffset,
+                      CRmdgpHeaderView(datagram).getFlags() | rmdgpFlagRetransmission);
+      repairBatch->add(datagram, length, repair.requester);
+      if(repairBatch->count == repairBatchSize)
+      {
+         sent += sender->sendBatch(repairBatch->messages, repairBatch->count);
+         repairBatch->count = 0;
+      }
+   }
+   if(repairBatch->count > 0)
+      sent += sender->sendBatch(repairBatch->messages, repairBatch->count);
+   return sent;
+}
+
+size_t CRmdgpSender::sendParityRepairs()
+{
+   const size_t maxRow = fecEncoder->getParityRows() + fecRepairRows;
+   size_t sent = 0;
+   size_t kept = 0;
+
+   fecRepairNextRow.erase(fecRepairNextRow.begin(),
+                          fecRepairNextRow.lower_bound(ring.getOldestSequence()));
+   std::sort(multicastRepairs.begin(), multicastRepairs.end(), CSequenceNumber::isBefore);
+   for(size_t i = 0; i < multicastRepairs.size();)
+   {
+      uint64_t firstSequence;
+      size_t blockSize;
+      size_t end = i + 1;
+
+      if(findFecBlock(multicastRepairs[i], firstSequence, blockSize))
+      {
+         while(end < multicastRepairs.size() &&
+               CSequenceNumber::isBefore(multicastRepairs[end], firstSequence + blockSize))
+            end++;
+         const size_t lost = end - i;
+         auto inserted = fecRepairNextRow.insert({ firstSequence, fecEncoder->getParityRows() });
+         size_t &nextRow = inserted.first->second;
+         if(nextRow + lost <= maxRow)
+         {
+            // one new row repairs one loss at every receiver, whichever datagram it lost
+            repairEncoder->setBlockSize(blockSize);
+            repairEncoder->setParityRows(lost, nextRow);
+            for(size_t index = 0; index < blockSize; index++)
+            {
+               size_t length;
+               const uint8_t *datagram = ring.lookup(firstSequence + index, length);
+               repairEncoder->add(firstSequence + index, datagram + CRmdgpHeader::size,
+                                  length - CRmdgpHeader::size);
+            }
+            const size_t count = repairEncoder->finish(sessionId, streamId,
+                                                       rmdgpFlagRetransmission);
+            for(size_t row = 0; row < count; row++)
+            {
+               size_t length;
+               const uint8_t *datagram = repairEncoder->getParity(row, length);
+               transmit(datagram, length);
+            }
+            nextRow += lost;
+            sent += count;
+            i = end;
+            continue;
+         }
+      }
+      // out of rows or no finished block, resend the datagrams
+      while(i < end)
+         multicastRepairs[kept++] = multicastRepairs[i++];
+   }
+   multicastRepairs.resize(kept);
+   return sent;
+}
+
+bool CRmdgpSender::findFecBlock(uint64_t sequence, uint64_t &firstSequence, size_t &blockSize)
+{
+   size_t length;
+   const uint8_t *datagram = ring.lookup(sequence, length);
+
+   if(datagram == nullptr)
+      return false;
+   const CRmdgpHeaderView header(datagram);
+   if(!(header.getFlags() & rmdgpFlagFec))
+      return false;
+   firstSequence = sequence - header.getFecIndex();
+   // the block that is being built has no parity rows yet
+   if(fecEncoder->isStarted() && fecEncoder->getFirstSequence() == firstSequence)
+      return false;
+
+   // a block that was cut short ends before its announced size, where the next block starts
+   for(blockSize = 0; blockSize < header.getFecBlockSize(); blockSize++)
+   {
+      const uint64_t current = firstSequence + blockSize;
+      if(!CSequenceNumber::isBefore(current, ring.getNextSequence()))
+         break;
+      datagram = ring.lookup(current, length);
+      if(datagram == nullptr)
+         return false;
+      if(CRmdgpHeaderView(datagram).getFecIndex() != blockSize)
+         break;
+   }
+   return blockSize > 0;
+}
+
+bool CRmdgpSender::processAck(const uint8_t *datagram, size_t length, const CNanoTime &now)
+{
+   SSequenceRange range;
+
+   if(CRmdgpHeaderView::validate(datagram, length) != ERmdgpValidation::valid)
+      return false;
+   const CRmdgpHeaderView header(datagram);
+   if(header.getType() != ERmdgpPacketType::ack || header.getSessionId() != sessionId ||
+      header.getStreamId() != streamId)
+      return false;
+
+   CAckReader ack(datagram, length);
+   const uint64_t cumulativeAck = ack.getCumulativeAck();
+   // nobody can have received what isn't sent yet
+   if(ack.isMalformed() || CSequenceNumber::isAfter(cumulativeAck, ring.getNextSequence()))
+      return false;
+   uint64_t highestReceived = cumulativeAck;
+   while(ack.next(range))
+      highestReceived = range.end;
+   if(ack.isMalformed() || CSequenceNumber::isAfter(highestReceived, ring.getNextSequence()))
+      return false;
+
+   uint32_t index = receivers.find(ack.getReceiverId());
+   // only an ACK that has new datagrams tells when they arrived
+   bool received = true;
+   if(index == CReceiverTable::invalidIndex)
+   {
+      // an ejected receiver stays out, until checkReceivers forgets the ejection
+      if(isEjected(ack.getReceiverId()))
+         return false;
+      index = receivers.add(ack.getReceiverId(), cumulativeAck, now);
+      if(index == CReceiverTable::invalidIndex)
+         return false;
+   }
+   else
+      received = CSequenceNumber::isAfter(highestReceived, receivers.getHighestReceived(index));
+   latestNow = std::max(latestNow, now);
+   receivers.acknowledge(index, cumulativeAck, highestReceived, now);
+   if(ack.hasLossRate())
+   {
+      receivers.reportLoss(index, ack.getLossRate());
+      if(congestionController)
+         congestionController->onFeedback(ack.getReceiverId(), receivers.getLossRate(index),
+                                          received ?
+                                             getRttSample(highestReceived, ack.getHoldTime(), now) :
+                                             CNanoTime(), now);
+   }
+   ackCount++;
+   return true;
+}
+
+CNanoTime CRmdgpSender::getRttSample(uint64_t highestReceived, const CNanoTime &holdTime,
+                                     const CNanoTime &now) const
+{
+   // the newest probe that the receiver has
+   for(size_t i = 0; i < rttProbeCount; i++)
+   {
+      const SRttProbe &probe = rttProbes[(rttProbeIndex + rttProbeCount - i) % rttProbeCount];
+      if(probe.time == CNanoTime())
+         break;
+      // the probe is the send time of the newest datagram that the receiver has, it got it
+      // holdTime before the ACK was sent. A hold time beyond the sample is a clock glitch.
+      if(CSequenceNumber::isBefore(probe.sequence, highestReceived))
+         return now - probe.time > holdTime ? now - probe.time - holdTime : CNanoTime();
+   }
+   return CNanoTime();
+}
+
+void CRmdgpSender::setPacing(double rate, size_t burst, size_t maxDatagrams)
+{
+   std::unique_ptr<CPacer> newPacer(new CPacer(sender, rate, burst, maxDatagrams,
+                                               CRmdgpHeader::size + maxPayloadSize));
+
+   // the waiting datagrams go first, in order
+   if(pacer)
+      pacer->flush();
+   pacer = std::move(newPacer);
+   if(pacerLatencyRecorder)
+      pacer->setLatencyRecorder(pacerLatencyRecorder);
+}
+
+void CRmdgpSender::setPacerLatencyRecorder(std::shared_ptr<CLatencyRecorder> recorder)
+{
+   pacerLatencyRecorder = recorder;
+   if(pacer)
+      pacer->setLatencyRecorder(recorder);
+}
+
+void CRmdgpSender::transmit(const uint8_t *datagram, size_t length)
+{
+   // a full pacer drops it like a socket that would block, the receivers will ask for it
+   if(pacer)
+      pacer->enqueue(datagram, length, latestNow);
+   else
+      sender->send(datagram, length);
+}
+
+bool CRmdgpSender::hasPacerRoom(size_t datagrams) const
+{
+   return !pacer || pacer->getFreeCount() >= datagrams +
+                                             (fecEncoder ? fecEncoder->getParityRows() : 0);
+}
+
+void CRmdgpSender::setCatchUp(double rate, size_t burst, size_t maxJoiners)
+{
+   if(!(rate > 0) || burst < CRmdgpHeader::size + maxPayloadSize)
+   {
+      std::ostringstream message;
+      message << "Error catch-up rate " << rate << " burst " << burst;
+      throw std::runtime_error(message.str());
+   }
+   catchUpRate = rate;
+   catchUpBurst = burst;
+   this->maxJoiners = maxJoiners;
+   if(joiners.size() > maxJoiners)
+      joiners.resize(maxJoiners);
+}
+
+bool CRmdgpSender::processJoin(const uint8_t *datagram, size_t length, const sockaddr_in &source,
+                    const CNanoTime &now)
+{
+   if(maxJoiners == 0 ||
+      CRmdgpHeaderView::validate(datagram, length) != ERmdgpValidation::valid)
+      return false;
+   const CRmdgpHeaderView header(datagram);
+   if(header.getType() != ERmdgpPacketType::join || header.getSessionId() != sessionId ||
+      header.getStreamId() != streamId)
+      return false;
+
+   const CJoinReader join(datagram, length);
+   SSequenceRange range = join.getRange();
+   // nobody can have missed what isn't sent yet. An ejected receiver may come back, but not
+   // right after its ejection.
+   const std::unordered_map<uint32_t, CNanoTime>::const_iterator ejected =
+                   ejectedIds.find(join.getReceiverId());
+   if(join.isMalformed() || (ejected != ejectedIds.end() && now - ejected->second < rejoinDelay) ||
+      CSequenceNumber::isAfter(range.end, ring.getNextSequence()) ||
+      CSequenceNumber::isAfter(range.begin, range.end))
+      return false;
+
+   // what is not in the history anymore is gone for the joiner
+   const uint64_t historyStart = getHistoryStart();
+   if(CSequenceNumber::isBefore(range.begin, historyStart))
+      range.begin = CSequenceNumber::isBefore(historyStart, range.end) ? historyStart : range.end;
+   std::vector<std::unique_ptr<SJoiner>>::iterator joiner = startReplay(join.getReceiverId(),
+                   source, range, rmdgpFlagCatchUp);
+   if(joiner == joiners.end())
+      return false;
+   if(ejected != ejectedIds.end())
+      ejectedIds.erase(ejected);
+
+   uint8_t accept[CJoinBuilder::maxLength];
+   CJoinBuilder builder(accept, ERmdgpPacketType::joinAccept, sessionId, streamId,
+                        join.getReceiverId(), range);
+   sender->sendTo(accept, builder.getLength(), &(*joiner)->address);
+   if(range.size() == 0)
+      joiners.erase(joiner);
+   joinCount++;
+   return true;
+}
+
+std::vector<std::unique_ptr<CRmdgpSender::SJoiner>>::iterator CRmdgpSender::startReplay(
+                uint32_t receiverId, const sockaddr_in &address, const SSequenceRange &range,
+                uint16_t flag)
+{
+   std::vector<std::unique_ptr<SJoiner>>::iterator joiner = std::find_if(joiners.begin(),
+                   joiners.end(), [&](const std::unique_ptr<SJoiner> &j)
+                   { return j->receiverId == receiverId; });
+   if(joiner == joiners.end())
+   {
+      if(joiners.size() >= maxJoiners)
+         return joiners.end();
+      joiners.emplace_back(new SJoiner(sender, receiverId, address, catchUpRate, catchUpBurst,
+                                       CRmdgpHeader::size + maxPayloadSize));
+      joiner = joiners.end() - 1;
+   }
+   else
+   {
+      // the joiner lost the replay or the accept, start again where it asks
+      (*joiner)->pacer.clear();
+      (*joiner)->address = address;
+   }
+   (*joiner)->next = range.begin;
+   (*joiner)->end = range.end;
+   (*joiner)->flag = flag;
+   return joiner;
+}
+
+size_t CRmdgpSender::replayHistory(const CNanoTime &now)
+{
+   size_t sent = 0;
+
+   for(size_t i = 0; i < joiners.size();)
+   {
+      SJoiner &joiner = *joiners[i];
+      bool lost = false;
+
+      while(joiner.next != joiner.end && joiner.pacer.getFreeCount() > 0)
+      {
+         size_t length;
+         const uint8_t *datagram = lookupHistory(joiner.next, length);
+         if(datagram == nullptr)
+         {
+            // the sender went faster than the replay, the joiner asks for what is left
+            lost = true;
+            break;
+         }
+         uint8_t *copy = joiner.pacer.enqueue(length);
+         memcpy(copy, datagram, length);
+         CRmdgpHeader::store16(copy + CRmdgpHeader::flagsOffset,
+                         CRmdgpHeaderView(copy).getFlags() | joiner.flag);
+         joiner.next++;
+      }
+      const size_t released = joiner.pacer.release(now);
+      sent += released;
+      if(lost || (joiner.next == joiner.end && joiner.pacer.isEmpty()))
+         joiners.erase(joiners.begin() + i);
+      else
+         i++;
+   }
+   replayedCount += sent;
+   return sent;
+}
+
+CNanoTime CRmdgpSender::getNextCatchUpTime() const
+{
+   CNanoTime next;
+
+   for(size_t i = 0; i < joiners.size(); i++)
+   {
+      const CNanoTime time = joiners[i]->pacer.getNextSendTime();
+      if(i == 0 || time < next)
+         next = time;
+   }
+   return next;
+}
+
+const uint8_t* CRmdgpSender::lookupHistory(uint64_t sequence, size_t &length) const
+{
+   const uint8_t *datagram = ring.lookupHistory(sequence, length);
+
+   if(datagram == nullptr && journal)
+      datagram = journal->lookup(sequence, length);
+   return datagram;
+}
+
+uint64_t CRmdgpSender::getHistoryStart() const
+{
+   const uint64_t historyStart = ring.getHistoryStart();
+
+   if(journal && !journal->isEmpty() &&
+      CSequenceNumber::isBefore(journal->getOldestSequence(), historyStart))
+      return journal->getOldestSequence();
+   return historyStart;
+}
+
+void CRmdgpSender::setJournal(std::shared_ptr<CSenderJournal> newJournal)
+{
+   if(newJournal && ((!newJournal->isEmpty() &&
+                      newJournal->getNextSequence() != ring.getNextSequence()) ||
+                     newJournal->getMaxLength() < CRmdgpHeader::size + maxPayloadSize))
+   {
+      std::ostringstream message;
+      message << "Error the journal in " << newJournal->getDirectory() << " ends at "
+              << newJournal->getNextSequence() << " instead of " << ring.getNextSequence()
+              << " or has no room for " << CRmdgpHeader::size + maxPayloadSize << " bytes";
+      throw std::runtime_error(message.str());
+   }
+   journal = newJournal;
+   // makes the segment for the first send
+   if(journal)
+      journal->flush();
+   journalCopy.resize(journal ? CRmdgpHeader::size + maxPayloadSize : 0);
+}
+
+double CRmdgpSender::getAllowedRate(const CNanoTime &now)
+{
+   return congestionController ? congestionController->getRate(now) : INFINITY;
+}
+
+size_t CRmdgpSender::updateWindow()
+{
+   if(receivers.getCount() == 0)
+      return 0;
+   return ring.release(receivers.getWatermark(ring.getNextSequence()));
+}
+
+bool CRmdgpSender::handleTimer(const CNanoTime &now)
+{
+   latestNow = std::max(latestNow, now);
+   if(hasPendingMessages() && now >= flushTime)
+      flush();
+   repairBudget = maxRepairsPerTimer;
+   sendRepairs(now);
+   // the encoder applies a new block size and parity rows with the next block
+   if(fecController && receivers.getCount() > 0 &&
+      fecController->update(receivers.getWorstLossRate(), now))
+      setFecBlockSize(fecController->getBlockSize(), std::max<size_t>(1,
+                      fecController->getParityRows()));
+   const bool heartbeat = handleIdle(now);
+   if(pacer)
+   {
+      if(congestionController)
+         pacer->setRate(congestionController->getRate(now), now);
+      pacer->release(now);
+   }
+   if(!joiners.empty())
+      replayHistory(now);
+   if(journal)
+      journal->flush();
+   return heartbeat;
+}
+
+bool CRmdgpSender::handleIdle(const CNanoTime &now)
+{
+   // datagrams that wait in the pacer are traffic as well
+   if(sentSinceTimer || (pacer && !pacer->isEmpty()))
+   {
+      // not idle, the first heartbeat comes shortly after the traffic stops
+      sentSinceTimer = false;
+      heartbeatInterval = minHeartbeatInterval;
+      nextHeartbeat = now + heartbeatInterval;
+      return false;
+   }
+   // idle, the last block won't fill up soon
+   if(fecEncoder && fecEncoder->isStarted())
+      sendParity();
+   if(now < nextHeartbeat)
+      return false;
+
+   uint8_t datagram[CRmdgpHeader::size];
+   CRmdgpHeaderBuilder(datagram).setType(ERmdgpPacketType::heartbeat).setSessionId(sessionId)
+                   .setStreamId(streamId).setSequence(ring.getNextSequence());
+   transmit(datagram, sizeof(datagram));
+   heartbeatCount++;
+
+   heartbeatInterval = std::min(heartbeatInterval * 2, maxHeartbeatInterval);
+   nextHeartbeat = now + heartbeatInterval;
+   return true;
+}
+
+void CRmdgpSender::setHeartbeatIntervals(const CNanoTime &minInterval,
+                    const CNanoTime &maxInterval)
+{
+   if(minInterval <= CNanoTime() || maxInterval < minInterval)
+   {
+      std::ostringstream message;
+      message << "Error heartbeat intervals " << minInterval << " and " << maxInterval;
+      throw std::runtime_error(message.str());
+   }
+   minHeartbeatInterval = minInterval;
+   maxHeartbeatInterval = maxInterval;
+   heartbeatInterval = minInterval;
+}
+
+size_t CRmdgpSender::checkReceivers(const CNanoTime &now)
+{
+   if(!ejectionPolicy)
+      return 0;
+   // after the rejoin delay an ejection is forgotten, so the ids of receivers that never come
+   // back don't pile up
+   for(auto ejected = ejectedIds.begin(); ejected != ejectedIds.end();)
+   {
+      if(now - ejected->second >= rejoinDelay)
+         ejected = ejectedIds.erase(ejected);
+      else
+         ++ejected;
+   }
+   if(!ejectionPolicy->evaluate(receivers, ring.getNextSequence(), now, ejectIndexes))
+      return 0;
+
+   // from the back, so removing doesn't move a receiver that is still to be ejected
+   for(std::vector<uint32_t>::const_reverse_iterator index = ejectIndexes.rbegin();
+       index != ejectIndexes.rend(); ++index)
+   {
+      const uint32_t receiverId = receivers.getReceiverId(*index);
+      ejectedIds[receiverId] = now;
+      receivers.remove(*index);
+      if(congestionController)
+         congestionController->onReceiverRemoved(receiverId);
+      if(listener)
+         listener->onReceiverEjected(receiverId, ejectionPolicy->getLastRate(*index));
+   }
+   if(!ejectIndexes.empty())
+      updateWindow();
+   return ejectIndexes.size();
+}
+
+size_t CRmdgpSender::handleFeedback(const CNanoTime &now)
+{
+   size_t received;
+   size_t resent = 0;
+
+   feedback->prepare();
+   while((received = sender->receiveBatch(feedback->messages, feedbackBatchSize)) > 0)
+   {
+      bool acknowledged = false;
+
+      for(size_t i = 0; i < received; i++)
+      {
+         const mmsghdr &message = feedback->messages[i];
+         const uint8_t *datagram = feedback->getBuffer(i);
+
+         // a truncated datagram can't be trusted
+         if((message.msg_hdr.msg_flags & MSG_TRUNC) || message.msg_len < CRmdgpHeader::size)
+            continue;
+         if(datagram[CRmdgpHeader::typeOffset] == uint8_t(ERmdgpPacketType::ack))
+            acknowledged |= processAck(datagram, message.msg_len, now);
+         else if(datagram[CRmdgpHeader::typeOffset] == uint8_t(ERmdgpPacketType::join))
+            processJoin(datagram, message.msg_len, feedback->sources[i], now);
+         else
+            resent += processNak(datagram, message.msg_len, feedback->sources[i], now);
+      }
+      feedback->prepare();
+      if(acknowledged)
+         updateWindow();
+   }
+   return resent;
+}
@@ -0,0 +1,554 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CRmdgpSender.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 16, 2021, 9:15 PM
+ */
+
+#ifndef CRMDGPSENDER_H
+#define CRMDGPSENDER_H
+
+#include "CCongestionController.h"
+#include "CFecController.h"
+#include "CFecEncoder.h"
+#include "CMessageBatch.h"
+#include "CRateEjectionPolicy.h"
+#include "CReceiverListener.h"
+#include "CReceiverTable.h"
+#include "CRepairScheduler.h"
+#include "CRetransmissionRing.h"
+#include "CRmdgpHeader.h"
+#include "CSenderJournal.h"
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+class CLatencyRecorder;
+class CPacer;
+class CUdpMulticastSender;
+
+/// \brief The sending side of an RMDGP stream. Every payload gets an RMDGP header with the next
+///        sequence number and is kept in a CRetransmissionRing until it is acknowledged, so it can
+///        be sent again on request.
+///        The receivers send ACKs with their cumulative acknowledgement. The sender keeps the
+///        latest per receiver in a CReceiverTable and releases everything before the lowest one.
+///        Feedback is received in batches, the window is recomputed once per batch instead of
+///        per ACK.
+///        So the slowest receiver sets the pace: when it falls a whole retransmission ring
+///        behind, send fails until it acknowledges more. With setMinimumRate a receiver that
+///        stays below the minimum rate is ejected: it has no influence on the window anymore,
+///        until it comes back with a join (see processJoin), for instance after a restart, or
+///        the ejection is forgotten after the rejoin delay.
+///        When the sender goes quiet, handleTimer sends heartbeats with the next sequence number,
+///        so the receivers find a loss at the end of a burst and know the sender is alive. The
+///        first heartbeat comes minHeartbeatInterval after the last datagram, the interval
+///        doubles with every heartbeat up to maxHeartbeatInterval, so an idle sender costs
+///        almost nothing.
+///        By default a NAK is answered at once with multicast repairs. With setRepairPolicy the
+///        NAKs are gathered for a short window, then each repair is multicast or unicast to the
+///        receivers that asked for it, see CRepairScheduler. The repairs are bounded per NAK
+///        and per handleTimer (see setRepairLimits), the receivers ask again for the rest, so a
+///        bogus NAK can't make the sender resend its whole history.
+///        With setFecBlockSize every block of data datagrams is followed by parity datagrams,
+///        so a receiver rebuilds as many lost datagrams per block without waiting for a repair,
+///        see CFecEncoder. When the sender goes idle the parities of the last, short block are
+///        sent from handleTimer. With setFecRepair as well, the gathered multicast repairs of a
+///        block are new parity rows instead of the lost datagrams: one parity repairs a
+///        different loss at every receiver. With setFecController the block size and the
+///        parity rows follow the worst loss rate that the receivers report in their ACKs.
+///        With setCoalescing small messages are sent with sendMessage. They are packed in a
+///        CMessageBatch up to the max payload size, which goes out when the next message
+///        doesn't fit, on flush, or from handleTimer when the first message waited for the
+///        deadline.
+///        sendFragmented splits a message that is larger than a datagram in fragments with a
+///        CFragmentHeader, the receivers put them together with CFragmentAssembler.
+///        With setCongestionController the loss reports of the ACKs and round trip time samples
+///        go to a CCongestionController, that decides the rate the stream may use. A sample is
+///        the time from sending a datagram until the first ACK that has it, minus the time that
+///        the receiver held that ACK back (see CAckBuilder); the send time is the latest now that
+///        was passed to the sender, so it is as precise as the event loop.
+///        With setPacing the multicast datagrams go through a CPacer instead of straight to the
+///        socket: they are queued and handleTimer sends them in micro bursts at the pacing rate.
+///        With a congestion controller as well, the pacing rate follows its rate. The unicast
+///        repairs are not paced.
+///        With setCatchUp a late joiner can ask for the datagrams it missed with a join, see
+///        CJoinBuilder. The sender answers with a join accept with the part that is still in the
+///        history of the retransmission ring, and replays that part to the joiner only, over
+///        unicast with its own CPacer. The replayed datagrams have rmdgpFlagCatchUp. The
+///        multicast stream and the window are not affected: the joiner is not in the receiver
+///        table until it sends an ACK, and the history is read from released slots too.
+///        With setJournal every sent datagram is appended to a CSenderJournal as well. The
+///        catch-up comes from the journal when the datagram is not in the ring anymore, and a
+///        restarted sender continues the stream where the journal ends. A NAK for datagrams
+///        that only the journal has is not repaired in bulk: the part is replayed to the
+///        requester alone, paced like a catch-up, see processNak.
+class CRmdgpSender {
+public:
+    /// \param sender an opened multicast sender
+    /// \param sessionId the session id that is put in every header
+    /// \param streamId the stream id that is put in every header
+    /// \param maxMessages the maximum number of unacknowledged datagrams
+    /// \param maxBytes the maximum number of bytes of all unacknowledged datagrams
+    /// \param maxPayloadSize the largest payload that can be sent
+    /// \param firstSequence the sequence number of the first datagram
+    /// \param maxReceivers the maximum number of receivers that are tracked. The ACKs of more
+    ///        receivers are ignored, so they don't hold the window.
+    /// \throws std::runtime_error when the retransmission ring or receiver table can't be made
+    ///         or maxPayloadSize doesn't fit in the header
+    CRmdgpSender(std::shared_ptr<CUdpMulticastSender> sender, uint32_t sessionId, uint32_t streamId,
+                 size_t maxMessages, size_t maxBytes,
+                 size_t maxPayloadSize = defaultMaxPayloadSize, uint64_t firstSequence = 0,
+                 size_t maxReceivers = defaultMaxReceivers);
+    CRmdgpSender(const CRmdgpSender& orig) = delete;
+    virtual ~CRmdgpSender();
+
+    /// \brief sends payload in a datagram with the next sequence number. The datagram is built
+    ///        in place in the retransmission ring. When the socket would block the datagram
+    ///        is kept anyway, the receivers will ask for it.
+    /// \return false when nothing was sent because the payload is larger than maxPayloadSize,
+    ///         the unacknowledged datagrams already reach the message or byte bound or the
+    ///         pacer queue is full
+    /// \throws std::runtime_error when OS reports an error.
+    bool send(const void *payload, size_t length);
+
+    /// \brief sends message in fragments of at most maxPayloadSize, each with a CFragmentHeader,
+    ///        with consecutive sequence numbers. A stream with fragments carries fragments only,
+    ///        also a small message is one fragment; its receivers use CFragmentAssembler.
+    /// \return false when nothing was sent because the message is larger than
+    ///         CFragmentHeader::maxMessageLength or its fragments don't fit in the free part of
+    ///         the retransmission ring or the pacer queue
+    /// \throws std::runtime_error when OS reports an error.
+    bool sendFragmented(const void *message, size_t length);
+    /// \brief returns the number of messages sent with sendFragmented
+    uint64_t getFragmentedCount() const { return fragmentedCount; }
+
+    /// \brief packs small messages together, see sendMessage. A stream with coalescing carries
+    ///        batches only, its receivers read the payloads with CMessageBatchReader, so don't
+    ///        mix sendMessage with send.
+    /// \param deadline the longest time that a message waits for others, see handleTimer
+    /// \param maxBatchSize the largest batch, 0 for maxPayloadSize
+    /// \throws std::runtime_error when deadline is negative or maxBatchSize is larger than
+    ///         maxPayloadSize
+    void setCoalescing(const CNanoTime &deadline, size_t maxBatchSize = 0);
+    /// \brief adds message to the current batch. A full batch is sent first.
+    /// \param now the current CLOCK_MONOTONIC time, the deadline starts at the first message
+    /// \return false when nothing was added because the message doesn't fit in a batch, or the
+    ///         full batch couldn't be sent, see send
+    /// \throws std::runtime_error when coalescing is not enabled or OS reports an error
+    bool sendMessage(const void *message, size_t length, const CNanoTime &now);
+    /// \brief sends the current batch now
+    /// \return false when the batch couldn't be sent, see send. It is kept.
+    /// \throws std::runtime_error when OS reports an error.
+    bool flush();
+    /// \brief returns true when messages wait in the current batch
+    bool hasPendingMessages() const { return batch && !batch->isEmpty(); }
+    /// \brief returns the moment that handleTimer sends the current batch, only valid with
+    ///        hasPendingMessages. Let the event loop wake up at this moment.
+    CNanoTime getFlushTime() const { return flushTime; }
+    /// \brief returns the number of messages sent with sendMessage, and of the batches they
+    ///        went in
+    uint64_t getMessageCount() const { return messageCount; }
+    uint64_t getBatchCount() const { return batchCount; }
+
+    /// \brief sends the datagram with sequence number again, with the retransmission flag set.
+    ///        A datagram that is only in the journal is sent from a copy.
+    /// \return false when the datagram is not kept (anymore)
+    /// \throws std::runtime_error when OS reports an error.
+    bool resend(uint64_t sequence);
+
+    /// \brief resends the datagrams in the retransmission ring that are in one of the ranges of
+    ///        a NAK datagram, within the repair limits, see setRepairLimits. The NAKs of an
+    ///        ejected receiver are ignored.
+    /// \param datagram a received datagram, it is validated here
+    /// \return the number of resent datagrams
+    /// \throws std::runtime_error when OS reports an error.
+    size_t processNak(const uint8_t *datagram, size_t length);
+
+    /// \brief handles a NAK datagram of requester. Without repair policy the datagrams in the
+    ///        ring are resent like processNak(datagram, length), with it the requests are
+    ///        gathered and sendRepairs sends them later.
+    ///        The first requested part that is only in the journal is replayed to requester
+    ///        like a catch-up (see setCatchUp), but with rmdgpFlagRetransmission. That needs
+    ///        setCatchUp, and room for a joiner; a receiver that is catching up is left alone.
+    /// \return the number of resent datagrams, or the number of gathered requests that were not
+    ///         merged with earlier ones
+    /// \throws std::runtime_error when OS reports an error.
+    size_t processNak(const uint8_t *datagram, size_t length, const sockaddr_in &requester,
+                      const CNanoTime &now);
+    /// \brief bounds the repairs: a NAK is answered with at most maxPerNak repairs (or
+    ///        requests with a repair policy), and at most maxPerTimer repairs are sent from one
+    ///        handleTimer until the next one. The receivers ask again for the rest.
+    /// \throws std::runtime_error when a limit is 0
+    void setRepairLimits(size_t maxPerNak, size_t maxPerTimer);
+    /// \brief returns the number of NAK ranges that were replayed from the journal
+    uint64_t getJournalReplayCount() const { return journalReplayCount; }
+
+    /// \brief gathers the NAKs for window, then multicasts a repair that more than
+    ///        unicastThreshold receivers asked for and unicasts the others, see CRepairScheduler
+    void setRepairPolicy(size_t unicastThreshold, const CNanoTime &window)
+        { repairScheduler.reset(new CRepairScheduler(unicastThreshold, window)); }
+    /// \brief sends the gathered repairs whose window passed. The unicast repairs go out
+    ///        repairBatchSize per system call. Called by handleTimer.
+    /// \return the number of sent repairs
+    /// \throws std::runtime_error when OS reports an error.
+    size_t sendRepairs(const CNanoTime &now);
+    /// \brief returns the repair scheduler, nullptr without repair policy
+    const CRepairScheduler* getRepairScheduler() const { return repairScheduler.get(); }
+
+    /// \brief sends parityRows parity datagrams after every blockSize data datagrams,
+    ///        blockSize 0 for no FEC. A new block size takes effect with the next block.
+    /// \throws std::runtime_error when blockSize is larger than CFecEncoder::maxBlockSize or
+    ///         parityRows is out of range, or when OS reports an error sending the parities of
+    ///         the last block when FEC stops
+    void setFecBlockSize(size_t blockSize, size_t parityRows = 1);
+    /// \brief answers the multicast repairs of a finished FEC block with up to repairRows
+    ///        parity rows after the ones sent with the block, 0 to resend the datagrams. When
+    ///        the rows run out, or a datagram of the block is released, the datagrams are
+    ///        resent. Needs setRepairPolicy, so the NAKs for a block are gathered; the
+    ///        receivers need enableFec with all rows.
+    /// \throws std::runtime_error when the rows pass CFecEncoder::maxParityRows together with
+    ///         the parity rows of the block, or the most that the FEC controller chooses
+    void setFecRepair(size_t repairRows);
+    /// \brief from now on handleTimer sets the FEC block size and parity rows that the
+    ///        controller chooses for the worst loss rate of the receivers, see CFecController.
+    ///        The receivers need enableFec with maxParityRows rows (plus the repair rows).
+    /// \throws std::runtime_error when a parameter is out of range, or maxParityRows and the
+    ///         rows of setFecRepair pass CFecEncoder::maxParityRows
+    void setFecController(double targetResidualLoss,
+                          size_t maxParityRows = CFecController::defaultMaxParityRows,
+                          double maxOverhead = CFecController::defaultMaxOverhead);
+    /// \brief returns the FEC controller, nullptr without
+    const CFecController* getFecController() const { return fecController.get(); }
+    /// \brief returns the FEC encoder, nullptr without FEC
+    const CFecEncoder* getFecEncoder() const { return fecEncoder.get(); }
+
+    /// \brief registers the acknowledgements of an ACK datagram. The window is not recomputed,
+    ///        call updateWindow when all available feedback is processed.
+    /// \param datagram a received datagram, it is validated here
+    /// \param now the time the datagram was received
+    /// \return false when the datagram is no valid ACK of this stream, comes from an ejected
+    ///         receiver, or from a new receiver while the receiver table is full
+    bool processAck(const uint8_t *datagram, size_t length, const CNanoTime &now);
+
+    /// \brief releases all datagrams that every known receiver acknowledged
+    /// \return the number of released datagrams
+    size_t updateWindow();
+
+    /// \brief receives and handles all feedback datagrams that are waiting at the socket of
+    ///        the sender, feedbackBatchSize per system call. After every batch with an ACK the
+    ///        window is updated. The socket must be in non blocking mode.
+    /// \return the number of resent datagrams, with a repair policy the number of gathered
+    ///         requests
+    /// \param now the current CLOCK_MONOTONIC time, see CFdWaiter::now()
+    /// \throws std::runtime_error when OS reports an error.
+    size_t handleFeedback(const CNanoTime &now);
+
+    /// \brief call this regularly, at least every minHeartbeatInterval. Sends the batch of
+    ///        messages whose deadline passed and the due repairs, and adapts the FEC to the
+    ///        loss rate.
+    ///        When nothing was sent since the previous call it sends the parity of an unfinished
+    ///        FEC block, and a heartbeat when the heartbeat interval passed.
+    ///        With setPacing it releases the paced datagrams last; call it again at
+    ///        getPacer()->getNextSendTime() while the pacer is not empty. Then it replays the
+    ///        history to the late joiners; call it again at getNextCatchUpTime() while there
+    ///        are joiners. At last it flushes the journal, see CSenderJournal::flush.
+    /// \param now the current CLOCK_MONOTONIC time, see CFdWaiter::now()
+    /// \return true when a heartbeat was sent
+    /// \throws std::runtime_error when OS reports an error.
+    bool handleTimer(const CNanoTime &now);
+
+    /// \brief sets the heartbeat interval right after traffic stops, and the longest one
+    /// \throws std::runtime_error when minInterval is not positive or maxInterval is smaller
+    void setHeartbeatIntervals(const CNanoTime &minInterval, const CNanoTime &maxInterval);
+    /// \brief returns the number of heartbeats sent
+    uint64_t getHeartbeatCount() const { return heartbeatCount; }
+
+    /// \brief ejects the receivers that stay below datagramsPerSecond for gracePeriod, measured
+    ///        per interval, see CRateEjectionPolicy. Call checkReceivers regularly to apply it.
+    /// \param rejoinDelay the time after the ejection that the joins of the receiver are
+    ///        refused, so a receiver that is too slow doesn't bounce in and out. After it
+    ///        checkReceivers forgets the ejection, then the ACKs of the receiver count again.
+    /// \throws std::runtime_error when interval is not positive or gracePeriod is negative
+    void setMinimumRate(double datagramsPerSecond, const CNanoTime &interval,
+                        const CNanoTime &gracePeriod,
+                        const CNanoTime &rejoinDelay = defaultRejoinDelay)
+    {
+        ejectionPolicy.reset(new CRateEjectionPolicy(datagramsPerSecond, interval, gracePeriod));
+        this->rejoinDelay = rejoinDelay;
+    }
+
+    /// \brief sets the listener that gets the receiver events, nullptr for none
+    void setReceiverListener(std::shared_ptr<CReceiverListener> newListener)
+        { listener = newListener; }
+
+    /// \brief sets the congestion controller that gets the feedback of the receivers,
+    ///        nullptr for none. It gets the ACKs with a loss report, the receivers add one when
+    ///        they acknowledge new datagrams.
+    void setCongestionController(std::shared_ptr<CCongestionController> controller)
+        { congestionController = controller; }
+    /// \brief returns the congestion controller, nullptr without
+    const std::shared_ptr<CCongestionController>& getCongestionController() const
+        { return congestionController; }
+    /// \brief returns the rate that the congestion controller allows now, in bytes per second,
+    ///        infinite without controller
+    double getAllowedRate(const CNanoTime &now);
+
+    /// \brief paces the multicast datagrams with a token bucket, see CPacer. The datagrams that
+    ///        are already paced keep their place.
+    /// \param rate the rate in bytes per second, until a congestion controller sets it
+    /// \param burst the size of a micro burst in bytes, at least a full datagram
+    /// \param maxDatagrams the number of datagrams that can wait in the pacer
+    /// \throws std::runtime_error when rate is not positive, burst is too small or maxDatagrams
+    ///         is 0
+    void setPacing(double rate, size_t burst, size_t maxDatagrams = defaultMaxPacedDatagrams);
+    /// \brief returns the pacer, nullptr without setPacing
+    const CPacer* getPacer() const { return pacer.get(); }
+    /// \brief records the time that the multicast datagrams wait in the pacer, from the latest
+    ///        now passed to the sender when they are queued until the handleTimer that sends
+    ///        them. It stays with a pacer of a later setPacing; nullptr stops it.
+    void setPacerLatencyRecorder(std::shared_ptr<CLatencyRecorder> recorder);
+
+    /// \brief answers the joins of late joiners, see processJoin. Every joiner gets the
+    ///        history it asks for at rate, so all joiners together use at most maxJoiners times
+    ///        rate.
+    /// \param rate the replay rate of a joiner in bytes per second
+    /// \param burst the size of a micro burst in bytes, at least a full datagram
+    /// \param maxJoiners the number of joiners that are served at the same time, the joins of
+    ///        more are ignored until one is done. 0 stops the catch-up.
+    /// \throws std::runtime_error when rate is not positive or burst is too small
+    void setCatchUp(double rate, size_t burst, size_t maxJoiners = defaultMaxJoiners);
+    /// \brief handles the join of a late joiner at source: answers with a join accept and
+    ///        starts to replay the part of the requested range that is in the history. A join of
+    ///        a joiner that is already served restarts its replay at the new range.
+    ///        An accepted join of an ejected receiver ends its ejection, its ACKs count again.
+    /// \param datagram a received datagram, it is validated here
+    /// \param now the current CLOCK_MONOTONIC time
+    /// \return false when the datagram is no valid join of this stream, the catch-up is not
+    ///         enabled, the joiner was ejected less than the rejoin delay ago (see
+    ///         setMinimumRate) or too many joiners are served
+    /// \throws std::runtime_error when OS reports an error.
+    bool processJoin(const uint8_t *datagram, size_t length, const sockaddr_in &source,
+                     const CNanoTime &now);
+    /// \brief tops up the pacers of the joiners from the history and releases them. A joiner
+    ///        whose next datagram left the history is dropped, it joins again. Called by
+    ///        handleTimer.
+    /// \return the number of replayed datagrams
+    /// \throws std::runtime_error when OS reports an error.
+    size_t replayHistory(const CNanoTime &now);
+    /// \brief returns when replayHistory can send the next micro burst, only valid when
+    ///        getJoinerCount() is not 0. Let the event loop call handleTimer at this moment.
+    CNanoTime getNextCatchUpTime() const;
+    /// \brief returns the number of joiners that are served now
+    size_t getJoinerCount() const { return joiners.size(); }
+    /// \brief returns the number of handled joins, and of the datagrams replayed to joiners
+    uint64_t getJoinCount() const { return joinCount; }
+    uint64_t getReplayedCount() const { return replayedCount; }
+
+    /// \brief appends every sent datagram to journal, nullptr for none. To continue the stream
+    ///        after a restart, open the journal first and construct the sender with
+    ///        journal->getNextSequence() as firstSequence and the session id of the journaled
+    ///        datagrams. It flushes the journal, so its next segment is ready.
+    /// \throws std::runtime_error when the journal doesn't end at getNextSequence() or its
+    ///         segments can't hold the largest datagram, or when OS reports an error
+    void setJournal(std::shared_ptr<CSenderJournal> newJournal);
+    /// \brief returns the journal, nullptr without
+    const std::shared_ptr<CSenderJournal>& getJournal() const { return journal; }
+    /// \brief returns the number of datagrams that were resent from the journal, by resend or
+    ///        the unicast repairs of datagrams that left the ring after their request
+    uint64_t getJournalRepairCount() const { return journalRepairCount; }
+
+    /// \brief applies the minimum rate: measures the receivers when the interval passed and
+    ///        ejects the ones that were slow for too long. The window is updated at once.
+    ///        The ejections older than the rejoin delay are forgotten.
+    ///        Does nothing without setMinimumRate.
+    /// \param now the current CLOCK_MONOTONIC time, see CFdWaiter::now()
+    /// \return the number of ejected receivers
+    size_t checkReceivers(const CNanoTime &now);
+
+    /// \brief returns true when the receiver was ejected and the ejection is not forgotten yet,
+    ///        see checkReceivers
+    bool isEjected(uint32_t receiverId) const { return ejectedIds.count(receiverId) != 0; }
+    /// \brief returns the number of ejected receivers that didn't join again and are not
+    ///        forgotten yet
+    size_t getEjectedCount() const { return ejectedIds.size(); }
+
+    /// \brief releases all datagrams before watermark, every receiver has received them
+    /// \return the number of released datagrams
+    size_t acknowledge(uint64_t watermark) { return ring.release(watermark); }
+
+    /// \brief returns the sequence number that the next sent datagram gets
+    uint64_t getNextSequence() const { return ring.getNextSequence(); }
+    const CRetransmissionRing& getRetransmissionRing() const { return ring; }
+    /// \brief returns the state of the receivers that sent an ACK
+    const CReceiverTable& getReceiverTable() const { return receivers; }
+    /// \brief returns the number of processed ACK datagrams
+    uint64_t getAckCount() const { return ackCount; }
+    uint32_t getSessionId() const { return sessionId; }
+    uint32_t getStreamId() const { return streamId; }
+
+    /// \brief an Ethernet MTU minus the IPv4, UDP and RMDGP headers
+    static constexpr size_t defaultMaxPayloadSize = 1500 - 20 - 8 - CRmdgpHeader::size;
+    static constexpr size_t defaultMaxReceivers = 1024;
+    static constexpr CNanoTime defaultMinHeartbeatInterval = CNanoTime::fromMsec(10);
+    static constexpr CNanoTime defaultMaxHeartbeatInterval = CNanoTime::fromSec(1);
+    /// \brief the number of feedback datagrams received with one system call
+    static constexpr unsigned int feedbackBatchSize = 32;
+    /// \brief the largest feedback datagram, larger ones are ignored
+    static constexpr size_t maxFeedbackLength = 1500 - 20 - 8;
+    /// \brief the number of unicast repairs sent with one system call
+    static constexpr unsigned int repairBatchSize = 32;
+    /// \brief the number of datagrams that can wait in the pacer by default
+    static constexpr size_t defaultMaxPacedDatagrams = 4096;
+    /// \brief the number of send times that are kept for round trip time samples
+    static constexpr size_t rttProbeCount = 32;
+    static constexpr size_t defaultMaxJoiners = 8;
+    static constexpr CNanoTime defaultRejoinDelay = CNanoTime::fromSec(1);
+    /// \brief the number of replayed datagrams that wait in the pacer of a joiner
+    static constexpr size_t catchUpQueueSize = 128;
+    static constexpr size_t defaultMaxRepairsPerNak = 1024;
+    static constexpr size_t defaultMaxRepairsPerTimer = 4096;
+
+private:
+    /// \brief the receive buffers of a feedback batch, see CRmdgpSender.cpp
+    struct SFeedbackBatch;
+    /// \brief the message headers of a unicast repair batch, see CRmdgpSender.cpp
+    struct SRepairBatch;
+    /// \brief a late joiner with the part of the history it still gets, see CRmdgpSender.cpp
+    struct SJoiner;
+
+    /// \brief validates a NAK datagram of this stream and calls function with the requested
+    ///        sequence numbers that are in the ring, at most maxRepairsPerNak
+    /// \param journalRange receives the first requested part that is only in the journal,
+    ///        empty when there is none
+    /// \param receiverId receives the id of the receiver that sent the NAK
+    /// \return the sum of the results of function
+    template<class TFunction>
+    size_t forEachRequested(const uint8_t *datagram, size_t length, TFunction function,
+                            SSequenceRange &journalRange, uint32_t &receiverId);
+    /// \brief starts to replay range to the joiner receiverId at address, with flag in the
+    ///        replayed datagrams. A joiner that is served already gets range from now on.
+    /// \return the joiner, joiners.end() when too many joiners are served
+    std::vector<std::unique_ptr<SJoiner>>::iterator startReplay(uint32_t receiverId, const sockaddr_in &address,
+                         const SSequenceRange &range, uint16_t flag);
+    /// \brief returns the time since the newest probe before highestReceived was sent, minus the
+    ///        time that the receiver held the ACK back, 0 when there is none
+    CNanoTime getRttSample(uint64_t highestReceived, const CNanoTime &holdTime,
+                           const CNanoTime &now) const;
+    /// \brief sends a multicast datagram, through the pacer when there is one
+    void transmit(const uint8_t *datagram, size_t length);
+    /// \brief returns true when the pacer has room for a datagram and the parity rows that may
+    ///        follow it, or there is no pacer
+    bool hasPacerRoom(size_t datagrams) const;
+    /// \brief returns the datagram with sequence from the history of the ring or else the
+    ///        journal, nullptr when it is in neither
+    const uint8_t* lookupHistory(uint64_t sequence, size_t &length) const;
+    /// \brief returns the oldest sequence number in the history of the ring or the journal
+    uint64_t getHistoryStart() const;
+    /// \brief resends sequence as a repair, when the repair budget isn't used up
+    bool resendRepair(uint64_t sequence);
+    /// \brief copies the datagram with sequence from the journal to journalCopy and sets the
+    ///        retransmission flag
+    /// \return the copy, nullptr when it is not in the journal
+    uint8_t* copyFromJournal(uint64_t sequence, size_t &length);
+    /// \brief sends the parity of an unfinished FEC block and heartbeats when idle
+    /// \return true when a heartbeat was sent
+    bool handleIdle(const CNanoTime &now);
+    /// \brief sends prefix and payload in one datagram, see send
+    bool send(const uint8_t *prefix, size_t prefixLength, const void *payload, size_t length);
+    /// \brief sends the parity datagrams of the current FEC block and starts the next block
+    void sendParity();
+    /// \brief sends new parity rows for the multicast repairs of finished FEC blocks and
+    ///        removes those from multicastRepairs
+    /// \return the number of sent parity datagrams
+    size_t sendParityRepairs();
+    /// \brief finds the finished FEC block of sequence, all its datagrams must be kept
+    /// \return false when there is no such block
+    bool findFecBlock(uint64_t sequence, uint64_t &firstSequence, size_t &blockSize);
+
+    std::shared_ptr<CUdpMulticastSender> sender;
+    CRetransmissionRing ring;
+    const uint32_t sessionId;
+    const uint32_t streamId;
+    std::unique_ptr<SFeedbackBatch> feedback;
+    CReceiverTable receivers;
+    uint64_t ackCount;
+    std::unique_ptr<CRateEjectionPolicy> ejectionPolicy;
+    std::shared_ptr<CReceiverListener> listener;
+    std::shared_ptr<CCongestionController> congestionController;
+    /// \brief a sent sequence number with its send time, for a round trip time sample
+    struct SRttProbe {
+        uint64_t sequence;
+        CNanoTime time;
+    };
+    /// \brief a ring of the probes of the latest distinct send times
+    std::vector<SRttProbe> rttProbes;
+    size_t rttProbeIndex;
+    /// \brief the latest now passed to processAck, handleTimer or sendMessage
+    CNanoTime latestNow;
+    std::unique_ptr<CPacer> pacer;
+    std::shared_ptr<CLatencyRecorder> pacerLatencyRecorder;
+    /// \brief the ejected receivers with the time of their ejection
+    std::unordered_map<uint32_t, CNanoTime> ejectedIds;
+    std::vector<uint32_t> ejectIndexes;
+    CNanoTime rejoinDelay;
+    bool sentSinceTimer;
+    CNanoTime minHeartbeatInterval;
+    CNanoTime maxHeartbeatInterval;
+    CNanoTime heartbeatInterval;
+    CNanoTime nextHeartbeat;
+    uint64_t heartbeatCount;
+    std::unique_ptr<CRepairScheduler> repairScheduler;
+    std::unique_ptr<SRepairBatch> repairBatch;
+    std::vector<uint64_t> multicastRepairs;
+    std::vector<SUnicastRepair> unicastRepairs;
+    std::unique_ptr<CFecEncoder> fecEncoder;
+    std::unique_ptr<CFecEncoder> repairEncoder;
+    std::unique_ptr<CFecController> fecController;
+    size_t fecRepairRows;
+    /// \brief the next parity row of a block that got parity repairs, by first sequence
+    std::map<uint64_t, size_t> fecRepairNextRow;
+    size_t maxPayloadSize;
+    std::unique_ptr<CMessageBatchBuilder> batch;
+    CNanoTime coalescingDeadline;
+    CNanoTime flushTime;
+    uint64_t messageCount;
+    uint64_t batchCount;
+    uint64_t fragmentedCount;
+    double catchUpRate;
+    size_t catchUpBurst;
+    size_t maxJoiners;
+    std::vector<std::unique_ptr<SJoiner>> joiners;
+    uint64_t joinCount;
+    uint64_t replayedCount;
+    std::shared_ptr<CSenderJournal> journal;
+    std::vector<uint8_t> journalCopy;
+    uint64_t journalRepairCount;
+    uint64_t journalReplayCount;
+    size_t maxRepairsPerNak;
+    size_t maxRepairsPerTimer;
+    size_t repairBudget;            ///< the repairs that may be sent until the next handleTimer
+};
+
+#endif /* CRMDGPSENDER_H */
@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CSenderJournal.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 6, 2021, 10:20 AM
+ */
+
+#include "CSenderJournal.h"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+#include <unistd.h>
+
+namespace {
+   const char journalMagic[8] = { 'R', 'M', 'D', 'G', 'P', 'J', 'N', 'L' };
+   const uint32_t journalVersion = 1;
+
+   /// \brief the start of a segment file, the records follow at headerSize
+   struct SSegmentHeader {
+      char magic[8];
+      uint32_t version;
+      uint32_t reserved;
+      uint64_t firstSequence;
+   };
+   const size_t headerSize = 64;
+   static_assert(sizeof(SSegmentHeader) <= headerSize, "the segment header doesn't fit");
+
+   /// \brief the start of a record, the datagram follows
+   typedef SSegmentRecordHeader SRecordHeader;
+   const size_t recordAlignment = SRecordHeader::alignment;
+   // the index entries are 32 bits offsets
+   const size_t maxSegmentSize = size_t(UINT32_MAX) + 1;
+   const size_t minSegmentSize = 64 * 1024;
+}
+
+const std::string CSenderJournal::filePrefix = "journal-";
+
+struct CSenderJournal::SSegment {
+   SSegment(const std::string &path, size_t size, bool populate)
+         : file(path, size, populate), firstSequence(0), count(0),
+           writeOffset(headerSize), flushed({ 0, file.getSize() }), synced(flushed) {}
+
+   /// \brief the part of the file before recordsEnd and from indexBegin that is written back
+   struct SRange {
+      size_t recordsEnd;
+      size_t indexBegin;
+   };
+
+   SSegmentHeader& header() { return *reinterpret_cast<SSegmentHeader*>(file.getData()); }
+   /// \brief the offset of record i is in the i-th 32 bits word from the end of the file
+   uint32_t* indexEntry(uint64_t i)
+      { return reinterpret_cast<uint32_t*>(file.getData() + file.getSize()) - (i + 1); }
+   const uint32_t* indexEntry(uint64_t i) const
+      { return reinterpret_cast<const uint32_t*>(file.getData() + file.getSize()) - (i + 1); }
+   size_t getIndexBegin() const { return file.getSize() - count * sizeof(uint32_t); }
+   bool fits(size_t recordSize) const
+      { return writeOffset + recordSize + (count + 1) * sizeof(uint32_t) <= file.getSize(); }
+   /// \brief writes back what was written after range and moves range
+   /// \param whole false to leave the pages that are partly written, the next append would
+   ///        have to wait for their write back
+   void flush(SRange &range, bool whole, bool synchronous);
+   bool isValidRecord(uint64_t i) const;
+   bool recover();
+   /// \brief the journal must be contiguous, the history before a gap is of no use
+   bool follows(const SSegment &previous) const
+      { return firstSequence == previous.firstSequence + previous.count; }
+
+   CMappedFile file;
+   uint64_t firstSequence;
+   uint64_t count;
+   size_t writeOffset;
+   /// \brief where the write back is started by flush(false)
+   SRange flushed;
+   /// \brief what is on the disk after flush(true)
+   SRange synced;
+};
+
+void CSenderJournal::SSegment::flush(SRange &range, bool whole, bool synchronous)
+{
+   const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+   const size_t recordsEnd = whole ? writeOffset : writeOffset - writeOffset % pageSize;
+   const size_t indexBegin = whole ? getIndexBegin() :
+                             (getIndexBegin() + pageSize - 1) / pageSize * pageSize;
+
+   if(recordsEnd > range.recordsEnd)
+   {
+      file.flush(range.recordsEnd, recordsEnd - range.recordsEnd, synchronous);
+      range.recordsEnd = recordsEnd;
+   }
+   if(indexBegin < range.indexBegin)
+   {
+      file.flush(indexBegin, range.indexBegin - indexBegin, synchronous);
+      range.indexBegin = indexBegin;
+   }
+}
+
+bool CSenderJournal::SSegment::isValidRecord(uint64_t i) const
+{
+   const uint32_t offset = *indexEntry(i);
+   const size_t end = file.getSize() - (i + 1) * sizeof(uint32_t);
+
+   if(offset < headerSize || offset % recordAlignment != 0 || offset + sizeof(SRecordHeader) > end)
+      return false;
+   const SRecordHeader *record = reinterpret_cast<const SRecordHeader*>(file.getData() + offset);
+   return record->sequence == firstSequence + i &&
+          offset + SRecordHeader::getRecordSize(record->length) <= end;
+}
+
+bool CSenderJournal::SSegment::recover()
+{
+   const SSegmentHeader &segmentHeader = header();
+
+   if(file.getSize() < minSegmentSize)
+      throw std::runtime_error("Error journal segment " + file.getPath() + " is too small");
+   if(memcmp(segmentHeader.magic, journalMagic, sizeof(journalMagic)) != 0)
+   {
+      if(std::any_of(segmentHeader.magic, segmentHeader.magic + sizeof(journalMagic),
+                     [](char c) { return c != 0; }))
+         throw std::runtime_error("Error " + file.getPath() + " is no journal segment");
+      // made in advance and never used
+      return false;
+   }
+   if(segmentHeader.version != journalVersion)
+   {
+      std::ostringstream message;
+      message << "Error journal segment " << file.getPath() << " has version "
+              << segmentHeader.version << " instead of " << journalVersion;
+      throw std::runtime_error(message.str());
+   }
+   firstSequence = segmentHeader.firstSequence;
+
+   // the index entries are written in order, after their record, so the used entries are the
+   // ones before the first one that doesn't point to its record. Past the used entries is 0, or
+   // in a full segment the records themselves.
+   uint64_t low = 0;
+   uint64_t high = (file.getSize() - headerSize) / (sizeof(SRecordHeader) + sizeof(uint32_t));
+   while(low < high)
+   {
+      const uint64_t middle = low + (high - low) / 2;
+      if(isValidRecord(middle))
+         low = middle + 1;
+      else
+         high = middle;
+   }
+   // the search only holds for an unbroken valid prefix: after a crash of the machine a lost
+   // page may be anywhere in the part that wasn't synced, and the search may step over it. The
+   // segment ends at the first record that is not valid, the journal must be contiguous.
+   count = 0;
+   while(count < low && isValidRecord(count))
+      count++;
+   if(count == 0)
+      return false;
+
+   const uint32_t lastOffset = *indexEntry(count - 1);
+   writeOffset = lastOffset + SRecordHeader::getRecordSize(
+               reinterpret_cast<const SRecordHeader*>(file.getData() + lastOffset)->length);
+   flushed = { writeOffset, getIndexBegin() };
+   return true;
+}
+
+CSenderJournal::CSenderJournal(const std::string &directory, size_t segmentSize,
+               size_t maxSegments) : segments(directory, filePrefix, segmentSize, maxSegments),
+               oldestSequence(0), count(0), recoveredCount(0)
+{
+   if(segmentSize < minSegmentSize || segmentSize > maxSegmentSize)
+   {
+      std::ostringstream message;
+      message << "Error journal segment size " << segmentSize << " is not between "
+              << minSegmentSize << " and " << maxSegmentSize;
+      throw std::runtime_error(message.str());
+   }
+   if(maxSegments == 0)
+      throw std::runtime_error("Error a journal needs at least 1 segment");
+
+   segments.recover();
+   if(!segments.empty())
+   {
+      oldestSequence = segments.front()->firstSequence;
+      for(const std::unique_ptr<SSegment> &segment : segments)
+         count += segment->count;
+      recoveredCount = count;
+      removeOldSegments();
+   }
+}
+
+CSenderJournal::~CSenderJournal()
+{
+}
+
+bool CSenderJournal::append(uint64_t sequence, const uint8_t *datagram, size_t length)
+{
+   const size_t recordSize = SRecordHeader::getRecordSize(length);
+
+   if(count != 0 && sequence != oldestSequence + count)
+      return false;
+   if(length > getMaxLength())
+      return false;
+   if(count == 0)
+      oldestSequence = sequence;
+
+   if(segments.empty() || !segments.back()->fits(recordSize))
+   {
+      addSegment();
+      if(!segments.back()->fits(recordSize))
+         return false;
+   }
+
+   SSegment &segment = *segments.back();
+   uint8_t *record = segment.file.getData() + segment.writeOffset;
+   const SRecordHeader recordHeader = { sequence, uint32_t(length), 0 };
+   memcpy(record, &recordHeader, sizeof(recordHeader));
+   memcpy(record + sizeof(recordHeader), datagram, length);
+   // the index entry makes the record part of the journal, so it is written last
+   __atomic_store_n(segment.indexEntry(segment.count), uint32_t(segment.writeOffset),
+                    __ATOMIC_RELEASE);
+   segment.writeOffset += recordSize;
+   segment.count++;
+   count++;
+   return true;
+}
+
+size_t CSenderJournal::getMaxLength() const
+{
+   return (segments.getSegmentSize() - headerSize - sizeof(uint32_t)) / recordAlignment *
+          recordAlignment - sizeof(SRecordHeader);
+}
+
+const uint8_t* CSenderJournal::lookup(uint64_t sequence, size_t &length) const
+{
+   if(!contains(sequence))
+      return nullptr;
+
+   const SSegment &segment = findSegment(sequence);
+   const uint8_t *record = segment.file.getData() + *segment.indexEntry(sequence -
+                                                                        segment.firstSequence);
+   length = reinterpret_cast<const SRecordHeader*>(record)->length;
+   return record + sizeof(SRecordHeader);
+}
+
+void CSenderJournal::flush(bool synchronous)
+{
+   // only the last segments have something new, a full segment is written back whole
+   for(auto it = segments.rbegin(); it != segments.rend(); ++it)
+   {
+      SSegment &segment = **it;
+      const bool whole = synchronous || it != segments.rbegin();
+      SSegment::SRange &range = synchronous ? segment.synced : segment.flushed;
+
+      if(it != segments.rbegin() && range.recordsEnd == segment.writeOffset)
+         break;
+      segment.flush(range, whole, synchronous);
+      if(synchronous)
+         segment.flushed = segment.synced;
+   }
+
+   if(segments.empty() || segments.back()->writeOffset + segments.back()->count *
+      sizeof(uint32_t) > segments.back()->file.getSize() / 2)
+      segments.makeSpare();
+   removeOldSegments();
+}
+
+void CSenderJournal::removeOldSegments()
+{
+   const uint64_t removed = segments.removeOldSegments();
+
+   oldestSequence += removed;
+   count -= removed;
+}
+
+const CSenderJournal::SSegment& CSenderJournal::findSegment(uint64_t sequence) const
+{
+   // the segments are in order, compare the distances from the oldest to survive a wrap around
+   const uint64_t distance = sequence - oldestSequence;
+   auto it = std::upper_bound(segments.begin(), segments.end(), distance,
+                              [this](uint64_t value, const std::unique_ptr<SSegment> &segment)
+                              { return value < segment->firstSequence - oldestSequence; });
+   return **(it - 1);
+}
+
+void CSenderJournal::addSegment()
+{
+   SSegment &segment = segments.addSegment();
+
+   segment.firstSequence = oldestSequence + count;
+   SSegmentHeader &segmentHeader = segment.header();
+   segmentHeader.version = journalVersion;
+   segmentHeader.reserved = 0;
+   segmentHeader.firstSequence = segment.firstSequence;
+   memcpy(segmentHeader.magic, journalMagic, sizeof(journalMagic));
+}
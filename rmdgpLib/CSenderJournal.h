@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CSenderJournal.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 6, 2021, 10:20 AM
+ */
+
+#ifndef CSENDERJOURNAL_H
+#define CSENDERJOURNAL_H
+
+#include "../socketLib/CSegmentDirectory.h"
+#include <memory>
+#include <string>
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief An append only journal of sent datagrams in memory mapped segment files, so the
+///        sender can repair far beyond its retransmission ring and keeps its history over a
+///        restart.
+///        A segment is a preallocated file of segmentSize bytes. The records (the datagrams)
+///        grow from the front, the index (the offset of every record) grows from the back, so a
+///        lookup is a subtraction and two loads, and opening a segment is a binary search for
+///        the end of its index. The records before that end are checked as well, the segment
+///        ends at the first damaged one.
+///        append only copies in the mapping, there are no system calls on the send path: the
+///        next segment is made in advance by flush, which also starts the write back and
+///        removes the segments beyond maxSegments. Call flush regularly, for instance from the
+///        timer of the sender.
+///        After a crash of the process everything that was appended is in the files. After a
+///        crash of the machine everything up to the last flush(true) is.
+///        The files are read and written in the byte order of the machine.
+class CSenderJournal {
+public:
+    /// \brief opens the journal in directory and maps the segments that are there, the journal
+    ///        continues after the last datagram in them. Call flush before the first append, so
+    ///        the first segment is made in advance as well.
+    /// \param directory where the segment files are, it is created when it doesn't exist
+    /// \param segmentSize the size of a segment file
+    /// \param maxSegments the number of segments that are kept, the oldest are removed
+    /// \throws std::runtime_error when segmentSize is too small or too large, maxSegments is 0
+    ///         or a file can't be made or mapped
+    CSenderJournal(const std::string &directory, size_t segmentSize = defaultSegmentSize,
+                   size_t maxSegments = defaultMaxSegments);
+    CSenderJournal(const CSenderJournal& orig) = delete;
+    CSenderJournal& operator=(const CSenderJournal& other) = delete;
+    virtual ~CSenderJournal();
+
+    /// \brief adds the datagram with sequence number sequence. Sequence numbers must be
+    ///        consecutive, the first one of an empty journal can be anything.
+    /// \return false when sequence is not getNextSequence() or the datagram doesn't fit in an
+    ///         empty segment
+    /// \throws std::runtime_error when a new segment is needed, the one made in advance is not
+    ///         there and it can't be made
+    bool append(uint64_t sequence, const uint8_t *datagram, size_t length);
+
+    /// \brief finds the datagram with the given sequence number
+    /// \param length receives the length of the datagram
+    /// \return the datagram in the mapping, valid until the next flush, or nullptr when it is
+    ///         not in the journal
+    const uint8_t* lookup(uint64_t sequence, size_t &length) const;
+
+    /// \brief returns true when sequence is in the journal
+    bool contains(uint64_t sequence) const { return sequence - oldestSequence < count; }
+
+    /// \brief starts the write back of what was appended since the previous flush, makes the
+    ///        next segment when there is none or the current one is half full, and removes the
+    ///        oldest segments beyond maxSegments. The page that is being filled is written back
+    ///        when it is full, so append never waits for it.
+    /// \param synchronous true to wait until the appended datagrams are on the disk
+    /// \throws std::runtime_error when OS reports an error.
+    void flush(bool synchronous = false);
+
+    bool isEmpty() const { return count == 0; }
+    uint64_t getOldestSequence() const { return oldestSequence; }
+    uint64_t getNextSequence() const { return oldestSequence + count; }
+    /// \brief returns the number of datagrams in the journal
+    uint64_t getCount() const { return count; }
+    /// \brief returns the number of datagrams that were found when the journal was opened
+    uint64_t getRecoveredCount() const { return recoveredCount; }
+    size_t getSegmentCount() const { return segments.size(); }
+    size_t getSegmentSize() const { return segments.getSegmentSize(); }
+    /// \brief returns the length of the largest datagram that fits in a segment
+    size_t getMaxLength() const;
+    const std::string& getDirectory() const { return segments.getDirectory(); }
+
+    /// \brief 64 MB
+    static constexpr size_t defaultSegmentSize = size_t(64) << 20;
+    static constexpr size_t defaultMaxSegments = 16;
+    /// \brief the segment files are named prefix followed by their number
+    static const std::string filePrefix;
+
+private:
+    /// \brief a mapped segment file with its place in the journal, see CSenderJournal.cpp
+    struct SSegment;
+
+    /// \brief returns the segment that holds sequence, it must be in the journal
+    const SSegment& findSegment(uint64_t sequence) const;
+    /// \brief starts a new segment at the next sequence number
+    void addSegment();
+    /// \brief removes the oldest segments beyond maxSegments
+    void removeOldSegments();
+
+    CSegmentDirectory<SSegment> segments;
+    uint64_t oldestSequence;
+    uint64_t count;
+    uint64_t recoveredCount;
+};
+
+#endif /* CSENDERJOURNAL_H */
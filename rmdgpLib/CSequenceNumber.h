@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CSequenceNumber.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 19, 2021, 2:30 PM
+ */
+
+#ifndef CSEQUENCENUMBER_H
+#define CSEQUENCENUMBER_H
+
+#include <stdint.h>
+
+/// \brief Serial number arithmetic (RFC 1982) for the 64 bit sequence numbers of RMDGP.
+///        Sequence numbers wrap around, a is before b when b is less than half the number space
+///        ahead of a.
+class CSequenceNumber {
+public:
+    static constexpr bool isBefore(uint64_t a, uint64_t b) { return int64_t(a - b) < 0; }
+    static constexpr bool isAfter(uint64_t a, uint64_t b) { return int64_t(a - b) > 0; }
+    static constexpr bool isBeforeOrEqual(uint64_t a, uint64_t b) { return int64_t(a - b) <= 0; }
+    /// \brief returns the number of sequence numbers from a up to b, negative when b is before a
+    static constexpr int64_t distance(uint64_t a, uint64_t b) { return int64_t(b - a); }
+
+    /// \brief comparison object for ordered containers of sequence numbers. All sequence numbers
+    ///        in the container must be less than half the number space apart.
+    struct SLess {
+        constexpr bool operator()(uint64_t a, uint64_t b) const { return isBefore(a, b); }
+    };
+};
+
+/// \brief the sequence numbers from begin up to (excluding) end
+struct SSequenceRange {
+    uint64_t begin;
+    uint64_t end;
+
+    constexpr uint64_t size() const { return end - begin; }
+    constexpr bool contains(uint64_t sequence) const { return sequence - begin < end - begin; }
+    constexpr bool operator==(const SSequenceRange &other) const
+        { return begin == other.begin && end == other.end; }
+    constexpr bool operator!=(const SSequenceRange &other) const { return !(*this == other); }
+};
+
+#endif /* CSEQUENCENUMBER_H */
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CTfmccController.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 5, 2021, 9:10 AM
+ */
+
+#include "CTfmccController.h"
+#include <algorithm>
+#include <math.h>
+#include <sstream>
+#include <stdexcept>
+
+CTfmccController::CTfmccController(size_t segmentSize, double minRate, double maxRate) :
+               segmentSize(segmentSize), minRate(minRate), maxRate(maxRate), receivers(),
+               hasLimiting(false), limitingId(0), maxRtt(), rate(minRate), lastUpdate(),
+               updated(false), slowStart(true), limitingChangeCount(0)
+{
+   if(segmentSize == 0 || !(minRate > 0) || !(maxRate >= minRate))
+   {
+      std::ostringstream message;
+      message << "Error TFMCC segment size " << segmentSize << ", min rate " << minRate
+              << " or max rate " << maxRate;
+      throw std::runtime_error(message.str());
+   }
+}
+
+CTfmccController::~CTfmccController()
+{
+}
+
+double CTfmccController::getTcpRate(size_t segmentSize, const CNanoTime &rtt, double lossRate)
+{
+   if(lossRate <= 0)
+      return INFINITY;
+
+   const double r = std::max(double(rtt.getNsec()), 1.0) / CNanoTime::nsecInSec;
+   const double p = std::min(lossRate, 1.0);
+   return double(segmentSize) / (r * sqrt(2 * p / 3) +
+                                 4 * r * (3 * sqrt(3 * p / 8)) * p * (1 + 32 * p * p));
+}
+
+void CTfmccController::onFeedback(uint32_t receiverId, double lossRate, const CNanoTime &rtt,
+                    const CNanoTime &now)
+{
+   // the increase up to now is at the old rate of the CLR
+   getRate(now);
+
+   const bool hasRtt = rtt > CNanoTime();
+   const std::pair<TReceivers::iterator, bool> result = receivers.emplace(receiverId,
+               SReceiver{ hasRtt ? rtt : defaultRtt, lossRate, INFINITY });
+   SReceiver &receiver = result.first->second;
+   if(!result.second && hasRtt)
+      receiver.rtt += (rtt - receiver.rtt) / 8;
+   if(hasRtt)
+      maxRtt = std::max(maxRtt, rtt);
+   receiver.lossRate = lossRate;
+   const double previous = receiver.rate;
+   receiver.rate = getTcpRate(segmentSize, receiver.rtt, lossRate);
+   if(lossRate > 0)
+      slowStart = false;
+
+   if(hasLimiting && receiverId == limitingId)
+   {
+      if(receiver.rate > previous)
+         findLimiting();
+   }
+   else if(receiver.rate < getLimitingRate())
+   {
+      hasLimiting = true;
+      limitingId = receiverId;
+      limitingChangeCount++;
+   }
+
+   // a decrease is followed at once
+   if(!slowStart)
+      rate = std::max(minRate, std::min(rate, getLimitingRate()));
+}
+
+void CTfmccController::onReceiverRemoved(uint32_t receiverId)
+{
+   if(receivers.erase(receiverId) > 0 && hasLimiting && receiverId == limitingId)
+      findLimiting();
+}
+
+double CTfmccController::getRate(const CNanoTime &now)
+{
+   if(!updated || now <= lastUpdate)
+   {
+      if(!updated)
+         lastUpdate = now;
+      updated = true;
+      return rate;
+   }
+
+   const double seconds = double((now - lastUpdate).getNsec()) / CNanoTime::nsecInSec;
+   const double rtt = double(getRtt().getNsec()) / CNanoTime::nsecInSec;
+   lastUpdate = now;
+   if(slowStart)
+      rate *= pow(2.0, seconds / rtt);
+   else
+   {
+      // one segment per round trip time per round trip time, like TCP congestion avoidance
+      const double target = getLimitingRate();
+      if(rate < target)
+         rate = std::min(target, rate + double(segmentSize) / rtt * seconds / rtt);
+   }
+   rate = std::max(minRate, std::min(maxRate, rate));
+   return rate;
+}
+
+double CTfmccController::getLimitingRate() const
+{
+   return hasLimiting ? receivers.at(limitingId).rate : INFINITY;
+}
+
+void CTfmccController::findLimiting()
+{
+   const uint32_t previousId = limitingId;
+   double lowest = INFINITY;
+
+   hasLimiting = false;
+   for(const TReceivers::value_type &receiver : receivers)
+   {
+      if(receiver.second.rate < lowest)
+      {
+         lowest = receiver.second.rate;
+         limitingId = receiver.first;
+         hasLimiting = true;
+      }
+   }
+   if(hasLimiting && limitingId != previousId)
+      limitingChangeCount++;
+}
+
+CNanoTime CTfmccController::getRtt() const
+{
+   if(hasLimiting)
+      return receivers.at(limitingId).rtt;
+   return (maxRtt > CNanoTime()) ? maxRtt : defaultRtt;
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CTfmccController.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 5, 2021, 9:10 AM
+ */
+
+#ifndef CTFMCCCONTROLLER_H
+#define CTFMCCCONTROLLER_H
+
+#include "CCongestionController.h"
+#include <unordered_map>
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief Equation based congestion control in the style of TFMCC (RFC 4654): the sending
+///        rate follows the TCP throughput equation of TFRC (RFC 5348) for the receiver that
+///        gets the lowest rate, the current limiting receiver (CLR). So the stream takes about
+///        the share of a link that a TCP connection to that receiver would get, but without
+///        the saw tooth of TCP.
+///        Per receiver the round trip time is smoothed (gain 1/8) and its rate is calculated
+///        from it and the loss rate it reports. A receiver with a lower rate than the CLR
+///        becomes the CLR at once; when the rate of the CLR goes up, all receivers are
+///        compared again.
+///        The sending rate goes down to the rate of the CLR at once, and up by at most one
+///        segment per round trip time per round trip time. Until a receiver reports loss the
+///        rate doubles every round trip time (slow start). It stays between minRate and
+///        maxRate.
+class CTfmccController : public CCongestionController {
+public:
+    /// \param segmentSize the typical datagram size in bytes, s in the equation
+    /// \param minRate the lowest rate in bytes per second, also the rate at the start
+    /// \param maxRate the highest rate in bytes per second
+    /// \throws std::runtime_error when a parameter is not positive or maxRate < minRate
+    CTfmccController(size_t segmentSize, double minRate, double maxRate);
+    CTfmccController(const CTfmccController& orig) = delete;
+    CTfmccController& operator=(const CTfmccController& other) = delete;
+    virtual ~CTfmccController();
+
+    void onFeedback(uint32_t receiverId, double lossRate, const CNanoTime &rtt,
+                    const CNanoTime &now) override;
+    void onReceiverRemoved(uint32_t receiverId) override;
+    double getRate(const CNanoTime &now) override;
+
+    /// \brief returns true when there is a current limiting receiver
+    bool hasLimitingReceiver() const { return hasLimiting; }
+    /// \brief returns the id of the current limiting receiver, only valid with
+    ///        hasLimitingReceiver
+    uint32_t getLimitingReceiver() const { return limitingId; }
+    /// \brief returns the calculated rate of the current limiting receiver, in bytes per second,
+    ///        infinite without
+    double getLimitingRate() const;
+    /// \brief returns the number of receivers that gave feedback
+    size_t getReceiverCount() const { return receivers.size(); }
+    /// \brief returns true until a receiver reported loss
+    bool isSlowStart() const { return slowStart; }
+    /// \brief returns the number of times another receiver became the CLR
+    uint64_t getLimitingChangeCount() const { return limitingChangeCount; }
+
+    /// \brief returns the TCP throughput in bytes per second (RFC 5348 section 3.1, b = 1 and
+    ///        t_RTO = 4 * rtt), infinite without loss
+    static double getTcpRate(size_t segmentSize, const CNanoTime &rtt, double lossRate);
+
+    /// \brief the round trip time until a receiver gave a sample
+    static constexpr CNanoTime defaultRtt = CNanoTime::fromMsec(100);
+
+private:
+    struct SReceiver {
+        CNanoTime rtt;
+        double lossRate;
+        double rate;
+    };
+    typedef std::unordered_map<uint32_t, SReceiver> TReceivers;
+
+    /// \brief makes the receiver with the lowest rate the CLR
+    void findLimiting();
+    /// \brief returns the round trip time that paces the increase
+    CNanoTime getRtt() const;
+
+    const size_t segmentSize;
+    const double minRate;
+    const double maxRate;
+    TReceivers receivers;
+    bool hasLimiting;
+    uint32_t limitingId;
+    /// \brief the largest round trip time sample, paces the slow start
+    CNanoTime maxRtt;
+    double rate;
+    CNanoTime lastUpdate;
+    bool updated;
+    bool slowStart;
+    uint64_t limitingChangeCount;
+};
+
+#endif /* CTFMCCCONTROLLER_H */
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CVarInt.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 19, 2021, 3:10 PM
+ */
+
+#ifndef CVARINT_H
+#define CVARINT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief Variable length encoding of unsigned integers (LEB128): 7 bits per byte, least
+///        significant group first, the high bit is set in every byte but the last. Small values,
+///        like the differences between nearby sequence numbers, take one or two bytes.
+class CVarInt {
+public:
+    /// \brief the largest encoding, of a 64 bit value
+    static constexpr size_t maxSize = 10;
+
+    /// \brief returns the number of bytes that value takes
+    static constexpr size_t size(uint64_t value)
+    {
+        size_t bytes = 1;
+        while(value >= 0x80)
+        {
+            value >>= 7;
+            bytes++;
+        }
+        return bytes;
+    }
+
+    /// \brief writes value at buffer
+    /// \return the number of bytes written, 0 when it doesn't fit in bufferSize bytes
+    static size_t encode(uint8_t *buffer, size_t bufferSize, uint64_t value)
+    {
+        size_t bytes = 0;
+
+        while(bytes < bufferSize)
+        {
+            if(value < 0x80)
+            {
+                buffer[bytes++] = uint8_t(value);
+                return bytes;
+            }
+            buffer[bytes++] = uint8_t(value | 0x80);
+            value >>= 7;
+        }
+        return 0;
+    }
+
+    /// \brief reads a value from buffer
+    /// \return the number of bytes read, 0 when the encoding is truncated or too long
+    static size_t decode(const uint8_t *buffer, size_t bufferSize, uint64_t &value)
+    {
+        uint64_t result = 0;
+
+        for(size_t bytes = 0; bytes < bufferSize && bytes < maxSize; bytes++)
+        {
+            result |= uint64_t(buffer[bytes] & 0x7f) << (7 * bytes);
+            if((buffer[bytes] & 0x80) == 0)
+            {
+                value = result;
+                return bytes + 1;
+            }
+        }
+        return 0;
+    }
+};
+
+#endif /* CVARINT_H */
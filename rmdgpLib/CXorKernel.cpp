@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CXorKernel.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 30, 2021, 8:10 PM
+ */
+
+#include "CXorKernel.h"
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace {
+   /// \brief 8 bytes at a time, memcpy makes the unaligned loads and stores legal
+   void xorScalar(uint8_t *target, const uint8_t *source, size_t length)
+   {
+      size_t i = 0;
+
+      for(; i + 8 <= length; i += 8)
+      {
+         uint64_t a, b;
+         memcpy(&a, target + i, 8);
+         memcpy(&b, source + i, 8);
+         a ^= b;
+         memcpy(target + i, &a, 8);
+      }
+      for(; i < length; i++)
+         target[i] ^= source[i];
+   }
+
+#if defined(__x86_64__)
+   /// \brief SSE2 is part of x86_64, so this one is always there
+   void xorSse2(uint8_t *target, const uint8_t *source, size_t length)
+   {
+      size_t i = 0;
+
+      for(; i + 64 <= length; i += 64)
+      {
+         for(size_t j = 0; j < 64; j += 16)
+         {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(target + i + j));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + j));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i + j), _mm_xor_si128(a, b));
+         }
+      }
+      for(; i + 16 <= length; i += 16)
+      {
+         const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(target + i));
+         const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i), _mm_xor_si128(a, b));
+      }
+      xorScalar(target + i, source + i, length - i);
+   }
+
+   /// \brief compiled for AVX2 without changing the flags of the rest of the build, only
+   ///        called when the CPU has it
+   __attribute__((target("avx2")))
+   void xorAvx2(uint8_t *target, const uint8_t *source, size_t length)
+   {
+      size_t i = 0;
+
+      for(; i + 128 <= length; i += 128)
+      {
+         for(size_t j = 0; j < 128; j += 32)
+         {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(target + i + j));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i + j));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + i + j),
+                                _mm256_xor_si256(a, b));
+         }
+      }
+      for(; i + 32 <= length; i += 32)
+      {
+         const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(target + i));
+         const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+         _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + i), _mm256_xor_si256(a, b));
+      }
+      xorScalar(target + i, source + i, length - i);
+   }
+#endif
+
+   CXorKernel::EKernel selectKernel()
+   {
+      if(CXorKernel::isSupported(CXorKernel::EKernel::avx2))
+         return CXorKernel::EKernel::avx2;
+      if(CXorKernel::isSupported(CXorKernel::EKernel::sse2))
+         return CXorKernel::EKernel::sse2;
+      return CXorKernel::EKernel::scalar;
+   }
+}
+
+void CXorKernel::xorInto(EKernel kernel, uint8_t *target, const uint8_t *source, size_t length)
+{
+   if(!isSupported(kernel))
+   {
+      std::ostringstream message;
+      message << "Error xor kernel " << getName(kernel) << " is not supported by this CPU";
+      throw std::runtime_error(message.str());
+   }
+   getFunction(kernel)(target, source, length);
+}
+
+bool CXorKernel::isSupported(EKernel kernel)
+{
+   switch(kernel)
+   {
+      case EKernel::scalar:
+         return true;
+#if defined(__x86_64__)
+      case EKernel::sse2:
+         return true;
+      case EKernel::avx2:
+         // also called by a static initializer, maybe before the one of libgcc
+         __builtin_cpu_init();
+         return __builtin_cpu_supports("avx2");
+#endif
+      default:
+         return false;
+   }
+}
+
+CXorKernel::EKernel CXorKernel::getSelected()
+{
+   return selectKernel();
+}
+
+const char* CXorKernel::getName(EKernel kernel)
+{
+   switch(kernel)
+   {
+      case EKernel::scalar:
+         return "scalar";
+      case EKernel::sse2:
+         return "sse2";
+      case EKernel::avx2:
+         return "avx2";
+   }
+   return "unknown";
+}
+
+CXorKernel::TXorFunction CXorKernel::getFunction(EKernel kernel)
+{
+   switch(kernel)
+   {
+#if defined(__x86_64__)
+      case EKernel::sse2:
+         return xorSse2;
+      case EKernel::avx2:
+         return xorAvx2;
+#endif
+      default:
+         return xorScalar;
+   }
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CXorKernel.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 30, 2021, 8:10 PM
+ */
+
+#ifndef CXORKERNEL_H
+#define CXORKERNEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief XORs one buffer into another, the inner loop of the parity FEC. There is a portable
+///        scalar version that works on 64 bit words, and on x86_64 an SSE2 and an AVX2 version.
+///        xorInto uses the fastest one the CPU supports, chosen at the first call.
+class CXorKernel {
+public:
+    /// \brief the implementations
+    enum class EKernel {
+        scalar,
+        sse2,
+        avx2
+    };
+
+    /// \brief target[i] ^= source[i] for i in [0, length), with the fastest kernel. The buffers
+    ///        need no alignment, but must not overlap.
+    static void xorInto(uint8_t *target, const uint8_t *source, size_t length)
+    {
+        static const TXorFunction selected = getFunction(getSelected());
+
+        selected(target, source, length);
+    }
+
+    /// \brief the same with a given kernel, for tests and benchmarks
+    /// \throws std::runtime_error when the CPU doesn't support kernel
+    static void xorInto(EKernel kernel, uint8_t *target, const uint8_t *source, size_t length);
+
+    /// \brief returns true when the CPU supports kernel
+    static bool isSupported(EKernel kernel);
+    /// \brief returns the kernel that xorInto uses
+    static EKernel getSelected();
+    static const char* getName(EKernel kernel);
+
+private:
+    typedef void (*TXorFunction)(uint8_t *target, const uint8_t *source, size_t length);
+    static TXorFunction getFunction(EKernel kernel);
+};
+
+#endif /* CXORKERNEL_H */
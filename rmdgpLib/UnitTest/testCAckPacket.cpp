@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCAckPacket.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 25, 2021, 8:30 PM
+ */
+
+#include "testCAckPacket.h"
+#include "../CAckPacket.h"
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCAckPacket);
+
+testCAckPacket::testCAckPacket()
+{
+}
+
+testCAckPacket::~testCAckPacket()
+{
+}
+
+void testCAckPacket::setUp()
+{
+}
+
+void testCAckPacket::tearDown()
+{
+}
+
+void testCAckPacket::testBuildAndRead()
+{
+   uint8_t datagram[1472];
+   const SSequenceRange ranges[] = { { 1001, 1002 }, { 1005, 1100 }, { 1100000, 1100002 } };
+   SSequenceRange range;
+
+   CAckBuilder builder(datagram, sizeof(datagram), 77, 3, 300, 1000);
+   for(const SSequenceRange &r : ranges)
+      CPPUNIT_ASSERT(builder.add(r));
+   CPPUNIT_ASSERT_EQUAL(size_t(3), builder.getRangeCount());
+   // id 300: 2 bytes, hold time 0: 1 byte, then 0,0 2,94 1098899,1: 1 + 1 + 1 + 1 + 3 + 1 bytes
+   CPPUNIT_ASSERT_EQUAL(CRmdgpHeader::size + 11, builder.getLength());
+
+   CPPUNIT_ASSERT(ERmdgpValidation::valid ==
+                  CRmdgpHeaderView::validate(datagram, builder.getLength()));
+   const CRmdgpHeaderView header(datagram);
+   CPPUNIT_ASSERT(ERmdgpPacketType::ack == header.getType());
+   CPPUNIT_ASSERT_EQUAL(uint32_t(77), header.getSessionId());
+   CPPUNIT_ASSERT_EQUAL(uint32_t(3), header.getStreamId());
+
+   CAckReader reader(datagram, builder.getLength());
+   CPPUNIT_ASSERT_EQUAL(uint32_t(300), reader.getReceiverId());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1000), reader.getCumulativeAck());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(), reader.getHoldTime());
+   for(const SSequenceRange &r : ranges)
+   {
+      CPPUNIT_ASSERT(reader.next(range));
+      CPPUNIT_ASSERT_EQUAL(r.begin, range.begin);
+      CPPUNIT_ASSERT_EQUAL(r.end, range.end);
+   }
+   CPPUNIT_ASSERT(!reader.next(range));
+   CPPUNIT_ASSERT(!reader.isMalformed());
+}
+
+void testCAckPacket::testNoRanges()
+{
+   uint8_t datagram[100];
+   SSequenceRange range;
+
+   // a receiver without losses only sends the cumulative acknowledgement
+   CAckBuilder builder(datagram, sizeof(datagram), 1, 1, UINT32_MAX, 123456789);
+   CPPUNIT_ASSERT_EQUAL(CRmdgpHeader::size + 6, builder.getLength());
+   CPPUNIT_ASSERT(ERmdgpValidation::valid ==
+                  CRmdgpHeaderView::validate(datagram, builder.getLength()));
+
+   CAckReader reader(datagram, builder.getLength());
+   CPPUNIT_ASSERT_EQUAL(UINT32_MAX, reader.getReceiverId());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(123456789), reader.getCumulativeAck());
+   CPPUNIT_ASSERT(!reader.next(range));
+   CPPUNIT_ASSERT(!reader.isMalformed());
+}
+
+void testCAckPacket::testLossRate()
+{
+   uint8_t datagram[100];
+
+   CAckBuilder builder(datagram, sizeof(datagram), 1, 1, 7, 1000);
+   CPPUNIT_ASSERT(!CAckReader(datagram, builder.getLength()).hasLossRate());
+   CPPUNIT_ASSERT_EQUAL(-1.0, CAckReader(datagram, builder.getLength()).getLossRate());
+
+   builder.setLossRate(0.0123);
+   CPPUNIT_ASSERT(builder.add({ 1001, 1002 }));
+   CPPUNIT_ASSERT(ERmdgpValidation::valid ==
+                  CRmdgpHeaderView::validate(datagram, builder.getLength()));
+   CPPUNIT_ASSERT(CRmdgpHeaderView(datagram).hasFlag(rmdgpFlagLossReport));
+   CAckReader reader(datagram, builder.getLength());
+   CPPUNIT_ASSERT(reader.hasLossRate());
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0123, reader.getLossRate(), 1.0 / CAckBuilder::lossRateScale);
+   CPPUNIT_ASSERT_EQUAL(uint32_t(7), reader.getReceiverId());
+
+   // out of range rates are clamped
+   builder.setLossRate(2.0);
+   CPPUNIT_ASSERT_EQUAL(1.0, CAckReader(datagram, builder.getLength()).getLossRate());
+   builder.setLossRate(-1.0);
+   CPPUNIT_ASSERT_EQUAL(0.0, CAckReader(datagram, builder.getLength()).getLossRate());
+}
+
+void testCAckPacket::testHoldTime()
+{
+   uint8_t datagram[100];
+   SSequenceRange range;
+
+   // the hold time is sent in whole microseconds
+   CAckBuilder builder(datagram, sizeof(datagram), 1, 1, 7, 1000, CNanoTime(0, 1500999));
+   CPPUNIT_ASSERT(builder.add({ 1001, 1002 }));
+   CPPUNIT_ASSERT(ERmdgpValidation::valid ==
+                  CRmdgpHeaderView::validate(datagram, builder.getLength()));
+   CAckReader reader(datagram, builder.getLength());
+   CPPUNIT_ASSERT_EQUAL(uint32_t(7), reader.getReceiverId());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromUsec(1500), reader.getHoldTime());
+   CPPUNIT_ASSERT(reader.next(range));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1001), range.begin);
+   CPPUNIT_ASSERT(!reader.isMalformed());
+
+   // out of range hold times are clamped
+   CAckBuilder longHold(datagram, sizeof(datagram), 1, 1, 7, 1000, CNanoTime::fromSec(3600));
+   CPPUNIT_ASSERT_EQUAL(CAckBuilder::maxHoldTime,
+                        CAckReader(datagram, longHold.getLength()).getHoldTime());
+   CAckBuilder negative(datagram, sizeof(datagram), 1, 1, 7, 1000, CNanoTime::fromMsec(-1));
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(), CAckReader(datagram, negative.getLength()).getHoldTime());
+}
+
+void testCAckPacket::testWrapAround()
+{
+   uint8_t datagram[100];
+   SSequenceRange range;
+
+   CAckBuilder builder(datagram, sizeof(datagram), 1, 1, 1, UINT64_MAX - 3);
+   CPPUNIT_ASSERT(builder.add({ UINT64_MAX - 2, 2 }));
+   CPPUNIT_ASSERT(builder.add({ 4, 5 }));
+
+   CAckReader reader(datagram, builder.getLength());
+   CPPUNIT_ASSERT(reader.next(range));
+   CPPUNIT_ASSERT_EQUAL(UINT64_MAX - 2, range.begin);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(2), range.end);
+   CPPUNIT_ASSERT(reader.next(range));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), range.begin);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), range.size());
+}
+
+void testCAckPacket::testRejectedRanges()
+{
+   uint8_t datagram[100];
+
+   CAckBuilder builder(datagram, sizeof(datagram), 1, 1, 1, 10);
+   CPPUNIT_ASSERT(!builder.add({ 12, 12 }));
+   // the cumulative acknowledgement itself is missing
+   CPPUNIT_ASSERT(!builder.add({ 10, 20 }));
+   CPPUNIT_ASSERT(!builder.add({ 5, 20 }));
+   CPPUNIT_ASSERT(builder.add({ 11, 20 }));
+   // received ranges are separated by a missing sequence number
+   CPPUNIT_ASSERT(!builder.add({ 20, 25 }));
+   CPPUNIT_ASSERT(!builder.add({ 15, 25 }));
+   CPPUNIT_ASSERT(builder.add({ 21, 25 }));
+   CPPUNIT_ASSERT_EQUAL(size_t(2), builder.getRangeCount());
+
+   // no room for a range at all
+   CAckBuilder small(datagram, CRmdgpHeader::size + 2, 1, 1, 1, 10);
+   CPPUNIT_ASSERT(!small.add({ 11, 12 }));
+   CPPUNIT_ASSERT_EQUAL(CRmdgpHeader::size + 2, small.getLength());
+}
+
+void testCAckPacket::testMalformed()
+{
+   uint8_t datagram[100];
+   SSequenceRange range;
+
+   CAckBuilder builder(datagram, sizeof(datagram), 1, 1, 1000, 10);
+   builder.add({ 11, 20 });
+   builder.add({ 1000, 2000 });
+
+   // cut in the middle of the last varint
+   CAckReader truncated(datagram, builder.getLength() - 1);
+   CPPUNIT_ASSERT(truncated.next(range));
+   CPPUNIT_ASSERT(!truncated.next(range));
+   CPPUNIT_ASSERT(truncated.isMalformed());
+
+   // no receiver id
+   CAckReader noId(datagram, CRmdgpHeader::size + 1);
+   CPPUNIT_ASSERT(noId.isMalformed());
+   CPPUNIT_ASSERT(!noId.next(range));
+
+   // no hold time
+   CAckBuilder noHold(datagram, sizeof(datagram), 1, 1, 1, 10);
+   CPPUNIT_ASSERT(noHold.add({ 11, 20 }));
+   CPPUNIT_ASSERT(!CAckReader(datagram, noHold.getLength()).isMalformed());
+   CPPUNIT_ASSERT(CAckReader(datagram, CRmdgpHeader::size + 1).isMalformed());
+
+   // a hold time beyond maxHoldTime
+   const uint8_t tooLong[] = { 0x01, 0xff, 0xff, 0xff, 0xff, 0x7f };
+   for(size_t i = 0; i < sizeof(tooLong); i++)
+      datagram[CRmdgpHeader::size + i] = tooLong[i];
+   CPPUNIT_ASSERT(CAckReader(datagram, CRmdgpHeader::size + sizeof(tooLong)).isMalformed());
+
+   // a receiver id larger than 32 bits
+   const uint8_t tooLarge[] = { 0xff, 0xff, 0xff, 0xff, 0x7f };
+   for(size_t i = 0; i < sizeof(tooLarge); i++)
+      datagram[CRmdgpHeader::size + i] = tooLarge[i];
+   CAckReader largeId(datagram, CRmdgpHeader::size + sizeof(tooLarge));
+   CPPUNIT_ASSERT(largeId.isMalformed());
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCAckPacket.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 25, 2021, 8:30 PM
+ */
+
+#ifndef TESTCACKPACKET_H
+#define TESTCACKPACKET_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class testCAckPacket : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCAckPacket);
+
+    CPPUNIT_TEST(testBuildAndRead);
+    CPPUNIT_TEST(testNoRanges);
+    CPPUNIT_TEST(testLossRate);
+    CPPUNIT_TEST(testHoldTime);
+    CPPUNIT_TEST(testWrapAround);
+    CPPUNIT_TEST(testRejectedRanges);
+    CPPUNIT_TEST(testMalformed);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCAckPacket();
+    virtual ~testCAckPacket();
+    void setUp();
+    void tearDown();
+
+private:
+    void testBuildAndRead();
+    void testNoRanges();
+    void testLossRate();
+    void testHoldTime();
+    void testWrapAround();
+    void testRejectedRanges();
+    void testMalformed();
+};
+
+#endif /* TESTCACKPACKET_H */
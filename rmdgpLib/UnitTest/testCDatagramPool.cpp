@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCDatagramPool.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 22, 2021, 9:10 PM
+ */
+
+#include "testCDatagramPool.h"
+#include "../CDatagramPool.h"
+#include <set>
+#include <stdexcept>
+#include <string.h>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCDatagramPool);
+
+testCDatagramPool::testCDatagramPool()
+{
+}
+
+testCDatagramPool::~testCDatagramPool()
+{
+}
+
+void testCDatagramPool::setUp()
+{
+}
+
+void testCDatagramPool::tearDown()
+{
+}
+
+void testCDatagramPool::testAcquireRelease()
+{
+   CDatagramPool pool(3, 100);
+   std::set<uint32_t> handles;
+
+   CPPUNIT_ASSERT_EQUAL(size_t(3), pool.getFreeCount());
+   for(int i = 0; i < 3; i++)
+      handles.insert(pool.acquire());
+   CPPUNIT_ASSERT_EQUAL(size_t(3), handles.size());
+   CPPUNIT_ASSERT(handles.count(CDatagramPool::invalidHandle) == 0);
+   CPPUNIT_ASSERT_EQUAL(size_t(0), pool.getFreeCount());
+   CPPUNIT_ASSERT_EQUAL(CDatagramPool::invalidHandle, pool.acquire());
+
+   pool.release(1);
+   CPPUNIT_ASSERT_EQUAL(uint32_t(1), pool.acquire());
+}
+
+void testCDatagramPool::testBuffers()
+{
+   CDatagramPool pool(4, 100);
+   uint32_t handles[4];
+
+   for(uint32_t i = 0; i < 4; i++)
+   {
+      handles[i] = pool.acquire();
+      uint8_t *buffer = pool.getBuffer(handles[i]);
+      CPPUNIT_ASSERT_EQUAL(size_t(0), reinterpret_cast<uintptr_t>(buffer) %
+                                      CDatagramPool::cacheLineSize);
+      memset(buffer, int(i), pool.getBufferSize());
+   }
+   // the buffers don't overlap
+   for(uint32_t i = 0; i < 4; i++)
+   {
+      CPPUNIT_ASSERT_EQUAL(uint8_t(i), pool.getBuffer(handles[i])[0]);
+      CPPUNIT_ASSERT_EQUAL(uint8_t(i), pool.getBuffer(handles[i])[99]);
+   }
+}
+
+void testCDatagramPool::testConstructorException()
+{
+   CPPUNIT_ASSERT_THROW(CDatagramPool(0, 100), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CDatagramPool(10, 0), std::runtime_error);
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCDatagramPool.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 22, 2021, 9:10 PM
+ */
+
+#ifndef TESTCDATAGRAMPOOL_H
+#define TESTCDATAGRAMPOOL_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class testCDatagramPool : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCDatagramPool);
+
+    CPPUNIT_TEST(testAcquireRelease);
+    CPPUNIT_TEST(testBuffers);
+    CPPUNIT_TEST(testConstructorException);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCDatagramPool();
+    virtual ~testCDatagramPool();
+    void setUp();
+    void tearDown();
+
+private:
+    void testAcquireRelease();
+    void testBuffers();
+    void testConstructorException();
+};
+
+#endif /* TESTCDATAGRAMPOOL_H */
@@ -0,0 +1,345 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCDeliveryLog.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 7, 2021, 10:30 AM
+ */
+
+#include "testCDeliveryLog.h"
+#include "../CDeliveryLog.h"
+#include "../../socketLib/CMappedFile.h"
+#include <stdexcept>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+   const size_t segmentSize = 64 * 1024;
+
+   /// \brief a message of length bytes that tells its sequence number
+   std::vector<uint8_t> makeMessage(uint64_t sequence, size_t length)
+   {
+      std::vector<uint8_t> message(length);
+      for(size_t i = 0; i < length; i++)
+         message[i] = uint8_t(sequence * 7 + i);
+      return message;
+   }
+
+   void appendAndVerify(CDeliveryLog &log, uint64_t sequence, size_t length)
+   {
+      const std::vector<uint8_t> message = makeMessage(sequence, length);
+      CPPUNIT_ASSERT(log.append(sequence, message.data(), message.size()));
+   }
+
+   /// \brief reads the log from first and checks that the messages are the expected ones
+   void replayAndVerify(const CDeliveryLog &log, uint64_t first,
+                    const std::vector<uint64_t> &expected, size_t expectedLength)
+   {
+      CDeliveryLog::SPosition position = log.seek(first);
+      CDeliveryLog::SRecord record;
+
+      for(uint64_t sequence : expected)
+      {
+         CPPUNIT_ASSERT(log.next(position, record));
+         CPPUNIT_ASSERT_EQUAL(sequence, record.sequence);
+         CPPUNIT_ASSERT_EQUAL(expectedLength, record.length);
+         CPPUNIT_ASSERT(makeMessage(sequence, expectedLength) ==
+                        std::vector<uint8_t>(record.data, record.data + record.length));
+      }
+      CPPUNIT_ASSERT(!log.next(position, record));
+   }
+
+   std::vector<uint64_t> range(uint64_t begin, uint64_t end)
+   {
+      std::vector<uint64_t> sequences;
+      for(uint64_t sequence = begin; sequence != end; sequence++)
+         sequences.push_back(sequence);
+      return sequences;
+   }
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCDeliveryLog);
+
+testCDeliveryLog::testCDeliveryLog()
+{
+}
+
+testCDeliveryLog::~testCDeliveryLog()
+{
+}
+
+void testCDeliveryLog::setUp()
+{
+   char name[] = "/tmp/testCDeliveryLog-XXXXXX";
+
+   CPPUNIT_ASSERT(mkdtemp(name) != nullptr);
+   directory = name;
+}
+
+void testCDeliveryLog::tearDown()
+{
+   for(const std::string &name : CMappedFile::list(directory, ""))
+      unlink((directory + "/" + name).c_str());
+   rmdir(directory.c_str());
+}
+
+void testCDeliveryLog::testAppendAndReplay()
+{
+   CDeliveryLog log(directory, segmentSize);
+   CDeliveryLog::SPosition position = log.seek(0);
+   CDeliveryLog::SRecord record;
+
+   CPPUNIT_ASSERT(log.isEmpty());
+   CPPUNIT_ASSERT(!log.next(position, record));
+
+   // a lost datagram leaves a gap
+   std::vector<uint64_t> expected;
+   for(uint64_t sequence = 500; sequence < 540; sequence++)
+   {
+      if(sequence % 10 == 3)
+         continue;
+      appendAndVerify(log, sequence, 100);
+      expected.push_back(sequence);
+   }
+   CPPUNIT_ASSERT_EQUAL(uint64_t(36), log.getCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(500), log.getOldestSequence());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(540), log.getNextSequence());
+   replayAndVerify(log, 0, expected, 100);
+   replayAndVerify(log, 500, expected, 100);
+   // the seek of a missing one finds the next
+   replayAndVerify(log, 513, std::vector<uint64_t>(expected.begin() + 12, expected.end()), 100);
+   replayAndVerify(log, 540, {}, 100);
+
+   // going back is refused, a message that is not logged can move the watermark
+   const std::vector<uint8_t> message = makeMessage(520, 100);
+   CPPUNIT_ASSERT(!log.append(520, message.data(), message.size()));
+   CPPUNIT_ASSERT(!log.append(600, message.data(), log.getMaxLength() + 1));
+   log.advance(545);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(545), log.getNextSequence());
+   log.advance(541);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(545), log.getNextSequence());
+   CPPUNIT_ASSERT(!log.append(544, message.data(), message.size()));
+   appendAndVerify(log, 545, 100);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(546), log.getNextSequence());
+
+   // nothing is durable before flush(true)
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), log.getDurableSequence());
+   log.flush(true);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(546), log.getDurableSequence());
+}
+
+void testCDeliveryLog::testRollover()
+{
+   const size_t length = 1000;
+   const uint64_t perSegment = (segmentSize - 4096) / (length + 16);
+   CDeliveryLog log(directory, segmentSize, 3);
+
+   for(uint64_t sequence = 0; sequence < perSegment * 5; sequence++)
+   {
+      appendAndVerify(log, sequence, length);
+      if(sequence % 10 == 0)
+         log.flush();
+   }
+   log.flush();
+
+   // the two oldest segments are gone
+   CPPUNIT_ASSERT_EQUAL(size_t(3), log.getSegmentCount());
+   CPPUNIT_ASSERT_EQUAL(perSegment * 2, log.getOldestSequence());
+   CPPUNIT_ASSERT_EQUAL(perSegment * 3, log.getCount());
+   replayAndVerify(log, 0, range(perSegment * 2, perSegment * 5), length);
+   replayAndVerify(log, perSegment * 4 - 1, range(perSegment * 4 - 1, perSegment * 5), length);
+   // three segments and the spare one
+   CPPUNIT_ASSERT_EQUAL(size_t(4), CMappedFile::list(directory, CDeliveryLog::filePrefix).size());
+}
+
+void testCDeliveryLog::testResume()
+{
+   const size_t length = 1000;
+   const uint64_t perSegment = (segmentSize - 4096) / (length + 16);
+   const uint64_t first = UINT64_MAX - perSegment;
+   const uint64_t end = first + perSegment * 2 + 5;
+
+   {
+      CDeliveryLog log(directory, segmentSize);
+      for(uint64_t sequence = first; sequence != end; sequence++)
+         appendAndVerify(log, sequence, length);
+      log.advance(end + 10);
+      log.flush(true);
+   }
+
+   // the sequence numbers wrap around in the log
+   CDeliveryLog log(directory, segmentSize);
+   CPPUNIT_ASSERT_EQUAL(size_t(3), log.getSegmentCount());
+   CPPUNIT_ASSERT_EQUAL(perSegment * 2 + 5, log.getRecoveredCount());
+   CPPUNIT_ASSERT_EQUAL(first, log.getOldestSequence());
+   CPPUNIT_ASSERT_EQUAL(end + 10, log.getNextSequence());
+   CPPUNIT_ASSERT_EQUAL(end + 10, log.getDurableSequence());
+   replayAndVerify(log, first, range(first, end), length);
+   replayAndVerify(log, 3, range(3, end), length);
+
+   // the log continues after the watermark
+   appendAndVerify(log, end + 10, length);
+   replayAndVerify(log, end - 1, { end - 1, end + 10 }, length);
+}
+
+void testCDeliveryLog::testUnsyncedTail()
+{
+   {
+      CDeliveryLog log(directory, segmentSize);
+      for(uint64_t sequence = 0; sequence < 20; sequence++)
+         appendAndVerify(log, sequence, 100);
+      log.flush(true);
+      // these are in the file, but the header doesn't cover them
+      for(uint64_t sequence = 20; sequence < 30; sequence++)
+         appendAndVerify(log, sequence, 100);
+      log.advance(40);
+      log.flush();
+   }
+
+   CDeliveryLog log(directory, segmentSize);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(20), log.getRecoveredCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(20), log.getNextSequence());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(20), log.getDurableSequence());
+   replayAndVerify(log, 0, range(0, 20), 100);
+
+   // the new records overwrite the old tail
+   appendAndVerify(log, 20, 300);
+   replayAndVerify(log, 20, { 20 }, 300);
+}
+
+void testCDeliveryLog::testRestartedStream()
+{
+   {
+      CDeliveryLog log(directory, segmentSize);
+      for(uint64_t sequence = 1000; sequence < 1010; sequence++)
+         appendAndVerify(log, sequence, 100);
+      log.flush(true);
+   }
+
+   // a spare segment that was never used is kept for the next messages
+   {
+      CMappedFile file(directory + "/" + CDeliveryLog::filePrefix + "0000000000000001",
+                       segmentSize);
+   }
+   {
+      CDeliveryLog log(directory, segmentSize);
+      CPPUNIT_ASSERT_EQUAL(size_t(1), log.getSegmentCount());
+      CPPUNIT_ASSERT_EQUAL(uint64_t(10), log.getRecoveredCount());
+   }
+
+   // a segment that starts before the end of the previous one belongs to a new stream, the
+   // old segments are removed
+   {
+      CDeliveryLog log(directory + "/other", segmentSize);
+      for(uint64_t sequence = 5; sequence < 8; sequence++)
+         appendAndVerify(log, sequence, 100);
+      log.flush(true);
+   }
+   CPPUNIT_ASSERT_EQUAL(0, rename((directory + "/other/" + CDeliveryLog::filePrefix +
+                                   "0000000000000000").c_str(),
+                                  (directory + "/" + CDeliveryLog::filePrefix +
+                                   "0000000000000002").c_str()));
+   rmdir((directory + "/other").c_str());
+
+   CDeliveryLog log(directory, segmentSize);
+   CPPUNIT_ASSERT_EQUAL(size_t(1), log.getSegmentCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(5), log.getOldestSequence());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(8), log.getNextSequence());
+   replayAndVerify(log, 0, range(5, 8), 100);
+   CPPUNIT_ASSERT_EQUAL(size_t(1), CMappedFile::list(directory, CDeliveryLog::filePrefix).size());
+}
+
+void testCDeliveryLog::testSession()
+{
+   {
+      CDeliveryLog log(directory, segmentSize);
+      CPPUNIT_ASSERT(!log.hasSession());
+      log.setSession(9, 5);
+      for(uint64_t sequence = 100; sequence < 110; sequence++)
+         appendAndVerify(log, sequence, 100);
+      log.flush(true);
+   }
+
+   // the session is in the segments
+   {
+      CDeliveryLog log(directory, segmentSize);
+      CPPUNIT_ASSERT(log.hasSession());
+      CPPUNIT_ASSERT_EQUAL(uint32_t(9), log.getSessionId());
+      CPPUNIT_ASSERT_EQUAL(uint32_t(5), log.getStreamId());
+      CPPUNIT_ASSERT_EQUAL(uint64_t(10), log.getRecoveredCount());
+      // the same session continues
+      log.setSession(9, 5);
+      CPPUNIT_ASSERT_EQUAL(uint64_t(110), log.getNextSequence());
+      appendAndVerify(log, 110, 100);
+      replayAndVerify(log, 100, range(100, 111), 100);
+
+      // a new session starts an empty log
+      log.setSession(10, 5);
+      CPPUNIT_ASSERT(log.isEmpty());
+      CPPUNIT_ASSERT_EQUAL(size_t(0), log.getSegmentCount());
+      appendAndVerify(log, 7, 100);
+      log.flush(true);
+   }
+
+   {
+      CDeliveryLog log(directory, segmentSize);
+      CPPUNIT_ASSERT_EQUAL(uint32_t(10), log.getSessionId());
+      CPPUNIT_ASSERT_EQUAL(uint64_t(8), log.getNextSequence());
+      replayAndVerify(log, 0, { 7 }, 100);
+   }
+
+   // a segment of an other session was written after a restart without the log, the history
+   // before it doesn't belong to it
+   {
+      CDeliveryLog other(directory + "/other", segmentSize);
+      other.setSession(11, 5);
+      for(uint64_t sequence = 20; sequence < 23; sequence++)
+         appendAndVerify(other, sequence, 100);
+      other.flush(true);
+   }
+   CPPUNIT_ASSERT_EQUAL(0, rename((directory + "/other/" + CDeliveryLog::filePrefix +
+                                   "0000000000000000").c_str(),
+                                  (directory + "/" + CDeliveryLog::filePrefix +
+                                   "00000000000000ff").c_str()));
+   rmdir((directory + "/other").c_str());
+
+   CDeliveryLog log(directory, segmentSize);
+   CPPUNIT_ASSERT_EQUAL(uint32_t(11), log.getSessionId());
+   CPPUNIT_ASSERT_EQUAL(size_t(1), log.getSegmentCount());
+   replayAndVerify(log, 0, range(20, 23), 100);
+}
+
+void testCDeliveryLog::testException()
+{
+   CPPUNIT_ASSERT_THROW(CDeliveryLog(directory, 1000), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CDeliveryLog(directory, segmentSize, 0), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CDeliveryLog("/proc/self/missing/log"), std::runtime_error);
+
+   // a file with the name of a segment that is no segment
+   {
+      CMappedFile file(directory + "/" + CDeliveryLog::filePrefix + "0000000000000001",
+                       segmentSize);
+      memcpy(file.getData(), "garbage", 7);
+   }
+   CPPUNIT_ASSERT_THROW(CDeliveryLog(directory, segmentSize), std::runtime_error);
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCDeliveryLog.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 7, 2021, 10:30 AM
+ */
+
+#ifndef TESTCDELIVERYLOG_H
+#define TESTCDELIVERYLOG_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+class testCDeliveryLog : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCDeliveryLog);
+
+    CPPUNIT_TEST(testAppendAndReplay);
+    CPPUNIT_TEST(testRollover);
+    CPPUNIT_TEST(testResume);
+    CPPUNIT_TEST(testUnsyncedTail);
+    CPPUNIT_TEST(testRestartedStream);
+    CPPUNIT_TEST(testSession);
+    CPPUNIT_TEST(testException);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCDeliveryLog();
+    virtual ~testCDeliveryLog();
+    void setUp();
+    void tearDown();
+
+private:
+    void testAppendAndReplay();
+    void testRollover();
+    void testResume();
+    void testUnsyncedTail();
+    void testRestartedStream();
+    void testSession();
+    void testException();
+
+    /// \brief a new directory for every test
+    std::string directory;
+};
+
+#endif /* TESTCDELIVERYLOG_H */
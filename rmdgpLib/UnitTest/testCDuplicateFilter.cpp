@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCDuplicateFilter.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 24, 2021, 8:40 PM
+ */
+
+#include "testCDuplicateFilter.h"
+#include "../CDuplicateFilter.h"
+#include <stdexcept>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCDuplicateFilter);
+
+typedef CDuplicateFilter::EResult EResult;
+
+testCDuplicateFilter::testCDuplicateFilter()
+{
+}
+
+testCDuplicateFilter::~testCDuplicateFilter()
+{
+}
+
+void testCDuplicateFilter::setUp()
+{
+}
+
+void testCDuplicateFilter::tearDown()
+{
+}
+
+void testCDuplicateFilter::testConstructor()
+{
+   CPPUNIT_ASSERT_EQUAL(size_t(64), CDuplicateFilter(1).getWindow());
+   CPPUNIT_ASSERT_EQUAL(size_t(128), CDuplicateFilter(65).getWindow());
+   CPPUNIT_ASSERT_EQUAL(size_t(4096), CDuplicateFilter(4096, 7).getWindow());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(7), CDuplicateFilter(4096, 7).getBase());
+   CPPUNIT_ASSERT_THROW(CDuplicateFilter(0), std::runtime_error);
+}
+
+void testCDuplicateFilter::testCheckAndSet()
+{
+   CDuplicateFilter filter(256, 1000);
+
+   CPPUNIT_ASSERT(EResult::fresh == filter.checkAndSet(1000));
+   CPPUNIT_ASSERT(EResult::fresh == filter.checkAndSet(1063));
+   CPPUNIT_ASSERT(EResult::fresh == filter.checkAndSet(1064));
+   CPPUNIT_ASSERT(EResult::fresh == filter.checkAndSet(1255));
+   CPPUNIT_ASSERT(EResult::duplicate == filter.checkAndSet(1000));
+   CPPUNIT_ASSERT(EResult::duplicate == filter.checkAndSet(1063));
+   CPPUNIT_ASSERT(EResult::duplicate == filter.checkAndSet(1064));
+   CPPUNIT_ASSERT(EResult::duplicate == filter.checkAndSet(1255));
+   CPPUNIT_ASSERT(EResult::fresh == filter.checkAndSet(1001));
+   // before the base counts as received
+   CPPUNIT_ASSERT(EResult::duplicate == filter.checkAndSet(999));
+   CPPUNIT_ASSERT(EResult::duplicate == filter.checkAndSet(0));
+}
+
+void testCDuplicateFilter::testWindow()
+{
+   CDuplicateFilter filter(64, 0);
+
+   CPPUNIT_ASSERT(EResult::beyondWindow == filter.checkAndSet(64));
+   // not marked, so still beyond the window after the base moved
+   filter.advance(1);
+   CPPUNIT_ASSERT(EResult::fresh == filter.checkAndSet(64));
+   CPPUNIT_ASSERT(EResult::beyondWindow == filter.checkAndSet(1000000));
+}
+
+void testCDuplicateFilter::testAdvance()
+{
+   CDuplicateFilter filter(128, 0);
+
+   for(uint64_t sequence = 0; sequence < 100; sequence++)
+      filter.checkAndSet(sequence);
+
+   // the bits of 0..69 are used again for 128..197
+   filter.advance(70);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(70), filter.getBase());
+   CPPUNIT_ASSERT(EResult::duplicate == filter.checkAndSet(69));
+   CPPUNIT_ASSERT(EResult::duplicate == filter.checkAndSet(99));
+   CPPUNIT_ASSERT(EResult::fresh == filter.checkAndSet(128));
+   CPPUNIT_ASSERT(EResult::fresh == filter.checkAndSet(197));
+   CPPUNIT_ASSERT(EResult::beyondWindow == filter.checkAndSet(198));
+
+   // backwards is ignored
+   filter.advance(10);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(70), filter.getBase());
+
+   // more than a window clears everything
+   filter.advance(1000);
+   CPPUNIT_ASSERT(EResult::fresh == filter.checkAndSet(1000));
+   CPPUNIT_ASSERT(EResult::fresh == filter.checkAndSet(1099));
+   CPPUNIT_ASSERT(EResult::duplicate == filter.checkAndSet(999));
+}
+
+void testCDuplicateFilter::testClear()
+{
+   CDuplicateFilter filter(64, 0);
+
+   CPPUNIT_ASSERT(EResult::fresh == filter.checkAndSet(5));
+   filter.clear(5);
+   CPPUNIT_ASSERT(EResult::fresh == filter.checkAndSet(5));
+   // outside the window nothing happens
+   filter.clear(100);
+   CPPUNIT_ASSERT(EResult::duplicate == filter.checkAndSet(5));
+}
+
+void testCDuplicateFilter::testWrapAround()
+{
+   CDuplicateFilter filter(64, UINT64_MAX - 9);
+
+   for(uint64_t sequence = UINT64_MAX - 9; sequence != 10; sequence++)
+      CPPUNIT_ASSERT(EResult::fresh == filter.checkAndSet(sequence));
+   CPPUNIT_ASSERT(EResult::duplicate == filter.checkAndSet(UINT64_MAX));
+   CPPUNIT_ASSERT(EResult::duplicate == filter.checkAndSet(0));
+
+   filter.advance(5);
+   CPPUNIT_ASSERT(EResult::duplicate == filter.checkAndSet(UINT64_MAX));
+   CPPUNIT_ASSERT(EResult::duplicate == filter.checkAndSet(9));
+   CPPUNIT_ASSERT(EResult::fresh == filter.checkAndSet(68));
+}
+
+void testCDuplicateFilter::testCounters()
+{
+   CDuplicateFilter filter(64, 0);
+
+   for(uint64_t sequence = 0; sequence < 10; sequence++)
+   {
+      filter.checkAndSet(sequence);
+      filter.checkAndSet(sequence);
+   }
+   filter.checkAndSet(1000);
+   filter.checkAndSet(1001);
+
+   CPPUNIT_ASSERT_EQUAL(uint64_t(22), filter.getCheckCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(10), filter.getDuplicateCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(2), filter.getBeyondWindowCount());
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(10.0 / 22.0, filter.getDuplicateRate(), 1e-9);
+
+   filter.resetCounters();
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), filter.getCheckCount());
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, filter.getDuplicateRate(), 1e-9);
+}
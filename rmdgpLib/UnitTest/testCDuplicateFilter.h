@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCDuplicateFilter.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 24, 2021, 8:40 PM
+ */
+
+#ifndef TESTCDUPLICATEFILTER_H
+#define TESTCDUPLICATEFILTER_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class testCDuplicateFilter : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCDuplicateFilter);
+
+    CPPUNIT_TEST(testConstructor);
+    CPPUNIT_TEST(testCheckAndSet);
+    CPPUNIT_TEST(testWindow);
+    CPPUNIT_TEST(testAdvance);
+    CPPUNIT_TEST(testClear);
+    CPPUNIT_TEST(testWrapAround);
+    CPPUNIT_TEST(testCounters);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCDuplicateFilter();
+    virtual ~testCDuplicateFilter();
+    void setUp();
+    void tearDown();
+
+private:
+    void testConstructor();
+    void testCheckAndSet();
+    void testWindow();
+    void testAdvance();
+    void testClear();
+    void testWrapAround();
+    void testCounters();
+};
+
+#endif /* TESTCDUPLICATEFILTER_H */
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCFecController.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 3, 2021, 11:30 AM
+ */
+
+#include "testCFecController.h"
+#include "../CFecController.h"
+#include <cmath>
+#include <stdexcept>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCFecController);
+
+testCFecController::testCFecController()
+{
+}
+
+testCFecController::~testCFecController()
+{
+}
+
+void testCFecController::setUp()
+{
+}
+
+void testCFecController::tearDown()
+{
+}
+
+namespace {
+   const CNanoTime start = CNanoTime::fromSec(1000);
+}
+
+void testCFecController::testResidualLoss()
+{
+   // without FEC everything lost stays lost
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(0.01, CFecController::getResidualLoss(0, 0, 0.01), 1e-12);
+   CPPUNIT_ASSERT_EQUAL(0.0, CFecController::getResidualLoss(8, 2, 0.0));
+   CPPUNIT_ASSERT_EQUAL(1.0, CFecController::getResidualLoss(8, 2, 1.0));
+   // 1 + 1 loses only when both are lost
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(0.01, CFecController::getResidualLoss(1, 1, 0.1), 1e-12);
+   // 4 + 1: sum over x >= 2 of P(x) * x / 5
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(0.03439, CFecController::getResidualLoss(4, 1, 0.1), 1e-9);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(3.43573e-5, CFecController::getResidualLoss(8, 2, 0.01), 1e-9);
+
+   // more parity rows always help
+   for(size_t m = 1; m < 8; m++)
+      CPPUNIT_ASSERT(CFecController::getResidualLoss(16, m + 1, 0.05) <
+                     CFecController::getResidualLoss(16, m, 0.05));
+}
+
+void testCFecController::testChoice()
+{
+   CFecController controller(1e-4);
+
+   // a clean network needs no FEC
+   CPPUNIT_ASSERT(!controller.update(0.0, start));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), controller.getBlockSize());
+   CPPUNIT_ASSERT(!controller.update(0.00005, start));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), controller.getParityRows());
+
+   // at 1% the least overhead that reaches 1e-4 is 3 parities per 32
+   CPPUNIT_ASSERT(controller.update(0.01, start));
+   CPPUNIT_ASSERT_EQUAL(size_t(32), controller.getBlockSize());
+   CPPUNIT_ASSERT_EQUAL(size_t(3), controller.getParityRows());
+   CPPUNIT_ASSERT(controller.getResidualLoss() <= 1e-4);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), controller.getChangeCount());
+   CPPUNIT_ASSERT(!controller.update(0.01, start));
+
+   // 40% can't be reached, the least residual loss within the overhead is taken
+   CPPUNIT_ASSERT(controller.update(0.4, start));
+   CPPUNIT_ASSERT(controller.getBlockSize() > 0);
+   CPPUNIT_ASSERT(controller.getResidualLoss() > 1e-4);
+   CPPUNIT_ASSERT(controller.getResidualLoss() < 0.4);
+   CPPUNIT_ASSERT(controller.getParityRows() * 2 <= controller.getBlockSize());
+
+   // fewer rows allowed costs more residual loss
+   CFecController limited(1e-4, 1);
+   limited.update(0.01, start);
+   CPPUNIT_ASSERT_EQUAL(size_t(1), limited.getParityRows());
+   CPPUNIT_ASSERT(limited.getResidualLoss() > 1e-4);
+}
+
+void testCFecController::testHold()
+{
+   const CNanoTime holdTime = CNanoTime::fromSec(1);
+   CFecController controller(1e-3, 8, 0.5, holdTime);
+
+   // a spike is followed at once
+   controller.update(0.0, start);
+   CPPUNIT_ASSERT(controller.update(0.05, start + CNanoTime::fromMsec(10)));
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(0.05, controller.getLossEstimate(), 1e-12);
+   const size_t rows = controller.getParityRows();
+
+   // the fall is slow, one hold time later it is at 1/e
+   CPPUNIT_ASSERT(!controller.update(0.0, start + CNanoTime::fromMsec(20)));
+   CPPUNIT_ASSERT_EQUAL(rows, controller.getParityRows());
+   controller.update(0.0, start + CNanoTime::fromMsec(20) + holdTime);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(0.05 * std::exp(-1.0 - 0.01), controller.getLossEstimate(),
+                                1e-6);
+   controller.update(0.0, start + holdTime * 20);
+   CPPUNIT_ASSERT_EQUAL(size_t(0), controller.getBlockSize());
+}
+
+void testCFecController::testConstructorException()
+{
+   CPPUNIT_ASSERT_THROW(CFecController(0.0), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CFecController(1.0), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CFecController(1e-4, 0), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CFecController(1e-4, 65), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CFecController(1e-4, 8, 0.0), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CFecController(1e-4, 8, 0.5, CNanoTime()), std::runtime_error);
+}
@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCFecDecoder.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 30, 2021, 11:40 PM
+ */
+
+#include "testCFecDecoder.h"
+#include "../CFecDecoder.h"
+#include "../CFecEncoder.h"
+#include "../CRmdgpHeader.h"
+#include <stdexcept>
+#include <vector>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCFecDecoder);
+
+namespace {
+   /// \brief the payload of datagram sequence, its length varies with the sequence number
+   std::vector<uint8_t> makePayload(uint64_t sequence)
+   {
+      std::vector<uint8_t> payload(10 + sequence % 7);
+      for(size_t i = 0; i < payload.size(); i++)
+         payload[i] = uint8_t(sequence * 13 + i);
+      return payload;
+   }
+
+   /// \brief encodes a block from first, passes all datagrams except lost to the decoder
+   /// \return the result of addParity
+   bool passBlock(CFecDecoder &decoder, uint64_t first, size_t blockSize, uint64_t lost,
+                  bool withParity = true)
+   {
+      CFecEncoder encoder(blockSize, 100);
+      size_t length;
+
+      for(uint64_t sequence = first; sequence < first + blockSize; sequence++)
+      {
+         const std::vector<uint8_t> payload = makePayload(sequence);
+         const uint8_t index = encoder.getIndex();
+         encoder.add(sequence, payload.data(), payload.size());
+         if(sequence != lost)
+            CPPUNIT_ASSERT(!decoder.addData(sequence, uint8_t(blockSize), index, payload.data(),
+                                            payload.size()));
+      }
+      encoder.finish(1, 2);
+      const uint8_t *parity = encoder.getParity(0, length);
+      if(!withParity)
+         return false;
+      return decoder.addParity(first, uint8_t(blockSize), 0, parity + CRmdgpHeader::size,
+                               length - CRmdgpHeader::size);
+   }
+
+   void checkRecovered(CFecDecoder &decoder, uint64_t sequence)
+   {
+      uint8_t datagram[200];
+      const std::vector<uint8_t> expected = makePayload(sequence);
+
+      const size_t length = decoder.recover(datagram, sizeof(datagram), 1, 2);
+      CPPUNIT_ASSERT_EQUAL(CRmdgpHeader::size + expected.size(), length);
+      CPPUNIT_ASSERT(ERmdgpValidation::valid == CRmdgpHeaderView::validate(datagram, length));
+      const CRmdgpHeaderView header(datagram);
+      CPPUNIT_ASSERT(ERmdgpPacketType::data == header.getType());
+      CPPUNIT_ASSERT(header.hasFlag(rmdgpFlagRetransmission));
+      CPPUNIT_ASSERT(!header.hasFlag(rmdgpFlagFec));
+      CPPUNIT_ASSERT_EQUAL(sequence, header.getSequence());
+      CPPUNIT_ASSERT(expected == std::vector<uint8_t>(datagram + CRmdgpHeader::size, datagram + length));
+   }
+}
+
+testCFecDecoder::testCFecDecoder()
+{
+}
+
+testCFecDecoder::~testCFecDecoder()
+{
+}
+
+void testCFecDecoder::setUp()
+{
+}
+
+void testCFecDecoder::tearDown()
+{
+}
+
+void testCFecDecoder::testRecover()
+{
+   CFecDecoder decoder(100, 4);
+
+   CPPUNIT_ASSERT_THROW(CFecDecoder(100, 0), std::runtime_error);
+   // every position of the block, the first and last of 64 too
+   for(uint64_t lost = 100; lost < 108; lost++)
+   {
+      CPPUNIT_ASSERT(passBlock(decoder, 100 + (lost - 100) * 8, 8, 100 + (lost - 100) * 9));
+      CPPUNIT_ASSERT(decoder.hasRecoverable());
+      checkRecovered(decoder, 100 + (lost - 100) * 9);
+      CPPUNIT_ASSERT(!decoder.hasRecoverable());
+   }
+   CPPUNIT_ASSERT(passBlock(decoder, 1000, 64, 1000));
+   checkRecovered(decoder, 1000);
+   CPPUNIT_ASSERT(passBlock(decoder, 2000, 64, 2063));
+   checkRecovered(decoder, 2063);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(10), decoder.getRecoveredCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), decoder.getDroppedCount());
+
+   // the parity can come before the data
+   uint8_t datagram[200];
+   CFecEncoder encoder(2, 100);
+   size_t length;
+   const std::vector<uint8_t> first = makePayload(3000), second = makePayload(3001);
+   encoder.add(3000, first.data(), first.size());
+   encoder.add(3001, second.data(), second.size());
+   encoder.finish(1, 2);
+   const uint8_t *parity = encoder.getParity(0, length);
+   CPPUNIT_ASSERT(!decoder.addParity(3000, 2, 0, parity + CRmdgpHeader::size,
+                                     length - CRmdgpHeader::size));
+   CPPUNIT_ASSERT(decoder.addData(3001, 2, 1, second.data(), second.size()));
+   checkRecovered(decoder, 3000);
+   CPPUNIT_ASSERT_EQUAL(size_t(0), decoder.recover(datagram, sizeof(datagram), 1, 2));
+}
+
+void testCFecDecoder::testComplete()
+{
+   CFecDecoder decoder(100, 4);
+
+   // nothing lost, nothing to recover, the block is forgotten at once
+   CPPUNIT_ASSERT(!passBlock(decoder, 10, 4, 0, false));
+   CPPUNIT_ASSERT(!passBlock(decoder, 14, 4, 0));
+   CPPUNIT_ASSERT(!decoder.hasRecoverable());
+
+   // two lost is too many
+   CFecEncoder encoder(4, 100);
+   size_t length;
+   for(uint64_t sequence = 18; sequence < 22; sequence++)
+   {
+      const std::vector<uint8_t> payload = makePayload(sequence);
+      encoder.add(sequence, payload.data(), payload.size());
+      if(sequence == 18 || sequence == 21)
+         decoder.addData(sequence, 4, uint8_t(sequence - 18), payload.data(), payload.size());
+   }
+   encoder.finish(1, 2);
+   const uint8_t *parity = encoder.getParity(0, length);
+   CPPUNIT_ASSERT(!decoder.addParity(18, 4, 0, parity + CRmdgpHeader::size,
+                                     length - CRmdgpHeader::size));
+   CPPUNIT_ASSERT(!decoder.hasRecoverable());
+
+   // out of range positions are ignored
+   const std::vector<uint8_t> payload = makePayload(1);
+   CPPUNIT_ASSERT(!decoder.addData(1, 4, 4, payload.data(), payload.size()));
+   CPPUNIT_ASSERT(!decoder.addData(1, 65, 0, payload.data(), payload.size()));
+   CPPUNIT_ASSERT(!decoder.addParity(1, 0, 0, payload.data(), payload.size()));
+   CPPUNIT_ASSERT(!decoder.addParity(1, 4, 0, payload.data(), 1));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), decoder.getRecoveredCount());
+}
+
+void testCFecDecoder::testShortBlock()
+{
+   CFecDecoder decoder(100, 4);
+   CFecEncoder encoder(8, 100);
+   size_t length;
+   const std::vector<uint8_t> first = makePayload(50), second = makePayload(51),
+                              third = makePayload(52);
+
+   // the data announce 8, the sender went idle after 3
+   CPPUNIT_ASSERT(!decoder.addData(50, 8, 0, first.data(), first.size()));
+   CPPUNIT_ASSERT(!decoder.addData(52, 8, 2, third.data(), third.size()));
+   encoder.add(50, first.data(), first.size());
+   encoder.add(51, second.data(), second.size());
+   encoder.add(52, third.data(), third.size());
+   encoder.finish(1, 2);
+   const uint8_t *parity = encoder.getParity(0, length);
+   CPPUNIT_ASSERT(decoder.addParity(50, CRmdgpHeaderView(parity).getFecBlockSize(), 0,
+                                    parity + CRmdgpHeader::size, length - CRmdgpHeader::size));
+   checkRecovered(decoder, 51);
+}
+
+void testCFecDecoder::testDropOldest()
+{
+   CFecDecoder decoder(100, 2);
+
+   // three blocks with a loss and no parity yet, the oldest one is dropped
+   CPPUNIT_ASSERT(!passBlock(decoder, 0, 4, 0, false));
+   CPPUNIT_ASSERT(!passBlock(decoder, 4, 4, 4, false));
+   CPPUNIT_ASSERT(!passBlock(decoder, 8, 4, 8, false));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), decoder.getDroppedCount());
+   CPPUNIT_ASSERT(passBlock(decoder, 4, 4, 4));
+   checkRecovered(decoder, 4);
+   CPPUNIT_ASSERT_EQUAL(size_t(2), decoder.getMaxBlocks());
+}
+
+void testCFecDecoder::testMultipleLost()
+{
+   // 3 parities with every block of 8 and 1 more row for repairs
+   CFecDecoder decoder(100, 4, 4);
+   CFecEncoder encoder(8, 100, 3);
+   std::vector<std::vector<uint8_t>> parities;
+   size_t length;
+
+   CPPUNIT_ASSERT_THROW(CFecDecoder(100, 4, 0), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CFecDecoder(100, 4, CFecEncoder::maxParityRows + 1), std::runtime_error);
+   for(uint64_t sequence = 200; sequence < 208; sequence++)
+   {
+      const std::vector<uint8_t> payload = makePayload(sequence);
+      const uint8_t index = encoder.getIndex();
+      encoder.add(sequence, payload.data(), payload.size());
+      // a burst of 3 and 1 more
+      if(sequence < 202 || sequence > 204)
+         if(sequence != 206)
+            CPPUNIT_ASSERT(!decoder.addData(sequence, 8, index, payload.data(), payload.size()));
+   }
+   const size_t count = encoder.finish(1, 2);
+   for(size_t row = 0; row < count; row++)
+   {
+      const uint8_t *parity = encoder.getParity(row, length);
+      parities.emplace_back(parity + CRmdgpHeader::size, parity + length);
+   }
+
+   // 3 parities for 4 losses is not enough, a parity of an unknown row is ignored
+   for(size_t row = 0; row < 3; row++)
+      CPPUNIT_ASSERT(!decoder.addParity(200, 8, uint8_t(row), parities[row].data(),
+                                        parities[row].size()));
+   CPPUNIT_ASSERT(!decoder.addParity(200, 8, 1, parities[1].data(), parities[1].size()));
+   CPPUNIT_ASSERT(!decoder.addParity(200, 8, 4, parities[1].data(), parities[1].size()));
+   CPPUNIT_ASSERT(!decoder.hasRecoverable());
+
+   // a repair row that was not sent with the block brings all 4
+   encoder.setParityRows(1, 3);
+   for(uint64_t sequence = 200; sequence < 208; sequence++)
+   {
+      const std::vector<uint8_t> payload = makePayload(sequence);
+      encoder.add(sequence, payload.data(), payload.size());
+   }
+   encoder.finish(1, 2);
+   const uint8_t *repair = encoder.getParity(0, length);
+   CPPUNIT_ASSERT(decoder.addParity(200, 8, 3, repair + CRmdgpHeader::size,
+                                    length - CRmdgpHeader::size));
+   checkRecovered(decoder, 202);
+   checkRecovered(decoder, 203);
+   checkRecovered(decoder, 204);
+   checkRecovered(decoder, 206);
+   CPPUNIT_ASSERT(!decoder.hasRecoverable());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), decoder.getRecoveredCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), decoder.getParityCount());
+}
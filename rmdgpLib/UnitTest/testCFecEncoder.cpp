@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCFecEncoder.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 30, 2021, 11:15 PM
+ */
+
+#include "testCFecEncoder.h"
+#include "../CFecEncoder.h"
+#include "../CGaloisField.h"
+#include "../CReedSolomon.h"
+#include <stdexcept>
+#include <vector>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCFecEncoder);
+
+testCFecEncoder::testCFecEncoder()
+{
+}
+
+testCFecEncoder::~testCFecEncoder()
+{
+}
+
+void testCFecEncoder::setUp()
+{
+}
+
+void testCFecEncoder::tearDown()
+{
+}
+
+void testCFecEncoder::testParity()
+{
+   CFecEncoder encoder(3, 100);
+   const uint8_t first[4] = { 1, 2, 3, 4 };
+   const uint8_t second[2] = { 0x10, 0x20 };
+   const uint8_t third[3] = { 0x01, 0x01, 0x01 };
+   size_t length;
+
+   CPPUNIT_ASSERT(!encoder.isStarted());
+   CPPUNIT_ASSERT_EQUAL(uint8_t(3), encoder.getBlockSize());
+   CPPUNIT_ASSERT_EQUAL(uint8_t(0), encoder.getIndex());
+   encoder.add(50, first, sizeof(first));
+   CPPUNIT_ASSERT_EQUAL(uint8_t(1), encoder.getIndex());
+   encoder.add(51, second, sizeof(second));
+   CPPUNIT_ASSERT(!encoder.isComplete());
+   encoder.add(52, third, sizeof(third));
+   CPPUNIT_ASSERT(encoder.isComplete());
+
+   encoder.finish(7, 8);
+   const uint8_t *datagram = encoder.getParity(0, length);
+   CPPUNIT_ASSERT_EQUAL(CRmdgpHeader::size + CFecEncoder::parityHeaderSize + 4, length);
+   CPPUNIT_ASSERT(ERmdgpValidation::valid == CRmdgpHeaderView::validate(datagram, length));
+   const CRmdgpHeaderView header(datagram);
+   CPPUNIT_ASSERT(ERmdgpPacketType::parity == header.getType());
+   CPPUNIT_ASSERT_EQUAL(uint32_t(7), header.getSessionId());
+   CPPUNIT_ASSERT_EQUAL(uint32_t(8), header.getStreamId());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(50), header.getSequence());
+   CPPUNIT_ASSERT_EQUAL(uint8_t(3), header.getFecBlockSize());
+
+   const uint8_t *payload = header.getPayload();
+   CPPUNIT_ASSERT_EQUAL(uint16_t(4 ^ 2 ^ 3), CRmdgpHeader::load16(payload));
+   CPPUNIT_ASSERT_EQUAL(0x10, int(payload[2]));
+   CPPUNIT_ASSERT_EQUAL(0x23, int(payload[3]));
+   CPPUNIT_ASSERT_EQUAL(0x02, int(payload[4]));
+   CPPUNIT_ASSERT_EQUAL(0x04, int(payload[5]));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), encoder.getParityCount());
+
+   // the next block starts clean
+   CPPUNIT_ASSERT(!encoder.isStarted());
+   encoder.add(53, second, sizeof(second));
+   encoder.finish(7, 8);
+   datagram = encoder.getParity(0, length);
+   CPPUNIT_ASSERT_EQUAL(CRmdgpHeader::size + CFecEncoder::parityHeaderSize + 2, length);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(53), CRmdgpHeaderView(datagram).getSequence());
+   CPPUNIT_ASSERT_EQUAL(0x10, int(datagram[CRmdgpHeader::size + 2]));
+   CPPUNIT_ASSERT_EQUAL(0x20, int(datagram[CRmdgpHeader::size + 3]));
+}
+
+void testCFecEncoder::testShortBlock()
+{
+   CFecEncoder encoder(8, 100);
+   const uint8_t payload[3] = { 5, 6, 7 };
+   size_t length;
+
+   encoder.add(10, payload, sizeof(payload));
+   encoder.add(11, payload, sizeof(payload));
+   CPPUNIT_ASSERT(encoder.isStarted());
+   encoder.finish(1, 1);
+   const uint8_t *datagram = encoder.getParity(0, length);
+   // the parity tells how many datagrams the block really has
+   CPPUNIT_ASSERT_EQUAL(uint8_t(2), CRmdgpHeaderView(datagram).getFecBlockSize());
+   CPPUNIT_ASSERT_EQUAL(uint16_t(0), CRmdgpHeader::load16(datagram + CRmdgpHeader::size));
+   CPPUNIT_ASSERT_EQUAL(0, int(datagram[CRmdgpHeader::size + 2]));
+}
+
+void testCFecEncoder::testBlockSize()
+{
+   CFecEncoder encoder(4, 100);
+   const uint8_t payload[1] = { 1 };
+
+   CPPUNIT_ASSERT_THROW(CFecEncoder(0, 100), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CFecEncoder(CFecEncoder::maxBlockSize + 1, 100), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CFecEncoder(4, CRmdgpHeader::maxPayloadLength), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(encoder.setBlockSize(0), std::runtime_error);
+
+   // between blocks it applies at once
+   encoder.setBlockSize(2);
+   CPPUNIT_ASSERT_EQUAL(uint8_t(2), encoder.getBlockSize());
+
+   // within a block it waits for the next one
+   encoder.add(0, payload, sizeof(payload));
+   encoder.setBlockSize(6);
+   CPPUNIT_ASSERT_EQUAL(uint8_t(2), encoder.getBlockSize());
+   CPPUNIT_ASSERT_EQUAL(size_t(6), encoder.getNextBlockSize());
+   encoder.add(1, payload, sizeof(payload));
+   CPPUNIT_ASSERT(encoder.isComplete());
+   encoder.finish(1, 1);
+   CPPUNIT_ASSERT_EQUAL(uint8_t(6), encoder.getBlockSize());
+}
+
+void testCFecEncoder::testParityRows()
+{
+   CFecEncoder encoder(3, 100, 2);
+   const uint8_t payloads[3][4] = { { 1, 2, 3, 4 }, { 0x10, 0x20 }, { 0x01, 0x01, 0x01 } };
+   const size_t lengths[3] = { 4, 2, 3 };
+   size_t length;
+
+   CPPUNIT_ASSERT_THROW(CFecEncoder(3, 100, 0), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(encoder.setParityRows(1, CFecEncoder::maxParityRows), std::runtime_error);
+   for(uint64_t sequence = 20; sequence < 23; sequence++)
+      encoder.add(sequence, payloads[sequence - 20], lengths[sequence - 20]);
+   CPPUNIT_ASSERT_EQUAL(size_t(2), encoder.finish(7, 8));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(2), encoder.getParityCount());
+
+   // the parities are the rows of the Reed-Solomon code over the length prefixed payloads
+   std::vector<std::vector<uint8_t>> shards(5, std::vector<uint8_t>(6, 0));
+   uint8_t *pointers[5];
+   for(size_t i = 0; i < 5; i++)
+      pointers[i] = shards[i].data();
+   for(size_t i = 0; i < 3; i++)
+   {
+      CRmdgpHeader::store16(pointers[i], uint16_t(lengths[i]));
+      std::copy(payloads[i], payloads[i] + lengths[i], pointers[i] + 2);
+   }
+   CReedSolomon(3, 2).encode(pointers, pointers + 3, 6);
+   for(size_t row = 0; row < 2; row++)
+   {
+      const uint8_t *datagram = encoder.getParity(row, length);
+      CPPUNIT_ASSERT_EQUAL(CRmdgpHeader::size + 6, length);
+      const CRmdgpHeaderView header(datagram);
+      CPPUNIT_ASSERT_EQUAL(uint64_t(20), header.getSequence());
+      CPPUNIT_ASSERT_EQUAL(uint8_t(3), header.getFecBlockSize());
+      CPPUNIT_ASSERT_EQUAL(uint8_t(row), header.getFecIndex());
+      CPPUNIT_ASSERT(shards[3 + row] == std::vector<uint8_t>(header.getPayload(),
+                                                             header.getPayload() + 6));
+   }
+
+   // later rows only, with the retransmission flag
+   encoder.setParityRows(1, 5);
+   CPPUNIT_ASSERT_EQUAL(size_t(1), encoder.getParityRows());
+   CPPUNIT_ASSERT_EQUAL(size_t(5), encoder.getFirstParityRow());
+   encoder.add(30, payloads[0], lengths[0]);
+   CPPUNIT_ASSERT_EQUAL(size_t(1), encoder.finish(7, 8, rmdgpFlagRetransmission));
+   const CRmdgpHeaderView header(encoder.getParity(0, length));
+   CPPUNIT_ASSERT_EQUAL(uint8_t(5), header.getFecIndex());
+   CPPUNIT_ASSERT(header.hasFlag(rmdgpFlagRetransmission));
+   const uint8_t coefficient = CReedSolomon::getCoefficient(5, 0);
+   CPPUNIT_ASSERT_EQUAL(int(CGaloisField::multiply(coefficient, 4)), int(header.getPayload()[1]));
+   CPPUNIT_ASSERT_EQUAL(int(CGaloisField::multiply(coefficient, 3)), int(header.getPayload()[4]));
+}
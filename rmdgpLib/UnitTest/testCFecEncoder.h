@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCFecEncoder.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 30, 2021, 11:15 PM
+ */
+
+#ifndef TESTCFECENCODER_H
+#define TESTCFECENCODER_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class testCFecEncoder : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCFecEncoder);
+
+    CPPUNIT_TEST(testParity);
+    CPPUNIT_TEST(testShortBlock);
+    CPPUNIT_TEST(testBlockSize);
+    CPPUNIT_TEST(testParityRows);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCFecEncoder();
+    virtual ~testCFecEncoder();
+    void setUp();
+    void tearDown();
+
+private:
+    void testParity();
+    void testShortBlock();
+    void testBlockSize();
+    void testParityRows();
+};
+
+#endif /* TESTCFECENCODER_H */
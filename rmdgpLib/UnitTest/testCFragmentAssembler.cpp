@@ -0,0 +1,272 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCFragmentAssembler.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 4, 2021, 3:40 PM
+ */
+
+#include "testCFragmentAssembler.h"
+#include "../CFragmentAssembler.h"
+#include "../CFragmentHeader.h"
+#include <stdexcept>
+#include <vector>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCFragmentAssembler);
+
+testCFragmentAssembler::testCFragmentAssembler()
+{
+}
+
+testCFragmentAssembler::~testCFragmentAssembler()
+{
+}
+
+void testCFragmentAssembler::setUp()
+{
+}
+
+void testCFragmentAssembler::tearDown()
+{
+}
+
+namespace {
+   /// \brief splits message in fragments of fragmentSize, like CRmdgpSender::sendFragmented
+   std::vector<std::vector<uint8_t>> fragment(const std::vector<uint8_t> &message,
+                                              size_t fragmentSize)
+   {
+      const size_t count = message.empty() ? 1 : (message.size() + fragmentSize - 1) / fragmentSize;
+      std::vector<std::vector<uint8_t>> fragments(count);
+
+      for(size_t index = 0; index < count; index++)
+      {
+         const size_t offset = index * fragmentSize;
+         const size_t length = std::min(fragmentSize, message.size() - offset);
+         fragments[index].resize(CFragmentHeader::size + length);
+         CFragmentHeader::store(fragments[index].data(), uint32_t(message.size()),
+                                uint32_t(offset), uint32_t(index), uint32_t(count));
+         std::copy(message.begin() + offset, message.begin() + offset + length,
+                   fragments[index].begin() + CFragmentHeader::size);
+      }
+      return fragments;
+   }
+
+   std::vector<uint8_t> makeMessage(size_t length, uint8_t seed)
+   {
+      std::vector<uint8_t> message(length);
+      for(size_t i = 0; i < length; i++)
+         message[i] = uint8_t(seed + i * 7);
+      return message;
+   }
+}
+
+void testCFragmentAssembler::testInOrder()
+{
+   CFragmentAssembler assembler(10000, 20000);
+   const std::vector<uint8_t> message = makeMessage(1000, 3);
+   const std::vector<std::vector<uint8_t>> fragments = fragment(message, 300);
+   CFragmentAssembler::SMessage result;
+
+   CPPUNIT_ASSERT_EQUAL(size_t(4), fragments.size());
+   for(size_t i = 0; i < 3; i++)
+   {
+      CPPUNIT_ASSERT(EFragmentResult::incomplete ==
+                     assembler.add(50 + i, fragments[i].data(), fragments[i].size()));
+      CPPUNIT_ASSERT(!assembler.next(result));
+   }
+   CPPUNIT_ASSERT_EQUAL(size_t(1), assembler.getPartialCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(1000), assembler.getPartialBytes());
+   CPPUNIT_ASSERT(EFragmentResult::complete ==
+                  assembler.add(53, fragments[3].data(), fragments[3].size()));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), assembler.getPartialCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), assembler.getPartialBytes());
+   CPPUNIT_ASSERT_EQUAL(size_t(1), assembler.getCompleteCount());
+
+   CPPUNIT_ASSERT(assembler.next(result));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(50), result.firstSequence);
+   CPPUNIT_ASSERT(message == std::vector<uint8_t>(result.data.get(),
+                                                  result.data.get() + result.length));
+   CPPUNIT_ASSERT(!assembler.next(result));
+
+   // a small and an empty message are one fragment
+   const std::vector<std::vector<uint8_t>> small = fragment(makeMessage(5, 1), 300);
+   CPPUNIT_ASSERT(EFragmentResult::complete ==
+                  assembler.add(54, small[0].data(), small[0].size()));
+   const std::vector<std::vector<uint8_t>> empty = fragment(std::vector<uint8_t>(), 300);
+   CPPUNIT_ASSERT(EFragmentResult::complete ==
+                  assembler.add(55, empty[0].data(), empty[0].size()));
+   CPPUNIT_ASSERT(assembler.next(result));
+   CPPUNIT_ASSERT_EQUAL(size_t(5), result.length);
+   CPPUNIT_ASSERT(assembler.next(result));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(55), result.firstSequence);
+   CPPUNIT_ASSERT_EQUAL(size_t(0), result.length);
+}
+
+void testCFragmentAssembler::testOutOfOrder()
+{
+   CFragmentAssembler assembler(100000, 200000);
+   const std::vector<uint8_t> first = makeMessage(70000, 1);
+   const std::vector<uint8_t> second = makeMessage(2000, 9);
+   const std::vector<std::vector<uint8_t>> firstFragments = fragment(first, 1000);
+   const std::vector<std::vector<uint8_t>> secondFragments = fragment(second, 1000);
+   const uint64_t secondSequence = 1000 + firstFragments.size();
+   CFragmentAssembler::SMessage result;
+
+   // the fragments of two messages mixed, each backwards; more than 64 fragments
+   CPPUNIT_ASSERT_EQUAL(size_t(70), firstFragments.size());
+   for(size_t i = firstFragments.size(); i-- > 0; )
+   {
+      if(i < secondFragments.size())
+         assembler.add(secondSequence + i, secondFragments[i].data(),
+                       secondFragments[i].size());
+      const EFragmentResult result = assembler.add(1000 + i, firstFragments[i].data(),
+                                                   firstFragments[i].size());
+      CPPUNIT_ASSERT((i == 0) == (result == EFragmentResult::complete));
+   }
+
+   CPPUNIT_ASSERT(assembler.next(result));
+   CPPUNIT_ASSERT_EQUAL(secondSequence, result.firstSequence);
+   CPPUNIT_ASSERT(second == std::vector<uint8_t>(result.data.get(),
+                                                 result.data.get() + result.length));
+   CPPUNIT_ASSERT(assembler.next(result));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1000), result.firstSequence);
+   CPPUNIT_ASSERT(first == std::vector<uint8_t>(result.data.get(),
+                                                result.data.get() + result.length));
+}
+
+void testCFragmentAssembler::testDuplicate()
+{
+   CFragmentAssembler assembler(10000, 10000);
+   const std::vector<std::vector<uint8_t>> fragments = fragment(makeMessage(500, 2), 200);
+
+   CPPUNIT_ASSERT(EFragmentResult::incomplete ==
+                  assembler.add(7, fragments[0].data(), fragments[0].size()));
+   CPPUNIT_ASSERT(EFragmentResult::duplicate ==
+                  assembler.add(7, fragments[0].data(), fragments[0].size()));
+   CPPUNIT_ASSERT(EFragmentResult::incomplete ==
+                  assembler.add(9, fragments[2].data(), fragments[2].size()));
+   CPPUNIT_ASSERT(EFragmentResult::complete ==
+                  assembler.add(8, fragments[1].data(), fragments[1].size()));
+}
+
+void testCFragmentAssembler::testMalformed()
+{
+   CFragmentAssembler assembler(10000, 10000);
+   uint8_t fragment[CFragmentHeader::size + 10] = { 0 };
+
+   CPPUNIT_ASSERT(EFragmentResult::malformed == assembler.add(1, fragment, 10));
+   // index past the count
+   CFragmentHeader::store(fragment, 100, 0, 2, 2);
+   CPPUNIT_ASSERT(EFragmentResult::malformed == assembler.add(1, fragment, sizeof(fragment)));
+   // past the end of the message
+   CFragmentHeader::store(fragment, 100, 95, 0, 2);
+   CPPUNIT_ASSERT(EFragmentResult::malformed == assembler.add(1, fragment, sizeof(fragment)));
+   // the last fragment doesn't end the message
+   CFragmentHeader::store(fragment, 100, 80, 1, 2);
+   CPPUNIT_ASSERT(EFragmentResult::malformed == assembler.add(1, fragment, sizeof(fragment)));
+   // a middle fragment that ends the message
+   CFragmentHeader::store(fragment, 100, 90, 0, 2);
+   CPPUNIT_ASSERT(EFragmentResult::malformed == assembler.add(1, fragment, sizeof(fragment)));
+   // more fragments than bytes
+   CFragmentHeader::store(fragment, 100, 0, 0, 1000);
+   CPPUNIT_ASSERT(EFragmentResult::malformed == assembler.add(1, fragment, sizeof(fragment)));
+
+   // a fragment that doesn't match the first one of its message
+   CFragmentHeader::store(fragment, 100, 0, 0, 10);
+   CPPUNIT_ASSERT(EFragmentResult::incomplete == assembler.add(1, fragment, sizeof(fragment)));
+   CFragmentHeader::store(fragment, 200, 10, 1, 10);
+   CPPUNIT_ASSERT(EFragmentResult::malformed == assembler.add(2, fragment, sizeof(fragment)));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), assembler.getPartialCount());
+}
+
+void testCFragmentAssembler::testOverlap()
+{
+   CFragmentAssembler assembler(10000, 10000);
+   const std::vector<uint8_t> message = makeMessage(30, 4);
+   const std::vector<std::vector<uint8_t>> fragments = fragment(message, 10);
+   uint8_t overlap[CFragmentHeader::size + 12] = { 0 };
+   CFragmentAssembler::SMessage result;
+
+   CPPUNIT_ASSERT(EFragmentResult::incomplete ==
+                  assembler.add(20, fragments[0].data(), fragments[0].size()));
+   // a fragment that overlaps the first one would leave bytes 15 to 19 unwritten
+   CFragmentHeader::store(overlap, 30, 5, 1, 3);
+   CPPUNIT_ASSERT(EFragmentResult::malformed == assembler.add(21, overlap, 26));
+   // a fragment of an other size
+   CFragmentHeader::store(overlap, 30, 12, 1, 3);
+   CPPUNIT_ASSERT(EFragmentResult::malformed == assembler.add(21, overlap, sizeof(overlap)));
+   // a last fragment that doesn't start at its index times the fragment size
+   CFragmentHeader::store(overlap, 30, 25, 2, 3);
+   CPPUNIT_ASSERT(EFragmentResult::malformed == assembler.add(22, overlap, 21));
+   CFragmentHeader::store(overlap, 30, 18, 2, 3);
+   CPPUNIT_ASSERT(EFragmentResult::malformed == assembler.add(22, overlap, sizeof(overlap)));
+   // a single fragment that doesn't start the message
+   CFragmentHeader::store(overlap, 17, 5, 0, 1);
+   CPPUNIT_ASSERT(EFragmentResult::malformed == assembler.add(40, overlap, sizeof(overlap)));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), assembler.getPartialCount());
+
+   // the real fragments still complete the message
+   CPPUNIT_ASSERT(EFragmentResult::incomplete ==
+                  assembler.add(22, fragments[2].data(), fragments[2].size()));
+   CPPUNIT_ASSERT(EFragmentResult::complete ==
+                  assembler.add(21, fragments[1].data(), fragments[1].size()));
+   CPPUNIT_ASSERT(assembler.next(result));
+   CPPUNIT_ASSERT(message == std::vector<uint8_t>(result.data.get(),
+                                                  result.data.get() + result.length));
+}
+
+void testCFragmentAssembler::testMemoryLimit()
+{
+   CFragmentAssembler assembler(1000, 2500);
+   const std::vector<std::vector<uint8_t>> large = fragment(makeMessage(1001, 0), 100);
+   std::vector<std::vector<uint8_t>> fragments[3];
+
+   // larger than the largest message, nothing is allocated
+   CPPUNIT_ASSERT(EFragmentResult::tooLarge == assembler.add(0, large[0].data(), large[0].size()));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), assembler.getPartialBytes());
+
+   // three partial messages don't fit, the oldest is dropped
+   for(size_t i = 0; i < 3; i++)
+   {
+      fragments[i] = fragment(makeMessage(1000, uint8_t(i)), 500);
+      CPPUNIT_ASSERT(EFragmentResult::incomplete ==
+                     assembler.add(100 + i * 2, fragments[i][0].data(), fragments[i][0].size()));
+   }
+   CPPUNIT_ASSERT_EQUAL(size_t(2), assembler.getPartialCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(2000), assembler.getPartialBytes());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), assembler.getDroppedCount());
+   CPPUNIT_ASSERT(EFragmentResult::complete ==
+                  assembler.add(105, fragments[2][1].data(), fragments[2][1].size()));
+   CPPUNIT_ASSERT(EFragmentResult::complete ==
+                  assembler.add(103, fragments[1][1].data(), fragments[1][1].size()));
+   // the rest of the dropped message starts a new one that never completes
+   CPPUNIT_ASSERT(EFragmentResult::incomplete ==
+                  assembler.add(101, fragments[0][1].data(), fragments[0][1].size()));
+   CPPUNIT_ASSERT_EQUAL(size_t(2), assembler.getCompleteCount());
+}
+
+void testCFragmentAssembler::testConstructorException()
+{
+   CPPUNIT_ASSERT_THROW(CFragmentAssembler(1000, 999), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CFragmentAssembler(size_t(CFragmentHeader::maxMessageLength) + 1,
+                                           SIZE_MAX), std::runtime_error);
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCFragmentAssembler.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 4, 2021, 3:40 PM
+ */
+
+#ifndef TESTCFRAGMENTASSEMBLER_H
+#define TESTCFRAGMENTASSEMBLER_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class testCFragmentAssembler : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCFragmentAssembler);
+
+    CPPUNIT_TEST(testInOrder);
+    CPPUNIT_TEST(testOutOfOrder);
+    CPPUNIT_TEST(testDuplicate);
+    CPPUNIT_TEST(testMalformed);
+    CPPUNIT_TEST(testOverlap);
+    CPPUNIT_TEST(testMemoryLimit);
+    CPPUNIT_TEST(testConstructorException);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCFragmentAssembler();
+    virtual ~testCFragmentAssembler();
+    void setUp();
+    void tearDown();
+
+private:
+    void testInOrder();
+    void testOutOfOrder();
+    void testDuplicate();
+    void testMalformed();
+    void testOverlap();
+    void testMemoryLimit();
+    void testConstructorException();
+};
+
+#endif /* TESTCFRAGMENTASSEMBLER_H */
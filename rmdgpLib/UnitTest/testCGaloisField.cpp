@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCGaloisField.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 2, 2021, 10:40 PM
+ */
+
+#include "testCGaloisField.h"
+#include "../CGaloisField.h"
+#include <stdexcept>
+#include <vector>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCGaloisField);
+
+testCGaloisField::testCGaloisField()
+{
+}
+
+testCGaloisField::~testCGaloisField()
+{
+}
+
+void testCGaloisField::setUp()
+{
+}
+
+void testCGaloisField::tearDown()
+{
+}
+
+void testCGaloisField::testArithmetic()
+{
+   // x * x^7 = x^8 = x^4 + x^3 + x^2 + 1
+   CPPUNIT_ASSERT_EQUAL(0x1d, int(CGaloisField::multiply(2, 128)));
+   CPPUNIT_ASSERT_EQUAL(0x00, int(CGaloisField::multiply(0, 77)));
+   CPPUNIT_ASSERT_EQUAL(0x00, int(CGaloisField::multiply(77, 0)));
+   CPPUNIT_ASSERT_EQUAL(77, int(CGaloisField::multiply(1, 77)));
+   CPPUNIT_ASSERT_EQUAL(0x00, int(CGaloisField::divide(0, 77)));
+
+   for(int a = 1; a < 256; a++)
+   {
+      CPPUNIT_ASSERT_EQUAL(1, int(CGaloisField::multiply(uint8_t(a),
+                                                         CGaloisField::inverse(uint8_t(a)))));
+      for(int b = 1; b < 256; b += 7)
+      {
+         const uint8_t product = CGaloisField::multiply(uint8_t(a), uint8_t(b));
+         CPPUNIT_ASSERT_EQUAL(int(product), int(CGaloisField::multiply(uint8_t(b), uint8_t(a))));
+         CPPUNIT_ASSERT_EQUAL(a, int(CGaloisField::divide(product, uint8_t(b))));
+      }
+   }
+   // the multiplication distributes over the addition, which is XOR
+   CPPUNIT_ASSERT_EQUAL(int(CGaloisField::multiply(0x53, 0xca ^ 0x11)),
+                        CGaloisField::multiply(0x53, 0xca) ^ CGaloisField::multiply(0x53, 0x11));
+}
+
+void testCGaloisField::testKernels()
+{
+   const CGaloisField::EKernel kernels[] = { CGaloisField::EKernel::scalar,
+                                             CGaloisField::EKernel::ssse3,
+                                             CGaloisField::EKernel::avx2 };
+   std::vector<uint8_t> source(1000), expected(1000);
+
+   for(size_t i = 0; i < source.size(); i++)
+   {
+      source[i] = uint8_t(i * 7919);
+      expected[i] = uint8_t(i * 31);
+   }
+   CPPUNIT_ASSERT(CGaloisField::isSupported(CGaloisField::getSelected()));
+   // all lengths around the vector sizes, and unaligned
+   for(size_t length : { 0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 990 })
+   {
+      for(size_t offset : { 0, 1, 3 })
+      {
+         for(int coefficient : { 0, 1, 2, 0x1d, 0x80, 0xff })
+         {
+            std::vector<uint8_t> reference(expected);
+            for(size_t i = 0; i < length; i++)
+               reference[offset + i] ^= CGaloisField::multiply(uint8_t(coefficient), source[i]);
+
+            std::vector<uint8_t> target(expected);
+            CGaloisField::mulAddInto(uint8_t(coefficient), &target[offset], &source[0], length);
+            CPPUNIT_ASSERT(reference == target);
+            for(CGaloisField::EKernel kernel : kernels)
+            {
+               if(!CGaloisField::isSupported(kernel))
+               {
+                  CPPUNIT_ASSERT_THROW(CGaloisField::mulAddInto(kernel, 2, &target[0], &source[0], 1),
+                                       std::runtime_error);
+                  continue;
+               }
+               target = expected;
+               CGaloisField::mulAddInto(kernel, uint8_t(coefficient), &target[offset], &source[0],
+                                        length);
+               CPPUNIT_ASSERT_MESSAGE(CGaloisField::getName(kernel), reference == target);
+            }
+         }
+      }
+   }
+}
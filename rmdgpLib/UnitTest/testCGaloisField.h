@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCGaloisField.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 2, 2021, 10:40 PM
+ */
+
+#ifndef TESTCGALOISFIELD_H
+#define TESTCGALOISFIELD_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class testCGaloisField : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCGaloisField);
+
+    CPPUNIT_TEST(testArithmetic);
+    CPPUNIT_TEST(testKernels);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCGaloisField();
+    virtual ~testCGaloisField();
+    void setUp();
+    void tearDown();
+
+private:
+    void testArithmetic();
+    void testKernels();
+};
+
+#endif /* TESTCGALOISFIELD_H */
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCJoinPacket.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 5, 2021, 4:30 PM
+ */
+
+#include "testCJoinPacket.h"
+#include "../CJoinPacket.h"
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCJoinPacket);
+
+testCJoinPacket::testCJoinPacket()
+{
+}
+
+testCJoinPacket::~testCJoinPacket()
+{
+}
+
+void testCJoinPacket::setUp()
+{
+}
+
+void testCJoinPacket::tearDown()
+{
+}
+
+void testCJoinPacket::testBuildAndRead()
+{
+   uint8_t datagram[CJoinBuilder::maxLength];
+
+   CJoinBuilder join(datagram, ERmdgpPacketType::join, 77, 3, 300, { 1000, 1500 });
+   // id 300 and size 500: 2 bytes each
+   CPPUNIT_ASSERT_EQUAL(CRmdgpHeader::size + 4, join.getLength());
+
+   const CRmdgpHeaderView header(datagram);
+   CPPUNIT_ASSERT(ERmdgpValidation::valid ==
+                  CRmdgpHeaderView::validate(datagram, join.getLength()));
+   CPPUNIT_ASSERT(ERmdgpPacketType::join == header.getType());
+   CPPUNIT_ASSERT_EQUAL(uint32_t(77), header.getSessionId());
+   CPPUNIT_ASSERT_EQUAL(uint32_t(3), header.getStreamId());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1000), header.getSequence());
+
+   CJoinReader reader(datagram, join.getLength());
+   CPPUNIT_ASSERT(!reader.isMalformed());
+   CPPUNIT_ASSERT_EQUAL(uint32_t(300), reader.getReceiverId());
+   CPPUNIT_ASSERT(SSequenceRange({ 1000, 1500 }) == reader.getRange());
+
+   // an accept of an empty range, the sender has nothing left to replay
+   CJoinBuilder accept(datagram, ERmdgpPacketType::joinAccept, 77, 3, 300, { 1500, 1500 });
+   CPPUNIT_ASSERT(ERmdgpValidation::valid ==
+                  CRmdgpHeaderView::validate(datagram, accept.getLength()));
+   CPPUNIT_ASSERT(ERmdgpPacketType::joinAccept == CRmdgpHeaderView(datagram).getType());
+   CJoinReader acceptReader(datagram, accept.getLength());
+   CPPUNIT_ASSERT(!acceptReader.isMalformed());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), acceptReader.getRange().size());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1500), acceptReader.getRange().begin);
+
+   // the largest values fit in maxLength
+   CJoinBuilder largest(datagram, ERmdgpPacketType::join, 1, 1, UINT32_MAX,
+                        { 0, uint64_t(INT64_MAX) - 1 });
+   CPPUNIT_ASSERT(largest.getLength() <= CJoinBuilder::maxLength);
+   CJoinReader largestReader(datagram, largest.getLength());
+   CPPUNIT_ASSERT(!largestReader.isMalformed());
+   CPPUNIT_ASSERT_EQUAL(UINT32_MAX, largestReader.getReceiverId());
+}
+
+void testCJoinPacket::testWrapAround()
+{
+   uint8_t datagram[CJoinBuilder::maxLength];
+
+   CJoinBuilder join(datagram, ERmdgpPacketType::join, 1, 1, 5, { UINT64_MAX - 9, 10 });
+   CJoinReader reader(datagram, join.getLength());
+   CPPUNIT_ASSERT(!reader.isMalformed());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(20), reader.getRange().size());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(10), reader.getRange().end);
+}
+
+void testCJoinPacket::testMalformed()
+{
+   uint8_t datagram[CJoinBuilder::maxLength];
+
+   CJoinBuilder join(datagram, ERmdgpPacketType::join, 1, 1, 1000, { 10, 2000 });
+
+   // cut in the middle of the size
+   CJoinReader truncated(datagram, join.getLength() - 1);
+   CPPUNIT_ASSERT(truncated.isMalformed());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), truncated.getRange().size());
+
+   // no payload at all
+   CJoinReader empty(datagram, CRmdgpHeader::size);
+   CPPUNIT_ASSERT(empty.isMalformed());
+
+   // a receiver id larger than 32 bits
+   const uint8_t tooLarge[] = { 0xff, 0xff, 0xff, 0xff, 0x7f, 0x01 };
+   for(size_t i = 0; i < sizeof(tooLarge); i++)
+      datagram[CRmdgpHeader::size + i] = tooLarge[i];
+   CJoinReader largeId(datagram, CRmdgpHeader::size + sizeof(tooLarge));
+   CPPUNIT_ASSERT(largeId.isMalformed());
+}
@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCLossTracker.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 20, 2021, 4:20 PM
+ */
+
+#include "testCLossTracker.h"
+#include "../CLossTracker.h"
+#include <sstream>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCLossTracker);
+
+typedef CLossTracker::EResult EResult;
+
+testCLossTracker::testCLossTracker()
+{
+}
+
+testCLossTracker::~testCLossTracker()
+{
+}
+
+void testCLossTracker::setUp()
+{
+}
+
+void testCLossTracker::tearDown()
+{
+}
+
+void testCLossTracker::verifyHoles(const std::string testName, const CLossTracker &tracker,
+                    const std::vector<uint64_t> &expected)
+{
+   std::ostringstream result, expectedText;
+   uint64_t missing = 0;
+
+   for(CLossTracker::THoles::const_iterator hole = tracker.getHoles().begin();
+       hole != tracker.getHoles().end(); ++hole)
+      result << "[" << hole->first << "," << hole->second << ")";
+   for(size_t i = 0; i + 1 < expected.size(); i += 2)
+   {
+      expectedText << "[" << expected[i] << "," << expected[i + 1] << ")";
+      missing += expected[i + 1] - expected[i];
+   }
+
+   if(result.str() != expectedText.str() || missing != tracker.getMissingCount())
+   {
+      std::ostringstream message;
+      message << testName << ", Result:" << result.str() << " missing " << tracker.getMissingCount()
+              << " expected:" << expectedText.str() << " missing " << missing;
+      CPPUNIT_FAIL(message.str());
+   }
+}
+
+void testCLossTracker::testInOrder()
+{
+   CLossTracker tracker(100);
+
+   for(uint64_t sequence = 100; sequence < 110; sequence++)
+      CPPUNIT_ASSERT(EResult::inOrder == tracker.receive(sequence));
+
+   CPPUNIT_ASSERT_EQUAL(uint64_t(110), tracker.getNextExpected());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(110), tracker.getFirstMissing());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(100), tracker.getBase());
+   verifyHoles("in order", tracker, {});
+}
+
+void testCLossTracker::testBurstLoss()
+{
+   CLossTracker tracker(0);
+
+   tracker.receive(0);
+   CPPUNIT_ASSERT(EResult::gapDetected == tracker.receive(50));
+   verifyHoles("burst", tracker, { 1, 50 });
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), tracker.getFirstMissing());
+   CPPUNIT_ASSERT(tracker.isMissing(1));
+   CPPUNIT_ASSERT(tracker.isMissing(49));
+   CPPUNIT_ASSERT(!tracker.isMissing(50));
+   CPPUNIT_ASSERT(!tracker.isMissing(0));
+
+   CPPUNIT_ASSERT(EResult::gapDetected == tracker.receive(60));
+   verifyHoles("second burst", tracker, { 1, 50, 51, 60 });
+
+   // repairs at the front, in the middle and at the end of a hole
+   CPPUNIT_ASSERT(EResult::repaired == tracker.receive(1));
+   CPPUNIT_ASSERT(EResult::repaired == tracker.receive(25));
+   CPPUNIT_ASSERT(EResult::repaired == tracker.receive(49));
+   verifyHoles("repairs", tracker, { 2, 25, 26, 49, 51, 60 });
+
+   // repair the whole first burst
+   for(uint64_t sequence = 2; sequence < 50; sequence++)
+      tracker.receive(sequence);
+   verifyHoles("first burst repaired", tracker, { 51, 60 });
+   CPPUNIT_ASSERT_EQUAL(uint64_t(51), tracker.getFirstMissing());
+}
+
+void testCLossTracker::testReordering()
+{
+   CLossTracker tracker(10);
+
+   // 10 12 11 13 15 14 16: every swap opens and closes a hole
+   CPPUNIT_ASSERT(EResult::inOrder == tracker.receive(10));
+   CPPUNIT_ASSERT(EResult::gapDetected == tracker.receive(12));
+   CPPUNIT_ASSERT(EResult::repaired == tracker.receive(11));
+   CPPUNIT_ASSERT(EResult::inOrder == tracker.receive(13));
+   CPPUNIT_ASSERT(EResult::gapDetected == tracker.receive(15));
+   CPPUNIT_ASSERT(EResult::repaired == tracker.receive(14));
+   CPPUNIT_ASSERT(EResult::inOrder == tracker.receive(16));
+   verifyHoles("reordered", tracker, {});
+
+   // the first datagrams arrive late
+   CLossTracker tracker2(0);
+   CPPUNIT_ASSERT(EResult::gapDetected == tracker2.receive(3));
+   verifyHoles("late start", tracker2, { 0, 3 });
+   CPPUNIT_ASSERT(EResult::repaired == tracker2.receive(2));
+   CPPUNIT_ASSERT(EResult::repaired == tracker2.receive(0));
+   CPPUNIT_ASSERT(EResult::repaired == tracker2.receive(1));
+   verifyHoles("late start repaired", tracker2, {});
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), tracker2.getFirstMissing());
+}
+
+void testCLossTracker::testDuplicate()
+{
+   CLossTracker tracker(0);
+
+   tracker.receive(0);
+   tracker.receive(5);
+   CPPUNIT_ASSERT(EResult::duplicate == tracker.receive(0));
+   CPPUNIT_ASSERT(EResult::duplicate == tracker.receive(5));
+   CPPUNIT_ASSERT(EResult::repaired == tracker.receive(3));
+   CPPUNIT_ASSERT(EResult::duplicate == tracker.receive(3));
+   verifyHoles("duplicates", tracker, { 1, 3, 4, 5 });
+
+   tracker.forget(2);
+   CPPUNIT_ASSERT(EResult::tooOld == tracker.receive(1));
+}
+
+void testCLossTracker::testWrapAround()
+{
+   const uint64_t start = UINT64_MAX - 5;
+   CLossTracker tracker(start);
+
+   tracker.receive(start);
+   // a gap across the end of the sequence numbers
+   CPPUNIT_ASSERT(EResult::gapDetected == tracker.receive(3));
+   verifyHoles("wrap", tracker, { start + 1, 3 });
+   CPPUNIT_ASSERT_EQUAL(uint64_t(8), tracker.getMissingCount());
+   CPPUNIT_ASSERT(tracker.isMissing(UINT64_MAX));
+   CPPUNIT_ASSERT(tracker.isMissing(0));
+
+   CPPUNIT_ASSERT(EResult::repaired == tracker.receive(UINT64_MAX));
+   CPPUNIT_ASSERT(EResult::repaired == tracker.receive(1));
+   verifyHoles("wrap repaired", tracker, { start + 1, UINT64_MAX, 0, 1, 2, 3 });
+   CPPUNIT_ASSERT_EQUAL(start + 1, tracker.getFirstMissing());
+
+   CPPUNIT_ASSERT(EResult::inOrder == tracker.receive(4));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(5), tracker.forget(1));
+   verifyHoles("wrap forget", tracker, { 2, 3 });
+   CPPUNIT_ASSERT(EResult::tooOld == tracker.receive(UINT64_MAX - 1));
+}
+
+void testCLossTracker::testForget()
+{
+   CLossTracker tracker(0);
+
+   tracker.receive(0);
+   tracker.receive(10);
+   tracker.receive(20);
+   verifyHoles("before", tracker, { 1, 10, 11, 20 });
+
+   // nothing before the base
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), tracker.forget(0));
+   // a part of a hole
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), tracker.forget(5));
+   verifyHoles("part", tracker, { 5, 10, 11, 20 });
+   CPPUNIT_ASSERT_EQUAL(uint64_t(5), tracker.getBase());
+   // a whole hole and a part
+   CPPUNIT_ASSERT_EQUAL(uint64_t(6), tracker.forget(12));
+   verifyHoles("whole", tracker, { 12, 20 });
+   // beyond the last received, the next expected moves along
+   CPPUNIT_ASSERT_EQUAL(uint64_t(8), tracker.forget(30));
+   verifyHoles("all", tracker, {});
+   CPPUNIT_ASSERT_EQUAL(uint64_t(30), tracker.getNextExpected());
+   CPPUNIT_ASSERT(EResult::inOrder == tracker.receive(30));
+}
+
+void testCLossTracker::testExpect()
+{
+   CLossTracker tracker(0);
+
+   tracker.receive(0);
+   tracker.receive(1);
+   // the end of the burst is lost, a heartbeat says up to 5 is sent
+   CPPUNIT_ASSERT_EQUAL(uint64_t(3), tracker.expect(5));
+   verifyHoles("tail", tracker, { 2, 5 });
+   CPPUNIT_ASSERT_EQUAL(uint64_t(5), tracker.getNextExpected());
+   // an old or repeated heartbeat changes nothing
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), tracker.expect(5));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), tracker.expect(3));
+
+   // a following gap grows the same hole
+   CPPUNIT_ASSERT(EResult::gapDetected == tracker.receive(7));
+   verifyHoles("grown", tracker, { 2, 7 });
+   CPPUNIT_ASSERT_EQUAL(uint64_t(5), tracker.getMissingCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(2), tracker.expect(10));
+   verifyHoles("after", tracker, { 2, 7, 8, 10 });
+
+   CPPUNIT_ASSERT(EResult::repaired == tracker.receive(4));
+   CPPUNIT_ASSERT(EResult::inOrder == tracker.receive(10));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(6), tracker.getMissingCount());
+}
+
+void testCLossTracker::testManyHoles()
+{
+   const uint64_t holes = 300000;
+   CLossTracker tracker(0);
+
+   // every other datagram is lost
+   for(uint64_t sequence = 0; sequence < 2 * holes; sequence += 2)
+      tracker.receive(sequence);
+   tracker.receive(2 * holes);
+   CPPUNIT_ASSERT_EQUAL(size_t(holes), tracker.getHoleCount());
+   CPPUNIT_ASSERT_EQUAL(holes, tracker.getMissingCount());
+
+   // repair them from the back to the front
+   for(uint64_t sequence = 2 * holes - 1; sequence < 2 * holes; sequence -= 2)
+      CPPUNIT_ASSERT(EResult::repaired == tracker.receive(sequence));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), tracker.getHoleCount());
+   CPPUNIT_ASSERT_EQUAL(2 * holes + 1, tracker.getFirstMissing());
+}
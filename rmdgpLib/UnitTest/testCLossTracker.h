@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCLossTracker.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 20, 2021, 4:20 PM
+ */
+
+#ifndef TESTCLOSSTRACKER_H
+#define TESTCLOSSTRACKER_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class CLossTracker;
+
+class testCLossTracker : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCLossTracker);
+
+    CPPUNIT_TEST(testInOrder);
+    CPPUNIT_TEST(testBurstLoss);
+    CPPUNIT_TEST(testReordering);
+    CPPUNIT_TEST(testDuplicate);
+    CPPUNIT_TEST(testWrapAround);
+    CPPUNIT_TEST(testForget);
+    CPPUNIT_TEST(testExpect);
+    CPPUNIT_TEST(testManyHoles);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCLossTracker();
+    virtual ~testCLossTracker();
+    void setUp();
+    void tearDown();
+
+private:
+    void testInOrder();
+    void testBurstLoss();
+    void testReordering();
+    void testDuplicate();
+    void testWrapAround();
+    void testForget();
+    void testExpect();
+    void testManyHoles();
+
+    /// \brief compares the holes of tracker with expected, a list of begin, end pairs
+    void verifyHoles(const std::string testName, const CLossTracker &tracker,
+                    const std::vector<uint64_t> &expected);
+};
+
+#endif /* TESTCLOSSTRACKER_H */
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCMessageBatch.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 4, 2021, 10:05 AM
+ */
+
+#include "testCMessageBatch.h"
+#include "../CMessageBatch.h"
+#include <string>
+#include <vector>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCMessageBatch);
+
+testCMessageBatch::testCMessageBatch()
+{
+}
+
+testCMessageBatch::~testCMessageBatch()
+{
+}
+
+void testCMessageBatch::setUp()
+{
+}
+
+void testCMessageBatch::tearDown()
+{
+}
+
+void testCMessageBatch::testBuild()
+{
+   CMessageBatchBuilder builder(10);
+   const uint8_t first[3] = { 1, 2, 3 };
+   const uint8_t second[4] = { 4, 5, 6, 7 };
+
+   CPPUNIT_ASSERT(builder.isEmpty());
+   CPPUNIT_ASSERT_EQUAL(size_t(10), builder.getCapacity());
+   CPPUNIT_ASSERT(builder.add(first, sizeof(first)));
+   CPPUNIT_ASSERT(builder.add(second, sizeof(second)));
+   CPPUNIT_ASSERT_EQUAL(size_t(2), builder.getMessageCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(9), builder.getLength());
+   const std::vector<uint8_t> expected = { 3, 1, 2, 3, 4, 4, 5, 6, 7 };
+   CPPUNIT_ASSERT(expected == std::vector<uint8_t>(builder.getData(), builder.getData() + 9));
+
+   // an empty message still fits, a byte more doesn't
+   CPPUNIT_ASSERT(builder.fits(0));
+   CPPUNIT_ASSERT(!builder.fits(1));
+   CPPUNIT_ASSERT(!builder.add(first, 1));
+   CPPUNIT_ASSERT(builder.add(nullptr, 0));
+   CPPUNIT_ASSERT_EQUAL(size_t(10), builder.getLength());
+
+   builder.clear();
+   CPPUNIT_ASSERT(builder.isEmpty());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), builder.getLength());
+
+   // a message of 128 bytes or more has a two byte length
+   CPPUNIT_ASSERT_EQUAL(size_t(128 + 2), CMessageBatchBuilder::getEncodedSize(128));
+   CPPUNIT_ASSERT_EQUAL(size_t(127 + 1), CMessageBatchBuilder::getEncodedSize(127));
+}
+
+void testCMessageBatch::testRead()
+{
+   CMessageBatchBuilder builder(1400);
+   std::vector<std::string> messages;
+
+   for(size_t i = 0; i < 20; i++)
+   {
+      messages.push_back(std::string(i * 7, char('a' + i)));
+      CPPUNIT_ASSERT(builder.add(messages.back().data(), messages.back().size()));
+   }
+
+   CMessageBatchReader reader(builder.getData(), builder.getLength());
+   const uint8_t *message;
+   size_t length;
+   for(size_t i = 0; i < messages.size(); i++)
+   {
+      CPPUNIT_ASSERT(reader.next(message, length));
+      CPPUNIT_ASSERT_EQUAL(messages[i], std::string((const char*)message, length));
+      // the message is read in place
+      CPPUNIT_ASSERT(message >= builder.getData() &&
+                     message + length <= builder.getData() + builder.getLength());
+   }
+   CPPUNIT_ASSERT(!reader.next(message, length));
+   CPPUNIT_ASSERT(!reader.isMalformed());
+}
+
+void testCMessageBatch::testMalformed()
+{
+   const uint8_t tooLong[] = { 2, 'a', 'b', 5, 'c' };
+   CMessageBatchReader reader(tooLong, sizeof(tooLong));
+   const uint8_t *message;
+   size_t length;
+
+   CPPUNIT_ASSERT(reader.next(message, length));
+   CPPUNIT_ASSERT_EQUAL(size_t(2), length);
+   CPPUNIT_ASSERT(!reader.next(message, length));
+   CPPUNIT_ASSERT(reader.isMalformed());
+   CPPUNIT_ASSERT(!reader.next(message, length));
+
+   // a length prefix that is cut off
+   const uint8_t truncated[] = { 0x80 };
+   CMessageBatchReader truncatedReader(truncated, sizeof(truncated));
+   CPPUNIT_ASSERT(!truncatedReader.next(message, length));
+   CPPUNIT_ASSERT(truncatedReader.isMalformed());
+
+   CMessageBatchReader emptyReader(tooLong, 0);
+   CPPUNIT_ASSERT(!emptyReader.next(message, length));
+   CPPUNIT_ASSERT(!emptyReader.isMalformed());
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCMessageBatch.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 4, 2021, 10:05 AM
+ */
+
+#ifndef TESTCMESSAGEBATCH_H
+#define TESTCMESSAGEBATCH_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class testCMessageBatch : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCMessageBatch);
+
+    CPPUNIT_TEST(testBuild);
+    CPPUNIT_TEST(testRead);
+    CPPUNIT_TEST(testMalformed);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCMessageBatch();
+    virtual ~testCMessageBatch();
+    void setUp();
+    void tearDown();
+
+private:
+    void testBuild();
+    void testRead();
+    void testMalformed();
+};
+
+#endif /* TESTCMESSAGEBATCH_H */
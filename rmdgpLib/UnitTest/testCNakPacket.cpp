@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCNakPacket.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 20, 2021, 5:30 PM
+ */
+
+#include "testCNakPacket.h"
+#include "../CNakPacket.h"
+#include "../CVarInt.h"
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCNakPacket);
+
+testCNakPacket::testCNakPacket()
+{
+}
+
+testCNakPacket::~testCNakPacket()
+{
+}
+
+void testCNakPacket::setUp()
+{
+}
+
+void testCNakPacket::tearDown()
+{
+}
+
+void testCNakPacket::testBuildAndRead()
+{
+   uint8_t datagram[1472];
+   const SSequenceRange ranges[] = { { 1000, 1001 }, { 1005, 1100 }, { 1100000, 1100002 } };
+   SSequenceRange range;
+
+   CNakBuilder builder(datagram, sizeof(datagram), 77, 3, 4711);
+   for(const SSequenceRange &r : ranges)
+      CPPUNIT_ASSERT(builder.add(r));
+   CPPUNIT_ASSERT_EQUAL(size_t(3), builder.getRangeCount());
+   // receiver id 4711: 2 bytes, 0,0 4,94 1098900,1: 1 + 1 + 1 + 1 + 3 + 1 bytes
+   CPPUNIT_ASSERT_EQUAL(CRmdgpHeader::size + 10, builder.getLength());
+
+   CPPUNIT_ASSERT(ERmdgpValidation::valid ==
+                  CRmdgpHeaderView::validate(datagram, builder.getLength()));
+   const CRmdgpHeaderView header(datagram);
+   CPPUNIT_ASSERT(ERmdgpPacketType::nak == header.getType());
+   CPPUNIT_ASSERT_EQUAL(uint32_t(77), header.getSessionId());
+   CPPUNIT_ASSERT_EQUAL(uint32_t(3), header.getStreamId());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1000), header.getSequence());
+
+   CNakReader reader(datagram, builder.getLength());
+   CPPUNIT_ASSERT_EQUAL(uint32_t(4711), reader.getReceiverId());
+   for(const SSequenceRange &r : ranges)
+   {
+      CPPUNIT_ASSERT(reader.next(range));
+      CPPUNIT_ASSERT_EQUAL(r.begin, range.begin);
+      CPPUNIT_ASSERT_EQUAL(r.end, range.end);
+   }
+   CPPUNIT_ASSERT(!reader.next(range));
+   CPPUNIT_ASSERT(!reader.isMalformed());
+}
+
+void testCNakPacket::testManyRanges()
+{
+   uint8_t datagram[1472];
+   SSequenceRange range;
+   uint64_t sequence = 5000000;
+   size_t added = 0;
+
+   // single losses a few datagrams apart take 2 bytes per range
+   CNakBuilder builder(datagram, sizeof(datagram), 1, 1, 1);
+   while(builder.add({ sequence, sequence + 1 }))
+   {
+      sequence += 10;
+      added++;
+   }
+   CPPUNIT_ASSERT_EQUAL((sizeof(datagram) - CRmdgpHeader::size - 1) / 2, added);
+   CPPUNIT_ASSERT(builder.getLength() <= sizeof(datagram));
+
+   CNakReader reader(datagram, builder.getLength());
+   sequence = 5000000;
+   for(size_t i = 0; i < added; i++, sequence += 10)
+   {
+      CPPUNIT_ASSERT(reader.next(range));
+      CPPUNIT_ASSERT_EQUAL(sequence, range.begin);
+      CPPUNIT_ASSERT_EQUAL(uint64_t(1), range.size());
+   }
+   CPPUNIT_ASSERT(!reader.next(range));
+}
+
+void testCNakPacket::testWrapAround()
+{
+   uint8_t datagram[100];
+   SSequenceRange range;
+
+   CNakBuilder builder(datagram, sizeof(datagram), 1, 1, 1);
+   CPPUNIT_ASSERT(builder.add({ UINT64_MAX - 2, 2 }));
+   CPPUNIT_ASSERT(builder.add({ 4, 5 }));
+
+   CNakReader reader(datagram, builder.getLength());
+   CPPUNIT_ASSERT(reader.next(range));
+   CPPUNIT_ASSERT_EQUAL(UINT64_MAX - 2, range.begin);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(2), range.end);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(5), range.size());
+   CPPUNIT_ASSERT(reader.next(range));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), range.begin);
+}
+
+void testCNakPacket::testRejectedRanges()
+{
+   uint8_t datagram[100];
+
+   CNakBuilder builder(datagram, sizeof(datagram), 1, 1, 1);
+   CPPUNIT_ASSERT(!builder.add({ 10, 10 }));
+   CPPUNIT_ASSERT(builder.add({ 10, 20 }));
+   // overlapping or before the previous range
+   CPPUNIT_ASSERT(!builder.add({ 19, 25 }));
+   CPPUNIT_ASSERT(!builder.add({ 1, 2 }));
+   // adjacent is fine
+   CPPUNIT_ASSERT(builder.add({ 20, 25 }));
+   CPPUNIT_ASSERT_EQUAL(size_t(2), builder.getRangeCount());
+
+   // no room for a range at all, after the receiver id
+   CNakBuilder small(datagram, CRmdgpHeader::size + 2, 1, 1, 1);
+   CPPUNIT_ASSERT(!small.add({ 10, 11 }));
+   CPPUNIT_ASSERT_EQUAL(CRmdgpHeader::size + 1, small.getLength());
+}
+
+void testCNakPacket::testMalformed()
+{
+   uint8_t datagram[100];
+   SSequenceRange range;
+
+   CNakBuilder builder(datagram, sizeof(datagram), 1, 1, 1);
+   builder.add({ 10, 20 });
+   builder.add({ 1000, 2000 });
+
+   // cut in the middle of the last varint
+   CNakReader truncated(datagram, builder.getLength() - 1);
+   CPPUNIT_ASSERT(truncated.next(range));
+   CPPUNIT_ASSERT(!truncated.next(range));
+   CPPUNIT_ASSERT(truncated.isMalformed());
+
+   // no receiver id
+   CNakReader noId(datagram, CRmdgpHeader::size);
+   CPPUNIT_ASSERT(noId.isMalformed());
+   CPPUNIT_ASSERT(!noId.next(range));
+
+   // a varint that doesn't end
+   for(size_t i = CRmdgpHeader::size; i < sizeof(datagram); i++)
+      datagram[i] = 0xff;
+   CNakReader endless(datagram, sizeof(datagram));
+   CPPUNIT_ASSERT(!endless.next(range));
+   CPPUNIT_ASSERT(endless.isMalformed());
+}
+
+void testCNakPacket::testVarInt()
+{
+   uint8_t buffer[CVarInt::maxSize];
+   const uint64_t values[] = { 0, 1, 127, 128, 16383, 16384, UINT32_MAX, UINT64_MAX };
+   const size_t sizes[] = { 1, 1, 1, 2, 2, 3, 5, 10 };
+   uint64_t value;
+
+   for(size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+   {
+      CPPUNIT_ASSERT_EQUAL(sizes[i], CVarInt::size(values[i]));
+      CPPUNIT_ASSERT_EQUAL(sizes[i], CVarInt::encode(buffer, sizeof(buffer), values[i]));
+      CPPUNIT_ASSERT_EQUAL(sizes[i], CVarInt::decode(buffer, sizeof(buffer), value));
+      CPPUNIT_ASSERT_EQUAL(values[i], value);
+   }
+   CPPUNIT_ASSERT_EQUAL(size_t(0), CVarInt::encode(buffer, 1, 128));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), CVarInt::decode(buffer, 0, value));
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCNakPacket.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 20, 2021, 5:30 PM
+ */
+
+#ifndef TESTCNAKPACKET_H
+#define TESTCNAKPACKET_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class testCNakPacket : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCNakPacket);
+
+    CPPUNIT_TEST(testBuildAndRead);
+    CPPUNIT_TEST(testManyRanges);
+    CPPUNIT_TEST(testWrapAround);
+    CPPUNIT_TEST(testRejectedRanges);
+    CPPUNIT_TEST(testMalformed);
+    CPPUNIT_TEST(testVarInt);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCNakPacket();
+    virtual ~testCNakPacket();
+    void setUp();
+    void tearDown();
+
+private:
+    void testBuildAndRead();
+    void testManyRanges();
+    void testWrapAround();
+    void testRejectedRanges();
+    void testMalformed();
+    void testVarInt();
+};
+
+#endif /* TESTCNAKPACKET_H */
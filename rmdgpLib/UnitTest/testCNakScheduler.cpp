@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCNakScheduler.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 28, 2021, 7:10 PM
+ */
+
+#include "testCNakScheduler.h"
+#include "../CNakScheduler.h"
+#include <vector>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCNakScheduler);
+
+namespace {
+   const CNanoTime start = CNanoTime::fromSec(50);
+   const CNanoTime rtt = CNanoTime::fromMsec(1);
+}
+
+testCNakScheduler::testCNakScheduler()
+{
+}
+
+testCNakScheduler::~testCNakScheduler()
+{
+}
+
+void testCNakScheduler::setUp()
+{
+}
+
+void testCNakScheduler::tearDown()
+{
+}
+
+void testCNakScheduler::testDelay()
+{
+   CNakScheduler scheduler(7);
+   CNanoTime uniformSum, exponentialSum;
+
+   scheduler.setRtt(rtt);
+   scheduler.setBackoff(1.0, 4.0, 0.0);
+   for(int i = 0; i < 1000; i++)
+   {
+      const CNanoTime delay = scheduler.getDelay(0);
+      CPPUNIT_ASSERT(delay >= rtt && delay < rtt * 5);
+      uniformSum += delay;
+      const CNanoTime doubled = scheduler.getDelay(2);
+      CPPUNIT_ASSERT(doubled >= rtt * 4 && doubled < rtt * 20);
+   }
+   scheduler.setBackoff(1.0, 4.0, 8.0);
+   for(int i = 0; i < 1000; i++)
+   {
+      const CNanoTime delay = scheduler.getDelay(0);
+      CPPUNIT_ASSERT(delay >= rtt && delay < rtt * 5);
+      exponentialSum += delay;
+   }
+   // the uniform average is 3 rtt, most exponential delays are late
+   CPPUNIT_ASSERT(uniformSum / 1000 > CNanoTime::fromUsec(2800) &&
+                  uniformSum / 1000 < CNanoTime::fromUsec(3200));
+   CPPUNIT_ASSERT(exponentialSum / 1000 > rtt * 4);
+}
+
+void testCNakScheduler::testTakeDue()
+{
+   CNakScheduler scheduler(7);
+   std::vector<SSequenceRange> due;
+
+   // without random part the delay is c1 * rtt
+   scheduler.setRtt(rtt);
+   scheduler.setBackoff(1.0, 0.0, 0.0);
+   scheduler.add({ 10, 12 });
+   scheduler.add({ 12, 14 });
+   scheduler.add({ 20, 21 });
+   CPPUNIT_ASSERT_EQUAL(size_t(0), scheduler.takeDue(start, due));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), scheduler.takeDue(start + rtt / 2, due));
+
+   // touching ranges are merged
+   CPPUNIT_ASSERT_EQUAL(size_t(2), scheduler.takeDue(start + rtt, due));
+   CPPUNIT_ASSERT(SSequenceRange({ 10, 14 }) == due[0]);
+   CPPUNIT_ASSERT(SSequenceRange({ 20, 21 }) == due[1]);
+   CPPUNIT_ASSERT_EQUAL(size_t(3), scheduler.getPendingCount());
+
+   // a retry waits twice as long
+   CPPUNIT_ASSERT_EQUAL(size_t(0), scheduler.takeDue(start + rtt * 2, due));
+   CPPUNIT_ASSERT_EQUAL(size_t(2), scheduler.takeDue(start + rtt * 3, due));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), scheduler.takeDue(start + rtt * 6, due));
+   CPPUNIT_ASSERT_EQUAL(size_t(2), scheduler.takeDue(start + rtt * 7, due));
+}
+
+void testCNakScheduler::testSuppress()
+{
+   CNakScheduler scheduler(7);
+   std::vector<SSequenceRange> due;
+
+   scheduler.setRtt(rtt);
+   scheduler.setBackoff(1.0, 0.0, 0.0);
+   scheduler.add({ 10, 20 });
+   scheduler.takeDue(start, due);
+
+   // an other receiver asked for a part, that part waits longer
+   CPPUNIT_ASSERT_EQUAL(size_t(1), scheduler.suppress({ 12, 15 }));
+   CPPUNIT_ASSERT_EQUAL(size_t(3), scheduler.getPendingCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), scheduler.getSuppressedCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), scheduler.suppress({ 30, 40 }));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), scheduler.takeDue(start + rtt / 2, due));
+   CPPUNIT_ASSERT_EQUAL(size_t(2), scheduler.takeDue(start + rtt, due));
+   CPPUNIT_ASSERT(SSequenceRange({ 10, 12 }) == due[0]);
+   CPPUNIT_ASSERT(SSequenceRange({ 15, 20 }) == due[1]);
+
+   // the postponed part got its doubled delay at the first call after the suppression, it is
+   // due together with the retries
+   CPPUNIT_ASSERT_EQUAL(size_t(0), scheduler.takeDue(start + rtt * 2, due));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), scheduler.takeDue(start + rtt * 3, due));
+   CPPUNIT_ASSERT(SSequenceRange({ 10, 20 }) == due[0]);
+}
+
+void testCNakScheduler::testReceived()
+{
+   CNakScheduler scheduler(7);
+   std::vector<SSequenceRange> due;
+
+   scheduler.setRtt(rtt);
+   scheduler.setBackoff(1.0, 0.0, 0.0);
+   scheduler.add({ 10, 13 });
+   CPPUNIT_ASSERT(scheduler.received(11));
+   CPPUNIT_ASSERT(!scheduler.received(11));
+   CPPUNIT_ASSERT(!scheduler.received(99));
+   CPPUNIT_ASSERT_EQUAL(size_t(2), scheduler.getPendingCount());
+
+   scheduler.takeDue(start, due);
+   CPPUNIT_ASSERT_EQUAL(size_t(2), scheduler.takeDue(start + rtt, due));
+   CPPUNIT_ASSERT(SSequenceRange({ 10, 11 }) == due[0]);
+   CPPUNIT_ASSERT(SSequenceRange({ 12, 13 }) == due[1]);
+
+   // the repairs cancel everything
+   CPPUNIT_ASSERT(scheduler.received(10));
+   CPPUNIT_ASSERT(scheduler.received(12));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), scheduler.getPendingCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), scheduler.takeDue(start + rtt * 10, due));
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCRateEjectionPolicy.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 27, 2021, 2:05 PM
+ */
+
+#include "testCRateEjectionPolicy.h"
+#include "../CRateEjectionPolicy.h"
+#include "../CReceiverTable.h"
+#include <stdexcept>
+#include <vector>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCRateEjectionPolicy);
+
+namespace {
+   const CNanoTime start = CNanoTime::fromSec(50);
+   const CNanoTime interval = CNanoTime::fromMsec(100);
+   const uint64_t sent = 10000;
+}
+
+testCRateEjectionPolicy::testCRateEjectionPolicy()
+{
+}
+
+testCRateEjectionPolicy::~testCRateEjectionPolicy()
+{
+}
+
+void testCRateEjectionPolicy::setUp()
+{
+}
+
+void testCRateEjectionPolicy::tearDown()
+{
+}
+
+void testCRateEjectionPolicy::testEject()
+{
+   CRateEjectionPolicy policy(1000.0, interval, CNanoTime::fromMsec(300));
+   CReceiverTable table(4);
+   std::vector<uint32_t> eject;
+
+   table.add(1, 0, start);
+   table.add(2, 0, start);
+   // the first call only starts the interval, the next ones wait for its end
+   CPPUNIT_ASSERT(!policy.evaluate(table, sent, start, eject));
+   CPPUNIT_ASSERT(!policy.evaluate(table, sent, start + interval / 2, eject));
+
+   // receiver 1 does 5000 datagrams per second, receiver 2 only 500
+   for(int i = 1; i <= 2; i++)
+   {
+      const CNanoTime now = start + interval * i;
+      table.acknowledge(0, 500 * i, 500 * i, now);
+      table.acknowledge(1, 50 * i, 50 * i, now);
+      CPPUNIT_ASSERT(policy.evaluate(table, sent, now, eject));
+      CPPUNIT_ASSERT(eject.empty());
+      CPPUNIT_ASSERT_EQUAL(uint8_t(0), uint8_t(table.getFlags(0) & receiverFlagSlow));
+      CPPUNIT_ASSERT(table.getFlags(1) & receiverFlagSlow);
+      CPPUNIT_ASSERT_EQUAL(start, table.getSlowSince(1));
+   }
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(5000.0, policy.getLastRate(0), 0.01);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(500.0, policy.getLastRate(1), 0.01);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(100), table.getIntervalAcked(1));
+
+   // the grace period is over
+   table.acknowledge(0, 1500, 1500, start + interval * 3);
+   table.acknowledge(1, 150, 150, start + interval * 3);
+   CPPUNIT_ASSERT(policy.evaluate(table, sent, start + interval * 3, eject));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), eject.size());
+   CPPUNIT_ASSERT_EQUAL(uint32_t(1), eject[0]);
+}
+
+void testCRateEjectionPolicy::testRecover()
+{
+   CRateEjectionPolicy policy(1000.0, interval, CNanoTime::fromMsec(200));
+   CReceiverTable table(4);
+   std::vector<uint32_t> eject;
+
+   table.add(1, 0, start);
+   policy.evaluate(table, sent, start, eject);
+   table.acknowledge(0, 10, 10, start + interval);
+   CPPUNIT_ASSERT(policy.evaluate(table, sent, start + interval, eject));
+   CPPUNIT_ASSERT(table.getFlags(0) & receiverFlagSlow);
+
+   // one good interval clears the slow state, so the grace period starts over
+   table.acknowledge(0, 1000, 1000, start + interval * 2);
+   CPPUNIT_ASSERT(policy.evaluate(table, sent, start + interval * 2, eject));
+   CPPUNIT_ASSERT_EQUAL(uint8_t(0), uint8_t(table.getFlags(0) & receiverFlagSlow));
+   table.acknowledge(0, 1010, 1010, start + interval * 3);
+   CPPUNIT_ASSERT(policy.evaluate(table, sent, start + interval * 3, eject));
+   CPPUNIT_ASSERT(eject.empty());
+   CPPUNIT_ASSERT_EQUAL(start + interval * 2, table.getSlowSince(0));
+}
+
+void testCRateEjectionPolicy::testIdleSender()
+{
+   CRateEjectionPolicy policy(1000.0, interval, CNanoTime());
+   CReceiverTable table(4);
+   std::vector<uint32_t> eject;
+
+   // the receiver has everything, it can't go faster than the sender
+   table.add(1, 20, start);
+   policy.evaluate(table, 20, start, eject);
+   CPPUNIT_ASSERT(policy.evaluate(table, 25, start + interval, eject));
+   CPPUNIT_ASSERT(eject.empty());
+   CPPUNIT_ASSERT_EQUAL(0.0, policy.getLastRate(0));
+
+   // but not when it stays behind, without grace period it is ejected at once
+   CPPUNIT_ASSERT(policy.evaluate(table, 25, start + interval * 2, eject));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), eject.size());
+}
+
+void testCRateEjectionPolicy::testConstructorException()
+{
+   CPPUNIT_ASSERT_THROW(CRateEjectionPolicy(1000.0, CNanoTime(), CNanoTime()),
+                        std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CRateEjectionPolicy(1000.0, interval, CNanoTime::fromNsec(-1)),
+                        std::runtime_error);
+}
@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCReceiverTable.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 26, 2021, 3:30 PM
+ */
+
+#include "testCReceiverTable.h"
+#include "../CReceiverTable.h"
+#include <stdexcept>
+#include <vector>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCReceiverTable);
+
+namespace {
+   const CNanoTime start = CNanoTime::fromSec(50);
+}
+
+testCReceiverTable::testCReceiverTable()
+{
+}
+
+testCReceiverTable::~testCReceiverTable()
+{
+}
+
+void testCReceiverTable::setUp()
+{
+}
+
+void testCReceiverTable::tearDown()
+{
+}
+
+void testCReceiverTable::testAddAndFind()
+{
+   CReceiverTable table(2);
+
+   CPPUNIT_ASSERT_EQUAL(CReceiverTable::invalidIndex, table.find(7));
+   CPPUNIT_ASSERT_EQUAL(uint32_t(0), table.add(7, 100, start));
+   CPPUNIT_ASSERT_EQUAL(uint32_t(1), table.add(900000, 50, start));
+   // known already, or full
+   CPPUNIT_ASSERT_EQUAL(CReceiverTable::invalidIndex, table.add(7, 100, start));
+   CPPUNIT_ASSERT_EQUAL(CReceiverTable::invalidIndex, table.add(8, 100, start));
+
+   CPPUNIT_ASSERT_EQUAL(size_t(2), table.getCount());
+   CPPUNIT_ASSERT_EQUAL(uint32_t(1), table.find(900000));
+   CPPUNIT_ASSERT_EQUAL(uint32_t(900000), table.getReceiverId(1));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(50), table.getAcked(1));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(50), table.getHighestReceived(1));
+   CPPUNIT_ASSERT_EQUAL(start, table.getLastHeard(1));
+   CPPUNIT_ASSERT_EQUAL(uint8_t(0), table.getFlags(1));
+}
+
+void testCReceiverTable::testRemove()
+{
+   CReceiverTable table(4);
+
+   table.add(10, 100, start);
+   table.add(11, 101, start);
+   table.add(12, 102, start);
+
+   // the last receiver moves into the hole
+   table.remove(0);
+   CPPUNIT_ASSERT_EQUAL(size_t(2), table.getCount());
+   CPPUNIT_ASSERT_EQUAL(CReceiverTable::invalidIndex, table.find(10));
+   CPPUNIT_ASSERT_EQUAL(uint32_t(0), table.find(12));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(102), table.getAcked(0));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(102), table.getIntervalAcked(0));
+   CPPUNIT_ASSERT_EQUAL(uint32_t(1), table.find(11));
+
+   table.remove(1);
+   table.remove(5);
+   CPPUNIT_ASSERT_EQUAL(size_t(1), table.getCount());
+   CPPUNIT_ASSERT_EQUAL(uint32_t(1), table.add(10, 100, start));
+}
+
+void testCReceiverTable::testWatermark()
+{
+   CReceiverTable table(16);
+
+   CPPUNIT_ASSERT_EQUAL(uint64_t(500), table.getWatermark(500));
+
+   table.add(1, 300, start);
+   table.add(2, 200, start);
+   table.add(3, 400, start);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(200), table.getWatermark(500));
+
+   // progress of others and overtaken ACKs don't need a scan
+   table.acknowledge(0, 350, 360, start);
+   table.acknowledge(1, 150, 150, start);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(200), table.getWatermark(500));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), table.getScanCount());
+
+   // the slowest receiver moves on
+   table.acknowledge(1, 380, 390, start);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(350), table.getWatermark(500));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), table.getScanCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(350), table.getWatermark(500));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), table.getScanCount());
+
+   // a new receiver behind everybody
+   table.add(4, 100, start);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(100), table.getWatermark(500));
+
+   // the slowest receiver leaves
+   table.remove(table.find(4));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(350), table.getWatermark(500));
+
+   // many receivers, the slowest in the scalar tail of the scan
+   for(uint32_t id = 10; id < 17; id++)
+      table.add(id, 400 + id, start);
+   table.acknowledge(table.find(1), 450, 450, start);
+   table.acknowledge(table.find(16), 405, 420, start);
+   table.acknowledge(table.find(2), 460, 460, start);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(400), table.getWatermark(500));
+}
+
+void testCReceiverTable::testWatermarkWrapAround()
+{
+   CReceiverTable table(8);
+
+   table.add(1, 5, start);
+   table.add(2, UINT64_MAX - 5, start);
+   table.add(3, 2, start);
+   CPPUNIT_ASSERT_EQUAL(UINT64_MAX - 5, table.getWatermark(10));
+
+   // the slowest passes zero
+   table.acknowledge(table.find(2), 1, 1, start);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), table.getWatermark(10));
+}
+
+void testCReceiverTable::testRate()
+{
+   CReceiverTable table(2);
+
+   table.add(1, 0, start);
+   // 1000 datagrams in 10ms
+   table.acknowledge(0, 1000, 1000, start + CNanoTime::fromMsec(10));
+   CPPUNIT_ASSERT(table.getFlags(0) & receiverFlagRateValid);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(100000.0, table.getRate(0), 0.001);
+   CPPUNIT_ASSERT_EQUAL(start + CNanoTime::fromMsec(10), table.getLastHeard(0));
+
+   // a stall counts, smoothed with 1/8
+   table.acknowledge(0, 1000, 1000, start + CNanoTime::fromMsec(20));
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(87500.0, table.getRate(0), 0.001);
+
+   // flags are free for the owner
+   table.setFlags(0, 0x80 | table.getFlags(0));
+   CPPUNIT_ASSERT_EQUAL(uint8_t(0x80 | receiverFlagRateValid), table.getFlags(0));
+}
+
+void testCReceiverTable::testLossRate()
+{
+   CReceiverTable table(3);
+
+   CPPUNIT_ASSERT_EQUAL(0.0, table.getWorstLossRate());
+   table.add(1, 0, start);
+   table.add(2, 0, start);
+   table.add(3, 0, start);
+
+   // the first report is taken as it is, the next ones smoothed with 1/8
+   table.reportLoss(1, 0.04);
+   CPPUNIT_ASSERT(table.getFlags(1) & receiverFlagLossValid);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(0.04, table.getLossRate(1), 1e-6);
+   table.reportLoss(1, 0.0);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(0.035, table.getLossRate(1), 1e-6);
+   table.reportLoss(2, 0.01);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(0.035, table.getWorstLossRate(), 1e-6);
+
+   // the loss rate moves along with a removed receiver
+   table.remove(0);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(0.01, table.getLossRate(0), 1e-6);
+   table.remove(1);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(0.01, table.getWorstLossRate(), 1e-6);
+}
+
+void testCReceiverTable::testScanMin()
+{
+   std::vector<uint64_t> acked;
+
+   // both versions must agree for every length and position of the minimum
+   for(size_t count = 1; count < 20; count++)
+   {
+      acked.assign(count, 1000);
+      for(size_t position = 0; position < count; position++)
+      {
+         acked[position] = 990;
+         CPPUNIT_ASSERT_EQUAL(int64_t(-10), CReceiverTable::scanMin(acked.data(), count, 1000));
+         CPPUNIT_ASSERT_EQUAL(int64_t(-10),
+                              CReceiverTable::scanMinScalar(acked.data(), count, 1000));
+         acked[position] = 1000;
+      }
+   }
+
+   // the distances are signed
+   const uint64_t wrapped[] = { UINT64_MAX, 3, 0, 1, 2 };
+   CPPUNIT_ASSERT_EQUAL(int64_t(-4), CReceiverTable::scanMin(wrapped, 5, 3));
+   CPPUNIT_ASSERT_EQUAL(int64_t(-4), CReceiverTable::scanMinScalar(wrapped, 5, 3));
+}
+
+void testCReceiverTable::testConstructorException()
+{
+   CPPUNIT_ASSERT_THROW(CReceiverTable(0), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CReceiverTable(CReceiverTable::maxCapacity + 1), std::runtime_error);
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCReceiverTable.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 26, 2021, 3:30 PM
+ */
+
+#ifndef TESTCRECEIVERTABLE_H
+#define TESTCRECEIVERTABLE_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class testCReceiverTable : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCReceiverTable);
+
+    CPPUNIT_TEST(testAddAndFind);
+    CPPUNIT_TEST(testRemove);
+    CPPUNIT_TEST(testWatermark);
+    CPPUNIT_TEST(testWatermarkWrapAround);
+    CPPUNIT_TEST(testRate);
+    CPPUNIT_TEST(testLossRate);
+    CPPUNIT_TEST(testScanMin);
+    CPPUNIT_TEST(testConstructorException);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCReceiverTable();
+    virtual ~testCReceiverTable();
+    void setUp();
+    void tearDown();
+
+private:
+    void testAddAndFind();
+    void testRemove();
+    void testWatermark();
+    void testWatermarkWrapAround();
+    void testRate();
+    void testLossRate();
+    void testScanMin();
+    void testConstructorException();
+};
+
+#endif /* TESTCRECEIVERTABLE_H */
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCReedSolomon.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 2, 2021, 10:40 PM
+ */
+
+#include "testCReedSolomon.h"
+#include "../CGaloisField.h"
+#include "../CReedSolomon.h"
+#include <stdexcept>
+#include <vector>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCReedSolomon);
+
+testCReedSolomon::testCReedSolomon()
+{
+}
+
+testCReedSolomon::~testCReedSolomon()
+{
+}
+
+void testCReedSolomon::setUp()
+{
+}
+
+void testCReedSolomon::tearDown()
+{
+}
+
+namespace {
+   /// \brief encodes k shards of length bytes, loses the shards in lostMask and decodes
+   /// \return the result of decode, the data shards must be back when it is true
+   bool loseAndDecode(CReedSolomon &code, size_t length, uint64_t lostMask)
+   {
+      const size_t k = code.getDataShards(), m = code.getParityShards();
+      std::vector<std::vector<uint8_t>> shards(k + m, std::vector<uint8_t>(length));
+      std::vector<uint8_t*> pointers(k + m);
+      bool present[64];
+
+      for(size_t i = 0; i < k + m; i++)
+      {
+         pointers[i] = shards[i].data();
+         present[i] = !(lostMask & (uint64_t(1) << i));
+      }
+      for(size_t i = 0; i < k; i++)
+         for(size_t j = 0; j < length; j++)
+            shards[i][j] = uint8_t(i * 37 + j * 11 + (j >> 8));
+      code.encode(pointers.data(), pointers.data() + k, length);
+      const std::vector<std::vector<uint8_t>> original(shards);
+
+      for(size_t i = 0; i < k + m; i++)
+         if(!present[i])
+            std::fill(shards[i].begin(), shards[i].end(), uint8_t(0x5a));
+      if(!code.decode(pointers.data(), present, length))
+         return false;
+      for(size_t i = 0; i < k; i++)
+         CPPUNIT_ASSERT(original[i] == shards[i]);
+      return true;
+   }
+}
+
+void testCReedSolomon::testCoefficients()
+{
+   CPPUNIT_ASSERT_THROW(CReedSolomon(0, 1), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CReedSolomon(4, 0), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CReedSolomon(CReedSolomon::maxDataShards + 1, 1), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CReedSolomon(4, CReedSolomon::maxParityShards + 1), std::runtime_error);
+
+   // row 0 is the XOR parity, and every 2 x 2 part of the matrix is invertible
+   for(size_t column = 0; column < 64; column++)
+   {
+      CPPUNIT_ASSERT_EQUAL(1, int(CReedSolomon::getCoefficient(0, column)));
+      for(size_t row = 1; row < 8; row++)
+         for(size_t other = 0; other < column; other++)
+            CPPUNIT_ASSERT(CGaloisField::multiply(CReedSolomon::getCoefficient(row - 1, other),
+                                                  CReedSolomon::getCoefficient(row, column)) !=
+                           CGaloisField::multiply(CReedSolomon::getCoefficient(row - 1, column),
+                                                  CReedSolomon::getCoefficient(row, other)));
+   }
+
+   // the XOR of the data
+   CReedSolomon code(3, 1);
+   uint8_t a[2] = { 1, 2 }, b[2] = { 4, 8 }, c[2] = { 16, 32 }, parity[2];
+   const uint8_t *data[3] = { a, b, c };
+   uint8_t *parities[1] = { parity };
+   code.encode(data, parities, 2);
+   CPPUNIT_ASSERT_EQUAL(21, int(parity[0]));
+   CPPUNIT_ASSERT_EQUAL(42, int(parity[1]));
+}
+
+void testCReedSolomon::testErasures()
+{
+   // every combination of up to 2 lost shards of 4 + 2
+   CReedSolomon small(4, 2);
+   for(uint64_t lostMask = 0; lostMask < 64; lostMask++)
+      if(__builtin_popcountll(lostMask) <= 2)
+         CPPUNIT_ASSERT(loseAndDecode(small, 100, lostMask));
+
+   // random losses of 10 + 4, a burst of data shards too
+   CReedSolomon large(10, 4);
+   uint64_t random = 12345;
+   for(int i = 0; i < 200; i++)
+   {
+      uint64_t lostMask = 0;
+      while(__builtin_popcountll(lostMask) < 4)
+      {
+         random ^= random << 13;
+         random ^= random >> 7;
+         random ^= random << 17;
+         lostMask |= uint64_t(1) << (random % 14);
+      }
+      CPPUNIT_ASSERT(loseAndDecode(large, 1000, lostMask));
+   }
+   CPPUNIT_ASSERT(loseAndDecode(large, 1000, 0xf));
+   CPPUNIT_ASSERT(loseAndDecode(large, 1000, 0x3c0));
+}
+
+void testCReedSolomon::testTooManyLost()
+{
+   CReedSolomon code(4, 2);
+
+   CPPUNIT_ASSERT(!loseAndDecode(code, 10, 0x7));
+   // enough shards, but the lost parity doesn't count
+   CPPUNIT_ASSERT(loseAndDecode(code, 10, 0x11));
+   CPPUNIT_ASSERT(!loseAndDecode(code, 10, 0x13));
+}
+
+void testCReedSolomon::testInvert()
+{
+   uint8_t identity[4] = { 1, 0, 0, 1 };
+   CPPUNIT_ASSERT(CReedSolomon::invert(identity, 2));
+   CPPUNIT_ASSERT_EQUAL(1, int(identity[0]));
+   CPPUNIT_ASSERT_EQUAL(0, int(identity[1]));
+
+   // the first pivot is 0, the rows have to swap
+   uint8_t swapped[4] = { 0, 3, 7, 0 };
+   CPPUNIT_ASSERT(CReedSolomon::invert(swapped, 2));
+   CPPUNIT_ASSERT_EQUAL(0, int(swapped[0]));
+   CPPUNIT_ASSERT_EQUAL(int(CGaloisField::inverse(7)), int(swapped[1]));
+   CPPUNIT_ASSERT_EQUAL(int(CGaloisField::inverse(3)), int(swapped[2]));
+   CPPUNIT_ASSERT_EQUAL(0, int(swapped[3]));
+
+   uint8_t singular[4] = { 2, 4, 2, 4 };
+   CPPUNIT_ASSERT(!CReedSolomon::invert(singular, 2));
+}
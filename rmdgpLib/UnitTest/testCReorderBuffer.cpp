@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCReorderBuffer.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 22, 2021, 9:40 PM
+ */
+
+#include "testCReorderBuffer.h"
+#include "../CReorderBuffer.h"
+#include <sstream>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCReorderBuffer);
+
+typedef CReorderBuffer::EResult EResult;
+
+namespace {
+   /// \brief a datagram of 100 bytes, the handle is derived from the sequence number
+   SReceivedDatagram datagram(uint64_t sequence, uint32_t length = 100)
+   {
+      return { sequence, uint32_t(sequence & 0xffff), length };
+   }
+}
+
+testCReorderBuffer::testCReorderBuffer()
+{
+}
+
+testCReorderBuffer::~testCReorderBuffer()
+{
+}
+
+void testCReorderBuffer::setUp()
+{
+}
+
+void testCReorderBuffer::tearDown()
+{
+}
+
+void testCReorderBuffer::verifyReady(CReorderBuffer &buffer, const std::vector<uint64_t> &expected)
+{
+   SReceivedDatagram batch[100];
+   const size_t count = buffer.popReady(batch, 100);
+   std::ostringstream result, expectedText;
+
+   for(size_t i = 0; i < count; i++)
+   {
+      result << batch[i].sequence << " ";
+      CPPUNIT_ASSERT_EQUAL(uint32_t(batch[i].sequence & 0xffff), batch[i].handle);
+   }
+   for(uint64_t sequence : expected)
+      expectedText << sequence << " ";
+   CPPUNIT_ASSERT_EQUAL(expectedText.str(), result.str());
+}
+
+void testCReorderBuffer::testInOrder()
+{
+   CReorderBuffer buffer(8, 10000, 10);
+
+   for(uint64_t sequence = 10; sequence < 100; sequence++)
+   {
+      CPPUNIT_ASSERT(EResult::deliverNow == buffer.insert(datagram(sequence)));
+      verifyReady(buffer, {});
+   }
+   CPPUNIT_ASSERT_EQUAL(uint64_t(100), buffer.getNextSequence());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), buffer.getHeldCount());
+}
+
+void testCReorderBuffer::testGapClosed()
+{
+   CReorderBuffer buffer(8, 10000);
+
+   CPPUNIT_ASSERT(EResult::deliverNow == buffer.insert(datagram(0)));
+   CPPUNIT_ASSERT(EResult::buffered == buffer.insert(datagram(3)));
+   CPPUNIT_ASSERT(EResult::buffered == buffer.insert(datagram(2)));
+   CPPUNIT_ASSERT(EResult::buffered == buffer.insert(datagram(5)));
+   CPPUNIT_ASSERT_EQUAL(size_t(3), buffer.getHeldCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(300), buffer.getHeldBytes());
+   verifyReady(buffer, {});
+
+   // 1 closes the gap: 1 is delivered by the caller, 2 and 3 come in one batch
+   CPPUNIT_ASSERT(EResult::deliverNow == buffer.insert(datagram(1)));
+   verifyReady(buffer, { 2, 3 });
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), buffer.getNextSequence());
+   CPPUNIT_ASSERT(EResult::deliverNow == buffer.insert(datagram(4)));
+   verifyReady(buffer, { 5 });
+   CPPUNIT_ASSERT_EQUAL(size_t(0), buffer.getHeldCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), buffer.getHeldBytes());
+}
+
+void testCReorderBuffer::testDuplicateAndOld()
+{
+   CReorderBuffer buffer(8, 10000, 100);
+
+   buffer.insert(datagram(100));
+   buffer.insert(datagram(102));
+   CPPUNIT_ASSERT(EResult::duplicate == buffer.insert(datagram(102)));
+   CPPUNIT_ASSERT(EResult::tooOld == buffer.insert(datagram(100)));
+   CPPUNIT_ASSERT(EResult::tooOld == buffer.insert(datagram(5)));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), buffer.getHeldCount());
+   CPPUNIT_ASSERT(EResult::duplicate == buffer.check(102, 100));
+   CPPUNIT_ASSERT(EResult::deliverNow == buffer.check(101, 100));
+}
+
+void testCReorderBuffer::testBounds()
+{
+   // a window of 8, but at most 5 datagrams or 410 bytes held
+   CReorderBuffer buffer(5, 410);
+   CPPUNIT_ASSERT_EQUAL(size_t(8), buffer.getWindow());
+
+   CPPUNIT_ASSERT(EResult::full == buffer.insert(datagram(8)));
+   CPPUNIT_ASSERT(EResult::buffered == buffer.insert(datagram(7)));
+   CPPUNIT_ASSERT(EResult::buffered == buffer.insert(datagram(6)));
+   CPPUNIT_ASSERT(EResult::buffered == buffer.insert(datagram(5)));
+   CPPUNIT_ASSERT(EResult::buffered == buffer.insert(datagram(4)));
+   // over the byte bound
+   CPPUNIT_ASSERT(EResult::full == buffer.insert(datagram(3)));
+   CPPUNIT_ASSERT(EResult::buffered == buffer.insert(datagram(1, 10)));
+   CPPUNIT_ASSERT_EQUAL(size_t(410), buffer.getHeldBytes());
+   // over the datagram bound
+   CPPUNIT_ASSERT(EResult::full == buffer.insert(datagram(2, 1)));
+   CPPUNIT_ASSERT_EQUAL(size_t(5), buffer.getHeldCount());
+
+   // the next one is always accepted, it isn't held
+   CPPUNIT_ASSERT(EResult::deliverNow == buffer.insert(datagram(0)));
+   verifyReady(buffer, { 1 });
+}
+
+void testCReorderBuffer::testBatchLimit()
+{
+   CReorderBuffer buffer(16, 10000);
+   SReceivedDatagram batch[3];
+
+   for(uint64_t sequence = 1; sequence < 10; sequence++)
+      buffer.insert(datagram(sequence));
+   CPPUNIT_ASSERT(EResult::deliverNow == buffer.insert(datagram(0)));
+
+   CPPUNIT_ASSERT_EQUAL(size_t(3), buffer.popReady(batch, 3));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(3), batch[2].sequence);
+   // the next ready one is held, so it is a duplicate and not in order
+   CPPUNIT_ASSERT(EResult::duplicate == buffer.insert(datagram(4)));
+   verifyReady(buffer, { 4, 5, 6, 7, 8, 9 });
+}
+
+void testCReorderBuffer::testSkip()
+{
+   CReorderBuffer buffer(8, 10000);
+
+   buffer.insert(datagram(0));
+   buffer.insert(datagram(3));
+   buffer.insert(datagram(6));
+
+   // 1, 2, 4 and 5 won't come
+   buffer.skip(6);
+   verifyReady(buffer, { 3, 6 });
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), buffer.getSkippedCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(7), buffer.getNextSequence());
+
+   // skipping far beyond the window
+   buffer.skip(1000000);
+   verifyReady(buffer, {});
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1000000), buffer.getNextSequence());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4 + 1000000 - 7), buffer.getSkippedCount());
+   CPPUNIT_ASSERT(EResult::deliverNow == buffer.insert(datagram(1000000)));
+
+   // a skip back is ignored
+   buffer.skip(10);
+   verifyReady(buffer, {});
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1000001), buffer.getNextSequence());
+}
+
+void testCReorderBuffer::testWrapAround()
+{
+   CReorderBuffer buffer(8, 10000, UINT64_MAX - 1);
+
+   CPPUNIT_ASSERT(EResult::buffered == buffer.insert(datagram(1)));
+   CPPUNIT_ASSERT(EResult::buffered == buffer.insert(datagram(0)));
+   CPPUNIT_ASSERT(EResult::buffered == buffer.insert(datagram(UINT64_MAX)));
+   CPPUNIT_ASSERT(EResult::full == buffer.insert(datagram(7)));
+   CPPUNIT_ASSERT(EResult::deliverNow == buffer.insert(datagram(UINT64_MAX - 1)));
+   verifyReady(buffer, { UINT64_MAX, 0, 1 });
+   CPPUNIT_ASSERT(EResult::tooOld == buffer.insert(datagram(UINT64_MAX - 3)));
+}
+
+void testCReorderBuffer::testReset()
+{
+   CReorderBuffer buffer(8, 10000);
+   SReceivedDatagram removed[8];
+
+   buffer.insert(datagram(2));
+   buffer.insert(datagram(5));
+   CPPUNIT_ASSERT_EQUAL(size_t(2), buffer.reset(500, removed));
+   CPPUNIT_ASSERT_EQUAL(uint32_t(2), removed[0].handle);
+   CPPUNIT_ASSERT_EQUAL(uint32_t(5), removed[1].handle);
+   CPPUNIT_ASSERT_EQUAL(size_t(0), buffer.getHeldCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), buffer.getHeldBytes());
+   CPPUNIT_ASSERT(EResult::deliverNow == buffer.insert(datagram(500)));
+}
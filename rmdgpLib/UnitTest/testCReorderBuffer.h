@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCReorderBuffer.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 22, 2021, 9:40 PM
+ */
+
+#ifndef TESTCREORDERBUFFER_H
+#define TESTCREORDERBUFFER_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <vector>
+
+class CReorderBuffer;
+
+class testCReorderBuffer : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCReorderBuffer);
+
+    CPPUNIT_TEST(testInOrder);
+    CPPUNIT_TEST(testGapClosed);
+    CPPUNIT_TEST(testDuplicateAndOld);
+    CPPUNIT_TEST(testBounds);
+    CPPUNIT_TEST(testBatchLimit);
+    CPPUNIT_TEST(testSkip);
+    CPPUNIT_TEST(testWrapAround);
+    CPPUNIT_TEST(testReset);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCReorderBuffer();
+    virtual ~testCReorderBuffer();
+    void setUp();
+    void tearDown();
+
+private:
+    void testInOrder();
+    void testGapClosed();
+    void testDuplicateAndOld();
+    void testBounds();
+    void testBatchLimit();
+    void testSkip();
+    void testWrapAround();
+    void testReset();
+
+    /// \brief pops the ready datagrams and compares their sequence numbers with expected
+    void verifyReady(CReorderBuffer &buffer, const std::vector<uint64_t> &expected);
+};
+
+#endif /* TESTCREORDERBUFFER_H */
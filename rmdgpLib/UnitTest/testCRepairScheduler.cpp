@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCRepairScheduler.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 29, 2021, 1:15 PM
+ */
+
+#include "testCRepairScheduler.h"
+#include "../CRepairScheduler.h"
+#include "../../socketLib/CSocketAddress.h"
+#include <vector>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCRepairScheduler);
+
+namespace {
+   const CNanoTime start = CNanoTime::fromSec(50);
+   const CNanoTime window = CNanoTime::fromMsec(2);
+   const CSocketAddress first("10.0.0.1", 4000);
+   const CSocketAddress second("10.0.0.2", 4000);
+   const CSocketAddress third("10.0.0.2", 4001);
+}
+
+testCRepairScheduler::testCRepairScheduler()
+{
+}
+
+testCRepairScheduler::~testCRepairScheduler()
+{
+}
+
+void testCRepairScheduler::setUp()
+{
+}
+
+void testCRepairScheduler::tearDown()
+{
+}
+
+void testCRepairScheduler::testUnicast()
+{
+   CRepairScheduler scheduler(2, window);
+   std::vector<uint64_t> multicast;
+   std::vector<SUnicastRepair> unicast;
+
+   CPPUNIT_ASSERT(scheduler.request(10, first, start));
+   CPPUNIT_ASSERT(scheduler.request(10, second, start));
+   // the same receiver again
+   CPPUNIT_ASSERT(!scheduler.request(10, first, start + window / 2));
+   CPPUNIT_ASSERT(scheduler.request(11, first, start));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), scheduler.getMergedCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(2), scheduler.getPendingCount());
+
+   CPPUNIT_ASSERT_EQUAL(size_t(3), scheduler.takeDue(start + window, multicast, unicast));
+   CPPUNIT_ASSERT(multicast.empty());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(10), unicast[0].sequence);
+   CPPUNIT_ASSERT_EQUAL(first.sin_addr.s_addr, unicast[0].requester.sin_addr.s_addr);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(10), unicast[1].sequence);
+   CPPUNIT_ASSERT_EQUAL(second.sin_addr.s_addr, unicast[1].requester.sin_addr.s_addr);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(11), unicast[2].sequence);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(3), scheduler.getUnicastCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), scheduler.getPendingCount());
+}
+
+void testCRepairScheduler::testMulticast()
+{
+   CRepairScheduler scheduler(2, window);
+   std::vector<uint64_t> multicast;
+   std::vector<SUnicastRepair> unicast;
+
+   // the port makes a different receiver too
+   CPPUNIT_ASSERT(scheduler.request(10, first, start));
+   CPPUNIT_ASSERT(scheduler.request(10, second, start));
+   CPPUNIT_ASSERT(scheduler.request(10, third, start));
+   CPPUNIT_ASSERT(!scheduler.request(10, first, start));
+   CPPUNIT_ASSERT(scheduler.request(12, first, start));
+
+   CPPUNIT_ASSERT_EQUAL(size_t(2), scheduler.takeDue(start + window, multicast, unicast));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), multicast.size());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(10), multicast[0]);
+   CPPUNIT_ASSERT_EQUAL(size_t(1), unicast.size());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(12), unicast[0].sequence);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), scheduler.getMulticastCount());
+}
+
+void testCRepairScheduler::testAlwaysMulticast()
+{
+   CRepairScheduler scheduler(0, window);
+   std::vector<uint64_t> multicast;
+   std::vector<SUnicastRepair> unicast;
+
+   CPPUNIT_ASSERT(scheduler.request(10, first, start));
+   CPPUNIT_ASSERT(!scheduler.request(10, second, start));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), scheduler.takeDue(start + window, multicast, unicast));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), multicast.size());
+   CPPUNIT_ASSERT(unicast.empty());
+}
+
+void testCRepairScheduler::testWindow()
+{
+   CRepairScheduler scheduler(2, window);
+   std::vector<uint64_t> multicast;
+   std::vector<SUnicastRepair> unicast;
+
+   scheduler.request(10, first, start);
+   scheduler.request(11, first, start + window / 2);
+   CPPUNIT_ASSERT_EQUAL(size_t(0), scheduler.takeDue(start + window / 4, multicast, unicast));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), scheduler.takeDue(start + window, multicast, unicast));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(10), unicast[0].sequence);
+   CPPUNIT_ASSERT_EQUAL(size_t(1), scheduler.getPendingCount());
+
+   // a request after the repair starts a new window
+   scheduler.request(10, first, start + window);
+   CPPUNIT_ASSERT_EQUAL(size_t(1), scheduler.takeDue(start + window + window / 2, multicast,
+                                                     unicast));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(11), unicast[0].sequence);
+   CPPUNIT_ASSERT_EQUAL(size_t(1), scheduler.takeDue(start + window * 2, multicast, unicast));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(10), unicast[0].sequence);
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCRepairScheduler.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 29, 2021, 1:15 PM
+ */
+
+#ifndef TESTCREPAIRSCHEDULER_H
+#define TESTCREPAIRSCHEDULER_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class testCRepairScheduler : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCRepairScheduler);
+
+    CPPUNIT_TEST(testUnicast);
+    CPPUNIT_TEST(testMulticast);
+    CPPUNIT_TEST(testAlwaysMulticast);
+    CPPUNIT_TEST(testWindow);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCRepairScheduler();
+    virtual ~testCRepairScheduler();
+    void setUp();
+    void tearDown();
+
+private:
+    void testUnicast();
+    void testMulticast();
+    void testAlwaysMulticast();
+    void testWindow();
+};
+
+#endif /* TESTCREPAIRSCHEDULER_H */
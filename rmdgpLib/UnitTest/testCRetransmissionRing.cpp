@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCRetransmissionRing.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 16, 2021, 10:05 PM
+ */
+
+#include "testCRetransmissionRing.h"
+#include "../CRetransmissionRing.h"
+#include <stdexcept>
+#include <string.h>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCRetransmissionRing);
+
+testCRetransmissionRing::testCRetransmissionRing()
+{
+}
+
+testCRetransmissionRing::~testCRetransmissionRing()
+{
+}
+
+void testCRetransmissionRing::setUp()
+{
+}
+
+void testCRetransmissionRing::tearDown()
+{
+}
+
+void testCRetransmissionRing::testConstructor()
+{
+   CRetransmissionRing ring(1000, 100000, 1500, 77);
+
+   CPPUNIT_ASSERT_EQUAL(size_t(1024), ring.getCapacity());
+   CPPUNIT_ASSERT_EQUAL(size_t(1000), ring.getMaxMessages());
+   CPPUNIT_ASSERT_EQUAL(size_t(100000), ring.getMaxBytes());
+   CPPUNIT_ASSERT_EQUAL(size_t(1500), ring.getMaxDatagramSize());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(77), ring.getOldestSequence());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(77), ring.getNextSequence());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), ring.getCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), ring.getBytes());
+
+   CRetransmissionRing ring2(1, 1, 1);
+   CPPUNIT_ASSERT_EQUAL(size_t(1), ring2.getCapacity());
+   CRetransmissionRing ring3(4096, 1, 1);
+   CPPUNIT_ASSERT_EQUAL(size_t(4096), ring3.getCapacity());
+}
+
+void testCRetransmissionRing::testConstructorException()
+{
+   CPPUNIT_ASSERT_THROW(CRetransmissionRing(0, 1000, 100), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CRetransmissionRing(10, 0, 100), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CRetransmissionRing(10, 1000, 0), std::runtime_error);
+}
+
+void testCRetransmissionRing::testStoreAndLookup()
+{
+   CRetransmissionRing ring(8, 100000, 100, 10);
+   uint8_t datagram[100];
+   size_t length = 0;
+
+   for(int i = 0; i < 5; i++)
+   {
+      memset(datagram, i, sizeof(datagram));
+      CPPUNIT_ASSERT(ring.store(datagram, 10 + i));
+   }
+   // in place
+   uint8_t *slot = ring.store(100);
+   CPPUNIT_ASSERT(slot != nullptr);
+   memset(slot, 0x55, 100);
+
+   CPPUNIT_ASSERT_EQUAL(uint64_t(16), ring.getNextSequence());
+   CPPUNIT_ASSERT_EQUAL(size_t(6), ring.getCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(10 + 11 + 12 + 13 + 14 + 100), ring.getBytes());
+
+   for(int i = 0; i < 5; i++)
+   {
+      const uint8_t *stored = ring.lookup(10 + i, length);
+      CPPUNIT_ASSERT(stored != nullptr);
+      CPPUNIT_ASSERT_EQUAL(size_t(10 + i), length);
+      CPPUNIT_ASSERT_EQUAL(uint8_t(i), stored[0]);
+      CPPUNIT_ASSERT_EQUAL(uint8_t(i), stored[length - 1]);
+   }
+   CPPUNIT_ASSERT(slot == ring.lookup(15, length));
+   CPPUNIT_ASSERT_EQUAL(size_t(100), length);
+
+   // not stored (yet)
+   CPPUNIT_ASSERT(ring.lookup(9, length) == nullptr);
+   CPPUNIT_ASSERT(ring.lookup(16, length) == nullptr);
+   CPPUNIT_ASSERT(!ring.contains(16));
+   // too large
+   CPPUNIT_ASSERT(ring.store(101) == nullptr);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(16), ring.getNextSequence());
+}
+
+void testCRetransmissionRing::testMessageBound()
+{
+   CRetransmissionRing ring(5, 100000, 100);
+
+   for(int i = 0; i < 5; i++)
+      CPPUNIT_ASSERT(ring.store(50) != nullptr);
+   // the bound is the number of messages, not the power of two capacity
+   CPPUNIT_ASSERT(!ring.canStore(1));
+   CPPUNIT_ASSERT(ring.store(1) == nullptr);
+   CPPUNIT_ASSERT_EQUAL(size_t(5), ring.getCount());
+
+   CPPUNIT_ASSERT_EQUAL(size_t(1), ring.release(1));
+   CPPUNIT_ASSERT(ring.store(1) != nullptr);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(6), ring.getNextSequence());
+}
+
+void testCRetransmissionRing::testByteBound()
+{
+   CRetransmissionRing ring(100, 250, 100);
+
+   CPPUNIT_ASSERT(ring.store(100) != nullptr);
+   CPPUNIT_ASSERT(ring.store(100) != nullptr);
+   CPPUNIT_ASSERT(!ring.canStore(51));
+   CPPUNIT_ASSERT(ring.store(51) == nullptr);
+   CPPUNIT_ASSERT(ring.store(50) != nullptr);
+   CPPUNIT_ASSERT_EQUAL(size_t(250), ring.getBytes());
+   CPPUNIT_ASSERT(ring.store(1) == nullptr);
+
+   CPPUNIT_ASSERT_EQUAL(size_t(1), ring.release(1));
+   CPPUNIT_ASSERT_EQUAL(size_t(150), ring.getBytes());
+   CPPUNIT_ASSERT(ring.store(100) != nullptr);
+}
+
+void testCRetransmissionRing::testRelease()
+{
+   CRetransmissionRing ring(16, 100000, 100, 1000);
+   size_t length;
+
+   for(int i = 0; i < 10; i++)
+      ring.store(i + 1);
+
+   // before the oldest sequence
+   CPPUNIT_ASSERT_EQUAL(size_t(0), ring.release(999));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), ring.release(1000));
+   CPPUNIT_ASSERT_EQUAL(size_t(10), ring.getCount());
+
+   CPPUNIT_ASSERT_EQUAL(size_t(3), ring.release(1003));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1003), ring.getOldestSequence());
+   CPPUNIT_ASSERT_EQUAL(size_t(4 + 5 + 6 + 7 + 8 + 9 + 10), ring.getBytes());
+   CPPUNIT_ASSERT(ring.lookup(1002, length) == nullptr);
+   CPPUNIT_ASSERT(ring.lookup(1003, length) != nullptr);
+   CPPUNIT_ASSERT_EQUAL(size_t(4), length);
+
+   // an old watermark is ignored
+   CPPUNIT_ASSERT_EQUAL(size_t(0), ring.release(1001));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1003), ring.getOldestSequence());
+
+   // beyond the last stored datagram releases everything
+   CPPUNIT_ASSERT_EQUAL(size_t(7), ring.release(5000));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), ring.getCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), ring.getBytes());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1010), ring.getOldestSequence());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1010), ring.getNextSequence());
+}
+
+void testCRetransmissionRing::testWrapAround()
+{
+   CRetransmissionRing ring(4, 100000, 16, UINT64_MAX - 1);
+   uint8_t datagram[16];
+   size_t length;
+
+   // walk several times around the ring and across the end of the sequence numbers
+   for(int i = 0; i < 20; i++)
+   {
+      memset(datagram, i, sizeof(datagram));
+      CPPUNIT_ASSERT(ring.store(datagram, 16));
+      if(ring.getCount() == 4)
+         CPPUNIT_ASSERT_EQUAL(size_t(2), ring.release(ring.getOldestSequence() + 2));
+   }
+   CPPUNIT_ASSERT_EQUAL(uint64_t(18), ring.getNextSequence());
+
+   const uint8_t *stored = ring.lookup(17, length);
+   CPPUNIT_ASSERT(stored != nullptr);
+   CPPUNIT_ASSERT_EQUAL(uint8_t(19), stored[0]);
+   CPPUNIT_ASSERT(ring.lookup(UINT64_MAX, length) == nullptr);
+   CPPUNIT_ASSERT_EQUAL(size_t(ring.getCount() * 16), ring.getBytes());
+}
+
+void testCRetransmissionRing::testSlotAlignment()
+{
+   CRetransmissionRing ring(8, 100000, 100);
+
+   for(int i = 0; i < 8; i++)
+   {
+      const uint8_t *slot = ring.store(100);
+      CPPUNIT_ASSERT_EQUAL(size_t(0), reinterpret_cast<uintptr_t>(slot) %
+                                      CRetransmissionRing::cacheLineSize);
+   }
+}
+
+void testCRetransmissionRing::testHistory()
+{
+   CRetransmissionRing ring(6, 100000, 100, 20);
+   size_t length = 0;
+
+   // nothing stored, no history
+   CPPUNIT_ASSERT_EQUAL(uint64_t(20), ring.getHistoryStart());
+   CPPUNIT_ASSERT(ring.lookupHistory(20, length) == nullptr);
+
+   for(int i = 0; i < 6; i++)
+      memset(ring.store(10 + i), i, 10 + i);
+   CPPUNIT_ASSERT_EQUAL(size_t(6), ring.release(26));
+
+   // released, but the slots are not reused yet
+   CPPUNIT_ASSERT(ring.lookup(20, length) == nullptr);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(20), ring.getHistoryStart());
+   const uint8_t *stored = ring.lookupHistory(23, length);
+   CPPUNIT_ASSERT(stored != nullptr);
+   CPPUNIT_ASSERT_EQUAL(size_t(13), length);
+   CPPUNIT_ASSERT_EQUAL(uint8_t(3), stored[12]);
+   CPPUNIT_ASSERT(ring.lookupHistory(19, length) == nullptr);
+   CPPUNIT_ASSERT(ring.lookupHistory(26, length) == nullptr);
+
+   // the history is bounded by the 8 slots, not by maxMessages
+   for(int i = 6; i < 11; i++)
+      memset(ring.store(10 + i), i, 10 + i);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(23), ring.getHistoryStart());
+   CPPUNIT_ASSERT(ring.lookupHistory(22, length) == nullptr);
+   stored = ring.lookupHistory(23, length);
+   CPPUNIT_ASSERT(stored != nullptr);
+   CPPUNIT_ASSERT_EQUAL(size_t(13), length);
+   stored = ring.lookupHistory(30, length);
+   CPPUNIT_ASSERT(stored != nullptr);
+   CPPUNIT_ASSERT_EQUAL(size_t(20), length);
+   CPPUNIT_ASSERT_EQUAL(uint8_t(10), stored[0]);
+
+   // the history wraps around with the sequence numbers
+   CRetransmissionRing wrapping(4, 100000, 100, UINT64_MAX - 1);
+   for(int i = 0; i < 6; i++)
+   {
+      CPPUNIT_ASSERT(wrapping.store(1) != nullptr);
+      wrapping.release(wrapping.getNextSequence());
+   }
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), wrapping.getHistoryStart());
+   CPPUNIT_ASSERT(wrapping.lookupHistory(3, length) != nullptr);
+   CPPUNIT_ASSERT(wrapping.lookupHistory(UINT64_MAX, length) == nullptr);
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCRetransmissionRing.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 16, 2021, 10:05 PM
+ */
+
+#ifndef TESTCRETRANSMISSIONRING_H
+#define TESTCRETRANSMISSIONRING_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class testCRetransmissionRing : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCRetransmissionRing);
+
+    CPPUNIT_TEST(testConstructor);
+    CPPUNIT_TEST(testConstructorException);
+    CPPUNIT_TEST(testStoreAndLookup);
+    CPPUNIT_TEST(testMessageBound);
+    CPPUNIT_TEST(testByteBound);
+    CPPUNIT_TEST(testRelease);
+    CPPUNIT_TEST(testWrapAround);
+    CPPUNIT_TEST(testSlotAlignment);
+    CPPUNIT_TEST(testHistory);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCRetransmissionRing();
+    virtual ~testCRetransmissionRing();
+    void setUp();
+    void tearDown();
+
+private:
+    void testConstructor();
+    void testConstructorException();
+    void testStoreAndLookup();
+    void testMessageBound();
+    void testByteBound();
+    void testRelease();
+    void testWrapAround();
+    void testSlotAlignment();
+    void testHistory();
+};
+
+#endif /* TESTCRETRANSMISSIONRING_H */
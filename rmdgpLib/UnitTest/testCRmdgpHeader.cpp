@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCRmdgpHeader.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 14, 2021, 8:10 PM
+ */
+
+#include "testCRmdgpHeader.h"
+#include "../CRmdgpHeader.h"
+#include <array>
+#include <sstream>
+#include <string.h>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCRmdgpHeader);
+
+namespace {
+   constexpr std::array<uint8_t, CRmdgpHeader::size + 4> buildAtCompileTime()
+   {
+      std::array<uint8_t, CRmdgpHeader::size + 4> datagram = {};
+      CRmdgpHeaderBuilder(datagram.data()).setPayloadLength(4).setSessionId(0x01020304)
+                      .setStreamId(7).setSequence(0x1122334455667788);
+      return datagram;
+   }
+}
+
+testCRmdgpHeader::testCRmdgpHeader()
+{
+}
+
+testCRmdgpHeader::~testCRmdgpHeader()
+{
+}
+
+void testCRmdgpHeader::setUp()
+{
+}
+
+void testCRmdgpHeader::tearDown()
+{
+}
+
+void testCRmdgpHeader::testBuildAndParse()
+{
+   uint8_t datagram[CRmdgpHeader::size + 100];
+   memset(datagram, 0xee, sizeof(datagram));
+
+   CRmdgpHeaderBuilder builder(datagram);
+   builder.setType(ERmdgpPacketType::data).setFlags(rmdgpFlagRetransmission)
+          .setPayloadLength(100).setSessionId(0xdeadbeef).setStreamId(42)
+          .setSequence(0xfedcba9876543210);
+   CPPUNIT_ASSERT(builder.getPayload() == datagram + CRmdgpHeader::size);
+
+   const CRmdgpHeaderView header(datagram);
+   CPPUNIT_ASSERT(ERmdgpValidation::valid == CRmdgpHeaderView::validate(datagram, sizeof(datagram)));
+   CPPUNIT_ASSERT_EQUAL(CRmdgpHeader::version, header.getVersion());
+   CPPUNIT_ASSERT(ERmdgpPacketType::data == header.getType());
+   CPPUNIT_ASSERT_EQUAL(uint16_t(rmdgpFlagRetransmission), header.getFlags());
+   CPPUNIT_ASSERT(header.hasFlag(rmdgpFlagRetransmission));
+   CPPUNIT_ASSERT_EQUAL(uint16_t(100), header.getPayloadLength());
+   CPPUNIT_ASSERT_EQUAL(uint32_t(0xdeadbeef), header.getSessionId());
+   CPPUNIT_ASSERT_EQUAL(uint32_t(42), header.getStreamId());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0xfedcba9876543210), header.getSequence());
+   CPPUNIT_ASSERT(header.getPayload() == datagram + CRmdgpHeader::size);
+   // the payload is left alone
+   CPPUNIT_ASSERT_EQUAL(uint8_t(0xee), datagram[CRmdgpHeader::size]);
+
+   // the FEC position uses the reserved field
+   CPPUNIT_ASSERT_EQUAL(uint8_t(0), header.getFecBlockSize());
+   builder.setFecPosition(8, 3);
+   CPPUNIT_ASSERT_EQUAL(uint8_t(8), header.getFecBlockSize());
+   CPPUNIT_ASSERT_EQUAL(uint8_t(3), header.getFecIndex());
+   CPPUNIT_ASSERT_EQUAL(uint8_t(8), datagram[CRmdgpHeader::reservedOffset]);
+
+   std::ostringstream text;
+   text << header;
+   CPPUNIT_ASSERT_EQUAL(std::string("version:1 type:0 flags:0x1 payloadLength:100 "
+                        "session:3735928559 stream:42 sequence:18364758544493064720"), text.str());
+}
+
+void testCRmdgpHeader::testByteOrder()
+{
+   uint8_t datagram[CRmdgpHeader::size];
+
+   CRmdgpHeaderBuilder(datagram).setFlags(0x0102).setPayloadLength(0x0304).setSessionId(0x05060708)
+                   .setStreamId(0x090a0b0c).setSequence(0x0d0e0f1011121314);
+
+   const uint8_t expected[CRmdgpHeader::size] = { 1, 0, 0x01, 0x02, 0x03, 0x04, 0, 0,
+                  0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c,
+                  0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14 };
+   for(size_t i = 0; i < CRmdgpHeader::size; i++)
+   {
+      std::ostringstream message;
+      message << "byte " << i;
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(message.str(), int(expected[i]), int(datagram[i]));
+   }
+}
+
+void testCRmdgpHeader::testConstexpr()
+{
+   // evaluated at compile time, so it is enough that it compiles
+   constexpr std::array<uint8_t, CRmdgpHeader::size + 4> datagram = buildAtCompileTime();
+   static_assert(CRmdgpHeaderView::validate(datagram.data(), datagram.size()) ==
+                 ERmdgpValidation::valid, "constexpr validate");
+   static_assert(CRmdgpHeaderView(datagram.data()).getSessionId() == 0x01020304,
+                 "constexpr session id");
+   static_assert(CRmdgpHeaderView(datagram.data()).getSequence() == 0x1122334455667788,
+                 "constexpr sequence");
+
+   CPPUNIT_ASSERT_EQUAL(uint32_t(7), CRmdgpHeaderView(datagram.data()).getStreamId());
+}
+
+void testCRmdgpHeader::testValidate()
+{
+   const size_t length = CRmdgpHeader::size + 10;
+
+   tstValidateDataDriven("valid", CRmdgpHeader::reservedOffset, 0xff, length,
+                         ERmdgpValidation::valid);
+   tstValidateDataDriven("empty", 0, 1, 0, ERmdgpValidation::tooShort);
+   tstValidateDataDriven("too short", 0, 1, CRmdgpHeader::size - 1, ERmdgpValidation::tooShort);
+   tstValidateDataDriven("version 0", CRmdgpHeader::versionOffset, 0, length,
+                         ERmdgpValidation::badVersion);
+   tstValidateDataDriven("version 2", CRmdgpHeader::versionOffset, 2, length,
+                         ERmdgpValidation::badVersion);
+   tstValidateDataDriven("type", CRmdgpHeader::typeOffset, uint8_t(ERmdgpPacketType::count),
+                         length, ERmdgpValidation::badType);
+   tstValidateDataDriven("type 255", CRmdgpHeader::typeOffset, 255, length,
+                         ERmdgpValidation::badType);
+   tstValidateDataDriven("unknown flag", CRmdgpHeader::flagsOffset, 0x80, length,
+                         ERmdgpValidation::badFlags);
+   tstValidateDataDriven("truncated", CRmdgpHeader::reservedOffset, 0, length - 1,
+                         ERmdgpValidation::badLength);
+   tstValidateDataDriven("long length", CRmdgpHeader::payloadLengthOffset, 1, length,
+                         ERmdgpValidation::badLength);
+}
+
+void testCRmdgpHeader::tstValidateDataDriven(const std::string testName, size_t offset,
+                    uint8_t value, size_t length, ERmdgpValidation expected)
+{
+   uint8_t datagram[CRmdgpHeader::size + 10];
+
+   CRmdgpHeaderBuilder(datagram).setPayloadLength(10).setSequence(1);
+   datagram[offset] = value;
+
+   const ERmdgpValidation result = CRmdgpHeaderView::validate(datagram, length);
+   if(result != expected)
+   {
+      std::ostringstream message;
+      message << testName << ", Result:" << result << " expected:" << expected;
+      CPPUNIT_FAIL(message.str());
+   }
+}
+
+void testCRmdgpHeader::testUnalignedBuffer()
+{
+   // the header may start at any address, for instance inside a coalesced datagram
+   uint8_t buffer[CRmdgpHeader::size + 3];
+
+   for(size_t offset = 0; offset < 3; offset++)
+   {
+      CRmdgpHeaderBuilder(buffer + offset).setSessionId(uint32_t(offset + 1))
+                      .setSequence(0x8000000000000001 + offset);
+      const CRmdgpHeaderView header(buffer + offset);
+      CPPUNIT_ASSERT_EQUAL(uint32_t(offset + 1), header.getSessionId());
+      CPPUNIT_ASSERT_EQUAL(uint64_t(0x8000000000000001 + offset), header.getSequence());
+   }
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCRmdgpHeader.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 14, 2021, 8:10 PM
+ */
+
+#ifndef TESTCRMDGPHEADER_H
+#define TESTCRMDGPHEADER_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+enum class ERmdgpValidation;
+
+class testCRmdgpHeader : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCRmdgpHeader);
+
+    CPPUNIT_TEST(testBuildAndParse);
+    CPPUNIT_TEST(testByteOrder);
+    CPPUNIT_TEST(testConstexpr);
+    CPPUNIT_TEST(testValidate);
+    CPPUNIT_TEST(testUnalignedBuffer);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCRmdgpHeader();
+    virtual ~testCRmdgpHeader();
+    void setUp();
+    void tearDown();
+
+private:
+    void testBuildAndParse();
+    void testByteOrder();
+    void testConstexpr();
+    void testValidate();
+    void tstValidateDataDriven(const std::string testName, size_t offset, uint8_t value,
+                    size_t length, ERmdgpValidation expected);
+    void testUnalignedBuffer();
+};
+
+#endif /* TESTCRMDGPHEADER_H */
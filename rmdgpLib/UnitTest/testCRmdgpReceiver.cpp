@@ -0,0 +1,828 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCRmdgpReceiver.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 20, 2021, 8:45 PM
+ */
+
+#include "testCRmdgpReceiver.h"
+#include "../CRmdgpReceiver.h"
+#include "../CRmdgpHeader.h"
+#include "../CAckPacket.h"
+#include "../CFecEncoder.h"
+#include "../CJoinPacket.h"
+#include "../CNakPacket.h"
+#include "../../socketLib/CLatencyRecorder.h"
+#include "../../socketLib/CUdpMulticastReceiver.h"
+#include "../../socketLib/CUdpSocket.h"
+#include "../../socketLib/CSocketAddress.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdexcept>
+#include <string.h>
+#include <time.h>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCRmdgpReceiver);
+
+typedef CLossTracker::EResult EResult;
+
+namespace {
+   // the ACKs are sent to the sender address, a unicast port on the loopback interface
+   const char *localAddress = "127.0.0.1";
+   const int senderPort = 7802;
+   const int groupPort = 7803;
+   const int peerGroupPort = 7804;
+   /// \brief the time that the datagrams of the tests are received
+   const CNanoTime receiveTime = CNanoTime::fromSec(1000);
+}
+
+testCRmdgpReceiver::testCRmdgpReceiver()
+{
+}
+
+testCRmdgpReceiver::~testCRmdgpReceiver()
+{
+}
+
+void testCRmdgpReceiver::setUp()
+{
+}
+
+void testCRmdgpReceiver::tearDown()
+{
+}
+
+size_t testCRmdgpReceiver::process(CRmdgpReceiver &receiver, uint32_t sessionId,
+                    uint32_t streamId, uint64_t sequence, std::vector<uint64_t> &delivered,
+                    size_t truncate, uint16_t flags)
+{
+   SReceivedDatagram ready[16];
+   const uint32_t handle = receiver.getDatagramPool().acquire();
+   uint8_t *datagram = receiver.getDatagramPool().getBuffer(handle);
+
+   CRmdgpHeaderBuilder(datagram).setFlags(flags).setPayloadLength(8).setSessionId(sessionId)
+                   .setStreamId(streamId).setSequence(sequence);
+   CRmdgpHeader::store64(datagram + CRmdgpHeader::size, sequence);
+
+   const size_t count = receiver.processDatagram(handle, CRmdgpHeader::size + 8 - truncate,
+                                                 ready, 16, receiveTime);
+   for(size_t i = 0; i < count; i++)
+   {
+      // the payload is read from the receive buffer itself
+      CPPUNIT_ASSERT_EQUAL(size_t(8), CRmdgpReceiver::getPayloadLength(ready[i]));
+      CPPUNIT_ASSERT_EQUAL(ready[i].sequence, CRmdgpHeader::load64(receiver.getPayload(ready[i])));
+      delivered.push_back(ready[i].sequence);
+      receiver.release(ready[i]);
+   }
+   return count;
+}
+
+void testCRmdgpReceiver::testProcessDatagram()
+{
+   CRmdgpReceiver receiver(std::make_shared<CUdpMulticastReceiver>(),
+                           CSocketAddress("127.0.0.1", 7802), 5);
+   std::vector<uint64_t> delivered;
+
+   // the first datagram sets the session and the start of the stream
+   CPPUNIT_ASSERT_EQUAL(size_t(1), process(receiver, 9, 5, 1000, delivered));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), process(receiver, 9, 5, 1001, delivered));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), process(receiver, 9, 5, 1005, delivered));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), process(receiver, 9, 5, 1003, delivered));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), process(receiver, 9, 5, 1003, delivered));
+
+   CPPUNIT_ASSERT_EQUAL(uint64_t(2), receiver.getLossTracker().getMissingCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(2), receiver.getLossTracker().getHoleCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1002), receiver.getLossTracker().getFirstMissing());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), receiver.getIgnoredCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), receiver.getDroppedCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), receiver.getDuplicateFilter().getDuplicateCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(2), receiver.getReorderBuffer().getHeldCount());
+
+   // delivered datagrams are duplicates too
+   CPPUNIT_ASSERT_EQUAL(size_t(0), process(receiver, 9, 5, 1000, delivered));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(2), receiver.getDuplicateFilter().getDuplicateCount());
+}
+
+void testCRmdgpReceiver::testIgnored()
+{
+   CRmdgpReceiver receiver(std::make_shared<CUdpMulticastReceiver>(),
+                           CSocketAddress("127.0.0.1", 7802), 5, 8);
+   std::vector<uint64_t> delivered;
+
+   // other stream
+   process(receiver, 9, 6, 1000, delivered);
+   // malformed
+   process(receiver, 9, 5, 1000, delivered, 1);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(2), receiver.getIgnoredCount());
+
+   process(receiver, 9, 5, 1000, delivered);
+   // other session
+   CPPUNIT_ASSERT_EQUAL(size_t(0), process(receiver, 10, 5, 1001, delivered));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(3), receiver.getIgnoredCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1001), receiver.getLossTracker().getNextExpected());
+   // all buffers are back in the pool
+   CPPUNIT_ASSERT_EQUAL(size_t(8), receiver.getDatagramPool().getFreeCount());
+}
+
+void testCRmdgpReceiver::testInOrderDelivery()
+{
+   CRmdgpReceiver receiver(std::make_shared<CUdpMulticastReceiver>(),
+                           CSocketAddress("127.0.0.1", 7802), 5, 16);
+   std::vector<uint64_t> delivered;
+   const uint64_t arrival[] = { 0, 1, 4, 2, 6, 3, 5, 7, 9, 8 };
+
+   for(uint64_t sequence : arrival)
+      process(receiver, 9, 5, sequence, delivered);
+
+   CPPUNIT_ASSERT_EQUAL(size_t(10), delivered.size());
+   for(uint64_t i = 0; i < delivered.size(); i++)
+      CPPUNIT_ASSERT_EQUAL(i, delivered[i]);
+   CPPUNIT_ASSERT_EQUAL(size_t(16), receiver.getDatagramPool().getFreeCount());
+}
+
+void testCRmdgpReceiver::testHoldLatency()
+{
+   CRmdgpReceiver receiver(std::make_shared<CUdpMulticastReceiver>(),
+                           CSocketAddress("127.0.0.1", 7802), 5, 16);
+   std::shared_ptr<CLatencyRecorder> latency(new CLatencyRecorder);
+   SReceivedDatagram ready[16];
+   size_t delivered = 0;
+   auto processAt = [&](uint64_t sequence, const CNanoTime &now)
+   {
+      const uint32_t handle = receiver.getDatagramPool().acquire();
+      CRmdgpHeaderBuilder(receiver.getDatagramPool().getBuffer(handle)).setPayloadLength(0)
+                      .setSessionId(9).setStreamId(5).setSequence(sequence);
+      const size_t count = receiver.processDatagram(handle, CRmdgpHeader::size, ready, 16, now);
+      for(size_t i = 0; i < count; i++)
+         receiver.release(ready[i]);
+      delivered += count;
+   };
+
+   receiver.setHoldLatencyRecorder(latency);
+   processAt(0, receiveTime);
+   // 2 waits in the reorder buffer for 1, that comes 2ms later
+   processAt(2, receiveTime + CNanoTime::fromMsec(1));
+   processAt(1, receiveTime + CNanoTime::fromMsec(3));
+   CPPUNIT_ASSERT_EQUAL(size_t(3), delivered);
+
+   const CLatencyHistogram histogram = latency->snapshot();
+   CPPUNIT_ASSERT_EQUAL(uint64_t(3), histogram.getTotalCount());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(), histogram.getMin());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromMsec(2), histogram.getMax());
+}
+
+void testCRmdgpReceiver::testMemoryCap()
+{
+   CRmdgpReceiver receiver(std::make_shared<CUdpMulticastReceiver>(),
+                           CSocketAddress("127.0.0.1", 7802), 5, 4);
+   std::vector<uint64_t> delivered;
+
+   process(receiver, 9, 5, 0, delivered);
+   // 1 is lost, the window covers 4 sequence numbers from 1, so 5 is dropped
+   for(uint64_t sequence = 2; sequence < 6; sequence++)
+      process(receiver, 9, 5, sequence, delivered);
+   CPPUNIT_ASSERT_EQUAL(size_t(3), receiver.getReorderBuffer().getHeldCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), receiver.getDroppedCount());
+   // the dropped datagram is still missing, so it will be asked for again
+   CPPUNIT_ASSERT_EQUAL(uint64_t(5), receiver.getLossTracker().getNextExpected());
+
+   process(receiver, 9, 5, 1, delivered);
+   // the dropped datagram is not mistaken for a duplicate
+   process(receiver, 9, 5, 5, delivered);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), receiver.getDuplicateFilter().getDuplicateCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(6), delivered.size());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(5), delivered.back());
+}
+
+void testCRmdgpReceiver::testReceiveReserve()
+{
+   // 10 buffers, the window is 16
+   CRmdgpReceiver receiver(std::make_shared<CUdpMulticastReceiver>(),
+                           CSocketAddress("127.0.0.1", 7802), 5, 10);
+   std::vector<uint64_t> delivered;
+
+   CPPUNIT_ASSERT_THROW(CRmdgpReceiver(std::make_shared<CUdpMulticastReceiver>(),
+                                       CSocketAddress("127.0.0.1", 7802), 5, 1),
+                        std::runtime_error);
+
+   process(receiver, 9, 5, 0, delivered);
+   // 1 is lost, the gap holds no more than 9 buffers, so one is left to receive the repair
+   for(uint64_t sequence = 2; sequence < 13; sequence++)
+      process(receiver, 9, 5, sequence, delivered);
+   CPPUNIT_ASSERT_EQUAL(size_t(9), receiver.getReorderBuffer().getHeldCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(2), receiver.getDroppedCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(1), receiver.getDatagramPool().getFreeCount());
+
+   CPPUNIT_ASSERT_EQUAL(size_t(10), process(receiver, 9, 5, 1, delivered));
+   CPPUNIT_ASSERT_EQUAL(size_t(10), receiver.getDatagramPool().getFreeCount());
+   process(receiver, 9, 5, 11, delivered);
+   process(receiver, 9, 5, 12, delivered);
+   CPPUNIT_ASSERT_EQUAL(size_t(13), delivered.size());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(12), delivered.back());
+}
+
+void testCRmdgpReceiver::testSendAck()
+{
+   const in_addr address = { inet_addr(localAddress) };
+   std::shared_ptr<CUdpMulticastReceiver> udpReceiver(new CUdpMulticastReceiver);
+   CUdpSocket udpSender;
+   CRmdgpReceiver receiver(udpReceiver, CSocketAddress(localAddress, senderPort), 5, 16);
+   std::vector<uint64_t> delivered;
+   const timespec waitTime = { 0, 1000000 };
+   uint8_t buffer[2048];
+   sockaddr_in source;
+   SSequenceRange range;
+
+   udpSender.openUdpSocket();
+   udpSender.bind(address, senderPort);
+   udpSender.setNonBlocking();
+   udpReceiver->openUdpSocket();
+   receiver.setReceiverId(4321);
+
+   // nothing to acknowledge yet
+   CPPUNIT_ASSERT(!receiver.sendAck(receiveTime));
+
+   // 100, 101 received, 102 missing, 103 received, 104, 105 missing, 106, 107 received
+   for(uint64_t sequence : { 100, 101, 103, 106, 107 })
+      process(receiver, 9, 5, sequence, delivered);
+   // the ACK tells how long it held 107 back
+   CPPUNIT_ASSERT(receiver.sendAck(receiveTime + CNanoTime::fromMsec(2)));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), receiver.getAckCount());
+
+   nanosleep(&waitTime, NULL); // give upd/ip stack some time
+   const size_t length = udpSender.receiveFrom(buffer, sizeof(buffer), &source);
+   CPPUNIT_ASSERT(ERmdgpValidation::valid == CRmdgpHeaderView::validate(buffer, length));
+   CPPUNIT_ASSERT(ERmdgpPacketType::ack == CRmdgpHeaderView(buffer).getType());
+   CPPUNIT_ASSERT_EQUAL(uint32_t(9), CRmdgpHeaderView(buffer).getSessionId());
+
+   CAckReader ack(buffer, length);
+   CPPUNIT_ASSERT_EQUAL(uint32_t(4321), ack.getReceiverId());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(102), ack.getCumulativeAck());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromMsec(2), ack.getHoldTime());
+   CPPUNIT_ASSERT(ack.next(range));
+   CPPUNIT_ASSERT(SSequenceRange({ 103, 104 }) == range);
+   CPPUNIT_ASSERT(ack.next(range));
+   CPPUNIT_ASSERT(SSequenceRange({ 106, 108 }) == range);
+   CPPUNIT_ASSERT(!ack.next(range));
+
+   // 3 of the 8 datagrams were missing at first
+   CPPUNIT_ASSERT_EQUAL(uint64_t(3), receiver.getLostCount());
+   CPPUNIT_ASSERT(ack.hasLossRate());
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0 / 8.0, ack.getLossRate(), 0.0001);
+}
+
+void testCRmdgpReceiver::testAckPolicy()
+{
+   const in_addr address = { inet_addr(localAddress) };
+   std::shared_ptr<CUdpMulticastReceiver> udpReceiver(new CUdpMulticastReceiver);
+   CUdpSocket udpSender;
+   CRmdgpReceiver receiver(udpReceiver, CSocketAddress(localAddress, senderPort), 5, 16);
+   std::vector<uint64_t> delivered;
+   const CNanoTime start = CNanoTime::fromSec(1000);
+
+   udpSender.openUdpSocket();
+   udpSender.bind(address, senderPort);
+   udpReceiver->openUdpSocket();
+   receiver.setAckPolicy(4, CNanoTime::fromMsec(10));
+
+   // after every 4 new datagrams, duplicates don't count
+   for(uint64_t sequence : { 0, 1, 2, 2, 2 })
+      process(receiver, 9, 5, sequence, delivered);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), receiver.getAckCount());
+   process(receiver, 9, 5, 3, delivered);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), receiver.getAckCount());
+
+   // the timer only sends when something new arrived
+   CPPUNIT_ASSERT(!receiver.handleTimer(start));
+   process(receiver, 9, 5, 4, delivered);
+   CPPUNIT_ASSERT(receiver.handleTimer(start));
+   process(receiver, 9, 5, 5, delivered);
+   CPPUNIT_ASSERT(!receiver.handleTimer(start + CNanoTime::fromMsec(9)));
+   CPPUNIT_ASSERT(receiver.handleTimer(start + CNanoTime::fromMsec(10)));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(3), receiver.getAckCount());
+}
+
+void testCRmdgpReceiver::testHeartbeat()
+{
+   std::shared_ptr<CUdpMulticastReceiver> udpReceiver(new CUdpMulticastReceiver);
+   CRmdgpReceiver receiver(udpReceiver, CSocketAddress(localAddress, senderPort), 5, 16);
+   std::vector<uint64_t> delivered;
+   const CNanoTime start = CNanoTime::fromSec(1000);
+   auto heartbeat = [&](uint32_t sessionId, uint64_t sequence)
+   {
+      SReceivedDatagram ready[1];
+      const uint32_t handle = receiver.getDatagramPool().acquire();
+      CRmdgpHeaderBuilder(receiver.getDatagramPool().getBuffer(handle))
+                      .setType(ERmdgpPacketType::heartbeat).setSessionId(sessionId)
+                      .setStreamId(5).setSequence(sequence);
+      CPPUNIT_ASSERT_EQUAL(size_t(0), receiver.processDatagram(handle, CRmdgpHeader::size,
+                                                               ready, 1, receiveTime));
+   };
+
+   udpReceiver->openUdpSocket();
+   CPPUNIT_ASSERT(!receiver.isSenderAlive(start));
+   process(receiver, 9, 5, 100, delivered);
+   process(receiver, 9, 5, 101, delivered);
+   CPPUNIT_ASSERT(receiver.isSenderAlive(start));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), receiver.getAckCount());
+
+   // the last datagrams of the burst are lost, the heartbeat reveals them and is answered
+   heartbeat(9, 105);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), receiver.getAckCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), receiver.getHeartbeatCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(3), receiver.getTailLossCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(102), receiver.getLossTracker().getFirstMissing());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(105), receiver.getLossTracker().getNextExpected());
+   // of an other session it is ignored, and nothing is held
+   heartbeat(10, 110);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), receiver.getHeartbeatCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), receiver.getIgnoredCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(16), receiver.getDatagramPool().getFreeCount());
+
+   // the repairs are delivered
+   for(uint64_t sequence = 102; sequence < 105; sequence++)
+      process(receiver, 9, 5, sequence, delivered);
+   CPPUNIT_ASSERT_EQUAL(size_t(5), delivered.size());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), receiver.getLossTracker().getMissingCount());
+
+   // the sender is alive until the timeout after the last time it was heard. The timer sends
+   // an ACK as well.
+   receiver.setSenderTimeout(CNanoTime::fromSec(3));
+   receiver.handleTimer(start);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(2), receiver.getAckCount());
+   CPPUNIT_ASSERT(receiver.isSenderAlive(start + CNanoTime::fromMsec(2999)));
+   CPPUNIT_ASSERT(!receiver.isSenderAlive(start + CNanoTime::fromSec(3)));
+   // the next heartbeat of the same idle period is not ahead of the ACK
+   heartbeat(9, 105);
+   CPPUNIT_ASSERT(receiver.isSenderAlive(start + CNanoTime::fromSec(3)));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(2), receiver.getAckCount());
+
+   // after the next burst the sender is idle again: the ACK of the burst may be lost, so the
+   // first heartbeat is answered even when the receiver has everything
+   for(uint64_t sequence = 105; sequence < 108; sequence++)
+      process(receiver, 9, 5, sequence, delivered);
+   receiver.sendAck(receiveTime);
+   heartbeat(9, 108);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), receiver.getAckCount());
+   heartbeat(9, 108);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), receiver.getAckCount());
+}
+
+void testCRmdgpReceiver::testNakSuppression()
+{
+   const in_addr address = { inet_addr(localAddress) };
+   std::shared_ptr<CUdpMulticastReceiver> udpReceiver(new CUdpMulticastReceiver);
+   CUdpSocket udpSender, group;
+   CRmdgpReceiver receiver(udpReceiver, CSocketAddress(localAddress, senderPort), 5, 16);
+   std::vector<uint64_t> delivered;
+   const CNanoTime start = CNanoTime::fromSec(1000);
+   const CNanoTime rtt = CNanoTime::fromMsec(1);
+   uint8_t buffer[2048];
+   sockaddr_in source;
+
+   udpSender.openUdpSocket();
+   udpSender.bind(address, senderPort);
+   group.openUdpSocket();
+   group.bind(address, groupPort);
+   udpReceiver->openUdpSocket();
+   // no ACKs, and the NAKs wait exactly one round trip time
+   receiver.setAckPolicy(1000, CNanoTime::fromSec(10000));
+   receiver.setNakSuppression(std::make_shared<CUdpSocket>(),
+                              CSocketAddress(localAddress, groupPort), rtt);
+   receiver.getNakScheduler().setBackoff(1.0, 0.0, 0.0);
+
+   for(uint64_t sequence : { 0, 1, 4 })
+      process(receiver, 9, 5, sequence, delivered);
+   receiver.handleTimer(start);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), receiver.getNakCount());
+   receiver.handleTimer(start + rtt);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), receiver.getNakCount());
+
+   // the NAK goes to the sender and to the group
+   const timespec waitTime = { 0, 1000000 };
+   nanosleep(&waitTime, NULL); // give upd/ip stack some time
+   for(CUdpSocket *socket : { &udpSender, &group })
+   {
+      SSequenceRange range;
+      const size_t length = socket->receiveFrom(buffer, sizeof(buffer), &source);
+      CPPUNIT_ASSERT(ERmdgpValidation::valid == CRmdgpHeaderView::validate(buffer, length));
+      CPPUNIT_ASSERT(ERmdgpPacketType::nak == CRmdgpHeaderView(buffer).getType());
+      CNakReader nak(buffer, length);
+      CPPUNIT_ASSERT(nak.next(range));
+      CPPUNIT_ASSERT(SSequenceRange({ 2, 4 }) == range);
+      CPPUNIT_ASSERT(!nak.next(range));
+   }
+   process(receiver, 9, 5, 2, delivered);
+   process(receiver, 9, 5, 3, delivered);
+   CPPUNIT_ASSERT_EQUAL(size_t(0), receiver.getNakScheduler().getPendingCount());
+
+   // an other receiver asks first, then the repair comes
+   process(receiver, 9, 5, 7, delivered);
+   receiver.handleTimer(start + rtt * 2);
+   const uint32_t handle = receiver.getDatagramPool().acquire();
+   CNakBuilder other(receiver.getDatagramPool().getBuffer(handle), 100, 9, 5,
+                     receiver.getReceiverId() + 1);
+   other.add({ 5, 7 });
+   SReceivedDatagram ready[1];
+   CPPUNIT_ASSERT_EQUAL(size_t(0), receiver.processDatagram(handle, other.getLength(), ready, 1,
+                                                            receiveTime));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), receiver.getNakScheduler().getSuppressedCount());
+   // the own NAK that comes back from the group doesn't count
+   const uint32_t ownHandle = receiver.getDatagramPool().acquire();
+   CNakBuilder own(receiver.getDatagramPool().getBuffer(ownHandle), 100, 9, 5,
+                   receiver.getReceiverId());
+   own.add({ 5, 7 });
+   receiver.processDatagram(ownHandle, own.getLength(), ready, 1, receiveTime);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), receiver.getNakScheduler().getSuppressedCount());
+   receiver.handleTimer(start + rtt * 3);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), receiver.getNakCount());
+   process(receiver, 9, 5, 5, delivered);
+   process(receiver, 9, 5, 6, delivered);
+   CPPUNIT_ASSERT_EQUAL(size_t(0), receiver.getNakScheduler().getPendingCount());
+   receiver.handleTimer(start + rtt * 10);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), receiver.getNakCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(8), delivered.size());
+}
+
+void testCRmdgpReceiver::testNakSuppressionPeers()
+{
+   const in_addr address = { inet_addr(localAddress) };
+   CUdpSocket udpSender;
+   std::shared_ptr<CUdpSocket> firstNaks(new CUdpSocket), secondNaks(new CUdpSocket);
+   std::shared_ptr<CUdpMulticastReceiver> firstReceiver(new CUdpMulticastReceiver);
+   std::shared_ptr<CUdpMulticastReceiver> secondReceiver(new CUdpMulticastReceiver);
+   CRmdgpReceiver first(firstReceiver, CSocketAddress(localAddress, senderPort), 5, 16);
+   CRmdgpReceiver second(secondReceiver, CSocketAddress(localAddress, senderPort), 5, 16);
+   std::vector<uint64_t> delivered;
+   const CNanoTime start = CNanoTime::fromSec(1000);
+   const CNanoTime rtt = CNanoTime::fromMsec(1);
+   const timespec waitTime = { 0, 1000000 };
+
+   udpSender.openUdpSocket();
+   udpSender.bind(address, senderPort);
+   firstReceiver->openUdpSocket();
+   secondReceiver->openUdpSocket();
+   firstNaks->openUdpSocket();
+   firstNaks->bind(address, groupPort);
+   firstNaks->setNonBlocking();
+   secondNaks->openUdpSocket();
+   secondNaks->bind(address, peerGroupPort);
+   secondNaks->setNonBlocking();
+   // there is no multicast route here, so the group is played by the NAK socket of second:
+   // the NAKs of first reach second, and those of second come back to it like with
+   // IP_MULTICAST_LOOP
+   first.setNakSuppression(firstNaks, CSocketAddress(localAddress, peerGroupPort), rtt);
+   second.setNakSuppression(secondNaks, CSocketAddress(localAddress, peerGroupPort), rtt);
+   for(CRmdgpReceiver *receiver : { &first, &second })
+   {
+      receiver->setAckPolicy(1000, CNanoTime::fromSec(10000));
+      receiver->getNakScheduler().setBackoff(1.0, 0.0, 0.0);
+      for(uint64_t sequence : { 0, 1, 4 })
+         process(*receiver, 9, 5, sequence, delivered);
+      receiver->handleTimer(start);
+   }
+
+   // first asks, second sees it before its own delay expired and postpones its NAK
+   first.handleTimer(start + rtt);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), first.getNakCount());
+   nanosleep(&waitTime, NULL); // give upd/ip stack some time
+   CPPUNIT_ASSERT(second.receiveNak());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), second.getNakScheduler().getSuppressedCount());
+   second.handleTimer(start + rtt);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), second.getNakCount());
+
+   // the own NAK of second comes back from the group and doesn't postpone anything
+   CPPUNIT_ASSERT_EQUAL(size_t(1), second.sendNaks());
+   nanosleep(&waitTime, NULL);
+   CPPUNIT_ASSERT(!second.receiveNak());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), second.getNakScheduler().getSuppressedCount());
+   CPPUNIT_ASSERT(!first.receiveNak());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), first.getNakScheduler().getSuppressedCount());
+   CPPUNIT_ASSERT(!second.receiveNak());
+}
+
+void testCRmdgpReceiver::testFec()
+{
+   CRmdgpReceiver receiver(std::make_shared<CUdpMulticastReceiver>(),
+                           CSocketAddress(localAddress, senderPort), 5, 16);
+   CFecEncoder encoder(4, 8);
+   std::vector<uint64_t> delivered;
+   SReceivedDatagram ready[16];
+   auto deliver = [&](size_t count)
+   {
+      for(size_t i = 0; i < count; i++)
+      {
+         CPPUNIT_ASSERT_EQUAL(ready[i].sequence,
+                              CRmdgpHeader::load64(receiver.getPayload(ready[i])));
+         delivered.push_back(ready[i].sequence);
+         receiver.release(ready[i]);
+      }
+      return count;
+   };
+   // the payload is the sequence number, like process makes it
+   auto data = [&](uint64_t sequence, bool lost)
+   {
+      const uint32_t handle = receiver.getDatagramPool().acquire();
+      uint8_t *datagram = receiver.getDatagramPool().getBuffer(handle);
+      CRmdgpHeaderBuilder(datagram).setFlags(rmdgpFlagFec).setPayloadLength(8).setSessionId(9)
+                      .setStreamId(5).setSequence(sequence)
+                      .setFecPosition(encoder.getBlockSize(), encoder.getIndex());
+      CRmdgpHeader::store64(datagram + CRmdgpHeader::size, sequence);
+      encoder.add(sequence, datagram + CRmdgpHeader::size, 8);
+      if(lost)
+      {
+         receiver.getDatagramPool().release(handle);
+         return size_t(0);
+      }
+      return deliver(receiver.processDatagram(handle, CRmdgpHeader::size + 8, ready, 16,
+                                                receiveTime));
+   };
+   auto parity = [&](size_t maxReady)
+   {
+      size_t length;
+      encoder.finish(9, 5);
+      const uint8_t *source = encoder.getParity(0, length);
+      const uint32_t handle = receiver.getDatagramPool().acquire();
+      memcpy(receiver.getDatagramPool().getBuffer(handle), source, length);
+      return deliver(receiver.processDatagram(handle, length, ready, maxReady, receiveTime));
+   };
+
+   // without FEC the parity is ignored
+   data(100, false);
+   parity(16);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), receiver.getIgnoredCount());
+
+   // 102 is lost, the parity brings it
+   receiver.enableFec();
+   data(101, false);
+   data(102, true);
+   data(103, false);
+   data(104, false);
+   CPPUNIT_ASSERT_EQUAL(size_t(2), delivered.size());
+   CPPUNIT_ASSERT_EQUAL(size_t(3), parity(16));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), receiver.getFecDecoder()->getRecoveredCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), receiver.getLossTracker().getMissingCount());
+   for(size_t i = 0; i < delivered.size(); i++)
+      CPPUNIT_ASSERT_EQUAL(uint64_t(100 + i), delivered[i]);
+   // a late original is a duplicate
+   CPPUNIT_ASSERT_EQUAL(size_t(0), process(receiver, 9, 5, 102, delivered));
+
+   // the parity of a complete block isn't needed
+   for(uint64_t sequence = 105; sequence < 109; sequence++)
+      data(sequence, false);
+   parity(16);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), receiver.getFecDecoder()->getParityCount());
+
+   // two losses in a block are too many
+   data(109, true);
+   data(110, true);
+   data(111, false);
+   data(112, false);
+   CPPUNIT_ASSERT_EQUAL(size_t(0), parity(16));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), receiver.getFecDecoder()->getRecoveredCount());
+   process(receiver, 9, 5, 109, delivered);
+   process(receiver, 9, 5, 110, delivered);
+
+   // a short block, and no room for the rebuilt datagram: getReady brings it
+   data(113, true);
+   data(114, false);
+   CPPUNIT_ASSERT_EQUAL(size_t(0), parity(0));
+   CPPUNIT_ASSERT(receiver.getFecDecoder()->hasRecoverable());
+   CPPUNIT_ASSERT_EQUAL(size_t(2), deliver(receiver.getReady(ready, 16)));
+   CPPUNIT_ASSERT_EQUAL(size_t(15), delivered.size());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(114), delivered.back());
+   CPPUNIT_ASSERT_EQUAL(size_t(16), receiver.getDatagramPool().getFreeCount());
+}
+
+void testCRmdgpReceiver::testCatchUp()
+{
+   const in_addr address = { inet_addr(localAddress) };
+   std::shared_ptr<CUdpMulticastReceiver> udpReceiver(new CUdpMulticastReceiver);
+   CUdpSocket udpSender;
+   CRmdgpReceiver receiver(udpReceiver, CSocketAddress(localAddress, senderPort), 5, 16);
+   const CNanoTime start = CNanoTime::fromSec(100);
+   const CNanoTime retryInterval = CNanoTime::fromMsec(10);
+   const timespec waitTime = { 0, 1000000 };
+   std::vector<uint64_t> delivered;
+   SReceivedDatagram ready[16];
+   uint8_t buffer[2048];
+   sockaddr_in source;
+   // the join that the receiver sent last
+   auto receiveJoin = [&]()
+   {
+      nanosleep(&waitTime, NULL); // give upd/ip stack some time
+      const size_t length = udpSender.receiveFrom(buffer, sizeof(buffer), &source);
+      CPPUNIT_ASSERT(ERmdgpValidation::valid == CRmdgpHeaderView::validate(buffer, length));
+      CPPUNIT_ASSERT(ERmdgpPacketType::join == CRmdgpHeaderView(buffer).getType());
+      CPPUNIT_ASSERT_EQUAL(uint32_t(9), CRmdgpHeaderView(buffer).getSessionId());
+      CJoinReader join(buffer, length);
+      CPPUNIT_ASSERT(!join.isMalformed());
+      CPPUNIT_ASSERT_EQUAL(uint32_t(4321), join.getReceiverId());
+      return join.getRange();
+   };
+   auto processAccept = [&](uint32_t receiverId, const SSequenceRange &range)
+   {
+      const uint32_t handle = receiver.getDatagramPool().acquire();
+      CJoinBuilder accept(receiver.getDatagramPool().getBuffer(handle),
+                          ERmdgpPacketType::joinAccept, 9, 5, receiverId, range);
+      return receiver.processDatagram(handle, accept.getLength(), ready, 16, receiveTime);
+   };
+
+   udpSender.openUdpSocket();
+   udpSender.bind(address, senderPort);
+   udpSender.setNonBlocking();
+   udpReceiver->openUdpSocket();
+   receiver.setReceiverId(4321);
+   // no ACKs between the joins
+   receiver.setAckPolicy(1000, CNanoTime::fromSec(1000));
+
+   // the history must fit in half the reorder window
+   CPPUNIT_ASSERT_THROW(receiver.setCatchUp(0), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(receiver.setCatchUp(9), std::runtime_error);
+   receiver.setCatchUp(6, retryInterval);
+   CPPUNIT_ASSERT(!receiver.isCatchingUp());
+   CPPUNIT_ASSERT(!receiver.sendJoin());
+
+   // the first datagram starts the catch-up, the live datagrams wait for the history
+   CPPUNIT_ASSERT_EQUAL(size_t(0), process(receiver, 9, 5, 100, delivered));
+   CPPUNIT_ASSERT(receiver.isCatchingUp());
+   CPPUNIT_ASSERT(SSequenceRange({ 94, 100 }) == receiver.getCatchUpRange());
+   CPPUNIT_ASSERT(SSequenceRange({ 94, 100 }) == receiveJoin());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), receiver.getJoinCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), process(receiver, 9, 5, 101, delivered));
+   CPPUNIT_ASSERT_THROW(receiver.setCatchUp(6), std::runtime_error);
+
+   // the sender has the history from 96 on, an accept for an other receiver is ignored
+   CPPUNIT_ASSERT_EQUAL(size_t(0), processAccept(1234, { 95, 100 }));
+   CPPUNIT_ASSERT(SSequenceRange({ 94, 100 }) == receiver.getCatchUpRange());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), processAccept(4321, { 96, 100 }));
+   CPPUNIT_ASSERT(SSequenceRange({ 96, 100 }) == receiver.getCatchUpRange());
+
+   // in order only, the replay doesn't touch the live loss tracking
+   CPPUNIT_ASSERT_EQUAL(size_t(1), process(receiver, 9, 5, 96, delivered, 0, rmdgpFlagCatchUp));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), process(receiver, 9, 5, 98, delivered, 0, rmdgpFlagCatchUp));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), process(receiver, 9, 5, 97, delivered, 0, rmdgpFlagCatchUp));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), receiver.getDroppedCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(102), receiver.getLossTracker().getNextExpected());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), receiver.getLossTracker().getMissingCount());
+
+   // without progress the join is sent again, from the next one
+   receiver.handleTimer(start);
+   receiver.handleTimer(start + retryInterval / 2);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), receiver.getJoinCount());
+   receiver.handleTimer(start + retryInterval);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(2), receiver.getJoinCount());
+   CPPUNIT_ASSERT(SSequenceRange({ 98, 100 }) == receiveJoin());
+
+   // the last one of the history releases the live datagrams
+   CPPUNIT_ASSERT_EQUAL(size_t(1), process(receiver, 9, 5, 98, delivered, 0, rmdgpFlagCatchUp));
+   CPPUNIT_ASSERT_EQUAL(size_t(3), process(receiver, 9, 5, 99, delivered, 0, rmdgpFlagCatchUp));
+   CPPUNIT_ASSERT(!receiver.isCatchingUp());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), receiver.getCatchUpCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(1), process(receiver, 9, 5, 102, delivered));
+   const std::vector<uint64_t> expected = { 96, 97, 98, 99, 100, 101, 102 };
+   CPPUNIT_ASSERT(expected == delivered);
+
+   // a late replay is dropped
+   CPPUNIT_ASSERT_EQUAL(size_t(0), process(receiver, 9, 5, 99, delivered, 0, rmdgpFlagCatchUp));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), receiver.getCatchUpCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(16), receiver.getDatagramPool().getFreeCount());
+}
+
+void testCRmdgpReceiver::testCatchUpGiveUp()
+{
+   std::shared_ptr<CUdpMulticastReceiver> udpReceiver(new CUdpMulticastReceiver);
+   CRmdgpReceiver receiver(udpReceiver, CSocketAddress(localAddress, senderPort), 5, 16);
+   const CNanoTime start = CNanoTime::fromSec(100);
+   const CNanoTime retryInterval = CNanoTime::fromMsec(10);
+   std::vector<uint64_t> delivered;
+   SReceivedDatagram ready[16];
+
+   udpReceiver->openUdpSocket();
+   receiver.setCatchUp(4, retryInterval);
+   // nobody listens at the sender port, like a sender without catch-up
+   CPPUNIT_ASSERT_EQUAL(size_t(0), process(receiver, 9, 5, 200, delivered));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), process(receiver, 9, 5, 201, delivered));
+
+   // the first timer starts the retry interval
+   receiver.handleTimer(start);
+   for(uint32_t i = 1; i < CRmdgpReceiver::maxJoinAttempts; i++)
+   {
+      receiver.handleTimer(start + retryInterval * i);
+      CPPUNIT_ASSERT(receiver.isCatchingUp());
+      CPPUNIT_ASSERT_EQUAL(uint64_t(i + 1), receiver.getJoinCount());
+   }
+   CPPUNIT_ASSERT_EQUAL(uint64_t(CRmdgpReceiver::maxJoinAttempts),
+                        receiver.getJoinCount());
+   CPPUNIT_ASSERT(receiver.isCatchingUp());
+
+   // the history is given up, the live datagrams are delivered
+   receiver.handleTimer(start + retryInterval * CRmdgpReceiver::maxJoinAttempts);
+   CPPUNIT_ASSERT(!receiver.isCatchingUp());
+   CPPUNIT_ASSERT_EQUAL(size_t(2), receiver.getReady(ready, 16));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(200), ready[0].sequence);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(201), ready[1].sequence);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), receiver.getReorderBuffer().getSkippedCount());
+}
+
+void testCRmdgpReceiver::testResume()
+{
+   const in_addr address = { inet_addr(localAddress) };
+   std::shared_ptr<CUdpMulticastReceiver> udpReceiver(new CUdpMulticastReceiver);
+   CUdpSocket udpSender;
+   const timespec waitTime = { 0, 1000000 };
+   std::vector<uint64_t> delivered;
+   uint8_t buffer[2048];
+   sockaddr_in source;
+   // the range of the join that a receiver sent last
+   auto receiveJoin = [&]()
+   {
+      nanosleep(&waitTime, NULL); // give upd/ip stack some time
+      const size_t length = udpSender.receiveFrom(buffer, sizeof(buffer), &source);
+      CPPUNIT_ASSERT(ERmdgpValidation::valid == CRmdgpHeaderView::validate(buffer, length));
+      CPPUNIT_ASSERT(ERmdgpPacketType::join == CRmdgpHeaderView(buffer).getType());
+      CJoinReader join(buffer, length);
+      CPPUNIT_ASSERT(!join.isMalformed());
+      return join.getRange();
+   };
+
+   udpSender.openUdpSocket();
+   udpSender.bind(address, senderPort);
+   udpSender.setNonBlocking();
+   udpReceiver->openUdpSocket();
+
+   // only what was not delivered before the restart is asked for
+   {
+      CRmdgpReceiver receiver(udpReceiver, CSocketAddress(localAddress, senderPort), 5, 16);
+      CPPUNIT_ASSERT_THROW(receiver.setResume(97, 9, 5), std::runtime_error);
+      receiver.setCatchUp(6);
+      CPPUNIT_ASSERT_THROW(receiver.setResume(97, 9, 4), std::runtime_error);
+      receiver.setResume(97, 9, 5);
+      CPPUNIT_ASSERT_EQUAL(size_t(0), process(receiver, 9, 5, 100, delivered));
+      CPPUNIT_ASSERT(receiver.isResumed());
+      CPPUNIT_ASSERT(SSequenceRange({ 97, 100 }) == receiver.getCatchUpRange());
+      CPPUNIT_ASSERT(SSequenceRange({ 97, 100 }) == receiveJoin());
+      CPPUNIT_ASSERT_THROW(receiver.setResume(97, 9, 5), std::runtime_error);
+   }
+
+   // the log is of an other session, its sequence numbers mean nothing: the whole history is
+   // asked for
+   {
+      CRmdgpReceiver receiver(udpReceiver, CSocketAddress(localAddress, senderPort), 5, 16);
+      receiver.setCatchUp(6);
+      receiver.setResume(102, 8, 5);
+      CPPUNIT_ASSERT_EQUAL(size_t(0), process(receiver, 9, 5, 100, delivered));
+      CPPUNIT_ASSERT(!receiver.isResumed());
+      CPPUNIT_ASSERT(receiver.isSessionKnown());
+      CPPUNIT_ASSERT_EQUAL(uint32_t(9), receiver.getSessionId());
+      CPPUNIT_ASSERT(receiver.isCatchingUp());
+      CPPUNIT_ASSERT(SSequenceRange({ 94, 100 }) == receiveJoin());
+   }
+
+   // further back than the history, only the history is asked for
+   {
+      CRmdgpReceiver receiver(udpReceiver, CSocketAddress(localAddress, senderPort), 5, 16);
+      receiver.setCatchUp(6);
+      receiver.setResume(90, 9, 5);
+      CPPUNIT_ASSERT_EQUAL(size_t(0), process(receiver, 9, 5, 100, delivered));
+      CPPUNIT_ASSERT(SSequenceRange({ 94, 100 }) == receiveJoin());
+   }
+
+   // the live stream is behind the log, what was delivered is dropped without a join or loss
+   {
+      CRmdgpReceiver receiver(udpReceiver, CSocketAddress(localAddress, senderPort), 5, 16);
+      receiver.setCatchUp(6);
+      receiver.setResume(102, 9, 5);
+      CPPUNIT_ASSERT_EQUAL(size_t(0), process(receiver, 9, 5, 100, delivered));
+      CPPUNIT_ASSERT(!receiver.isCatchingUp());
+      CPPUNIT_ASSERT_EQUAL(size_t(0), process(receiver, 9, 5, 101, delivered));
+      CPPUNIT_ASSERT_EQUAL(size_t(1), process(receiver, 9, 5, 102, delivered));
+      CPPUNIT_ASSERT_EQUAL(size_t(1), process(receiver, 9, 5, 103, delivered));
+      CPPUNIT_ASSERT_EQUAL(uint64_t(0), receiver.getJoinCount());
+      CPPUNIT_ASSERT_EQUAL(uint64_t(2), receiver.getDuplicateFilter().getDuplicateCount());
+      CPPUNIT_ASSERT_EQUAL(uint64_t(0), receiver.getLostCount());
+      const std::vector<uint64_t> expected = { 102, 103 };
+      CPPUNIT_ASSERT(expected == delivered);
+      CPPUNIT_ASSERT_EQUAL(size_t(16), receiver.getDatagramPool().getFreeCount());
+   }
+}
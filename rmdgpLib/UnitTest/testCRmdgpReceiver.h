@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCRmdgpReceiver.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 20, 2021, 8:45 PM
+ */
+
+#ifndef TESTCRMDGPRECEIVER_H
+#define TESTCRMDGPRECEIVER_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class CRmdgpReceiver;
+
+class testCRmdgpReceiver : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCRmdgpReceiver);
+
+    CPPUNIT_TEST(testProcessDatagram);
+    CPPUNIT_TEST(testIgnored);
+    CPPUNIT_TEST(testInOrderDelivery);
+    CPPUNIT_TEST(testHoldLatency);
+    CPPUNIT_TEST(testMemoryCap);
+    CPPUNIT_TEST(testReceiveReserve);
+    CPPUNIT_TEST(testSendAck);
+    CPPUNIT_TEST(testAckPolicy);
+    CPPUNIT_TEST(testHeartbeat);
+    CPPUNIT_TEST(testNakSuppression);
+    CPPUNIT_TEST(testNakSuppressionPeers);
+    CPPUNIT_TEST(testFec);
+    CPPUNIT_TEST(testCatchUp);
+    CPPUNIT_TEST(testCatchUpGiveUp);
+    CPPUNIT_TEST(testResume);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCRmdgpReceiver();
+    virtual ~testCRmdgpReceiver();
+    void setUp();
+    void tearDown();
+
+private:
+    void testProcessDatagram();
+    void testIgnored();
+    void testInOrderDelivery();
+    void testHoldLatency();
+    void testMemoryCap();
+    void testReceiveReserve();
+    void testSendAck();
+    void testAckPolicy();
+    void testHeartbeat();
+    void testNakSuppression();
+    void testNakSuppressionPeers();
+    void testFec();
+    void testCatchUp();
+    void testCatchUpGiveUp();
+    void testResume();
+
+    /// \brief builds a data datagram in a buffer of the pool of receiver and processes it. The
+    ///        delivered datagrams are checked, released and their sequence numbers appended to
+    ///        delivered.
+    /// \param flags the flags of the header
+    /// \return the number of delivered datagrams
+    static size_t process(CRmdgpReceiver &receiver, uint32_t sessionId, uint32_t streamId,
+                    uint64_t sequence, std::vector<uint64_t> &delivered, size_t truncate = 0,
+                    uint16_t flags = 0);
+};
+
+#endif /* TESTCRMDGPRECEIVER_H */
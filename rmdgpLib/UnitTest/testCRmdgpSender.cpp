@@ -0,0 +1,1134 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCRmdgpSender.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 17, 2021, 7:40 PM
+ */
+
+#include "testCRmdgpSender.h"
+#include "../CRmdgpSender.h"
+#include "../CRmdgpHeader.h"
+#include "../CNakPacket.h"
+#include "../CAckPacket.h"
+#include "../CReceiverListener.h"
+#include "../CMessageBatch.h"
+#include "../CFragmentAssembler.h"
+#include "../CFragmentHeader.h"
+#include "../CJoinPacket.h"
+#include "../CSenderJournal.h"
+#include "../../socketLib/CLatencyRecorder.h"
+#include "../../socketLib/CMappedFile.h"
+#include "../../socketLib/CPacer.h"
+#include "../../socketLib/CUdpMulticastSender.h"
+#include "../../socketLib/CUdpSocket.h"
+#include "../../socketLib/CSocketAddress.h"
+#include "../../socketLib/CNanoTime.h"
+#include <arpa/inet.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <stdexcept>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCRmdgpSender);
+
+namespace {
+   // the datagrams are sent to a unicast address on the loopback interface, so the test doesn't
+   // depend on multicast routing
+   const char *localAddress = "127.0.0.1";
+   const int receiverPort = 7801;
+   const uint32_t sessionId = 0x5e55;
+   const uint32_t streamId = 3;
+
+   /// \brief remembers the ejected receivers
+   class CEjectionRecorder : public CReceiverListener {
+   public:
+      void onReceiverEjected(uint32_t receiverId, double rate) override
+      {
+         ejectedIds.push_back(receiverId);
+         rates.push_back(rate);
+      }
+
+      std::vector<uint32_t> ejectedIds;
+      std::vector<double> rates;
+   };
+
+   /// \brief remembers the feedback
+   class CFeedbackRecorder : public CCongestionController {
+   public:
+      CFeedbackRecorder() : rate(5000) {}
+      void onFeedback(uint32_t receiverId, double lossRate, const CNanoTime &rtt,
+                      const CNanoTime &now) override
+      {
+         receiverIds.push_back(receiverId);
+         lossRates.push_back(lossRate);
+         rtts.push_back(rtt);
+      }
+      void onReceiverRemoved(uint32_t receiverId) override { removedIds.push_back(receiverId); }
+      double getRate(const CNanoTime &now) override { return rate; }
+
+      std::vector<uint32_t> receiverIds;
+      std::vector<double> lossRates;
+      std::vector<CNanoTime> rtts;
+      std::vector<uint32_t> removedIds;
+      double rate;
+   };
+}
+
+testCRmdgpSender::testCRmdgpSender()
+{
+}
+
+testCRmdgpSender::~testCRmdgpSender()
+{
+}
+
+void testCRmdgpSender::setUp()
+{
+   const in_addr address = { inet_addr(localAddress) };
+
+   udpReceiver.reset(new CUdpSocket);
+   udpReceiver->openUdpSocket();
+   udpReceiver->bind(address, receiverPort);
+   udpReceiver->setNonBlocking();
+
+   udpSender.reset(new CUdpMulticastSender);
+   udpSender->open(localAddress, receiverPort, localAddress);
+}
+
+void testCRmdgpSender::tearDown()
+{
+   udpSender.reset();
+   udpReceiver.reset();
+}
+
+void testCRmdgpSender::receiveAndVerify(uint64_t expectedSequence, size_t expectedPayloadLength,
+                    bool expectRetransmission)
+{
+   const timespec waitTime = { 0, 1000000 };
+   uint8_t buffer[2048];
+   sockaddr_in source;
+
+   nanosleep(&waitTime, NULL); // give upd/ip stack some time
+   const size_t length = udpReceiver->receiveFrom(buffer, sizeof(buffer), &source);
+
+   CPPUNIT_ASSERT(ERmdgpValidation::valid == CRmdgpHeaderView::validate(buffer, length));
+   const CRmdgpHeaderView header(buffer);
+   CPPUNIT_ASSERT_EQUAL(expectedSequence, header.getSequence());
+   CPPUNIT_ASSERT_EQUAL(expectedPayloadLength, size_t(header.getPayloadLength()));
+   CPPUNIT_ASSERT_EQUAL(sessionId, header.getSessionId());
+   CPPUNIT_ASSERT_EQUAL(streamId, header.getStreamId());
+   CPPUNIT_ASSERT_EQUAL(expectRetransmission, header.hasFlag(rmdgpFlagRetransmission));
+   for(size_t i = 0; i < expectedPayloadLength; i++)
+      CPPUNIT_ASSERT_EQUAL(uint8_t(expectedSequence + i), header.getPayload()[i]);
+}
+
+void testCRmdgpSender::testSend()
+{
+   CRmdgpSender sender(udpSender, sessionId, streamId, 16, 100000, 1000, 500);
+   uint8_t payload[1000];
+
+   for(uint64_t sequence = 500; sequence < 503; sequence++)
+   {
+      for(size_t i = 0; i < sizeof(payload); i++)
+         payload[i] = uint8_t(sequence + i);
+      CPPUNIT_ASSERT(sender.send(payload, sequence - 400));
+      receiveAndVerify(sequence, sequence - 400, false);
+   }
+
+   CPPUNIT_ASSERT_EQUAL(uint64_t(503), sender.getNextSequence());
+   CPPUNIT_ASSERT_EQUAL(size_t(3), sender.getRetransmissionRing().getCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(3 * CRmdgpHeader::size + 100 + 101 + 102),
+                        sender.getRetransmissionRing().getBytes());
+}
+
+void testCRmdgpSender::testResend()
+{
+   CRmdgpSender sender(udpSender, sessionId, streamId, 16, 100000);
+   uint8_t payload[10];
+
+   for(uint64_t sequence = 0; sequence < 3; sequence++)
+   {
+      for(size_t i = 0; i < sizeof(payload); i++)
+         payload[i] = uint8_t(sequence + i);
+      CPPUNIT_ASSERT(sender.send(payload, sizeof(payload)));
+      receiveAndVerify(sequence, sizeof(payload), false);
+   }
+
+   CPPUNIT_ASSERT(sender.resend(1));
+   receiveAndVerify(1, sizeof(payload), true);
+
+   CPPUNIT_ASSERT_EQUAL(size_t(2), sender.acknowledge(2));
+   CPPUNIT_ASSERT(!sender.resend(1));
+   CPPUNIT_ASSERT(!sender.resend(3));
+   CPPUNIT_ASSERT(sender.resend(2));
+   receiveAndVerify(2, sizeof(payload), true);
+}
+
+void testCRmdgpSender::testWindowFull()
+{
+   CRmdgpSender sender(udpSender, sessionId, streamId, 2, 100000, 100);
+   uint8_t payload[101] = { 0 };
+
+   CPPUNIT_ASSERT(!sender.send(payload, 101));
+   CPPUNIT_ASSERT(sender.send(payload, 100));
+   CPPUNIT_ASSERT(sender.send(payload, 100));
+   CPPUNIT_ASSERT(!sender.send(payload, 1));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(2), sender.getNextSequence());
+
+   sender.acknowledge(1);
+   CPPUNIT_ASSERT(sender.send(payload, 1));
+}
+
+void testCRmdgpSender::testConstructorException()
+{
+   CPPUNIT_ASSERT_THROW(CRmdgpSender(udpSender, sessionId, streamId, 2, 100000,
+                        CRmdgpHeader::maxPayloadLength + 1), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CRmdgpSender(udpSender, sessionId, streamId, 0, 100000), std::runtime_error);
+}
+
+void testCRmdgpSender::testProcessNak()
+{
+   CRmdgpSender sender(udpSender, sessionId, streamId, 16, 100000, 100, 20);
+   uint8_t payload[10];
+   uint8_t nak[100];
+
+   for(uint64_t sequence = 20; sequence < 30; sequence++)
+   {
+      for(size_t i = 0; i < sizeof(payload); i++)
+         payload[i] = uint8_t(sequence + i);
+      sender.send(payload, sizeof(payload));
+      receiveAndVerify(sequence, sizeof(payload), false);
+   }
+   sender.acknowledge(22);
+
+   // 21 is released, 29 is the last one sent: 22, 25, 26 and 29 are resent
+   CNakBuilder builder(nak, sizeof(nak), sessionId, streamId, 1);
+   builder.add({ 21, 23 });
+   builder.add({ 25, 27 });
+   builder.add({ 29, 40 });
+   CPPUNIT_ASSERT_EQUAL(size_t(4), sender.processNak(nak, builder.getLength()));
+   receiveAndVerify(22, sizeof(payload), true);
+   receiveAndVerify(25, sizeof(payload), true);
+   receiveAndVerify(26, sizeof(payload), true);
+   receiveAndVerify(29, sizeof(payload), true);
+
+   // other session, or not a NAK
+   CNakBuilder otherSession(nak, sizeof(nak), sessionId + 1, streamId, 1);
+   otherSession.add({ 25, 26 });
+   CPPUNIT_ASSERT_EQUAL(size_t(0), sender.processNak(nak, otherSession.getLength()));
+   CRmdgpHeaderBuilder(nak).setSessionId(sessionId).setStreamId(streamId).setSequence(25);
+   CPPUNIT_ASSERT_EQUAL(size_t(0), sender.processNak(nak, CRmdgpHeader::size));
+}
+
+void testCRmdgpSender::testRepairLimits()
+{
+   CRmdgpSender sender(udpSender, sessionId, streamId, 64, 100000);
+   const CSocketAddress requester(localAddress, receiverPort);
+   const CNanoTime start = CNanoTime::fromSec(100);
+   const timespec waitTime = { 0, 1000000 };
+   uint8_t payload[10];
+   uint8_t nak[100];
+   uint8_t buffer[2048];
+   sockaddr_in source;
+   auto drain = [&]()
+   {
+      size_t count = 0;
+      nanosleep(&waitTime, NULL); // give upd/ip stack some time
+      while(udpReceiver->receiveFrom(buffer, sizeof(buffer), &source) > 0)
+         count++;
+      return count;
+   };
+
+   for(uint64_t sequence = 0; sequence < 40; sequence++)
+   {
+      for(size_t i = 0; i < sizeof(payload); i++)
+         payload[i] = uint8_t(sequence + i);
+      sender.send(payload, sizeof(payload));
+   }
+   CPPUNIT_ASSERT_EQUAL(size_t(40), drain());
+   CPPUNIT_ASSERT_THROW(sender.setRepairLimits(0, 8), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(sender.setRepairLimits(5, 0), std::runtime_error);
+   sender.setRepairLimits(5, 8);
+
+   // a bogus NAK for everything gets 5 repairs, and 8 go out until the next handleTimer
+   CNakBuilder builder(nak, sizeof(nak), sessionId, streamId, 1);
+   builder.add({ 0, 1000000 });
+   CPPUNIT_ASSERT_EQUAL(size_t(5), sender.processNak(nak, builder.getLength(), requester, start));
+   CPPUNIT_ASSERT_EQUAL(size_t(3), sender.processNak(nak, builder.getLength(), requester, start));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), sender.processNak(nak, builder.getLength()));
+   CPPUNIT_ASSERT_EQUAL(size_t(8), drain());
+   sender.handleTimer(start);
+   CPPUNIT_ASSERT_EQUAL(size_t(5), sender.processNak(nak, builder.getLength()));
+   CPPUNIT_ASSERT_EQUAL(size_t(5), drain());
+
+   // the gathered repairs are bounded the same way
+   sender.setRepairPolicy(0, CNanoTime());
+   CPPUNIT_ASSERT_EQUAL(size_t(5), sender.processNak(nak, builder.getLength(), requester, start));
+   CNakBuilder more(nak, sizeof(nak), sessionId, streamId, 2);
+   more.add({ 10, 20 });
+   CPPUNIT_ASSERT_EQUAL(size_t(5), sender.processNak(nak, more.getLength(), requester, start));
+   sender.handleTimer(start);
+   CPPUNIT_ASSERT_EQUAL(size_t(8), drain());
+}
+
+void testCRmdgpSender::testHandleFeedback()
+{
+   CRmdgpSender sender(udpSender, sessionId, streamId, 16, 100000);
+   uint8_t payload[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+   uint8_t nak[100];
+
+   udpSender->setNonBlocking();
+   CPPUNIT_ASSERT_EQUAL(size_t(0), sender.handleFeedback(CNanoTime::fromSec(100)));
+
+   sender.send(payload, sizeof(payload));
+   receiveAndVerify(0, sizeof(payload), false);
+
+   // the receiver sends its NAK to the unicast port of the sender
+   CSocketAddress senderAddress(localAddress, udpSender->getSenderPort());
+   CNakBuilder builder(nak, sizeof(nak), sessionId, streamId, 1);
+   builder.add({ 0, 1 });
+   udpReceiver->sendTo(nak, builder.getLength(), &senderAddress);
+   udpReceiver->sendTo(nak, builder.getLength(), &senderAddress);
+
+   // and an ACK, that releases the datagram
+   CAckBuilder ack(nak, sizeof(nak), sessionId, streamId, 1, 1);
+   udpReceiver->sendTo(nak, ack.getLength(), &senderAddress);
+
+   const timespec waitTime = { 0, 1000000 };
+   nanosleep(&waitTime, NULL);
+   CPPUNIT_ASSERT_EQUAL(size_t(2), sender.handleFeedback(CNanoTime::fromSec(100)));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), sender.getAckCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), sender.getRetransmissionRing().getCount());
+}
+
+void testCRmdgpSender::testProcessAck()
+{
+   CRmdgpSender sender(udpSender, sessionId, streamId, 16, 100000);
+   uint8_t payload[10] = { 0 };
+   uint8_t datagram[100];
+   const CNanoTime now = CNanoTime::fromSec(100);
+
+   for(int i = 0; i < 10; i++)
+      sender.send(payload, sizeof(payload));
+
+   // nothing is released before the receivers are known
+   CPPUNIT_ASSERT_EQUAL(size_t(0), sender.updateWindow());
+
+   CAckBuilder first(datagram, sizeof(datagram), sessionId, streamId, 1, 6);
+   first.add({ 8, 10 });
+   CPPUNIT_ASSERT(sender.processAck(datagram, first.getLength(), now));
+   CAckBuilder second(datagram, sizeof(datagram), sessionId, streamId, 2, 4);
+   CPPUNIT_ASSERT(sender.processAck(datagram, second.getLength(), now));
+   CPPUNIT_ASSERT_EQUAL(size_t(2), sender.getReceiverTable().getCount());
+   // the window follows the slowest receiver
+   CPPUNIT_ASSERT_EQUAL(size_t(4), sender.updateWindow());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), sender.getRetransmissionRing().getOldestSequence());
+
+   // an old ACK that arrives late doesn't move a receiver back
+   CAckBuilder late(datagram, sizeof(datagram), sessionId, streamId, 2, 2);
+   CPPUNIT_ASSERT(sender.processAck(datagram, late.getLength(), now));
+   CAckBuilder newer(datagram, sizeof(datagram), sessionId, streamId, 2, 7);
+   CPPUNIT_ASSERT(sender.processAck(datagram, newer.getLength(), now));
+   CPPUNIT_ASSERT_EQUAL(size_t(2), sender.updateWindow());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(6), sender.getRetransmissionRing().getOldestSequence());
+
+   // not sent yet, other session, or not an ACK
+   CAckBuilder future(datagram, sizeof(datagram), sessionId, streamId, 3, 11);
+   CPPUNIT_ASSERT(!sender.processAck(datagram, future.getLength(), now));
+   CAckBuilder futureRange(datagram, sizeof(datagram), sessionId, streamId, 3, 8);
+   futureRange.add({ 9, 11 });
+   CPPUNIT_ASSERT(!sender.processAck(datagram, futureRange.getLength(), now));
+   CAckBuilder otherSession(datagram, sizeof(datagram), sessionId + 1, streamId, 3, 8);
+   CPPUNIT_ASSERT(!sender.processAck(datagram, otherSession.getLength(), now));
+   CNakBuilder nak(datagram, sizeof(datagram), sessionId, streamId, 1);
+   nak.add({ 8, 9 });
+   CPPUNIT_ASSERT(!sender.processAck(datagram, nak.getLength(), now));
+   CPPUNIT_ASSERT_EQUAL(size_t(2), sender.getReceiverTable().getCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), sender.getAckCount());
+
+   // a receiver that doesn't fit in the table is ignored
+   CRmdgpSender small(udpSender, sessionId, streamId, 16, 100000, 100, 0, 1);
+   small.send(payload, sizeof(payload));
+   CAckBuilder fits(datagram, sizeof(datagram), sessionId, streamId, 1, 0);
+   CPPUNIT_ASSERT(small.processAck(datagram, fits.getLength(), now));
+   CAckBuilder full(datagram, sizeof(datagram), sessionId, streamId, 2, 0);
+   CPPUNIT_ASSERT(!small.processAck(datagram, full.getLength(), now));
+}
+
+void testCRmdgpSender::testEjectReceiver()
+{
+   CRmdgpSender sender(udpSender, sessionId, streamId, 4, 100000);
+   std::shared_ptr<CEjectionRecorder> recorder(new CEjectionRecorder);
+   uint8_t payload[10] = { 0 };
+   uint8_t datagram[100];
+   const CNanoTime start = CNanoTime::fromSec(100);
+   const CNanoTime interval = CNanoTime::fromMsec(100);
+
+   for(int i = 0; i < 4; i++)
+      CPPUNIT_ASSERT(sender.send(payload, sizeof(payload)));
+
+   // without a policy nobody is ejected
+   CPPUNIT_ASSERT_EQUAL(size_t(0), sender.checkReceivers(start));
+
+   CAckBuilder fast(datagram, sizeof(datagram), sessionId, streamId, 1, 4);
+   CPPUNIT_ASSERT(sender.processAck(datagram, fast.getLength(), start));
+   CAckBuilder slow(datagram, sizeof(datagram), sessionId, streamId, 2, 0);
+   CPPUNIT_ASSERT(sender.processAck(datagram, slow.getLength(), start));
+   // receiver 2 holds the window
+   CPPUNIT_ASSERT_EQUAL(size_t(0), sender.updateWindow());
+   CPPUNIT_ASSERT(!sender.send(payload, sizeof(payload)));
+
+   sender.setMinimumRate(1000.0, interval, CNanoTime());
+   sender.setReceiverListener(recorder);
+   CPPUNIT_ASSERT_EQUAL(size_t(0), sender.checkReceivers(start));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), sender.checkReceivers(start + interval));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), recorder->ejectedIds.size());
+   CPPUNIT_ASSERT_EQUAL(uint32_t(2), recorder->ejectedIds[0]);
+   CPPUNIT_ASSERT_EQUAL(0.0, recorder->rates[0]);
+   CPPUNIT_ASSERT(sender.isEjected(2));
+   CPPUNIT_ASSERT(!sender.isEjected(1));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), sender.getEjectedCount());
+
+   // the window opened at once, and the ejected receiver stays out
+   CPPUNIT_ASSERT_EQUAL(size_t(1), sender.getReceiverTable().getCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), sender.getRetransmissionRing().getOldestSequence());
+   CPPUNIT_ASSERT(sender.send(payload, sizeof(payload)));
+   CAckBuilder again(datagram, sizeof(datagram), sessionId, streamId, 2, 4);
+   CPPUNIT_ASSERT(!sender.processAck(datagram, again.getLength(), start + interval));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), sender.getReceiverTable().getCount());
+   // and gets no repairs
+   CNakBuilder ejectedNak(datagram, sizeof(datagram), sessionId, streamId, 2);
+   CPPUNIT_ASSERT(ejectedNak.add({ 4, 5 }));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), sender.processNak(datagram, ejectedNak.getLength()));
+   CNakBuilder memberNak(datagram, sizeof(datagram), sessionId, streamId, 1);
+   CPPUNIT_ASSERT(memberNak.add({ 4, 5 }));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), sender.processNak(datagram, memberNak.getLength()));
+
+   // until it comes back with a join, for instance after a restart, but not right after the
+   // ejection. It catches up from the history and its ACKs count again.
+   const CNanoTime ejected = start + interval;
+   const CNanoTime rejoin = ejected + CRmdgpSender::defaultRejoinDelay;
+   const CSocketAddress joinerAddress(localAddress, receiverPort);
+   const timespec waitTime = { 0, 1000000 };
+   uint8_t buffer[2048];
+   sockaddr_in source;
+   sender.setCatchUp(1e6, 3000, 1);
+   CJoinBuilder join(datagram, ERmdgpPacketType::join, sessionId, streamId, 2, { 2, 5 });
+   CPPUNIT_ASSERT(!sender.processJoin(datagram, join.getLength(), joinerAddress,
+                                      rejoin - CNanoTime::fromMsec(1)));
+   CPPUNIT_ASSERT(sender.isEjected(2));
+   CPPUNIT_ASSERT(sender.processJoin(datagram, join.getLength(), joinerAddress, rejoin));
+   CPPUNIT_ASSERT(!sender.isEjected(2));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), sender.getEjectedCount());
+   sender.handleTimer(rejoin);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(3), sender.getReplayedCount());
+   nanosleep(&waitTime, NULL); // give upd/ip stack some time
+   size_t replayed = 0;
+   while(udpReceiver->receiveFrom(buffer, sizeof(buffer), &source) > 0)
+      replayed += CRmdgpHeaderView(buffer).hasFlag(rmdgpFlagCatchUp);
+   CPPUNIT_ASSERT_EQUAL(size_t(3), replayed);
+   CAckBuilder back(datagram, sizeof(datagram), sessionId, streamId, 2, 5);
+   CPPUNIT_ASSERT(sender.processAck(datagram, back.getLength(), rejoin));
+   CPPUNIT_ASSERT_EQUAL(size_t(2), sender.getReceiverTable().getCount());
+
+   // a receiver that doesn't come back is forgotten after the rejoin delay
+   CRmdgpSender other(udpSender, sessionId, streamId, 4, 100000);
+   CPPUNIT_ASSERT(other.send(payload, sizeof(payload)));
+   CAckBuilder gone(datagram, sizeof(datagram), sessionId, streamId, 3, 0);
+   CPPUNIT_ASSERT(other.processAck(datagram, gone.getLength(), start));
+   other.setMinimumRate(1000.0, interval, CNanoTime());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), other.checkReceivers(start));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), other.checkReceivers(ejected));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), other.checkReceivers(rejoin - CNanoTime::fromMsec(1)));
+   CPPUNIT_ASSERT(other.isEjected(3));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), other.checkReceivers(rejoin));
+   CPPUNIT_ASSERT(!other.isEjected(3));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), other.getEjectedCount());
+}
+
+void testCRmdgpSender::testHeartbeat()
+{
+   CRmdgpSender sender(udpSender, sessionId, streamId, 16, 100000, 100, 40);
+   const CNanoTime start = CNanoTime::fromSec(100);
+   uint8_t payload[1] = { 40 };
+   uint8_t buffer[2048];
+   sockaddr_in source;
+
+   sender.setHeartbeatIntervals(CNanoTime::fromMsec(10), CNanoTime::fromMsec(30));
+   // the first call starts the idle time
+   CPPUNIT_ASSERT(!sender.handleTimer(start));
+   CPPUNIT_ASSERT(!sender.handleTimer(start + CNanoTime::fromMsec(9)));
+   CPPUNIT_ASSERT(sender.handleTimer(start + CNanoTime::fromMsec(10)));
+
+   const timespec waitTime = { 0, 1000000 };
+   nanosleep(&waitTime, NULL); // give upd/ip stack some time
+   const size_t length = udpReceiver->receiveFrom(buffer, sizeof(buffer), &source);
+   CPPUNIT_ASSERT(ERmdgpValidation::valid == CRmdgpHeaderView::validate(buffer, length));
+   const CRmdgpHeaderView header(buffer);
+   CPPUNIT_ASSERT(ERmdgpPacketType::heartbeat == header.getType());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(40), header.getSequence());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), size_t(header.getPayloadLength()));
+   CPPUNIT_ASSERT_EQUAL(sessionId, header.getSessionId());
+   CPPUNIT_ASSERT_EQUAL(streamId, header.getStreamId());
+
+   // the interval doubles, up to the maximum
+   CPPUNIT_ASSERT(!sender.handleTimer(start + CNanoTime::fromMsec(29)));
+   CPPUNIT_ASSERT(sender.handleTimer(start + CNanoTime::fromMsec(30)));
+   CPPUNIT_ASSERT(!sender.handleTimer(start + CNanoTime::fromMsec(59)));
+   CPPUNIT_ASSERT(sender.handleTimer(start + CNanoTime::fromMsec(60)));
+   CPPUNIT_ASSERT(sender.handleTimer(start + CNanoTime::fromMsec(90)));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), sender.getHeartbeatCount());
+   for(int i = 0; i < 3; i++)
+   {
+      CPPUNIT_ASSERT_EQUAL(size_t(CRmdgpHeader::size),
+                           udpReceiver->receiveFrom(buffer, sizeof(buffer), &source));
+      CPPUNIT_ASSERT(ERmdgpPacketType::heartbeat == CRmdgpHeaderView(buffer).getType());
+   }
+
+   // traffic starts the short interval again
+   CPPUNIT_ASSERT(sender.send(payload, sizeof(payload)));
+   receiveAndVerify(40, 1, false);
+   CPPUNIT_ASSERT(!sender.handleTimer(start + CNanoTime::fromMsec(100)));
+   CPPUNIT_ASSERT(!sender.handleTimer(start + CNanoTime::fromMsec(109)));
+   CPPUNIT_ASSERT(sender.handleTimer(start + CNanoTime::fromMsec(110)));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(5), sender.getHeartbeatCount());
+
+   CPPUNIT_ASSERT_THROW(sender.setHeartbeatIntervals(CNanoTime(), CNanoTime::fromMsec(30)),
+                        std::runtime_error);
+   CPPUNIT_ASSERT_THROW(sender.setHeartbeatIntervals(CNanoTime::fromMsec(10),
+                        CNanoTime::fromMsec(9)), std::runtime_error);
+}
+
+void testCRmdgpSender::testRepairPolicy()
+{
+   CRmdgpSender sender(udpSender, sessionId, streamId, 16, 100000);
+   const CSocketAddress requester(localAddress, receiverPort);
+   const CSocketAddress other(localAddress, receiverPort + 10);
+   const CNanoTime start = CNanoTime::fromSec(100);
+   const CNanoTime window = CNanoTime::fromMsec(2);
+   uint8_t payload[10];
+   uint8_t nak[100];
+   uint8_t buffer[2048];
+   sockaddr_in source;
+
+   for(uint64_t sequence = 0; sequence < 3; sequence++)
+   {
+      for(size_t i = 0; i < sizeof(payload); i++)
+         payload[i] = uint8_t(sequence + i);
+      sender.send(payload, sizeof(payload));
+      receiveAndVerify(sequence, sizeof(payload), false);
+   }
+   CPPUNIT_ASSERT(sender.getRepairScheduler() == nullptr);
+   sender.setRepairPolicy(1, window);
+
+   // one receiver misses 1, the repair is sent to it alone, once
+   CNakBuilder single(nak, sizeof(nak), sessionId, streamId, 1);
+   single.add({ 1, 2 });
+   CPPUNIT_ASSERT_EQUAL(size_t(1), sender.processNak(nak, single.getLength(), requester, start));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), sender.processNak(nak, single.getLength(), requester, start));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), sender.sendRepairs(start + window / 2));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), sender.sendRepairs(start + window));
+   receiveAndVerify(1, sizeof(payload), true);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), sender.getRepairScheduler()->getUnicastCount());
+
+   // two receivers miss 2, it is multicast
+   CNakBuilder shared(nak, sizeof(nak), sessionId, streamId, 1);
+   shared.add({ 2, 3 });
+   sender.processNak(nak, shared.getLength(), requester, start);
+   sender.processNak(nak, shared.getLength(), other, start);
+   CPPUNIT_ASSERT(!sender.handleTimer(start + window));
+   receiveAndVerify(2, sizeof(payload), true);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), sender.getRepairScheduler()->getMulticastCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), udpReceiver->receiveFrom(buffer, sizeof(buffer), &source));
+}
+
+void testCRmdgpSender::testFec()
+{
+   CRmdgpSender sender(udpSender, sessionId, streamId, 16, 100000);
+   const CNanoTime start = CNanoTime::fromSec(100);
+   const timespec waitTime = { 0, 1000000 };
+   uint8_t payload[10];
+   uint8_t buffer[2048];
+   sockaddr_in source;
+   auto sendData = [&](uint64_t sequence, size_t length)
+   {
+      for(size_t i = 0; i < length; i++)
+         payload[i] = uint8_t(sequence + i);
+      CPPUNIT_ASSERT(sender.send(payload, length));
+      receiveAndVerify(sequence, length, false);
+   };
+   auto receiveParity = [&](uint64_t firstSequence, uint8_t blockSize)
+   {
+      nanosleep(&waitTime, NULL); // give upd/ip stack some time
+      const size_t length = udpReceiver->receiveFrom(buffer, sizeof(buffer), &source);
+      CPPUNIT_ASSERT(ERmdgpValidation::valid == CRmdgpHeaderView::validate(buffer, length));
+      const CRmdgpHeaderView header(buffer);
+      CPPUNIT_ASSERT(ERmdgpPacketType::parity == header.getType());
+      CPPUNIT_ASSERT_EQUAL(firstSequence, header.getSequence());
+      CPPUNIT_ASSERT_EQUAL(blockSize, header.getFecBlockSize());
+      return length;
+   };
+
+   CPPUNIT_ASSERT(sender.getFecEncoder() == nullptr);
+   CPPUNIT_ASSERT_THROW(sender.setFecBlockSize(CFecEncoder::maxBlockSize + 1), std::runtime_error);
+   sender.setFecBlockSize(2);
+
+   // a parity datagram after every 2 data datagrams
+   sendData(0, 10);
+   sendData(1, 6);
+   const size_t length = receiveParity(0, 2);
+   CPPUNIT_ASSERT_EQUAL(CRmdgpHeader::size + CFecEncoder::parityHeaderSize + 10, length);
+   CPPUNIT_ASSERT_EQUAL(uint16_t(10 ^ 6), CRmdgpHeader::load16(buffer + CRmdgpHeader::size));
+   for(size_t i = 0; i < 10; i++)
+      CPPUNIT_ASSERT_EQUAL(uint8_t(uint8_t(i) ^ ((i < 6) ? uint8_t(1 + i) : 0)),
+                           buffer[CRmdgpHeader::size + CFecEncoder::parityHeaderSize + i]);
+
+   // the data datagrams carry their position, a resend keeps it
+   sender.send(payload, 1);
+   CPPUNIT_ASSERT(sender.resend(2));
+   for(int i = 0; i < 2; i++)
+   {
+      nanosleep(&waitTime, NULL); // give upd/ip stack some time
+      udpReceiver->receiveFrom(buffer, sizeof(buffer), &source);
+      const CRmdgpHeaderView header(buffer);
+      CPPUNIT_ASSERT(header.hasFlag(rmdgpFlagFec));
+      CPPUNIT_ASSERT_EQUAL(uint8_t(2), header.getFecBlockSize());
+      CPPUNIT_ASSERT_EQUAL(uint8_t(0), header.getFecIndex());
+   }
+
+   // when the sender goes idle the short block gets its parity
+   CPPUNIT_ASSERT(!sender.handleTimer(start));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), sender.getFecEncoder()->getParityCount());
+   sender.handleTimer(start + CNanoTime::fromMsec(1));
+   receiveParity(2, 1);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(2), sender.getFecEncoder()->getParityCount());
+
+   // without FEC the flag is gone
+   sender.setFecBlockSize(0);
+   CPPUNIT_ASSERT(sender.getFecEncoder() == nullptr);
+   sender.send(payload, 1);
+   nanosleep(&waitTime, NULL); // give upd/ip stack some time
+   udpReceiver->receiveFrom(buffer, sizeof(buffer), &source);
+   CPPUNIT_ASSERT(!CRmdgpHeaderView(buffer).hasFlag(rmdgpFlagFec));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), udpReceiver->receiveFrom(buffer, sizeof(buffer), &source));
+}
+
+void testCRmdgpSender::testFecRepair()
+{
+   CRmdgpSender sender(udpSender, sessionId, streamId, 16, 100000);
+   const CSocketAddress requester(localAddress, receiverPort);
+   const CSocketAddress other(localAddress, receiverPort + 10);
+   const CNanoTime start = CNanoTime::fromSec(100);
+   const CNanoTime window = CNanoTime::fromMsec(2);
+   const timespec waitTime = { 0, 1000000 };
+   uint8_t payload[10];
+   uint8_t nak[100];
+   uint8_t buffer[2048];
+   sockaddr_in source;
+   auto receiveParity = [&](uint8_t row)
+   {
+      nanosleep(&waitTime, NULL); // give upd/ip stack some time
+      const size_t length = udpReceiver->receiveFrom(buffer, sizeof(buffer), &source);
+      CPPUNIT_ASSERT(ERmdgpValidation::valid == CRmdgpHeaderView::validate(buffer, length));
+      const CRmdgpHeaderView header(buffer);
+      CPPUNIT_ASSERT(ERmdgpPacketType::parity == header.getType());
+      CPPUNIT_ASSERT_EQUAL(uint64_t(0), header.getSequence());
+      CPPUNIT_ASSERT_EQUAL(uint8_t(4), header.getFecBlockSize());
+      CPPUNIT_ASSERT_EQUAL(row, header.getFecIndex());
+      CPPUNIT_ASSERT_EQUAL(row > 0, header.hasFlag(rmdgpFlagRetransmission));
+   };
+   // both receivers ask for range, so the repairs are multicast
+   auto nakFromBoth = [&](const SSequenceRange &range)
+   {
+      CNakBuilder builder(nak, sizeof(nak), sessionId, streamId, 1);
+      builder.add(range);
+      sender.processNak(nak, builder.getLength(), requester, start);
+      sender.processNak(nak, builder.getLength(), other, start);
+      return sender.sendRepairs(start + window);
+   };
+
+   CPPUNIT_ASSERT_THROW(sender.setFecRepair(CFecEncoder::maxParityRows), std::runtime_error);
+   sender.setFecBlockSize(4);
+   sender.setRepairPolicy(1, window);
+   sender.setFecRepair(2);
+   CPPUNIT_ASSERT_THROW(sender.setFecBlockSize(4, CFecEncoder::maxParityRows - 1),
+                        std::runtime_error);
+   // the FEC controller may raise the parity rows to its maximum, that leaves room for the
+   // repair rows as well
+   CPPUNIT_ASSERT_THROW(sender.setFecController(0.001, CFecEncoder::maxParityRows - 1),
+                        std::runtime_error);
+   {
+      CRmdgpSender controlled(udpSender, sessionId, streamId, 16, 100000);
+      controlled.setFecController(0.001, CFecEncoder::maxParityRows - 2);
+      CPPUNIT_ASSERT_THROW(controlled.setFecRepair(3), std::runtime_error);
+      controlled.setFecRepair(2);
+   }
+   for(uint64_t sequence = 0; sequence < 5; sequence++)
+   {
+      for(size_t i = 0; i < sizeof(payload); i++)
+         payload[i] = uint8_t(sequence + i);
+      sender.send(payload, sizeof(payload));
+      receiveAndVerify(sequence, sizeof(payload), false);
+      if(sequence == 3)
+         receiveParity(0);
+   }
+
+   // 2 losses in the finished block are answered with 2 new parity rows
+   CPPUNIT_ASSERT_EQUAL(size_t(2), nakFromBoth({ 1, 3 }));
+   receiveParity(1);
+   receiveParity(2);
+
+   // the repair rows are used up, the datagrams are resent
+   CPPUNIT_ASSERT_EQUAL(size_t(2), nakFromBoth({ 1, 3 }));
+   receiveAndVerify(1, sizeof(payload), true);
+   receiveAndVerify(2, sizeof(payload), true);
+
+   // the block that is being built has no parity yet
+   CPPUNIT_ASSERT_EQUAL(size_t(1), nakFromBoth({ 4, 5 }));
+   receiveAndVerify(4, sizeof(payload), true);
+   CPPUNIT_ASSERT_EQUAL(size_t(0), udpReceiver->receiveFrom(buffer, sizeof(buffer), &source));
+}
+
+void testCRmdgpSender::testCoalescing()
+{
+   CRmdgpSender sender(udpSender, sessionId, streamId, 16, 100000, 100, 0);
+   const CNanoTime start = CNanoTime::fromSec(100);
+   const CNanoTime deadline = CNanoTime::fromMsec(5);
+   uint8_t message[100];
+   uint8_t buffer[2048];
+   sockaddr_in source;
+
+   for(size_t i = 0; i < sizeof(message); i++)
+      message[i] = uint8_t(i);
+   CPPUNIT_ASSERT_THROW(sender.sendMessage(message, 10, start), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(sender.setCoalescing(-deadline), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(sender.setCoalescing(deadline, 101), std::runtime_error);
+   sender.setCoalescing(deadline);
+   CPPUNIT_ASSERT(sender.flush());
+
+   // three messages of 30 bytes wait, the fourth doesn't fit and sends them
+   for(int i = 0; i < 3; i++)
+      CPPUNIT_ASSERT(sender.sendMessage(message, 30, start + CNanoTime::fromMsec(i)));
+   CPPUNIT_ASSERT(sender.hasPendingMessages());
+   CPPUNIT_ASSERT_EQUAL(start + deadline, sender.getFlushTime());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), sender.getNextSequence());
+   CPPUNIT_ASSERT(sender.sendMessage(message + 1, 30, start + CNanoTime::fromMsec(3)));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), sender.getNextSequence());
+   CPPUNIT_ASSERT_EQUAL(start + CNanoTime::fromMsec(8), sender.getFlushTime());
+
+   const timespec waitTime = { 0, 1000000 };
+   nanosleep(&waitTime, NULL); // give upd/ip stack some time
+   size_t length = udpReceiver->receiveFrom(buffer, sizeof(buffer), &source);
+   CPPUNIT_ASSERT_EQUAL(CRmdgpHeader::size + 3 * 31, length);
+   CMessageBatchReader reader(buffer + CRmdgpHeader::size, length - CRmdgpHeader::size);
+   const uint8_t *received;
+   size_t receivedLength;
+   for(int i = 0; i < 3; i++)
+   {
+      CPPUNIT_ASSERT(reader.next(received, receivedLength));
+      CPPUNIT_ASSERT_EQUAL(size_t(30), receivedLength);
+      CPPUNIT_ASSERT_EQUAL(uint8_t(29), received[29]);
+   }
+   CPPUNIT_ASSERT(!reader.next(received, receivedLength));
+
+   // the timer sends the fourth when its deadline passed
+   sender.handleTimer(start + CNanoTime::fromMsec(7));
+   CPPUNIT_ASSERT(sender.hasPendingMessages());
+   sender.handleTimer(start + CNanoTime::fromMsec(8));
+   CPPUNIT_ASSERT(!sender.hasPendingMessages());
+   nanosleep(&waitTime, NULL);
+   length = udpReceiver->receiveFrom(buffer, sizeof(buffer), &source);
+   CPPUNIT_ASSERT_EQUAL(CRmdgpHeader::size + 31, length);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), CRmdgpHeaderView(buffer).getSequence());
+   CPPUNIT_ASSERT_EQUAL(uint8_t(1), buffer[CRmdgpHeader::size + 1]);
+
+   // too large for a batch, and a message that fills it goes out at once
+   CPPUNIT_ASSERT(!sender.sendMessage(message, 100, start + CNanoTime::fromMsec(10)));
+   CPPUNIT_ASSERT(sender.sendMessage(message, 98, start + CNanoTime::fromMsec(10)));
+   CPPUNIT_ASSERT(!sender.hasPendingMessages());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(3), sender.getNextSequence());
+
+   // a message and an explicit flush
+   CPPUNIT_ASSERT(sender.sendMessage(message, 5, start + CNanoTime::fromMsec(11)));
+   CPPUNIT_ASSERT(sender.flush());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), sender.getNextSequence());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(6), sender.getMessageCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), sender.getBatchCount());
+
+   // without deadline every message goes out at once
+   sender.setCoalescing(CNanoTime());
+   CPPUNIT_ASSERT(sender.sendMessage(message, 5, start + CNanoTime::fromMsec(12)));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(5), sender.getNextSequence());
+}
+
+void testCRmdgpSender::testFragmented()
+{
+   CRmdgpSender sender(udpSender, sessionId, streamId, 4, 100000, 100, 10);
+   CFragmentAssembler assembler(1000, 1000);
+   CFragmentAssembler::SMessage result;
+   std::vector<uint8_t> message(200);
+   uint8_t buffer[2048];
+   sockaddr_in source;
+
+   for(size_t i = 0; i < message.size(); i++)
+      message[i] = uint8_t(i * 3);
+   // 84 bytes per fragment, so three fragments
+   CPPUNIT_ASSERT(sender.sendFragmented(message.data(), message.size()));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(13), sender.getNextSequence());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), sender.getFragmentedCount());
+
+   const timespec waitTime = { 0, 1000000 };
+   nanosleep(&waitTime, NULL); // give upd/ip stack some time
+   for(uint64_t sequence = 10; sequence < 13; sequence++)
+   {
+      const size_t length = udpReceiver->receiveFrom(buffer, sizeof(buffer), &source);
+      CPPUNIT_ASSERT(ERmdgpValidation::valid == CRmdgpHeaderView::validate(buffer, length));
+      const CRmdgpHeaderView header(buffer);
+      CPPUNIT_ASSERT_EQUAL(sequence, header.getSequence());
+      CPPUNIT_ASSERT_EQUAL(uint32_t(sequence - 10), CFragmentHeader::getIndex(header.getPayload()));
+      CPPUNIT_ASSERT_EQUAL(size_t(sequence < 12 ? 100 : 16 + 200 - 168),
+                           size_t(header.getPayloadLength()));
+      assembler.add(sequence, header.getPayload(), header.getPayloadLength());
+   }
+   CPPUNIT_ASSERT(assembler.next(result));
+   CPPUNIT_ASSERT(message == std::vector<uint8_t>(result.data.get(),
+                                                  result.data.get() + result.length));
+
+   // two fragments don't fit in the one free slot, nothing is sent
+   CPPUNIT_ASSERT(!sender.sendFragmented(message.data(), 100));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(13), sender.getNextSequence());
+   CPPUNIT_ASSERT(sender.sendFragmented(message.data(), 84));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(14), sender.getNextSequence());
+}
+
+void testCRmdgpSender::testCongestionController()
+{
+   CRmdgpSender sender(udpSender, sessionId, streamId, 16, 100000, 100, 0);
+   std::shared_ptr<CFeedbackRecorder> recorder(new CFeedbackRecorder);
+   const CNanoTime start = CNanoTime::fromSec(100);
+   uint8_t payload[10] = { 0 };
+   uint8_t datagram[CRmdgpSender::maxFeedbackLength];
+
+   CPPUNIT_ASSERT(isinf(sender.getAllowedRate(start)));
+   sender.setCongestionController(recorder);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(5000.0, sender.getAllowedRate(start), 0.001);
+
+   // datagrams 0 to 2 are sent at start, 3 and 4 five milliseconds later
+   sender.handleTimer(start);
+   for(int i = 0; i < 3; i++)
+      CPPUNIT_ASSERT(sender.send(payload, sizeof(payload)));
+   sender.handleTimer(start + CNanoTime::fromMsec(5));
+   for(int i = 0; i < 2; i++)
+      CPPUNIT_ASSERT(sender.send(payload, sizeof(payload)));
+
+   // the ACK of 0 to 3 is a sample of the probe of 3, minus the 2 milliseconds that the
+   // receiver held it
+   CAckBuilder first(datagram, sizeof(datagram), sessionId, streamId, 9, 4,
+                     CNanoTime::fromMsec(2));
+   first.setLossRate(0.25);
+   CPPUNIT_ASSERT(sender.processAck(datagram, first.getLength(), start + CNanoTime::fromMsec(12)));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), recorder->receiverIds.size());
+   CPPUNIT_ASSERT_EQUAL(uint32_t(9), recorder->receiverIds[0]);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25, recorder->lossRates[0], 0.0001);
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromMsec(5), recorder->rtts[0]);
+
+   // nothing new received, no sample
+   CAckBuilder second(datagram, sizeof(datagram), sessionId, streamId, 9, 4);
+   second.setLossRate(0.25);
+   CPPUNIT_ASSERT(sender.processAck(datagram, second.getLength(), start + CNanoTime::fromMsec(20)));
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(), recorder->rtts[1]);
+
+   // a hold time longer than the sample leaves no sample
+   CAckBuilder held(datagram, sizeof(datagram), sessionId, streamId, 9, 5, CNanoTime::fromMsec(30));
+   held.setLossRate(0.25);
+   CPPUNIT_ASSERT(sender.processAck(datagram, held.getLength(), start + CNanoTime::fromMsec(21)));
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(), recorder->rtts[2]);
+
+   // without a loss report the controller isn't told
+   CAckBuilder third(datagram, sizeof(datagram), sessionId, streamId, 9, 5);
+   CPPUNIT_ASSERT(sender.processAck(datagram, third.getLength(), start + CNanoTime::fromMsec(22)));
+   CPPUNIT_ASSERT_EQUAL(size_t(3), recorder->receiverIds.size());
+
+   // an ejected receiver is removed from the controller
+   CPPUNIT_ASSERT(sender.send(payload, sizeof(payload)));
+   sender.setMinimumRate(1000.0, CNanoTime::fromMsec(100), CNanoTime());
+   sender.checkReceivers(start + CNanoTime::fromMsec(100));
+   sender.checkReceivers(start + CNanoTime::fromMsec(200));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), recorder->removedIds.size());
+   CPPUNIT_ASSERT_EQUAL(uint32_t(9), recorder->removedIds[0]);
+}
+
+void testCRmdgpSender::testPacing()
+{
+   CRmdgpSender sender(udpSender, sessionId, streamId, 16, 100000);
+   std::shared_ptr<CFeedbackRecorder> recorder(new CFeedbackRecorder);
+   const CNanoTime start = CNanoTime::fromSec(100);
+   const size_t payloadLength = 1000 - CRmdgpHeader::size;
+   uint8_t payload[payloadLength] = { 0 };
+   uint8_t buffer[2048];
+   sockaddr_in source;
+   uint64_t nextSequence = 0;
+   // the payload that receiveAndVerify expects
+   auto sendNext = [&]()
+   {
+      for(size_t i = 0; i < payloadLength; i++)
+         payload[i] = uint8_t(nextSequence + i);
+      const bool sent = sender.send(payload, payloadLength);
+      nextSequence += sent ? 1 : 0;
+      return sent;
+   };
+
+   CPPUNIT_ASSERT(sender.getPacer() == nullptr);
+   CPPUNIT_ASSERT_THROW(sender.setPacing(1e6, 1000, 4), std::runtime_error);
+   sender.setPacing(1e6, 3000, 4);
+
+   // queued until the timer releases them, a full pacer refuses more
+   for(int i = 0; i < 4; i++)
+      CPPUNIT_ASSERT(sendNext());
+   CPPUNIT_ASSERT(!sendNext());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), udpReceiver->receiveFrom(buffer, sizeof(buffer), &source));
+
+   // a micro burst of 3000 bytes, the last datagram 1ms later
+   sender.handleTimer(start);
+   for(uint64_t sequence = 0; sequence < 3; sequence++)
+      receiveAndVerify(sequence, payloadLength, false);
+   CPPUNIT_ASSERT_EQUAL(size_t(0), udpReceiver->receiveFrom(buffer, sizeof(buffer), &source));
+   CPPUNIT_ASSERT_EQUAL(start + CNanoTime::fromMsec(1), sender.getPacer()->getNextSendTime());
+   sender.handleTimer(start + CNanoTime::fromMsec(1));
+   receiveAndVerify(3, payloadLength, false);
+   CPPUNIT_ASSERT(sender.getPacer()->isEmpty());
+
+   // the congestion controller sets the rate
+   sender.setCongestionController(recorder);
+   sender.handleTimer(start + CNanoTime::fromMsec(2));
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(5000.0, sender.getPacer()->getRate(), 0.001);
+
+   // a new pacer sends the waiting datagrams first, both waited 1ms since the last now
+   std::shared_ptr<CLatencyRecorder> latency(new CLatencyRecorder);
+   sender.setPacerLatencyRecorder(latency);
+   CPPUNIT_ASSERT(sendNext());
+   CPPUNIT_ASSERT(sendNext());
+   sender.handleTimer(start + CNanoTime::fromMsec(3));
+   receiveAndVerify(4, payloadLength, false);
+   sender.setPacing(1e6, 3000);
+   receiveAndVerify(5, payloadLength, false);
+   CPPUNIT_ASSERT(sender.getPacer()->isEmpty());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(2), latency->snapshot().getTotalCount());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromMsec(1), latency->snapshot().getMax());
+
+   // the new pacer records as well
+   CPPUNIT_ASSERT(sendNext());
+   sender.handleTimer(start + CNanoTime::fromMsec(5));
+   receiveAndVerify(6, payloadLength, false);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(3), latency->snapshot().getTotalCount());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromMsec(2), latency->snapshot().getMax());
+}
+
+void testCRmdgpSender::testCatchUp()
+{
+   CRmdgpSender sender(udpSender, sessionId, streamId, 8, 100000);
+   const CSocketAddress joinerAddress(localAddress, receiverPort);
+   const CNanoTime start = CNanoTime::fromSec(100);
+   const timespec waitTime = { 0, 1000000 };
+   uint8_t payload[10];
+   uint8_t join[CJoinBuilder::maxLength];
+   uint8_t buffer[2048];
+   sockaddr_in source;
+   auto sendData = [&](uint64_t sequence)
+   {
+      for(size_t i = 0; i < sizeof(payload); i++)
+         payload[i] = uint8_t(sequence + i);
+      CPPUNIT_ASSERT(sender.send(payload, sizeof(payload)));
+      receiveAndVerify(sequence, sizeof(payload), false);
+   };
+   auto processJoin = [&](uint32_t receiverId, const SSequenceRange &range)
+   {
+      CJoinBuilder builder(join, ERmdgpPacketType::join, sessionId, streamId, receiverId, range);
+      return sender.processJoin(join, builder.getLength(), joinerAddress, start);
+   };
+   auto receiveAccept = [&]()
+   {
+      nanosleep(&waitTime, NULL); // give upd/ip stack some time
+      const size_t length = udpReceiver->receiveFrom(buffer, sizeof(buffer), &source);
+      CPPUNIT_ASSERT(ERmdgpValidation::valid == CRmdgpHeaderView::validate(buffer, length));
+      CPPUNIT_ASSERT(ERmdgpPacketType::joinAccept == CRmdgpHeaderView(buffer).getType());
+      CJoinReader accept(buffer, length);
+      CPPUNIT_ASSERT(!accept.isMalformed());
+      return accept.getRange();
+   };
+   auto receiveReplay = [&](uint64_t sequence)
+   {
+      nanosleep(&waitTime, NULL); // give upd/ip stack some time
+      const size_t length = udpReceiver->receiveFrom(buffer, sizeof(buffer), &source);
+      CPPUNIT_ASSERT(ERmdgpValidation::valid == CRmdgpHeaderView::validate(buffer, length));
+      const CRmdgpHeaderView header(buffer);
+      CPPUNIT_ASSERT(ERmdgpPacketType::data == header.getType());
+      CPPUNIT_ASSERT(header.hasFlag(rmdgpFlagCatchUp));
+      CPPUNIT_ASSERT_EQUAL(sequence, header.getSequence());
+      CPPUNIT_ASSERT_EQUAL(uint8_t(sequence), header.getPayload()[0]);
+   };
+
+   for(uint64_t sequence = 0; sequence < 6; sequence++)
+      sendData(sequence);
+   CPPUNIT_ASSERT_EQUAL(size_t(6), sender.acknowledge(6));
+
+   // not enabled
+   CPPUNIT_ASSERT(!processJoin(1, { 2, 6 }));
+   CPPUNIT_ASSERT_THROW(sender.setCatchUp(0, 3000), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(sender.setCatchUp(1e6, 100), std::runtime_error);
+   sender.setCatchUp(1e6, 3000, 1);
+
+   // nobody can have missed what isn't sent yet
+   CPPUNIT_ASSERT(!processJoin(1, { 2, 7 }));
+
+   // the released datagrams are still in the history, they are replayed to the joiner alone
+   CPPUNIT_ASSERT(processJoin(1, { 2, 6 }));
+   CPPUNIT_ASSERT(SSequenceRange({ 2, 6 }) == receiveAccept());
+   CPPUNIT_ASSERT_EQUAL(size_t(1), sender.getJoinerCount());
+   // one joiner at a time
+   CPPUNIT_ASSERT(!processJoin(2, { 0, 6 }));
+   CPPUNIT_ASSERT(!sender.handleTimer(start));
+   for(uint64_t sequence = 2; sequence < 6; sequence++)
+      receiveReplay(sequence);
+   CPPUNIT_ASSERT_EQUAL(size_t(0), udpReceiver->receiveFrom(buffer, sizeof(buffer), &source));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), sender.getJoinerCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), sender.getReplayedCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), sender.getJoinCount());
+   // the multicast datagrams are not changed
+   size_t length;
+   CPPUNIT_ASSERT(!CRmdgpHeaderView(sender.getRetransmissionRing().lookupHistory(3, length))
+                  .hasFlag(rmdgpFlagCatchUp));
+
+   // the 8 slots are reused, the history starts at 4 now
+   for(uint64_t sequence = 6; sequence < 12; sequence++)
+      sendData(sequence);
+   CPPUNIT_ASSERT(processJoin(2, { 0, 12 }));
+   CPPUNIT_ASSERT(SSequenceRange({ 4, 12 }) == receiveAccept());
+
+   // a join of a joiner that is served restarts its replay
+   CPPUNIT_ASSERT(processJoin(2, { 10, 12 }));
+   CPPUNIT_ASSERT(SSequenceRange({ 10, 12 }) == receiveAccept());
+   CPPUNIT_ASSERT(sender.getNextCatchUpTime() <= start);
+   sender.handleTimer(start + CNanoTime::fromMsec(1));
+   receiveReplay(10);
+   receiveReplay(11);
+   CPPUNIT_ASSERT_EQUAL(size_t(0), sender.getJoinerCount());
+
+   // nothing left in the history: the accept is empty, there is no replay
+   sender.acknowledge(12);
+   for(uint64_t sequence = 12; sequence < 20; sequence++)
+      sendData(sequence);
+   CPPUNIT_ASSERT(processJoin(3, { 2, 11 }));
+   CPPUNIT_ASSERT(SSequenceRange({ 11, 11 }) == receiveAccept());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), sender.getJoinerCount());
+}
+
+void testCRmdgpSender::testJournal()
+{
+   char directory[] = "/tmp/testCRmdgpSender-XXXXXX";
+   const CSocketAddress requester(localAddress, receiverPort);
+   const CNanoTime start = CNanoTime::fromSec(100);
+   uint8_t payload[10];
+   uint8_t nak[100];
+   CPPUNIT_ASSERT(mkdtemp(directory) != nullptr);
+   {
+      std::shared_ptr<CSenderJournal> journal(new CSenderJournal(directory, 64 * 1024));
+      CRmdgpSender sender(udpSender, sessionId, streamId, 4, 100000);
+      sender.setJournal(journal);
+      CPPUNIT_ASSERT(sender.getJournal() == journal);
+
+      for(uint64_t sequence = 0; sequence < 10; sequence++)
+      {
+         for(size_t i = 0; i < sizeof(payload); i++)
+            payload[i] = uint8_t(sequence + i);
+         CPPUNIT_ASSERT(sender.send(payload, sizeof(payload)));
+         receiveAndVerify(sequence, sizeof(payload), false);
+         sender.acknowledge(sequence);
+      }
+      CPPUNIT_ASSERT_EQUAL(uint64_t(9), sender.getRetransmissionRing().getOldestSequence());
+      CPPUNIT_ASSERT_EQUAL(uint64_t(10), journal->getCount());
+
+      // what left the ring comes from the journal
+      CPPUNIT_ASSERT(sender.resend(2));
+      receiveAndVerify(2, sizeof(payload), true);
+      CPPUNIT_ASSERT_EQUAL(uint64_t(1), sender.getJournalRepairCount());
+
+      // but not in bulk for a NAK, it is replayed paced to the requester alone. That needs
+      // the catch-up.
+      CNakBuilder builder(nak, sizeof(nak), sessionId, streamId, 1);
+      builder.add({ 0, 2 });
+      builder.add({ 5, 7 });
+      CPPUNIT_ASSERT_EQUAL(size_t(0), sender.processNak(nak, builder.getLength()));
+      CPPUNIT_ASSERT_EQUAL(size_t(0), sender.processNak(nak, builder.getLength(), requester,
+                                                        start));
+      CPPUNIT_ASSERT_EQUAL(uint64_t(0), sender.getJournalReplayCount());
+      sender.setCatchUp(1e6, 3000, 1);
+      CPPUNIT_ASSERT_EQUAL(size_t(0), sender.processNak(nak, builder.getLength(), requester,
+                                                        start));
+      CPPUNIT_ASSERT_EQUAL(uint64_t(1), sender.getJournalReplayCount());
+      CPPUNIT_ASSERT_EQUAL(size_t(1), sender.getJoinerCount());
+      // the first range, the receiver asks again for the rest
+      CPPUNIT_ASSERT(!sender.handleTimer(start));
+      receiveAndVerify(0, sizeof(payload), true);
+      receiveAndVerify(1, sizeof(payload), true);
+      CPPUNIT_ASSERT_EQUAL(size_t(0), sender.getJoinerCount());
+      CPPUNIT_ASSERT_EQUAL(uint64_t(1), sender.getJournalRepairCount());
+
+      // a unicast repair of a datagram that left the ring after the request
+      sender.setRepairPolicy(1, CNanoTime());
+      CNakBuilder last(nak, sizeof(nak), sessionId, streamId, 1);
+      last.add({ 9, 10 });
+      CPPUNIT_ASSERT_EQUAL(size_t(1), sender.processNak(nak, last.getLength(), requester,
+                                                        start));
+      sender.acknowledge(10);
+      CPPUNIT_ASSERT_EQUAL(size_t(1), sender.sendRepairs(start));
+      receiveAndVerify(9, sizeof(payload), true);
+      CPPUNIT_ASSERT_EQUAL(uint64_t(2), sender.getJournalRepairCount());
+      CPPUNIT_ASSERT(!sender.handleTimer(start));
+
+      // a sender that doesn't continue the journal
+      CRmdgpSender other(udpSender, sessionId, streamId, 4, 100000, 1000, 5);
+      CPPUNIT_ASSERT_THROW(other.setJournal(journal), std::runtime_error);
+   }
+
+   // after a restart the stream continues where the journal ends, with its history
+   std::shared_ptr<CSenderJournal> journal(new CSenderJournal(directory, 64 * 1024));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(10), journal->getRecoveredCount());
+   CRmdgpSender sender(udpSender, sessionId, streamId, 4, 100000,
+                       CRmdgpSender::defaultMaxPayloadSize, journal->getNextSequence());
+   sender.setJournal(journal);
+   for(size_t i = 0; i < sizeof(payload); i++)
+      payload[i] = uint8_t(10 + i);
+   CPPUNIT_ASSERT(sender.send(payload, sizeof(payload)));
+   receiveAndVerify(10, sizeof(payload), false);
+   CPPUNIT_ASSERT(sender.resend(3));
+   receiveAndVerify(3, sizeof(payload), true);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(11), journal->getNextSequence());
+
+   for(const std::string &name : CMappedFile::list(directory, ""))
+      unlink((std::string(directory) + "/" + name).c_str());
+   rmdir(directory);
+}
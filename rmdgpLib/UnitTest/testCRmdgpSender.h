@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCRmdgpSender.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 17, 2021, 7:40 PM
+ */
+
+#ifndef TESTCRMDGPSENDER_H
+#define TESTCRMDGPSENDER_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+class CUdpMulticastSender;
+class CUdpSocket;
+
+class testCRmdgpSender : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCRmdgpSender);
+
+    CPPUNIT_TEST(testSend);
+    CPPUNIT_TEST(testResend);
+    CPPUNIT_TEST(testWindowFull);
+    CPPUNIT_TEST(testConstructorException);
+    CPPUNIT_TEST(testProcessNak);
+    CPPUNIT_TEST(testRepairLimits);
+    CPPUNIT_TEST(testHandleFeedback);
+    CPPUNIT_TEST(testProcessAck);
+    CPPUNIT_TEST(testEjectReceiver);
+    CPPUNIT_TEST(testHeartbeat);
+    CPPUNIT_TEST(testRepairPolicy);
+    CPPUNIT_TEST(testFec);
+    CPPUNIT_TEST(testFecRepair);
+    CPPUNIT_TEST(testCoalescing);
+    CPPUNIT_TEST(testFragmented);
+    CPPUNIT_TEST(testCongestionController);
+    CPPUNIT_TEST(testPacing);
+    CPPUNIT_TEST(testCatchUp);
+    CPPUNIT_TEST(testJournal);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCRmdgpSender();
+    virtual ~testCRmdgpSender();
+    void setUp();
+    void tearDown();
+
+private:
+    void testSend();
+    void testResend();
+    void testWindowFull();
+    void testConstructorException();
+    void testProcessNak();
+    void testRepairLimits();
+    void testHandleFeedback();
+    void testProcessAck();
+    void testEjectReceiver();
+    void testHeartbeat();
+    void testRepairPolicy();
+    void testFec();
+    void testFecRepair();
+    void testCoalescing();
+    void testFragmented();
+    void testCongestionController();
+    void testPacing();
+    void testCatchUp();
+    void testJournal();
+
+    /// \brief receives one datagram and checks its header
+    void receiveAndVerify(uint64_t expectedSequence, size_t expectedPayloadLength,
+                    bool expectRetransmission);
+
+    std::shared_ptr<CUdpMulticastSender> udpSender;
+    std::unique_ptr<CUdpSocket> udpReceiver;
+};
+
+#endif /* TESTCRMDGPSENDER_H */
@@ -0,0 +1,261 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCSenderJournal.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 6, 2021, 11:40 AM
+ */
+
+#include "testCSenderJournal.h"
+#include "../CSenderJournal.h"
+#include "../../socketLib/CMappedFile.h"
+#include <stdexcept>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+   const size_t segmentSize = 64 * 1024;
+
+   /// \brief a datagram of length bytes that tells its sequence number
+   std::vector<uint8_t> makeDatagram(uint64_t sequence, size_t length)
+   {
+      std::vector<uint8_t> datagram(length);
+      for(size_t i = 0; i < length; i++)
+         datagram[i] = uint8_t(sequence * 7 + i);
+      return datagram;
+   }
+
+   void appendAndVerify(CSenderJournal &journal, uint64_t sequence, size_t length)
+   {
+      const std::vector<uint8_t> datagram = makeDatagram(sequence, length);
+      CPPUNIT_ASSERT(journal.append(sequence, datagram.data(), datagram.size()));
+   }
+
+   void lookupAndVerify(const CSenderJournal &journal, uint64_t sequence, size_t expectedLength)
+   {
+      size_t length = 0;
+      const uint8_t *datagram = journal.lookup(sequence, length);
+      CPPUNIT_ASSERT(datagram != nullptr);
+      CPPUNIT_ASSERT_EQUAL(expectedLength, length);
+      CPPUNIT_ASSERT(makeDatagram(sequence, length) ==
+                     std::vector<uint8_t>(datagram, datagram + length));
+   }
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCSenderJournal);
+
+testCSenderJournal::testCSenderJournal()
+{
+}
+
+testCSenderJournal::~testCSenderJournal()
+{
+}
+
+void testCSenderJournal::setUp()
+{
+   char name[] = "/tmp/testCSenderJournal-XXXXXX";
+
+   CPPUNIT_ASSERT(mkdtemp(name) != nullptr);
+   directory = name;
+}
+
+void testCSenderJournal::tearDown()
+{
+   for(const std::string &name : CMappedFile::list(directory, ""))
+      unlink((directory + "/" + name).c_str());
+   rmdir(directory.c_str());
+}
+
+void testCSenderJournal::testAppendAndLookup()
+{
+   CSenderJournal journal(directory, segmentSize);
+   size_t length;
+
+   CPPUNIT_ASSERT(journal.isEmpty());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), journal.getSegmentCount());
+   CPPUNIT_ASSERT(journal.lookup(0, length) == nullptr);
+
+   // the first sequence number can be anything, the next ones follow
+   for(uint64_t sequence = 1000; sequence < 1100; sequence++)
+      appendAndVerify(journal, sequence, sequence % 50);
+   const std::vector<uint8_t> datagram = makeDatagram(0, 10);
+   CPPUNIT_ASSERT(!journal.append(1099, datagram.data(), datagram.size()));
+   CPPUNIT_ASSERT(!journal.append(1101, datagram.data(), datagram.size()));
+
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1000), journal.getOldestSequence());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1100), journal.getNextSequence());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(100), journal.getCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(1), journal.getSegmentCount());
+   for(uint64_t sequence = 1000; sequence < 1100; sequence++)
+      lookupAndVerify(journal, sequence, sequence % 50);
+   CPPUNIT_ASSERT(journal.lookup(999, length) == nullptr);
+   CPPUNIT_ASSERT(journal.lookup(1100, length) == nullptr);
+   CPPUNIT_ASSERT(!journal.contains(1100));
+
+   // a datagram larger than a segment doesn't fit
+   const std::vector<uint8_t> large = makeDatagram(0, journal.getMaxLength() + 1);
+   CPPUNIT_ASSERT(!journal.append(1100, large.data(), large.size()));
+   journal.flush(true);
+}
+
+void testCSenderJournal::testRollover()
+{
+   CSenderJournal journal(directory, segmentSize, 3);
+   const size_t datagramLength = 1000;
+   uint64_t sequence = UINT64_MAX - 100;
+
+   // flush makes the next segment when the current one is half full
+   while(journal.getCount() < 40)
+   {
+      appendAndVerify(journal, sequence++, datagramLength);
+      journal.flush();
+   }
+   CPPUNIT_ASSERT_EQUAL(size_t(1), journal.getSegmentCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(2), CMappedFile::list(directory, CSenderJournal::filePrefix).size());
+
+   // the sequence numbers wrap around in the second segment
+   while(journal.getSegmentCount() < 2)
+      appendAndVerify(journal, sequence++, datagramLength);
+   const uint64_t perSegment = journal.getCount() - 1;
+   // a record is 16 + 1000 bytes and an index entry of 4 bytes
+   CPPUNIT_ASSERT_EQUAL(uint64_t((segmentSize - 64) / 1020), perSegment);
+   CPPUNIT_ASSERT_EQUAL(size_t(2), CMappedFile::list(directory, CSenderJournal::filePrefix).size());
+   for(uint64_t i = 0; i < journal.getCount(); i++)
+      lookupAndVerify(journal, journal.getOldestSequence() + i, datagramLength);
+
+   // flush removes the oldest segments
+   while(journal.getSegmentCount() < 4)
+      appendAndVerify(journal, sequence++, datagramLength);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(UINT64_MAX - 100), journal.getOldestSequence());
+   journal.flush();
+   CPPUNIT_ASSERT_EQUAL(size_t(3), journal.getSegmentCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(UINT64_MAX - 100 + perSegment), journal.getOldestSequence());
+   CPPUNIT_ASSERT_EQUAL(sequence, journal.getNextSequence());
+   CPPUNIT_ASSERT(!journal.contains(UINT64_MAX - 100));
+   for(uint64_t i = 0; i < journal.getCount(); i++)
+      lookupAndVerify(journal, journal.getOldestSequence() + i, datagramLength);
+}
+
+void testCSenderJournal::testRecovery()
+{
+   uint64_t sequence = 500;
+   {
+      CSenderJournal journal(directory, segmentSize);
+      while(journal.getSegmentCount() < 2 || journal.getCount() % 7 != 0)
+      {
+         appendAndVerify(journal, sequence, sequence % 1200);
+         sequence++;
+         journal.flush();
+      }
+   }
+
+   CSenderJournal journal(directory, segmentSize);
+   CPPUNIT_ASSERT_EQUAL(size_t(2), journal.getSegmentCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(500), journal.getOldestSequence());
+   CPPUNIT_ASSERT_EQUAL(sequence, journal.getNextSequence());
+   CPPUNIT_ASSERT_EQUAL(sequence - 500, journal.getRecoveredCount());
+   for(uint64_t i = 500; i < sequence; i++)
+      lookupAndVerify(journal, i, i % 1200);
+
+   // it continues where it ended, in the same segment
+   CPPUNIT_ASSERT(!journal.append(sequence + 1, makeDatagram(0, 10).data(), 10));
+   appendAndVerify(journal, sequence, 10);
+   CPPUNIT_ASSERT_EQUAL(size_t(2), journal.getSegmentCount());
+   lookupAndVerify(journal, sequence, 10);
+}
+
+void testCSenderJournal::testTornRecord()
+{
+   {
+      CSenderJournal journal(directory, segmentSize);
+      for(uint64_t sequence = 0; sequence < 10; sequence++)
+         appendAndVerify(journal, sequence, 100);
+      journal.flush(true);
+   }
+
+   // the last record lost its page, its index entry survived
+   {
+      const std::vector<std::string> names = CMappedFile::list(directory,
+                                                               CSenderJournal::filePrefix);
+      CPPUNIT_ASSERT_EQUAL(size_t(1), names.size());
+      CMappedFile file(directory + "/" + names[0], 0);
+      const uint32_t *index = reinterpret_cast<const uint32_t*>(file.getData() + file.getSize());
+      memset(file.getData() + index[-10], 0, 100);
+   }
+
+   CSenderJournal journal(directory, segmentSize);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), journal.getOldestSequence());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(9), journal.getNextSequence());
+   for(uint64_t sequence = 0; sequence < 9; sequence++)
+      lookupAndVerify(journal, sequence, 100);
+   // the new record overwrites the torn one
+   appendAndVerify(journal, 9, 200);
+   lookupAndVerify(journal, 9, 200);
+}
+
+void testCSenderJournal::testDamagedMiddleRecord()
+{
+   {
+      CSenderJournal journal(directory, segmentSize);
+      for(uint64_t sequence = 0; sequence < 10; sequence++)
+         appendAndVerify(journal, sequence, 100);
+      journal.flush(true);
+   }
+
+   // a page in the middle was lost, the records on both sides of it survived
+   {
+      const std::vector<std::string> names = CMappedFile::list(directory,
+                                                               CSenderJournal::filePrefix);
+      CPPUNIT_ASSERT_EQUAL(size_t(1), names.size());
+      CMappedFile file(directory + "/" + names[0], 0);
+      const uint32_t *index = reinterpret_cast<const uint32_t*>(file.getData() + file.getSize());
+      memset(file.getData() + index[-4], 0, 100);
+   }
+
+   // the journal ends before the damaged record, the ones after it are of no use
+   CSenderJournal journal(directory, segmentSize);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), journal.getOldestSequence());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(3), journal.getNextSequence());
+   for(uint64_t sequence = 0; sequence < 3; sequence++)
+      lookupAndVerify(journal, sequence, 100);
+   size_t length;
+   CPPUNIT_ASSERT(journal.lookup(5, length) == nullptr);
+   appendAndVerify(journal, 3, 200);
+   lookupAndVerify(journal, 3, 200);
+}
+
+void testCSenderJournal::testException()
+{
+   CPPUNIT_ASSERT_THROW(CSenderJournal(directory, 1000), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CSenderJournal(directory, segmentSize, 0), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CSenderJournal("/proc/self/missing/journal"), std::runtime_error);
+
+   // a file with the name of a segment that is no segment
+   {
+      CMappedFile file(directory + "/" + CSenderJournal::filePrefix + "0000000000000001",
+                       segmentSize);
+      memcpy(file.getData(), "garbage", 7);
+   }
+   CPPUNIT_ASSERT_THROW(CSenderJournal(directory, segmentSize), std::runtime_error);
+}
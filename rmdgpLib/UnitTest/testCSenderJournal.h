@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCSenderJournal.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 6, 2021, 11:40 AM
+ */
+
+#ifndef TESTCSENDERJOURNAL_H
+#define TESTCSENDERJOURNAL_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+class testCSenderJournal : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCSenderJournal);
+
+    CPPUNIT_TEST(testAppendAndLookup);
+    CPPUNIT_TEST(testRollover);
+    CPPUNIT_TEST(testRecovery);
+    CPPUNIT_TEST(testTornRecord);
+    CPPUNIT_TEST(testDamagedMiddleRecord);
+    CPPUNIT_TEST(testException);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCSenderJournal();
+    virtual ~testCSenderJournal();
+    void setUp();
+    void tearDown();
+
+private:
+    void testAppendAndLookup();
+    void testRollover();
+    void testRecovery();
+    void testTornRecord();
+    void testDamagedMiddleRecord();
+    void testException();
+
+    /// \brief a new directory for every test
+    std::string directory;
+};
+
+#endif /* TESTCSENDERJOURNAL_H */
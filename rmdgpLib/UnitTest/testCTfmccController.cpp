@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCTfmccController.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 5, 2021, 10:30 AM
+ */
+
+#include "testCTfmccController.h"
+#include "../CTfmccController.h"
+#include <math.h>
+#include <stdexcept>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCTfmccController);
+
+testCTfmccController::testCTfmccController()
+{
+}
+
+testCTfmccController::~testCTfmccController()
+{
+}
+
+void testCTfmccController::setUp()
+{
+}
+
+void testCTfmccController::tearDown()
+{
+}
+
+void testCTfmccController::testTcpRate()
+{
+   // RFC 5348 with b = 1 and t_RTO = 4 * R
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(112332.2, CTfmccController::getTcpRate(1000,
+                                CNanoTime::fromMsec(100), 0.01), 0.1);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(73249.0, CTfmccController::getTcpRate(1000,
+                                CNanoTime::fromMsec(100), 0.02), 0.1);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(1123322.3, CTfmccController::getTcpRate(1000,
+                                CNanoTime::fromMsec(10), 0.01), 0.1);
+   CPPUNIT_ASSERT(isinf(CTfmccController::getTcpRate(1000, CNanoTime::fromMsec(10), 0)));
+}
+
+void testCTfmccController::testSlowStart()
+{
+   CTfmccController controller(1000, 10000, 1e7);
+   const CNanoTime start = CNanoTime::fromSec(100);
+
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(10000.0, controller.getRate(start), 0.001);
+   controller.onFeedback(1, 0, CNanoTime::fromMsec(100), start);
+   CPPUNIT_ASSERT(controller.isSlowStart());
+   CPPUNIT_ASSERT(!controller.hasLimitingReceiver());
+
+   // doubles every round trip time, up to the maximum
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(20000.0, controller.getRate(start + CNanoTime::fromMsec(100)),
+                                0.001);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(80000.0, controller.getRate(start + CNanoTime::fromMsec(300)),
+                                0.001);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(1e7, controller.getRate(start + CNanoTime::fromSec(2)), 0.001);
+}
+
+void testCTfmccController::testLimitingReceiver()
+{
+   CTfmccController controller(1000, 1000, 1e9);
+   const CNanoTime now = CNanoTime::fromSec(100);
+
+   controller.onFeedback(1, 0.01, CNanoTime::fromMsec(100), now);
+   CPPUNIT_ASSERT(!controller.isSlowStart());
+   CPPUNIT_ASSERT(controller.hasLimitingReceiver());
+   CPPUNIT_ASSERT_EQUAL(uint32_t(1), controller.getLimitingReceiver());
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(112332.2, controller.getLimitingRate(), 0.1);
+
+   // a lower rate takes over, a higher one doesn't
+   controller.onFeedback(2, 0.02, CNanoTime::fromMsec(100), now);
+   CPPUNIT_ASSERT_EQUAL(uint32_t(2), controller.getLimitingReceiver());
+   controller.onFeedback(3, 0.02, CNanoTime::fromMsec(50), now);
+   CPPUNIT_ASSERT_EQUAL(uint32_t(2), controller.getLimitingReceiver());
+   CPPUNIT_ASSERT_EQUAL(size_t(3), controller.getReceiverCount());
+
+   // when the CLR gets better, the lowest rate is looked for
+   controller.onFeedback(2, 0.001, CNanoTime::fromMsec(100), now);
+   CPPUNIT_ASSERT_EQUAL(uint32_t(1), controller.getLimitingReceiver());
+   controller.onReceiverRemoved(1);
+   CPPUNIT_ASSERT_EQUAL(uint32_t(3), controller.getLimitingReceiver());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), controller.getLimitingChangeCount());
+
+   // the round trip time is smoothed
+   controller.onFeedback(3, 0.02, CNanoTime::fromMsec(130), now);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(CTfmccController::getTcpRate(1000, CNanoTime::fromMsec(60), 0.02),
+                                controller.getLimitingRate(), 0.1);
+
+   // without losses there is no CLR
+   controller.onFeedback(3, 0, CNanoTime(), now);
+   controller.onFeedback(2, 0, CNanoTime(), now);
+   CPPUNIT_ASSERT(!controller.hasLimitingReceiver());
+   CPPUNIT_ASSERT(isinf(controller.getLimitingRate()));
+}
+
+void testCTfmccController::testRateChange()
+{
+   CTfmccController controller(1000, 1000, 1e9);
+   const CNanoTime start = CNanoTime::fromSec(100);
+
+   controller.onFeedback(1, 0, CNanoTime::fromMsec(100), start);
+   CPPUNIT_ASSERT(controller.getRate(start + CNanoTime::fromMsec(1500)) > 1e6);
+
+   // down at once
+   controller.onFeedback(1, 0.01, CNanoTime::fromMsec(100), start + CNanoTime::fromMsec(1500));
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(112332.2, controller.getRate(start + CNanoTime::fromMsec(1500)),
+                                0.1);
+
+   // up by one segment per round trip time per round trip time
+   controller.onFeedback(1, 0.005, CNanoTime::fromMsec(100), start + CNanoTime::fromMsec(1500));
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(122332.2, controller.getRate(start + CNanoTime::fromMsec(1600)),
+                                0.1);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(142332.2, controller.getRate(start + CNanoTime::fromMsec(1800)),
+                                0.1);
+   // not past the rate of the CLR
+   const double target = CTfmccController::getTcpRate(1000, CNanoTime::fromMsec(100), 0.005);
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(target, controller.getRate(start + CNanoTime::fromSec(10)), 0.1);
+
+   // and not below the minimum
+   controller.onFeedback(1, 1.0, CNanoTime::fromMsec(100), start + CNanoTime::fromSec(10));
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(1000.0, controller.getRate(start + CNanoTime::fromSec(10)), 0.001);
+}
+
+void testCTfmccController::testConstructorException()
+{
+   CPPUNIT_ASSERT_THROW(CTfmccController(0, 1000, 2000), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CTfmccController(1000, 0, 2000), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CTfmccController(1000, 3000, 2000), std::runtime_error);
+}
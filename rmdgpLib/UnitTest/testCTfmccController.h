@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCTfmccController.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 5, 2021, 10:30 AM
+ */
+
+#ifndef TESTCTFMCCCONTROLLER_H
+#define TESTCTFMCCCONTROLLER_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class testCTfmccController : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCTfmccController);
+
+    CPPUNIT_TEST(testTcpRate);
+    CPPUNIT_TEST(testSlowStart);
+    CPPUNIT_TEST(testLimitingReceiver);
+    CPPUNIT_TEST(testRateChange);
+    CPPUNIT_TEST(testConstructorException);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCTfmccController();
+    virtual ~testCTfmccController();
+    void setUp();
+    void tearDown();
+
+private:
+    void testTcpRate();
+    void testSlowStart();
+    void testLimitingReceiver();
+    void testRateChange();
+    void testConstructorException();
+};
+
+#endif /* TESTCTFMCCCONTROLLER_H */
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCXorKernel.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 30, 2021, 11:15 PM
+ */
+
+#include "testCXorKernel.h"
+#include "../CXorKernel.h"
+#include <stdexcept>
+#include <vector>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCXorKernel);
+
+testCXorKernel::testCXorKernel()
+{
+}
+
+testCXorKernel::~testCXorKernel()
+{
+}
+
+void testCXorKernel::setUp()
+{
+}
+
+void testCXorKernel::tearDown()
+{
+}
+
+void testCXorKernel::testXorInto()
+{
+   uint8_t target[5] = { 0x00, 0xff, 0x0f, 0xaa, 0x12 };
+   const uint8_t source[5] = { 0xff, 0xff, 0xf0, 0x55, 0x34 };
+
+   CXorKernel::xorInto(target, source, 4);
+   CPPUNIT_ASSERT_EQUAL(0xff, int(target[0]));
+   CPPUNIT_ASSERT_EQUAL(0x00, int(target[1]));
+   CPPUNIT_ASSERT_EQUAL(0xff, int(target[2]));
+   CPPUNIT_ASSERT_EQUAL(0xff, int(target[3]));
+   // beyond the length nothing changes
+   CPPUNIT_ASSERT_EQUAL(0x12, int(target[4]));
+   // twice is the original
+   CXorKernel::xorInto(target, source, 4);
+   CPPUNIT_ASSERT_EQUAL(0x00, int(target[0]));
+   CPPUNIT_ASSERT_EQUAL(0xaa, int(target[3]));
+   CPPUNIT_ASSERT(CXorKernel::isSupported(CXorKernel::getSelected()));
+}
+
+void testCXorKernel::testKernels()
+{
+   const CXorKernel::EKernel kernels[] = { CXorKernel::EKernel::scalar, CXorKernel::EKernel::sse2,
+                                           CXorKernel::EKernel::avx2 };
+   std::vector<uint8_t> source(1000), expected(1000);
+
+   for(size_t i = 0; i < source.size(); i++)
+   {
+      source[i] = uint8_t(i * 7919);
+      expected[i] = uint8_t(i * 31);
+   }
+   // all lengths around the vector and unroll sizes, and unaligned
+   for(size_t length : { 0, 1, 7, 8, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 128, 129, 257, 990 })
+   {
+      for(size_t offset : { 0, 1, 3 })
+      {
+         std::vector<uint8_t> reference(expected);
+         for(size_t i = 0; i < length; i++)
+            reference[offset + i] ^= source[i];
+
+         for(CXorKernel::EKernel kernel : kernels)
+         {
+            if(!CXorKernel::isSupported(kernel))
+            {
+               CPPUNIT_ASSERT_THROW(CXorKernel::xorInto(kernel, &expected[0], &source[0], 1),
+                                    std::runtime_error);
+               continue;
+            }
+            std::vector<uint8_t> target(expected);
+            CXorKernel::xorInto(kernel, &target[offset], &source[0], length);
+            CPPUNIT_ASSERT_MESSAGE(CXorKernel::getName(kernel), reference == target);
+         }
+      }
+   }
+}
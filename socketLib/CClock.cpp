@@ -26,11 +26,22 @@
 
 #include "CClock.h"
 #include "CTime.h"
+#include "CNanoTime.h"
+#include "CTscClock.h"
 #include <time.h>
 #include <sstream>
 #include <errno.h>
 #include <string.h>
 
+namespace {
+   /// \brief the shared TSC clock, calibrated at the first use
+   CTscClock& fastClock()
+   {
+      static CTscClock clock;
+      return clock;
+   }
+}
+
 CClock::CClock()
 {
 }
@@ -49,3 +60,56 @@ CTime& CClock::getMonotonicTime(CTime &monotonicTime)
    }
    return monotonicTime;
 }
+
+CNanoTime& CClock::getMonotonicTime(CNanoTime &monotonicTime)
+{
+   timespec time;
+
+   if(clock_gettime(CLOCK_MONOTONIC, &time))
+   {
+      std::ostringstream message;
+      message << "Error clock_gettime CLOCK_MONOTONIC:" << errno << ": " << strerror(errno);
+      throw std::runtime_error(message.str());
+   }
+   monotonicTime = CNanoTime(time);
+   return monotonicTime;
+}
+
+CNanoTime& CClock::getMonotonicCoarseTime(CNanoTime &monotonicTime)
+{
+   timespec time;
+
+   if(clock_gettime(CLOCK_MONOTONIC_COARSE, &time))
+   {
+      std::ostringstream message;
+      message << "Error clock_gettime CLOCK_MONOTONIC_COARSE:" << errno << ": " << strerror(errno);
+      throw std::runtime_error(message.str());
+   }
+   monotonicTime = CNanoTime(time);
+   return monotonicTime;
+}
+
+CNanoTime& CClock::getRealTime(CNanoTime &realTime)
+{
+   timespec time;
+
+   if(clock_gettime(CLOCK_REALTIME, &time))
+   {
+      std::ostringstream message;
+      message << "Error clock_gettime CLOCK_REALTIME:" << errno << ": " << strerror(errno);
+      throw std::runtime_error(message.str());
+   }
+   realTime = CNanoTime(time);
+   return realTime;
+}
+
+CNanoTime& CClock::getFastMonotonicTime(CNanoTime &monotonicTime)
+{
+   monotonicTime = fastClock().now();
+   return monotonicTime;
+}
+
+bool CClock::isFastMonotonicTimeTscBased()
+{
+   return fastClock().isTscBased();
+}
@@ -28,6 +28,7 @@
 #define CCLOCK_H
 
 class CTime;
+class CNanoTime;
 
 /// \brief an interface that retrieves the clock times from the OS
 class CClock {
@@ -42,6 +43,36 @@ public:
     /// \throws std::runtime_error when clock points outside the accessible address space or when
     ///         The OS doesn't support CLOCK_MONOTONIC
     static CTime& getMonotonicTime(CTime &monotonicTime);
+    static CNanoTime& getMonotonicTime(CNanoTime &monotonicTime);
+
+    /// \brief retrieve the coarse monotonicTime (CLOCK_MONOTONIC_COARSE) from OS. It is cheaper
+    ///        than getMonotonicTime, but has only the resolution of a kernel tick (1 to 4ms).
+    ///        Good enough for liveness timeouts.
+    /// \param monotonicTime object that receives the time
+    /// \returns a reference to monotonicTime
+    /// \throws std::runtime_error when the OS doesn't support CLOCK_MONOTONIC_COARSE
+    static CNanoTime& getMonotonicCoarseTime(CNanoTime &monotonicTime);
+
+    /// \brief retrieve the wall clock time (CLOCK_REALTIME) from OS, the time since the epoch.
+    ///        Unlike the monotonic time it can be compared between hosts whose clocks are
+    ///        synchronized (NTP, PTP), for instance to time stamp a message at the sender and
+    ///        measure its delivery latency at the receiver.
+    /// \param realTime object that receives the time
+    /// \returns a reference to realTime
+    /// \throws std::runtime_error when the OS doesn't support CLOCK_REALTIME
+    static CNanoTime& getRealTime(CNanoTime &realTime);
+
+    /// \brief retrieve the monotonicTime from the invariant TSC of the CPU. This is much cheaper
+    ///        than getMonotonicTime and meant for time stamping on the hot path. The TSC is
+    ///        calibrated against CLOCK_MONOTONIC at the first call and recalibrated every second.
+    ///        When there is no invariant TSC it falls back to getMonotonicTime.
+    /// \param monotonicTime object that receives the time
+    /// \returns a reference to monotonicTime
+    /// \throws std::runtime_error only in fallback mode, see getMonotonicTime
+    static CNanoTime& getFastMonotonicTime(CNanoTime &monotonicTime);
+
+    /// \brief returns true when getFastMonotonicTime reads the TSC, false when it falls back
+    static bool isFastMonotonicTimeTscBased();
 private:
 
 };
@@ -35,7 +35,8 @@
 
 
 
-CFdWaiter::CFdWaiter() : proxy(CSocketProxySingleton::get())
+CFdWaiter::CFdWaiter() : proxy(CSocketProxySingleton::get()),
+                           clockMode(EClockMode::precise), clockReadCount(0), wakeUpCount(0)
 {
 }
 
@@ -43,10 +44,10 @@ CFdWaiter::~CFdWaiter()
 {
 }
 
-int CFdWaiter::select(const CTime &timeout)
+int CFdWaiter::select(const CNanoTime &timeout)
 {
    int nfds = 0;
-   CTime timeOut(timeout);
+   const timespec timeOut = timeout.toTimespec();
 
    FD_ZERO(&readFdSet);
    for(auto it = readFileDescriptors.begin(); it != readFileDescriptors.end(); ++it)
@@ -77,16 +78,21 @@ int CFdWaiter::select(const CTime &timeout)
    return proxy->pselect(nfds, &readFdSet, &writeFdSet, NULL, &timeOut, NULL);
 }
 
-bool CFdWaiter::waitUntil(const CTime &moment)
+bool CFdWaiter::waitUntil(const CNanoTime &moment)
 {
-   const CTime zeroTime(0,1);
-   CTime currentTime;
-   CTime timeout = moment - CClock::getMonotonicTime(currentTime);
+   const CNanoTime zeroTime(0,1);
    int result;
 
+   // the caller may have spent time since the previous wake up, now() is too old for the
+   // remaining time. Within the loop the read after pselect is the start of the next one.
+   refreshNow();
+
+   CNanoTime timeout = moment - currentTime;
+
    while(timeout > zeroTime)
    {
       result = select(timeout);
+      wakeUpCount++;
 
       if(result==-1)
       {
@@ -99,14 +105,27 @@ bool CFdWaiter::waitUntil(const CTime &moment)
          }
       }
 
+      refreshNow();
+
       if(result>0)
          return false;
 
-      timeout = moment - CClock::getMonotonicTime(currentTime);
+      timeout = moment - currentTime;
    }
    return true;
 }
 
+const CNanoTime& CFdWaiter::refreshNow()
+{
+   if(clockMode == EClockMode::coarse)
+      CClock::getMonotonicCoarseTime(currentTime);
+   else
+      CClock::getMonotonicTime(currentTime);
+   clockReadCount++;
+
+   return currentTime;
+}
+
 void CFdWaiter::addReadFileDescriptor(const CFileDescriptor *fileDesriptor)
 {
    readFileDescriptors.insert(fileDesriptor);
@@ -28,14 +28,22 @@
 #define CFDWAITER_H
 
 #include "CTime.h"
+#include "CNanoTime.h"
 #include <set>
 #include <memory>
+#include <stdint.h>
 
 class CFileDescriptor;
 class CSocketProxy;
 
 class CFdWaiter {
 public:
+    /// \brief the clock that is read at every wake up
+    enum class EClockMode {
+        precise,    ///< CLOCK_MONOTONIC
+        coarse      ///< CLOCK_MONOTONIC_COARSE, cheaper but only kernel tick (1 to 4ms) resolution
+    };
+
     CFdWaiter();
     CFdWaiter(const CFdWaiter& orig) = delete;
     CFdWaiter& operator=(const CFdWaiter& other) = delete;
@@ -49,15 +57,40 @@ public:
     /// \brief does the appropriate call to pselect with the current added fileDescriptors
     /// \return the returned value of the select system call
     /// \warning you have to handle the OS errors when select returns -1
-    int select(const CTime &timeout);
+    int select(const CNanoTime &timeout);
+    int select(const CTime &timeout) { return select(CNanoTime(timeout)); }
 
     /// \brief wait until moment or a file descriptor is ready
+    ///        The clock is read on entry, for the remaining time, and at every wake up. The time
+    ///        of the last wake up is available via now(), for the handlers of the ready file
+    ///        descriptors, and is the start of the remaining time when pselect is called again
+    ///        within the same call. So a call that wakes up once reads the clock twice: the
+    ///        wake up of the previous call can't be the entry time, because the handlers ran
+    ///        in between and a slow handler would push every deadline back by its run time.
     /// \param moment is a particular time of the monotonic clock (CLOCK_MONOTONIC)
     /// \return true if moment is passed. false if a file descriptor is ready for reading or
     ///         writing
     /// \throws std::runtime_error when OS reports an error. This can only happen when it is not
     ///         possible to allocate memory or when waitUntil has a bug.
-    bool waitUntil(const CTime &moment);
+    bool waitUntil(const CNanoTime &moment);
+    bool waitUntil(const CTime &moment) { return waitUntil(CNanoTime(moment)); }
+
+    /// \brief returns the time read at the last wake up of waitUntil (or the last refreshNow).
+    ///        Handlers should use this instead of reading the clock for every packet.
+    const CNanoTime& now() const { return currentTime; }
+
+    /// \brief reads the clock and returns the new now()
+    /// \throws std::runtime_error see CClock::getMonotonicTime
+    const CNanoTime& refreshNow();
+
+    /// \brief selects the clock that is used for now(). Default is EClockMode::precise
+    void setClockMode(EClockMode mode) { clockMode = mode; }
+    EClockMode getClockMode() const { return clockMode; }
+
+    /// \brief returns the number of clock reads done by this object
+    uint64_t getClockReadCount() const { return clockReadCount; }
+    /// \brief returns the number of times pselect returned
+    uint64_t getWakeUpCount() const { return wakeUpCount; }
 
     size_t getNumberReadFileDescriptors() const { return readFileDescriptors.size(); }
     size_t getNumberWriteFileDescriptors() const { return writeFileDescriptors.size(); }
@@ -73,6 +106,11 @@ private:
     std::set<const CFileDescriptor*> writeFileDescriptors;
 
     std::shared_ptr<CSocketProxy> proxy;
+
+    CNanoTime currentTime;
+    EClockMode clockMode;
+    uint64_t clockReadCount;
+    uint64_t wakeUpCount;
 };
 
 #endif /* CFDWAITER_H */
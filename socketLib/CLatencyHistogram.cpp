@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CLatencyHistogram.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 12, 2021, 10:20 AM
+ */
+
+#include "CLatencyHistogram.h"
+#include "CTime.h"
+#include <algorithm>
+#include <sstream>
+
+CLatencyHistogram::CLatencyHistogram() : counts(countsLength, 0), totalCount(0), totalSum(0),
+                                         minValue(UINT64_MAX), maxValue(0)
+{
+}
+
+CLatencyHistogram::~CLatencyHistogram()
+{
+}
+
+void CLatencyHistogram::record(const CTime &duration)
+{
+   record(CNanoTime(duration));
+}
+
+void CLatencyHistogram::merge(const CLatencyHistogram &other)
+{
+   addCounts(other.counts.data(), other.totalSum, other.minValue, other.maxValue);
+}
+
+void CLatencyHistogram::addCounts(const uint64_t *countsToAdd, uint64_t sum, uint64_t min,
+                                  uint64_t max)
+{
+   for(size_t i = 0; i < countsLength; i++)
+   {
+      counts[i] += countsToAdd[i];
+      totalCount += countsToAdd[i];
+   }
+   totalSum += sum;
+   if(min < minValue) minValue = min;
+   if(max > maxValue) maxValue = max;
+}
+
+void CLatencyHistogram::reset()
+{
+   std::fill(counts.begin(), counts.end(), 0);
+   totalCount = 0;
+   totalSum = 0;
+   minValue = UINT64_MAX;
+   maxValue = 0;
+}
+
+CNanoTime CLatencyHistogram::getValueAtPercentile(double percentile) const
+{
+   if(totalCount == 0)
+      return CNanoTime();
+
+   if(percentile > 100.0) percentile = 100.0;
+   if(percentile < 0.0) percentile = 0.0;
+
+   // the number of values that must be at or below the returned value, at least one
+   uint64_t countAtPercentile = uint64_t((percentile / 100.0) * double(totalCount) + 0.5);
+   if(countAtPercentile < 1) countAtPercentile = 1;
+
+   uint64_t runningCount = 0;
+   for(size_t i = 0; i < countsLength; i++)
+   {
+      runningCount += counts[i];
+      if(runningCount >= countAtPercentile)
+      {
+         // the highest value of the sub bucket, but never above the exact maximum
+         const uint64_t value = highestValueAtIndex(i);
+         return CNanoTime::fromNsec(int64_t(value < maxValue ? value : maxValue));
+      }
+   }
+   return getMax();
+}
+
+uint64_t CLatencyHistogram::highestValueAtIndex(size_t index)
+{
+   const size_t bucketIndex = (index < subBucketCount) ? 0 : index / subBucketHalfCount - 1;
+   const uint64_t subBucketIndex = index - bucketIndex * subBucketHalfCount;
+   const uint64_t lowestValue = subBucketIndex << bucketIndex;
+
+   return lowestValue + (uint64_t(1) << bucketIndex) - 1;
+}
+
+void CLatencyHistogram::printPercentiles(std::ostream &os) const
+{
+   const double percentiles[] = { 50.0, 90.0, 99.0, 99.9, 99.99 };
+
+   os << "count=" << totalCount << " min=" << getMin().getNsec() << "ns";
+   for(const double percentile : percentiles)
+   {
+      // own stream for the label, so the float format of os doesn't matter
+      std::ostringstream label;
+      label << " p" << percentile << "=";
+      os << label.str() << getValueAtPercentile(percentile).getNsec() << "ns";
+   }
+   os << " max=" << getMax().getNsec() << "ns";
+}
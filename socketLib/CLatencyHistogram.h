@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CLatencyHistogram.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 12, 2021, 10:20 AM
+ */
+
+#ifndef CLATENCYHISTOGRAM_H
+#define CLATENCYHISTOGRAM_H
+
+#include "CNanoTime.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <ostream>
+#include <vector>
+
+class CTime;
+
+/// \brief A fixed memory, log linear (HDR style) histogram of durations in nanoseconds.
+///        Every power of two range is divided in subBucketHalfCount linear sub buckets, so a
+///        recorded value is known with a relative precision of 1/subBucketHalfCount (< 0.8%).
+///        Recording is constant time: a count leading zeros and an array increment.
+///        Durations up to maxTrackableValue (about 18 minutes) are tracked, longer durations are
+///        counted as maxTrackableValue, negative durations as 0.
+/// \note  Not thread safe. Use CLatencyRecorder to record from a hot path in another thread.
+class CLatencyHistogram {
+public:
+    CLatencyHistogram();
+    CLatencyHistogram(const CLatencyHistogram& orig) = default;
+    CLatencyHistogram& operator=(const CLatencyHistogram& other) = default;
+    virtual ~CLatencyHistogram();
+
+    /// \brief records a duration
+    void record(const CNanoTime &duration) { recordValue(duration.getNsec(), 1); }
+    void record(const CTime &duration);
+
+    /// \brief records count times a duration of nanoSeconds
+    void recordValue(int64_t nanoSeconds, uint64_t count)
+    {
+        const uint64_t value = clampValue(nanoSeconds);
+        counts[countsIndex(value)] += count;
+        totalCount += count;
+        totalSum += value * count;
+        if(value < minValue) minValue = value;
+        if(value > maxValue) maxValue = value;
+    }
+
+    /// \brief adds all recorded values of other to this histogram
+    void merge(const CLatencyHistogram &other);
+
+    /// \brief removes all recorded values
+    void reset();
+
+    /// \brief returns the duration below or equal to which percentile percent of the recorded
+    ///        values are. For instance getValueAtPercentile(99.9).
+    ///        Returns 0 when nothing is recorded.
+    CNanoTime getValueAtPercentile(double percentile) const;
+
+    uint64_t getTotalCount() const { return totalCount; }
+    /// \brief returns the smallest recorded duration (exact), 0 when nothing is recorded
+    CNanoTime getMin() const { return CNanoTime::fromNsec(totalCount ? minValue : 0); }
+    /// \brief returns the largest recorded duration (exact)
+    CNanoTime getMax() const { return CNanoTime::fromNsec(maxValue); }
+    /// \brief returns the average of the recorded durations (exact)
+    CNanoTime getMean() const
+        { return CNanoTime::fromNsec(totalCount ? totalSum / totalCount : 0); }
+
+    /// \brief prints count, min, the usual percentiles (50, 90, 99, 99.9, 99.99) and max
+    void printPercentiles(std::ostream &os) const;
+
+    /// \brief returns the index in the counts array for a value
+    static size_t countsIndex(uint64_t value)
+    {
+        // the power of two range, the first range also contains the values below subBucketCount
+        const int bucketIndex =
+                    63 - __builtin_clzll(value | (subBucketCount - 1)) - (subBucketBits - 1);
+        const size_t subBucketIndex = size_t(value >> bucketIndex);
+        return size_t(bucketIndex) * subBucketHalfCount + subBucketIndex;
+    }
+    /// \brief returns the highest value that is counted in counts[index]
+    static uint64_t highestValueAtIndex(size_t index);
+
+    /// \brief returns value clamped to [0, maxTrackableValue]
+    static uint64_t clampValue(int64_t value)
+    {
+        return (value < 0) ? 0 :
+                    (uint64_t(value) > maxTrackableValue) ? maxTrackableValue : uint64_t(value);
+    }
+
+    static constexpr int subBucketBits = 8;
+    static constexpr uint64_t subBucketCount = uint64_t(1) << subBucketBits;
+    static constexpr uint64_t subBucketHalfCount = subBucketCount / 2;
+    static constexpr int maxValueBits = 40;
+    static constexpr uint64_t maxTrackableValue = (uint64_t(1) << maxValueBits) - 1;
+    static constexpr size_t bucketCount = maxValueBits - subBucketBits + 1;
+    static constexpr size_t countsLength = (bucketCount + 1) * subBucketHalfCount;
+
+    /// \brief direct access to the counters, for CLatencyRecorder snapshots
+    void addCounts(const uint64_t *countsToAdd, uint64_t sum, uint64_t min, uint64_t max);
+
+private:
+    std::vector<uint64_t> counts;
+    uint64_t totalCount;
+    uint64_t totalSum;
+    uint64_t minValue;
+    uint64_t maxValue;
+};
+
+#endif /* CLATENCYHISTOGRAM_H */
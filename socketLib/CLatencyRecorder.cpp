@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CLatencyRecorder.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 12, 2021, 3:05 PM
+ */
+
+#include "CLatencyRecorder.h"
+#include <vector>
+
+CLatencyRecorder::CLatencyRecorder() :
+               counts(new std::atomic<uint64_t>[CLatencyHistogram::countsLength]),
+               totalSum(0), minValue(UINT64_MAX), maxValue(0)
+{
+   for(size_t i = 0; i < CLatencyHistogram::countsLength; i++)
+      counts[i].store(0, std::memory_order_relaxed);
+}
+
+CLatencyRecorder::~CLatencyRecorder()
+{
+}
+
+void CLatencyRecorder::snapshot(CLatencyHistogram &histogram) const
+{
+   std::vector<uint64_t> copy(CLatencyHistogram::countsLength);
+
+   for(size_t i = 0; i < CLatencyHistogram::countsLength; i++)
+      copy[i] = counts[i].load(std::memory_order_relaxed);
+
+   histogram.addCounts(copy.data(), totalSum.load(std::memory_order_relaxed),
+                       minValue.load(std::memory_order_relaxed),
+                       maxValue.load(std::memory_order_relaxed));
+}
+
+CLatencyHistogram CLatencyRecorder::snapshot() const
+{
+   CLatencyHistogram histogram;
+
+   snapshot(histogram);
+   return histogram;
+}
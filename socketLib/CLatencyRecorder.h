@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CLatencyRecorder.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 12, 2021, 3:05 PM
+ */
+
+#ifndef CLATENCYRECORDER_H
+#define CLATENCYRECORDER_H
+
+#include "CLatencyHistogram.h"
+#include <atomic>
+#include <memory>
+
+/// \brief Records durations in a CLatencyHistogram layout from a single thread, while other
+///        threads take snapshots. Recording is lock free and wait free: the counters are atomics
+///        written by one thread only, so a relaxed load and store is enough (no read modify
+///        write). Give every recording thread its own recorder and merge the snapshots off the
+///        hot path.
+/// \warning only one thread may call record() on an object
+class CLatencyRecorder {
+public:
+    CLatencyRecorder();
+    CLatencyRecorder(const CLatencyRecorder& orig) = delete;
+    CLatencyRecorder& operator=(const CLatencyRecorder& other) = delete;
+    virtual ~CLatencyRecorder();
+
+    /// \brief records a duration. Only call from the owning thread.
+    void record(const CNanoTime &duration)
+    {
+        const uint64_t value = CLatencyHistogram::clampValue(duration.getNsec());
+        increment(counts[CLatencyHistogram::countsIndex(value)], 1);
+        increment(totalSum, value);
+        if(value < minValue.load(std::memory_order_relaxed))
+            minValue.store(value, std::memory_order_relaxed);
+        if(value > maxValue.load(std::memory_order_relaxed))
+            maxValue.store(value, std::memory_order_relaxed);
+    }
+
+    /// \brief adds everything recorded until now to histogram. Can be called from any thread.
+    ///        The snapshot is not atomic as a whole, a value recorded during the snapshot may be
+    ///        in it or not, but every counter is read consistently.
+    void snapshot(CLatencyHistogram &histogram) const;
+
+    /// \brief returns everything recorded until now as a new histogram
+    CLatencyHistogram snapshot() const;
+
+private:
+    static void increment(std::atomic<uint64_t> &counter, uint64_t value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    std::unique_ptr<std::atomic<uint64_t>[]> counts;
+    std::atomic<uint64_t> totalSum;
+    std::atomic<uint64_t> minValue;
+    std::atomic<uint64_t> maxValue;
+};
+
+#endif /* CLATENCYRECORDER_H */
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CMappedFile.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 6, 2021, 10:20 AM
+ */
+
+#include "CMappedFile.h"
+#include <algorithm>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+   /// \brief throws the error of the last system call
+   void throwError(const char *what, const std::string &path, int errorNbr)
+   {
+      std::ostringstream message;
+      message << "Error " << what << " " << path << " " << errorNbr << ": " << strerror(errorNbr);
+      throw std::runtime_error(message.str());
+   }
+}
+
+CMappedFile::CMappedFile(const std::string &path, size_t size, bool populate) : path(path),
+               size(size), data(nullptr), fd(-1), created(false)
+{
+   struct stat status;
+
+   fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+   if(fd < 0)
+      throwError("opening", path, errno);
+   if(fstat(fd, &status))
+   {
+      const int errorNbr = errno;
+      close(fd);
+      throwError("reading the status of", path, errorNbr);
+   }
+
+   if(status.st_size == 0)
+   {
+      // reserve the blocks now, a write in the mapping of a sparse file may block or fail
+      const int errorNbr = (size == 0) ? EINVAL : posix_fallocate(fd, 0, off_t(size));
+      if(errorNbr != 0 && !(errorNbr == EOPNOTSUPP && ftruncate(fd, off_t(size)) == 0))
+      {
+         close(fd);
+         unlink(path.c_str());
+         throwError("preallocating", path, errorNbr);
+      }
+      created = true;
+   }
+   else
+      this->size = size_t(status.st_size);
+
+   void *mapping = mmap(nullptr, this->size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | (populate ? MAP_POPULATE : 0), fd, 0);
+   if(mapping == MAP_FAILED)
+   {
+      const int errorNbr = errno;
+      close(fd);
+      throwError("mapping", path, errorNbr);
+   }
+   data = static_cast<uint8_t*>(mapping);
+}
+
+CMappedFile::~CMappedFile()
+{
+   munmap(data, size);
+   close(fd);
+}
+
+void CMappedFile::flush(size_t offset, size_t length, bool synchronous)
+{
+   // msync wants a page aligned start
+   const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+   const size_t begin = offset - offset % pageSize;
+   const size_t end = std::min(size, offset + length);
+
+   if(end <= begin)
+      return;
+   if(synchronous)
+   {
+      if(msync(data + begin, end - begin, MS_SYNC))
+         throwError("flushing", path, errno);
+   }
+   // MS_ASYNC does nothing on Linux, this starts the write back without waiting for it. So the
+   // dirty pages don't pile up until the kernel throttles the thread that writes them.
+   else if(sync_file_range(fd, off64_t(begin), off64_t(end - begin), SYNC_FILE_RANGE_WRITE))
+      throwError("flushing", path, errno);
+}
+
+void CMappedFile::adviseRandom(size_t offset, size_t length)
+{
+   // madvise wants a page aligned start as well
+   const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+   const size_t begin = offset - offset % pageSize;
+   const size_t end = std::min(size, offset + length);
+
+   if(end > begin && madvise(data + begin, end - begin, MADV_RANDOM))
+      throwError("advising", path, errno);
+}
+
+void CMappedFile::remove()
+{
+   if(unlink(path.c_str()))
+      throwError("removing", path, errno);
+}
+
+std::vector<std::string> CMappedFile::list(const std::string &directory,
+                    const std::string &prefix)
+{
+   std::vector<std::string> names;
+   DIR *dir = opendir(directory.c_str());
+
+   if(dir == nullptr)
+      throwError("reading directory", directory, errno);
+   while(const dirent *entry = readdir(dir))
+   {
+      if(strncmp(entry->d_name, prefix.c_str(), prefix.size()) == 0 &&
+         strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+         names.push_back(entry->d_name);
+   }
+   closedir(dir);
+   std::sort(names.begin(), names.end());
+   return names;
+}
+
+void CMappedFile::makeDirectory(const std::string &directory)
+{
+   if(mkdir(directory.c_str(), 0755) && errno != EEXIST)
+      throwError("creating directory", directory, errno);
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CMappedFile.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 6, 2021, 10:20 AM
+ */
+
+#ifndef CMAPPEDFILE_H
+#define CMAPPEDFILE_H
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief A file that is mapped shared in memory, read and write. A new file is preallocated
+///        with its full size, so writing in the mapping never has to allocate disk blocks; the
+///        bytes of a new file are 0. An existing file is mapped with its own size.
+///        The mapping is written back by the kernel in the background, flush starts it at once
+///        (asynchronous) or waits for it.
+class CMappedFile {
+public:
+    /// \param path the file to open, it is created when it doesn't exist
+    /// \param size the size of a new file, ignored for an existing one
+    /// \param populate maps all pages now, so the first write to a page doesn't fault
+    /// \throws std::runtime_error when the file can't be created, preallocated or mapped, or
+    ///         an existing file is empty
+    CMappedFile(const std::string &path, size_t size, bool populate = false);
+    CMappedFile(const CMappedFile& orig) = delete;
+    CMappedFile& operator=(const CMappedFile& other) = delete;
+    virtual ~CMappedFile();
+
+    uint8_t* getData() { return data; }
+    const uint8_t* getData() const { return data; }
+    size_t getSize() const { return size; }
+    const std::string& getPath() const { return path; }
+    /// \brief returns true when the file didn't exist before
+    bool isCreated() const { return created; }
+
+    /// \brief writes the pages of the range back to the file
+    /// \param synchronous false to start the write back and return at once
+    ///        (sync_file_range), true to wait until the pages are on the disk (MS_SYNC)
+    /// \throws std::runtime_error when OS reports an error.
+    void flush(size_t offset, size_t length, bool synchronous = false);
+    /// \brief writes all pages back, see flush(size_t, size_t, bool)
+    void flush(bool synchronous = false) { flush(0, size, synchronous); }
+    /// \brief tells the kernel that the range is read at random, so a page fault reads only
+    ///        that page instead of a whole read ahead window around it (MADV_RANDOM)
+    /// \throws std::runtime_error when OS reports an error.
+    void adviseRandom(size_t offset, size_t length);
+    /// \brief deletes the file. The mapping stays valid until destruction.
+    /// \throws std::runtime_error when OS reports an error.
+    void remove();
+
+    /// \brief returns the names of the files in directory that start with prefix, sorted
+    /// \throws std::runtime_error when the directory can't be read
+    static std::vector<std::string> list(const std::string &directory, const std::string &prefix);
+    /// \brief creates directory when it doesn't exist
+    /// \throws std::runtime_error when OS reports an error.
+    static void makeDirectory(const std::string &directory);
+
+private:
+    const std::string path;
+    size_t size;
+    uint8_t *data;
+    int fd;
+    bool created;
+};
+
+#endif /* CMAPPEDFILE_H */
@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CNanoTime.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 2, 2021, 7:45 PM
+ */
+
+#include "CNanoTime.h"
+
+std::ostream& operator<<(std::ostream& os, const CNanoTime &time)
+{
+   // same format as CTime, so both can be compared in test and log output
+   const timespec spec = time.toTimespec();
+   os << spec.tv_sec << "s " << spec.tv_nsec << "ns";
+   return os;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CNanoTime.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 2, 2021, 7:45 PM
+ */
+
+#ifndef CNANOTIME_H
+#define CNANOTIME_H
+
+#include "CTime.h"
+#include <time.h>
+#include <stdint.h>
+#include <chrono>
+#include <ostream>
+#include <type_traits>
+
+/// \brief A compact time, a moment or a duration, stored as a signed number of nanoseconds.
+///        Unlike CTime it has no virtual destructor and needs no normalization, so it is 8 bytes,
+///        trivially copyable and all arithmetic and comparisons are constexpr.
+///        The range is about +/- 292 years, which is more than enough for CLOCK_MONOTONIC.
+class CNanoTime {
+public:
+    constexpr CNanoTime() : nsec(0) {}
+    constexpr CNanoTime(int64_t sec, int64_t nanoSec) : nsec(sec * nsecInSec + nanoSec) {}
+    explicit constexpr CNanoTime(const timespec &time)
+        : nsec(int64_t(time.tv_sec) * nsecInSec + time.tv_nsec) {}
+    template<class Rep, class Period>
+    constexpr CNanoTime(const std::chrono::duration<Rep, Period> &duration)
+        : nsec(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()) {}
+
+    /// \brief named constructors, to prevent confusion about the unit of a single number
+    static constexpr CNanoTime fromNsec(int64_t nanoSec) { return CNanoTime(0, nanoSec); }
+    static constexpr CNanoTime fromUsec(int64_t microSec)
+        { return CNanoTime(0, microSec * nsecInMicrosec); }
+    static constexpr CNanoTime fromMsec(int64_t milliSec)
+        { return CNanoTime(0, milliSec * nsecInMillisec); }
+    static constexpr CNanoTime fromSec(int64_t sec) { return CNanoTime(sec, 0); }
+
+    /// \brief returns the number of nanoseconds
+    constexpr int64_t getNsec() const { return nsec; }
+    /// \brief returns the number of whole seconds (truncated towards zero)
+    constexpr int64_t getSec() const { return nsec / nsecInSec; }
+    /// \brief returns the number of whole microseconds (truncated towards zero)
+    constexpr int64_t getUsec() const { return nsec / nsecInMicrosec; }
+    /// \brief returns the number of whole milliseconds (truncated towards zero)
+    constexpr int64_t getMsec() const { return nsec / nsecInMillisec; }
+
+    /// \brief returns the time as timespec. Like CTime the tv_nsec part is always positive.
+    constexpr timespec toTimespec() const
+    {
+        return { time_t(floorSec()), long(nsec - floorSec() * nsecInSec) };
+    }
+    /// \brief returns the time as CTime
+    CTime toCTime() const { return CTime(time_t(floorSec()), long(nsec - floorSec() * nsecInSec)); }
+    /// \brief returns the time as std::chrono::nanoseconds
+    constexpr std::chrono::nanoseconds toChrono() const { return std::chrono::nanoseconds(nsec); }
+
+    constexpr CNanoTime operator-(const CNanoTime &other) const
+        { return fromNsec(nsec - other.nsec); }
+    constexpr CNanoTime operator+(const CNanoTime &other) const
+        { return fromNsec(nsec + other.nsec); }
+    constexpr CNanoTime operator*(int64_t count) const { return fromNsec(nsec * count); }
+    constexpr CNanoTime operator/(int64_t divisor) const { return fromNsec(nsec / divisor); }
+    constexpr CNanoTime operator-() const { return fromNsec(-nsec); }
+    constexpr CNanoTime& operator-=(const CNanoTime &other) { nsec -= other.nsec; return *this; }
+    constexpr CNanoTime& operator+=(const CNanoTime &other) { nsec += other.nsec; return *this; }
+
+    constexpr bool operator==(const CNanoTime &other) const { return nsec == other.nsec; }
+    constexpr bool operator!=(const CNanoTime &other) const { return nsec != other.nsec; }
+    constexpr bool operator>(const CNanoTime &other) const { return nsec > other.nsec; }
+    constexpr bool operator<(const CNanoTime &other) const { return nsec < other.nsec; }
+    constexpr bool operator>=(const CNanoTime &other) const { return nsec >= other.nsec; }
+    constexpr bool operator<=(const CNanoTime &other) const { return nsec <= other.nsec; }
+
+    friend std::ostream& operator<<(std::ostream& os, const CNanoTime &time);
+
+    static constexpr int64_t nsecInSec = CTime::nsecInSec;
+    static constexpr int64_t nsecInMillisec = CTime::nsecInMillisec;
+    static constexpr int64_t nsecInMicrosec = CTime::nsecInMicrosec;
+
+private:
+    /// \brief seconds rounded towards minus infinity, so the remaining nanoseconds are positive
+    constexpr int64_t floorSec() const
+        { return (nsec >= 0) ? nsec / nsecInSec : -((-nsec + nsecInSec - 1) / nsecInSec); }
+
+    int64_t nsec;
+};
+
+static_assert(sizeof(CNanoTime) == 8, "CNanoTime must stay 8 bytes");
+static_assert(std::is_trivially_copyable<CNanoTime>::value, "CNanoTime must be trivially copyable");
+
+#endif /* CNANOTIME_H */
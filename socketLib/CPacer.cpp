@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CPacer.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 5, 2021, 2:05 PM
+ */
+
+#include "CPacer.h"
+#include "CLatencyRecorder.h"
+#include "CSocketProxy.h"        // includes sys/types.h and sys/socket.h
+#include "CUdpMulticastSender.h"
+#include <netinet/in.h>
+#include <algorithm>
+#include <math.h>
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+
+struct CPacer::SBatch {
+   /// \param destination the multicast address and port of all messages
+   SBatch(const sockaddr_in &destination) : destination(destination)
+   {
+      for(unsigned int i = 0; i < batchSize; i++)
+      {
+         messages[i] = mmsghdr();
+         messages[i].msg_hdr.msg_iov = &vectors[i];
+         messages[i].msg_hdr.msg_iovlen = 1;
+         messages[i].msg_hdr.msg_name = &this->destination;
+         messages[i].msg_hdr.msg_namelen = sizeof(this->destination);
+      }
+   }
+
+   sockaddr_in destination;
+   iovec vectors[batchSize];
+   mmsghdr messages[batchSize];
+};
+
+CPacer::CPacer(std::shared_ptr<CUdpMulticastSender> sender, double rate, size_t burst,
+               size_t maxDatagrams, size_t maxDatagramSize) : CPacer(sender,
+               getMulticastDestination(*sender), rate, burst, maxDatagrams, maxDatagramSize)
+{
+}
+
+CPacer::CPacer(std::shared_ptr<CUdpMulticastSender> sender, const sockaddr_in &destination,
+               double rate, size_t burst, size_t maxDatagrams, size_t maxDatagramSize) :
+               sender(sender), rate(rate),
+               burst(burst), maxDatagrams(maxDatagrams), maxDatagramSize(maxDatagramSize),
+               buffers(), lengths(maxDatagrams, 0), head(0), count(0), queuedBytes(0),
+               tokens(double(burst)), lastRefill(), started(false), backlogged(false), batch(),
+               latencyRecorder(), enqueueTimes(), sentCount(0), sentBytes(0), batchCount(0)
+{
+   if(!(rate > 0) || burst < maxDatagramSize || maxDatagrams == 0)
+   {
+      std::ostringstream message;
+      message << "Error pacer rate " << rate << " burst " << burst << " max datagrams "
+              << maxDatagrams << " max datagram size " << maxDatagramSize;
+      throw std::runtime_error(message.str());
+   }
+   buffers.resize(maxDatagrams * maxDatagramSize);
+   batch.reset(new SBatch(destination));
+}
+
+CPacer::~CPacer()
+{
+}
+
+bool CPacer::enqueue(const void *datagram, size_t length, const CNanoTime &now)
+{
+   uint8_t *slot = enqueue(length, now);
+
+   if(slot == nullptr)
+      return false;
+   memcpy(slot, datagram, length);
+   return true;
+}
+
+uint8_t* CPacer::enqueue(size_t length, const CNanoTime &now)
+{
+   if(count == maxDatagrams || length > maxDatagramSize)
+      return nullptr;
+
+   const size_t slot = (head + count) % maxDatagrams;
+   lengths[slot] = length;
+   if(latencyRecorder)
+      enqueueTimes[slot] = now;
+   queuedBytes += length;
+   count++;
+   return &buffers[slot * maxDatagramSize];
+}
+
+void CPacer::clear()
+{
+   head = 0;
+   count = 0;
+   queuedBytes = 0;
+   backlogged = false;
+}
+
+size_t CPacer::release(const CNanoTime &now)
+{
+   refill(now);
+   return sendQueued(tokens, now);
+}
+
+size_t CPacer::flush()
+{
+   return sendQueued(INFINITY, lastRefill);
+}
+
+void CPacer::setLatencyRecorder(std::shared_ptr<CLatencyRecorder> recorder)
+{
+   latencyRecorder = recorder;
+   // the datagrams that wait already count from the last release
+   enqueueTimes.assign(recorder ? maxDatagrams : 0, lastRefill);
+}
+
+size_t CPacer::sendQueued(double budget, const CNanoTime &now)
+{
+   size_t sent = 0;
+
+   while(count > 0 && budget >= double(lengths[head]))
+   {
+      // a batch of the datagrams that the budget covers
+      unsigned int batchLength = 0;
+      double cost = 0;
+      for(size_t slot = head; batchLength < batchSize && batchLength < count &&
+          cost + double(lengths[slot]) <= budget; slot = (slot + 1) % maxDatagrams)
+      {
+         batch->vectors[batchLength] = { &buffers[slot * maxDatagramSize], lengths[slot] };
+         cost += double(lengths[slot]);
+         batchLength++;
+      }
+
+      const size_t done = sender->sendBatch(batch->messages, batchLength);
+      for(size_t i = 0; i < done; i++)
+      {
+         tokens -= double(lengths[head]);
+         budget -= double(lengths[head]);
+         queuedBytes -= lengths[head];
+         sentBytes += lengths[head];
+         if(latencyRecorder)
+            latencyRecorder->record(now > enqueueTimes[head] ? now - enqueueTimes[head] :
+                                                               CNanoTime());
+         head = (head + 1) % maxDatagrams;
+         count--;
+      }
+      sent += done;
+      if(done > 0)
+         batchCount++;
+      // the socket would block, the rest waits for the next release
+      if(done < batchLength)
+         break;
+   }
+   sentCount += sent;
+   backlogged = count > 0;
+   return sent;
+}
+
+CNanoTime CPacer::getNextSendTime() const
+{
+   const double needed = std::min(double(burst), double(queuedBytes)) - tokens;
+
+   if(needed <= 0)
+      return lastRefill;
+   return lastRefill + CNanoTime::fromNsec(int64_t(ceil(needed / rate * 1e9)));
+}
+
+void CPacer::setRate(double newRate, const CNanoTime &now)
+{
+   if(!(newRate > 0))
+   {
+      std::ostringstream message;
+      message << "Error pacer rate " << newRate;
+      throw std::runtime_error(message.str());
+   }
+   refill(now);
+   rate = newRate;
+}
+
+sockaddr_in CPacer::getMulticastDestination(const CUdpMulticastSender &sender)
+{
+   sockaddr_in destination = sockaddr_in();
+
+   destination.sin_family = AF_INET;
+   destination.sin_addr = sender.getMulticastIpAddress();
+   destination.sin_port = htons(uint16_t(sender.getMulticastPort()));
+   return destination;
+}
+
+void CPacer::refill(const CNanoTime &now)
+{
+   // the bucket starts full
+   if(!started)
+   {
+      started = true;
+      lastRefill = now;
+      return;
+   }
+   if(now <= lastRefill)
+      return;
+
+   const double limit = backlogged ? double(burst) + std::max(double(burst), rate *
+                                     double(maxCatchUp.getNsec()) * 1e-9) : double(burst);
+   tokens = std::min(limit, tokens + rate * double((now - lastRefill).getNsec()) * 1e-9);
+   lastRefill = now;
+}
@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CPacer.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 5, 2021, 2:05 PM
+ */
+
+#ifndef CPACER_H
+#define CPACER_H
+
+#include "CNanoTime.h"
+#include <memory>
+#include <vector>
+#include <netinet/in.h>
+#include <stddef.h>
+#include <stdint.h>
+
+class CLatencyRecorder;
+class CUdpMulticastSender;
+
+/// \brief A token bucket between the protocol and a CUdpMulticastSender, so datagrams go out
+///        at rate instead of at line rate. enqueue copies a datagram into a queue, release sends
+///        the queued datagrams that the tokens allow, up to batchSize per sendmmsg call.
+///        The bucket fills with rate bytes per second. While the queue is empty it holds at most
+///        burst bytes, so after an idle period at most burst bytes go out at once. While
+///        datagrams wait it may hold another burst or maxCatchUp of tokens, so a release that
+///        comes late catches up instead of losing the tokens; that keeps the long term rate on
+///        target.
+///        getNextSendTime returns when the tokens cover burst bytes (or all that is queued), so
+///        the datagrams go out in micro bursts of about burst bytes: a larger burst costs fewer
+///        system calls, a smaller one gives a smoother stream. Schedule release at that time,
+///        the time is calculated in nanoseconds.
+///        A pacer sends to the multicast group of the sender, or to one unicast destination
+///        through the socket of the sender.
+///        With setLatencyRecorder the time that every datagram waited in the queue is recorded,
+///        from the now passed to enqueue until the now of the release that sends it.
+class CPacer {
+public:
+    /// \param sender an opened multicast sender
+    /// \param rate the rate in bytes per second
+    /// \param burst the size of a micro burst in bytes, at least maxDatagramSize
+    /// \param maxDatagrams the number of datagrams that can be queued
+    /// \param maxDatagramSize the largest datagram
+    /// \throws std::runtime_error when rate is not positive, burst is smaller than
+    ///         maxDatagramSize or maxDatagrams is 0
+    CPacer(std::shared_ptr<CUdpMulticastSender> sender, double rate, size_t burst,
+           size_t maxDatagrams = defaultMaxDatagrams,
+           size_t maxDatagramSize = defaultMaxDatagramSize);
+    /// \brief a pacer that sends to destination instead of the multicast group
+    /// \param sender an opened multicast sender, its socket sends the datagrams
+    /// \param destination a unicast address and port
+    /// \throws std::runtime_error see the other constructor
+    CPacer(std::shared_ptr<CUdpMulticastSender> sender, const sockaddr_in &destination,
+           double rate, size_t burst, size_t maxDatagrams = defaultMaxDatagrams,
+           size_t maxDatagramSize = defaultMaxDatagramSize);
+    CPacer(const CPacer& orig) = delete;
+    CPacer& operator=(const CPacer& other) = delete;
+    virtual ~CPacer();
+
+    /// \brief copies datagram to the end of the queue
+    /// \param now the enqueue time, only used by the latency recorder
+    /// \return false when the queue is full or the datagram is larger than maxDatagramSize
+    bool enqueue(const void *datagram, size_t length, const CNanoTime &now = CNanoTime());
+    /// \brief claims the slot at the end of the queue, so the datagram can be built in place
+    /// \param length the length of the datagram that will be written in the slot
+    /// \param now the enqueue time, only used by the latency recorder
+    /// \return the slot buffer or nullptr when the queue is full or length is larger than
+    ///         maxDatagramSize
+    uint8_t* enqueue(size_t length, const CNanoTime &now = CNanoTime());
+    /// \brief drops all queued datagrams
+    void clear();
+    /// \brief sends the queued datagrams that the tokens allow, in order
+    /// \param now the current CLOCK_MONOTONIC time
+    /// \return the number of sent datagrams. When the socket would block the rest stays queued.
+    /// \throws std::runtime_error when OS reports an error.
+    size_t release(const CNanoTime &now);
+    /// \brief sends all queued datagrams now, without waiting for tokens. The tokens go below
+    ///        zero, so the next release waits for the debt.
+    /// \return the number of sent datagrams. When the socket would block the rest stays queued.
+    /// \throws std::runtime_error when OS reports an error.
+    size_t flush();
+    /// \brief returns the moment that release can send the next micro burst, only valid when
+    ///        the queue is not empty
+    CNanoTime getNextSendTime() const;
+
+    /// \brief sets a new rate, the tokens until now are added at the old one
+    /// \throws std::runtime_error when rate is not positive
+    void setRate(double newRate, const CNanoTime &now);
+    /// \brief returns the rate in bytes per second
+    double getRate() const { return rate; }
+    size_t getBurst() const { return burst; }
+
+    /// \brief returns the number of queued datagrams
+    size_t getQueuedCount() const { return count; }
+    /// \brief returns the number of datagrams that still fit in the queue
+    size_t getFreeCount() const { return maxDatagrams - count; }
+    bool isEmpty() const { return count == 0; }
+    /// \brief returns the number of bytes in the queue
+    size_t getQueuedBytes() const { return queuedBytes; }
+    /// \brief returns the number of sent datagrams
+    uint64_t getSentCount() const { return sentCount; }
+    /// \brief returns the number of sent bytes
+    uint64_t getSentBytes() const { return sentBytes; }
+    /// \brief returns the number of sendmmsg calls that sent something
+    uint64_t getBatchCount() const { return batchCount; }
+
+    /// \brief records the queue delay of every sent datagram in recorder, nullptr stops it.
+    ///        flush records up to the now of the last release.
+    void setLatencyRecorder(std::shared_ptr<CLatencyRecorder> recorder);
+
+    static constexpr size_t defaultMaxDatagrams = 4096;
+    /// \brief an Ethernet MTU minus the IPv4 and UDP headers
+    static constexpr size_t defaultMaxDatagramSize = 1500 - 20 - 8;
+    /// \brief the largest number of datagrams sent with one system call
+    static constexpr unsigned int batchSize = 64;
+    /// \brief while datagrams wait, the tokens of a release that is up to this much late are
+    ///        kept (at least a burst)
+    static constexpr CNanoTime maxCatchUp = CNanoTime::fromMsec(1);
+
+private:
+    /// \brief the message headers of a batch, see CPacer.cpp
+    struct SBatch;
+
+    /// \brief returns the multicast address and port of sender
+    static sockaddr_in getMulticastDestination(const CUdpMulticastSender &sender);
+    /// \brief adds the tokens since the last refill
+    void refill(const CNanoTime &now);
+    /// \brief sends the queued datagrams that fit in budget bytes, in batches
+    /// \param now the send time for the latency recorder
+    /// \return the number of sent datagrams
+    size_t sendQueued(double budget, const CNanoTime &now);
+
+    std::shared_ptr<CUdpMulticastSender> sender;
+    double rate;
+    const size_t burst;
+    const size_t maxDatagrams;
+    const size_t maxDatagramSize;
+    /// \brief the queue, a ring of maxDatagrams slots of maxDatagramSize bytes
+    std::vector<uint8_t> buffers;
+    std::vector<size_t> lengths;
+    size_t head;
+    size_t count;
+    size_t queuedBytes;
+    /// \brief in bytes, may be fractional
+    double tokens;
+    CNanoTime lastRefill;
+    bool started;
+    /// \brief true when datagrams were left after the last release
+    bool backlogged;
+    std::unique_ptr<SBatch> batch;
+    std::shared_ptr<CLatencyRecorder> latencyRecorder;
+    /// \brief the enqueue time of every slot, only with a latency recorder
+    std::vector<CNanoTime> enqueueTimes;
+    uint64_t sentCount;
+    uint64_t sentBytes;
+    uint64_t batchCount;
+};
+
+#endif /* CPACER_H */
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CSegmentDirectory.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 8, 2021, 11:15 AM
+ */
+
+#include "CSegmentDirectory.h"
+#include "CMappedFile.h"
+#include <iomanip>
+#include <sstream>
+#include <stdlib.h>
+
+CSegmentNames::CSegmentNames(const std::string &directory, const std::string &prefix) :
+               directory(directory), prefix(prefix)
+{
+}
+
+CSegmentNames::~CSegmentNames()
+{
+}
+
+std::vector<uint64_t> CSegmentNames::list() const
+{
+   std::vector<uint64_t> numbers;
+
+   CMappedFile::makeDirectory(directory);
+   // the names have a fixed width, so their order is the order of the numbers
+   for(const std::string &name : CMappedFile::list(directory, prefix))
+   {
+      char *end = nullptr;
+      const uint64_t number = strtoull(name.c_str() + prefix.size(), &end, 16);
+      if(*end == 0 && end != name.c_str() + prefix.size())
+         numbers.push_back(number);
+   }
+   return numbers;
+}
+
+std::string CSegmentNames::getPath(uint64_t number) const
+{
+   std::ostringstream path;
+
+   path << directory << '/' << prefix << std::hex << std::setw(16) << std::setfill('0')
+        << number;
+   return path.str();
+}
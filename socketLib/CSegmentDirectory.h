@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CSegmentDirectory.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 8, 2021, 11:15 AM
+ */
+
+#ifndef CSEGMENTDIRECTORY_H
+#define CSEGMENTDIRECTORY_H
+
+#include "CMappedFile.h"
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief the start of a record in a segment file, the data follows. Records are aligned on
+///        alignment bytes.
+struct SSegmentRecordHeader {
+    uint64_t sequence;
+    uint32_t length;
+    uint32_t reserved;
+
+    static constexpr size_t alignment = 8;
+    /// \brief returns the size of a record with length bytes of data
+    static size_t getRecordSize(size_t length)
+        { return (sizeof(SSegmentRecordHeader) + length + alignment - 1) & ~(alignment - 1); }
+};
+
+/// \brief The names of the segment files in a directory: prefix followed by the number of the
+///        segment in 16 hex digits, so the names sort in the order of the segments.
+class CSegmentNames {
+public:
+    CSegmentNames(const std::string &directory, const std::string &prefix);
+    virtual ~CSegmentNames();
+
+    /// \brief creates the directory when it doesn't exist and returns the numbers of the
+    ///        segment files in it, in order. Files of which the rest of the name is no number
+    ///        are skipped.
+    /// \throws std::runtime_error when the directory can't be made or read
+    std::vector<uint64_t> list() const;
+    /// \brief returns the path of the segment file with number
+    std::string getPath(uint64_t number) const;
+    const std::string& getDirectory() const { return directory; }
+
+private:
+    const std::string directory;
+    const std::string prefix;
+};
+
+/// \brief The segment files of an append only log in a directory, in order, each a
+///        preallocated CMappedFile of segmentSize bytes (see CSenderJournal and CDeliveryLog).
+///        The next segment file can be made in advance with makeSpare, so starting a segment on
+///        the write path doesn't need system calls.
+///        TSegment is the mapped segment of the log. It has a constructor with the path, the
+///        size and the populate flag of its CMappedFile, a member CMappedFile file, a member
+///        count with its number of records, bool recover() that reads an existing file and
+///        returns false when it was made in advance and never used, and bool follows(const
+///        TSegment &previous) const that returns true when it continues previous.
+template<class TSegment>
+class CSegmentDirectory : public CSegmentNames {
+public:
+    typedef std::deque<std::unique_ptr<TSegment>> TSegments;
+
+    /// \param directory where the segment files are, recover creates it when it doesn't exist
+    /// \param prefix the start of the names of the segment files
+    /// \param segmentSize the size of a new segment file
+    /// \param maxSegments the number of segments that are kept, see removeOldSegments
+    CSegmentDirectory(const std::string &directory, const std::string &prefix,
+                      size_t segmentSize, size_t maxSegments) : CSegmentNames(directory, prefix),
+                      segmentSize(segmentSize), maxSegments(maxSegments), segments(), spare(),
+                      nextNumber(0) {}
+    CSegmentDirectory(const CSegmentDirectory& orig) = delete;
+    CSegmentDirectory& operator=(const CSegmentDirectory& other) = delete;
+    virtual ~CSegmentDirectory() {}
+
+    /// \brief maps the segment files that are in the directory, call it once before the
+    ///        segments are used. Only the last unused one is kept, as the spare. A segment
+    ///        that doesn't follow the one before it was written after a restart without the
+    ///        log, the segments before it are removed.
+    /// \throws std::runtime_error when the directory can't be made or read, a file can't be
+    ///         mapped, or what TSegment::recover throws for a damaged one
+    void recover()
+    {
+        for(uint64_t number : list())
+        {
+            std::unique_ptr<TSegment> segment = open(number, false);
+            nextNumber = number + 1;
+            if(spare)
+            {
+                spare->file.remove();
+                spare.reset();
+            }
+            if(!segment->recover())
+            {
+                spare = std::move(segment);
+                continue;
+            }
+            if(!segments.empty() && !segment->follows(*segments.back()))
+                removeSegments();
+            segments.push_back(std::move(segment));
+        }
+    }
+    /// \brief starts a new segment with the spare, or with a new file when makeSpare wasn't
+    ///        called in time
+    /// \return the new last segment
+    /// \throws std::runtime_error when the file can't be made or mapped
+    TSegment& addSegment()
+    {
+        std::unique_ptr<TSegment> segment = spare ? std::move(spare) : open(nextNumber++, true);
+
+        segments.push_back(std::move(segment));
+        return *segments.back();
+    }
+    /// \brief makes the next segment file in advance, when there is none yet
+    /// \throws std::runtime_error when the file can't be made or mapped
+    void makeSpare()
+    {
+        if(!spare)
+            spare = open(nextNumber++, true);
+    }
+    bool hasSpare() const { return spare != nullptr; }
+    /// \brief removes the oldest segments beyond maxSegments
+    /// \return the number of records in the removed segments
+    /// \throws std::runtime_error when OS reports an error.
+    uint64_t removeOldSegments()
+    {
+        uint64_t removed = 0;
+
+        while(segments.size() > maxSegments)
+        {
+            removed += segments.front()->count;
+            segments.front()->file.remove();
+            segments.pop_front();
+        }
+        return removed;
+    }
+    /// \brief removes all segments, the spare stays
+    /// \throws std::runtime_error when OS reports an error.
+    void removeSegments()
+    {
+        for(std::unique_ptr<TSegment> &segment : segments)
+            segment->file.remove();
+        segments.clear();
+    }
+
+    /// \brief the segments, the oldest first
+    typename TSegments::iterator begin() { return segments.begin(); }
+    typename TSegments::iterator end() { return segments.end(); }
+    typename TSegments::const_iterator begin() const { return segments.begin(); }
+    typename TSegments::const_iterator end() const { return segments.end(); }
+    typename TSegments::reverse_iterator rbegin() { return segments.rbegin(); }
+    typename TSegments::reverse_iterator rend() { return segments.rend(); }
+    const std::unique_ptr<TSegment>& operator[](size_t i) const { return segments[i]; }
+    const std::unique_ptr<TSegment>& front() const { return segments.front(); }
+    const std::unique_ptr<TSegment>& back() const { return segments.back(); }
+    size_t size() const { return segments.size(); }
+    bool empty() const { return segments.empty(); }
+    size_t getSegmentSize() const { return segmentSize; }
+
+private:
+    /// \brief maps the segment file with number, it is created when it doesn't exist
+    std::unique_ptr<TSegment> open(uint64_t number, bool populate) const
+        { return std::unique_ptr<TSegment>(new TSegment(getPath(number), segmentSize, populate)); }
+
+    const size_t segmentSize;
+    const size_t maxSegments;
+    TSegments segments;
+    /// \brief the next segment, made by makeSpare
+    std::unique_ptr<TSegment> spare;
+    uint64_t nextNumber;
+};
+
+#endif /* CSEGMENTDIRECTORY_H */
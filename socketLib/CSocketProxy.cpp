@@ -66,6 +66,17 @@ ssize_t CSocketProxy::recvfrom(int fd, void *buf, size_t len, int flags,
    return ::recvfrom(fd, buf, len, flags, src_addr, addrlen);
 }
 
+int CSocketProxy::recvmmsg(int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags,
+               struct timespec *timeout)
+{
+   return ::recvmmsg(fd, msgvec, vlen, flags, timeout);
+}
+
+int CSocketProxy::sendmmsg(int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags)
+{
+   return ::sendmmsg(fd, msgvec, vlen, flags);
+}
+
 ssize_t CSocketProxy::sendto(int fd, const void *buf, size_t len, int flags,
                const struct sockaddr *dest_addr, socklen_t addrlen)
 {
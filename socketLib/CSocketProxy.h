@@ -47,8 +47,11 @@ public:
     virtual int fcntl(int fd, int cmd, int param);
     virtual ssize_t recvfrom(int fd, void *buf, size_t len, int flags,
                         struct sockaddr *src_addr, socklen_t *addrlen);
+    virtual int recvmmsg(int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags,
+                        struct timespec *timeout);
     virtual ssize_t sendto(int fd, const void *buf, size_t len, int flags,
                         const struct sockaddr *dest_addr, socklen_t addrlen);
+    virtual int sendmmsg(int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags);
     virtual int setsockopt(int fd, int level, int optname, const void *optval, socklen_t optlen);
     virtual int socket(int socket_family, int socket_type, int protocol);
     virtual int pselect(int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds,
@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CTscClock.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 6, 2021, 2:18 PM
+ */
+
+#include "CTscClock.h"
+#include "CClock.h"
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#include <cpuid.h>
+#endif
+
+namespace {
+   // the time between the two samples of the first calibration. A longer time gives a better
+   // initial rate, but delays the construction.
+   const CNanoTime initialCalibrationTime = CNanoTime::fromMsec(5);
+   // number of attempts to read TSC and CLOCK_MONOTONIC close together
+   const int sampleAttempts = 5;
+}
+
+CTscClock::CTscClock(const CNanoTime &recalibrationInterval) : sequence(0), tscBase(0),
+               nsecBase(0), multiplier(0), nextCalibrationTsc(UINT64_MAX), calibrating(),
+               calibrationCount(0), lastSample({0, 0}), interval(recalibrationInterval),
+               intervalTicks(0), tscBased(hasInvariantTsc())
+{
+   calibrating.clear();
+   if(!tscBased)
+      return;
+
+   SSample first = takeSample();
+   SSample second;
+   do
+   {
+      second = takeSample();
+   } while(second.nsec - first.nsec < initialCalibrationTime.getNsec());
+
+   if(second.tsc <= first.tsc)
+   {
+      // the TSC doesn't tick, don't trust it
+      tscBased = false;
+      return;
+   }
+
+   const uint64_t rate = uint64_t((unsigned __int128)(second.nsec - first.nsec) << shift) /
+                                 (second.tsc - first.tsc);
+   intervalTicks = uint64_t(((unsigned __int128)interval.getNsec() << shift) / rate);
+   tscBase.store(second.tsc, std::memory_order_relaxed);
+   nsecBase.store(second.nsec, std::memory_order_relaxed);
+   multiplier.store(rate, std::memory_order_relaxed);
+   nextCalibrationTsc.store(second.tsc + intervalTicks, std::memory_order_release);
+   lastSample = second;
+   calibrationCount.store(1, std::memory_order_relaxed);
+}
+
+CTscClock::~CTscClock()
+{
+}
+
+CNanoTime CTscClock::now()
+{
+   if(!tscBased)
+   {
+      CNanoTime time;
+      return CClock::getMonotonicTime(time);
+   }
+
+   uint32_t seq;
+   uint64_t base, mult, tsc;
+   int64_t nsec;
+
+   for(;;)
+   {
+      // read the conversion parameters consistently (sequence lock reader side)
+      do
+      {
+         seq = sequence.load(std::memory_order_acquire);
+         base = tscBase.load(std::memory_order_relaxed);
+         nsec = nsecBase.load(std::memory_order_relaxed);
+         mult = multiplier.load(std::memory_order_relaxed);
+         std::atomic_thread_fence(std::memory_order_acquire);
+      } while((seq & 1) || (seq != sequence.load(std::memory_order_relaxed)));
+
+      tsc = readTsc();
+      if(tsc < nextCalibrationTsc.load(std::memory_order_relaxed) ||
+         calibrating.test_and_set(std::memory_order_acquire))
+         break;
+
+      // this thread is the one that recalibrates, afterwards read the new parameters
+      calibrate(takeSample());
+      calibrating.clear(std::memory_order_release);
+   }
+
+   // the TSC of another core can be a little behind the base, so the delta is signed
+   const int64_t delta = int64_t(tsc - base);
+   return CNanoTime::fromNsec(nsec + int64_t(((__int128)delta * (__int128)mult) >> shift));
+}
+
+void CTscClock::recalibrate()
+{
+   if(tscBased && !calibrating.test_and_set(std::memory_order_acquire))
+   {
+      calibrate(takeSample());
+      calibrating.clear(std::memory_order_release);
+   }
+}
+
+void CTscClock::calibrate(const CTscClock::SSample &sample)
+{
+   const uint64_t base = tscBase.load(std::memory_order_relaxed);
+   const int64_t nsec = nsecBase.load(std::memory_order_relaxed);
+   const uint64_t mult = multiplier.load(std::memory_order_relaxed);
+
+   if(sample.tsc <= lastSample.tsc)
+      return;
+
+   // the real rate since the previous sample
+   const uint64_t rate = uint64_t((unsigned __int128)(sample.nsec - lastSample.nsec) << shift) /
+                                 (sample.tsc - lastSample.tsc);
+   // where the current parameters say we are, and how far that is off
+   const int64_t predicted = nsec +
+               int64_t(((__int128)int64_t(sample.tsc - base) * (__int128)mult) >> shift);
+   const int64_t error = predicted - sample.nsec;
+   const int64_t maxSlew = interval.getNsec() / 2;
+   int64_t newNsecBase;
+   uint64_t newMultiplier;
+
+   if(error > -maxSlew)
+   {
+      // continue from the predicted time and slew towards CLOCK_MONOTONIC in one interval.
+      // When we are ahead the clock runs at least at half speed, so it never goes backwards.
+      const int64_t correction = (error < maxSlew) ? error : maxSlew;
+      newNsecBase = predicted;
+      newMultiplier = uint64_t((unsigned __int128)rate * uint64_t(interval.getNsec() - correction)
+                               / uint64_t(interval.getNsec()));
+   }
+   else
+   {
+      // far behind (for instance after a suspend), step forward
+      newNsecBase = sample.nsec;
+      newMultiplier = rate;
+   }
+
+   // sequence lock writer side
+   const uint32_t seq = sequence.load(std::memory_order_relaxed);
+   sequence.store(seq + 1, std::memory_order_relaxed);
+   std::atomic_thread_fence(std::memory_order_release);
+   tscBase.store(sample.tsc, std::memory_order_relaxed);
+   nsecBase.store(newNsecBase, std::memory_order_relaxed);
+   multiplier.store(newMultiplier, std::memory_order_relaxed);
+   sequence.store(seq + 2, std::memory_order_release);
+
+   intervalTicks = uint64_t(((unsigned __int128)interval.getNsec() << shift) / rate);
+   nextCalibrationTsc.store(sample.tsc + intervalTicks, std::memory_order_relaxed);
+   lastSample = sample;
+   calibrationCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+CTscClock::SSample CTscClock::takeSample()
+{
+   SSample best = { 0, 0 };
+   uint64_t bestWindow = UINT64_MAX;
+   CNanoTime time;
+
+   // take the sample where the clock_gettime call was the least disturbed
+   for(int i = 0; i < sampleAttempts; i++)
+   {
+      const uint64_t before = readTsc();
+      CClock::getMonotonicTime(time);
+      const uint64_t after = readTsc();
+
+      if(after - before < bestWindow)
+      {
+         bestWindow = after - before;
+         best.tsc = before + bestWindow / 2;
+         best.nsec = time.getNsec();
+      }
+   }
+   return best;
+}
+
+bool CTscClock::hasInvariantTsc()
+{
+#if defined(__x86_64__)
+   unsigned int eax, ebx, ecx, edx;
+
+   if(!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007)
+      return false;
+   if(!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+      return false;
+   // Advanced power management information, EDX bit 8: invariant TSC
+   return (edx & (1u << 8)) != 0;
+#else
+   return false;
+#endif
+}
+
+uint64_t CTscClock::readTsc()
+{
+#if defined(__x86_64__)
+   return __rdtsc();
+#else
+   return 0;
+#endif
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   CTscClock.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 6, 2021, 2:18 PM
+ */
+
+#ifndef CTSCCLOCK_H
+#define CTSCCLOCK_H
+
+#include "CNanoTime.h"
+#include <atomic>
+#include <stdint.h>
+
+/// \brief A monotonic clock that reads the invariant time stamp counter (TSC) of the CPU instead
+///        of calling clock_gettime. The TSC ticks are converted to CLOCK_MONOTONIC nanoseconds
+///        with a calibration that is made at construction and renewed every
+///        recalibrationInterval. A renewed calibration doesn't step the clock, it slews it towards
+///        CLOCK_MONOTONIC in the next interval, so the clock never jumps backwards.
+///        When the CPU has no invariant TSC (or is no x86_64) all calls fall back to
+///        CClock::getMonotonicTime.
+/// \note  now() may be called from several threads. Only one of them will do a recalibration.
+class CTscClock {
+public:
+    CTscClock(const CNanoTime &recalibrationInterval = CNanoTime::fromSec(1));
+    CTscClock(const CTscClock& orig) = delete;
+    CTscClock& operator=(const CTscClock& other) = delete;
+    virtual ~CTscClock();
+
+    /// \brief returns the current CLOCK_MONOTONIC time
+    /// \throws std::runtime_error only in fallback mode, see CClock::getMonotonicTime
+    CNanoTime now();
+
+    /// \brief returns true when the time is derived from the TSC, false when in fallback mode
+    bool isTscBased() const { return tscBased; }
+
+    /// \brief takes a new calibration sample now, instead of waiting for the interval to expire
+    void recalibrate();
+
+    /// \brief returns the number of calibrations done since construction
+    uint64_t getCalibrationCount() const { return calibrationCount.load(std::memory_order_relaxed); }
+
+    /// \brief returns true when the CPU reports an invariant TSC (constant rate in all P, C and
+    ///        T states)
+    static bool hasInvariantTsc();
+
+    /// \brief returns the current TSC value or 0 if there is no TSC
+    static uint64_t readTsc();
+
+private:
+    /// \brief a TSC value with the CLOCK_MONOTONIC time that was read at the same moment
+    struct SSample {
+        uint64_t tsc;
+        int64_t nsec;
+    };
+    static SSample takeSample();
+    void calibrate(const SSample &sample);
+
+    /// \brief the conversion nsec = nsecBase + ((tsc - tscBase) * multiplier) >> shift.
+    ///        Protected by a sequence lock; an odd sequence means a write is in progress.
+    std::atomic<uint32_t> sequence;
+    std::atomic<uint64_t> tscBase;
+    std::atomic<int64_t> nsecBase;
+    std::atomic<uint64_t> multiplier;
+    std::atomic<uint64_t> nextCalibrationTsc;
+    static constexpr int shift = 32;
+
+    std::atomic_flag calibrating;
+    std::atomic<uint64_t> calibrationCount;
+    SSample lastSample;              // only accessed by the thread that holds calibrating
+    const CNanoTime interval;
+    uint64_t intervalTicks;
+    bool tscBased;
+};
+
+#endif /* CTSCCLOCK_H */
@@ -118,13 +118,28 @@ void CUdpMulticastReceiver::open(const in_addr &multicastAddress, int multicastP
 
    for(auto it = interfaces.begin(); it != interfaces.end(); ++it)
    {
-      // Join the multicast group
-      struct ip_mreq_source mcGroup = { 0 };
-      mcGroup.imr_multiaddr.s_addr = multicastAddress.s_addr;
-      mcGroup.imr_sourceaddr.s_addr = sourceAddress.s_addr;
-      mcGroup.imr_interface.s_addr = *it;
+      int result;
 
-      if(proxy->setsockopt(fd, IPPROTO_IP, IP_ADD_SOURCE_MEMBERSHIP, (char *)&mcGroup, sizeof(mcGroup)))
+      // Join the multicast group. A source specific membership with the any address would
+      // only accept datagrams from 0.0.0.0, so without a source join for every source.
+      if(sourceIpAddress->s_addr == INADDR_ANY)
+      {
+         struct ip_mreq mcGroup = { 0 };
+         mcGroup.imr_multiaddr.s_addr = multicastAddress.s_addr;
+         mcGroup.imr_interface.s_addr = *it;
+         result = proxy->setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, (char *)&mcGroup,
+                                    sizeof(mcGroup));
+      }
+      else
+      {
+         struct ip_mreq_source mcGroup = { 0 };
+         mcGroup.imr_multiaddr.s_addr = multicastAddress.s_addr;
+         mcGroup.imr_sourceaddr.s_addr = sourceAddress.s_addr;
+         mcGroup.imr_interface.s_addr = *it;
+         result = proxy->setsockopt(fd, IPPROTO_IP, IP_ADD_SOURCE_MEMBERSHIP, (char *)&mcGroup,
+                                    sizeof(mcGroup));
+      }
+      if(result)
       {
          closeAndThrowRuntimeException("Error joining multicast group");
       }
@@ -164,6 +164,33 @@ size_t CUdpSocket::sendTo(const void *buffer, size_t bufferSize, sockaddr_in *de
    return result;
 }
 
+size_t CUdpSocket::sendBatch(mmsghdr *messages, unsigned int count)
+{
+   int result;
+
+   do
+   {
+      result = proxy->sendmmsg(fd, messages, count, 0);
+   } while(result==-1 && proxy->getErrno() == EINTR);
+
+   if(result == -1)
+   {
+      int errorNbr = proxy->getErrno();
+      if(errorNbr == EAGAIN || errorNbr == EWOULDBLOCK)
+      {
+         result = 0;
+      }
+      else
+      {
+         std::ostringstream message;
+         message << "Error sendmmsg " << errorNbr << ": " << strerror(errorNbr);
+         throw std::runtime_error(message.str());
+      }
+   }
+
+   return size_t(result);
+}
+
 size_t CUdpSocket::receiveFrom(void *buffer, size_t bufferSize, sockaddr_in *source)
 {
    ssize_t result;
@@ -194,6 +221,35 @@ size_t CUdpSocket::receiveFrom(void *buffer, size_t bufferSize, sockaddr_in *sou
    return result;
 }
 
+size_t CUdpSocket::receiveBatch(mmsghdr *messages, unsigned int count)
+{
+   int result;
+
+   // receive until an error is reported except EINTR
+   do
+   {
+      result = proxy->recvmmsg(fd, messages, count, 0, NULL);
+   } while(result==-1 && proxy->getErrno() == EINTR);
+
+   if(result == -1)
+   {
+      int errorNbr = proxy->getErrno();
+
+      if(errorNbr == EAGAIN || errorNbr == EWOULDBLOCK)
+      {
+         result = 0;
+      }
+      else
+      {
+         std::ostringstream message;
+         message << "Error recvmmsg " << errorNbr << ": " << strerror(errorNbr);
+         throw std::runtime_error(message.str());
+      }
+   }
+
+   return size_t(result);
+}
+
 void CUdpSocket::closeAndThrowRuntimeException(const std::string matter)
 {
    int errorNbr = proxy->getErrno();
@@ -31,6 +31,7 @@
 
 struct in_addr;
 struct sockaddr_in;
+struct mmsghdr;
 
 
 class CUdpSocket : public CFileDescriptor {
@@ -86,6 +87,15 @@ public:
     /// \throws std::runtime_error when OS reports an error that cannot be handled.
     size_t sendTo(const void *buffer, size_t bufferSize, sockaddr_in *destination);
 
+    /// \brief sends up to count udp messages with one system call (sendmmsg).
+    /// \param messages the message headers, with the buffers and destination addresses filled
+    ///        in by the caller. msg_len of every sent message is set.
+    /// \param count the number of messages
+    /// \return the number of messages sent, the first ones of messages. If the socket is in non
+    ///         blocking mode and the socket would block then 0 will be returned.
+    /// \throws std::runtime_error when OS reports an error that cannot be handled.
+    size_t sendBatch(mmsghdr *messages, unsigned int count);
+
     /// \brief receives an udp message from the socket.
     /// \param buffer the buffer that receives the message
     /// \param bufferSize, the size of buffer
@@ -95,6 +105,15 @@ public:
     /// \throws std::runtime_error when OS reports an error.
     size_t receiveFrom(void *buffer, size_t bufferSize, sockaddr_in *source);
 
+    /// \brief receives up to count udp messages with one system call (recvmmsg).
+    /// \param messages the message headers, with the buffers (and optionally the source address
+    ///        buffers) filled in by the caller. msg_len of every received message is set.
+    /// \param count the number of messages
+    /// \return the number of messages received. Will be 0 when socket is in non blocking mode and
+    ///         no messages are available.
+    /// \throws std::runtime_error when OS reports an error.
+    size_t receiveBatch(mmsghdr *messages, unsigned int count);
+
     /// \brief helper function that closes the socket and assembles and throws a std::runtime_error
     ///        exception. The what() message is composed from the given matter and the available
     ///        errno. This is meant for error handling when OS reports an error.
@@ -27,6 +27,8 @@
 #include "testCClock.h"
 #include "../CClock.h"
 #include "../CTime.h"
+#include "../CNanoTime.h"
+#include <time.h>
 
 
 CPPUNIT_TEST_SUITE_REGISTRATION(testCClock);
@@ -66,3 +68,46 @@ void testCClock::testGetMonotonicTime()
 //   CTime * const pTime = nullptr;
 //   CPPUNIT_ASSERT_THROW(CClock::getMonotonicTime(*pTime), std::runtime_error);
 }
+
+void testCClock::testGetMonotonicNanoTime()
+{
+   CNanoTime time;
+   CTime timeToCompare;
+   const CNanoTime zeroTime;
+
+   CPPUNIT_ASSERT_EQUAL(zeroTime, time);
+   CPPUNIT_ASSERT_NO_THROW(CClock::getMonotonicTime(time));
+   CPPUNIT_ASSERT_GREATER(zeroTime, time);
+
+   // both variants read the same clock
+   CClock::getMonotonicTime(timeToCompare);
+   CPPUNIT_ASSERT(CNanoTime(timeToCompare) >= time);
+   CPPUNIT_ASSERT(CNanoTime(timeToCompare) - time < CNanoTime::fromSec(1));
+}
+
+void testCClock::testGetMonotonicCoarseTime()
+{
+   CNanoTime coarseTime, preciseTime;
+   const CNanoTime zeroTime;
+
+   CPPUNIT_ASSERT_NO_THROW(CClock::getMonotonicCoarseTime(coarseTime));
+   CClock::getMonotonicTime(preciseTime);
+
+   CPPUNIT_ASSERT_GREATER(zeroTime, coarseTime);
+   // the coarse clock lags at most a kernel tick behind
+   CPPUNIT_ASSERT(coarseTime <= preciseTime);
+   CPPUNIT_ASSERT(preciseTime - coarseTime < CNanoTime::fromMsec(100));
+}
+
+void testCClock::testGetRealTime()
+{
+   CNanoTime realTime;
+   const time_t before = time(nullptr);
+
+   CPPUNIT_ASSERT_NO_THROW(CClock::getRealTime(realTime));
+   const time_t after = time(nullptr);
+
+   // the same clock as time(), in nanoseconds
+   CPPUNIT_ASSERT(realTime.getSec() >= int64_t(before));
+   CPPUNIT_ASSERT(realTime.getSec() <= int64_t(after));
+}
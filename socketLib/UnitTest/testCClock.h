@@ -33,6 +33,9 @@ class testCClock : public CPPUNIT_NS::TestFixture {
     CPPUNIT_TEST_SUITE(testCClock);
 
     CPPUNIT_TEST(testGetMonotonicTime);
+    CPPUNIT_TEST(testGetMonotonicNanoTime);
+    CPPUNIT_TEST(testGetMonotonicCoarseTime);
+    CPPUNIT_TEST(testGetRealTime);
 
     CPPUNIT_TEST_SUITE_END();
 
@@ -44,6 +47,9 @@ public:
 
 private:
     void testGetMonotonicTime();
+    void testGetMonotonicNanoTime();
+    void testGetMonotonicCoarseTime();
+    void testGetRealTime();
 };
 
 #endif /* TESTCCLOCK_H */
@@ -28,6 +28,7 @@
 #include "CSocketTestProxy.h"
 #include "../CFdWaiter.h"
 #include "../CTime.h"
+#include "../CNanoTime.h"
 #include "../CClock.h"
 #include "../CUdpSocket.h"
 #include "../CSocketAddress.h"
@@ -249,3 +250,102 @@ void testCFdWaiter::testWaitUntilThrows()
       testProxy->verifyErrnoInMessage(re.what());
    }
 }
+
+void testCFdWaiter::testWaitUntilNanoTime()
+{
+   CFdWaiter fdWaiter;
+   CNanoTime currentTime;
+
+   // create a test proxy that records the timeout handed over to pselect
+   class CTestProxyPselectTimeout : public CSocketTestProxy
+   {
+   public:
+      virtual int pselect(int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds,
+                          const struct timespec *timeout, const sigset_t *sigmask) override
+      {
+         pselectCnt++;
+         if(pselectCnt==1) firstTimeout = CNanoTime(*timeout);
+         return CSocketProxy::pselect(nfds, readfds, writefds, exceptfds, timeout, sigmask);
+      }
+      CNanoTime firstTimeout;
+   };
+   std::shared_ptr<CTestProxyPselectTimeout> testProxy( new CTestProxyPselectTimeout );
+   fdWaiter.setSocketProxy(testProxy);
+
+   const CNanoTime waitTime = CNanoTime::fromMsec(2);
+   const CNanoTime targetTime = CClock::getMonotonicTime(currentTime) + waitTime;
+   CPPUNIT_ASSERT_EQUAL(true, fdWaiter.waitUntil(targetTime));
+   CPPUNIT_ASSERT_GREATER(targetTime, CClock::getMonotonicTime(currentTime));
+   CPPUNIT_ASSERT(testProxy->pselectCnt >= 1);
+   // the timeout is the remaining time, so never more than the time we wanted to wait
+   CPPUNIT_ASSERT(testProxy->firstTimeout <= waitTime);
+   CPPUNIT_ASSERT_GREATER(CNanoTime(), testProxy->firstTimeout);
+}
+
+void testCFdWaiter::testNow()
+{
+   const struct in_addr localAddress = { inet_addr("127.0.0.1") };
+   CFdWaiter fdWaiter;
+   CUdpSocket udpReceiver, udpSender;
+   CNanoTime currentTime;
+
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(), fdWaiter.now());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), fdWaiter.getClockReadCount());
+   CPPUNIT_ASSERT(CFdWaiter::EClockMode::precise == fdWaiter.getClockMode());
+
+   CPPUNIT_ASSERT_NO_THROW(udpReceiver.openUdpSocket());
+   CPPUNIT_ASSERT_NO_THROW(udpReceiver.bind(localAddress, 7001));
+   CPPUNIT_ASSERT_NO_THROW(udpSender.openUdpSocket());
+   fdWaiter.addReadFileDescriptor(&udpReceiver);
+
+   CSocketAddress sockAddress("127.0.0.1", 7001);
+   const char testMessage[] = "Helloooo . . .";
+   CPPUNIT_ASSERT_EQUAL(sizeof(testMessage),
+           udpSender.sendTo(testMessage, sizeof(testMessage), &sockAddress));
+
+   // first call reads the clock before and after the select
+   const CNanoTime targetTime = CClock::getMonotonicTime(currentTime) + CNanoTime::fromSec(1);
+   CPPUNIT_ASSERT_EQUAL(false, fdWaiter.waitUntil(targetTime));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(2), fdWaiter.getClockReadCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), fdWaiter.getWakeUpCount());
+   CPPUNIT_ASSERT(fdWaiter.now() >= currentTime);
+   CPPUNIT_ASSERT(fdWaiter.now() <= CClock::getMonotonicTime(currentTime));
+
+   // the time spent by the caller doesn't count as waiting, every call reads the clock again
+   const CNanoTime previousNow = fdWaiter.now();
+   CPPUNIT_ASSERT_EQUAL(false, fdWaiter.waitUntil(targetTime));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), fdWaiter.getClockReadCount());
+   CPPUNIT_ASSERT(fdWaiter.now() >= previousNow);
+
+   // now() itself never reads the clock
+   for(int i = 0; i < 10; i++)
+      CPPUNIT_ASSERT_EQUAL(fdWaiter.now(), fdWaiter.now());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), fdWaiter.getClockReadCount());
+
+   fdWaiter.refreshNow();
+   CPPUNIT_ASSERT_EQUAL(uint64_t(5), fdWaiter.getClockReadCount());
+   CPPUNIT_ASSERT(fdWaiter.now() >= previousNow);
+
+   // a moment that passed while the caller was busy is not waited for
+   const timespec busyTime = { 0, 20000000 };
+   const uint64_t wakeUps = fdWaiter.getWakeUpCount();
+   nanosleep(&busyTime, NULL);
+   CPPUNIT_ASSERT_EQUAL(true, fdWaiter.waitUntil(fdWaiter.now() + CNanoTime::fromMsec(10)));
+   CPPUNIT_ASSERT_EQUAL(wakeUps, fdWaiter.getWakeUpCount());
+}
+
+void testCFdWaiter::testCoarseClockMode()
+{
+   CFdWaiter fdWaiter;
+   CNanoTime currentTime;
+
+   fdWaiter.setClockMode(CFdWaiter::EClockMode::coarse);
+   CPPUNIT_ASSERT(CFdWaiter::EClockMode::coarse == fdWaiter.getClockMode());
+
+   const CNanoTime targetTime = CClock::getMonotonicTime(currentTime) + CNanoTime::fromMsec(5);
+   CPPUNIT_ASSERT_EQUAL(true, fdWaiter.waitUntil(targetTime));
+   // the coarse clock is behind the precise clock, so when the coarse clock passed the target
+   // time, the precise clock did too.
+   CPPUNIT_ASSERT(fdWaiter.now() >= targetTime);
+   CPPUNIT_ASSERT_GREATER(targetTime, CClock::getMonotonicTime(currentTime));
+}
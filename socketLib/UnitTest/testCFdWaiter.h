@@ -39,6 +39,9 @@ class testCFdWaiter : public CPPUNIT_NS::TestFixture {
     CPPUNIT_TEST(testWaitUntil);
     CPPUNIT_TEST(testWaitUntilInterrupted);
     CPPUNIT_TEST(testWaitUntilThrows);
+    CPPUNIT_TEST(testWaitUntilNanoTime);
+    CPPUNIT_TEST(testNow);
+    CPPUNIT_TEST(testCoarseClockMode);
 
     CPPUNIT_TEST_SUITE_END();
 
@@ -56,6 +59,9 @@ private:
     void testWaitUntil();
     void testWaitUntilInterrupted();
     void testWaitUntilThrows();
+    void testWaitUntilNanoTime();
+    void testNow();
+    void testCoarseClockMode();
 };
 
 #endif /* TESTCCLOCK_H */
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCLatencyHistogram.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 12, 2021, 5:10 PM
+ */
+
+#include "testCLatencyHistogram.h"
+#include "../CLatencyHistogram.h"
+#include "../CNanoTime.h"
+#include "../CTime.h"
+#include <sstream>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCLatencyHistogram);
+
+testCLatencyHistogram::testCLatencyHistogram()
+{
+}
+
+testCLatencyHistogram::~testCLatencyHistogram()
+{
+}
+
+void testCLatencyHistogram::setUp()
+{
+}
+
+void testCLatencyHistogram::tearDown()
+{
+}
+
+void testCLatencyHistogram::testEmpty()
+{
+   CLatencyHistogram histogram;
+
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), histogram.getTotalCount());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(), histogram.getMin());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(), histogram.getMax());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(), histogram.getMean());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(), histogram.getValueAtPercentile(99.9));
+}
+
+void testCLatencyHistogram::testCountsIndex()
+{
+   // small values are stored exactly
+   for(uint64_t value = 0; value < CLatencyHistogram::subBucketCount; value++)
+   {
+      CPPUNIT_ASSERT_EQUAL(size_t(value), CLatencyHistogram::countsIndex(value));
+      CPPUNIT_ASSERT_EQUAL(value,
+                  CLatencyHistogram::highestValueAtIndex(CLatencyHistogram::countsIndex(value)));
+   }
+
+   // every value is in a bucket whose highest value is within the precision above it
+   size_t previousIndex = 0;
+   for(uint64_t value = 1; value <= CLatencyHistogram::maxTrackableValue; value = value * 3 / 2 + 1)
+   {
+      const size_t index = CLatencyHistogram::countsIndex(value);
+      const uint64_t highest = CLatencyHistogram::highestValueAtIndex(index);
+
+      CPPUNIT_ASSERT(index < CLatencyHistogram::countsLength);
+      CPPUNIT_ASSERT(index >= previousIndex);
+      CPPUNIT_ASSERT(highest >= value);
+      CPPUNIT_ASSERT(highest - value <= value / CLatencyHistogram::subBucketHalfCount);
+      previousIndex = index;
+   }
+   CPPUNIT_ASSERT_EQUAL(CLatencyHistogram::countsLength - 1,
+                        CLatencyHistogram::countsIndex(CLatencyHistogram::maxTrackableValue));
+}
+
+void testCLatencyHistogram::testRecord()
+{
+   CLatencyHistogram histogram;
+
+   histogram.record(CNanoTime::fromUsec(10));
+   histogram.record(CTime(0, 30000));
+   histogram.recordValue(20000, 2);
+
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), histogram.getTotalCount());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromUsec(10), histogram.getMin());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromUsec(30), histogram.getMax());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromUsec(20), histogram.getMean());
+}
+
+void testCLatencyHistogram::testRecordClamped()
+{
+   CLatencyHistogram histogram;
+
+   histogram.record(CNanoTime::fromNsec(-5));
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(), histogram.getMax());
+   histogram.record(CNanoTime::fromSec(3600));
+   CPPUNIT_ASSERT_EQUAL(uint64_t(2), histogram.getTotalCount());
+   CPPUNIT_ASSERT_EQUAL(int64_t(CLatencyHistogram::maxTrackableValue), histogram.getMax().getNsec());
+   CPPUNIT_ASSERT_EQUAL(histogram.getMax(), histogram.getValueAtPercentile(100.0));
+}
+
+void testCLatencyHistogram::testPercentiles()
+{
+   CLatencyHistogram histogram;
+
+   // 1..100 us, so percentile p is at about p us
+   for(int i = 1; i <= 10000; i++)
+      histogram.record(CNanoTime::fromNsec(i * 10));
+
+   const double percentiles[] = { 0.0, 1.0, 50.0, 90.0, 99.0, 99.9, 99.99, 100.0 };
+   for(const double percentile : percentiles)
+   {
+      const double expected = (percentile < 0.01) ? 10.0 : percentile * 1000.0;
+      const double value = double(histogram.getValueAtPercentile(percentile).getNsec());
+
+      std::ostringstream message;
+      message << "p" << percentile << " expected " << expected << " got " << value;
+      CPPUNIT_ASSERT_MESSAGE(message.str(), value >= expected);
+      CPPUNIT_ASSERT_MESSAGE(message.str(), value <= expected * 1.01);
+   }
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromUsec(100), histogram.getValueAtPercentile(100.0));
+
+   std::ostringstream output;
+   histogram.printPercentiles(output);
+   CPPUNIT_ASSERT(output.str().find("count=10000") != std::string::npos);
+   CPPUNIT_ASSERT(output.str().find("p99.99=") != std::string::npos);
+}
+
+void testCLatencyHistogram::testPrecision()
+{
+   CLatencyHistogram histogram;
+
+   // one outlier in a million, p99.99999 must find it, p99.9 not
+   histogram.recordValue(1000, 999999);
+   histogram.record(CNanoTime::fromMsec(25));
+
+   // reported is the highest value of the sub bucket that contains 1000ns
+   const int64_t normal = histogram.getValueAtPercentile(99.9).getNsec();
+   CPPUNIT_ASSERT(normal >= 1000);
+   CPPUNIT_ASSERT(normal <= 1000 + 1000 / int64_t(CLatencyHistogram::subBucketHalfCount));
+   const int64_t outlier = histogram.getValueAtPercentile(99.99999).getNsec();
+   CPPUNIT_ASSERT(outlier <= 25000000);
+   CPPUNIT_ASSERT(outlier >= 25000000 - 25000000 / int64_t(CLatencyHistogram::subBucketHalfCount));
+}
+
+void testCLatencyHistogram::testMerge()
+{
+   CLatencyHistogram histogram1, histogram2;
+
+   histogram1.recordValue(100, 10);
+   histogram2.recordValue(300, 10);
+   histogram2.record(CNanoTime::fromNsec(50));
+
+   histogram1.merge(histogram2);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(21), histogram1.getTotalCount());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromNsec(50), histogram1.getMin());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromNsec(300), histogram1.getMax());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromNsec(100), histogram1.getValueAtPercentile(50.0));
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromNsec(300), histogram1.getValueAtPercentile(60.0));
+
+   // merging an empty histogram changes nothing
+   histogram1.merge(CLatencyHistogram());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(21), histogram1.getTotalCount());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromNsec(50), histogram1.getMin());
+}
+
+void testCLatencyHistogram::testReset()
+{
+   CLatencyHistogram histogram;
+
+   histogram.recordValue(12345, 7);
+   histogram.reset();
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), histogram.getTotalCount());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(), histogram.getMax());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(), histogram.getValueAtPercentile(50.0));
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCLatencyHistogram.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 12, 2021, 5:10 PM
+ */
+
+#ifndef TESTCLATENCYHISTOGRAM_H
+#define TESTCLATENCYHISTOGRAM_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class testCLatencyHistogram : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCLatencyHistogram);
+
+    CPPUNIT_TEST(testEmpty);
+    CPPUNIT_TEST(testCountsIndex);
+    CPPUNIT_TEST(testRecord);
+    CPPUNIT_TEST(testRecordClamped);
+    CPPUNIT_TEST(testPercentiles);
+    CPPUNIT_TEST(testPrecision);
+    CPPUNIT_TEST(testMerge);
+    CPPUNIT_TEST(testReset);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCLatencyHistogram();
+    virtual ~testCLatencyHistogram();
+    void setUp();
+    void tearDown();
+
+private:
+    void testEmpty();
+    void testCountsIndex();
+    void testRecord();
+    void testRecordClamped();
+    void testPercentiles();
+    void testPrecision();
+    void testMerge();
+    void testReset();
+};
+
+#endif /* TESTCLATENCYHISTOGRAM_H */
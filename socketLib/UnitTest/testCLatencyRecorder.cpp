@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCLatencyRecorder.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 12, 2021, 6:45 PM
+ */
+
+#include "testCLatencyRecorder.h"
+#include "../CLatencyRecorder.h"
+#include "../CNanoTime.h"
+#include <thread>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCLatencyRecorder);
+
+testCLatencyRecorder::testCLatencyRecorder()
+{
+}
+
+testCLatencyRecorder::~testCLatencyRecorder()
+{
+}
+
+void testCLatencyRecorder::setUp()
+{
+}
+
+void testCLatencyRecorder::tearDown()
+{
+}
+
+void testCLatencyRecorder::testRecord()
+{
+   CLatencyRecorder recorder;
+
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0), recorder.snapshot().getTotalCount());
+
+   recorder.record(CNanoTime::fromUsec(5));
+   recorder.record(CNanoTime::fromUsec(15));
+   recorder.record(CNanoTime::fromUsec(10));
+
+   const CLatencyHistogram histogram = recorder.snapshot();
+   CPPUNIT_ASSERT_EQUAL(uint64_t(3), histogram.getTotalCount());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromUsec(5), histogram.getMin());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromUsec(15), histogram.getMax());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromUsec(10), histogram.getMean());
+
+   // a snapshot is added to what is already in the histogram
+   CLatencyHistogram merged;
+   merged.recordValue(1, 1);
+   recorder.snapshot(merged);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), merged.getTotalCount());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromNsec(1), merged.getMin());
+}
+
+void testCLatencyRecorder::testSnapshotWhileRecording()
+{
+   const int threads = 4;
+   const uint64_t valuesPerThread = 200000;
+   CLatencyRecorder recorders[threads];
+   std::thread recordingThreads[threads];
+
+   for(int t = 0; t < threads; t++)
+   {
+      recordingThreads[t] = std::thread([&recorders, t]()
+      {
+         for(uint64_t i = 0; i < valuesPerThread; i++)
+            recorders[t].record(CNanoTime::fromNsec(int64_t(100 * (t + 1))));
+      });
+   }
+
+   // snapshots taken while recording must never count more than was recorded
+   for(int i = 0; i < 100; i++)
+   {
+      CLatencyHistogram histogram;
+      for(int t = 0; t < threads; t++)
+         recorders[t].snapshot(histogram);
+      CPPUNIT_ASSERT(histogram.getTotalCount() <= threads * valuesPerThread);
+   }
+
+   for(int t = 0; t < threads; t++)
+      recordingThreads[t].join();
+
+   CLatencyHistogram histogram;
+   for(int t = 0; t < threads; t++)
+      recorders[t].snapshot(histogram);
+   CPPUNIT_ASSERT_EQUAL(threads * valuesPerThread, histogram.getTotalCount());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromNsec(100), histogram.getMin());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromNsec(100 * threads), histogram.getMax());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromNsec(100 * threads), histogram.getValueAtPercentile(99.0));
+}
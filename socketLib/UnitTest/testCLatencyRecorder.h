@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCLatencyRecorder.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 12, 2021, 6:45 PM
+ */
+
+#ifndef TESTCLATENCYRECORDER_H
+#define TESTCLATENCYRECORDER_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class testCLatencyRecorder : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCLatencyRecorder);
+
+    CPPUNIT_TEST(testRecord);
+    CPPUNIT_TEST(testSnapshotWhileRecording);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCLatencyRecorder();
+    virtual ~testCLatencyRecorder();
+    void setUp();
+    void tearDown();
+
+private:
+    void testRecord();
+    void testSnapshotWhileRecording();
+};
+
+#endif /* TESTCLATENCYRECORDER_H */
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCMappedFile.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 6, 2021, 11:05 AM
+ */
+
+#include "testCMappedFile.h"
+#include "../CMappedFile.h"
+#include <stdexcept>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCMappedFile);
+
+testCMappedFile::testCMappedFile()
+{
+}
+
+testCMappedFile::~testCMappedFile()
+{
+}
+
+void testCMappedFile::setUp()
+{
+   char name[] = "/tmp/testCMappedFile-XXXXXX";
+
+   CPPUNIT_ASSERT(mkdtemp(name) != nullptr);
+   directory = name;
+}
+
+void testCMappedFile::tearDown()
+{
+   for(const std::string &name : CMappedFile::list(directory, ""))
+      unlink((directory + "/" + name).c_str());
+   rmdir(directory.c_str());
+}
+
+void testCMappedFile::testCreateAndReopen()
+{
+   const std::string path = directory + "/file";
+   struct stat status;
+   {
+      CMappedFile file(path, 10000);
+      CPPUNIT_ASSERT(file.isCreated());
+      CPPUNIT_ASSERT_EQUAL(size_t(10000), file.getSize());
+      CPPUNIT_ASSERT_EQUAL(path, file.getPath());
+      // a new file is all 0
+      for(size_t i = 0; i < file.getSize(); i++)
+         CPPUNIT_ASSERT_EQUAL(uint8_t(0), file.getData()[i]);
+      memcpy(file.getData() + 9990, "0123456789", 10);
+   }
+   CPPUNIT_ASSERT_EQUAL(0, stat(path.c_str(), &status));
+   CPPUNIT_ASSERT_EQUAL(off_t(10000), status.st_size);
+   // the blocks are reserved
+   CPPUNIT_ASSERT(status.st_blocks * 512 >= 10000);
+
+   // an existing file keeps its size and content
+   CMappedFile file(path, 20000, true);
+   CPPUNIT_ASSERT(!file.isCreated());
+   CPPUNIT_ASSERT_EQUAL(size_t(10000), file.getSize());
+   CPPUNIT_ASSERT_EQUAL(0, memcmp(file.getData() + 9990, "0123456789", 10));
+
+   // the mapping outlives the file
+   file.remove();
+   CPPUNIT_ASSERT(stat(path.c_str(), &status) != 0);
+   file.getData()[0] = 1;
+   CPPUNIT_ASSERT_EQUAL(uint8_t(1), file.getData()[0]);
+}
+
+void testCMappedFile::testFlush()
+{
+   CMappedFile file(directory + "/file", 3 * 4096 + 100);
+
+   file.getData()[5000] = 5;
+   // ranges that don't start at a page are widened, and the end of the file is the end
+   file.flush(5000, 1);
+   file.flush(4095, 2, true);
+   file.flush(3 * 4096, 100, true);
+   file.flush();
+   file.flush(true);
+   // the range ends at the end of the file
+   file.flush(3 * 4096, 1000, true);
+
+   CMappedFile reopened(directory + "/file", 1);
+   // the advice only changes how the pages are read
+   reopened.adviseRandom(4095, 2);
+   reopened.adviseRandom(3 * 4096, 1000);
+   CPPUNIT_ASSERT_EQUAL(uint8_t(5), reopened.getData()[5000]);
+}
+
+void testCMappedFile::testList()
+{
+   CPPUNIT_ASSERT(CMappedFile::list(directory, "").empty());
+   CMappedFile::makeDirectory(directory + "/sub");
+   // already there
+   CMappedFile::makeDirectory(directory + "/sub");
+
+   CMappedFile second(directory + "/sub/journal-2", 100);
+   CMappedFile first(directory + "/sub/journal-1", 100);
+   CMappedFile other(directory + "/sub/other", 100);
+   const std::vector<std::string> names = CMappedFile::list(directory + "/sub", "journal-");
+   CPPUNIT_ASSERT_EQUAL(size_t(2), names.size());
+   CPPUNIT_ASSERT_EQUAL(std::string("journal-1"), names[0]);
+   CPPUNIT_ASSERT_EQUAL(std::string("journal-2"), names[1]);
+
+   first.remove();
+   second.remove();
+   other.remove();
+   rmdir((directory + "/sub").c_str());
+}
+
+void testCMappedFile::testException()
+{
+   CPPUNIT_ASSERT_THROW(CMappedFile(directory + "/missing/file", 100), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CMappedFile(directory + "/empty", 0), std::runtime_error);
+   // a failed creation leaves no file behind
+   CPPUNIT_ASSERT(CMappedFile::list(directory, "").empty());
+   CPPUNIT_ASSERT_THROW(CMappedFile::list(directory + "/missing", ""), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CMappedFile::makeDirectory("/proc/self/missing"), std::runtime_error);
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCMappedFile.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 6, 2021, 11:05 AM
+ */
+
+#ifndef TESTCMAPPEDFILE_H
+#define TESTCMAPPEDFILE_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+class testCMappedFile : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCMappedFile);
+
+    CPPUNIT_TEST(testCreateAndReopen);
+    CPPUNIT_TEST(testFlush);
+    CPPUNIT_TEST(testList);
+    CPPUNIT_TEST(testException);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCMappedFile();
+    virtual ~testCMappedFile();
+    void setUp();
+    void tearDown();
+
+private:
+    void testCreateAndReopen();
+    void testFlush();
+    void testList();
+    void testException();
+
+    /// \brief a new directory for every test
+    std::string directory;
+};
+
+#endif /* TESTCMAPPEDFILE_H */
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCNanoTime.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 2, 2021, 8:30 PM
+ */
+
+#include "testCNanoTime.h"
+#include "../CNanoTime.h"
+#include "../CTime.h"
+#include <sstream>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCNanoTime);
+
+testCNanoTime::testCNanoTime()
+{
+}
+
+testCNanoTime::~testCNanoTime()
+{
+}
+
+void testCNanoTime::setUp()
+{
+}
+
+void testCNanoTime::tearDown()
+{
+}
+
+void testCNanoTime::testConstructor()
+{
+   CNanoTime time;
+   CPPUNIT_ASSERT_EQUAL(int64_t(0), time.getNsec());
+
+   CNanoTime time2(3, 0);
+   CPPUNIT_ASSERT_EQUAL(int64_t(3000000000), time2.getNsec());
+
+   CNanoTime time3(103050709, 987123456);
+   CPPUNIT_ASSERT_EQUAL(int64_t(103050709987123456), time3.getNsec());
+
+   // out of range nano seconds are just added
+   CNanoTime time4(103050709, 1987123456);
+   CPPUNIT_ASSERT_EQUAL(int64_t(103050710987123456), time4.getNsec());
+
+   CNanoTime time5(103050709, -2000123456);
+   CPPUNIT_ASSERT_EQUAL(int64_t(103050706999876544), time5.getNsec());
+
+   CPPUNIT_ASSERT_EQUAL(int64_t(7), CNanoTime::fromNsec(7).getNsec());
+   CPPUNIT_ASSERT_EQUAL(int64_t(7000), CNanoTime::fromUsec(7).getNsec());
+   CPPUNIT_ASSERT_EQUAL(int64_t(7000000), CNanoTime::fromMsec(7).getNsec());
+   CPPUNIT_ASSERT_EQUAL(int64_t(7000000000), CNanoTime::fromSec(7).getNsec());
+   CPPUNIT_ASSERT_EQUAL(int64_t(-7), CNanoTime::fromMsec(-7999).getSec());
+}
+
+void testCNanoTime::testConstexpr()
+{
+   // everything below is evaluated at compile time, so it is enough that it compiles
+   constexpr CNanoTime second = CNanoTime::fromSec(1);
+   constexpr CNanoTime halfSecond = second / 2;
+   constexpr CNanoTime sum = halfSecond + halfSecond * 3;
+   static_assert(sum == CNanoTime(2, 0), "constexpr arithmetic");
+   static_assert(halfSecond < second, "constexpr compare");
+   static_assert((second - sum).toTimespec().tv_sec == -1, "constexpr timespec conversion");
+   static_assert(CNanoTime(std::chrono::milliseconds(3)) == CNanoTime::fromMsec(3),
+                 "constexpr chrono conversion");
+
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(2, 0), sum);
+}
+
+void testCNanoTime::testSubtract()
+{
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(180, 1000), CNanoTime(185, 1000) - CNanoTime(5, 0));
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(183, 999999999), CNanoTime(185, 1000) - CNanoTime(1, 1001));
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(-3, 999999999), CNanoTime(18, 1000) - CNanoTime(20, 1001));
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(1000, 0), CNanoTime(999, 100) - CNanoTime(-1, 100));
+
+   CNanoTime result(185, 1000);
+   result -= CNanoTime(1, 1001);
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(183, 999999999), result);
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromNsec(-5), -CNanoTime::fromNsec(5));
+}
+
+void testCNanoTime::testAdd()
+{
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(2004, 0), CNanoTime(5, 0) + CNanoTime(1999, 0));
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(2005, 111111110),
+                        CNanoTime(5, 123456789) + CNanoTime(1999, 987654321));
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(106, 999999999),
+                        CNanoTime(115, 123456789) + CNanoTime(-9, 876543210));
+
+   CNanoTime result(5, 123456789);
+   result += CNanoTime(-1, 987654321);
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(5, 111111110), result);
+}
+
+void testCNanoTime::testMultiply()
+{
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromUsec(1), CNanoTime::fromNsec(1) * 1000);
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(20000, CNanoTime::nsecInMillisec),
+                        CNanoTime::fromMsec(1) * 20000001);
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(-2, 999000000), CNanoTime::fromMsec(1) * -1001);
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(-10000, 0), CNanoTime::fromMsec(100) * -100000);
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromMsec(250), CNanoTime::fromSec(1) / 4);
+}
+
+void testCNanoTime::testCompare()
+{
+   CPPUNIT_ASSERT(CNanoTime(0, 1) == CNanoTime(0, 1));
+   CPPUNIT_ASSERT(CNanoTime(1, 777) != CNanoTime(1, 776));
+   CPPUNIT_ASSERT(CNanoTime(11, 999999999) < CNanoTime(12, 0));
+   CPPUNIT_ASSERT(CNanoTime(-1000, 17) > CNanoTime(-1000, 16));
+   CPPUNIT_ASSERT(CNanoTime(-5544332211, 0) < CNanoTime(11, 123456789));
+   CPPUNIT_ASSERT(CNanoTime(3, 0) <= CNanoTime(3, 0));
+   CPPUNIT_ASSERT(CNanoTime(3, 0) >= CNanoTime(3, 0));
+   CPPUNIT_ASSERT(!(CNanoTime(3, 0) > CNanoTime(3, 0)));
+}
+
+void testCNanoTime::testTimespecConversion()
+{
+   tstTimespecDataDriven("zero", CNanoTime(), 0, 0);
+   tstTimespecDataDriven("positive", CNanoTime(103050709, 987123456), 103050709, 987123456);
+   tstTimespecDataDriven("negative nsec only", CNanoTime::fromNsec(-1), -1, 999999999);
+   tstTimespecDataDriven("negative whole sec", CNanoTime::fromSec(-3), -3, 0);
+   tstTimespecDataDriven("negative", CNanoTime(-2, -1000), -3, 999999000);
+
+   timespec spec = { 12, 345 };
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(12, 345), CNanoTime(spec));
+}
+
+void testCNanoTime::tstTimespecDataDriven(const std::string testName, const CNanoTime &value,
+                    time_t expectedSec, long expectedNsec)
+{
+   const timespec result = value.toTimespec();
+
+   if((result.tv_sec != expectedSec) || (result.tv_nsec != expectedNsec))
+   {
+      std::ostringstream message;
+      message << testName << ", Result:" << result.tv_sec << "s " << result.tv_nsec
+              << "ns expected:" << expectedSec << "s " << expectedNsec << "ns";
+      CPPUNIT_FAIL(message.str());
+   }
+}
+
+void testCNanoTime::testCTimeConversion()
+{
+   const CTime time(-3, 999999999);
+   const CNanoTime nanoTime(time);
+
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromNsec(-2000000001), nanoTime);
+   CPPUNIT_ASSERT_EQUAL(time, nanoTime.toCTime());
+   CPPUNIT_ASSERT_EQUAL(CTime(103050709, 987123456), CNanoTime(103050709, 987123456).toCTime());
+
+   // both types have to print the same way
+   std::ostringstream timeStream, nanoTimeStream;
+   timeStream << time;
+   nanoTimeStream << nanoTime;
+   CPPUNIT_ASSERT_EQUAL(timeStream.str(), nanoTimeStream.str());
+}
+
+void testCNanoTime::testChronoConversion()
+{
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromMsec(1500), CNanoTime(std::chrono::milliseconds(1500)));
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromSec(120), CNanoTime(std::chrono::minutes(2)));
+   CPPUNIT_ASSERT(std::chrono::microseconds(-42) == CNanoTime::fromUsec(-42).toChrono());
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCNanoTime.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 2, 2021, 8:30 PM
+ */
+
+#ifndef TESTCNANOTIME_H
+#define TESTCNANOTIME_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <time.h>
+class CNanoTime;
+
+class testCNanoTime : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCNanoTime);
+
+    CPPUNIT_TEST(testConstructor);
+    CPPUNIT_TEST(testConstexpr);
+    CPPUNIT_TEST(testSubtract);
+    CPPUNIT_TEST(testAdd);
+    CPPUNIT_TEST(testMultiply);
+    CPPUNIT_TEST(testCompare);
+    CPPUNIT_TEST(testTimespecConversion);
+    CPPUNIT_TEST(testCTimeConversion);
+    CPPUNIT_TEST(testChronoConversion);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCNanoTime();
+    virtual ~testCNanoTime();
+    void setUp();
+    void tearDown();
+
+private:
+    void testConstructor();
+    void testConstexpr();
+    void testSubtract();
+    void testAdd();
+    void testMultiply();
+    void testCompare();
+    void testTimespecConversion();
+    void tstTimespecDataDriven(const std::string testName, const CNanoTime &value,
+                    time_t expectedSec, long expectedNsec);
+    void testCTimeConversion();
+    void testChronoConversion();
+};
+
+#endif /* TESTCNANOTIME_H */
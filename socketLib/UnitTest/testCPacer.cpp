@@ -0,0 +1,343 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCPacer.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 5, 2021, 2:50 PM
+ */
+
+#include "testCPacer.h"
+#include "../CLatencyRecorder.h"
+#include "../CPacer.h"
+#include "../CUdpMulticastSender.h"
+#include "CSocketTestProxy.h"
+#include <netinet/in.h>
+#include <math.h>
+#include <stdexcept>
+#include <vector>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCPacer);
+
+testCPacer::testCPacer()
+{
+}
+
+testCPacer::~testCPacer()
+{
+}
+
+void testCPacer::setUp()
+{
+}
+
+void testCPacer::tearDown()
+{
+}
+
+namespace {
+   /// \brief records the sendmmsg calls instead of sending
+   class CSendmmsgRecorder : public CSocketTestProxy {
+   public:
+      CSendmmsgRecorder() : maxPerCall(UINT32_MAX) {}
+      virtual int sendmmsg(int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags) override
+      {
+         const unsigned int count = std::min(vlen, maxPerCall);
+         batchSizes.push_back(vlen);
+         for(unsigned int i = 0; i < count; i++)
+         {
+            lengths.push_back(msgvec[i].msg_hdr.msg_iov[0].iov_len);
+            firstBytes.push_back(*(uint8_t*)msgvec[i].msg_hdr.msg_iov[0].iov_base);
+            ports.push_back(ntohs(((sockaddr_in*)msgvec[i].msg_hdr.msg_name)->sin_port));
+         }
+         if(count == 0)
+         {
+            Errno = EAGAIN;
+            return -1;
+         }
+         return int(count);
+      }
+
+      std::vector<unsigned int> batchSizes;
+      std::vector<size_t> lengths;
+      std::vector<uint8_t> firstBytes;
+      std::vector<int> ports;
+      unsigned int maxPerCall;
+   };
+
+   std::shared_ptr<CUdpMulticastSender> openSender(std::shared_ptr<CSocketProxy> proxy)
+   {
+      std::shared_ptr<CUdpMulticastSender> sender(new CUdpMulticastSender);
+      sender->setSocketProxy(proxy);
+      sender->open("127.0.0.1", 7890, "127.0.0.1");
+      return sender;
+   }
+
+   const CNanoTime start = CNanoTime::fromSec(100);
+}
+
+void testCPacer::testConstructorException()
+{
+   std::shared_ptr<CUdpMulticastSender> sender = openSender(std::make_shared<CSocketTestProxy>());
+
+   CPPUNIT_ASSERT_THROW(CPacer(sender, 0, 3000), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CPacer(sender, NAN, 3000), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CPacer(sender, 1e6, 1000, 16, 1400), std::runtime_error);
+   CPPUNIT_ASSERT_THROW(CPacer(sender, 1e6, 3000, 0), std::runtime_error);
+   CPacer pacer(sender, 1e6, 3000);
+   CPPUNIT_ASSERT_THROW(pacer.setRate(-1, start), std::runtime_error);
+}
+
+void testCPacer::testEnqueue()
+{
+   CPacer pacer(openSender(std::make_shared<CSocketTestProxy>()), 1e6, 3000, 4, 1000);
+   uint8_t datagram[1001] = { 0 };
+
+   CPPUNIT_ASSERT(pacer.isEmpty());
+   CPPUNIT_ASSERT(!pacer.enqueue(datagram, 1001));
+   for(int i = 0; i < 4; i++)
+      CPPUNIT_ASSERT(pacer.enqueue(datagram, 100 * (i + 1)));
+   CPPUNIT_ASSERT(!pacer.enqueue(datagram, 10));
+   CPPUNIT_ASSERT_EQUAL(size_t(4), pacer.getQueuedCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), pacer.getFreeCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(1000), pacer.getQueuedBytes());
+}
+
+void testCPacer::testRelease()
+{
+   std::shared_ptr<CSendmmsgRecorder> recorder(new CSendmmsgRecorder);
+   CPacer pacer(openSender(recorder), 1e6, 3000, 16, 1000);
+   uint8_t datagram[1000] = { 0 };
+
+   for(int i = 0; i < 10; i++)
+      CPPUNIT_ASSERT(pacer.enqueue(datagram, sizeof(datagram)));
+
+   // the bucket starts full: one micro burst in one call
+   CPPUNIT_ASSERT_EQUAL(size_t(3), pacer.release(start));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), recorder->batchSizes.size());
+   CPPUNIT_ASSERT_EQUAL(3u, recorder->batchSizes[0]);
+   // the next micro burst, 1000 bytes take 1ms
+   CPPUNIT_ASSERT_EQUAL(start + CNanoTime::fromMsec(3), pacer.getNextSendTime());
+   CPPUNIT_ASSERT_EQUAL(size_t(1), pacer.release(start + CNanoTime::fromMsec(1)));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), pacer.release(start + CNanoTime::fromUsec(1999)));
+   CPPUNIT_ASSERT_EQUAL(start + CNanoTime::fromMsec(4), pacer.getNextSendTime());
+   CPPUNIT_ASSERT_EQUAL(size_t(3), pacer.release(start + CNanoTime::fromMsec(4)));
+
+   // a late release catches up, a queue of 3 waits for 3000 bytes
+   CPPUNIT_ASSERT_EQUAL(start + CNanoTime::fromMsec(7), pacer.getNextSendTime());
+   CPPUNIT_ASSERT_EQUAL(size_t(3), pacer.release(start + CNanoTime::fromMsec(8)));
+   CPPUNIT_ASSERT(pacer.isEmpty());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(10), pacer.getSentCount());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(10000), pacer.getSentBytes());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(4), pacer.getBatchCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(10), recorder->lengths.size());
+
+   // a single datagram waits for its own tokens only
+   CPPUNIT_ASSERT(pacer.enqueue(datagram, 500));
+   CPPUNIT_ASSERT_EQUAL(start + CNanoTime::fromMsec(8), pacer.getNextSendTime());
+}
+
+void testCPacer::testBatchSize()
+{
+   std::shared_ptr<CSendmmsgRecorder> recorder(new CSendmmsgRecorder);
+   CPacer pacer(openSender(recorder), 1e9, 100000, 200, 1000);
+   uint8_t datagram[100] = { 0 };
+
+   for(int i = 0; i < 100; i++)
+      CPPUNIT_ASSERT(pacer.enqueue(datagram, sizeof(datagram)));
+   CPPUNIT_ASSERT_EQUAL(size_t(100), pacer.release(start));
+   CPPUNIT_ASSERT_EQUAL(size_t(2), recorder->batchSizes.size());
+   CPPUNIT_ASSERT_EQUAL(CPacer::batchSize, recorder->batchSizes[0]);
+   CPPUNIT_ASSERT_EQUAL(100u - CPacer::batchSize, recorder->batchSizes[1]);
+}
+
+void testCPacer::testIdleBurst()
+{
+   CPacer pacer(openSender(std::make_shared<CSendmmsgRecorder>()), 1e6, 3000, 16, 1000);
+   uint8_t datagram[1000] = { 0 };
+
+   CPPUNIT_ASSERT_EQUAL(size_t(0), pacer.release(start));
+   // a second of idle time gives no more than a burst
+   for(int i = 0; i < 10; i++)
+      CPPUNIT_ASSERT(pacer.enqueue(datagram, sizeof(datagram)));
+   CPPUNIT_ASSERT_EQUAL(size_t(3), pacer.release(start + CNanoTime::fromSec(1)));
+   // while backlogged up to two bursts are kept for a late release
+   CPPUNIT_ASSERT_EQUAL(size_t(6), pacer.release(start + CNanoTime::fromSec(2)));
+}
+
+void testCPacer::testWouldBlock()
+{
+   std::shared_ptr<CSendmmsgRecorder> recorder(new CSendmmsgRecorder);
+   CPacer pacer(openSender(recorder), 1e6, 3000, 16, 1000);
+   uint8_t datagram[1000] = { 0 };
+
+   for(int i = 0; i < 4; i++)
+      CPPUNIT_ASSERT(pacer.enqueue(datagram, sizeof(datagram)));
+   recorder->maxPerCall = 2;
+   CPPUNIT_ASSERT_EQUAL(size_t(2), pacer.release(start));
+   CPPUNIT_ASSERT_EQUAL(size_t(2), pacer.getQueuedCount());
+   recorder->maxPerCall = 0;
+   CPPUNIT_ASSERT_EQUAL(size_t(0), pacer.release(start));
+   // the tokens of the unsent datagram are kept
+   recorder->maxPerCall = 10;
+   CPPUNIT_ASSERT_EQUAL(size_t(1), pacer.release(start));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), pacer.getQueuedCount());
+}
+
+void testCPacer::testSetRate()
+{
+   CPacer pacer(openSender(std::make_shared<CSendmmsgRecorder>()), 1e6, 3000, 16, 1000);
+   uint8_t datagram[1000] = { 0 };
+
+   for(int i = 0; i < 6; i++)
+      CPPUNIT_ASSERT(pacer.enqueue(datagram, sizeof(datagram)));
+   CPPUNIT_ASSERT_EQUAL(size_t(3), pacer.release(start));
+   // 1ms at the old rate, then 2000 bytes take 1ms
+   pacer.setRate(2e6, start + CNanoTime::fromMsec(1));
+   CPPUNIT_ASSERT_DOUBLES_EQUAL(2e6, pacer.getRate(), 0.001);
+   CPPUNIT_ASSERT_EQUAL(start + CNanoTime::fromMsec(2), pacer.getNextSendTime());
+   CPPUNIT_ASSERT_EQUAL(size_t(3), pacer.release(start + CNanoTime::fromMsec(2)));
+}
+
+void testCPacer::testFlush()
+{
+   CPacer pacer(openSender(std::make_shared<CSendmmsgRecorder>()), 1e6, 3000, 16, 1000);
+   uint8_t datagram[1000] = { 0 };
+
+   CPPUNIT_ASSERT_EQUAL(size_t(0), pacer.release(start));
+   for(int i = 0; i < 6; i++)
+      CPPUNIT_ASSERT(pacer.enqueue(datagram, sizeof(datagram)));
+   CPPUNIT_ASSERT_EQUAL(size_t(6), pacer.flush());
+   CPPUNIT_ASSERT(pacer.isEmpty());
+   // the 3000 bytes sent in advance are paid back first
+   CPPUNIT_ASSERT(pacer.enqueue(datagram, sizeof(datagram)));
+   CPPUNIT_ASSERT_EQUAL(start + CNanoTime::fromMsec(4), pacer.getNextSendTime());
+}
+
+void testCPacer::testRateAccuracy()
+{
+   // from 10Mbit/s to 10Gbit/s, with releases that come up to 20us late
+   const double rates[] = { 10e6 / 8, 100e6 / 8, 1e9 / 8, 10e9 / 8 };
+   uint8_t datagram[1400] = { 0 };
+
+   for(double rate : rates)
+   {
+      CPacer pacer(openSender(std::make_shared<CSendmmsgRecorder>()), rate, 64 * 1024, 256, 1400);
+      CNanoTime now = start, lastRelease;
+      uint64_t random = 0x9e3779b97f4a7c15;
+
+      // a full second, the queue never runs empty. The bucket starts with a burst.
+      while(now < start + CNanoTime::fromSec(1))
+      {
+         while(pacer.enqueue(datagram, sizeof(datagram)))
+            ;
+         pacer.release(now);
+         lastRelease = now;
+         random ^= random << 13; random ^= random >> 7; random ^= random << 17;
+         now = std::max(now, pacer.getNextSendTime()) + CNanoTime::fromNsec(random % 20000);
+      }
+      const double achieved = double(pacer.getSentBytes() - 64 * 1024) /
+                              (double((lastRelease - start).getNsec()) * 1e-9);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(rate, achieved, rate * 0.01);
+   }
+}
+
+void testCPacer::testUnicast()
+{
+   std::shared_ptr<CSendmmsgRecorder> recorder(new CSendmmsgRecorder);
+   std::shared_ptr<CUdpMulticastSender> sender = openSender(recorder);
+   sockaddr_in destination = sockaddr_in();
+   destination.sin_family = AF_INET;
+   destination.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+   destination.sin_port = htons(7891);
+   CPacer multicast(sender, 1e6, 3000, 16, 1000);
+   CPacer unicast(sender, destination, 1e6, 3000, 16, 1000);
+   uint8_t datagram[100] = { 0 };
+
+   CPPUNIT_ASSERT_THROW(CPacer(sender, destination, 0, 3000), std::runtime_error);
+
+   // both share the socket of the sender, but have their own destination and tokens
+   CPPUNIT_ASSERT(multicast.enqueue(datagram, sizeof(datagram)));
+   CPPUNIT_ASSERT(unicast.enqueue(datagram, sizeof(datagram)));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), unicast.release(start));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), multicast.release(start));
+   CPPUNIT_ASSERT_EQUAL(size_t(2), recorder->ports.size());
+   CPPUNIT_ASSERT_EQUAL(7891, recorder->ports[0]);
+   CPPUNIT_ASSERT_EQUAL(7890, recorder->ports[1]);
+}
+
+void testCPacer::testClaimAndClear()
+{
+   std::shared_ptr<CSendmmsgRecorder> recorder(new CSendmmsgRecorder);
+   CPacer pacer(openSender(recorder), 1e6, 3000, 4, 1000);
+
+   CPPUNIT_ASSERT(pacer.enqueue(1001) == nullptr);
+   for(int i = 0; i < 4; i++)
+   {
+      uint8_t *slot = pacer.enqueue(100);
+      CPPUNIT_ASSERT(slot != nullptr);
+      slot[0] = uint8_t(i);
+   }
+   CPPUNIT_ASSERT(pacer.enqueue(1) == nullptr);
+   CPPUNIT_ASSERT_EQUAL(size_t(400), pacer.getQueuedBytes());
+
+   // the queue is dropped, not sent
+   pacer.clear();
+   CPPUNIT_ASSERT(pacer.isEmpty());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), pacer.getQueuedBytes());
+   CPPUNIT_ASSERT_EQUAL(size_t(4), pacer.getFreeCount());
+   CPPUNIT_ASSERT_EQUAL(size_t(0), pacer.release(start));
+   CPPUNIT_ASSERT(recorder->lengths.empty());
+
+   // the slots are reused in order
+   for(int i = 0; i < 3; i++)
+      pacer.enqueue(50)[0] = uint8_t(10 + i);
+   CPPUNIT_ASSERT_EQUAL(size_t(3), pacer.release(start + CNanoTime::fromMsec(1)));
+   CPPUNIT_ASSERT_EQUAL(size_t(3), recorder->firstBytes.size());
+   for(int i = 0; i < 3; i++)
+      CPPUNIT_ASSERT_EQUAL(uint8_t(10 + i), recorder->firstBytes[i]);
+}
+
+void testCPacer::testLatencyRecorder()
+{
+   CPacer pacer(openSender(std::make_shared<CSendmmsgRecorder>()), 1e6, 3000, 16, 1000);
+   std::shared_ptr<CLatencyRecorder> latency(new CLatencyRecorder);
+   uint8_t datagram[1000] = { 0 };
+
+   pacer.setLatencyRecorder(latency);
+   for(int i = 0; i < 4; i++)
+      CPPUNIT_ASSERT(pacer.enqueue(datagram, sizeof(datagram), start));
+   CPPUNIT_ASSERT_EQUAL(size_t(3), pacer.release(start));
+   CPPUNIT_ASSERT(pacer.enqueue(datagram, sizeof(datagram), start + CNanoTime::fromMsec(1)));
+   // the tokens of 2ms send the one that waited since start and the one of 1ms later
+   CPPUNIT_ASSERT_EQUAL(size_t(2), pacer.release(start + CNanoTime::fromMsec(2)));
+
+   const CLatencyHistogram histogram = latency->snapshot();
+   CPPUNIT_ASSERT_EQUAL(uint64_t(5), histogram.getTotalCount());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(), histogram.getMin());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime::fromMsec(2), histogram.getMax());
+
+   // flush counts until the last release
+   CPPUNIT_ASSERT(pacer.enqueue(datagram, sizeof(datagram), start + CNanoTime::fromMsec(2)));
+   CPPUNIT_ASSERT_EQUAL(size_t(1), pacer.flush());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(6), latency->snapshot().getTotalCount());
+   CPPUNIT_ASSERT_EQUAL(CNanoTime(), latency->snapshot().getMin());
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCPacer.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 5, 2021, 2:50 PM
+ */
+
+#ifndef TESTCPACER_H
+#define TESTCPACER_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class testCPacer : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCPacer);
+
+    CPPUNIT_TEST(testConstructorException);
+    CPPUNIT_TEST(testEnqueue);
+    CPPUNIT_TEST(testRelease);
+    CPPUNIT_TEST(testBatchSize);
+    CPPUNIT_TEST(testIdleBurst);
+    CPPUNIT_TEST(testWouldBlock);
+    CPPUNIT_TEST(testSetRate);
+    CPPUNIT_TEST(testFlush);
+    CPPUNIT_TEST(testRateAccuracy);
+    CPPUNIT_TEST(testUnicast);
+    CPPUNIT_TEST(testClaimAndClear);
+    CPPUNIT_TEST(testLatencyRecorder);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCPacer();
+    virtual ~testCPacer();
+    void setUp();
+    void tearDown();
+
+private:
+    void testConstructorException();
+    void testEnqueue();
+    void testRelease();
+    void testBatchSize();
+    void testIdleBurst();
+    void testWouldBlock();
+    void testSetRate();
+    void testFlush();
+    void testRateAccuracy();
+    void testUnicast();
+    void testClaimAndClear();
+    void testLatencyRecorder();
+};
+
+#endif /* TESTCPACER_H */
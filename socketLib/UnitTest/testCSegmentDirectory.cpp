@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCSegmentDirectory.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 8, 2021, 11:15 AM
+ */
+
+#include "testCSegmentDirectory.h"
+#include "../CMappedFile.h"
+#include "../CSegmentDirectory.h"
+#include <stdexcept>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCSegmentDirectory);
+
+namespace {
+   const size_t segmentSize = 4096;
+
+   /// \brief a segment with its number of records in byte 0 and 1 in byte 1 when it doesn't
+   ///        follow the one before it
+   struct SSegment {
+      SSegment(const std::string &path, size_t size, bool populate)
+            : file(path, size, populate), count(0) {}
+
+      bool recover()
+      {
+         count = file.getData()[0];
+         return count > 0;
+      }
+      bool follows(const SSegment &) const { return file.getData()[1] == 0; }
+
+      CMappedFile file;
+      uint64_t count;
+   };
+
+   /// \brief makes the segment file with number, with count records
+   void makeSegment(const CSegmentNames &names, uint64_t number, uint8_t count,
+                    bool follows = true)
+   {
+      CMappedFile file(names.getPath(number), segmentSize);
+      file.getData()[0] = count;
+      file.getData()[1] = follows ? 0 : 1;
+   }
+}
+
+testCSegmentDirectory::testCSegmentDirectory()
+{
+}
+
+testCSegmentDirectory::~testCSegmentDirectory()
+{
+}
+
+void testCSegmentDirectory::setUp()
+{
+   char name[] = "/tmp/testCSegmentDirectory-XXXXXX";
+
+   CPPUNIT_ASSERT(mkdtemp(name) != nullptr);
+   directory = name;
+}
+
+void testCSegmentDirectory::tearDown()
+{
+   for(const std::string &name : CMappedFile::list(directory, ""))
+      unlink((directory + "/" + name).c_str());
+   rmdir(directory.c_str());
+}
+
+void testCSegmentDirectory::testNames()
+{
+   const CSegmentNames names(directory + "/sub", "seg-");
+
+   CPPUNIT_ASSERT_EQUAL(directory + "/sub/seg-00000000000000ab", names.getPath(0xab));
+   // list makes the directory
+   CPPUNIT_ASSERT(names.list().empty());
+   CMappedFile(names.getPath(0x10), segmentSize);
+   CMappedFile(names.getPath(0x2), segmentSize);
+   CMappedFile(directory + "/sub/seg-x", segmentSize);
+   CMappedFile(directory + "/sub/seg-", segmentSize);
+   CMappedFile(directory + "/sub/other-0000000000000001", segmentSize);
+
+   const std::vector<uint64_t> numbers = names.list();
+   CPPUNIT_ASSERT_EQUAL(size_t(2), numbers.size());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0x2), numbers[0]);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(0x10), numbers[1]);
+
+   for(const std::string &name : CMappedFile::list(directory + "/sub", ""))
+      unlink((directory + "/sub/" + name).c_str());
+   rmdir((directory + "/sub").c_str());
+}
+
+void testCSegmentDirectory::testRecover()
+{
+   CSegmentDirectory<SSegment> segments(directory, "seg-", segmentSize, 4);
+
+   makeSegment(segments, 0, 1);
+   makeSegment(segments, 1, 0);
+   // 2 doesn't follow 0, so 0 goes
+   makeSegment(segments, 2, 2, false);
+   makeSegment(segments, 3, 3);
+   makeSegment(segments, 4, 0);
+   makeSegment(segments, 5, 0);
+
+   segments.recover();
+   CPPUNIT_ASSERT_EQUAL(size_t(2), segments.size());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(2), segments.front()->count);
+   CPPUNIT_ASSERT_EQUAL(uint64_t(3), segments.back()->count);
+   // only the last unused segment is kept, as the spare
+   CPPUNIT_ASSERT(segments.hasSpare());
+   const std::vector<uint64_t> numbers = segments.list();
+   CPPUNIT_ASSERT_EQUAL(size_t(3), numbers.size());
+   CPPUNIT_ASSERT_EQUAL(uint64_t(5), numbers[2]);
+}
+
+void testCSegmentDirectory::testAddAndRemove()
+{
+   CSegmentDirectory<SSegment> segments(directory, "seg-", segmentSize, 2);
+
+   segments.recover();
+   CPPUNIT_ASSERT(segments.empty());
+   CPPUNIT_ASSERT(!segments.hasSpare());
+
+   // without a spare the file is made at once
+   segments.addSegment().count = 1;
+   segments.makeSpare();
+   CPPUNIT_ASSERT(segments.hasSpare());
+   CPPUNIT_ASSERT_EQUAL(segments.getPath(1), segments.addSegment().file.getPath());
+   CPPUNIT_ASSERT(!segments.hasSpare());
+   segments.back()->count = 2;
+   segments.addSegment().count = 3;
+   CPPUNIT_ASSERT_EQUAL(size_t(3), segments.size());
+
+   // the oldest beyond maxSegments go, with their records
+   CPPUNIT_ASSERT_EQUAL(uint64_t(1), segments.removeOldSegments());
+   CPPUNIT_ASSERT_EQUAL(size_t(2), segments.size());
+   CPPUNIT_ASSERT_EQUAL(size_t(2), segments.list().size());
+
+   segments.removeSegments();
+   CPPUNIT_ASSERT(segments.empty());
+   CPPUNIT_ASSERT(segments.list().empty());
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCSegmentDirectory.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on July 8, 2021, 11:15 AM
+ */
+
+#ifndef TESTCSEGMENTDIRECTORY_H
+#define TESTCSEGMENTDIRECTORY_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+class testCSegmentDirectory : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCSegmentDirectory);
+
+    CPPUNIT_TEST(testNames);
+    CPPUNIT_TEST(testRecover);
+    CPPUNIT_TEST(testAddAndRemove);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCSegmentDirectory();
+    virtual ~testCSegmentDirectory();
+    void setUp();
+    void tearDown();
+
+private:
+    void testNames();
+    void testRecover();
+    void testAddAndRemove();
+
+    /// \brief a new directory for every test
+    std::string directory;
+};
+
+#endif /* TESTCSEGMENTDIRECTORY_H */
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCTscClock.cpp
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 6, 2021, 4:40 PM
+ */
+
+#include "testCTscClock.h"
+#include "../CTscClock.h"
+#include "../CClock.h"
+#include "../CNanoTime.h"
+#include <sstream>
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testCTscClock);
+
+namespace {
+   // maximum allowed difference between the TSC clock and CLOCK_MONOTONIC. Generous, because a
+   // test machine (or virtual machine) can be interrupted between two clock reads.
+   const CNanoTime maxDeviation = CNanoTime::fromUsec(500);
+}
+
+testCTscClock::testCTscClock()
+{
+}
+
+testCTscClock::~testCTscClock()
+{
+}
+
+void testCTscClock::setUp()
+{
+}
+
+void testCTscClock::tearDown()
+{
+}
+
+void testCTscClock::testNow()
+{
+   CTscClock clock;
+   CNanoTime before, after;
+
+   CClock::getMonotonicTime(before);
+   const CNanoTime time = clock.now();
+   CClock::getMonotonicTime(after);
+
+   CPPUNIT_ASSERT(time > before - maxDeviation);
+   CPPUNIT_ASSERT(time < after + maxDeviation);
+   CPPUNIT_ASSERT_EQUAL(CTscClock::hasInvariantTsc(), clock.isTscBased());
+   if(clock.isTscBased())
+   {
+      CPPUNIT_ASSERT_EQUAL(uint64_t(1), clock.getCalibrationCount());
+      CPPUNIT_ASSERT(CTscClock::readTsc() != 0);
+   }
+}
+
+void testCTscClock::testMonotonic()
+{
+   // a short interval, so some recalibrations happen during the test
+   CTscClock clock(CNanoTime::fromMsec(1));
+   CNanoTime previous = clock.now();
+
+   for(int i = 0; i < 1000000; i++)
+   {
+      const CNanoTime time = clock.now();
+      if(time < previous)
+      {
+         std::ostringstream message;
+         message << "clock went backwards at " << i << " from " << previous << " to " << time;
+         CPPUNIT_FAIL(message.str());
+      }
+      previous = time;
+   }
+}
+
+void testCTscClock::testDrift()
+{
+   CTscClock clock(CNanoTime::fromMsec(10));
+   CNanoTime start, before, after;
+   CNanoTime maxDifference;
+
+   // compare both clocks during 200ms, with several recalibrations in between. The fast time is
+   // read between two monotonic reads, so a preemption between the reads doesn't count as drift.
+   CClock::getMonotonicTime(start);
+   do
+   {
+      CClock::getMonotonicTime(before);
+      const CNanoTime fast = clock.now();
+      CClock::getMonotonicTime(after);
+
+      CNanoTime difference;
+      if(fast < before)
+         difference = before - fast;
+      else if(fast > after)
+         difference = fast - after;
+      if(difference > maxDifference)
+         maxDifference = difference;
+   } while(after - start < CNanoTime::fromMsec(200));
+
+   std::ostringstream message;
+   message << "max difference " << maxDifference;
+   CPPUNIT_ASSERT_MESSAGE(message.str(), maxDifference < maxDeviation);
+   if(clock.isTscBased())
+      CPPUNIT_ASSERT(clock.getCalibrationCount() > 10);
+}
+
+void testCTscClock::testRecalibrate()
+{
+   CTscClock clock(CNanoTime::fromSec(100));
+   const uint64_t count = clock.getCalibrationCount();
+
+   clock.recalibrate();
+   if(clock.isTscBased())
+      CPPUNIT_ASSERT_EQUAL(count + 1, clock.getCalibrationCount());
+   else
+      CPPUNIT_ASSERT_EQUAL(count, clock.getCalibrationCount());
+
+   CNanoTime monotonic;
+   const CNanoTime fast = clock.now();
+   CClock::getMonotonicTime(monotonic);
+   CPPUNIT_ASSERT(fast < monotonic + maxDeviation);
+   CPPUNIT_ASSERT(fast > monotonic - maxDeviation);
+}
+
+void testCTscClock::testGetFastMonotonicTime()
+{
+   CNanoTime fast, monotonic;
+
+   CPPUNIT_ASSERT_NO_THROW(CClock::getFastMonotonicTime(fast));
+   CClock::getMonotonicTime(monotonic);
+   CPPUNIT_ASSERT(fast < monotonic + maxDeviation);
+   CPPUNIT_ASSERT(fast > monotonic - maxDeviation);
+   CPPUNIT_ASSERT_EQUAL(CTscClock::hasInvariantTsc(), CClock::isFastMonotonicTimeTscBased());
+}
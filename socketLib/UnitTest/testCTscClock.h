@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2021 G.J. Westeneng (Gerald Westeneng)
+ *
+ * This file is part of RMDGP. Reliable Multicast DataGram Protocol
+ *
+ * RMDGP is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * RMDGP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RMDGP.   If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * File:   testCTscClock.h
+ * Author: G.J. Westeneng (Gerald Westeneng)
+ *
+ * Created on June 6, 2021, 4:40 PM
+ */
+
+#ifndef TESTCTSCCLOCK_H
+#define TESTCTSCCLOCK_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class testCTscClock : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(testCTscClock);
+
+    CPPUNIT_TEST(testNow);
+    CPPUNIT_TEST(testMonotonic);
+    CPPUNIT_TEST(testDrift);
+    CPPUNIT_TEST(testRecalibrate);
+    CPPUNIT_TEST(testGetFastMonotonicTime);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    testCTscClock();
+    virtual ~testCTscClock();
+    void setUp();
+    void tearDown();
+
+private:
+    void testNow();
+    void testMonotonic();
+    void testDrift();
+    void testRecalibrate();
+    void testGetFastMonotonicTime();
+};
+
+#endif /* TESTCTSCCLOCK_H */
@@ -152,6 +152,46 @@ public:
    }
 };
 
+class CTestProxyMembership : public CSocketTestProxy
+{
+public:
+   int membershipCnt = 0;
+   int sourceMembershipCnt = 0;
+
+   virtual int setsockopt(int fd, int level, int optname, const void *optval, socklen_t optlen)
+      override
+   {
+      if(optname==IP_ADD_MEMBERSHIP)
+         membershipCnt++;
+      if(optname==IP_ADD_SOURCE_MEMBERSHIP)
+         sourceMembershipCnt++;
+      return CSocketTestProxy::setsockopt(fd, level, optname, optval, optlen);
+   }
+};
+
+}
+
+void testCUdpMulticastReceiver::testOpenAnySource()
+{
+   std::shared_ptr<CTestProxyMembership> testProxy(new CTestProxyMembership);
+
+   // a source filter with the any address would receive nothing, every source is accepted
+   {
+      CUdpMulticastReceiver udpMulticastReceiver;
+      udpMulticastReceiver.setSocketProxy(testProxy);
+      CPPUNIT_ASSERT_NO_THROW(udpMulticastReceiver.open("225.1.1.1", 7000, "0.0.0.0"));
+   }
+   CPPUNIT_ASSERT(testProxy->membershipCnt > 0);
+   CPPUNIT_ASSERT_EQUAL(0, testProxy->sourceMembershipCnt);
+
+   testProxy->membershipCnt = 0;
+   {
+      CUdpMulticastReceiver udpMulticastReceiver;
+      udpMulticastReceiver.setSocketProxy(testProxy);
+      CPPUNIT_ASSERT_NO_THROW(udpMulticastReceiver.open("225.1.1.1", 7000, "127.0.0.1"));
+   }
+   CPPUNIT_ASSERT_EQUAL(0, testProxy->membershipCnt);
+   CPPUNIT_ASSERT_EQUAL(1, testProxy->sourceMembershipCnt);
 }
 
 void testCUdpMulticastReceiver::testOpenThrow()
@@ -40,6 +40,7 @@ class testCUdpMulticastReceiver : public CPPUNIT_NS::TestFixture {
     CPPUNIT_TEST(testDestructor);
     CPPUNIT_TEST(testOpen);
     CPPUNIT_TEST(testOpenThrow);
+    CPPUNIT_TEST(testOpenAnySource);
     CPPUNIT_TEST(testReceive);
     CPPUNIT_TEST(testReceiveThrow);
     CPPUNIT_TEST(testGetSourcePortNumber);
@@ -59,6 +60,7 @@ private:
     void testDestructor();
     void testOpen();
     void testOpenThrow();
+    void testOpenAnySource();
     void tstOpenThrowDataDriven(const std::string testName,
                                 const std::string multicastAddress, int multicastPort,
                                 const std::string sourceAddress, int sourcePort,
@@ -416,3 +416,95 @@ void testCUdpSocket::testGetLocalSockAddress()
    //  tested at tstBindDataDriven
    CPPUNIT_ASSERT(true);
 }
+
+void testCUdpSocket::testReceiveBatch()
+{
+   const struct in_addr localAddress = { inet_addr("127.0.0.1") };
+   CSocketAddress destination("127.0.0.1", 7779); // encapsulates sockaddr_in
+   CTime waitTime(0,1000);
+   CUdpSocket udpSocket;
+   CUdpSocket udpReceiver;
+   const unsigned int batchSize = 4;
+   char buffers[batchSize][64];
+   iovec vectors[batchSize];
+   sockaddr_in sources[batchSize];
+   mmsghdr messages[batchSize];
+
+   for(unsigned int i = 0; i < batchSize; i++)
+   {
+      vectors[i] = { buffers[i], sizeof(buffers[i]) };
+      messages[i] = mmsghdr();
+      messages[i].msg_hdr.msg_iov = &vectors[i];
+      messages[i].msg_hdr.msg_iovlen = 1;
+      messages[i].msg_hdr.msg_name = &sources[i];
+      messages[i].msg_hdr.msg_namelen = sizeof(sources[i]);
+   }
+
+   CPPUNIT_ASSERT_THROW(udpReceiver.receiveBatch(messages, batchSize), std::runtime_error);
+   CPPUNIT_ASSERT_NO_THROW(udpReceiver.openUdpSocket());
+   CPPUNIT_ASSERT_NO_THROW(udpReceiver.bind(localAddress, 7779));
+   CPPUNIT_ASSERT_NO_THROW(udpReceiver.setNonBlocking());
+   CPPUNIT_ASSERT_NO_THROW(udpSocket.openUdpSocket());
+
+   // nothing available
+   CPPUNIT_ASSERT_EQUAL(size_t(0), udpReceiver.receiveBatch(messages, batchSize));
+
+   for(int i = 0; i < 6; i++)
+      CPPUNIT_ASSERT_NO_THROW(udpSocket.sendTo(testMessage, sizeof(testMessage) - i, &destination));
+
+   nanosleep(&waitTime, NULL); // give upd/ip stack some time
+
+   CPPUNIT_ASSERT_EQUAL(size_t(batchSize), udpReceiver.receiveBatch(messages, batchSize));
+   for(unsigned int i = 0; i < batchSize; i++)
+   {
+      CPPUNIT_ASSERT_EQUAL(unsigned(sizeof(testMessage) - i), messages[i].msg_len);
+      CPPUNIT_ASSERT_EQUAL(localAddress.s_addr, sources[i].sin_addr.s_addr);
+   }
+   CPPUNIT_ASSERT_EQUAL(size_t(2), udpReceiver.receiveBatch(messages, batchSize));
+   CPPUNIT_ASSERT_EQUAL(unsigned(sizeof(testMessage) - 5), messages[1].msg_len);
+}
+
+void testCUdpSocket::testSendBatch()
+{
+   const struct in_addr localAddress = { inet_addr("127.0.0.1") };
+   CSocketAddress destinations[2] = { CSocketAddress("127.0.0.1", 7779),
+                                      CSocketAddress("127.0.0.1", 7778) };
+   CTime waitTime(0,1000);
+   CUdpSocket udpSocket;
+   CUdpSocket udpReceivers[2];
+   const unsigned int batchSize = 4;
+   iovec vectors[batchSize];
+   mmsghdr messages[batchSize];
+   char buffer[64];
+   sockaddr_in source;
+
+   // every message has its own length and destination
+   for(unsigned int i = 0; i < batchSize; i++)
+   {
+      vectors[i] = { (void*)testMessage, sizeof(testMessage) - i };
+      messages[i] = mmsghdr();
+      messages[i].msg_hdr.msg_iov = &vectors[i];
+      messages[i].msg_hdr.msg_iovlen = 1;
+      messages[i].msg_hdr.msg_name = static_cast<sockaddr_in*>(&destinations[i % 2]);
+      messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+   }
+
+   CPPUNIT_ASSERT_THROW(udpSocket.sendBatch(messages, batchSize), std::runtime_error);
+   for(int i = 0; i < 2; i++)
+   {
+      CPPUNIT_ASSERT_NO_THROW(udpReceivers[i].openUdpSocket());
+      CPPUNIT_ASSERT_NO_THROW(udpReceivers[i].bind(localAddress, i == 0 ? 7779 : 7778));
+      CPPUNIT_ASSERT_NO_THROW(udpReceivers[i].setNonBlocking());
+   }
+   CPPUNIT_ASSERT_NO_THROW(udpSocket.openUdpSocket());
+
+   CPPUNIT_ASSERT_EQUAL(size_t(batchSize), udpSocket.sendBatch(messages, batchSize));
+   CPPUNIT_ASSERT_EQUAL(unsigned(sizeof(testMessage) - 1), messages[1].msg_len);
+
+   nanosleep(&waitTime, NULL); // give upd/ip stack some time
+
+   for(unsigned int i = 0; i < batchSize; i++)
+      CPPUNIT_ASSERT_EQUAL(size_t(sizeof(testMessage) - i),
+                           udpReceivers[i % 2].receiveFrom(buffer, sizeof(buffer), &source));
+   CPPUNIT_ASSERT_EQUAL(size_t(0), udpReceivers[0].receiveFrom(buffer, sizeof(buffer), &source));
+}
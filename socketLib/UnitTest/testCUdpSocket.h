@@ -50,6 +50,8 @@ class testCUdpSocket : public CPPUNIT_NS::TestFixture {
     CPPUNIT_TEST(testReceiveFromWouldBlock);
 
     CPPUNIT_TEST(testGetLocalSockAddress);
+    CPPUNIT_TEST(testReceiveBatch);
+    CPPUNIT_TEST(testSendBatch);
 
     CPPUNIT_TEST_SUITE_END();
 
@@ -78,6 +80,8 @@ private:
     void testReceiveFromInterrupted();
     void testReceiveFromWouldBlock();
     void testGetLocalSockAddress();
+    void testReceiveBatch();
+    void testSendBatch();
 };
 
 #endif /* TESTCUDPSOCKET_H */
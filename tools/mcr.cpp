@@ -25,18 +25,21 @@
  */
 
 #include "../socketLib/CUdpMulticastReceiver.h"
+#include "../socketLib/CLatencyRecorder.h"
+#include "../socketLib/CNanoTime.h"
 //#include "../socketLib/CFdWaiter.h"
 //#include "../socketLib/CTime.h"
-//#include "../socketLib/CClock.h"
+#include "../socketLib/CClock.h"
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <stdint.h>
 
 int main(int argc, char** argv)
 {
    if(argc < 4)
    {
-      std::cout << "usage: mcr mulicast_address multicast_port source_address\n";
+      std::cout << "usage: mcr mulicast_address multicast_port source_address [count]\n";
       exit(1);
    }
    CUdpMulticastReceiver receiver;
@@ -45,7 +48,13 @@ int main(int argc, char** argv)
 
    std::istringstream multicastPortSS(argv[2]);
    int mcPort;
+   int count = 1;
    multicastPortSS >> mcPort;
+   if(argc > 4)
+   {
+      std::istringstream countSS(argv[4]);
+      countSS >> count;
+   }
 
    try
    {
@@ -60,10 +69,36 @@ int main(int argc, char** argv)
 //      waiter.addReadFileDescriptor(&receiver);
 //      waiter.waitUntil( CClock::getMonotonicTime(currentTime) + minute );
 
+      CLatencyRecorder deliveryLatency;
+
       std::cout << "Start receiving\n";
-      char buffer[256] = {0};
-      int result = receiver.receive(buffer, sizeof(buffer));
-      std::cout << "result=" << result << " received:'" << buffer << "'" << std::endl;
+      for(int i = 0; i < count; i++)
+      {
+         uint8_t buffer[256] = {0};
+         const size_t result = receiver.receive(buffer, sizeof(buffer) - 1);
+         CNanoTime deliveryTime;
+         CClock::getRealTime(deliveryTime);
+         if(result < sizeof(uint64_t))
+         {
+            std::cout << "result=" << result << " without send time" << std::endl;
+            continue;
+         }
+
+         // the send time of mcs, from the start of the message. The clocks of the sending and
+         // the receiving host must be synchronized (NTP, PTP) for this to mean something.
+         uint64_t stamp = 0;
+         for(size_t byte = 0; byte < sizeof(stamp); byte++)
+            stamp = (stamp << 8) | buffer[byte];
+         deliveryLatency.record(deliveryTime - CNanoTime::fromNsec(int64_t(stamp)));
+         std::cout << "result=" << result << " received:'"
+                   << reinterpret_cast<const char*>(buffer + sizeof(stamp)) << "'" << std::endl;
+      }
+
+      // from the send time stamp until the message is here, the wait before it was sent
+      // doesn't count
+      std::cout << "delivery latency: ";
+      deliveryLatency.snapshot().printPercentiles(std::cout);
+      std::cout << std::endl;
    }
    catch(std::runtime_error &re)
    {
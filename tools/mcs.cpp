@@ -25,15 +25,19 @@
  */
 
  #include "../socketLib/CUdpMulticastSender.h"
+ #include "../socketLib/CClock.h"
+ #include "../socketLib/CNanoTime.h"
  #include <iostream>
  #include <string>
  #include <sstream>
+ #include <vector>
+ #include <stdint.h>
 
 int main(int argc, char** argv)
 {
    if(argc < 5)
    {
-      std::cout << "usage: mcs mulicast_address multicast_port if_address message\n";
+      std::cout << "usage: mcs mulicast_address multicast_port if_address message [count]\n";
       exit(1);
    }
    CUdpMulticastSender sender;
@@ -42,15 +46,33 @@ int main(int argc, char** argv)
    const std::string interfaceAddress(argv[3]);
    const std::string message(argv[4]);
    int mcPort;
+   int count = 1;
 
    multicastPortSS >> mcPort;
+   if(argc > 5)
+   {
+      std::istringstream countSS(argv[5]);
+      countSS >> count;
+   }
 
    try
    {
       std::cout << "open sender:" << multicastAddress << ":" << mcPort << " if:" << interfaceAddress << std::endl;
       sender.open(multicastAddress, mcPort, interfaceAddress);
-      std::cout << "send:'" << message << "'" << std::endl;
-      sender.send(message.c_str(), message.size());
+      std::cout << "send:'" << message << "' " << count << " times" << std::endl;
+
+      // every message starts with the wall clock time it is sent at, in nanoseconds big
+      // endian, so mcr can measure the delivery latency
+      std::vector<uint8_t> datagram(sizeof(uint64_t) + message.size());
+      message.copy(reinterpret_cast<char*>(datagram.data()) + sizeof(uint64_t), message.size());
+      for(int i = 0; i < count; i++)
+      {
+         CNanoTime sendTime;
+         const uint64_t stamp = uint64_t(CClock::getRealTime(sendTime).getNsec());
+         for(size_t byte = 0; byte < sizeof(stamp); byte++)
+            datagram[byte] = uint8_t(stamp >> (56 - 8 * byte));
+         sender.send(datagram.data(), datagram.size());
+      }
    }
    catch(std::runtime_error &re)
    {